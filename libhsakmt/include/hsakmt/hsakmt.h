@@ -307,6 +307,82 @@ hsaKmtWaitOnMultipleEvents_Ext(
     uint64_t   *event_age       //IN/OUT
     );
 
+/**
+  Creates an empty event wait set with room for Capacity events.
+
+  A wait set keeps the event list passed to KFD between waits, so that
+  waiting on the same events again doesn't allocate or rebuild anything.
+  Event ages of signal events are tracked inside the set. A wait set must
+  not be used by multiple threads at the same time.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtCreateEventWaitSet(
+    HSAuint32           Capacity,   //IN
+    HsaEventWaitSet**   WaitSet     //OUT
+    );
+
+/**
+  Destroys an event wait set. The events in the set are not destroyed.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtDestroyEventWaitSet(
+    HsaEventWaitSet*    WaitSet     //IN
+    );
+
+/**
+  Adds an event to a wait set, growing the set if it is full.
+  EventAge is the initial event age of a signal event, as passed to
+  hsaKmtWaitOnMultipleEvents_Ext. 0 disables age tracking for the event.
+  The same event must not be added twice.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtEventWaitSetAdd(
+    HsaEventWaitSet*    WaitSet,    //IN
+    HsaEvent*           Event,      //IN
+    HSAuint64           EventAge    //IN
+    );
+
+/**
+  Removes an event from a wait set. The last event of the set takes its
+  place, the order of the events in the set is not preserved.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtEventWaitSetRemove(
+    HsaEventWaitSet*    WaitSet,    //IN
+    HsaEvent*           Event       //IN
+    );
+
+/**
+  Removes all events from a wait set, keeping its capacity.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtEventWaitSetClear(
+    HsaEventWaitSet*    WaitSet     //IN
+    );
+
+/**
+  Waits on all events of a wait set like hsaKmtWaitOnMultipleEvents_Ext.
+  The event ages are updated in the set and used by the next wait.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtWaitOnEventWaitSet(
+    HsaEventWaitSet*    WaitSet,        //IN
+    bool                WaitOnAll,      //IN
+    HSAuint32           Milliseconds    //IN
+    );
+
 /**
   new TEMPORARY function definition - to be used only on "Triniti + Southern Islands" platform
   If used on other platforms the function will return HSAKMT_STATUS_ERROR
@@ -654,6 +730,23 @@ hsaKmtMapMemoryToGPUNodes(
     HSAuint32*      NodeArray              //IN
     );
 
+/**
+  Maps many memory ranges to the same GPUs, like hsaKmtMapMemoryToGPUNodes
+  called for each range. Duplicate ranges of the same buffer are mapped once.
+  Returns the first failing range's status, each range's status is also
+  written to its Status field.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtMapMemoryToGPUNodesBatch(
+    HsaMemMapRange* Ranges,                //IN/OUT
+    HSAuint64       NumberOfRanges,        //IN
+    HsaMemMapFlags  MemMapFlags,           //IN
+    HSAuint64       NumberOfNodes,         //IN
+    HSAuint32*      NodeArray              //IN
+    );
+
 /**
   Releases the residency of the memory
 */
@@ -664,6 +757,18 @@ hsaKmtUnmapMemoryToGPU(
     void*           MemoryAddress       //IN (page-aligned)
     );
 
+/**
+  Releases the residency of many memory ranges, like hsaKmtUnmapMemoryToGPU
+  called for each range. AlternateVAGPU and MemorySizeInBytes are ignored.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtUnmapMemoryToGPUBatch(
+    HsaMemMapRange* Ranges,             //IN/OUT
+    HSAuint64       NumberOfRanges      //IN
+    );
+
 
 /**
   Notifies the kernel driver that a process wants to use GPU debugging facilities
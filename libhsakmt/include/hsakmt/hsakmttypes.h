@@ -521,7 +521,9 @@ typedef struct _HsaMemFlags
             unsigned int NonPaged    : 1; // default = 0: pageable memory
             unsigned int CachePolicy : 2; // see HSA_CACHING_TYPE
             unsigned int ReadOnly    : 1; // default = 0: Read/Write memory
-            unsigned int PageSize    : 2; // see HSA_PAGE_SIZE
+            unsigned int PageSize    : 2; // see HSA_PAGE_SIZE. 2MB and 1GB back system memory with huge pages
+                                          // when available, falling back to transparent huge pages and then to
+                                          // base pages otherwise. SizeInBytes must be a multiple of the page size.
             unsigned int HostAccess  : 1; // default = 0: GPU access only
             unsigned int NoSubstitute: 1; // default = 0: if specific memory is not available on node (e.g. on
                                           // discrete GPU local), allocation may fall back to system memory node 0
@@ -573,7 +575,10 @@ typedef struct _HsaMemFlags
             unsigned int GTTAccess:     1;  // default = 0; If 1: The caller indicates this memory will be mapped to GART for MES
 					    // KFD will allocate GTT memory with the Preferred_node set as gpu_id for GART mapping
             unsigned int Contiguous:	1; // Allocate contiguous VRAM
-            unsigned int Reserved:      9;
+            unsigned int NUMAInterleave: 1; // Interleave system memory pages across the NUMA nodes in
+                                            // HSA_NUMA_INTERLEAVE_NODES (default: all nodes the process may
+                                            // allocate from) instead of binding them to PreferredNode
+            unsigned int Reserved:      8;
 
         } ui32;
         HSAuint32 Value;
@@ -609,6 +614,19 @@ typedef struct _HsaMemMapFlags
     };
 } HsaMemMapFlags;
 
+//
+// Memory range of hsaKmtMapMemoryToGPUNodesBatch and
+// hsaKmtUnmapMemoryToGPUBatch
+//
+
+typedef struct _HsaMemMapRange
+{
+    void*           MemoryAddress;      // IN (page-aligned)
+    HSAuint64       MemorySizeInBytes;  // IN (page-aligned)
+    HSAuint64       AlternateVAGPU;     // OUT (page-aligned)
+    HSAKMT_STATUS   Status;             // OUT
+} HsaMemMapRange;
+
 typedef struct _HsaGraphicsResourceInfo {
     void       *MemoryAddress;      // For use in hsaKmtMapMemoryToGPU(Nodes)
     HSAuint64  SizeInBytes;         // Buffer size
@@ -1110,6 +1128,13 @@ typedef struct _HsaEvent
     HsaEventData    EventData;
 } HsaEvent;
 
+//
+// Opaque set of events that are waited on together many times, see
+// hsaKmtCreateEventWaitSet
+//
+
+typedef struct _HsaEventWaitSet HsaEventWaitSet;
+
 typedef enum _HsaEventTimeout
 {
     HSA_EVENTTIMEOUT_IMMEDIATE  = 0,
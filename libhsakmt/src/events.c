@@ -31,6 +31,7 @@
 #include <unistd.h>
 #include <sys/mman.h>
 #include <stdio.h>
+#include <stddef.h>
 #include "hsakmt/linux/kfd_ioctl.h"
 #include "fmm.h"
 
@@ -374,6 +375,69 @@ static void analysis_memory_exception(struct kfd_hsa_memory_exception_data *
 	}
 }
 
+/* Events whose kfd_event_data is filled with exception data by KFD */
+static bool IsExceptionEventType(HSA_EVENTTYPE type)
+{
+	return (type == HSA_EVENTTYPE_MEMORY || type == HSA_EVENTTYPE_HW_EXCEPTION);
+}
+
+/* Copies the exception data KFD reported for a signaled memory or HW
+ * exception event to the event
+ */
+static HSAKMT_STATUS copy_event_exception_data(HsaEvent *Event,
+					       struct kfd_event_data *event_data)
+{
+	HSAKMT_STATUS result = HSAKMT_STATUS_SUCCESS;
+
+	if (Event->EventData.EventType == HSA_EVENTTYPE_MEMORY &&
+	    event_data->memory_exception_data.gpu_id) {
+		Event->EventData.EventData.MemoryAccessFault.VirtualAddress = event_data->memory_exception_data.va;
+		result = hsakmt_gpuid_to_nodeid(event_data->memory_exception_data.gpu_id, &Event->EventData.EventData.MemoryAccessFault.NodeId);
+		if (result != HSAKMT_STATUS_SUCCESS)
+			return result;
+		Event->EventData.EventData.MemoryAccessFault.Failure.NotPresent = event_data->memory_exception_data.failure.NotPresent;
+		Event->EventData.EventData.MemoryAccessFault.Failure.ReadOnly = event_data->memory_exception_data.failure.ReadOnly;
+		Event->EventData.EventData.MemoryAccessFault.Failure.NoExecute = event_data->memory_exception_data.failure.NoExecute;
+		Event->EventData.EventData.MemoryAccessFault.Failure.Imprecise = event_data->memory_exception_data.failure.imprecise;
+		Event->EventData.EventData.MemoryAccessFault.Failure.ErrorType = event_data->memory_exception_data.ErrorType;
+		Event->EventData.EventData.MemoryAccessFault.Failure.ECC =
+				((event_data->memory_exception_data.ErrorType == 1) || (event_data->memory_exception_data.ErrorType == 2)) ? 1 : 0;
+		Event->EventData.EventData.MemoryAccessFault.Flags = HSA_EVENTID_MEMORY_FATAL_PROCESS;
+		analysis_memory_exception(&event_data->memory_exception_data);
+	} else if (Event->EventData.EventType == HSA_EVENTTYPE_HW_EXCEPTION &&
+		event_data->hw_exception_data.gpu_id) {
+
+		result = hsakmt_gpuid_to_nodeid(event_data->hw_exception_data.gpu_id, &Event->EventData.EventData.HwException.NodeId);
+		if (result != HSAKMT_STATUS_SUCCESS)
+			return result;
+
+		Event->EventData.EventData.HwException.ResetType = event_data->hw_exception_data.reset_type;
+		Event->EventData.EventData.HwException.ResetCause = event_data->hw_exception_data.reset_cause;
+		Event->EventData.EventData.HwException.MemoryLost = event_data->hw_exception_data.memory_lost;
+	}
+
+	return result;
+}
+
+static HSAKMT_STATUS wait_on_event_data(struct kfd_event_data *event_data,
+					HSAuint32 NumEvents, bool WaitOnAll,
+					HSAuint32 Milliseconds)
+{
+	struct kfd_ioctl_wait_events_args args = {0};
+
+	args.wait_for_all = WaitOnAll;
+	args.timeout = Milliseconds;
+	args.num_events = NumEvents;
+	args.events_ptr = (uint64_t)(uintptr_t)event_data;
+
+	if (hsakmt_ioctl(hsakmt_kfd_fd, AMDKFD_IOC_WAIT_EVENTS, &args) == -1)
+		return HSAKMT_STATUS_ERROR;
+	else if (args.wait_result == KFD_IOC_WAIT_RESULT_TIMEOUT)
+		return HSAKMT_STATUS_WAIT_TIMEOUT;
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
 HSAKMT_STATUS HSAKMTAPI hsaKmtWaitOnMultipleEvents(HsaEvent *Events[],
 						   HSAuint32 NumEvents,
 						   bool WaitOnAll,
@@ -382,80 +446,225 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtWaitOnMultipleEvents(HsaEvent *Events[],
 	return hsaKmtWaitOnMultipleEvents_Ext(Events, NumEvents, WaitOnAll, Milliseconds, NULL);
 }
 
+/* Waits on up to this many events don't allocate the event data */
+#define WAIT_EVENTS_ON_STACK 8
+
 HSAKMT_STATUS HSAKMTAPI hsaKmtWaitOnMultipleEvents_Ext(HsaEvent *Events[],
 						   HSAuint32 NumEvents,
 						   bool WaitOnAll,
 						   HSAuint32 Milliseconds,
 						   uint64_t *event_age)
 {
-        HSAKMT_STATUS result;
-        CHECK_KFD_OPEN();
+	struct kfd_event_data short_event_data[WAIT_EVENTS_ON_STACK];
+	struct kfd_event_data *event_data = short_event_data;
+	HSAKMT_STATUS result;
 
-        if (!Events)
+	CHECK_KFD_OPEN();
+
+	if (!Events)
 		return HSAKMT_STATUS_INVALID_HANDLE;
 
-        struct kfd_event_data *event_data =
-        calloc(NumEvents, sizeof(struct kfd_event_data));
-        if (!event_data) {
-		return HSAKMT_STATUS_NO_MEMORY;
+	if (NumEvents > WAIT_EVENTS_ON_STACK) {
+		event_data = calloc(NumEvents, sizeof(struct kfd_event_data));
+		if (!event_data)
+			return HSAKMT_STATUS_NO_MEMORY;
+	} else {
+		memset(short_event_data, 0, NumEvents * sizeof(struct kfd_event_data));
 	}
-        for (HSAuint32 i = 0; i < NumEvents; i++) {
+
+	for (HSAuint32 i = 0; i < NumEvents; i++) {
 		event_data[i].event_id = Events[i]->EventId;
 		event_data[i].kfd_event_data_ext = (uint64_t)(uintptr_t)NULL;
 		if (event_age && Events[i]->EventData.EventType == HSA_EVENTTYPE_SIGNAL)
 			event_data[i].signal_event_data.last_event_age = event_age[i];
 	}
 
-        struct kfd_ioctl_wait_events_args args = {0};
-
-	args.wait_for_all = WaitOnAll;
-	args.timeout = Milliseconds;
-	args.num_events = NumEvents;
-	args.events_ptr = (uint64_t)(uintptr_t)event_data;
-
-	if (hsakmt_ioctl(hsakmt_kfd_fd, AMDKFD_IOC_WAIT_EVENTS, &args) == -1)
-		result = HSAKMT_STATUS_ERROR;
-	else if (args.wait_result == KFD_IOC_WAIT_RESULT_TIMEOUT)
-		result = HSAKMT_STATUS_WAIT_TIMEOUT;
-	else {
-		result = HSAKMT_STATUS_SUCCESS;
+	result = wait_on_event_data(event_data, NumEvents, WaitOnAll, Milliseconds);
+	if (result == HSAKMT_STATUS_SUCCESS) {
 		for (HSAuint32 i = 0; i < NumEvents; i++) {
-			if (Events[i]->EventData.EventType == HSA_EVENTTYPE_MEMORY &&
-			    event_data[i].memory_exception_data.gpu_id) {
-				Events[i]->EventData.EventData.MemoryAccessFault.VirtualAddress = event_data[i].memory_exception_data.va;
-				result = hsakmt_gpuid_to_nodeid(event_data[i].memory_exception_data.gpu_id, &Events[i]->EventData.EventData.MemoryAccessFault.NodeId);
-				if (result != HSAKMT_STATUS_SUCCESS)
-					goto out;
-				Events[i]->EventData.EventData.MemoryAccessFault.Failure.NotPresent = event_data[i].memory_exception_data.failure.NotPresent;
-				Events[i]->EventData.EventData.MemoryAccessFault.Failure.ReadOnly = event_data[i].memory_exception_data.failure.ReadOnly;
-				Events[i]->EventData.EventData.MemoryAccessFault.Failure.NoExecute = event_data[i].memory_exception_data.failure.NoExecute;
-				Events[i]->EventData.EventData.MemoryAccessFault.Failure.Imprecise = event_data[i].memory_exception_data.failure.imprecise;
-				Events[i]->EventData.EventData.MemoryAccessFault.Failure.ErrorType = event_data[i].memory_exception_data.ErrorType;
-				Events[i]->EventData.EventData.MemoryAccessFault.Failure.ECC =
-						((event_data[i].memory_exception_data.ErrorType == 1) || (event_data[i].memory_exception_data.ErrorType == 2)) ? 1 : 0;
-				Events[i]->EventData.EventData.MemoryAccessFault.Flags = HSA_EVENTID_MEMORY_FATAL_PROCESS;
-				analysis_memory_exception(&event_data[i].memory_exception_data);
-			} else if (Events[i]->EventData.EventType == HSA_EVENTTYPE_HW_EXCEPTION &&
-				event_data[i].hw_exception_data.gpu_id) {
-
-				result = hsakmt_gpuid_to_nodeid(event_data[i].hw_exception_data.gpu_id, &Events[i]->EventData.EventData.HwException.NodeId);
-				if (result != HSAKMT_STATUS_SUCCESS)
-					goto out;
-
-				Events[i]->EventData.EventData.HwException.ResetType = event_data[i].hw_exception_data.reset_type;
-				Events[i]->EventData.EventData.HwException.ResetCause = event_data[i].hw_exception_data.reset_cause;
-				Events[i]->EventData.EventData.HwException.MemoryLost = event_data[i].hw_exception_data.memory_lost;
-			}
+			result = copy_event_exception_data(Events[i], &event_data[i]);
+			if (result != HSAKMT_STATUS_SUCCESS)
+				break;
 		}
 	}
-out:
 
 	for (HSAuint32 i = 0; i < NumEvents; i++) {
 		if (event_age && Events[i]->EventData.EventType == HSA_EVENTTYPE_SIGNAL)
 			event_age[i] = event_data[i].signal_event_data.last_event_age;
 	}
 
-	free(event_data);
+	if (event_data != short_event_data)
+		free(event_data);
+
+	return result;
+}
+
+/* The kfd_event_data array is passed to KFD as is. events[i] is the event
+ * of event_data[i].
+ */
+struct _HsaEventWaitSet {
+	HSAuint32 num_events;
+	HSAuint32 capacity;
+	/* Number of memory and HW exception events */
+	HSAuint32 num_exception_events;
+	HsaEvent **events;
+	struct kfd_event_data *event_data;
+};
+
+#define EVENT_WAIT_SET_MIN_CAPACITY 16
+
+static HSAKMT_STATUS event_wait_set_grow(HsaEventWaitSet *WaitSet,
+					 HSAuint32 Capacity)
+{
+	struct kfd_event_data *event_data;
+	HsaEvent **events;
+
+	events = realloc(WaitSet->events, Capacity * sizeof(*events));
+	if (!events)
+		return HSAKMT_STATUS_NO_MEMORY;
+	WaitSet->events = events;
+
+	event_data = realloc(WaitSet->event_data, Capacity * sizeof(*event_data));
+	if (!event_data)
+		return HSAKMT_STATUS_NO_MEMORY;
+	WaitSet->event_data = event_data;
+
+	WaitSet->capacity = Capacity;
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtCreateEventWaitSet(HSAuint32 Capacity,
+						 HsaEventWaitSet **WaitSet)
+{
+	HsaEventWaitSet *set;
+
+	CHECK_KFD_OPEN();
+
+	if (!WaitSet)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	set = calloc(1, sizeof(*set));
+	if (!set)
+		return HSAKMT_STATUS_NO_MEMORY;
+
+	if (Capacity && event_wait_set_grow(set, Capacity) != HSAKMT_STATUS_SUCCESS) {
+		hsaKmtDestroyEventWaitSet(set);
+		return HSAKMT_STATUS_NO_MEMORY;
+	}
+
+	*WaitSet = set;
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+/* Only frees memory, so that thread exit handlers can destroy their wait
+ * sets after KFD was closed.
+ */
+HSAKMT_STATUS HSAKMTAPI hsaKmtDestroyEventWaitSet(HsaEventWaitSet *WaitSet)
+{
+	if (!WaitSet)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	free(WaitSet->events);
+	free(WaitSet->event_data);
+	free(WaitSet);
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtEventWaitSetAdd(HsaEventWaitSet *WaitSet,
+					      HsaEvent *Event,
+					      HSAuint64 EventAge)
+{
+	struct kfd_event_data *event_data;
+	HSAuint32 capacity;
+
+	if (!WaitSet || !Event)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	if (WaitSet->num_events == WaitSet->capacity) {
+		capacity = WaitSet->capacity ? WaitSet->capacity * 2 :
+					       EVENT_WAIT_SET_MIN_CAPACITY;
+		if (event_wait_set_grow(WaitSet, capacity) != HSAKMT_STATUS_SUCCESS)
+			return HSAKMT_STATUS_NO_MEMORY;
+	}
+
+	event_data = &WaitSet->event_data[WaitSet->num_events];
+	memset(event_data, 0, sizeof(*event_data));
+	event_data->event_id = Event->EventId;
+	if (Event->EventData.EventType == HSA_EVENTTYPE_SIGNAL)
+		event_data->signal_event_data.last_event_age = EventAge;
+	else if (IsExceptionEventType(Event->EventData.EventType))
+		WaitSet->num_exception_events++;
+
+	WaitSet->events[WaitSet->num_events++] = Event;
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtEventWaitSetRemove(HsaEventWaitSet *WaitSet,
+						 HsaEvent *Event)
+{
+	HSAuint32 i, last;
+
+	if (!WaitSet || !Event)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	for (i = 0; i < WaitSet->num_events; i++)
+		if (WaitSet->events[i] == Event)
+			break;
+	if (i == WaitSet->num_events)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	if (IsExceptionEventType(Event->EventData.EventType))
+		WaitSet->num_exception_events--;
+
+	last = --WaitSet->num_events;
+	WaitSet->events[i] = WaitSet->events[last];
+	WaitSet->event_data[i] = WaitSet->event_data[last];
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtEventWaitSetClear(HsaEventWaitSet *WaitSet)
+{
+	if (!WaitSet)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	WaitSet->num_events = 0;
+	WaitSet->num_exception_events = 0;
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtWaitOnEventWaitSet(HsaEventWaitSet *WaitSet,
+						 bool WaitOnAll,
+						 HSAuint32 Milliseconds)
+{
+	HSAKMT_STATUS result;
+	HSAuint32 i;
+
+	CHECK_KFD_OPEN();
+
+	if (!WaitSet)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+	if (!WaitSet->num_events)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	/* Exception data is only written by KFD when the event signals, clear
+	 * what the previous wait reported. Signal events keep their age.
+	 */
+	for (i = 0; WaitSet->num_exception_events && i < WaitSet->num_events; i++)
+		if (IsExceptionEventType(WaitSet->events[i]->EventData.EventType))
+			memset(&WaitSet->event_data[i].memory_exception_data, 0,
+			       offsetof(struct kfd_event_data, kfd_event_data_ext));
+
+	result = wait_on_event_data(WaitSet->event_data, WaitSet->num_events,
+				    WaitOnAll, Milliseconds);
+
+	for (i = 0; result == HSAKMT_STATUS_SUCCESS &&
+		    WaitSet->num_exception_events && i < WaitSet->num_events; i++)
+		result = copy_event_exception_data(WaitSet->events[i],
+						   &WaitSet->event_data[i]);
 
 	return result;
 }
@@ -0,0 +1,988 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* User space KFD simulator
+ *
+ * Built with -DBUILD_FAKE_KFD=ON and enabled with HSA_FAKE_KFD=1, it
+ * replaces /dev/kfd and the DRM render nodes so that FMM, event, queue
+ * and topology code paths run without a GPU or driver:
+ *
+ * - Topology is a synthetic sysfs tree with one CPU node and
+ *   HSA_FAKE_KFD_GPUS (default 1) gfx90a nodes of HSA_FAKE_KFD_VRAM_MB
+ *   (default 16384) VRAM each, unless HSA_SYSFS_ROOT points to a tree
+ *   already.
+ * - Memory objects are ranges of a memfd which doubles as KFD and render
+ *   node file, so the mmap offsets returned by the allocation ioctl map
+ *   host memory.
+ * - Events are signaled by AMDKFD_IOC_SET_EVENT or by writing their slot
+ *   in the events page, which waiters poll every FAKE_KFD_POLL_MS.
+ * - Queues only track their resources and doorbells, packets are never
+ *   processed.
+ *
+ * Everything else fails with EINVAL, like a KFD without the feature.
+ */
+
+/* memfd_create() and fallocate() hole punching */
+#define _GNU_SOURCE
+
+#include "libhsakmt.h"
+#include "linux/kfd_ioctl.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysinfo.h>
+
+#define FAKE_KFD_MAX_GPUS		16
+#define FAKE_KFD_GPU_ID_BASE		0xfa00
+#define FAKE_KFD_RENDER_MINOR_BASE	128
+#define FAKE_KFD_GFX_TARGET_VERSION	90010
+#define FAKE_KFD_DEVICE_ID		0x7408
+#define FAKE_KFD_MAX_QUEUES		1024
+#define FAKE_KFD_DOORBELL_SIZE		8
+#define FAKE_KFD_DOORBELL_PAGE		(FAKE_KFD_MAX_QUEUES * FAKE_KFD_DOORBELL_SIZE)
+#define FAKE_KFD_POLL_MS		1
+#define FAKE_KFD_UNSIGNALED_SLOT	(~0ULL)
+#define FAKE_KFD_TIMEOUT_INFINITE	0xffffffffU
+
+/* gfx9 apertures as KFD reports them for 47-bit GPUVM */
+#define FAKE_KFD_GPUVM_BASE		0x1000000ULL
+#define FAKE_KFD_GPUVM_LIMIT		0x7fffffffffffULL
+#define FAKE_KFD_LDS_BASE		0x1000000000000ULL
+#define FAKE_KFD_SCRATCH_BASE		0x2000000000000ULL
+#define FAKE_KFD_APERTURE_SIZE		0x100000000ULL
+
+struct fake_gpu {
+	uint32_t gpu_id;
+	uint64_t vram_size;
+	uint64_t vram_used;
+	/* memfd offset of the doorbell page, 0 until the first queue */
+	uint64_t doorbell_offset;
+};
+
+struct fake_bo {
+	bool used;
+	uint32_t gpu;
+	uint32_t flags;
+	uint64_t va;
+	uint64_t size;
+	/* memfd offset, 0 for user pointers and doorbells */
+	uint64_t offset;
+};
+
+struct fake_event {
+	bool used;
+	bool signaled;
+	bool auto_reset;
+	uint32_t type;
+	uint64_t age;
+};
+
+struct fake_queue {
+	bool used;
+	uint32_t gpu;
+	uint32_t type;
+	uint64_t ring_base;
+	uint32_t ring_size;
+};
+
+bool hsakmt_fake_kfd;
+
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t event_cond;
+	int memfd;
+	uint64_t file_size;
+	uint64_t next_offset;
+
+	uint32_t num_gpus;
+	struct fake_gpu gpus[FAKE_KFD_MAX_GPUS];
+
+	struct fake_bo *bos;
+	uint32_t num_bos;
+	uint32_t bo_hint;
+
+	/* Signal events use IDs [0, KFD_SIGNAL_EVENT_LIMIT), matching their
+	 * slot in the events page, other events follow.
+	 */
+	struct fake_event *events;
+	uint32_t num_events;
+	uint64_t event_page_offset;
+	uint64_t *event_slots;
+
+	struct fake_queue queues[FAKE_KFD_MAX_QUEUES];
+
+	char sysfs_dir[64];
+} fake = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.event_cond = PTHREAD_COND_INITIALIZER,
+	.memfd = -1,
+};
+
+bool hsakmt_fake_kfd_enabled(void)
+{
+	char *envvar = getenv("HSA_FAKE_KFD");
+
+	hsakmt_fake_kfd = envvar && strcmp(envvar, "0");
+	return hsakmt_fake_kfd;
+}
+
+/* Reserves size bytes of the memfd and returns their offset */
+static uint64_t fake_alloc_backing(uint64_t size)
+{
+	uint64_t offset = fake.next_offset;
+	uint64_t end = offset + ALIGN_UP(size, PAGE_SIZE);
+
+	if (end > fake.file_size) {
+		if (ftruncate(fake.memfd, end))
+			return 0;
+		fake.file_size = end;
+	}
+	fake.next_offset = end;
+
+	return offset;
+}
+
+/* Offsets are never reused, only the pages go back to the system */
+static void fake_free_backing(uint64_t offset, uint64_t size)
+{
+	if (offset)
+		fallocate(fake.memfd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			  offset, ALIGN_UP(size, PAGE_SIZE));
+}
+
+static int fake_find_gpu(uint32_t gpu_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < fake.num_gpus; i++)
+		if (fake.gpus[i].gpu_id == gpu_id)
+			return i;
+
+	return -1;
+}
+
+static int fake_write_file(const char *content, const char *fmt, ...)
+{
+	char path[256], *p;
+	va_list ap;
+	FILE *fd;
+
+	va_start(ap, fmt);
+	vsnprintf(path, sizeof(path), fmt, ap);
+	va_end(ap);
+
+	for (p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+		*p = '\0';
+		mkdir(path, 0755);
+		*p = '/';
+	}
+
+	fd = fopen(path, "w");
+	if (!fd)
+		return -1;
+	fputs(content, fd);
+	fclose(fd);
+
+	return 0;
+}
+
+static int fake_remove_entry(const char *path, const struct stat *sb,
+			     int type, struct FTW *ftw)
+{
+	return remove(path);
+}
+
+static void fake_remove_sysfs(void)
+{
+	if (fake.sysfs_dir[0])
+		nftw(fake.sysfs_dir, fake_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+/* Formats the CPU mask [first, last] the way sysfs shared_cpu_map does */
+static void fake_cpu_map(char *buf, int num_cpus, int first, int last)
+{
+	int word, bit, len = 0;
+	unsigned int mask;
+
+	for (word = (num_cpus - 1) / 32; word >= 0; word--) {
+		mask = 0;
+		for (bit = 0; bit < 32; bit++)
+			if (word * 32 + bit >= first && word * 32 + bit <= last)
+				mask |= 1U << bit;
+		len += sprintf(buf + len, "%08x%s", mask, word ? "," : "\n");
+	}
+}
+
+/* Every CPU has a private L1 data cache and shares one L3 with the others */
+static int fake_create_cpu_caches(int cpu, int num_cpus)
+{
+	static const char *type[] = { "Data", "Unified" };
+	static const char *size[] = { "32K", "32768K" };
+	static const int level[] = { 1, 3 };
+	const char *cache = "%s/sys/devices/system/node/node0/cpu%d/cache/index%d/%s";
+	char buf[1200];
+	int idx, first, last, ret = 0;
+
+	for (idx = 0; idx < 2; idx++) {
+		first = idx ? 0 : cpu;
+		last = idx ? num_cpus - 1 : cpu;
+
+		snprintf(buf, sizeof(buf), "%d\n", level[idx]);
+		ret |= fake_write_file(buf, cache, fake.sysfs_dir, cpu, idx, "level");
+		snprintf(buf, sizeof(buf), "%s\n", type[idx]);
+		ret |= fake_write_file(buf, cache, fake.sysfs_dir, cpu, idx, "type");
+		snprintf(buf, sizeof(buf), "%s\n", size[idx]);
+		ret |= fake_write_file(buf, cache, fake.sysfs_dir, cpu, idx, "size");
+		ret |= fake_write_file("64\n", cache, fake.sysfs_dir, cpu, idx,
+				       "coherency_line_size");
+		ret |= fake_write_file("8\n", cache, fake.sysfs_dir, cpu, idx,
+				       "ways_of_associativity");
+		ret |= fake_write_file("1\n", cache, fake.sysfs_dir, cpu, idx,
+				       "physical_line_partition");
+		if (first == last)
+			snprintf(buf, sizeof(buf), "%d\n", first);
+		else
+			snprintf(buf, sizeof(buf), "%d-%d\n", first, last);
+		ret |= fake_write_file(buf, cache, fake.sysfs_dir, cpu, idx,
+				       "shared_cpu_list");
+		fake_cpu_map(buf, num_cpus, first, last);
+		ret |= fake_write_file(buf, cache, fake.sysfs_dir, cpu, idx,
+				       "shared_cpu_map");
+	}
+
+	return ret;
+}
+
+/* Writes the topology of the simulated system to a temporary directory
+ * and points HSA_SYSFS_ROOT and HSA_PROCFS_ROOT at it.
+ */
+static int fake_create_sysfs(void)
+{
+	const char *topo = "%s/sys/devices/virtual/kfd/kfd/topology/nodes/%u/%s";
+	int num_cpus = get_nprocs();
+	char buf[2048];
+	uint32_t i;
+	int cpu, ret = 0;
+	FILE *fd;
+
+	snprintf(fake.sysfs_dir, sizeof(fake.sysfs_dir), "/tmp/hsakmt_fake_kfd.XXXXXX");
+	if (!mkdtemp(fake.sysfs_dir)) {
+		fake.sysfs_dir[0] = '\0';
+		return -1;
+	}
+	atexit(fake_remove_sysfs);
+
+	ret |= fake_write_file("1\n", "%s/sys/devices/virtual/kfd/kfd/topology/generation_id",
+			       fake.sysfs_dir);
+	ret |= fake_write_file("platform_oem 0\nplatform_id 0\nplatform_rev 0\n",
+			       "%s/sys/devices/virtual/kfd/kfd/topology/system_properties",
+			       fake.sysfs_dir);
+
+	/* Node 0 is the CPU with all processors and one link per GPU */
+	ret |= fake_write_file("0\n", topo, fake.sysfs_dir, 0, "gpu_id");
+	snprintf(buf, sizeof(buf),
+		 "cpu_cores_count %d\nsimd_count 0\nmem_banks_count 1\n"
+		 "caches_count 0\nio_links_count %u\np2p_links_count 0\n"
+		 "cpu_core_id_base 0\nsimd_id_base 0\nmax_waves_per_simd 0\n"
+		 "lds_size_in_kb 0\ngds_size_in_kb 0\nwave_front_size 0\n"
+		 "array_count 0\nsimd_arrays_per_engine 0\ncu_per_simd_array 0\n"
+		 "simd_per_cu 0\nmax_slots_scratch_cu 0\nvendor_id 0\n"
+		 "device_id 0\nlocation_id 0\ndomain 0\ndrm_render_minor 0\n"
+		 "hive_id 0\nnum_sdma_engines 0\nnum_sdma_xgmi_engines 0\n"
+		 "num_sdma_queues_per_engine 0\nnum_cp_queues 0\n"
+		 "max_engine_clk_fcompute 0\nlocal_mem_size 0\nfw_version 0\n"
+		 "capability 0\ndebug_prop 0\nsdma_fw_version 0\nunique_id 0\n"
+		 "num_xcc 0\nmax_engine_clk_ccompute 3000\n",
+		 num_cpus, fake.num_gpus);
+	ret |= fake_write_file(buf, topo, fake.sysfs_dir, 0, "properties");
+	ret |= fake_write_file("heap_type 0\nsize_in_bytes 68719476736\n"
+			       "flags 0\nwidth 64\nmem_clk_max 3200\n",
+			       topo, fake.sysfs_dir, 0, "mem_banks/0/properties");
+
+	for (i = 0; i < fake.num_gpus && !ret; i++) {
+		snprintf(buf, sizeof(buf),
+			 "type 2\nversion_major 0\nversion_minor 0\nnode_from 0\n"
+			 "node_to %u\nweight 20\nmin_latency 0\nmax_latency 0\n"
+			 "min_bandwidth 0\nmax_bandwidth 0\nrecommended_transfer_size 0\n"
+			 "recommended_sdma_engine_id_mask 0\nflags 1\n", i + 1);
+		ret |= fake_write_file(buf, "%s/sys/devices/virtual/kfd/kfd/topology/nodes/0/io_links/%u/properties",
+				       fake.sysfs_dir, i);
+
+		snprintf(buf, sizeof(buf), "%u\n", fake.gpus[i].gpu_id);
+		ret |= fake_write_file(buf, topo, fake.sysfs_dir, i + 1, "gpu_id");
+		snprintf(buf, sizeof(buf),
+			 "cpu_cores_count 0\nsimd_count 416\nmem_banks_count 1\n"
+			 "caches_count 0\nio_links_count 1\np2p_links_count 0\n"
+			 "cpu_core_id_base 0\nsimd_id_base %u\nmax_waves_per_simd 8\n"
+			 "lds_size_in_kb 64\ngds_size_in_kb 0\nwave_front_size 64\n"
+			 "array_count 8\nsimd_arrays_per_engine 1\ncu_per_simd_array 13\n"
+			 "simd_per_cu 4\nmax_slots_scratch_cu 32\nvendor_id 4098\n"
+			 "device_id %u\nlocation_id %u\ndomain 0\ndrm_render_minor %u\n"
+			 "hive_id 0\nnum_sdma_engines 2\nnum_sdma_xgmi_engines 0\n"
+			 "num_sdma_queues_per_engine 8\nnum_cp_queues 24\n"
+			 "max_engine_clk_fcompute 1700\nlocal_mem_size %llu\n"
+			 "fw_version 0\ncapability 0\ndebug_prop 0\nsdma_fw_version 0\n"
+			 "unique_id %u\nnum_xcc 1\nmax_engine_clk_ccompute 3000\n"
+			 "gfx_target_version %u\n",
+			 0x80000000U + i * 0x1000, FAKE_KFD_DEVICE_ID, (i + 1) << 8,
+			 FAKE_KFD_RENDER_MINOR_BASE + i,
+			 (unsigned long long)fake.gpus[i].vram_size, i + 1,
+			 FAKE_KFD_GFX_TARGET_VERSION);
+		ret |= fake_write_file(buf, topo, fake.sysfs_dir, i + 1, "properties");
+		snprintf(buf, sizeof(buf), "heap_type 1\nsize_in_bytes %llu\n"
+			 "flags 0\nwidth 4096\nmem_clk_max 1600\n",
+			 (unsigned long long)fake.gpus[i].vram_size);
+		ret |= fake_write_file(buf, topo, fake.sysfs_dir, i + 1,
+				       "mem_banks/0/properties");
+		snprintf(buf, sizeof(buf),
+			 "type 2\nversion_major 0\nversion_minor 0\nnode_from %u\n"
+			 "node_to 0\nweight 20\nmin_latency 0\nmax_latency 0\n"
+			 "min_bandwidth 0\nmax_bandwidth 0\nrecommended_transfer_size 0\n"
+			 "recommended_sdma_engine_id_mask 0\nflags 1\n", i + 1);
+		ret |= fake_write_file(buf, topo, fake.sysfs_dir, i + 1,
+				       "io_links/0/properties");
+	}
+	for (cpu = 0; cpu < num_cpus && !ret; cpu++)
+		ret |= fake_create_cpu_caches(cpu, num_cpus);
+	if (ret)
+		return ret;
+
+	/* One cpuinfo entry per processor, the topology code indexes it by
+	 * processor number.
+	 */
+	snprintf(buf, sizeof(buf), "%s/proc/cpuinfo", fake.sysfs_dir);
+	if (fake_write_file("", "%s", buf))
+		return -1;
+	fd = fopen(buf, "w");
+	if (!fd)
+		return -1;
+	for (cpu = 0; cpu < num_cpus; cpu++)
+		fprintf(fd, "processor\t: %d\nvendor_id\t: AuthenticAMD\n"
+			"model name\t: Simulated CPU\napicid\t\t: %d\n\n", cpu, cpu);
+	fclose(fd);
+
+	snprintf(buf, sizeof(buf), "%s/sys", fake.sysfs_dir);
+	setenv("HSA_SYSFS_ROOT", buf, 1);
+	snprintf(buf, sizeof(buf), "%s/proc", fake.sysfs_dir);
+	setenv("HSA_PROCFS_ROOT", buf, 1);
+
+	return 0;
+}
+
+int hsakmt_fake_kfd_open(void)
+{
+	uint64_t vram_mb = 16384;
+	char *envvar;
+	uint32_t i;
+	int fd;
+
+	pthread_mutex_lock(&fake.mutex);
+
+	if (fake.memfd >= 0) {
+		fd = dup(fake.memfd);
+		goto out;
+	}
+
+	fd = memfd_create("hsakmt_fake_kfd", MFD_CLOEXEC);
+	if (fd < 0)
+		goto out;
+
+	/* Offset 0 means "not backed", start with a page that is never
+	 * handed out. PAGE_SIZE isn't initialized before KFD is open.
+	 */
+	fake.memfd = fd;
+	fake.next_offset = sysconf(_SC_PAGESIZE);
+
+	envvar = getenv("HSA_FAKE_KFD_GPUS");
+	fake.num_gpus = envvar ? atoi(envvar) : 1;
+	if (fake.num_gpus > FAKE_KFD_MAX_GPUS)
+		fake.num_gpus = FAKE_KFD_MAX_GPUS;
+	envvar = getenv("HSA_FAKE_KFD_VRAM_MB");
+	if (envvar)
+		vram_mb = strtoull(envvar, NULL, 0);
+
+	for (i = 0; i < fake.num_gpus; i++) {
+		fake.gpus[i].gpu_id = FAKE_KFD_GPU_ID_BASE + i;
+		fake.gpus[i].vram_size = vram_mb << 20;
+	}
+
+	if (!getenv("HSA_SYSFS_ROOT") && fake_create_sysfs()) {
+		pr_err("Failed to create the fake KFD topology\n");
+		fake_remove_sysfs();
+		fake.sysfs_dir[0] = '\0';
+		close(fd);
+		fake.memfd = fd = -1;
+		goto out;
+	}
+
+	/* Keep one descriptor for the simulator, the caller owns the other */
+	fd = dup(fake.memfd);
+
+out:
+	pthread_mutex_unlock(&fake.mutex);
+	return fd;
+}
+
+int hsakmt_fake_kfd_open_render(int minor)
+{
+	int fd;
+
+	if (minor < FAKE_KFD_RENDER_MINOR_BASE ||
+	    minor >= FAKE_KFD_RENDER_MINOR_BASE + (int)fake.num_gpus)
+		return -ENOENT;
+
+	fd = dup(fake.memfd);
+	return fd < 0 ? -errno : fd;
+}
+
+static int fake_get_process_apertures(struct kfd_ioctl_get_process_apertures_new_args *args)
+{
+	struct kfd_process_device_apertures *ap =
+		(struct kfd_process_device_apertures *)args->kfd_process_device_apertures_ptr;
+	uint32_t i;
+
+	if (args->num_of_nodes < fake.num_gpus) {
+		args->num_of_nodes = fake.num_gpus;
+		return 0;
+	}
+
+	for (i = 0; i < fake.num_gpus; i++) {
+		memset(&ap[i], 0, sizeof(ap[i]));
+		ap[i].gpu_id = fake.gpus[i].gpu_id;
+		ap[i].lds_base = FAKE_KFD_LDS_BASE;
+		ap[i].lds_limit = FAKE_KFD_LDS_BASE + FAKE_KFD_APERTURE_SIZE - 1;
+		ap[i].scratch_base = FAKE_KFD_SCRATCH_BASE;
+		ap[i].scratch_limit = FAKE_KFD_SCRATCH_BASE + FAKE_KFD_APERTURE_SIZE - 1;
+		ap[i].gpuvm_base = FAKE_KFD_GPUVM_BASE;
+		ap[i].gpuvm_limit = FAKE_KFD_GPUVM_LIMIT;
+	}
+	args->num_of_nodes = fake.num_gpus;
+
+	return 0;
+}
+
+static int fake_alloc_memory(struct kfd_ioctl_alloc_memory_of_gpu_args *args)
+{
+	struct fake_gpu *gpu;
+	struct fake_bo *bo;
+	uint32_t i, n;
+	int gpu_idx;
+
+	gpu_idx = fake_find_gpu(args->gpu_id);
+	if (gpu_idx < 0 || !args->size)
+		return -EINVAL;
+	gpu = &fake.gpus[gpu_idx];
+
+	if ((args->flags & KFD_IOC_ALLOC_MEM_FLAGS_VRAM) &&
+	    gpu->vram_used + args->size > gpu->vram_size)
+		return -ENOMEM;
+
+	/* Handles are indexes into the BO array, 0 is never used */
+	for (n = 0, i = fake.bo_hint; n < fake.num_bos; n++, i = (i + 1) % fake.num_bos)
+		if (i && !fake.bos[i].used)
+			break;
+	if (n == fake.num_bos) {
+		uint32_t num = fake.num_bos ? fake.num_bos * 2 : 1024;
+		struct fake_bo *bos = realloc(fake.bos, num * sizeof(*bos));
+
+		if (!bos)
+			return -ENOMEM;
+		memset(&bos[fake.num_bos], 0, (num - fake.num_bos) * sizeof(*bos));
+		i = fake.num_bos ? fake.num_bos : 1;
+		fake.bos = bos;
+		fake.num_bos = num;
+	}
+	bo = &fake.bos[i];
+	fake.bo_hint = i + 1 < fake.num_bos ? i + 1 : 1;
+
+	memset(bo, 0, sizeof(*bo));
+	bo->gpu = gpu_idx;
+	bo->flags = args->flags;
+	bo->va = args->va_addr;
+	bo->size = args->size;
+
+	if (args->flags & (KFD_IOC_ALLOC_MEM_FLAGS_VRAM | KFD_IOC_ALLOC_MEM_FLAGS_GTT)) {
+		bo->offset = fake_alloc_backing(args->size);
+		if (!bo->offset)
+			return -ENOMEM;
+		args->mmap_offset = bo->offset;
+	}
+	if (args->flags & KFD_IOC_ALLOC_MEM_FLAGS_VRAM)
+		gpu->vram_used += args->size;
+
+	bo->used = true;
+	args->handle = ((uint64_t)gpu->gpu_id << 32) | i;
+
+	return 0;
+}
+
+static struct fake_bo *fake_find_bo(uint64_t handle)
+{
+	uint32_t i = (uint32_t)handle;
+
+	if (!i || i >= fake.num_bos || !fake.bos[i].used ||
+	    fake.gpus[fake.bos[i].gpu].gpu_id != handle >> 32)
+		return NULL;
+
+	return &fake.bos[i];
+}
+
+static int fake_free_memory(struct kfd_ioctl_free_memory_of_gpu_args *args)
+{
+	struct fake_bo *bo = fake_find_bo(args->handle);
+
+	if (!bo)
+		return -EINVAL;
+
+	if (bo->flags & KFD_IOC_ALLOC_MEM_FLAGS_VRAM)
+		fake.gpus[bo->gpu].vram_used -= bo->size;
+	if (fake.event_slots && bo->offset == fake.event_page_offset) {
+		munmap(fake.event_slots, KFD_SIGNAL_EVENT_LIMIT * 8);
+		fake.event_slots = NULL;
+		fake.event_page_offset = 0;
+	}
+	fake_free_backing(bo->offset, bo->size);
+	bo->used = false;
+
+	return 0;
+}
+
+/* Map and unmap share their argument layout */
+static int fake_map_memory(struct kfd_ioctl_map_memory_to_gpu_args *args)
+{
+	uint32_t *ids = (uint32_t *)args->device_ids_array_ptr;
+	uint32_t i;
+
+	if (!fake_find_bo(args->handle))
+		return -EINVAL;
+
+	for (i = args->n_success; i < args->n_devices; i++)
+		if (fake_find_gpu(ids[i]) < 0)
+			return -EINVAL;
+	args->n_success = args->n_devices;
+
+	return 0;
+}
+
+static struct fake_event *fake_find_event(uint32_t event_id)
+{
+	if (event_id >= fake.num_events || !fake.events[event_id].used)
+		return NULL;
+
+	return &fake.events[event_id];
+}
+
+static int fake_create_event(struct kfd_ioctl_create_event_args *args)
+{
+	bool is_signal = args->event_type == KFD_IOC_EVENT_SIGNAL;
+	uint32_t first = is_signal ? 0 : KFD_SIGNAL_EVENT_LIMIT;
+	uint32_t last = is_signal ? KFD_SIGNAL_EVENT_LIMIT : UINT32_MAX;
+	struct fake_event *ev;
+	uint32_t id;
+
+	/* dGPUs pass the handle of the events page with the first event,
+	 * otherwise KFD provides the page for the caller to mmap.
+	 */
+	if (is_signal && !fake.event_slots) {
+		uint64_t offset;
+
+		if (args->event_page_offset) {
+			struct fake_bo *bo = fake_find_bo(args->event_page_offset);
+
+			if (!bo || !bo->offset || bo->size < KFD_SIGNAL_EVENT_LIMIT * 8)
+				return -EINVAL;
+			offset = bo->offset;
+		} else {
+			offset = fake_alloc_backing(KFD_SIGNAL_EVENT_LIMIT * 8);
+			if (!offset)
+				return -ENOMEM;
+		}
+		fake.event_slots = mmap(NULL, KFD_SIGNAL_EVENT_LIMIT * 8,
+					PROT_READ | PROT_WRITE, MAP_SHARED,
+					fake.memfd, offset);
+		if (fake.event_slots == MAP_FAILED) {
+			fake.event_slots = NULL;
+			return -ENOMEM;
+		}
+		fake.event_page_offset = offset;
+	}
+
+	for (id = first; id < fake.num_events && id < last; id++)
+		if (!fake.events[id].used)
+			break;
+	if (id == last)
+		return -ENOSPC;
+	if (id >= fake.num_events) {
+		uint32_t num = MAX(KFD_SIGNAL_EVENT_LIMIT * 2, fake.num_events * 2);
+		struct fake_event *events;
+
+		num = MAX(num, id + 1);
+		events = realloc(fake.events, num * sizeof(*events));
+		if (!events)
+			return -ENOMEM;
+		memset(&events[fake.num_events], 0,
+		       (num - fake.num_events) * sizeof(*events));
+		fake.events = events;
+		fake.num_events = num;
+	}
+
+	ev = &fake.events[id];
+	memset(ev, 0, sizeof(*ev));
+	ev->used = true;
+	ev->type = args->event_type;
+	ev->auto_reset = args->auto_reset;
+	ev->age = 1;
+
+	args->event_id = id;
+	if (is_signal) {
+		args->event_trigger_data = id;
+		args->event_slot_index = id;
+		args->event_page_offset = fake.event_page_offset;
+		fake.event_slots[id] = FAKE_KFD_UNSIGNALED_SLOT;
+	}
+
+	return 0;
+}
+
+static void fake_signal_event(struct fake_event *ev)
+{
+	ev->signaled = true;
+	ev->age++;
+	pthread_cond_broadcast(&fake.event_cond);
+}
+
+/* Picks up events signaled through their slot, as the interrupt handler
+ * would.
+ */
+static void fake_scan_event_slots(struct kfd_event_data *data, uint32_t num_events)
+{
+	uint32_t i, id;
+
+	if (!fake.event_slots)
+		return;
+
+	for (i = 0; i < num_events; i++) {
+		id = data[i].event_id;
+		if (id < KFD_SIGNAL_EVENT_LIMIT && fake_find_event(id) &&
+		    __atomic_load_n(&fake.event_slots[id], __ATOMIC_ACQUIRE) !=
+		    FAKE_KFD_UNSIGNALED_SLOT) {
+			fake.event_slots[id] = FAKE_KFD_UNSIGNALED_SLOT;
+			fake_signal_event(&fake.events[id]);
+		}
+	}
+}
+
+/* An event is ready when it is signaled or, with age tracking, when it
+ * was signaled since the age the caller saw last.
+ */
+static bool fake_event_ready(struct kfd_event_data *data)
+{
+	struct fake_event *ev = &fake.events[data->event_id];
+	uint64_t last_age = data->signal_event_data.last_event_age;
+
+	return ev->signaled ||
+		(ev->type == KFD_IOC_EVENT_SIGNAL && last_age && last_age != ev->age);
+}
+
+static int fake_wait_events(struct kfd_ioctl_wait_events_args *args)
+{
+	struct kfd_event_data *data = (struct kfd_event_data *)args->events_ptr;
+	bool infinite = args->timeout == FAKE_KFD_TIMEOUT_INFINITE;
+	struct timespec deadline, now, slice;
+	uint32_t i, ready;
+
+	for (i = 0; i < args->num_events; i++)
+		if (!fake_find_event(data[i].event_id))
+			return -EINVAL;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += args->timeout / 1000;
+	deadline.tv_nsec += (args->timeout % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	while (true) {
+		fake_scan_event_slots(data, args->num_events);
+
+		for (i = 0, ready = 0; i < args->num_events; i++)
+			ready += fake_event_ready(&data[i]);
+		if (ready && (!args->wait_for_all || ready == args->num_events)) {
+			args->wait_result = KFD_IOC_WAIT_RESULT_COMPLETE;
+			break;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (!infinite && (now.tv_sec > deadline.tv_sec ||
+				  (now.tv_sec == deadline.tv_sec &&
+				   now.tv_nsec >= deadline.tv_nsec))) {
+			args->wait_result = KFD_IOC_WAIT_RESULT_TIMEOUT;
+			break;
+		}
+
+		/* Sleep until the next signal or slot poll, the condition
+		 * variable uses the realtime clock.
+		 */
+		clock_gettime(CLOCK_REALTIME, &slice);
+		slice.tv_nsec += FAKE_KFD_POLL_MS * 1000000L;
+		if (slice.tv_nsec >= 1000000000L) {
+			slice.tv_sec++;
+			slice.tv_nsec -= 1000000000L;
+		}
+		pthread_cond_timedwait(&fake.event_cond, &fake.mutex, &slice);
+
+		for (i = 0; i < args->num_events; i++)
+			if (!fake_find_event(data[i].event_id))
+				return -EINVAL;
+	}
+
+	for (i = 0; i < args->num_events; i++) {
+		struct fake_event *ev = &fake.events[data[i].event_id];
+
+		if (ev->type == KFD_IOC_EVENT_SIGNAL)
+			data[i].signal_event_data.last_event_age = ev->age;
+		if (args->wait_result == KFD_IOC_WAIT_RESULT_COMPLETE &&
+		    ev->signaled && ev->auto_reset)
+			ev->signaled = false;
+	}
+
+	return 0;
+}
+
+static int fake_create_queue(struct kfd_ioctl_create_queue_args *args)
+{
+	struct fake_queue *q;
+	struct fake_gpu *gpu;
+	uint32_t id;
+	int gpu_idx;
+
+	gpu_idx = fake_find_gpu(args->gpu_id);
+	if (gpu_idx < 0 || args->queue_type > KFD_IOC_QUEUE_TYPE_SDMA_BY_ENG_ID)
+		return -EINVAL;
+	gpu = &fake.gpus[gpu_idx];
+
+	for (id = 0; id < FAKE_KFD_MAX_QUEUES; id++)
+		if (!fake.queues[id].used)
+			break;
+	if (id == FAKE_KFD_MAX_QUEUES)
+		return -ENOSPC;
+
+	/* The doorbell page must be aligned to its size, the doorbell index
+	 * is encoded in the low bits of the offset.
+	 */
+	if (!gpu->doorbell_offset) {
+		fake.next_offset = ALIGN_UP(fake.next_offset, FAKE_KFD_DOORBELL_PAGE);
+		gpu->doorbell_offset = fake_alloc_backing(FAKE_KFD_DOORBELL_PAGE);
+		if (!gpu->doorbell_offset)
+			return -ENOMEM;
+	}
+
+	q = &fake.queues[id];
+	q->used = true;
+	q->gpu = gpu_idx;
+	q->type = args->queue_type;
+	q->ring_base = args->ring_base_address;
+	q->ring_size = args->ring_size;
+
+	args->queue_id = id;
+	args->doorbell_offset = gpu->doorbell_offset + id * FAKE_KFD_DOORBELL_SIZE;
+
+	return 0;
+}
+
+static struct fake_queue *fake_find_queue(uint32_t queue_id)
+{
+	if (queue_id >= FAKE_KFD_MAX_QUEUES || !fake.queues[queue_id].used)
+		return NULL;
+
+	return &fake.queues[queue_id];
+}
+
+static uint64_t fake_clock_ns(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int fake_ioctl(unsigned long request, void *arg)
+{
+	switch (request) {
+	case AMDKFD_IOC_GET_VERSION: {
+		struct kfd_ioctl_get_version_args *args = arg;
+
+		args->major_version = KFD_IOCTL_MAJOR_VERSION;
+		args->minor_version = KFD_IOCTL_MINOR_VERSION;
+		return 0;
+	}
+	case AMDKFD_IOC_GET_PROCESS_APERTURES_NEW:
+		return fake_get_process_apertures(arg);
+	case AMDKFD_IOC_ACQUIRE_VM: {
+		struct kfd_ioctl_acquire_vm_args *args = arg;
+
+		return fake_find_gpu(args->gpu_id) < 0 ? -EINVAL : 0;
+	}
+	case AMDKFD_IOC_AVAILABLE_MEMORY: {
+		struct kfd_ioctl_get_available_memory_args *args = arg;
+		int gpu_idx = fake_find_gpu(args->gpu_id);
+
+		if (gpu_idx < 0)
+			return -EINVAL;
+		args->available = fake.gpus[gpu_idx].vram_size -
+				  fake.gpus[gpu_idx].vram_used;
+		return 0;
+	}
+	case AMDKFD_IOC_ALLOC_MEMORY_OF_GPU:
+		return fake_alloc_memory(arg);
+	case AMDKFD_IOC_FREE_MEMORY_OF_GPU:
+		return fake_free_memory(arg);
+	case AMDKFD_IOC_MAP_MEMORY_TO_GPU:
+	case AMDKFD_IOC_UNMAP_MEMORY_FROM_GPU:
+		return fake_map_memory(arg);
+	case AMDKFD_IOC_CREATE_EVENT:
+		return fake_create_event(arg);
+	case AMDKFD_IOC_DESTROY_EVENT: {
+		struct kfd_ioctl_destroy_event_args *args = arg;
+		struct fake_event *ev = fake_find_event(args->event_id);
+
+		if (!ev)
+			return -EINVAL;
+		ev->used = false;
+		/* Wake up waiters so that they notice */
+		pthread_cond_broadcast(&fake.event_cond);
+		return 0;
+	}
+	case AMDKFD_IOC_SET_EVENT: {
+		struct kfd_ioctl_set_event_args *args = arg;
+		struct fake_event *ev = fake_find_event(args->event_id);
+
+		if (!ev)
+			return -EINVAL;
+		fake_signal_event(ev);
+		return 0;
+	}
+	case AMDKFD_IOC_RESET_EVENT: {
+		struct kfd_ioctl_reset_event_args *args = arg;
+		struct fake_event *ev = fake_find_event(args->event_id);
+
+		if (!ev)
+			return -EINVAL;
+		ev->signaled = false;
+		return 0;
+	}
+	case AMDKFD_IOC_WAIT_EVENTS:
+		return fake_wait_events(arg);
+	case AMDKFD_IOC_CREATE_QUEUE:
+		return fake_create_queue(arg);
+	case AMDKFD_IOC_DESTROY_QUEUE: {
+		struct kfd_ioctl_destroy_queue_args *args = arg;
+		struct fake_queue *q = fake_find_queue(args->queue_id);
+
+		if (!q)
+			return -EINVAL;
+		q->used = false;
+		return 0;
+	}
+	case AMDKFD_IOC_UPDATE_QUEUE: {
+		struct kfd_ioctl_update_queue_args *args = arg;
+		struct fake_queue *q = fake_find_queue(args->queue_id);
+
+		if (!q)
+			return -EINVAL;
+		q->ring_base = args->ring_base_address;
+		q->ring_size = args->ring_size;
+		return 0;
+	}
+	case AMDKFD_IOC_SET_CU_MASK: {
+		struct kfd_ioctl_set_cu_mask_args *args = arg;
+
+		return fake_find_queue(args->queue_id) ? 0 : -EINVAL;
+	}
+	case AMDKFD_IOC_GET_CLOCK_COUNTERS: {
+		struct kfd_ioctl_get_clock_counters_args *args = arg;
+
+		if (fake_find_gpu(args->gpu_id) < 0)
+			return -EINVAL;
+		args->gpu_clock_counter = fake_clock_ns(CLOCK_MONOTONIC_RAW);
+		args->cpu_clock_counter = fake_clock_ns(CLOCK_MONOTONIC_RAW);
+		args->system_clock_counter = fake_clock_ns(CLOCK_BOOTTIME);
+		args->system_clock_freq = 1000000000ULL;
+		return 0;
+	}
+	case AMDKFD_IOC_GET_TILE_CONFIG: {
+		struct kfd_ioctl_get_tile_config_args *args = arg;
+
+		args->num_tile_configs = 0;
+		args->num_macro_tile_configs = 0;
+		args->gb_addr_config = 0;
+		args->num_banks = 0;
+		args->num_ranks = 0;
+		return 0;
+	}
+	case AMDKFD_IOC_SET_XNACK_MODE: {
+		struct kfd_ioctl_set_xnack_mode_args *args = arg;
+
+		/* Negative values query the mode, XNACK is never on */
+		if (args->xnack_enabled > 0)
+			return -EPERM;
+		args->xnack_enabled = 0;
+		return 0;
+	}
+	case AMDKFD_IOC_SET_MEMORY_POLICY:
+	case AMDKFD_IOC_SET_SCRATCH_BACKING_VA:
+	case AMDKFD_IOC_SET_TRAP_HANDLER:
+	case AMDKFD_IOC_RUNTIME_ENABLE:
+		return 0;
+	default:
+		pr_debug("fake KFD: unsupported ioctl 0x%lx\n", request);
+		return -EINVAL;
+	}
+}
+
+int hsakmt_fake_kfd_ioctl(unsigned long request, void *arg)
+{
+	int ret;
+
+	pthread_mutex_lock(&fake.mutex);
+	ret = fake_ioctl(request, arg);
+	pthread_mutex_unlock(&fake.mutex);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
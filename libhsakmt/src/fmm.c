@@ -41,6 +41,7 @@
 #include <numa.h>
 #include <numaif.h>
 #include "rbtree.h"
+#include "vm_area.h"
 #include <amdgpu.h>
 
 #ifndef MPOL_F_STATIC_NODES
@@ -50,6 +51,16 @@
 #define MPOL_F_STATIC_NODES     (1 << 15)
 #endif
 
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT		26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB		(21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB		(30 << MAP_HUGE_SHIFT)
+#endif
+
 #define NON_VALID_GPU_ID 0
 
 #define INIT_MANAGEABLE_APERTURE(base_value, limit_value) {	\
@@ -57,7 +68,7 @@
 	.limit = (void *) limit_value,				\
 	.align = 0,						\
 	.guard_pages = 1,					\
-	.vm_ranges = NULL,					\
+	.vm_ranges = { .head = NULL },				\
 	.fmm_mutex = PTHREAD_MUTEX_INITIALIZER,			\
 	.is_cpu_accessible = false,				\
 	.ops = &reserved_aperture_ops				\
@@ -111,6 +122,8 @@ struct vm_object {
 	void *user_data;
 	/* Flag to indicate imported KFD buffer */
 	bool is_imported_kfd_bo;
+	/* Next object in the aperture's cache of removed objects */
+	struct vm_object *next_free;
 #ifdef SANITIZER_AMDGPU
 	int mmap_flags;
 	int mmap_fd;
@@ -119,14 +132,6 @@ struct vm_object {
 };
 typedef struct vm_object vm_object_t;
 
-struct vm_area {
-	void *start;
-	void *end;
-	struct vm_area *next;
-	struct vm_area *prev;
-};
-typedef struct vm_area vm_area_t;
-
 /* Memory manager for an aperture */
 typedef struct manageable_aperture manageable_aperture_t;
 
@@ -167,14 +172,53 @@ struct manageable_aperture {
 	void *limit;
 	uint64_t align;
 	uint32_t guard_pages;
-	vm_area_t *vm_ranges;
+	vm_area_list_t vm_ranges;
 	rbtree_t tree;
 	rbtree_t user_tree;
 	pthread_mutex_t fmm_mutex;
+	/* Sequence count for lockless lookups, odd while fmm_mutex is held */
+	uint32_t seq;
+	/* Removed objects are kept for reuse instead of being freed, so that
+	 * lockless readers never follow a pointer to freed memory
+	 */
+	vm_object_t *free_objects;
 	bool is_cpu_accessible;
 	const manageable_aperture_ops_t *ops;
 };
 
+/* Mutations of an aperture's objects and trees are serialized by its
+ * fmm_mutex. Lookups that only copy object state out can instead run
+ * without it and retry when the sequence count shows that they raced with
+ * a writer.
+ */
+static inline void aperture_lock(manageable_aperture_t *app)
+{
+	pthread_mutex_lock(&app->fmm_mutex);
+	__atomic_store_n(&app->seq, app->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void aperture_unlock(manageable_aperture_t *app)
+{
+	__atomic_store_n(&app->seq, app->seq + 1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&app->fmm_mutex);
+}
+
+/* Returns false if a writer holds the aperture */
+static inline bool aperture_read_begin(manageable_aperture_t *app,
+				       uint32_t *seq)
+{
+	*seq = __atomic_load_n(&app->seq, __ATOMIC_ACQUIRE);
+	return !(*seq & 1);
+}
+
+/* Returns true if everything read since aperture_read_begin is consistent */
+static inline bool aperture_read_end(manageable_aperture_t *app, uint32_t seq)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&app->seq, __ATOMIC_RELAXED) == seq;
+}
+
 typedef struct {
 	void *base;
 	void *limit;
@@ -316,23 +360,16 @@ static int _fmm_unmap_from_gpu_scratch(uint32_t gpu_id,
 				       void *address);
 static void print_device_id_array(uint32_t *device_id_array, uint32_t device_id_array_size);
 
-static vm_area_t *vm_create_and_init_area(void *start, void *end)
-{
-	vm_area_t *area = (vm_area_t *) malloc(sizeof(vm_area_t));
-
-	if (area) {
-		area->start = start;
-		area->end = end;
-		area->next = area->prev = NULL;
-	}
-
-	return area;
-}
-
-static vm_object_t *vm_create_and_init_object(void *start, uint64_t size,
+static vm_object_t *vm_create_and_init_object(manageable_aperture_t *app,
+					      void *start, uint64_t size,
 					      uint64_t handle, HsaMemFlags mflags)
 {
-	vm_object_t *object = (vm_object_t *) malloc(sizeof(vm_object_t));
+	vm_object_t *object = app->free_objects;
+
+	if (object)
+		app->free_objects = object->next_free;
+	else
+		object = (vm_object_t *) malloc(sizeof(vm_object_t));
 
 	if (object) {
 		object->start = start;
@@ -363,25 +400,6 @@ static vm_object_t *vm_create_and_init_object(void *start, uint64_t size,
 }
 
 
-static void vm_remove_area(manageable_aperture_t *app, vm_area_t *area)
-{
-	vm_area_t *next;
-	vm_area_t *prev;
-
-	next = area->next;
-	prev = area->prev;
-
-	if (!prev) /* The first element */
-		app->vm_ranges = next;
-	else
-		prev->next = next;
-
-	if (next) /* If not the last element */
-		next->prev = prev;
-
-	free(area);
-}
-
 static void vm_remove_object(manageable_aperture_t *app, vm_object_t *object)
 {
 	/* Free allocations inside the object */
@@ -403,40 +421,18 @@ static void vm_remove_object(manageable_aperture_t *app, vm_object_t *object)
 	if (object->userptr)
 		hsakmt_rbtree_delete(&app->user_tree, &object->user_node);
 
-	free(object);
-}
-
-static void vm_add_area_after(vm_area_t *after_this, vm_area_t *new_area)
-{
-	vm_area_t *next = after_this->next;
-
-	after_this->next = new_area;
-	new_area->next = next;
-
-	new_area->prev = after_this;
-	if (next)
-		next->prev = new_area;
+	object->next_free = app->free_objects;
+	app->free_objects = object;
 }
 
-static void vm_split_area(manageable_aperture_t *app, vm_area_t *area,
-				void *address, uint64_t MemorySizeInBytes)
+static void vm_free_removed_objects(manageable_aperture_t *app)
 {
-	/*
-	 * The existing area is split to: [area->start, address - 1]
-	 * and [address + MemorySizeInBytes, area->end]
-	 */
-	vm_area_t *new_area = vm_create_and_init_area(
-				VOID_PTR_ADD(address, MemorySizeInBytes),
-				area->end);
+	while (app->free_objects) {
+		vm_object_t *next = app->free_objects->next_free;
 
-	if (new_area == NULL) {
-		pr_err("[%s] Failed to create new area during split.", __func__);
-		return;
+		free(app->free_objects);
+		app->free_objects = next;
 	}
-	/* Shrink the existing area */
-	area->end = VOID_PTR_SUB(address, 1);
-
-	vm_add_area_after(area, new_area);
 }
 
 static vm_object_t *vm_find_object_by_address_userptr(manageable_aperture_t *app,
@@ -493,6 +489,7 @@ static vm_object_t *vm_find_object_by_address_userptr_range(manageable_aperture_
 	rbtree_key_t key = rbtree_key((unsigned long)address, 0);
 	rbtree_node_t *rn = rbtree_lookup_nearest(tree, &key, LKP_ALL, RIGHT);
 	rbtree_node_t *ln;
+	unsigned long count;
 	void *start;
 	uint64_t size;
 
@@ -517,7 +514,10 @@ static vm_object_t *vm_find_object_by_address_userptr_range(manageable_aperture_
 	if (!ln)
 		return NULL;
 
-	while (rn) {
+	/* A lockless walk racing with a writer may not reach ln */
+	count = rbtree_count(tree);
+
+	while (rn && rn != &tree->sentinel && count--) {
 		cur = vm_object_entry(rn, is_userptr);
 		if (is_userptr == 0) {
 			start = cur->start;
@@ -566,20 +566,6 @@ static vm_object_t *vm_find_object_by_userptr_range(manageable_aperture_t *app,
 	return vm_find_object_by_address_userptr_range(app, address, 1);
 }
 
-static vm_area_t *vm_find(manageable_aperture_t *app, void *address)
-{
-	vm_area_t *cur = app->vm_ranges;
-
-	/* Look up the appropriate address range containing the given address */
-	while (cur) {
-		if (cur->start <= address && cur->end >= address)
-			break;
-		cur = cur->next;
-	};
-
-	return cur; /* NULL if not found */
-}
-
 static bool aperture_is_valid(void *app_base, void *app_limit)
 {
 	if (app_base && app_limit && app_base < app_limit)
@@ -604,33 +590,15 @@ static void reserved_aperture_release(manageable_aperture_t *app,
 				      void *address,
 				      uint64_t MemorySizeInBytes)
 {
-	vm_area_t *area;
-	uint64_t SizeOfRegion;
+	int ret;
 
 	MemorySizeInBytes = vm_align_area_size(app, MemorySizeInBytes);
 
-	area = vm_find(app, address);
-	if (!area)
+	ret = hsakmt_vm_area_release(&app->vm_ranges, address, MemorySizeInBytes);
+	if (ret == -ENOENT)
 		return;
-
-	SizeOfRegion = VOID_PTRS_SUB(area->end, area->start) + 1;
-
-	/* check if block is whole region or part of it */
-	if (SizeOfRegion == MemorySizeInBytes) {
-		vm_remove_area(app, area);
-	} else if (SizeOfRegion > MemorySizeInBytes) {
-		/* shrink from the start */
-		if (area->start == address)
-			area->start =
-				VOID_PTR_ADD(area->start, MemorySizeInBytes);
-		/* shrink from the end */
-		else if (VOID_PTRS_SUB(area->end, address) + 1 ==
-				MemorySizeInBytes)
-			area->end = VOID_PTR_SUB(area->end, MemorySizeInBytes);
-		/* split the area */
-		else
-			vm_split_area(app, area, address, MemorySizeInBytes);
-	}
+	if (ret == -ENOMEM)
+		pr_err("[%s] Failed to create new area during split.", __func__);
 
 	if (app->is_cpu_accessible) {
 		void *mmap_ret;
@@ -675,8 +643,6 @@ static void *reserved_aperture_allocate_aligned(manageable_aperture_t *app,
 						uint64_t align)
 {
 	uint64_t offset = 0, orig_align = align;
-	vm_area_t *cur, *next;
-	void *start;
 
 	if (align < app->align)
 		align = app->align;
@@ -698,50 +664,8 @@ static void *reserved_aperture_allocate_aligned(manageable_aperture_t *app,
 
 	MemorySizeInBytes = vm_align_area_size(app, MemorySizeInBytes);
 
-	/* Find a big enough "hole" in the address space */
-	cur = NULL;
-	next = app->vm_ranges;
-	start = address ? address :
-		(void *)(ALIGN_UP((uint64_t)app->base, align) + offset);
-	while (next) {
-		if (next->start > start &&
-		    VOID_PTRS_SUB(next->start, start) >= MemorySizeInBytes)
-			break;
-
-		cur = next;
-		next = next->next;
-		if (!address)
-			start = (void *)(ALIGN_UP((uint64_t)cur->end + 1, align) + offset);
-	}
-	if (!next && VOID_PTRS_SUB(app->limit, start) + 1 < MemorySizeInBytes)
-		/* No hole found and not enough space after the last area */
-		return NULL;
-
-	if (cur && address && address < (void *)ALIGN_UP((uint64_t)cur->end + 1, align))
-		/* Required address is not free or overlaps */
-		return NULL;
-
-	if (cur && VOID_PTR_ADD(cur->end, 1) == start) {
-		/* extend existing area */
-		cur->end = VOID_PTR_ADD(start, MemorySizeInBytes-1);
-	} else {
-		vm_area_t *new_area;
-		/* create a new area between cur and next */
-		new_area = vm_create_and_init_area(start,
-				VOID_PTR_ADD(start, (MemorySizeInBytes - 1)));
-		if (!new_area)
-			return NULL;
-		new_area->next = next;
-		new_area->prev = cur;
-		if (cur)
-			cur->next = new_area;
-		else
-			app->vm_ranges = new_area;
-		if (next)
-			next->prev = new_area;
-	}
-
-	return start;
+	return hsakmt_vm_area_reserve(&app->vm_ranges, app->base, app->limit,
+				      address, MemorySizeInBytes, align, offset);
 }
 
 void *hsakmt_mmap_allocate_aligned(int prot, int flags, uint64_t size, uint64_t align,
@@ -893,7 +817,7 @@ static vm_object_t *aperture_allocate_object(manageable_aperture_t *app,
 	vm_object_t *new_object;
 
 	/* Allocate new object */
-	new_object = vm_create_and_init_object(new_address,
+	new_object = vm_create_and_init_object(app, new_address,
 					       MemorySizeInBytes,
 					       handle, mflags);
 	if (!new_object)
@@ -1143,12 +1067,12 @@ static vm_object_t *fmm_allocate_memory_object(uint32_t gpu_id, void *mem,
 	mflags = fmm_translate_ioc_to_hsa_flags(ioc_flags);
 
 	/* Allocate object */
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	vm_obj = aperture_allocate_object(aperture, mem, args.handle,
 				      MemorySizeInBytes, mflags);
 	if (!vm_obj)
 		goto err_object_allocation_failed;
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	if (mmap_offset)
 		*mmap_offset = args.mmap_offset;
@@ -1156,7 +1080,7 @@ static vm_object_t *fmm_allocate_memory_object(uint32_t gpu_id, void *mem,
 	return vm_obj;
 
 err_object_allocation_failed:
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	free_args.handle = args.handle;
 	if (hsakmt_ioctl(hsakmt_kfd_fd, AMDKFD_IOC_FREE_MEMORY_OF_GPU, &free_args)) {
 		pr_err("Failed to free GPU memory with handle: 0x%llx\n", free_args.handle);
@@ -1174,7 +1098,7 @@ static void aperture_print(aperture_t *app)
 
 static void manageable_aperture_print(manageable_aperture_t *app)
 {
-	vm_area_t *cur = app->vm_ranges;
+	vm_area_t *cur = app->vm_ranges.head;
 	rbtree_node_t *n = rbtree_node_any(&app->tree, LEFT);
 	vm_object_t *object;
 
@@ -1223,58 +1147,49 @@ void hsakmt_fmm_print(uint32_t gpu_id)
 }
 #endif
 
-/* vm_find_object - Find a VM object in any aperture
- *
- * @addr: VM address of the object
- * @size: size of the object, 0 means "don't care",
- *        UINT64_MAX means addr can match any address within the object
- * @out_aper: Aperture where the object was found
- *
- * Returns a pointer to the object if found, NULL otherwise. If an
- * object is found, this function returns with the
- * (*out_aper)->fmm_mutex locked.
+/* Returns the aperture that manages addr, NULL if there is none. userptr
+ * is set if addr can only be found as a userptr.
  */
-static vm_object_t *vm_find_object(const void *addr, uint64_t size,
-				   manageable_aperture_t **out_aper)
+static manageable_aperture_t *vm_find_aperture(const void *addr, bool *userptr)
 {
-	manageable_aperture_t *aper = NULL;
-	bool range = (size == UINT64_MAX);
-	bool userptr = false;
-	vm_object_t *obj = NULL;
 	uint32_t i;
 
+	*userptr = false;
+
 	for (i = 0; i < gpu_mem_count; i++)
 		if (gpu_mem[i].gpu_id != NON_VALID_GPU_ID &&
 		    addr >= gpu_mem[i].gpuvm_aperture.base &&
-		    addr <= gpu_mem[i].gpuvm_aperture.limit) {
-			aper = &gpu_mem[i].gpuvm_aperture;
-			break;
-		}
+		    addr <= gpu_mem[i].gpuvm_aperture.limit)
+			return &gpu_mem[i].gpuvm_aperture;
 
-	if (!aper) {
-		if ((addr >= mem_handle_aperture.base) &&
-			 (addr <= mem_handle_aperture.limit)){
-			 aper = &mem_handle_aperture;
-		}
-	}
+	if ((addr >= mem_handle_aperture.base) &&
+	    (addr <= mem_handle_aperture.limit))
+		return &mem_handle_aperture;
 
-	if (!aper) {
-		if (!svm.dgpu_aperture)
-			goto no_svm;
+	if (!svm.dgpu_aperture)
+		return NULL;
 
-		if ((addr >= svm.dgpu_aperture->base) &&
-		    (addr <= svm.dgpu_aperture->limit))
-			aper = svm.dgpu_aperture;
-		else if ((addr >= svm.dgpu_alt_aperture->base) &&
-			 (addr <= svm.dgpu_alt_aperture->limit))
-			aper = svm.dgpu_alt_aperture;
-		else {
-			aper = svm.dgpu_aperture;
-			userptr = true;
-		}
-	}
+	if ((addr >= svm.dgpu_aperture->base) &&
+	    (addr <= svm.dgpu_aperture->limit))
+		return svm.dgpu_aperture;
+	if ((addr >= svm.dgpu_alt_aperture->base) &&
+	    (addr <= svm.dgpu_alt_aperture->limit))
+		return svm.dgpu_alt_aperture;
+
+	*userptr = true;
+	return svm.dgpu_aperture;
+}
+
+/* Looks up addr in aper, see vm_find_object for size. Either the aperture
+ * is locked or the result is validated with aperture_read_end.
+ */
+static vm_object_t *vm_find_object_in_aperture(manageable_aperture_t *aper,
+					       const void *addr, uint64_t size,
+					       bool userptr)
+{
+	bool range = (size == UINT64_MAX);
+	vm_object_t *obj = NULL;
 
-	pthread_mutex_lock(&aper->fmm_mutex);
 	if (range) {
 		/* mmap_apertures can have userptrs in them. Try to
 		 * look up addresses as userptrs first to sort out any
@@ -1304,19 +1219,51 @@ static vm_object_t *vm_find_object(const void *addr, uint64_t size,
 		}
 	}
 
-no_svm:
+	return obj;
+}
+
+/* Looks up addr in the CPUVM aperture on APUs */
+static vm_object_t *vm_find_object_in_cpuvm(const void *addr, uint64_t size)
+{
+	if (size == UINT64_MAX)
+		return vm_find_object_by_address_range(&cpuvm_aperture, addr);
+
+	return vm_find_object_by_address(&cpuvm_aperture, addr, 0);
+}
+
+/* vm_find_object - Find a VM object in any aperture
+ *
+ * @addr: VM address of the object
+ * @size: size of the object, 0 means "don't care",
+ *        UINT64_MAX means addr can match any address within the object
+ * @out_aper: Aperture where the object was found
+ *
+ * Returns a pointer to the object if found, NULL otherwise. If an
+ * object is found, this function returns with the
+ * (*out_aper)->fmm_mutex locked.
+ */
+static vm_object_t *vm_find_object(const void *addr, uint64_t size,
+				   manageable_aperture_t **out_aper)
+{
+	manageable_aperture_t *aper;
+	bool userptr;
+	vm_object_t *obj = NULL;
+
+	aper = vm_find_aperture(addr, &userptr);
+	if (aper) {
+		aperture_lock(aper);
+		obj = vm_find_object_in_aperture(aper, addr, size, userptr);
+	}
+
 	if (!obj && !hsakmt_is_dgpu) {
 		/* On APUs try finding it in the CPUVM aperture */
 		if (aper)
-			pthread_mutex_unlock(&aper->fmm_mutex);
+			aperture_unlock(aper);
 
 		aper = &cpuvm_aperture;
 
-		pthread_mutex_lock(&aper->fmm_mutex);
-		if (range)
-			obj = vm_find_object_by_address_range(aper, addr);
-		else
-			obj = vm_find_object_by_address(aper, addr, 0);
+		aperture_lock(aper);
+		obj = vm_find_object_in_cpuvm(addr, size);
 	}
 
 	if (obj) {
@@ -1325,7 +1272,7 @@ no_svm:
 	}
 
 	if (aper)
-		pthread_mutex_unlock(&aper->fmm_mutex);
+		aperture_unlock(aper);
 	return NULL;
 }
 
@@ -1363,26 +1310,26 @@ static void fmm_release_scratch(uint32_t gpu_id)
 
 	if (hsakmt_is_dgpu) {
 		/* unmap and remove all remaining objects */
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 		while ((n = rbtree_node_any(&aperture->tree, MID))) {
 			obj = vm_object_entry(n, 0);
 
 			void *obj_addr = obj->start;
 
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+			aperture_unlock(aperture);
 
 			_fmm_unmap_from_gpu_scratch(gpu_id, aperture, obj_addr);
 
-			pthread_mutex_lock(&aperture->fmm_mutex);
+			aperture_lock(aperture);
 		}
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 
 		/* release address space */
-		pthread_mutex_lock(&svm.dgpu_aperture->fmm_mutex);
+		aperture_lock(svm.dgpu_aperture);
 		aperture_release_area(svm.dgpu_aperture,
 				      gpu_mem[gpu_mem_id].scratch_physical.base,
 				      size);
-		pthread_mutex_unlock(&svm.dgpu_aperture->fmm_mutex);
+		aperture_unlock(svm.dgpu_aperture);
 	} else
 		/* release address space */
 		munmap(gpu_mem[gpu_mem_id].scratch_physical.base, size);
@@ -1430,11 +1377,11 @@ void *hsakmt_fmm_allocate_scratch(uint32_t gpu_id, void *address, uint64_t Memor
 
 	/* Allocate address space for scratch backing, 64KB aligned */
 	if (hsakmt_is_dgpu) {
-		pthread_mutex_lock(&svm.dgpu_aperture->fmm_mutex);
+		aperture_lock(svm.dgpu_aperture);
 		mem = aperture_allocate_area_aligned(
 			svm.dgpu_aperture, address,
 			aligned_size, SCRATCH_ALIGN);
-		pthread_mutex_unlock(&svm.dgpu_aperture->fmm_mutex);
+		aperture_unlock(svm.dgpu_aperture);
 	} else {
 		if (address)
 			return NULL;
@@ -1474,9 +1421,9 @@ static void *__fmm_allocate_device(uint32_t gpu_id, void *address, uint64_t Memo
 		return NULL;
 
 	/* Allocate address space */
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	mem = aperture_allocate_area_aligned(aperture, address, MemorySizeInBytes, alignment);
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	if (!mem)
 		return NULL;
@@ -1491,9 +1438,9 @@ static void *__fmm_allocate_device(uint32_t gpu_id, void *address, uint64_t Memo
 		 * allocation of memory in device failed.
 		 * Release region in aperture
 		 */
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 		aperture_release_area(aperture, mem, MemorySizeInBytes);
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 
 		/* Assign NULL to mem to indicate failure to calling function */
 		mem = NULL;
@@ -1532,7 +1479,7 @@ static void *fmm_allocate_va(uint32_t gpu_id, void *address, uint64_t size,
 		return NULL;
 
 	/* Allocate address space */
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	mem = aperture_allocate_area_aligned(aperture, address, size, alignment);
 
 	if (mem) {
@@ -1544,7 +1491,7 @@ static void *fmm_allocate_va(uint32_t gpu_id, void *address, uint64_t size,
 		}
 	}
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	return mem;
 }
@@ -1603,11 +1550,11 @@ void *hsakmt_fmm_allocate_device(uint32_t gpu_id, uint32_t node_id, void *addres
 				    ioc_flags, alignment, &vm_obj);
 
 	if (mem && vm_obj) {
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 		/* Store memory allocation flags, not ioc flags */
 		vm_obj->mflags = mflags;
 		hsakmt_gpuid_to_nodeid(gpu_id, &vm_obj->node_id);
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 	}
 
 	/* if alloc vram-only not mmap to cpu vm since no va */
@@ -1664,10 +1611,10 @@ void *hsakmt_fmm_allocate_doorbell(uint32_t gpu_id, uint64_t MemorySizeInBytes,
 		mflags.ui32.NonPaged = 1;
 		mflags.ui32.HostAccess = 1;
 
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 		vm_obj->mflags = mflags;
 		hsakmt_gpuid_to_nodeid(gpu_id, &vm_obj->node_id);
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 	}
 
 	if (mem) {
@@ -1684,6 +1631,104 @@ void *hsakmt_fmm_allocate_doorbell(uint32_t gpu_id, uint64_t MemorySizeInBytes,
 	return mem;
 }
 
+static int fmm_mbind_failed(void *mem, HsaMemFlags mflags)
+{
+	/* If applcation is running inside docker, still return
+	 * ok because docker seccomp blocks mbind by default,
+	 * otherwise application cannot allocate system memory.
+	 */
+	if (errno == EPERM) {
+		pr_err_once("mbind is blocked by seccomp\n");
+
+		return 0;
+	}
+
+	/* Ignore mbind failure if no memory available on node */
+	if (!mflags.ui32.NoSubstitute)
+		return 0;
+
+	pr_warn_once("Failed to set NUMA policy for %p: %s\n", mem,
+		     strerror(errno));
+
+	return -EFAULT;
+}
+
+/* Node set for NUMAInterleave allocations, parsed once from
+ * HSA_NUMA_INTERLEAVE_NODES (numactl syntax, e.g. "0-3" or "0,2").
+ * Defaults to all nodes the process is allowed to allocate from.
+ */
+static struct bitmask *interleave_nodes;
+static pthread_once_t interleave_nodes_once = PTHREAD_ONCE_INIT;
+
+static void fmm_init_interleave_nodes(void)
+{
+	char *nodes_str = getenv("HSA_NUMA_INTERLEAVE_NODES");
+
+	if (nodes_str) {
+		interleave_nodes = numa_parse_nodestring(nodes_str);
+		if (!interleave_nodes)
+			pr_warn("Ignoring invalid HSA_NUMA_INTERLEAVE_NODES \"%s\"\n",
+				nodes_str);
+	}
+
+	if (!interleave_nodes)
+		interleave_nodes = numa_get_mems_allowed();
+}
+
+static int fmm_interleave_mem(void *mem, uint64_t SizeInBytes,
+			      HsaMemFlags mflags)
+{
+	long r;
+
+	if (numa_available() == -1)
+		return 0;
+
+	pthread_once(&interleave_nodes_once, fmm_init_interleave_nodes);
+
+	/* Nothing to interleave across */
+	if (!interleave_nodes || numa_bitmask_weight(interleave_nodes) <= 1)
+		return 0;
+
+	r = mbind(mem, SizeInBytes, MPOL_INTERLEAVE | MPOL_F_STATIC_NODES,
+		  interleave_nodes->maskp, interleave_nodes->size + 1, 0);
+
+	return r ? fmm_mbind_failed(mem, mflags) : 0;
+}
+
+/* Map anonymous memory at the fixed address mem, backed by the page
+ * size requested in mflags. Explicit huge pages come from the hugetlb
+ * pool, falling back from 1GB to 2MB pages and then to transparent huge
+ * pages on regular anonymous memory, so a request only fails if a plain
+ * mapping would fail too. mem must be aligned to the requested page size.
+ */
+static void *fmm_map_host_pages(void *mem, uint64_t size, int prot,
+				HsaMemFlags mflags)
+{
+	int map_flags = MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED;
+	uint32_t page_size;
+	void *ret;
+
+	for (page_size = mflags.ui32.PageSize; page_size >= HSA_PAGE_SIZE_2MB;
+	     page_size--) {
+		int huge_flags = MAP_HUGETLB | (page_size == HSA_PAGE_SIZE_1GB ?
+						MAP_HUGE_1GB : MAP_HUGE_2MB);
+
+		ret = mmap(mem, size, prot, map_flags | huge_flags, -1, 0);
+		if (ret != MAP_FAILED)
+			return ret;
+
+		pr_debug("No %u KB huge pages for %p size 0x%lx: %s\n",
+			 hsakmt_PageSizeFromFlags(page_size) >> 10, mem, size,
+			 strerror(errno));
+	}
+
+	ret = mmap(mem, size, prot, map_flags, -1, 0);
+	if (ret != MAP_FAILED && mflags.ui32.PageSize >= HSA_PAGE_SIZE_2MB)
+		madvise(ret, size, MADV_HUGEPAGE);
+
+	return ret;
+}
+
 static void *fmm_allocate_host_cpu(void *address, uint64_t MemorySizeInBytes,
 				HsaMemFlags mflags)
 {
@@ -1700,21 +1745,46 @@ static void *fmm_allocate_host_cpu(void *address, uint64_t MemorySizeInBytes,
 	if (!mflags.ui32.ReadOnly)
 		mmap_prot |= PROT_WRITE;
 
-	/* mmap will return a pointer with alignment equal to
-	 * sysconf(_SC_PAGESIZE).
-	 */
-	mem = mmap(NULL, MemorySizeInBytes, mmap_prot,
-			MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+	if (mflags.ui32.PageSize >= HSA_PAGE_SIZE_2MB) {
+		/* Reserve address space aligned to the huge page size first,
+		 * so the fallback to transparent huge pages can use them too.
+		 */
+		mem = hsakmt_mmap_allocate_aligned(PROT_NONE,
+				MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE,
+				MemorySizeInBytes,
+				hsakmt_PageSizeFromFlags(mflags.ui32.PageSize),
+				0, NULL, (void *)UINTPTR_MAX);
+		if (!mem)
+			return NULL;
 
-	if (mem == MAP_FAILED)
+		if (fmm_map_host_pages(mem, MemorySizeInBytes, mmap_prot,
+				       mflags) == MAP_FAILED) {
+			munmap(mem, MemorySizeInBytes);
+			return NULL;
+		}
+	} else {
+		/* mmap will return a pointer with alignment equal to
+		 * sysconf(_SC_PAGESIZE).
+		 */
+		mem = mmap(NULL, MemorySizeInBytes, mmap_prot,
+				MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+		if (mem == MAP_FAILED)
+			return NULL;
+	}
+
+	if (mflags.ui32.NUMAInterleave &&
+	    fmm_interleave_mem(mem, MemorySizeInBytes, mflags)) {
+		munmap(mem, MemorySizeInBytes);
 		return NULL;
+	}
 
-	pthread_mutex_lock(&cpuvm_aperture.fmm_mutex);
+	aperture_lock(&cpuvm_aperture);
 	vm_obj = aperture_allocate_object(&cpuvm_aperture, mem, 0,
 				      MemorySizeInBytes, mflags);
 	if (vm_obj)
 		vm_obj->node_id = 0; /* APU systems only have one CPU node */
-	pthread_mutex_unlock(&cpuvm_aperture.fmm_mutex);
+	aperture_unlock(&cpuvm_aperture);
 
 	return mem;
 }
@@ -1733,6 +1803,9 @@ static int bind_mem_to_numa(uint32_t node_id, void *mem,
 	if (mflags.ui32.NoNUMABind)
 		return 0;
 
+	if (mflags.ui32.NUMAInterleave)
+		return fmm_interleave_mem(mem, SizeInBytes, mflags);
+
 	if (numa_available() == -1)
 		return 0;
 
@@ -1760,28 +1833,7 @@ static int bind_mem_to_numa(uint32_t node_id, void *mem,
 	r = mbind(mem, SizeInBytes, mode, node_mask->maskp, num_node + 1, 0);
 	numa_bitmask_free(node_mask);
 
-	if (r) {
-		/* If applcation is running inside docker, still return
-		 * ok because docker seccomp blocks mbind by default,
-		 * otherwise application cannot allocate system memory.
-		 */
-		if (errno == EPERM) {
-			pr_err_once("mbind is blocked by seccomp\n");
-
-			return 0;
-		}
-
-		/* Ignore mbind failure if no memory available on node */
-		if (!mflags.ui32.NoSubstitute)
-			return 0;
-
-		pr_warn_once("Failed to set NUMA policy for %p: %s\n", mem,
-			     strerror(errno));
-
-		return -EFAULT;
-	}
-
-	return 0;
+	return r ? fmm_mbind_failed(mem, mflags) : 0;
 }
 
 static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *address,
@@ -1789,19 +1841,21 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 {
 	manageable_aperture_t *aperture;
 	vm_object_t *vm_obj = NULL;
-	int flags = MADV_DONTFORK;
 	uint64_t mmap_offset;
 	int32_t gpu_drm_fd;
 	uint32_t ioc_flags;
 	uint32_t preferred_gpu_id;
 	int gpu_mem_id = 0; /* default to g_first_gpu_mem */
 	uint64_t size;
+	uint64_t page_size;
 	void *mem;
 
-	/* set madvise flags to HUGEPAGE always for 2MB pages */
-	if (MemorySizeInBytes >= (2 * 1024 * 1024))
-		flags |= MADV_HUGEPAGE;
-
+	/* Huge pages need a matching GPU VA alignment, both for the CPU
+	 * mapping and for the GPU to use huge page fragments.
+	 */
+	page_size = hsakmt_PageSizeFromFlags(mflags.ui32.PageSize);
+	if (mflags.ui32.PageSize >= HSA_PAGE_SIZE_2MB && alignment < page_size)
+		alignment = page_size;
 
 	if (!g_first_gpu_mem)
 		return NULL;
@@ -1838,15 +1892,15 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 	 */
 	if (!mflags.ui32.NonPaged && svm.userptr_for_paged_mem) {
 		/* Allocate address space */
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 		mem = aperture_allocate_area_aligned(aperture, address, size, alignment);
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		if (!mem)
 			return NULL;
 
 		/* Map anonymous pages */
-		if (mmap(mem, MemorySizeInBytes, PROT_READ | PROT_WRITE,
-			 MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0)
+		if (fmm_map_host_pages(mem, MemorySizeInBytes,
+				       PROT_READ | PROT_WRITE, mflags)
 		    == MAP_FAILED)
 			goto out_release_area;
 
@@ -1858,7 +1912,12 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 		 * fork. This avoids MMU notifiers and evictions due to user
 		 * memory mappings on fork.
 		 */
-		madvise(mem, MemorySizeInBytes, flags);
+		madvise(mem, MemorySizeInBytes, MADV_DONTFORK);
+
+		/* Use transparent huge pages for anything of at least 2MB */
+		if (mflags.ui32.PageSize < HSA_PAGE_SIZE_2MB &&
+		    MemorySizeInBytes >= (2 * 1024 * 1024))
+			madvise(mem, MemorySizeInBytes, MADV_HUGEPAGE);
 
 		/* Create userptr BO */
 		mmap_offset = (uint64_t)mem;
@@ -1895,21 +1954,21 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 
 	if (mem && vm_obj) {
 		/* Store memory allocation flags, not ioc flags */
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 		vm_obj->mflags = mflags;
 		vm_obj->node_id = node_id;
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 	}
 
 	return mem;
 
 out_release_area:
 	/* Release address space */
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	if (mem) {
 		aperture_release_area(aperture, mem, size);
 	}
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	return NULL;
 }
@@ -1935,12 +1994,12 @@ static int __fmm_release(vm_object_t *object, manageable_aperture_t *aperture)
 	if (!object)
 		return -EINVAL;
 
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 
 	if (object->userptr) {
 		object->registration_count--;
 		if (object->registration_count > 0) {
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+			aperture_unlock(aperture);
 			return 0;
 		}
 	}
@@ -1952,14 +2011,14 @@ static int __fmm_release(vm_object_t *object, manageable_aperture_t *aperture)
 	 */
 	args.handle = object->handle;
 	if (args.handle && hsakmt_ioctl(hsakmt_kfd_fd, AMDKFD_IOC_FREE_MEMORY_OF_GPU, &args)) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		return -errno;
 	}
 
 	aperture_release_area(aperture, object->start, object->size);
 	vm_remove_object(aperture, object);
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	return 0;
 }
 
@@ -1991,10 +2050,10 @@ HSAKMT_STATUS hsakmt_fmm_release(void *address)
 
 		size = object->size;
 		vm_remove_object(&cpuvm_aperture, object);
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		munmap(address, size);
 	} else {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 
 		if (__fmm_release(object, aperture))
 			return HSAKMT_STATUS_ERROR;
@@ -2094,6 +2153,15 @@ int hsakmt_open_drm_render_device(int minor)
 	if (drm_render_fds[index])
 		return drm_render_fds[index];
 
+#ifdef HSAKMT_FAKE_KFD
+	if (hsakmt_fake_kfd) {
+		fd = hsakmt_fake_kfd_open_render(minor);
+		if (fd >= 0)
+			drm_render_fds[index] = fd;
+		return fd;
+	}
+#endif
+
 	sprintf(path, "/dev/dri/renderD%d", minor);
 	fd = open(path, O_RDWR | O_CLOEXEC);
 	if (fd < 0) {
@@ -2358,12 +2426,16 @@ static void fmm_init_rbtree(void)
 	if (once++ == 0) {
 		rbtree_init(&svm.apertures[SVM_DEFAULT].tree);
 		rbtree_init(&svm.apertures[SVM_DEFAULT].user_tree);
+		hsakmt_vm_area_list_init(&svm.apertures[SVM_DEFAULT].vm_ranges);
 		rbtree_init(&svm.apertures[SVM_COHERENT].tree);
 		rbtree_init(&svm.apertures[SVM_COHERENT].user_tree);
+		hsakmt_vm_area_list_init(&svm.apertures[SVM_COHERENT].vm_ranges);
 		rbtree_init(&cpuvm_aperture.tree);
 		rbtree_init(&cpuvm_aperture.user_tree);
+		hsakmt_vm_area_list_init(&cpuvm_aperture.vm_ranges);
 		rbtree_init(&mem_handle_aperture.tree);
 		rbtree_init(&mem_handle_aperture.user_tree);
+		hsakmt_vm_area_list_init(&mem_handle_aperture.vm_ranges);
 	}
 
 	while (i--) {
@@ -2397,10 +2469,10 @@ static void *map_mmio(uint32_t node_id, uint32_t gpu_id, int mmap_fd)
 	mflags.Value = 0;
 	mflags.ui32.NonPaged = 1;
 	mflags.ui32.HostAccess = 1;
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	vm_obj->mflags = mflags;
 	vm_obj->node_id = node_id;
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	/* Map for CPU access*/
 	ret = mmap(mem, PAGE_SIZE,
@@ -2618,12 +2690,14 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 			gpu_mem[gpu_mem_count].scratch_physical.align = PAGE_SIZE;
 			gpu_mem[gpu_mem_count].scratch_physical.ops = &reserved_aperture_ops;
 			pthread_mutex_init(&gpu_mem[gpu_mem_count].scratch_physical.fmm_mutex, NULL);
+			hsakmt_vm_area_list_init(&gpu_mem[gpu_mem_count].scratch_physical.vm_ranges);
 
 			gpu_mem[gpu_mem_count].gpuvm_aperture.align =
 				get_vm_alignment(props.DeviceId);
 			gpu_mem[gpu_mem_count].gpuvm_aperture.guard_pages = guardPages;
 			gpu_mem[gpu_mem_count].gpuvm_aperture.ops = &reserved_aperture_ops;
 			pthread_mutex_init(&gpu_mem[gpu_mem_count].gpuvm_aperture.fmm_mutex, NULL);
+			hsakmt_vm_area_list_init(&gpu_mem[gpu_mem_count].gpuvm_aperture.vm_ranges);
 
 			if (!g_first_gpu_mem)
 				g_first_gpu_mem = &gpu_mem[gpu_mem_count];
@@ -2847,8 +2921,11 @@ void hsakmt_fmm_destroy_process_apertures(void)
 {
 	release_mmio();
 	if (gpu_mem) {
-		while (gpu_mem_count-- > 0)
+		while (gpu_mem_count-- > 0) {
 			free(gpu_mem[gpu_mem_count].usable_peer_id_array);
+			vm_free_removed_objects(&gpu_mem[gpu_mem_count].gpuvm_aperture);
+			vm_free_removed_objects(&gpu_mem[gpu_mem_count].scratch_physical);
+		}
 		free(gpu_mem);
 		gpu_mem = NULL;
 	}
@@ -3000,7 +3077,7 @@ static HSAKMT_STATUS _fmm_map_to_gpu(manageable_aperture_t *aperture,
 	int ret_ioctl;
 
 	if (!obj)
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 
 	object = obj;
 	if (!object) {
@@ -3076,7 +3153,7 @@ exit_ok:
 err_object_not_found:
 err_map_failed:
 	if (!obj)
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 
 	return ret;
 }
@@ -3201,13 +3278,13 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu(void *address, uint64_t size, uint64_t *gpuv
 
 	/* allocate VA only */
 	if (object && object->handle == 0) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 	}
 
 	/* allocate buffer only, should be mapped by GEM API */
         if (aperture && (aperture == &mem_handle_aperture)) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 	}
 
@@ -3227,7 +3304,7 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu(void *address, uint64_t size, uint64_t *gpuv
 	}
 
 	if (object)
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 	return ret;
 }
 
@@ -3253,7 +3330,7 @@ static int _fmm_unmap_from_gpu(manageable_aperture_t *aperture, void *address,
 	HSAuint32 page_offset = (HSAint64)address & (PAGE_SIZE - 1);
 
 	if (!obj)
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 
 	/* Find the object to retrieve the handle */
 	object = obj;
@@ -3305,7 +3382,7 @@ static int _fmm_unmap_from_gpu(manageable_aperture_t *aperture, void *address,
 
 out:
 	if (!obj)
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 	return ret;
 }
 
@@ -3326,7 +3403,7 @@ static int _fmm_unmap_from_gpu_scratch(uint32_t gpu_id,
 	if (!hsakmt_is_dgpu)
 		return 0; /* Nothing to do on APU */
 
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 
 	/* Find the object to retrieve the handle and size */
 	object = vm_find_object_by_address(aperture, address, 0);
@@ -3337,7 +3414,7 @@ static int _fmm_unmap_from_gpu_scratch(uint32_t gpu_id,
 
 	if (!object->mapped_device_id_array ||
 			object->mapped_device_id_array_size == 0) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		return 0;
 	}
 
@@ -3364,13 +3441,13 @@ static int _fmm_unmap_from_gpu_scratch(uint32_t gpu_id,
 	if (ret)
 		goto err;
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	/* free object in scratch backing aperture */
 	return __fmm_release(object, aperture);
 
 err:
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	return ret;
 }
 
@@ -3402,7 +3479,7 @@ int hsakmt_fmm_unmap_from_gpu(void *address)
 	else
 		ret = _fmm_unmap_from_gpu(aperture, address, NULL, 0, object);
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	return ret;
 }
@@ -3442,14 +3519,14 @@ bool hsakmt_fmm_get_handle(void *address, uint64_t *handle)
 	if (!aperture)
 		return false;
 
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	/* Find the object to retrieve the handle */
 	object = vm_find_object_by_address(aperture, address, 0);
 	if (object && handle) {
 		*handle = object->handle;
 		found = true;
 	}
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 
 	return found;
@@ -3494,7 +3571,7 @@ static HSAKMT_STATUS fmm_register_user_memory(void *addr,
 	if (!obj)
 		return HSAKMT_STATUS_ERROR;
 
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 
 	/* catch the race condition where some other thread added the userptr
 	 * object already after the vm_find_object.
@@ -3510,7 +3587,7 @@ static HSAKMT_STATUS fmm_register_user_memory(void *addr,
 		obj->user_node.key = rbtree_key((unsigned long)addr, size);
 		hsakmt_rbtree_insert(&aperture->user_tree, &obj->user_node);
 	}
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	if (exist_obj)
 		__fmm_release(obj, aperture);
@@ -3563,14 +3640,14 @@ HSAKMT_STATUS hsakmt_fmm_register_memory(void *address, uint64_t size_in_bytes,
 		if (gpu_id_array_size == 0)
 			return HSAKMT_STATUS_SUCCESS;
 		aperture = svm.dgpu_aperture;
-		pthread_mutex_lock(&aperture->fmm_mutex);
+		aperture_lock(aperture);
 		/* fall through for registered device ID array setup */
 	} else if (object->userptr) {
 		/* Update an existing userptr */
 		++object->registration_count;
 	} else {
 		/* Not a userptr when we are expecting one */
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		return HSAKMT_STATUS_INVALID_HANDLE;
 	}
 	/* Successful vm_find_object returns with aperture locked */
@@ -3581,14 +3658,14 @@ HSAKMT_STATUS hsakmt_fmm_register_memory(void *address, uint64_t size_in_bytes,
 			|| memcmp(object->registered_device_id_array,
 					gpu_id_array, gpu_id_array_size)) {
 			pr_err("Cannot change nodes in a registered addr.\n");
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+			aperture_unlock(aperture);
 			return HSAKMT_STATUS_MEMORY_ALREADY_REGISTERED;
 		} else {
 			/* Delete the new array, keep the existing one. */
 			if (gpu_id_array)
 				free(gpu_id_array);
 
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+			aperture_unlock(aperture);
 			return HSAKMT_STATUS_SUCCESS;
 		}
 	}
@@ -3606,7 +3683,7 @@ HSAKMT_STATUS hsakmt_fmm_register_memory(void *address, uint64_t size_in_bytes,
 		}
 	}
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	return HSAKMT_STATUS_SUCCESS;
 }
 
@@ -3669,11 +3746,11 @@ HSAKMT_STATUS hsakmt_fmm_register_graphics_handle(HSAuint64 GraphicsResourceHand
 	}
 	if (!aperture_is_valid(aperture->base, aperture->limit))
 		goto error_free_metadata;
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	mem = aperture_allocate_area_aligned(aperture, NULL, infoArgs.size,
 					     IMAGE_ALIGN);
 	if (!mem) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		goto error_free_metadata;
 	}
 
@@ -3687,7 +3764,7 @@ HSAKMT_STATUS hsakmt_fmm_register_graphics_handle(HSAuint64 GraphicsResourceHand
 	importArgs.dmabuf_fd = GraphicsResourceHandle;
 	r = hsakmt_ioctl(hsakmt_kfd_fd, AMDKFD_IOC_IMPORT_DMABUF, (void *)&importArgs);
 	if (r) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		goto error_release_aperture;
 	}
 
@@ -3702,7 +3779,7 @@ HSAKMT_STATUS hsakmt_fmm_register_graphics_handle(HSAuint64 GraphicsResourceHand
 		obj->registered_device_id_array_size = gpu_id_array_size;
 		hsakmt_gpuid_to_nodeid(infoArgs.gpu_id, &obj->node_id);
 	}
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	if (!obj)
 		goto error_release_buffer;
 
@@ -3744,7 +3821,7 @@ HSAKMT_STATUS hsakmt_fmm_export_dma_buf_fd(void *MemoryAddress,
 	if (!aperture)
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	obj = vm_find_object_by_address_range(aperture, MemoryAddress);
 	if (obj) {
 		offset = VOID_PTRS_SUB(MemoryAddress, obj->start);
@@ -3756,7 +3833,7 @@ HSAKMT_STATUS hsakmt_fmm_export_dma_buf_fd(void *MemoryAddress,
 			obj = NULL;
 		}
 	}
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	if (!obj)
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 
@@ -3790,9 +3867,9 @@ HSAKMT_STATUS hsakmt_fmm_share_memory(void *MemoryAddress,
 	if (!aperture)
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	obj = vm_find_object_by_address(aperture, MemoryAddress, 0);
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	if (!obj)
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 
@@ -3854,7 +3931,7 @@ HSAKMT_STATUS hsakmt_fmm_register_shared_memory(const HsaSharedMemoryHandle *Sha
 	if (!aperture)
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 
-	pthread_mutex_lock(&aperture->fmm_mutex);
+	aperture_lock(aperture);
 	reservedMem = aperture_allocate_area(aperture, NULL,
 			(SizeInPages << PAGE_SHIFT));
 	if (!reservedMem) {
@@ -3889,14 +3966,14 @@ HSAKMT_STATUS hsakmt_fmm_register_shared_memory(const HsaSharedMemoryHandle *Sha
 			goto err_free_mem;
 		}
 		obj->node_id = gpu_mem[gpu_mem_id].node_id;
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 
 		ret = fmm_map_to_cpu(reservedMem, (SizeInPages << PAGE_SHIFT),
 				true, gpu_mem[gpu_mem_id].drm_render_fd,
 				importArgs.mmap_offset);
 
 		if (ret == MAP_FAILED) {
-			pthread_mutex_lock(&aperture->fmm_mutex);
+			aperture_lock(aperture);
 			vm_remove_object(aperture, obj);
 			aperture_release_area(aperture, reservedMem,
 					(SizeInPages << PAGE_SHIFT));
@@ -3904,7 +3981,7 @@ HSAKMT_STATUS hsakmt_fmm_register_shared_memory(const HsaSharedMemoryHandle *Sha
 			goto err_free_mem_handle;
 		}
 	} else {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 	}
 
 	*MemoryAddress = reservedMem;
@@ -3925,7 +4002,7 @@ err_free_mem_handle:
 err_free_mem:
 err_free_buffer:
 err_import:
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	return err;
 }
 
@@ -3948,7 +4025,7 @@ HSAKMT_STATUS hsakmt_fmm_deregister_memory(void *address)
 		/* API-allocated system memory on APUs, deregistration
 		 * is a no-op
 		 */
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		return HSAKMT_STATUS_SUCCESS;
 	}
 
@@ -3957,14 +4034,14 @@ HSAKMT_STATUS hsakmt_fmm_deregister_memory(void *address)
 		 * buffer. Deregistering imported graphics buffers or
 		 * userptrs means releasing the BO.
 		 */
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		__fmm_release(object, aperture);
 		return HSAKMT_STATUS_SUCCESS;
 	}
 
 	if (!object->registered_device_id_array ||
 		object->registered_device_id_array_size <= 0) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+		aperture_unlock(aperture);
 		return HSAKMT_STATUS_MEMORY_NOT_REGISTERED;
 	}
 
@@ -3978,61 +4055,43 @@ HSAKMT_STATUS hsakmt_fmm_deregister_memory(void *address)
 	object->registered_node_id_array = NULL;
 	object->registration_count = 0;
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 
 	return HSAKMT_STATUS_SUCCESS;
 }
 
-/*
- * This function unmaps all nodes on current mapped nodes list that are not included on nodes_to_map
- * and maps nodes_to_map
- */
-
-HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
-		uint32_t *nodes_to_map, uint64_t num_of_nodes,
-		uint64_t *gpuvm_address)
+/* Checks that object in aperture can be mapped to GPU nodes explicitly */
+static HSAKMT_STATUS vm_object_check_mappable(manageable_aperture_t *aperture,
+					      vm_object_t *object)
 {
-	manageable_aperture_t *aperture = NULL;
-	vm_object_t *object;
-	uint32_t i;
-	uint32_t *registered_node_id_array, registered_node_id_array_size;
-	HSAKMT_STATUS ret;
-	int retcode = 0;
-
-	if (!num_of_nodes || !nodes_to_map || !address)
-		return HSAKMT_STATUS_INVALID_PARAMETER;
-
-	object = vm_find_object(address, size, &aperture);
-	if (!object && !hsakmt_is_svm_api_supported)
-		return HSAKMT_STATUS_ERROR;
-	/* Successful vm_find_object returns with aperture locked */
-
 	/* allocates VA only */
-	if (object && object->handle == 0) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+	if (object && object->handle == 0)
 		return HSAKMT_STATUS_INVALID_PARAMETER;
-	}
 
 	/* allocates buffer only, should be mapped by GEM API */
-	if (aperture == &mem_handle_aperture) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+	if (aperture == &mem_handle_aperture)
 		return HSAKMT_STATUS_INVALID_PARAMETER;
-	}
 
 	/* APU memory is not supported by this function */
 	if (aperture &&
-	   (aperture == &cpuvm_aperture || !aperture->is_cpu_accessible)) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
+	   (aperture == &cpuvm_aperture || !aperture->is_cpu_accessible))
 		return HSAKMT_STATUS_ERROR;
-	}
 
-	if ((hsakmt_is_svm_api_supported && !object) || object->userptr) {
-		retcode = _fmm_map_to_gpu_userptr(address, size, gpuvm_address,
-				object, nodes_to_map, num_of_nodes * sizeof(uint32_t));
-		if (object)
-			pthread_mutex_unlock(&aperture->fmm_mutex);
-		return retcode ? HSAKMT_STATUS_ERROR : HSAKMT_STATUS_SUCCESS;
-	}
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+/* Unmaps object from all nodes that are not included on nodes_to_map and
+ * maps it to the remaining ones. Assumes that the aperture is locked.
+ */
+static HSAKMT_STATUS vm_object_map_to_nodes(manageable_aperture_t *aperture,
+					    void *address, uint64_t size,
+					    vm_object_t *object,
+					    uint32_t *nodes_to_map,
+					    uint64_t num_of_nodes)
+{
+	uint32_t i;
+	uint32_t *registered_node_id_array, registered_node_id_array_size;
+	HSAKMT_STATUS ret;
 
 	/* Verify that all nodes to map are registered already */
 	registered_node_id_array = all_gpu_id_array;
@@ -4044,10 +4103,8 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 	}
 	for (i = 0 ; i < num_of_nodes; i++) {
 		if (!id_in_array(nodes_to_map[i], registered_node_id_array,
-					registered_node_id_array_size)) {
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+					registered_node_id_array_size))
 			return HSAKMT_STATUS_ERROR;
-		}
 	}
 
 	/* Unmap buffer from all nodes that have this buffer mapped that are not included on nodes_to_map array */
@@ -4069,10 +4126,8 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 					temp_node_id_array,
 					temp_node_id_array_size,
 					object);
-			if (ret != HSAKMT_STATUS_SUCCESS) {
-				pthread_mutex_unlock(&aperture->fmm_mutex);
+			if (ret != HSAKMT_STATUS_SUCCESS)
 				return ret;
-			}
 		}
 	}
 
@@ -4090,35 +4145,255 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 				nodes_to_map[i];
 	}
 
-	if (map_node_id_array_size)
-		retcode = _fmm_map_to_gpu(aperture, address, size, object,
-				map_node_id_array,
-				map_node_id_array_size * sizeof(uint32_t));
+	if (map_node_id_array_size &&
+	    _fmm_map_to_gpu(aperture, address, size, object,
+			    map_node_id_array,
+			    map_node_id_array_size * sizeof(uint32_t)))
+		return HSAKMT_STATUS_ERROR;
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+/*
+ * This function unmaps all nodes on current mapped nodes list that are not included on nodes_to_map
+ * and maps nodes_to_map
+ */
+
+HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
+		uint32_t *nodes_to_map, uint64_t num_of_nodes,
+		uint64_t *gpuvm_address)
+{
+	manageable_aperture_t *aperture = NULL;
+	vm_object_t *object;
+	HSAKMT_STATUS ret;
+	int retcode = 0;
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	if (!num_of_nodes || !nodes_to_map || !address)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
 
-	if (retcode != 0)
+	object = vm_find_object(address, size, &aperture);
+	if (!object && !hsakmt_is_svm_api_supported)
 		return HSAKMT_STATUS_ERROR;
+	/* Successful vm_find_object returns with aperture locked */
 
-	return HSAKMT_STATUS_SUCCESS;
+	ret = vm_object_check_mappable(aperture, object);
+	if (ret != HSAKMT_STATUS_SUCCESS) {
+		if (object)
+			aperture_unlock(aperture);
+		return ret;
+	}
+
+	if ((hsakmt_is_svm_api_supported && !object) || object->userptr) {
+		retcode = _fmm_map_to_gpu_userptr(address, size, gpuvm_address,
+				object, nodes_to_map, num_of_nodes * sizeof(uint32_t));
+		if (object)
+			aperture_unlock(aperture);
+		return retcode ? HSAKMT_STATUS_ERROR : HSAKMT_STATUS_SUCCESS;
+	}
+
+	ret = vm_object_map_to_nodes(aperture, address, size, object,
+				     nodes_to_map, num_of_nodes);
+
+	aperture_unlock(aperture);
+
+	return ret;
 }
 
-HSAKMT_STATUS hsakmt_fmm_get_mem_info(const void *address, HsaPointerInfo *info)
+/* Batch entry sorted by aperture and address, so that each aperture is
+ * locked once and repeated ranges of the same object are adjacent
+ */
+struct fmm_batch_entry {
+	manageable_aperture_t *aperture;
+	HsaMemMapRange *range;
+	bool userptr;
+	bool done;
+};
+
+static int fmm_batch_entry_cmp(const void *a, const void *b)
 {
+	const struct fmm_batch_entry *ea = a, *eb = b;
+
+	if (ea->aperture != eb->aperture)
+		return ea->aperture < eb->aperture ? -1 : 1;
+	if (ea->range->MemoryAddress != eb->range->MemoryAddress)
+		return ea->range->MemoryAddress < eb->range->MemoryAddress ? -1 : 1;
+	return 0;
+}
+
+static struct fmm_batch_entry *fmm_batch_sort(HsaMemMapRange *ranges,
+					      uint64_t num_ranges)
+{
+	struct fmm_batch_entry *entries;
+	uint64_t i;
+
+	entries = malloc(num_ranges * sizeof(*entries));
+	if (!entries)
+		return NULL;
+
+	for (i = 0; i < num_ranges; i++) {
+		entries[i].range = &ranges[i];
+		entries[i].aperture = vm_find_aperture(ranges[i].MemoryAddress,
+						       &entries[i].userptr);
+		entries[i].done = false;
+	}
+	qsort(entries, num_ranges, sizeof(*entries), fmm_batch_entry_cmp);
+
+	return entries;
+}
+
+/* Maps every range to exactly nodes_to_map. Ranges of buffer objects are
+ * handled with one lock per aperture, and an object listed several times
+ * is only mapped once. Any other range takes the same path as
+ * hsakmt_fmm_map_to_gpu_nodes.
+ */
+HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes_batch(HsaMemMapRange *ranges,
+		uint64_t num_ranges, uint32_t *nodes_to_map,
+		uint64_t num_of_nodes)
+{
+	struct fmm_batch_entry *entries;
+	manageable_aperture_t *locked = NULL;
+	vm_object_t *object, *prev_object = NULL;
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS, prev_status = ret;
+	uint64_t i;
+
+	if (!num_of_nodes || !nodes_to_map)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	entries = fmm_batch_sort(ranges, num_ranges);
+	if (!entries)
+		return HSAKMT_STATUS_NO_MEMORY;
+
+	for (i = 0; i < num_ranges; i++) {
+		HsaMemMapRange *range = entries[i].range;
+
+		range->AlternateVAGPU = 0;
+		if (!entries[i].aperture || entries[i].userptr ||
+		    !range->MemoryAddress)
+			continue;
+
+		if (entries[i].aperture != locked) {
+			if (locked)
+				aperture_unlock(locked);
+			locked = entries[i].aperture;
+			aperture_lock(locked);
+			prev_object = NULL;
+		}
+
+		object = vm_find_object_in_aperture(locked,
+						    range->MemoryAddress,
+						    range->MemorySizeInBytes,
+						    false);
+		if (!object || object->userptr)
+			continue;
+
+		entries[i].done = true;
+		if (object == prev_object) {
+			range->Status = prev_status;
+			continue;
+		}
+
+		range->Status = vm_object_check_mappable(locked, object);
+		if (range->Status == HSAKMT_STATUS_SUCCESS)
+			range->Status = vm_object_map_to_nodes(locked,
+						range->MemoryAddress,
+						range->MemorySizeInBytes,
+						object, nodes_to_map,
+						num_of_nodes);
+		prev_object = object;
+		prev_status = range->Status;
+	}
+	if (locked)
+		aperture_unlock(locked);
+
+	for (i = 0; i < num_ranges; i++) {
+		HsaMemMapRange *range = entries[i].range;
+
+		if (!entries[i].done)
+			range->Status = hsakmt_fmm_map_to_gpu_nodes(
+						range->MemoryAddress,
+						range->MemorySizeInBytes,
+						nodes_to_map, num_of_nodes,
+						&range->AlternateVAGPU);
+
+		if (range->Status != HSAKMT_STATUS_SUCCESS &&
+		    ret == HSAKMT_STATUS_SUCCESS)
+			ret = range->Status;
+	}
+
+	free(entries);
+
+	return ret;
+}
+
+/* Unmaps every range from all GPUs. Ranges of buffer objects are handled
+ * with one lock per aperture, any other range takes the same path as
+ * hsakmt_fmm_unmap_from_gpu.
+ */
+HSAKMT_STATUS hsakmt_fmm_unmap_from_gpu_batch(HsaMemMapRange *ranges,
+					      uint64_t num_ranges)
+{
+	struct fmm_batch_entry *entries;
+	manageable_aperture_t *locked = NULL;
+	vm_object_t *object;
 	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
-	uint32_t i;
-	manageable_aperture_t *aperture;
-	vm_object_t *vm_obj;
+	uint64_t i;
 
-	memset(info, 0, sizeof(HsaPointerInfo));
+	entries = fmm_batch_sort(ranges, num_ranges);
+	if (!entries)
+		return HSAKMT_STATUS_NO_MEMORY;
 
-	vm_obj = vm_find_object(address, UINT64_MAX, &aperture);
-	if (!vm_obj) {
-		info->Type = HSA_POINTER_UNKNOWN;
-		return HSAKMT_STATUS_ERROR;
+	for (i = 0; i < num_ranges; i++) {
+		HsaMemMapRange *range = entries[i].range;
+
+		if (!entries[i].aperture || !range->MemoryAddress)
+			continue;
+
+		if (entries[i].aperture != locked) {
+			if (locked)
+				aperture_unlock(locked);
+			locked = entries[i].aperture;
+			aperture_lock(locked);
+		}
+
+		object = vm_find_object_in_aperture(locked,
+						    range->MemoryAddress, 0,
+						    entries[i].userptr);
+		if (!object)
+			continue;
+
+		entries[i].done = true;
+		range->Status = _fmm_unmap_from_gpu(locked,
+						range->MemoryAddress, NULL, 0,
+						object) ?
+			HSAKMT_STATUS_ERROR : HSAKMT_STATUS_SUCCESS;
 	}
-	/* Successful vm_find_object returns with the aperture locked */
+	if (locked)
+		aperture_unlock(locked);
+
+	for (i = 0; i < num_ranges; i++) {
+		HsaMemMapRange *range = entries[i].range;
+
+		/* Unmapping NULL succeeds as in hsaKmtUnmapMemoryToGPU */
+		if (!entries[i].done)
+			range->Status = range->MemoryAddress &&
+				hsakmt_fmm_unmap_from_gpu(range->MemoryAddress) ?
+				HSAKMT_STATUS_ERROR : HSAKMT_STATUS_SUCCESS;
+
+		if (range->Status != HSAKMT_STATUS_SUCCESS &&
+		    ret == HSAKMT_STATUS_SUCCESS)
+			ret = range->Status;
+	}
+
+	free(entries);
+
+	return ret;
+}
 
+/* Copies the state of vm_obj to info. Returns false if the node ID arrays
+ * have not been created yet, which requires the aperture lock.
+ */
+static bool vm_object_get_info(const vm_object_t *vm_obj, HsaPointerInfo *info)
+{
 	if (vm_obj->is_imported_kfd_bo)
 		info->Type = HSA_POINTER_REGISTERED_SHARED;
 	else if (vm_obj->metadata)
@@ -4136,55 +4411,150 @@ HSAKMT_STATUS hsakmt_fmm_get_mem_info(const void *address, HsaPointerInfo *info)
 	/* registered nodes */
 	info->NRegisteredNodes =
 		vm_obj->registered_device_id_array_size / sizeof(uint32_t);
-	if (info->NRegisteredNodes && !vm_obj->registered_node_id_array) {
+	info->RegisteredNodes = vm_obj->registered_node_id_array;
+	/* mapped nodes */
+	info->NMappedNodes =
+		vm_obj->mapped_device_id_array_size / sizeof(uint32_t);
+	info->MappedNodes = vm_obj->mapped_node_id_array;
+	info->UserData = vm_obj->user_data;
+
+	info->MemFlags = vm_obj->mflags;
+
+	if (info->Type == HSA_POINTER_REGISTERED_USER) {
+		info->CPUAddress = vm_obj->userptr;
+		info->SizeInBytes = vm_obj->userptr_size;
+		info->GPUAddress += ((HSAuint64)info->CPUAddress & (PAGE_SIZE - 1));
+	} else if (info->Type == HSA_POINTER_ALLOCATED) {
+		info->CPUAddress = vm_obj->start;
+	}
+
+	return (!info->NRegisteredNodes || info->RegisteredNodes) &&
+		(!info->NMappedNodes || info->MappedNodes);
+}
+
+/* Looks up address in aper without taking its lock. Returns 1 if the
+ * object was found and copied to info, 0 if there is no such object and
+ * -1 if the lookup raced with a writer or needs the lock.
+ */
+static int vm_object_get_info_lockless(manageable_aperture_t *aper,
+				       const void *address, bool userptr,
+				       HsaPointerInfo *info)
+{
+	vm_object_t *vm_obj;
+	bool complete = true;
+	uint32_t seq;
+
+	if (!aperture_read_begin(aper, &seq))
+		return -1;
+
+	if (aper == &cpuvm_aperture)
+		vm_obj = vm_find_object_in_cpuvm(address, UINT64_MAX);
+	else
+		vm_obj = vm_find_object_in_aperture(aper, address, UINT64_MAX,
+						    userptr);
+	if (vm_obj)
+		complete = vm_object_get_info(vm_obj, info);
+
+	if (!aperture_read_end(aper, seq) || !complete)
+		return -1;
+
+	return vm_obj ? 1 : 0;
+}
+
+static int fmm_get_mem_info_lockless(const void *address, HsaPointerInfo *info)
+{
+	manageable_aperture_t *aper;
+	bool userptr;
+	int ret;
+
+	aper = vm_find_aperture(address, &userptr);
+	if (aper) {
+		ret = vm_object_get_info_lockless(aper, address, userptr, info);
+		if (ret)
+			return ret;
+	}
+
+	if (hsakmt_is_dgpu)
+		return 0;
+
+	/* On APUs try finding it in the CPUVM aperture */
+	return vm_object_get_info_lockless(&cpuvm_aperture, address, false,
+					   info);
+}
+
+/* Number of lockless pointer lookups before falling back to the lock */
+#define FMM_LOCKLESS_LOOKUP_TRIES 4
+
+HSAKMT_STATUS hsakmt_fmm_get_mem_info(const void *address, HsaPointerInfo *info)
+{
+	uint32_t i;
+	manageable_aperture_t *aperture;
+	vm_object_t *vm_obj;
+	int found = -1;
+
+	for (i = 0; i < FMM_LOCKLESS_LOOKUP_TRIES && found < 0; i++)
+		found = fmm_get_mem_info_lockless(address, info);
+
+	if (found > 0)
+		return HSAKMT_STATUS_SUCCESS;
+
+	memset(info, 0, sizeof(HsaPointerInfo));
+
+	if (found == 0) {
+		info->Type = HSA_POINTER_UNKNOWN;
+		return HSAKMT_STATUS_ERROR;
+	}
+
+	vm_obj = vm_find_object(address, UINT64_MAX, &aperture);
+	if (!vm_obj) {
+		info->Type = HSA_POINTER_UNKNOWN;
+		return HSAKMT_STATUS_ERROR;
+	}
+	/* Successful vm_find_object returns with the aperture locked */
+
+	if (vm_obj->registered_device_id_array_size &&
+	    !vm_obj->registered_node_id_array) {
+		uint32_t n = vm_obj->registered_device_id_array_size /
+			sizeof(uint32_t);
+
 		vm_obj->registered_node_id_array = (uint32_t *)
 			(uint32_t *)malloc(vm_obj->registered_device_id_array_size);
 		if (!vm_obj->registered_node_id_array) {
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+			aperture_unlock(aperture);
 			return HSAKMT_STATUS_NO_MEMORY;
 		}
 		/* vm_obj->registered_node_id_array allocated here will be
 		 * freed whenever the registration is changed (deregistration or
 		 * register to new nodes) or the memory being freed
 		 */
-		for (i = 0; i < info->NRegisteredNodes; i++)
+		for (i = 0; i < n; i++)
 			hsakmt_gpuid_to_nodeid(vm_obj->registered_device_id_array[i],
 				&vm_obj->registered_node_id_array[i]);
 	}
-	info->RegisteredNodes = vm_obj->registered_node_id_array;
-	/* mapped nodes */
-	info->NMappedNodes =
-		vm_obj->mapped_device_id_array_size / sizeof(uint32_t);
-	if (info->NMappedNodes && !vm_obj->mapped_node_id_array) {
+	if (vm_obj->mapped_device_id_array_size &&
+	    !vm_obj->mapped_node_id_array) {
+		uint32_t n = vm_obj->mapped_device_id_array_size /
+			sizeof(uint32_t);
+
 		vm_obj->mapped_node_id_array =
 			(uint32_t *)malloc(vm_obj->mapped_device_id_array_size);
 		if (!vm_obj->mapped_node_id_array) {
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+			aperture_unlock(aperture);
 			return HSAKMT_STATUS_NO_MEMORY;
 		}
 		/* vm_obj->mapped_node_id_array allocated here will be
 		 * freed whenever the mapping is changed (unmapped or map
 		 * to new nodes) or memory being freed
 		 */
-		for (i = 0; i < info->NMappedNodes; i++)
+		for (i = 0; i < n; i++)
 			hsakmt_gpuid_to_nodeid(vm_obj->mapped_device_id_array[i],
 				&vm_obj->mapped_node_id_array[i]);
 	}
-	info->MappedNodes = vm_obj->mapped_node_id_array;
-	info->UserData = vm_obj->user_data;
-
-	info->MemFlags = vm_obj->mflags;
 
-	if (info->Type == HSA_POINTER_REGISTERED_USER) {
-		info->CPUAddress = vm_obj->userptr;
-		info->SizeInBytes = vm_obj->userptr_size;
-		info->GPUAddress += ((HSAuint64)info->CPUAddress & (PAGE_SIZE - 1));
-	} else if (info->Type == HSA_POINTER_ALLOCATED) {
-		info->CPUAddress = vm_obj->start;
-	}
+	vm_object_get_info(vm_obj, info);
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
-	return ret;
+	aperture_unlock(aperture);
+	return HSAKMT_STATUS_SUCCESS;
 }
 
 #ifdef SANITIZER_AMDGPU
@@ -4211,7 +4581,7 @@ HSAKMT_STATUS hsakmt_fmm_replace_asan_header_page(void* address)
 			ret = HSAKMT_STATUS_ERROR;
 	}
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	return ret;
 }
 
@@ -4240,7 +4610,7 @@ HSAKMT_STATUS hsakmt_fmm_return_asan_header_page(void* address)
 			ret = HSAKMT_STATUS_ERROR;
 	}
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	return ret;
 }
 #endif
@@ -4256,7 +4626,7 @@ HSAKMT_STATUS hsakmt_fmm_set_mem_user_data(const void *mem, void *usr_data)
 
 	vm_obj->user_data = usr_data;
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	aperture_unlock(aperture);
 	return HSAKMT_STATUS_SUCCESS;
 }
 
@@ -4268,12 +4638,9 @@ static void fmm_clear_aperture(manageable_aperture_t *app)
 
 	while ((n = rbtree_node_any(&app->tree, MID)))
 		vm_remove_object(app, vm_object_entry(n, 0));
+	vm_free_removed_objects(app);
 
-	while (app->vm_ranges) {
-		void *next_range = app->vm_ranges->next;
-		vm_remove_area(app, app->vm_ranges);
-		app->vm_ranges = next_range;
-	}
+	hsakmt_vm_area_list_clear(&app->vm_ranges);
 }
 
 /* This is a special funcion that should be called only from the child process
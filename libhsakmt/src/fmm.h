@@ -97,6 +97,10 @@ HSAKMT_STATUS hsakmt_fmm_register_shared_memory(const HsaSharedMemoryHandle *Sha
 					 uint32_t gpu_id_array_size);
 HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 		uint32_t *nodes_to_map, uint64_t num_of_nodes, uint64_t *gpuvm_address);
+HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes_batch(HsaMemMapRange *ranges,
+		uint64_t num_ranges, uint32_t *nodes_to_map, uint64_t num_of_nodes);
+HSAKMT_STATUS hsakmt_fmm_unmap_from_gpu_batch(HsaMemMapRange *ranges,
+		uint64_t num_ranges);
 
 int hsakmt_open_drm_render_device(int minor);
 void *hsakmt_mmap_allocate_aligned(int prot, int flags, uint64_t size, uint64_t align,
@@ -9,6 +9,11 @@ int hsakmt_ioctl(int fd, unsigned long request, void *arg)
 {
 	int ret;
 
+#ifdef HSAKMT_FAKE_KFD
+	if (hsakmt_fake_kfd)
+		return hsakmt_fake_kfd_ioctl(request, arg);
+#endif
+
 	do {
 		ret = ioctl(fd, request, arg);
 	} while (ret == -1 && (errno == EINTR || errno == EAGAIN));
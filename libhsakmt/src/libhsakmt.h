@@ -220,6 +220,13 @@ uint32_t *hsakmt_convert_queue_ids(HSAuint32 NumQueues, HSA_QUEUEID *Queues);
 
 extern int hsakmt_ioctl(int fd, unsigned long request, void *arg);
 
+/* User space KFD simulator, only built with HSAKMT_FAKE_KFD */
+extern bool hsakmt_fake_kfd;
+bool hsakmt_fake_kfd_enabled(void);
+int hsakmt_fake_kfd_open(void);
+int hsakmt_fake_kfd_open_render(int minor);
+int hsakmt_fake_kfd_ioctl(unsigned long request, void *arg);
+
 /* Void pointer arithmetic (or remove -Wpointer-arith to allow void pointers arithmetic) */
 #define VOID_PTR_ADD32(ptr,n) (void*)((uint32_t*)(ptr) + n)/*ptr + offset*/
 #define VOID_PTR_ADD(ptr,n) (void*)((uint8_t*)(ptr) + n)/*ptr + offset*/
@@ -550,6 +550,64 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtMapMemoryToGPUNodes(void *MemoryAddress,
 	return ret;
 }
 
+HSAKMT_STATUS HSAKMTAPI hsaKmtMapMemoryToGPUNodesBatch(HsaMemMapRange *Ranges,
+						       HSAuint64 NumberOfRanges,
+						       HsaMemMapFlags MemMapFlags,
+						       HSAuint64 NumberOfNodes,
+						       HSAuint32 *NodeArray)
+{
+	uint32_t *gpu_id_array;
+	HSAKMT_STATUS ret;
+	HSAuint64 i;
+
+	CHECK_KFD_OPEN();
+
+	pr_debug("[%s] %lu ranges number of nodes %lu\n",
+		__func__, NumberOfRanges, NumberOfNodes);
+
+	if (!Ranges || !NumberOfRanges)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	if (!hsakmt_is_dgpu && NumberOfNodes == 1) {
+		ret = HSAKMT_STATUS_SUCCESS;
+		for (i = 0; i < NumberOfRanges; i++) {
+			Ranges[i].Status = hsaKmtMapMemoryToGPU(
+						Ranges[i].MemoryAddress,
+						Ranges[i].MemorySizeInBytes,
+						&Ranges[i].AlternateVAGPU);
+			if (Ranges[i].Status != HSAKMT_STATUS_SUCCESS &&
+			    ret == HSAKMT_STATUS_SUCCESS)
+				ret = Ranges[i].Status;
+		}
+		return ret;
+	}
+
+	ret = hsakmt_validate_nodeid_array(&gpu_id_array,
+				NumberOfNodes, NodeArray);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
+	ret = hsakmt_fmm_map_to_gpu_nodes_batch(Ranges, NumberOfRanges,
+		gpu_id_array, NumberOfNodes);
+
+	free(gpu_id_array);
+
+	return ret;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtUnmapMemoryToGPUBatch(HsaMemMapRange *Ranges,
+						    HSAuint64 NumberOfRanges)
+{
+	CHECK_KFD_OPEN();
+
+	pr_debug("[%s] %lu ranges\n", __func__, NumberOfRanges);
+
+	if (!Ranges || !NumberOfRanges)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	return hsakmt_fmm_unmap_from_gpu_batch(Ranges, NumberOfRanges);
+}
+
 HSAKMT_STATUS HSAKMTAPI hsaKmtUnmapMemoryToGPU(void *MemoryAddress)
 {
 	CHECK_KFD_OPEN();
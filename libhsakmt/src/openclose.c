@@ -175,6 +175,11 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtOpenKFD(void)
 			goto open_failed;
 
 		if (hsakmt_kfd_fd < 0) {
+#ifdef HSAKMT_FAKE_KFD
+			if (hsakmt_fake_kfd_enabled())
+				fd = hsakmt_fake_kfd_open();
+			else
+#endif
 			fd = open(kfd_device_name, O_RDWR | O_CLOEXEC);
 
 			if (fd == -1) {
@@ -28,9 +28,11 @@
 #include "rbtree.h"
 
 static inline void rbtree_left_rotate(rbtree_node_t **root,
-		rbtree_node_t *sentinel, rbtree_node_t *node);
+		rbtree_node_t *sentinel, rbtree_node_t *node,
+		rbtree_augment_pt augment);
 static inline void rbtree_right_rotate(rbtree_node_t **root,
-		rbtree_node_t *sentinel, rbtree_node_t *node);
+		rbtree_node_t *sentinel, rbtree_node_t *node,
+		rbtree_augment_pt augment);
 
 static void
 hsakmt_rbtree_insert_value(rbtree_node_t *temp, rbtree_node_t *node,
@@ -50,11 +52,14 @@ hsakmt_rbtree_insert_value(rbtree_node_t *temp, rbtree_node_t *node,
 		temp = *p;
 	}
 
-	*p = node;
-	node->parent = temp;
-	node->left = sentinel;
-	node->right = sentinel;
+	/* a reused node may still be read by a stale lockless walk, and the
+	 * node is complete before it is reachable
+	 */
+	rbt_set_link(node->parent, temp);
+	rbt_set_link(node->left, sentinel);
+	rbt_set_link(node->right, sentinel);
 	rbt_red(node);
+	rbt_set_link(*p, node);
 }
 
 
@@ -68,17 +73,21 @@ hsakmt_rbtree_insert(rbtree_t *tree, rbtree_node_t *node)
 	root = &tree->root;
 	sentinel = &tree->sentinel;
 
+	__atomic_store_n(&tree->count, tree->count + 1, __ATOMIC_RELAXED);
+
 	if (*root == sentinel) {
-		node->parent = NULL;
-		node->left = sentinel;
-		node->right = sentinel;
+		rbt_set_link(node->parent, NULL);
+		rbt_set_link(node->left, sentinel);
+		rbt_set_link(node->right, sentinel);
 		rbt_black(node);
-		*root = node;
+		rbt_set_link(*root, node);
+		hsakmt_rbtree_augment_path(tree, node);
 
 		return;
 	}
 
 	hsakmt_rbtree_insert_value(*root, node, sentinel);
+	hsakmt_rbtree_augment_path(tree, node);
 
 	/* re-balance tree */
 
@@ -96,12 +105,13 @@ hsakmt_rbtree_insert(rbtree_t *tree, rbtree_node_t *node)
 			} else {
 				if (node == node->parent->right) {
 					node = node->parent;
-					rbtree_left_rotate(root, sentinel, node);
+					rbtree_left_rotate(root, sentinel, node, tree->augment);
 				}
 
 				rbt_black(node->parent);
 				rbt_red(node->parent->parent);
-				rbtree_right_rotate(root, sentinel, node->parent->parent);
+				rbtree_right_rotate(root, sentinel, node->parent->parent,
+						tree->augment);
 			}
 
 		} else {
@@ -116,12 +126,13 @@ hsakmt_rbtree_insert(rbtree_t *tree, rbtree_node_t *node)
 			} else {
 				if (node == node->parent->left) {
 					node = node->parent;
-					rbtree_right_rotate(root, sentinel, node);
+					rbtree_right_rotate(root, sentinel, node, tree->augment);
 				}
 
 				rbt_black(node->parent);
 				rbt_red(node->parent->parent);
-				rbtree_left_rotate(root, sentinel, node->parent->parent);
+				rbtree_left_rotate(root, sentinel, node->parent->parent,
+						tree->augment);
 			}
 		}
 	}
@@ -141,6 +152,8 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 	root = &tree->root;
 	sentinel = &tree->sentinel;
 
+	__atomic_store_n(&tree->count, tree->count - 1, __ATOMIC_RELAXED);
+
 	if (node->left == sentinel) {
 		temp = node->right;
 		subst = node;
@@ -160,8 +173,10 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 	}
 
 	if (subst == *root) {
-		*root = temp;
+		rbt_set_link(*root, temp);
 		rbt_black(temp);
+		if (temp != sentinel)
+			rbt_set_link(temp->parent, NULL);
 
 		return;
 	}
@@ -169,50 +184,53 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 	red = rbt_is_red(subst);
 
 	if (subst == subst->parent->left) {
-		subst->parent->left = temp;
+		rbt_set_link(subst->parent->left, temp);
 
 	} else {
-		subst->parent->right = temp;
+		rbt_set_link(subst->parent->right, temp);
 	}
 
 	if (subst == node) {
 
-		temp->parent = subst->parent;
+		rbt_set_link(temp->parent, subst->parent);
 
 	} else {
 
 		if (subst->parent == node) {
-			temp->parent = subst;
+			rbt_set_link(temp->parent, subst);
 
 		} else {
-			temp->parent = subst->parent;
+			rbt_set_link(temp->parent, subst->parent);
 		}
 
-		subst->left = node->left;
-		subst->right = node->right;
-		subst->parent = node->parent;
+		rbt_set_link(subst->left, node->left);
+		rbt_set_link(subst->right, node->right);
+		rbt_set_link(subst->parent, node->parent);
 		rbt_copy_color(subst, node);
 
 		if (node == *root) {
-			*root = subst;
+			rbt_set_link(*root, subst);
 
 		} else {
 			if (node == node->parent->left) {
-				node->parent->left = subst;
+				rbt_set_link(node->parent->left, subst);
 			} else {
-				node->parent->right = subst;
+				rbt_set_link(node->parent->right, subst);
 			}
 		}
 
 		if (subst->left != sentinel) {
-			subst->left->parent = subst;
+			rbt_set_link(subst->left->parent, subst);
 		}
 
 		if (subst->right != sentinel) {
-			subst->right->parent = subst;
+			rbt_set_link(subst->right->parent, subst);
 		}
 	}
 
+	/* temp->parent is the deepest node whose subtree changed */
+	hsakmt_rbtree_augment_path(tree, temp->parent);
+
 	if (red) {
 		return;
 	}
@@ -227,7 +245,7 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 			if (rbt_is_red(w)) {
 				rbt_black(w);
 				rbt_red(temp->parent);
-				rbtree_left_rotate(root, sentinel, temp->parent);
+				rbtree_left_rotate(root, sentinel, temp->parent, tree->augment);
 				w = temp->parent->right;
 			}
 
@@ -239,14 +257,14 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 				if (rbt_is_black(w->right)) {
 					rbt_black(w->left);
 					rbt_red(w);
-					rbtree_right_rotate(root, sentinel, w);
+					rbtree_right_rotate(root, sentinel, w, tree->augment);
 					w = temp->parent->right;
 				}
 
 				rbt_copy_color(w, temp->parent);
 				rbt_black(temp->parent);
 				rbt_black(w->right);
-				rbtree_left_rotate(root, sentinel, temp->parent);
+				rbtree_left_rotate(root, sentinel, temp->parent, tree->augment);
 				temp = *root;
 			}
 
@@ -256,7 +274,7 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 			if (rbt_is_red(w)) {
 				rbt_black(w);
 				rbt_red(temp->parent);
-				rbtree_right_rotate(root, sentinel, temp->parent);
+				rbtree_right_rotate(root, sentinel, temp->parent, tree->augment);
 				w = temp->parent->left;
 			}
 
@@ -268,14 +286,14 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 				if (rbt_is_black(w->left)) {
 					rbt_black(w->right);
 					rbt_red(w);
-					rbtree_left_rotate(root, sentinel, w);
+					rbtree_left_rotate(root, sentinel, w, tree->augment);
 					w = temp->parent->left;
 				}
 
 				rbt_copy_color(w, temp->parent);
 				rbt_black(temp->parent);
 				rbt_black(w->left);
-				rbtree_right_rotate(root, sentinel, temp->parent);
+				rbtree_right_rotate(root, sentinel, temp->parent, tree->augment);
 				temp = *root;
 			}
 		}
@@ -285,118 +303,154 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 }
 
 
+void
+hsakmt_rbtree_augment_path(rbtree_t *tree, rbtree_node_t *node)
+{
+	if (!tree->augment)
+		return;
+
+	for ( ;; ) {
+		tree->augment(node, &tree->sentinel);
+
+		if (node == tree->root) {
+			return;
+		}
+
+		node = node->parent;
+	}
+}
+
+
 static inline void
 rbtree_left_rotate(rbtree_node_t **root, rbtree_node_t *sentinel,
-		rbtree_node_t *node)
+		rbtree_node_t *node, rbtree_augment_pt augment)
 {
 	rbtree_node_t  *temp;
 
 	temp = node->right;
-	node->right = temp->left;
+	rbt_set_link(node->right, temp->left);
 
 	if (temp->left != sentinel) {
-		temp->left->parent = node;
+		rbt_set_link(temp->left->parent, node);
 	}
 
-	temp->parent = node->parent;
+	rbt_set_link(temp->parent, node->parent);
 
 	if (node == *root) {
-		*root = temp;
+		rbt_set_link(*root, temp);
 
 	} else if (node == node->parent->left) {
-		node->parent->left = temp;
+		rbt_set_link(node->parent->left, temp);
 
 	} else {
-		node->parent->right = temp;
+		rbt_set_link(node->parent->right, temp);
 	}
 
-	temp->left = node;
-	node->parent = temp;
+	rbt_set_link(temp->left, node);
+	rbt_set_link(node->parent, temp);
+
+	if (augment) {
+		augment(node, sentinel);
+		augment(temp, sentinel);
+	}
 }
 
 
 static inline void
 rbtree_right_rotate(rbtree_node_t **root, rbtree_node_t *sentinel,
-		rbtree_node_t *node)
+		rbtree_node_t *node, rbtree_augment_pt augment)
 {
 	rbtree_node_t  *temp;
 
 	temp = node->left;
-	node->left = temp->right;
+	rbt_set_link(node->left, temp->right);
 
 	if (temp->right != sentinel) {
-		temp->right->parent = node;
+		rbt_set_link(temp->right->parent, node);
 	}
 
-	temp->parent = node->parent;
+	rbt_set_link(temp->parent, node->parent);
 
 	if (node == *root) {
-		*root = temp;
+		rbt_set_link(*root, temp);
 
 	} else if (node == node->parent->right) {
-		node->parent->right = temp;
+		rbt_set_link(node->parent->right, temp);
 
 	} else {
-		node->parent->left = temp;
+		rbt_set_link(node->parent->left, temp);
 	}
 
-	temp->right = node;
-	node->parent = temp;
+	rbt_set_link(temp->right, node);
+	rbt_set_link(node->parent, temp);
+
+	if (augment) {
+		augment(node, sentinel);
+		augment(temp, sentinel);
+	}
 }
 
 
 rbtree_node_t *
 hsakmt_rbtree_next(rbtree_t *tree, rbtree_node_t *node)
 {
-	rbtree_node_t  *root, *sentinel, *parent;
+	rbtree_node_t  *root, *sentinel, *parent, *child;
+	int depth;
 
 	sentinel = &tree->sentinel;
 
-	if (node->right != sentinel) {
-		return rbtree_min(node->right, sentinel);
+	child = rbt_link(node->right);
+	if (child != sentinel) {
+		return rbtree_min(child, sentinel);
 	}
 
-	root = tree->root;
+	root = rbt_link(tree->root);
 
-	for ( ;; ) {
-		parent = node->parent;
+	for (depth = 0; depth < RBTREE_MAX_DEPTH; depth++) {
+		parent = rbt_link(node->parent);
 
-		if (node == root) {
+		if (node == root || !parent) {
 			return NULL;
 		}
 
-		if (node == parent->left) {
+		if (node == rbt_link(parent->left)) {
 			return parent;
 		}
 
 		node = parent;
 	}
+
+	return NULL;
 }
 
 rbtree_node_t *
 hsakmt_rbtree_prev(rbtree_t *tree, rbtree_node_t *node)
 {
-	rbtree_node_t  *root, *sentinel, *parent;
+	rbtree_node_t  *root, *sentinel, *parent, *child;
+	int depth;
 
 	sentinel = &tree->sentinel;
 
-	if (node->left != sentinel) {
-		return rbtree_max(node->left, sentinel);
+	child = rbt_link(node->left);
+	if (child != sentinel) {
+		return rbtree_max(child, sentinel);
 	}
 
-	root = tree->root;
+	root = rbt_link(tree->root);
 
-	for ( ;; ) {
-		parent = node->parent;
+	for (depth = 0; depth < RBTREE_MAX_DEPTH; depth++) {
+		parent = rbt_link(node->parent);
 
-		if (node == root) {
+		if (node == root || !parent) {
 			return NULL;
 		}
 
-		if (node == parent->right) {
+		if (node == rbt_link(parent->right)) {
 			return parent;
 		}
 
 		node = parent;
 	}
+
+	return NULL;
 }
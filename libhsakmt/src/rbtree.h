@@ -53,17 +53,31 @@ struct rbtree_node_s {
 
 typedef struct rbtree_s rbtree_t;
 
+/* Recomputes the augmented data of node from its children */
+typedef void (*rbtree_augment_pt)(rbtree_node_t *node,
+		rbtree_node_t *sentinel);
+
 struct rbtree_s {
 	rbtree_node_t   *root;
 	rbtree_node_t   sentinel;
+	rbtree_augment_pt augment;
+	/* Number of nodes, bounds walks by lockless readers */
+	unsigned long   count;
 };
 
 #define rbtree_init(tree)				\
 	rbtree_sentinel_init(&(tree)->sentinel);	\
-	(tree)->root = &(tree)->sentinel;
+	(tree)->root = &(tree)->sentinel;		\
+	(tree)->augment = NULL;				\
+	(tree)->count = 0;
+
+#define rbtree_init_augmented(tree, fn)			\
+	rbtree_init(tree)				\
+	(tree)->augment = (fn);
 
 void hsakmt_rbtree_insert(rbtree_t *tree, rbtree_node_t *node);
 void hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node);
+void hsakmt_rbtree_augment_path(rbtree_t *tree, rbtree_node_t *node);
 rbtree_node_t *hsakmt_rbtree_prev(rbtree_t *tree,
 		rbtree_node_t *node);
 rbtree_node_t *hsakmt_rbtree_next(rbtree_t *tree,
@@ -75,15 +89,44 @@ rbtree_node_t *hsakmt_rbtree_next(rbtree_t *tree,
 #define rbt_is_black(node)		(!rbt_is_red(node))
 #define rbt_copy_color(n1, n2)		(n1->color = n2->color)
 
-/* a sentinel must be black */
+/* Lookups may walk a tree without its lock and validate the result
+ * afterwards, see aperture_read_begin in fmm.c. Writers publish every link
+ * with a release store and walks load links with acquire loads. A walk that
+ * races with a rotation can loop, so walks give up after RBTREE_MAX_DEPTH
+ * steps, which a consistent tree never needs: a red-black tree of 2^64 nodes
+ * is at most 128 levels deep.
+ */
+#define rbt_link(link)			__atomic_load_n(&(link), __ATOMIC_ACQUIRE)
+#define rbt_set_link(link, node)	__atomic_store_n(&(link), (node), __ATOMIC_RELEASE)
+#define RBTREE_MAX_DEPTH		128
 
-#define rbtree_sentinel_init(node)	rbt_black(node)
+static inline unsigned long
+rbtree_count(rbtree_t *tree)
+{
+	return __atomic_load_n(&tree->count, __ATOMIC_RELAXED);
+}
+
+/* a sentinel must be black. Its children point to itself so that
+ * lockless readers racing with a rotation stop on it as well.
+ */
+
+#define rbtree_sentinel_init(node)				\
+	do {							\
+		rbt_black(node);				\
+		(node)->left = (node)->right = (node);		\
+	} while (0)
 
 static inline rbtree_node_t *
 rbtree_min(rbtree_node_t *node, rbtree_node_t *sentinel)
 {
-	while (node->left != sentinel) {
-		node = node->left;
+	rbtree_node_t  *left;
+	int depth;
+
+	for (depth = 0; depth < RBTREE_MAX_DEPTH; depth++) {
+		left = rbt_link(node->left);
+		if (left == sentinel)
+			break;
+		node = left;
 	}
 
 	return node;
@@ -69,8 +69,15 @@ rbtree_key_compare(unsigned int type, rbtree_key_t *key1, rbtree_key_t *key2)
 static inline rbtree_node_t *
 rbtree_max(rbtree_node_t *node, rbtree_node_t *sentinel)
 {
-	while (node->right != sentinel)
-		node = node->right;
+	rbtree_node_t *right;
+	int depth;
+
+	for (depth = 0; depth < RBTREE_MAX_DEPTH; depth++) {
+		right = rbt_link(node->right);
+		if (right == sentinel)
+			break;
+		node = right;
+	}
 
 	return node;
 }
@@ -82,7 +89,7 @@ static inline rbtree_node_t *
 rbtree_min_max(rbtree_t *tree, int lr)
 {
 	rbtree_node_t *sentinel = &tree->sentinel;
-	rbtree_node_t *node = tree->root;
+	rbtree_node_t *node = rbt_link(tree->root);
 
 	if (node == sentinel)
 		return NULL;
@@ -99,7 +106,7 @@ static inline rbtree_node_t *
 rbtree_node_any(rbtree_t *tree, int lmr)
 {
 	rbtree_node_t *sentinel = &tree->sentinel;
-	rbtree_node_t *node = tree->root;
+	rbtree_node_t *node = rbt_link(tree->root);
 
 	if (node == sentinel)
 		return NULL;
@@ -114,26 +121,26 @@ static inline rbtree_node_t *
 rbtree_lookup_nearest(rbtree_t *rbtree, rbtree_key_t *key,
 		unsigned int type, int lr)
 {
-	int rc;
+	int rc, depth;
 	rbtree_node_t *node, *sentinel, *n = NULL;
 
-	node = rbtree->root;
+	node = rbt_link(rbtree->root);
 	sentinel = &rbtree->sentinel;
 
-	while (node != sentinel) {
+	for (depth = 0; node != sentinel && depth < RBTREE_MAX_DEPTH; depth++) {
 		rc = rbtree_key_compare(type, key, &node->key);
 
 		if (rc < 0) {
 			if (lr == RIGHT)
 				n = node;
-			node = node->left;
+			node = rbt_link(node->left);
 			continue;
 		}
 
 		if (rc > 0) {
 			if (lr == LEFT)
 				n = node;
-			node = node->right;
+			node = rbt_link(node->right);
 			continue;
 		}
 
@@ -35,6 +35,8 @@
 #include <limits.h>
 
 #include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include <sys/sysinfo.h>
 #include <xf86drm.h>
 #include <amdgpu.h>
@@ -51,10 +53,58 @@
  */
 #define NUM_OF_IGPU_HEAPS 3
 #define NUM_OF_DGPU_HEAPS 3
-/* SYSFS related */
-#define KFD_SYSFS_PATH_GENERATION_ID "/sys/devices/virtual/kfd/kfd/topology/generation_id"
-#define KFD_SYSFS_PATH_SYSTEM_PROPERTIES "/sys/devices/virtual/kfd/kfd/topology/system_properties"
-#define KFD_SYSFS_PATH_NODES "/sys/devices/virtual/kfd/kfd/topology/nodes"
+/* SYSFS related, relative to sysfs_root */
+#define KFD_SYSFS_PATH_GENERATION_ID "/devices/virtual/kfd/kfd/topology/generation_id"
+#define KFD_SYSFS_PATH_SYSTEM_PROPERTIES "/devices/virtual/kfd/kfd/topology/system_properties"
+#define KFD_SYSFS_PATH_NODES "/devices/virtual/kfd/kfd/topology/nodes"
+
+/* Roots of the sysfs and procfs trees the topology is read from. They are
+ * set from HSA_SYSFS_ROOT and HSA_PROCFS_ROOT to test and benchmark the
+ * topology code against a synthetic tree.
+ */
+#define TOPOLOGY_ROOT_MAX 128
+static char sysfs_root[TOPOLOGY_ROOT_MAX] = "/sys";
+static char procfs_root[TOPOLOGY_ROOT_MAX] = "/proc";
+
+/* Upper bound of threads parsing the nodes, HSA_TOPOLOGY_THREADS overrides
+ * the default of one thread per node up to the number of online CPUs.
+ */
+#define TOPOLOGY_MAX_THREADS 16
+
+/* Serialized topology cache, enabled by HSA_TOPOLOGY_CACHE=<file>.
+ * It holds the parts of the snapshot which take the longest to read from
+ * sysfs: memory banks, caches and IO links of every node. It is only used
+ * when generation_id, boot_id, sysfs root and the GPU IDs of all nodes
+ * match the running system.
+ */
+#define TOPOLOGY_CACHE_MAGIC	0x4f50544b	/* "KTPO" */
+#define TOPOLOGY_CACHE_VERSION	1
+#define TOPOLOGY_BOOT_ID_SIZE	40
+
+struct topology_cache_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t node_size;
+	uint32_t mem_size;
+	uint32_t cache_size;
+	uint32_t link_size;
+	uint32_t generation;
+	uint32_t num_nodes;
+	char boot_id[TOPOLOGY_BOOT_ID_SIZE];
+	char sysfs_root[TOPOLOGY_ROOT_MAX];
+};
+
+/* Followed by NumMemoryBanks HsaMemoryProperties, NumCaches
+ * HsaCacheProperties and NumIOLinks HsaIoLinkProperties
+ */
+struct topology_cache_node {
+	uint32_t gpu_id;
+	uint32_t num_mem;
+	uint32_t num_caches;
+	uint32_t num_links;
+	HSAuint16 marketing_name[HSA_PUBLIC_NAME_SIZE];
+	HSAuint8 amd_name[HSA_PUBLIC_NAME_SIZE];
+};
 
 typedef struct {
 	HsaNodeProperties node;
@@ -72,6 +122,8 @@ static node_props_t *g_props;
 static uint32_t *map_user_to_sysfs_node_id;
 static uint32_t map_user_to_sysfs_node_id_size;
 static uint32_t num_sysfs_nodes;
+/* Number of valid entries in map_user_to_sysfs_node_id */
+static uint32_t num_supported_sysfs_nodes;
 
 static int processor_vendor = -1;
 /* Supported System Vendors */
@@ -462,14 +514,14 @@ static void cpumap_to_cpu_ci(char *shared_cpu_map,
 {
 	int num_hexs, bit;
 	uint32_t proc, apicid, mask;
-	char *ch_ptr;
+	char *ch_ptr, *saveptr;
 
 	/* shared_cpu_map is shown as ...X3,X2,X1 Each X is a hex without 0x
 	 * and it's up to 8 characters(32 bits). For the first 32 CPUs(actually
 	 * procs), it's presented in X1. The next 32 is in X2, and so on.
 	 */
 	num_hexs = (strlen(shared_cpu_map) + 8) / 9; /* 8 characters + "," */
-	ch_ptr = strtok(shared_cpu_map, ",");
+	ch_ptr = strtok_r(shared_cpu_map, ",", &saveptr);
 	while (num_hexs-- > 0) {
 		mask = strtol(ch_ptr, NULL, 16); /* each X */
 		for (bit = 0; bit < 32; bit++) {
@@ -484,7 +536,7 @@ static void cpumap_to_cpu_ci(char *shared_cpu_map,
 			}
 			this_cache->SiblingMap[apicid] = 1;
 		}
-		ch_ptr = strtok(NULL, ",");
+		ch_ptr = strtok_r(NULL, ",", &saveptr);
 	}
 }
 
@@ -579,13 +631,39 @@ static int get_cpu_cache_info(const char *prefix, struct proc_cpuinfo *cpuinfo,
 	return cpu_ci->num_caches;
 }
 
+/* topology_set_fs_root - set @root from the environment variable @name or
+ *	to @default_root if it isn't set. Roots that don't fit the path
+ *	buffers are ignored.
+ */
+static void topology_set_fs_root(char *root, const char *name,
+				 const char *default_root)
+{
+	const char *envvar = getenv(name);
+
+	if (!envvar)
+		envvar = default_root;
+	if (strlen(envvar) >= TOPOLOGY_ROOT_MAX) {
+		pr_err("%s %s is too long\n", name, envvar);
+		envvar = default_root;
+	}
+	strcpy(root, envvar);
+}
+
+static void topology_set_fs_roots(void)
+{
+	topology_set_fs_root(sysfs_root, "HSA_SYSFS_ROOT", "/sys");
+	topology_set_fs_root(procfs_root, "HSA_PROCFS_ROOT", "/proc");
+}
+
 static HSAKMT_STATUS topology_sysfs_get_generation(uint32_t *gen)
 {
 	FILE *fd;
+	char path[256];
 	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
 
 	assert(gen);
-	fd = fopen(KFD_SYSFS_PATH_GENERATION_ID, "r");
+	snprintf(path, 256, "%s%s", sysfs_root, KFD_SYSFS_PATH_GENERATION_ID);
+	fd = fopen(path, "r");
 	if (!fd)
 		return HSAKMT_STATUS_ERROR;
 	if (fscanf(fd, "%ul", gen) != 1) {
@@ -614,7 +692,7 @@ static HSAKMT_STATUS topology_sysfs_get_gpu_id(uint32_t sysfs_node_id, uint32_t
 	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
 
 	assert(gpu_id);
-	snprintf(path, 256, "%s/%d/gpu_id", KFD_SYSFS_PATH_NODES, sysfs_node_id);
+	snprintf(path, 256, "%s%s/%d/gpu_id", sysfs_root, KFD_SYSFS_PATH_NODES, sysfs_node_id);
 	fd = fopen(path, "r");
 	if (!fd)
 		return HSAKMT_STATUS_ERROR;
@@ -666,7 +744,7 @@ static HSAKMT_STATUS topology_sysfs_check_node_supported(uint32_t sysfs_node_id,
 		return HSAKMT_STATUS_NO_MEMORY;
 
 	/* Retrieve the node properties */
-	snprintf(path, 256, "%s/%d/properties", KFD_SYSFS_PATH_NODES, sysfs_node_id);
+	snprintf(path, 256, "%s%s/%d/properties", sysfs_root, KFD_SYSFS_PATH_NODES, sysfs_node_id);
 	fd = fopen(path, "r");
 	if (!fd) {
 		ret = HSAKMT_STATUS_ERROR;
@@ -716,6 +794,7 @@ HSAKMT_STATUS hsakmt_topology_sysfs_get_system_props(HsaSystemProperties *props)
 	FILE *fd;
 	char *read_buf, *p;
 	char prop_name[256];
+	char path[256];
 	unsigned long long prop_val;
 	uint32_t prog;
 	int read_size;
@@ -724,7 +803,9 @@ HSAKMT_STATUS hsakmt_topology_sysfs_get_system_props(HsaSystemProperties *props)
 	uint32_t num_supported_nodes = 0;
 
 	assert(props);
-	fd = fopen(KFD_SYSFS_PATH_SYSTEM_PROPERTIES, "r");
+	topology_set_fs_roots();
+	snprintf(path, 256, "%s%s", sysfs_root, KFD_SYSFS_PATH_SYSTEM_PROPERTIES);
+	fd = fopen(path, "r");
 	if (!fd)
 		return HSAKMT_STATUS_ERROR;
 
@@ -762,7 +843,8 @@ HSAKMT_STATUS hsakmt_topology_sysfs_get_system_props(HsaSystemProperties *props)
 	 * Assuming that inside nodes folder there are only folders
 	 * which represent the node numbers
 	 */
-	num_sysfs_nodes = num_subdirs(KFD_SYSFS_PATH_NODES, "");
+	snprintf(path, 256, "%s%s", sysfs_root, KFD_SYSFS_PATH_NODES);
+	num_sysfs_nodes = num_subdirs(path, "");
 
 	if (map_user_to_sysfs_node_id == NULL) {
 		/* Trade off - num_sysfs_nodes includes all CPU and GPU nodes.
@@ -792,6 +874,7 @@ HSAKMT_STATUS hsakmt_topology_sysfs_get_system_props(HsaSystemProperties *props)
 			map_user_to_sysfs_node_id[num_supported_nodes++] = i;
 	}
 	props->NumNodes = num_supported_nodes;
+	num_supported_sysfs_nodes = num_supported_nodes;
 
 	free(read_buf);
 	fclose(fd);
@@ -800,6 +883,8 @@ HSAKMT_STATUS hsakmt_topology_sysfs_get_system_props(HsaSystemProperties *props)
 sysfs_parse_failed:
 	free(map_user_to_sysfs_node_id);
 	map_user_to_sysfs_node_id = NULL;
+	map_user_to_sysfs_node_id_size = 0;
+	num_supported_sysfs_nodes = 0;
 err2:
 	free(read_buf);
 err1:
@@ -892,13 +977,14 @@ static HSAKMT_STATUS topology_parse_cpuinfo(struct proc_cpuinfo *cpuinfo,
 	char *p;
 	uint32_t proc = 0;
 	size_t p_len;
-	const char *proc_cpuinfo_path = "/proc/cpuinfo";
+	char proc_cpuinfo_path[256];
 
 	if (!cpuinfo) {
 		pr_err("CPU information will be missing\n");
 		return HSAKMT_STATUS_INVALID_PARAMETER;
 	}
 
+	snprintf(proc_cpuinfo_path, 256, "%s/cpuinfo", procfs_root);
 	fd = fopen(proc_cpuinfo_path, "r");
 	if (!fd) {
 		pr_err("Failed to open [%s]. Unable to get CPU information",
@@ -1027,6 +1113,12 @@ static int topology_get_node_props_from_drm(HsaNodeProperties *props)
 	if (props == NULL)
 		return -1;
 
+#ifdef HSAKMT_FAKE_KFD
+	/* Don't pick up the name of a real GPU with the same minor */
+	if (hsakmt_fake_kfd)
+		return -1;
+#endif
+
 	drm_fd = drmOpenRender(props->DrmRenderMinor);
 	if (drm_fd < 0)
 		return -1;
@@ -1095,7 +1187,7 @@ static HSAKMT_STATUS topology_sysfs_get_node_props(uint32_t node_id,
 		return HSAKMT_STATUS_NO_MEMORY;
 
 	/* Retrieve the node properties */
-	snprintf(path, 256, "%s/%d/properties", KFD_SYSFS_PATH_NODES, sys_node_id);
+	snprintf(path, 256, "%s%s/%d/properties", sysfs_root, KFD_SYSFS_PATH_NODES, sys_node_id);
 	fd = fopen(path, "r");
 	if (!fd) {
 		free(read_buf);
@@ -1300,7 +1392,7 @@ static HSAKMT_STATUS topology_sysfs_get_mem_props(uint32_t node_id,
 	if (ret != HSAKMT_STATUS_SUCCESS)
 		return ret;
 
-	snprintf(path, 256, "%s/%d/mem_banks/%d/properties", KFD_SYSFS_PATH_NODES, sys_node_id, mem_id);
+	snprintf(path, 256, "%s%s/%d/mem_banks/%d/properties", sysfs_root, KFD_SYSFS_PATH_NODES, sys_node_id, mem_id);
 	fd = fopen(path, "r");
 	if (!fd)
 		return HSAKMT_STATUS_ERROR;
@@ -1384,7 +1476,7 @@ static int topology_create_temp_cpu_cache_list(int node,
 /* MAXNAMLEN is the BSD name for NAME_MAX. glibc aliases this as NAME_MAX, but not musl */
 #define MAXNAMLEN NAME_MAX
 #endif
-	const uint32_t MAXPATHSIZE = 29 + MAXNAMLEN + (MAXNAMLEN + 6);
+	const uint32_t MAXPATHSIZE = TOPOLOGY_ROOT_MAX + 29 + MAXNAMLEN + (MAXNAMLEN + 6);
 	cpu_cacheinfo_t *p_temp_cpu_ci_list; /* a list of cpu_ci */
 	char path[MAXPATHSIZE], node_dir[MAXPATHSIZE];
 	int max_cpus;
@@ -1407,7 +1499,7 @@ static int topology_create_temp_cpu_cache_list(int node,
 			node_real = node * 8;
 		}
 	}
-	snprintf(node_dir, MAXPATHSIZE, "/sys/devices/system/node/node%d", node_real);
+	snprintf(node_dir, MAXPATHSIZE, "%s/devices/system/node/node%d", sysfs_root, node_real);
 	/* Other than cpuY folders, this dir also has cpulist and cpumap */
 	max_cpus = num_subdirs(node_dir, "cpu");
 	if (max_cpus <= 0) {
@@ -1419,7 +1511,7 @@ static int topology_create_temp_cpu_cache_list(int node,
 			goto exit;
 		}
 		/* Fall back to use /sys/devices/system/cpu */
-		snprintf(node_dir, MAXPATHSIZE, "/sys/devices/system/cpu");
+		snprintf(node_dir, MAXPATHSIZE, "%s/devices/system/cpu", sysfs_root);
 		max_cpus = num_subdirs(node_dir, "cpu");
 		if (max_cpus <= 0) {
 			pr_err("Fail to get cpu* dirs under %s\n", node_dir);
@@ -1534,7 +1626,7 @@ static HSAKMT_STATUS topology_sysfs_get_cache_props(uint32_t node_id,
 	if (ret != HSAKMT_STATUS_SUCCESS)
 		return ret;
 
-	snprintf(path, 256, "%s/%d/caches/%d/properties", KFD_SYSFS_PATH_NODES, sys_node_id, cache_id);
+	snprintf(path, 256, "%s%s/%d/caches/%d/properties", sysfs_root, KFD_SYSFS_PATH_NODES, sys_node_id, cache_id);
 	fd = fopen(path, "r");
 	if (!fd)
 		return HSAKMT_STATUS_ERROR;
@@ -1597,7 +1689,7 @@ static HSAKMT_STATUS topology_map_sysfs_to_user_node_id(uint32_t sys_node_id, ui
 {
 	uint32_t node_id;
 
-	for (node_id = 0; node_id < map_user_to_sysfs_node_id_size; node_id++)
+	for (node_id = 0; node_id < num_supported_sysfs_nodes; node_id++)
 		if (map_user_to_sysfs_node_id[node_id] == sys_node_id) {
 			*user_node_id = node_id;
 			return HSAKMT_STATUS_SUCCESS;
@@ -1632,9 +1724,9 @@ static HSAKMT_STATUS topology_sysfs_get_iolink_props(uint32_t node_id,
 		return ret;
 
 	if (p2pLink)
-		snprintf(path, 256, "%s/%d/p2p_links/%d/properties", KFD_SYSFS_PATH_NODES, sys_node_id, iolink_id);
+		snprintf(path, 256, "%s%s/%d/p2p_links/%d/properties", sysfs_root, KFD_SYSFS_PATH_NODES, sys_node_id, iolink_id);
 	else
-		snprintf(path, 256, "%s/%d/io_links/%d/properties", KFD_SYSFS_PATH_NODES, sys_node_id, iolink_id);
+		snprintf(path, 256, "%s%s/%d/io_links/%d/properties", sysfs_root, KFD_SYSFS_PATH_NODES, sys_node_id, iolink_id);
 
 	fd = fopen(path, "r");
 	if (!fd)
@@ -1673,19 +1765,17 @@ static HSAKMT_STATUS topology_sysfs_get_iolink_props(uint32_t node_id,
 			}
 			props->NodeFrom = node_id;
 		} else if (strcmp(prop_name, "node_to") == 0) {
-			bool is_node_supported;
-			uint32_t sysfs_node_id;
-
-			sysfs_node_id = (uint32_t)prop_val;
-			ret = topology_sysfs_check_node_supported(sysfs_node_id, &is_node_supported);
-			if (!is_node_supported) {
+			/* The supported nodes were probed when the system
+			 * properties of this generation were read, the remote
+			 * node is only supported if it got a user node ID.
+			 */
+			ret = topology_map_sysfs_to_user_node_id((uint32_t)prop_val,
+								 &props->NodeTo);
+			if (ret != HSAKMT_STATUS_SUCCESS) {
 				ret = HSAKMT_STATUS_NOT_SUPPORTED;
 				memset(props, 0, sizeof(*props));
 				goto err2;
 			}
-			ret = topology_map_sysfs_to_user_node_id(sysfs_node_id, &props->NodeTo);
-			if (ret != HSAKMT_STATUS_SUCCESS)
-				goto err2;
 		} else if (strcmp(prop_name, "weight") == 0)
 			props->Weight = (uint32_t)prop_val;
 		else if (strcmp(prop_name, "min_latency") == 0)
@@ -1937,24 +2027,438 @@ try_alt_dir:
 	}
 }
 
+/* State shared by the threads reading the nodes of one snapshot */
+struct topology_walk {
+	const HsaSystemProperties *sys_props;
+	node_props_t *props;
+	struct proc_cpuinfo *cpuinfo;
+	uint32_t num_procs;
+	/* Cached record of each node, NULL to read all nodes from sysfs */
+	const uint8_t **cache;
+	uint32_t next_node;
+	bool p2p_links;
+	bool cache_miss;
+	HSAKMT_STATUS ret;
+};
+
+/* topology_get_boot_id - read the boot ID. A cache written before a reboot
+ *	must not be used even if the generation happens to match.
+ */
+static bool topology_get_boot_id(char *boot_id)
+{
+	char path[256];
+	FILE *fd;
+	bool ret;
+
+	snprintf(path, 256, "%s/sys/kernel/random/boot_id", procfs_root);
+	fd = fopen(path, "r");
+	if (!fd)
+		return false;
+
+	memset(boot_id, 0, TOPOLOGY_BOOT_ID_SIZE);
+	ret = fgets(boot_id, TOPOLOGY_BOOT_ID_SIZE, fd) != NULL;
+	fclose(fd);
+
+	return ret;
+}
+
+/* topology_cache_load - read the topology cache
+ *	@path [IN] cache file
+ *	@gen [IN] generation_id the system properties were read in
+ *	@sys_props [IN] system properties of this generation
+ *	@nodes [OUT] record of each node inside the returned buffer
+ * Return: the cache contents if it matches the system, NULL otherwise.
+ *	The caller frees the returned buffer and *nodes.
+ */
+static void *topology_cache_load(const char *path, uint32_t gen,
+				 const HsaSystemProperties *sys_props,
+				 const uint8_t ***nodes)
+{
+	struct topology_cache_header header;
+	struct topology_cache_node rec;
+	char boot_id[TOPOLOGY_BOOT_ID_SIZE];
+	uint8_t *buf = NULL;
+	const uint8_t **recs = NULL;
+	size_t size, offset;
+	struct stat st;
+	uint32_t i;
+	FILE *fd;
+
+	*nodes = NULL;
+	if (!sys_props->NumNodes || !topology_get_boot_id(boot_id))
+		return NULL;
+
+	fd = fopen(path, "r");
+	if (!fd)
+		return NULL;
+	if (fstat(fileno(fd), &st) || st.st_size < (off_t)sizeof(header))
+		goto out;
+
+	size = st.st_size;
+	buf = malloc(size);
+	if (!buf || fread(buf, 1, size, fd) != size)
+		goto err;
+
+	memcpy(&header, buf, sizeof(header));
+	if (header.magic != TOPOLOGY_CACHE_MAGIC ||
+	    header.version != TOPOLOGY_CACHE_VERSION ||
+	    header.node_size != sizeof(HsaNodeProperties) ||
+	    header.mem_size != sizeof(HsaMemoryProperties) ||
+	    header.cache_size != sizeof(HsaCacheProperties) ||
+	    header.link_size != sizeof(HsaIoLinkProperties) ||
+	    header.generation != gen ||
+	    header.num_nodes != sys_props->NumNodes ||
+	    strncmp(header.boot_id, boot_id, TOPOLOGY_BOOT_ID_SIZE) ||
+	    strncmp(header.sysfs_root, sysfs_root, TOPOLOGY_ROOT_MAX))
+		goto err;
+
+	recs = calloc(header.num_nodes, sizeof(*recs));
+	if (!recs)
+		goto err;
+
+	offset = sizeof(header);
+	for (i = 0; i < header.num_nodes; i++) {
+		if (size - offset < sizeof(rec))
+			goto err;
+		memcpy(&rec, buf + offset, sizeof(rec));
+		if (rec.num_links > sys_props->NumNodes - 1)
+			goto err;
+		recs[i] = buf + offset;
+		offset += sizeof(rec);
+
+		if ((size - offset) / sizeof(HsaMemoryProperties) < rec.num_mem)
+			goto err;
+		offset += rec.num_mem * sizeof(HsaMemoryProperties);
+		if ((size - offset) / sizeof(HsaCacheProperties) < rec.num_caches)
+			goto err;
+		offset += rec.num_caches * sizeof(HsaCacheProperties);
+		if ((size - offset) / sizeof(HsaIoLinkProperties) < rec.num_links)
+			goto err;
+		offset += rec.num_links * sizeof(HsaIoLinkProperties);
+	}
+	if (offset != size)
+		goto err;
+
+	*nodes = recs;
+	goto out;
+
+err:
+	pr_debug("Ignoring stale topology cache %s\n", path);
+	free(recs);
+	free(buf);
+	buf = NULL;
+out:
+	fclose(fd);
+	return buf;
+}
+
+/* topology_cache_apply - fill the node tables of @props from the cached
+ *	record @data instead of sysfs. The node properties must have been
+ *	read already.
+ * Return: HSAKMT_STATUS_SUCCESS in success, HSAKMT_STATUS_ERROR if the
+ *	record belongs to a different node.
+ */
+static HSAKMT_STATUS topology_cache_apply(const uint8_t *data,
+					  const HsaSystemProperties *sys_props,
+					  node_props_t *props)
+{
+	struct topology_cache_node rec;
+
+	memcpy(&rec, data, sizeof(rec));
+	data += sizeof(rec);
+	if (rec.gpu_id != props->node.KFDGpuID)
+		return HSAKMT_STATUS_ERROR;
+
+	props->node.NumMemoryBanks = rec.num_mem;
+	props->node.NumCaches = rec.num_caches;
+	props->node.NumIOLinks = rec.num_links;
+	if (props->node.NumCPUCores) {
+		/* CPU model name from /proc/cpuinfo */
+		memcpy(props->node.MarketingName, rec.marketing_name,
+		       sizeof(rec.marketing_name));
+		memcpy(props->node.AMDName, rec.amd_name, sizeof(rec.amd_name));
+	}
+
+	if (rec.num_mem) {
+		props->mem = calloc(rec.num_mem, sizeof(HsaMemoryProperties));
+		if (!props->mem)
+			return HSAKMT_STATUS_NO_MEMORY;
+		memcpy(props->mem, data, rec.num_mem * sizeof(HsaMemoryProperties));
+		data += rec.num_mem * sizeof(HsaMemoryProperties);
+	}
+
+	if (rec.num_caches) {
+		props->cache = calloc(rec.num_caches, sizeof(HsaCacheProperties));
+		if (!props->cache)
+			return HSAKMT_STATUS_NO_MEMORY;
+		memcpy(props->cache, data, rec.num_caches * sizeof(HsaCacheProperties));
+		data += rec.num_caches * sizeof(HsaCacheProperties);
+	}
+
+	props->link = calloc(sys_props->NumNodes - 1, sizeof(HsaIoLinkProperties));
+	if (!props->link)
+		return HSAKMT_STATUS_NO_MEMORY;
+	memcpy(props->link, data, rec.num_links * sizeof(HsaIoLinkProperties));
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+/* topology_cache_save - write the snapshot tables of generation @gen to the
+ *	topology cache. The file is replaced atomically so that concurrent
+ *	processes never read a partial cache.
+ */
+static void topology_cache_save(const char *path, uint32_t gen,
+				const HsaSystemProperties *sys_props,
+				const node_props_t *props)
+{
+	struct topology_cache_header header;
+	struct topology_cache_node rec;
+	char tmp_path[PATH_MAX];
+	size_t size;
+	uint32_t i;
+	FILE *fd;
+	int tmp_fd;
+	bool ok;
+
+	memset(&header, 0, sizeof(header));
+	if (!sys_props->NumNodes || !topology_get_boot_id(header.boot_id))
+		return;
+
+	if (snprintf(tmp_path, PATH_MAX, "%s.XXXXXX", path) >= PATH_MAX)
+		return;
+	tmp_fd = mkstemp(tmp_path);
+	if (tmp_fd < 0) {
+		pr_debug("Failed to create topology cache %s: %s\n", tmp_path,
+			 strerror(errno));
+		return;
+	}
+	fd = fdopen(tmp_fd, "w");
+	if (!fd) {
+		close(tmp_fd);
+		unlink(tmp_path);
+		return;
+	}
+
+	header.magic = TOPOLOGY_CACHE_MAGIC;
+	header.version = TOPOLOGY_CACHE_VERSION;
+	header.node_size = sizeof(HsaNodeProperties);
+	header.mem_size = sizeof(HsaMemoryProperties);
+	header.cache_size = sizeof(HsaCacheProperties);
+	header.link_size = sizeof(HsaIoLinkProperties);
+	header.generation = gen;
+	header.num_nodes = sys_props->NumNodes;
+	snprintf(header.sysfs_root, sizeof(header.sysfs_root), "%s", sysfs_root);
+	ok = fwrite(&header, sizeof(header), 1, fd) == 1;
+
+	for (i = 0; ok && i < sys_props->NumNodes; i++) {
+		memset(&rec, 0, sizeof(rec));
+		rec.gpu_id = props[i].node.KFDGpuID;
+		rec.num_mem = props[i].node.NumMemoryBanks;
+		rec.num_caches = props[i].node.NumCaches;
+		rec.num_links = props[i].node.NumIOLinks;
+		memcpy(rec.marketing_name, props[i].node.MarketingName,
+		       sizeof(rec.marketing_name));
+		memcpy(rec.amd_name, props[i].node.AMDName, sizeof(rec.amd_name));
+		ok = fwrite(&rec, sizeof(rec), 1, fd) == 1;
+
+		size = rec.num_mem * sizeof(HsaMemoryProperties);
+		if (ok && size)
+			ok = fwrite(props[i].mem, size, 1, fd) == 1;
+		size = rec.num_caches * sizeof(HsaCacheProperties);
+		if (ok && size)
+			ok = fwrite(props[i].cache, size, 1, fd) == 1;
+		size = rec.num_links * sizeof(HsaIoLinkProperties);
+		if (ok && size)
+			ok = fwrite(props[i].link, size, 1, fd) == 1;
+	}
+
+	if (fclose(fd))
+		ok = false;
+	if (!ok || rename(tmp_path, path)) {
+		pr_debug("Failed to write topology cache %s\n", path);
+		unlink(tmp_path);
+	}
+}
+
+/* topology_get_node_snapshot - read all properties of node @i from sysfs,
+ *	or only its node properties if the tables are cached. On failure the
+ *	caller frees the partially filled node.
+ */
+static HSAKMT_STATUS topology_get_node_snapshot(struct topology_walk *walk,
+						uint32_t i)
+{
+	const HsaSystemProperties *sys_props = walk->sys_props;
+	node_props_t *props = &walk->props[i];
+	uint32_t mem_id, cache_id, num_ioLinks, link_id = 0;
+	uint32_t num_p2pLinks = 0;
+	bool p2p_links = false;
+	HSAKMT_STATUS ret;
+
+	ret = topology_sysfs_get_node_props(i, &props->node,
+					    &p2p_links, &num_p2pLinks);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+	if (p2p_links)
+		__atomic_store_n(&walk->p2p_links, true, __ATOMIC_RELAXED);
+
+	if (walk->cache) {
+		ret = topology_cache_apply(walk->cache[i], sys_props, props);
+		if (ret == HSAKMT_STATUS_ERROR) {
+			/* Redone from sysfs after all nodes are read */
+			__atomic_store_n(&walk->cache_miss, true, __ATOMIC_RELAXED);
+			ret = HSAKMT_STATUS_SUCCESS;
+		}
+		return ret;
+	}
+
+	if (props->node.NumCPUCores)
+		topology_get_cpu_model_name(&props->node,
+					walk->cpuinfo, walk->num_procs);
+
+	if (props->node.NumMemoryBanks) {
+		props->mem = calloc(props->node.NumMemoryBanks * sizeof(HsaMemoryProperties), 1);
+		if (!props->mem)
+			return HSAKMT_STATUS_NO_MEMORY;
+		for (mem_id = 0; mem_id < props->node.NumMemoryBanks; mem_id++) {
+			ret = topology_sysfs_get_mem_props(i, mem_id, &props->mem[mem_id]);
+			if (ret != HSAKMT_STATUS_SUCCESS)
+				return ret;
+		}
+	}
+
+	if (props->node.NumCaches) {
+		props->cache = calloc(props->node.NumCaches * sizeof(HsaCacheProperties), 1);
+		if (!props->cache)
+			return HSAKMT_STATUS_NO_MEMORY;
+		for (cache_id = 0; cache_id < props->node.NumCaches; cache_id++) {
+			ret = topology_sysfs_get_cache_props(i, cache_id, &props->cache[cache_id]);
+			if (ret != HSAKMT_STATUS_SUCCESS)
+				return ret;
+		}
+	} else if (!props->node.KFDGpuID) { /* a CPU node */
+		ret = topology_get_cpu_cache_props(i, walk->cpuinfo, props);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			return ret;
+	}
+
+	/* To simplify, allocate maximum needed memory for io_links for each node. This
+	 * removes the need for realloc when indirect and QPI links are added later
+	 */
+	props->link = calloc(sys_props->NumNodes - 1, sizeof(HsaIoLinkProperties));
+	if (!props->link)
+		return HSAKMT_STATUS_NO_MEMORY;
+	num_ioLinks = props->node.NumIOLinks - num_p2pLinks;
+
+	if (num_ioLinks) {
+		uint32_t sys_link_id = 0;
+
+		/* Parse all the sysfs specified io links. Skip the ones where the
+		 * remote node (node_to) is not accessible
+		 */
+		while (sys_link_id < num_ioLinks &&
+			link_id < sys_props->NumNodes - 1) {
+			ret = topology_sysfs_get_iolink_props(i, sys_link_id++,
+						&props->link[link_id], false);
+			if (ret == HSAKMT_STATUS_NOT_SUPPORTED)
+				continue;
+			else if (ret != HSAKMT_STATUS_SUCCESS)
+				return ret;
+			link_id++;
+		}
+		/* sysfs specifies all the io links. Limit the number to valid ones */
+		props->node.NumIOLinks = link_id;
+	}
+
+	if (num_p2pLinks) {
+		uint32_t sys_link_id = 0;
+
+		/* Parse all the sysfs specified p2p links.
+		 */
+		while (sys_link_id < num_p2pLinks &&
+			link_id < sys_props->NumNodes - 1) {
+			ret = topology_sysfs_get_iolink_props(i, sys_link_id++,
+						&props->link[link_id], true);
+			if (ret == HSAKMT_STATUS_NOT_SUPPORTED)
+				continue;
+			else if (ret != HSAKMT_STATUS_SUCCESS)
+				return ret;
+			link_id++;
+		}
+		props->node.NumIOLinks = link_id;
+	}
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+static void *topology_walk_nodes(void *arg)
+{
+	struct topology_walk *walk = arg;
+	HSAKMT_STATUS ret;
+	uint32_t i;
+
+	while (__atomic_load_n(&walk->ret, __ATOMIC_RELAXED) == HSAKMT_STATUS_SUCCESS) {
+		i = __atomic_fetch_add(&walk->next_node, 1, __ATOMIC_RELAXED);
+		if (i >= walk->sys_props->NumNodes)
+			break;
+
+		ret = topology_get_node_snapshot(walk, i);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			__atomic_store_n(&walk->ret, ret, __ATOMIC_RELAXED);
+	}
+
+	return NULL;
+}
+
+/* topology_walk_run - read all nodes. Every node is read by a single thread,
+ *	nodes are handed out to up to one thread per node. Most of the time
+ *	is spent in the kernel generating sysfs files and in the DRM queries
+ *	of GPU nodes, which scales with the number of threads.
+ */
+static HSAKMT_STATUS topology_walk_run(struct topology_walk *walk)
+{
+	pthread_t threads[TOPOLOGY_MAX_THREADS];
+	uint32_t num_threads = get_nprocs();
+	uint32_t i, num_created = 0;
+	const char *envvar;
+
+	envvar = getenv("HSA_TOPOLOGY_THREADS");
+	if (envvar && atoi(envvar) > 0)
+		num_threads = atoi(envvar);
+	if (num_threads > walk->sys_props->NumNodes)
+		num_threads = walk->sys_props->NumNodes;
+	if (num_threads > TOPOLOGY_MAX_THREADS)
+		num_threads = TOPOLOGY_MAX_THREADS;
+
+	/* The calling thread is one of the walkers */
+	for (i = 1; i < num_threads; i++) {
+		if (pthread_create(&threads[num_created], NULL,
+				   topology_walk_nodes, walk))
+			break;
+		num_created++;
+	}
+	topology_walk_nodes(walk);
+
+	for (i = 0; i < num_created; i++)
+		pthread_join(threads[i], NULL);
+
+	return walk->ret;
+}
+
 HSAKMT_STATUS topology_take_snapshot(void)
 {
-	uint32_t gen_start, gen_end, i, mem_id, cache_id;
+	uint32_t gen_start, gen_end;
 	HsaSystemProperties sys_props;
 	node_props_t *temp_props = 0;
 	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
-	struct proc_cpuinfo *cpuinfo;
+	struct proc_cpuinfo *cpuinfo = NULL;
 	const uint32_t num_procs = get_nprocs();
-	uint32_t num_ioLinks;
-	bool p2p_links = false;
-	uint32_t num_p2pLinks = 0;
+	const char *cache_path = getenv("HSA_TOPOLOGY_CACHE");
+	bool use_cache = cache_path && *cache_path;
+	struct topology_walk walk;
+	void *cache = NULL;
 
-	cpuinfo = calloc(num_procs, sizeof(struct proc_cpuinfo));
-	if (!cpuinfo) {
-		pr_err("Fail to allocate memory for CPU info\n");
-		return HSAKMT_STATUS_NO_MEMORY;
-	}
-	topology_parse_cpuinfo(cpuinfo, num_procs);
+	topology_set_fs_roots();
+	memset(&walk, 0, sizeof(walk));
 
 retry:
 	ret = topology_sysfs_get_generation(&gen_start);
@@ -1963,124 +2467,56 @@ retry:
 	ret = hsakmt_topology_sysfs_get_system_props(&sys_props);
 	if (ret != HSAKMT_STATUS_SUCCESS)
 		goto err;
+
+	memset(&walk, 0, sizeof(walk));
+	walk.sys_props = &sys_props;
+	if (use_cache)
+		cache = topology_cache_load(cache_path, gen_start, &sys_props,
+					    &walk.cache);
+
+	/* CPU model names and caches come from the cache as well */
+	if (!walk.cache && !cpuinfo) {
+		cpuinfo = calloc(num_procs, sizeof(struct proc_cpuinfo));
+		if (!cpuinfo) {
+			pr_err("Fail to allocate memory for CPU info\n");
+			ret = HSAKMT_STATUS_NO_MEMORY;
+			goto err;
+		}
+		topology_parse_cpuinfo(cpuinfo, num_procs);
+	}
+	walk.cpuinfo = cpuinfo;
+	walk.num_procs = num_procs;
+
 	if (sys_props.NumNodes > 0) {
 		temp_props = calloc(sys_props.NumNodes * sizeof(node_props_t), 1);
 		if (!temp_props) {
 			ret = HSAKMT_STATUS_NO_MEMORY;
 			goto err;
 		}
-		for (i = 0; i < sys_props.NumNodes; i++) {
-			ret = topology_sysfs_get_node_props(i,
-					&temp_props[i].node,
-					&p2p_links, &num_p2pLinks);
-			if (ret != HSAKMT_STATUS_SUCCESS) {
-				free_properties(temp_props, i);
-				goto err;
-			}
-
-			if (temp_props[i].node.NumCPUCores)
-				topology_get_cpu_model_name(&temp_props[i].node,
-							cpuinfo, num_procs);
-
-			if (temp_props[i].node.NumMemoryBanks) {
-				temp_props[i].mem = calloc(temp_props[i].node.NumMemoryBanks * sizeof(HsaMemoryProperties), 1);
-				if (!temp_props[i].mem) {
-					ret = HSAKMT_STATUS_NO_MEMORY;
-					free_properties(temp_props, i + 1);
-					goto err;
-				}
-				for (mem_id = 0; mem_id < temp_props[i].node.NumMemoryBanks; mem_id++) {
-					ret = topology_sysfs_get_mem_props(i, mem_id, &temp_props[i].mem[mem_id]);
-					if (ret != HSAKMT_STATUS_SUCCESS) {
-						free_properties(temp_props, i + 1);
-						goto err;
-					}
-				}
-			}
-
-			if (temp_props[i].node.NumCaches) {
-				temp_props[i].cache = calloc(temp_props[i].node.NumCaches * sizeof(HsaCacheProperties), 1);
-				if (!temp_props[i].cache) {
-					ret = HSAKMT_STATUS_NO_MEMORY;
-					free_properties(temp_props, i + 1);
-					goto err;
-				}
-				for (cache_id = 0; cache_id < temp_props[i].node.NumCaches; cache_id++) {
-					ret = topology_sysfs_get_cache_props(i, cache_id, &temp_props[i].cache[cache_id]);
-					if (ret != HSAKMT_STATUS_SUCCESS) {
-						free_properties(temp_props, i + 1);
-						goto err;
-					}
-				}
-			} else if (!temp_props[i].node.KFDGpuID) { /* a CPU node */
-				ret = topology_get_cpu_cache_props(
-						i, cpuinfo, &temp_props[i]);
-				if (ret != HSAKMT_STATUS_SUCCESS) {
-					free_properties(temp_props, i + 1);
-					goto err;
-				}
-			}
-
-			/* To simplify, allocate maximum needed memory for io_links for each node. This
-			 * removes the need for realloc when indirect and QPI links are added later
-			 */
-			temp_props[i].link = calloc(sys_props.NumNodes - 1, sizeof(HsaIoLinkProperties));
-			if (!temp_props[i].link) {
-				ret = HSAKMT_STATUS_NO_MEMORY;
-				free_properties(temp_props, i + 1);
-				goto err;
-			}
-			num_ioLinks = temp_props[i].node.NumIOLinks - num_p2pLinks;
-			uint32_t link_id = 0;
-
-			if (num_ioLinks) {
-				uint32_t sys_link_id = 0;
-
-				/* Parse all the sysfs specified io links. Skip the ones where the
-				 * remote node (node_to) is not accessible
-				 */
-				while (sys_link_id < num_ioLinks &&
-					link_id < sys_props.NumNodes - 1) {
-					ret = topology_sysfs_get_iolink_props(i, sys_link_id++,
-								&temp_props[i].link[link_id], false);
-					if (ret == HSAKMT_STATUS_NOT_SUPPORTED) {
-						continue;
-					} else if (ret != HSAKMT_STATUS_SUCCESS) {
-						free_properties(temp_props, i + 1);
-						goto err;
-					}
-					link_id++;
-				}
-				/* sysfs specifies all the io links. Limit the number to valid ones */
-				temp_props[i].node.NumIOLinks = link_id;
-			}
-
-			if (num_p2pLinks) {
-				uint32_t sys_link_id = 0;
+		walk.props = temp_props;
 
-				/* Parse all the sysfs specified p2p links.
-				 */
-				while (sys_link_id < num_p2pLinks &&
-					link_id < sys_props.NumNodes - 1) {
-					ret = topology_sysfs_get_iolink_props(i, sys_link_id++,
-								&temp_props[i].link[link_id], true);
-					if (ret == HSAKMT_STATUS_NOT_SUPPORTED) {
-						ret = HSAKMT_STATUS_SUCCESS;
-						continue;
-					} else if (ret != HSAKMT_STATUS_SUCCESS) {
-						free_properties(temp_props, i + 1);
-						goto err;
-					}
-					link_id++;
-				}
-				temp_props[i].node.NumIOLinks = link_id;
-			}
+		ret = topology_walk_run(&walk);
+		if (ret != HSAKMT_STATUS_SUCCESS) {
+			free_properties(temp_props, sys_props.NumNodes);
+			goto err;
 		}
 	}
 
-	if (!p2p_links) {
+	if (walk.cache_miss) {
+		/* The cache belongs to different nodes, read all from sysfs */
+		free_properties(temp_props, sys_props.NumNodes);
+		temp_props = 0;
+		free(walk.cache);
+		free(cache);
+		cache = NULL;
+		use_cache = false;
+		goto retry;
+	}
+
+	if (!walk.cache && !walk.p2p_links) {
 		/* All direct IO links are created in the kernel. Here we need to
-		 * connect GPU<->GPU or GPU<->CPU indirect IO links.
+		 * connect GPU<->GPU or GPU<->CPU indirect IO links. Cached
+		 * tables already include them.
 		 */
 		topology_create_indirect_gpu_links(&sys_props, temp_props);
 	}
@@ -2094,9 +2530,15 @@ retry:
 	if (gen_start != gen_end) {
 		free_properties(temp_props, sys_props.NumNodes);
 		temp_props = 0;
+		free(walk.cache);
+		free(cache);
+		cache = NULL;
 		goto retry;
 	}
 
+	if (cache_path && *cache_path && !walk.cache)
+		topology_cache_save(cache_path, gen_end, &sys_props, temp_props);
+
 	if (!g_system) {
 		g_system = malloc(sizeof(HsaSystemProperties));
 		if (!g_system) {
@@ -2111,6 +2553,8 @@ retry:
 		free(g_props);
 	g_props = temp_props;
 err:
+	free(walk.cache);
+	free(cache);
 	free(cpuinfo);
 	return ret;
 }
@@ -2134,6 +2578,7 @@ void topology_drop_snapshot(void)
 		free(map_user_to_sysfs_node_id);
 		map_user_to_sysfs_node_id = NULL;
 		map_user_to_sysfs_node_id_size = 0;
+		num_supported_sysfs_nodes = 0;
 	}
 }
 
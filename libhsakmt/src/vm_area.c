@@ -0,0 +1,316 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "libhsakmt.h"
+#include "vm_area.h"
+#include <stddef.h>
+
+#define vm_area_entry(n)					\
+		((vm_area_t *)((char *)(n) - offsetof(vm_area_t, node)))
+
+static void vm_area_augment(rbtree_node_t *node, rbtree_node_t *sentinel)
+{
+	vm_area_t *area = vm_area_entry(node);
+	uint64_t gap = area->gap;
+
+	if (node->left != sentinel && vm_area_entry(node->left)->subtree_gap > gap)
+		gap = vm_area_entry(node->left)->subtree_gap;
+	if (node->right != sentinel && vm_area_entry(node->right)->subtree_gap > gap)
+		gap = vm_area_entry(node->right)->subtree_gap;
+
+	area->subtree_gap = gap;
+}
+
+void hsakmt_vm_area_list_init(vm_area_list_t *list)
+{
+	list->head = NULL;
+	rbtree_init_augmented(&list->tree, vm_area_augment);
+}
+
+void hsakmt_vm_area_list_clear(vm_area_list_t *list)
+{
+	while (list->head) {
+		vm_area_t *next = list->head->next;
+
+		free(list->head);
+		list->head = next;
+	}
+	hsakmt_vm_area_list_init(list);
+}
+
+/* Recomputes the gap of area after its start or the end of its
+ * predecessor moved.
+ */
+static void vm_area_update_gap(vm_area_list_t *list, vm_area_t *area)
+{
+	if (!area)
+		return;
+
+	area->gap = area->prev ?
+		VOID_PTRS_SUB(area->start, area->prev->end) - 1 : 0;
+	hsakmt_rbtree_augment_path(&list->tree, &area->node);
+}
+
+/* Links a new area [start, end] between prev and next */
+static vm_area_t *vm_area_insert(vm_area_list_t *list, vm_area_t *prev,
+				 vm_area_t *next, void *start, void *end)
+{
+	vm_area_t *area = (vm_area_t *) malloc(sizeof(vm_area_t));
+
+	if (!area)
+		return NULL;
+
+	area->start = start;
+	area->end = end;
+	area->prev = prev;
+	area->next = next;
+	if (prev)
+		prev->next = area;
+	else
+		list->head = area;
+	if (next)
+		next->prev = area;
+
+	area->gap = prev ? VOID_PTRS_SUB(start, prev->end) - 1 : 0;
+	area->subtree_gap = area->gap;
+	area->node.key = rbtree_key((unsigned long)start, 0);
+	hsakmt_rbtree_insert(&list->tree, &area->node);
+
+	vm_area_update_gap(list, next);
+
+	return area;
+}
+
+static void vm_area_remove(vm_area_list_t *list, vm_area_t *area)
+{
+	vm_area_t *next = area->next;
+
+	if (!area->prev) /* The first element */
+		list->head = next;
+	else
+		area->prev->next = next;
+
+	if (next) /* If not the last element */
+		next->prev = area->prev;
+
+	hsakmt_rbtree_delete(&list->tree, &area->node);
+	free(area);
+
+	vm_area_update_gap(list, next);
+}
+
+/* Returns the last area starting at or before address */
+static vm_area_t *vm_area_find_before(vm_area_list_t *list, void *address)
+{
+	rbtree_key_t key = rbtree_key((unsigned long)address, 0);
+	rbtree_node_t *n = rbtree_lookup_nearest(&list->tree, &key, LKP_ADDR, LEFT);
+
+	return n ? vm_area_entry(n) : NULL;
+}
+
+vm_area_t *hsakmt_vm_area_find(vm_area_list_t *list, void *address)
+{
+	vm_area_t *area = vm_area_find_before(list, address);
+
+	if (area && area->end >= address)
+		return area;
+
+	return NULL; /* NULL if not found */
+}
+
+/* Start of the hole following prev, aligned as requested */
+static void *vm_area_hole_start(vm_area_t *prev, uint64_t align,
+				uint64_t offset)
+{
+	return (void *)(ALIGN_UP((uint64_t)prev->end + 1, align) + offset);
+}
+
+static bool vm_area_hole_fits(vm_area_t *next, void *start, uint64_t size)
+{
+	return next->start > start && VOID_PTRS_SUB(next->start, start) >= size;
+}
+
+/* Returns the lowest area whose preceding gap is at least min_gap bytes */
+static vm_area_t *vm_area_find_gap(vm_area_list_t *list, uint64_t min_gap)
+{
+	rbtree_node_t *node = list->tree.root;
+	rbtree_node_t *sentinel = &list->tree.sentinel;
+
+	while (node != sentinel && vm_area_entry(node)->subtree_gap >= min_gap) {
+		if (node->left != sentinel &&
+		    vm_area_entry(node->left)->subtree_gap >= min_gap)
+			node = node->left;
+		else if (vm_area_entry(node)->gap >= min_gap)
+			return vm_area_entry(node);
+		else
+			node = node->right;
+	}
+
+	return NULL;
+}
+
+/* Returns the lowest area of the subtree whose preceding hole fits size
+ * bytes once aligned. A hole always loses at least offset bytes to
+ * alignment, so subtrees without any gap of size + offset bytes are
+ * skipped.
+ */
+static vm_area_t *vm_area_find_hole(rbtree_node_t *node,
+				    rbtree_node_t *sentinel, uint64_t size,
+				    uint64_t align, uint64_t offset)
+{
+	uint64_t min_gap = size + offset;
+	vm_area_t *area;
+
+	while (node != sentinel && vm_area_entry(node)->subtree_gap >= min_gap) {
+		if (node->left != sentinel &&
+		    vm_area_entry(node->left)->subtree_gap >= min_gap) {
+			area = vm_area_find_hole(node->left, sentinel, size,
+						 align, offset);
+			if (area)
+				return area;
+		}
+
+		area = vm_area_entry(node);
+		if (area->prev && area->gap >= min_gap &&
+		    vm_area_hole_fits(area,
+				      vm_area_hole_start(area->prev, align, offset),
+				      size))
+			return area;
+
+		node = node->right;
+	}
+
+	return NULL;
+}
+
+void *hsakmt_vm_area_reserve(vm_area_list_t *list, void *base, void *limit,
+			     void *address, uint64_t size, uint64_t align,
+			     uint64_t offset)
+{
+	vm_area_t *cur, *next;
+	void *start;
+
+	if (address) {
+		start = address;
+		cur = vm_area_find_before(list, address);
+		next = cur ? cur->next : list->head;
+
+		if (next && !vm_area_hole_fits(next, start, size))
+			/* Required address range overlaps the next area */
+			return NULL;
+
+		if (cur && address < vm_area_hole_start(cur, align, 0))
+			/* Required address is not free or overlaps */
+			return NULL;
+	} else {
+		/* Find a big enough "hole" in the address space, the one
+		 * before the first area is not tracked by the tree.
+		 */
+		cur = NULL;
+		next = list->head;
+		start = (void *)(ALIGN_UP((uint64_t)base, align) + offset);
+		if (next && !vm_area_hole_fits(next, start, size)) {
+			/* Any gap that fits the worst case alignment padding
+			 * can be found in O(log n). Holes which only fit
+			 * depending on their position are searched for last,
+			 * when there is no space left after the last area.
+			 */
+			next = vm_area_find_gap(list, size + offset + align - 1);
+			cur = next ? next->prev :
+				vm_area_entry(rbtree_min_max(&list->tree, RIGHT));
+			start = vm_area_hole_start(cur, align, offset);
+
+			if (!next && (start > limit ||
+				      VOID_PTRS_SUB(limit, start) + 1 < size)) {
+				next = vm_area_find_hole(list->tree.root,
+							 &list->tree.sentinel,
+							 size, align, offset);
+				if (next) {
+					cur = next->prev;
+					start = vm_area_hole_start(cur, align,
+								   offset);
+				}
+			}
+		}
+	}
+
+	if (!next && (start > limit || VOID_PTRS_SUB(limit, start) + 1 < size))
+		/* No hole found and not enough space after the last area */
+		return NULL;
+
+	if (cur && VOID_PTR_ADD(cur->end, 1) == start) {
+		/* extend existing area */
+		cur->end = VOID_PTR_ADD(start, size - 1);
+		vm_area_update_gap(list, next);
+	} else if (!vm_area_insert(list, cur, next, start,
+				   VOID_PTR_ADD(start, size - 1))) {
+		return NULL;
+	}
+
+	return start;
+}
+
+int hsakmt_vm_area_release(vm_area_list_t *list, void *address,
+			   uint64_t size)
+{
+	vm_area_t *area = hsakmt_vm_area_find(list, address);
+	uint64_t SizeOfRegion;
+
+	if (!area)
+		return -ENOENT;
+
+	SizeOfRegion = VOID_PTRS_SUB(area->end, area->start) + 1;
+
+	/* check if block is whole region or part of it */
+	if (SizeOfRegion == size) {
+		vm_area_remove(list, area);
+	} else if (SizeOfRegion > size) {
+		if (area->start == address) {
+			/* shrink from the start */
+			area->start = VOID_PTR_ADD(area->start, size);
+			area->node.key.addr = (unsigned long)area->start;
+			vm_area_update_gap(list, area);
+		} else if (VOID_PTRS_SUB(area->end, address) + 1 == size) {
+			/* shrink from the end */
+			area->end = VOID_PTR_SUB(area->end, size);
+			vm_area_update_gap(list, area->next);
+		} else {
+			/*
+			 * split the area to: [area->start, address - 1]
+			 * and [address + size, area->end]
+			 */
+			void *end = area->end;
+
+			area->end = VOID_PTR_SUB(address, 1);
+			if (!vm_area_insert(list, area, area->next,
+					    VOID_PTR_ADD(address, size), end)) {
+				area->end = end;
+				return -ENOMEM;
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VM_AREA_H_
+#define VM_AREA_H_
+
+#include <stdint.h>
+#include "rbtree.h"
+
+/* Reserved range of an aperture's virtual address space. Areas never
+ * overlap and are kept both in an address ordered list and in a tree
+ * augmented with the largest free gap of each subtree.
+ */
+struct vm_area {
+	void *start;
+	void *end;
+	struct vm_area *next;
+	struct vm_area *prev;
+	rbtree_node_t node;
+	uint64_t gap;		/* free bytes between prev and this area, 0 for the first */
+	uint64_t subtree_gap;	/* largest gap in the subtree rooted at node */
+};
+typedef struct vm_area vm_area_t;
+
+typedef struct {
+	vm_area_t *head;
+	rbtree_t tree;
+} vm_area_list_t;
+
+void hsakmt_vm_area_list_init(vm_area_list_t *list);
+
+/* Frees all areas */
+void hsakmt_vm_area_list_clear(vm_area_list_t *list);
+
+/* Returns the area containing address, NULL if there is none */
+vm_area_t *hsakmt_vm_area_find(vm_area_list_t *list, void *address);
+
+/* Reserves size bytes in [base, limit] and returns their start, or NULL.
+ *
+ * If address is not NULL, the range must start at address and must not
+ * overlap or follow an area before its align-aligned end. Otherwise the
+ * range starts at offset from an align boundary after the base or after the
+ * end of an area, preferring the lowest hole that fits regardless of its
+ * alignment padding.
+ */
+void *hsakmt_vm_area_reserve(vm_area_list_t *list, void *base, void *limit,
+			     void *address, uint64_t size, uint64_t align,
+			     uint64_t offset);
+
+/* Releases size bytes at address from the area containing address.
+ * Returns 0 on success, -ENOENT if no area contains address and -ENOMEM if
+ * the area could not be split.
+ */
+int hsakmt_vm_area_release(vm_area_list_t *list, void *address,
+			   uint64_t size);
+
+#endif /* VM_AREA_H_ */
@@ -0,0 +1,388 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Micro-benchmarks of the thunk paths which don't need the GPU to execute
+ * anything: memory allocation, mapping and lookup, events, queues and
+ * clock counters. Meant to run against a libhsakmt built with
+ * -DBUILD_FAKE_KFD=ON, HSA_FAKE_KFD=1 is set unless the environment says
+ * otherwise, so the same numbers can be taken on real hardware with
+ * HSA_FAKE_KFD=0.
+ *
+ * Usage: fake_kfd_bench [-n iterations] [benchmark name ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "hsakmt/hsakmt.h"
+
+#define BENCH_QUEUE_SIZE	(64 * 1024)
+
+static HSAuint32 gpu_node;
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+#define CHECK(call)							\
+	do {								\
+		HSAKMT_STATUS _status = (call);				\
+		if (_status != HSAKMT_STATUS_SUCCESS) {			\
+			fprintf(stderr, "%s:%d: %s failed: %d\n",	\
+				__FILE__, __LINE__, #call, _status);	\
+			return -1;					\
+		}							\
+	} while (0)
+
+static HsaMemFlags vram_flags(void)
+{
+	HsaMemFlags flags = {0};
+
+	flags.ui32.NonPaged = 1;
+	flags.ui32.NoNUMABind = 1;
+	flags.ui32.PageSize = HSA_PAGE_SIZE_4KB;
+	return flags;
+}
+
+static HsaMemFlags system_flags(void)
+{
+	HsaMemFlags flags = {0};
+
+	flags.ui32.HostAccess = 1;
+	flags.ui32.NoNUMABind = 1;
+	flags.ui32.PageSize = HSA_PAGE_SIZE_4KB;
+	return flags;
+}
+
+static int alloc_free(unsigned int iters, HSAuint32 node, HsaMemFlags flags,
+		      HSAuint64 size)
+{
+	unsigned int i;
+	void *mem;
+
+	for (i = 0; i < iters; i++) {
+		CHECK(hsaKmtAllocMemory(node, size, flags, &mem));
+		CHECK(hsaKmtFreeMemory(mem, size));
+	}
+	return 0;
+}
+
+static int bench_vram_4k(unsigned int iters)
+{
+	return alloc_free(iters, gpu_node, vram_flags(), 4096);
+}
+
+static int bench_vram_2m(unsigned int iters)
+{
+	return alloc_free(iters, gpu_node, vram_flags(), 2 << 20);
+}
+
+static int bench_system_4k(unsigned int iters)
+{
+	return alloc_free(iters, 0, system_flags(), 4096);
+}
+
+static int bench_map_unmap(unsigned int iters)
+{
+	HSAuint64 size = 2 << 20, gpuva;
+	unsigned int i;
+	void *mem;
+
+	CHECK(hsaKmtAllocMemory(gpu_node, size, vram_flags(), &mem));
+	for (i = 0; i < iters; i++) {
+		CHECK(hsaKmtMapMemoryToGPU(mem, size, &gpuva));
+		CHECK(hsaKmtUnmapMemoryToGPU(mem));
+	}
+	CHECK(hsaKmtFreeMemory(mem, size));
+	return 0;
+}
+
+static int bench_register_userptr(unsigned int iters)
+{
+	HSAuint64 size = 2 << 20;
+	unsigned int i;
+	void *mem;
+
+	mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED)
+		return -1;
+	for (i = 0; i < iters; i++) {
+		CHECK(hsaKmtRegisterMemory(mem, size));
+		CHECK(hsaKmtDeregisterMemory(mem));
+	}
+	munmap(mem, size);
+	return 0;
+}
+
+/* Lookups among 1024 live allocations */
+static int bench_pointer_info(unsigned int iters)
+{
+	enum { NUM_BUFFERS = 1024 };
+	static void *mem[NUM_BUFFERS];
+	HsaPointerInfo info;
+	unsigned int i;
+
+	for (i = 0; i < NUM_BUFFERS; i++)
+		CHECK(hsaKmtAllocMemory(gpu_node, 4096, vram_flags(), &mem[i]));
+	for (i = 0; i < iters; i++)
+		CHECK(hsaKmtQueryPointerInfo(mem[(i * 7919) % NUM_BUFFERS], &info));
+	for (i = 0; i < NUM_BUFFERS; i++)
+		CHECK(hsaKmtFreeMemory(mem[i], 4096));
+	return 0;
+}
+
+static int create_event(HsaEvent **event)
+{
+	HsaEventDescriptor desc = {0};
+
+	desc.EventType = HSA_EVENTTYPE_SIGNAL;
+	desc.NodeId = gpu_node;
+	desc.SyncVar.SyncVar.UserData = NULL;
+	desc.SyncVar.SyncVarSize = sizeof(HSAuint64);
+
+	CHECK(hsaKmtCreateEvent(&desc, false, false, event));
+	return 0;
+}
+
+static int bench_event_create(unsigned int iters)
+{
+	unsigned int i;
+	HsaEvent *event;
+
+	for (i = 0; i < iters; i++) {
+		if (create_event(&event))
+			return -1;
+		CHECK(hsaKmtDestroyEvent(event));
+	}
+	return 0;
+}
+
+static int bench_event_signal_wait(unsigned int iters)
+{
+	unsigned int i;
+	HsaEvent *event;
+
+	if (create_event(&event))
+		return -1;
+	for (i = 0; i < iters; i++) {
+		CHECK(hsaKmtSetEvent(event));
+		CHECK(hsaKmtWaitOnEvent(event, 1000));
+	}
+	CHECK(hsaKmtDestroyEvent(event));
+	return 0;
+}
+
+/* Signal one of 8 events and wait on all of them, list and wait set */
+static int bench_multi_wait(unsigned int iters, bool wait_set)
+{
+	enum { NUM_EVENTS = 8 };
+	HsaEvent *events[NUM_EVENTS];
+	HSAuint64 ages[NUM_EVENTS];
+	HsaEventWaitSet *set;
+	unsigned int i;
+
+	CHECK(hsaKmtCreateEventWaitSet(NUM_EVENTS, &set));
+	for (i = 0; i < NUM_EVENTS; i++) {
+		if (create_event(&events[i]))
+			return -1;
+		ages[i] = 1;
+		CHECK(hsaKmtEventWaitSetAdd(set, events[i], 1));
+	}
+
+	for (i = 0; i < iters; i++) {
+		CHECK(hsaKmtSetEvent(events[i % NUM_EVENTS]));
+		if (wait_set)
+			CHECK(hsaKmtWaitOnEventWaitSet(set, false, 1000));
+		else
+			CHECK(hsaKmtWaitOnMultipleEvents_Ext(events, NUM_EVENTS,
+							     false, 1000, ages));
+	}
+
+	CHECK(hsaKmtDestroyEventWaitSet(set));
+	for (i = 0; i < NUM_EVENTS; i++)
+		CHECK(hsaKmtDestroyEvent(events[i]));
+	return 0;
+}
+
+static int bench_wait_list(unsigned int iters)
+{
+	return bench_multi_wait(iters, false);
+}
+
+static int bench_wait_set(unsigned int iters)
+{
+	return bench_multi_wait(iters, true);
+}
+
+static int bench_queue_create(unsigned int iters)
+{
+	HsaQueueResource res;
+	unsigned int i;
+	void *ring;
+
+	CHECK(hsaKmtAllocMemory(0, BENCH_QUEUE_SIZE, system_flags(), &ring));
+	CHECK(hsaKmtMapMemoryToGPU(ring, BENCH_QUEUE_SIZE, NULL));
+	for (i = 0; i < iters; i++) {
+		memset(&res, 0, sizeof(res));
+		CHECK(hsaKmtCreateQueue(gpu_node, HSA_QUEUE_COMPUTE_AQL, 100,
+					HSA_QUEUE_PRIORITY_NORMAL, ring,
+					BENCH_QUEUE_SIZE, NULL, &res));
+		CHECK(hsaKmtDestroyQueue(res.QueueId));
+	}
+	CHECK(hsaKmtUnmapMemoryToGPU(ring));
+	CHECK(hsaKmtFreeMemory(ring, BENCH_QUEUE_SIZE));
+	return 0;
+}
+
+static int bench_clock_counters(unsigned int iters)
+{
+	HsaClockCounters counters;
+	unsigned int i;
+
+	for (i = 0; i < iters; i++)
+		CHECK(hsaKmtGetClockCounters(gpu_node, &counters));
+	return 0;
+}
+
+static int bench_topology(unsigned int iters)
+{
+	HsaSystemProperties props;
+	unsigned int i;
+
+	for (i = 0; i < iters; i++) {
+		CHECK(hsaKmtAcquireSystemProperties(&props));
+		CHECK(hsaKmtReleaseSystemProperties());
+	}
+	return 0;
+}
+
+static const struct {
+	const char *name;
+	int (*run)(unsigned int iters);
+	/* Fraction of the iterations for slow benchmarks */
+	unsigned int divisor;
+} benchmarks[] = {
+	{ "vram_alloc_4k", bench_vram_4k, 1 },
+	{ "vram_alloc_2m", bench_vram_2m, 1 },
+	{ "system_alloc_4k", bench_system_4k, 1 },
+	{ "map_unmap", bench_map_unmap, 1 },
+	{ "register_userptr", bench_register_userptr, 1 },
+	{ "pointer_info", bench_pointer_info, 1 },
+	{ "event_create", bench_event_create, 1 },
+	{ "event_signal_wait", bench_event_signal_wait, 1 },
+	{ "wait_any_list", bench_wait_list, 1 },
+	{ "wait_any_set", bench_wait_set, 1 },
+	{ "queue_create", bench_queue_create, 10 },
+	{ "clock_counters", bench_clock_counters, 1 },
+	{ "topology_snapshot", bench_topology, 100 },
+};
+
+static bool selected(const char *name, int argc, char *argv[])
+{
+	int i;
+
+	if (optind >= argc)
+		return true;
+	for (i = optind; i < argc; i++)
+		if (!strcmp(name, argv[i]))
+			return true;
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int iters = 10000, n, i;
+	HsaSystemProperties sys_props;
+	HsaNodeProperties props;
+	int opt, errors = 0;
+	double start;
+
+	while ((opt = getopt(argc, argv, "n:")) != -1) {
+		switch (opt) {
+		case 'n':
+			iters = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-n iterations] [benchmark ...]\n",
+				argv[0]);
+			return 1;
+		}
+	}
+	if (!iters)
+		return 1;
+
+	setenv("HSA_FAKE_KFD", "1", 0);
+
+	if (hsaKmtOpenKFD() != HSAKMT_STATUS_SUCCESS) {
+		fprintf(stderr, "Failed to open KFD\n");
+		return 1;
+	}
+	if (hsaKmtAcquireSystemProperties(&sys_props) != HSAKMT_STATUS_SUCCESS) {
+		fprintf(stderr, "Failed to read the topology\n");
+		hsaKmtCloseKFD();
+		return 1;
+	}
+	for (gpu_node = 0; gpu_node < sys_props.NumNodes; gpu_node++)
+		if (!hsaKmtGetNodeProperties(gpu_node, &props) &&
+		    props.NumFComputeCores)
+			break;
+	if (gpu_node == sys_props.NumNodes) {
+		fprintf(stderr, "No GPU node\n");
+		hsaKmtReleaseSystemProperties();
+		hsaKmtCloseKFD();
+		return 1;
+	}
+	printf("%u nodes, benchmarking GPU node %u (%s KFD)\n", sys_props.NumNodes,
+	       gpu_node, strcmp(getenv("HSA_FAKE_KFD"), "0") ? "fake" : "real");
+
+	for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+		if (!selected(benchmarks[i].name, argc, argv))
+			continue;
+
+		n = iters / benchmarks[i].divisor ? iters / benchmarks[i].divisor : 1;
+		start = now_us();
+		if (benchmarks[i].run(n)) {
+			printf("  %-20s failed\n", benchmarks[i].name);
+			errors++;
+			continue;
+		}
+		printf("  %-20s %10.3f us/op (%u ops)\n", benchmarks[i].name,
+		       (now_us() - start) / n, n);
+	}
+
+	hsaKmtReleaseSystemProperties();
+	hsaKmtCloseKFD();
+
+	printf("%d errors\n", errors);
+	return !!errors;
+}
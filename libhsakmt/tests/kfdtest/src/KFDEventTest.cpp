@@ -182,6 +182,95 @@ TEST_F(KFDEventTest, SignalEventExt) {
     TEST_END;
 }
 
+TEST_F(KFDEventTest, EventWaitSet) {
+    TEST_START(TESTPROFILE_RUNALL);
+
+    static const unsigned int EVENT_NUMBER = 4;
+    static const unsigned int REPS = 10000;
+
+    PM4Queue queue;
+    HsaEvent* pHsaEvent[EVENT_NUMBER];
+    HsaEventWaitSet* waitSet;
+    uint64_t event_age[EVENT_NUMBER];
+    unsigned int i;
+
+    if (m_VersionInfo.KernelInterfaceMajorVersion == 1 &&
+		m_VersionInfo.KernelInterfaceMinorVersion < 14) {
+        LOG() << "event age tracking isn't supported in KFD. Exiting." << std::endl;
+        return;
+    }
+
+    int defaultGPUNode = m_NodeInfo.HsaDefaultGPUNode();
+    ASSERT_GE(defaultGPUNode, 0) << "failed to get default GPU Node";
+
+    for (i = 0; i < EVENT_NUMBER; i++)
+        ASSERT_SUCCESS(CreateQueueTypeEvent(false, false, defaultGPUNode, &pHsaEvent[i]));
+
+    ASSERT_SUCCESS(hsaKmtCreateEventWaitSet(1, &waitSet));
+    /* Grows past the initial capacity */
+    for (i = 0; i < EVENT_NUMBER; i++)
+        ASSERT_SUCCESS(hsaKmtEventWaitSetAdd(waitSet, pHsaEvent[i], 1));
+
+    ASSERT_SUCCESS(queue.Create(defaultGPUNode));
+
+    /* 1. Any event of the set wakes up the waiter */
+    queue.PlaceAndSubmitPacket(PM4ReleaseMemoryPacket(m_FamilyId, false,
+                    pHsaEvent[2]->EventData.HWData2, pHsaEvent[2]->EventId));
+    EXPECT_SUCCESS(hsaKmtWaitOnEventWaitSet(waitSet, false, g_TestTimeOut));
+
+    /* 2. The age of the event was updated in the set, so without a new
+     * signal the next wait sleeps
+     */
+    EXPECT_EQ(HSAKMT_STATUS_WAIT_TIMEOUT, hsaKmtWaitOnEventWaitSet(waitSet, false, 100));
+
+    /* 3. Signaling from CPU */
+    EXPECT_SUCCESS(hsaKmtSetEvent(pHsaEvent[0]));
+    EXPECT_SUCCESS(hsaKmtWaitOnEventWaitSet(waitSet, false, g_TestTimeOut));
+
+    /* 4. Removed events don't wake up the waiter anymore */
+    EXPECT_SUCCESS(hsaKmtEventWaitSetRemove(waitSet, pHsaEvent[0]));
+    EXPECT_EQ(HSAKMT_STATUS_INVALID_PARAMETER, hsaKmtEventWaitSetRemove(waitSet, pHsaEvent[0]));
+    EXPECT_SUCCESS(hsaKmtSetEvent(pHsaEvent[0]));
+    EXPECT_EQ(HSAKMT_STATUS_WAIT_TIMEOUT, hsaKmtWaitOnEventWaitSet(waitSet, false, 100));
+    queue.PlaceAndSubmitPacket(PM4ReleaseMemoryPacket(m_FamilyId, false,
+                    pHsaEvent[3]->EventData.HWData2, pHsaEvent[3]->EventId));
+    EXPECT_SUCCESS(hsaKmtWaitOnEventWaitSet(waitSet, false, g_TestTimeOut));
+
+    /* 5. An empty set can't be waited on */
+    EXPECT_SUCCESS(hsaKmtEventWaitSetClear(waitSet));
+    EXPECT_EQ(HSAKMT_STATUS_INVALID_PARAMETER, hsaKmtWaitOnEventWaitSet(waitSet, false, 0));
+
+    /* 6. Compare signal and wait round trips with the per-call event list */
+    EXPECT_SUCCESS(hsaKmtEventWaitSetAdd(waitSet, pHsaEvent[1], 1));
+    HSAuint64 startTime = GetSystemTickCountInMicroSec();
+    for (i = 0; i < REPS; i++) {
+        hsaKmtSetEvent(pHsaEvent[1]);
+        ASSERT_SUCCESS(hsaKmtWaitOnEventWaitSet(waitSet, false, g_TestTimeOut));
+    }
+    HSAuint64 waitSetTime = GetSystemTickCountInMicroSec() - startTime;
+
+    for (i = 0; i < EVENT_NUMBER; i++)
+        event_age[i] = 1;
+    startTime = GetSystemTickCountInMicroSec();
+    for (i = 0; i < REPS; i++) {
+        hsaKmtSetEvent(pHsaEvent[1]);
+        ASSERT_SUCCESS(hsaKmtWaitOnMultipleEvents_Ext(&pHsaEvent[1], 1, false,
+                                                      g_TestTimeOut, &event_age[1]));
+    }
+    HSAuint64 extTime = GetSystemTickCountInMicroSec() - startTime;
+
+    LOG() << "Signal and wait, wait set: " << std::dec << (double)waitSetTime / REPS
+          << " us, event list: " << (double)extTime / REPS << " us" << std::endl;
+
+    EXPECT_SUCCESS(hsaKmtDestroyEventWaitSet(waitSet));
+    EXPECT_SUCCESS(queue.Destroy());
+
+    for (i = 0; i < EVENT_NUMBER; i++)
+        EXPECT_SUCCESS(hsaKmtDestroyEvent(pHsaEvent[i]));
+
+    TEST_END;
+}
+
 static uint64_t gettime() {
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
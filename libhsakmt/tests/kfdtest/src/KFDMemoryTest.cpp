@@ -223,6 +223,74 @@ TEST_F(KFDMemoryTest , MapMemoryToGPU) {
     TEST_END
 }
 
+// Map and unmap many buffers with hsaKmtMapMemoryToGPUNodesBatch and
+// hsaKmtUnmapMemoryToGPUBatch and compare with one call per buffer
+TEST_F(KFDMemoryTest, MapMemoryToGPUNodesBatch) {
+    TEST_REQUIRE_ENV_CAPABILITIES(ENVCAPS_64BITLINUX);
+    TEST_START(TESTPROFILE_RUNALL)
+
+    const unsigned nBufs = 512;
+    const std::vector<int> gpuNodes = m_NodeInfo.GetNodesWithGPU();
+    std::vector<HSAuint32> mapNodes(gpuNodes.begin(), gpuNodes.end());
+    std::vector<HsaMemMapRange> ranges(nBufs + 1);
+    std::vector<void *> bufs(nBufs);
+    HsaMemMapFlags mapFlags = {0};
+    HsaMemFlags memFlags = {0};
+    HsaPointerInfo info;
+    HSAuint64 start, singleTime, batchTime;
+    unsigned i;
+
+    if (!hsakmt_is_dgpu()) {
+        LOG() << "Skipping test: Test requires a dGPU." << std::endl;
+        return;
+    }
+
+    memFlags.ui32.PageSize = HSA_PAGE_SIZE_4KB;
+    memFlags.ui32.HostAccess = 1;
+    memFlags.ui32.NonPaged = 0;
+    memFlags.ui32.NoNUMABind = 1;
+
+    for (i = 0; i < nBufs; i++) {
+        ASSERT_SUCCESS(hsaKmtAllocMemory(0, PAGE_SIZE, memFlags, &bufs[i]));
+        ranges[i].MemoryAddress = bufs[i];
+        ranges[i].MemorySizeInBytes = PAGE_SIZE;
+    }
+    /* The same buffer twice is mapped once */
+    ranges[nBufs] = ranges[0];
+
+    start = GetSystemTickCountInMicroSec();
+    for (i = 0; i < nBufs; i++)
+        EXPECT_SUCCESS(hsaKmtMapMemoryToGPUNodes(bufs[i], PAGE_SIZE, NULL, mapFlags,
+                                                 mapNodes.size(), &mapNodes[0]));
+    for (i = 0; i < nBufs; i++)
+        EXPECT_SUCCESS(hsaKmtUnmapMemoryToGPU(bufs[i]));
+    singleTime = GetSystemTickCountInMicroSec() - start;
+
+    start = GetSystemTickCountInMicroSec();
+    EXPECT_SUCCESS(hsaKmtMapMemoryToGPUNodesBatch(&ranges[0], ranges.size(), mapFlags,
+                                                  mapNodes.size(), &mapNodes[0]));
+    for (i = 0; i < ranges.size(); i++)
+        EXPECT_SUCCESS(ranges[i].Status);
+    EXPECT_SUCCESS(hsaKmtQueryPointerInfo(bufs[0], &info));
+    EXPECT_EQ(mapNodes.size(), info.NMappedNodes);
+    EXPECT_SUCCESS(hsaKmtUnmapMemoryToGPUBatch(&ranges[0], nBufs));
+    batchTime = GetSystemTickCountInMicroSec() - start;
+
+    for (i = 0; i < nBufs; i++) {
+        EXPECT_SUCCESS(ranges[i].Status);
+        EXPECT_SUCCESS(hsaKmtQueryPointerInfo(bufs[i], &info));
+        EXPECT_EQ(0, info.NMappedNodes);
+    }
+
+    LOG() << std::dec << nBufs << " buffers on " << mapNodes.size() << " GPUs: "
+          << singleTime << "us per buffer calls, " << batchTime << "us batched" << std::endl;
+
+    for (i = 0; i < nBufs; i++)
+        EXPECT_SUCCESS(hsaKmtFreeMemory(bufs[i], PAGE_SIZE));
+
+    TEST_END
+}
+
 // Following tests are for hsaKmtAllocMemory with invalid params
 TEST_F(KFDMemoryTest, InvalidMemoryPointerAlloc) {
     TEST_START(TESTPROFILE_RUNALL)
@@ -254,6 +322,44 @@ TEST_F(KFDMemoryTest, MemoryAlloc) {
     TEST_END
 }
 
+// Huge page and NUMA interleaved system memory, with fallback to smaller pages
+TEST_F(KFDMemoryTest, MemoryAllocHugePages) {
+    TEST_START(TESTPROFILE_RUNALL)
+
+    static const struct {
+        HSA_PAGE_SIZE flag;
+        HSAuint64 size;
+    } pageSizes[] = {{HSA_PAGE_SIZE_2MB, 2ULL << 20}, {HSA_PAGE_SIZE_1GB, 1ULL << 30}};
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(pageSizes); i++) {
+        const HSAuint64 size = pageSizes[i].size * 2;
+
+        for (unsigned int interleave = 0; interleave < 2; interleave++) {
+            HsaMemFlags memFlags = m_MemoryFlags;
+            HSAuint64 *buf = NULL;
+
+            memFlags.ui32.PageSize = pageSizes[i].flag;
+            memFlags.ui32.NUMAInterleave = interleave;
+
+            /* Size must be a multiple of the page size */
+            EXPECT_NE(HSAKMT_STATUS_SUCCESS, hsaKmtAllocMemory(0 /* system */, PAGE_SIZE,
+                                                               memFlags, reinterpret_cast<void**>(&buf)));
+
+            ASSERT_SUCCESS(hsaKmtAllocMemory(0 /* system */, size, memFlags, reinterpret_cast<void**>(&buf)));
+            EXPECT_EQ(0, reinterpret_cast<HSAuint64>(buf) & (pageSizes[i].size - 1));
+
+            for (HSAuint64 off = 0; off < size / sizeof(*buf); off += PAGE_SIZE / sizeof(*buf))
+                buf[off] = off;
+            for (HSAuint64 off = 0; off < size / sizeof(*buf); off += PAGE_SIZE / sizeof(*buf))
+                EXPECT_EQ(off, buf[off]);
+
+            EXPECT_SUCCESS(hsaKmtFreeMemory(buf, size));
+        }
+    }
+
+    TEST_END
+}
+
 // Basic test for hsaKmtAllocMemory
 TEST_F(KFDMemoryTest, MemoryAllocAll) {
     TEST_START(TESTPROFILE_RUNALL)
@@ -2812,6 +2918,127 @@ TEST_F(KFDMemoryTest, MultiThreadRegisterUserptrTest) {
     TEST_END
 }
 
+/* Lookup threads query random buffers while an optional allocator thread
+ * keeps allocating and freeing in the same aperture. Reports the lookup
+ * throughput per thread count to quantify lock contention in pointer
+ * queries.
+ */
+#define LOOKUP_BENCH_BUFS       1024
+#define LOOKUP_BENCH_QUERIES    200000
+#define LOOKUP_BENCH_MAX_THREADS 16
+
+struct LookupBenchParams {
+    void **bufs;
+    HSAuint32 node;
+    HsaMemFlags memFlags;
+    unsigned seed;
+    volatile bool *stop;
+    pthread_barrier_t *barrier;
+    HSAuint64 count;
+};
+
+static unsigned int LookupBenchQueryThread(void* p) {
+    struct LookupBenchParams* pArgs = reinterpret_cast<struct LookupBenchParams*>(p);
+    HsaPointerInfo info;
+    HSAuint64 i;
+    unsigned fails = 0;
+
+    pthread_barrier_wait(pArgs->barrier);
+    for (i = 0; i < LOOKUP_BENCH_QUERIES; i++) {
+        void *buf = pArgs->bufs[rand_r(&pArgs->seed) % LOOKUP_BENCH_BUFS];
+
+        if (hsaKmtQueryPointerInfo(buf, &info) != HSAKMT_STATUS_SUCCESS ||
+            info.CPUAddress != buf)
+            fails++;
+    }
+    pArgs->count = i;
+    EXPECT_EQ(0U, fails);
+
+    return 0;
+}
+
+static unsigned int LookupBenchAllocThread(void* p) {
+    struct LookupBenchParams* pArgs = reinterpret_cast<struct LookupBenchParams*>(p);
+    void *buf;
+
+    pthread_barrier_wait(pArgs->barrier);
+    for (pArgs->count = 0; !*pArgs->stop; pArgs->count++) {
+        EXPECT_SUCCESS(hsaKmtAllocMemory(pArgs->node, PAGE_SIZE, pArgs->memFlags, &buf));
+        EXPECT_SUCCESS(hsaKmtFreeMemory(buf, PAGE_SIZE));
+    }
+
+    return 0;
+}
+
+TEST_F(KFDMemoryTest, PointerInfoLookupBench) {
+    TEST_REQUIRE_ENV_CAPABILITIES(ENVCAPS_64BITLINUX);
+    TEST_START(TESTPROFILE_RUNALL);
+
+    HsaMemFlags memFlags = {0};
+    void *bufs[LOOKUP_BENCH_BUFS];
+    struct LookupBenchParams params[LOOKUP_BENCH_MAX_THREADS + 1];
+    HSAuint64 threadId[LOOKUP_BENCH_MAX_THREADS + 1];
+    unsigned i, nThreads;
+
+    memFlags.ui32.PageSize = HSA_PAGE_SIZE_4KB;
+    memFlags.ui32.HostAccess = 1;
+    memFlags.ui32.NonPaged = 0;
+    memFlags.ui32.NoNUMABind = 1;
+
+    for (i = 0; i < LOOKUP_BENCH_BUFS; i++)
+        ASSERT_SUCCESS(hsaKmtAllocMemory(0, PAGE_SIZE, memFlags, &bufs[i]));
+
+    LOG() << "Threads\tAllocator\tlookups/s\tallocs/s" << std::endl;
+    for (int withAlloc = 0; withAlloc < 2; withAlloc++) {
+        for (nThreads = 1; nThreads <= LOOKUP_BENCH_MAX_THREADS; nThreads <<= 1) {
+            unsigned nTotal = nThreads + withAlloc;
+            volatile bool stop = false;
+            pthread_barrier_t barrier;
+            HSAuint64 start, elapsed, lookups = 0;
+
+            ASSERT_SUCCESS(pthread_barrier_init(&barrier, NULL, nTotal + 1));
+            for (i = 0; i < nTotal; i++) {
+                params[i].bufs = bufs;
+                params[i].node = 0;
+                params[i].memFlags = memFlags;
+                params[i].seed = i + 1;
+                params[i].stop = &stop;
+                params[i].barrier = &barrier;
+                params[i].count = 0;
+                ASSERT_EQ(true, StartThread(i < nThreads ? &LookupBenchQueryThread :
+                                            &LookupBenchAllocThread,
+                                            &params[i], threadId[i]));
+            }
+
+            pthread_barrier_wait(&barrier);
+            start = GetSystemTickCountInMicroSec();
+            for (i = 0; i < nThreads; i++) {
+                WaitForThread(threadId[i]);
+                lookups += params[i].count;
+            }
+            elapsed = GetSystemTickCountInMicroSec() - start;
+            stop = true;
+            if (withAlloc)
+                WaitForThread(threadId[nThreads]);
+            pthread_barrier_destroy(&barrier);
+
+            if (!elapsed)
+                elapsed = 1;
+            LOG() << std::dec << nThreads << "\t" << (withAlloc ? "yes" : "no") << "\t\t"
+                  << lookups * 1000000 / elapsed << "\t"
+                  << (withAlloc ? params[nThreads].count * 1000000 / elapsed : 0)
+                  << std::endl;
+            RECORD(lookups * 1000000 / elapsed) << "PointerInfoLookup-" << nThreads
+                  << (withAlloc ? "-Alloc" : "");
+        }
+    }
+
+    for (i = 0; i < LOOKUP_BENCH_BUFS; i++)
+        EXPECT_SUCCESS(hsaKmtFreeMemory(bufs[i], PAGE_SIZE));
+
+    TEST_END
+}
+
 TEST_F(KFDMemoryTest, ExportDMABufTest) {
     TEST_REQUIRE_ENV_CAPABILITIES(ENVCAPS_64BITLINUX);
     TEST_START(TESTPROFILE_RUNALL);
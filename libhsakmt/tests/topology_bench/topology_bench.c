@@ -0,0 +1,399 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Times topology snapshots with a serial and a parallel sysfs walk and with
+ * a cold and warm topology cache. All snapshots must describe the same
+ * topology. By default the topology of the running system is read. With
+ * -s a synthetic sysfs and procfs tree of CPU nodes with per-CPU caches is
+ * generated and used instead, which still needs /dev/kfd to be opened.
+ * The synthetic tree has at most as many CPUs as the system since the
+ * CPU cache parser indexes /proc/cpuinfo by CPU number.
+ *
+ * Usage: topology_bench [-s nodes] [-c cpus per node] [-n iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/sysinfo.h>
+#include "hsakmt/hsakmt.h"
+
+#define BENCH_CACHE_LEVELS	4	/* L1d, L1i, L2 per CPU, L3 per node */
+
+static char bench_dir[] = "/tmp/topology_bench.XXXXXX";
+static int acquired;
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int write_file(const char *content, const char *fmt, ...)
+{
+	char path[512], *p;
+	va_list ap;
+	FILE *fd;
+
+	va_start(ap, fmt);
+	vsnprintf(path, sizeof(path), fmt, ap);
+	va_end(ap);
+
+	/* mkdir -p the parent directories */
+	for (p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+		*p = '\0';
+		mkdir(path, 0755);
+		*p = '/';
+	}
+
+	fd = fopen(path, "w");
+	if (!fd) {
+		perror(path);
+		return -1;
+	}
+	fputs(content, fd);
+	fclose(fd);
+	return 0;
+}
+
+/* Formats the CPU mask [first, last] the way sysfs shared_cpu_map does */
+static void cpu_map(char *buf, int total_cpus, int first, int last)
+{
+	int word, bit, len = 0;
+	unsigned int mask;
+
+	for (word = (total_cpus - 1) / 32; word >= 0; word--) {
+		mask = 0;
+		for (bit = 0; bit < 32; bit++)
+			if (word * 32 + bit >= first && word * 32 + bit <= last)
+				mask |= 1U << bit;
+		len += sprintf(buf + len, "%08x%s", mask, word ? "," : "\n");
+	}
+}
+
+static int create_synthetic_tree(int nodes, int cpus)
+{
+	static const char *cache_type[BENCH_CACHE_LEVELS] = {
+		"Data", "Instruction", "Unified", "Unified"
+	};
+	static const int cache_level[BENCH_CACHE_LEVELS] = { 1, 1, 2, 3 };
+	static const char *cache_size[BENCH_CACHE_LEVELS] = {
+		"32K", "32K", "1024K", "32768K"
+	};
+	const char *kfd = "%s/sys/devices/virtual/kfd/kfd/topology";
+	char buf[4096], prefix[256];
+	int n, m, c, idx, cpu, first, last, len, ret = 0;
+	FILE *fd;
+
+	ret |= write_file("1\n", "%s/sys/devices/virtual/kfd/kfd/topology/generation_id",
+			  bench_dir);
+	ret |= write_file("platform_oem 0\nplatform_id 0\nplatform_rev 0\n",
+			  "%s/sys/devices/virtual/kfd/kfd/topology/system_properties",
+			  bench_dir);
+	ret |= write_file("8f3c2a7e-5b1d-4c0e-9a6f-2d7b8e1c4f90\n",
+			  "%s/proc/sys/kernel/random/boot_id", bench_dir);
+
+	for (n = 0; n < nodes && !ret; n++) {
+		snprintf(prefix, sizeof(prefix), kfd, bench_dir);
+		ret |= write_file("0\n", "%s/nodes/%d/gpu_id", prefix, n);
+		snprintf(buf, sizeof(buf),
+			 "cpu_cores_count %d\nsimd_count 0\nmem_banks_count 1\n"
+			 "caches_count 0\nio_links_count %d\np2p_links_count 0\n"
+			 "cpu_core_id_base %d\nsimd_id_base 0\nmax_waves_per_simd 0\n"
+			 "lds_size_in_kb 0\ngds_size_in_kb 0\nwave_front_size 0\n"
+			 "array_count 0\nsimd_arrays_per_engine 0\n"
+			 "cu_per_simd_array 0\nsimd_per_cu 0\nmax_slots_scratch_cu 0\n"
+			 "vendor_id 0\ndevice_id 0\nlocation_id 0\ndomain 0\n"
+			 "drm_render_minor 0\nhive_id 0\nnum_sdma_engines 0\n"
+			 "num_sdma_xgmi_engines 0\nnum_sdma_queues_per_engine 0\n"
+			 "num_cp_queues 0\nmax_engine_clk_fcompute 0\n"
+			 "local_mem_size 0\nfw_version 0\ncapability 0\n"
+			 "debug_prop 0\nsdma_fw_version 0\nunique_id 0\n"
+			 "num_xcc 0\nmax_engine_clk_ccompute 3700\n",
+			 cpus, nodes - 1, n * cpus);
+		ret |= write_file(buf, "%s/nodes/%d/properties", prefix, n);
+		ret |= write_file("heap_type 0\nsize_in_bytes 270582939648\n"
+				  "flags 0\nwidth 72\nmem_clk_max 3200\n",
+				  "%s/nodes/%d/mem_banks/0/properties", prefix, n);
+
+		for (m = 0, idx = 0; m < nodes; m++) {
+			if (m == n)
+				continue;
+			snprintf(buf, sizeof(buf),
+				 "type 2\nversion_major 0\nversion_minor 0\n"
+				 "node_from %d\nnode_to %d\nweight %d\n"
+				 "min_latency 0\nmax_latency 0\nmin_bandwidth 0\n"
+				 "max_bandwidth 0\nrecommended_transfer_size 0\n"
+				 "recommended_sdma_engine_id_mask 0\nflags 1\n",
+				 n, m, 21 + (m / 2 != n / 2) * 11);
+			ret |= write_file(buf, "%s/nodes/%d/io_links/%d/properties",
+					  prefix, n, idx++);
+		}
+
+		snprintf(prefix, sizeof(prefix), "%s/sys/devices/system/node/node%d",
+			 bench_dir, n);
+		for (c = 0; c < cpus && !ret; c++) {
+			cpu = n * cpus + c;
+			for (idx = 0; idx < BENCH_CACHE_LEVELS; idx++) {
+				first = idx < 3 ? cpu : n * cpus;
+				last = idx < 3 ? cpu : n * cpus + cpus - 1;
+				snprintf(buf, sizeof(buf), "%d\n", cache_level[idx]);
+				ret |= write_file(buf, "%s/cpu%d/cache/index%d/level",
+						  prefix, cpu, idx);
+				snprintf(buf, sizeof(buf), "%s\n", cache_type[idx]);
+				ret |= write_file(buf, "%s/cpu%d/cache/index%d/type",
+						  prefix, cpu, idx);
+				snprintf(buf, sizeof(buf), "%s\n", cache_size[idx]);
+				ret |= write_file(buf, "%s/cpu%d/cache/index%d/size",
+						  prefix, cpu, idx);
+				ret |= write_file("64\n", "%s/cpu%d/cache/index%d/coherency_line_size",
+						  prefix, cpu, idx);
+				ret |= write_file("8\n", "%s/cpu%d/cache/index%d/ways_of_associativity",
+						  prefix, cpu, idx);
+				ret |= write_file("1\n", "%s/cpu%d/cache/index%d/physical_line_partition",
+						  prefix, cpu, idx);
+				if (first == last)
+					snprintf(buf, sizeof(buf), "%d\n", first);
+				else
+					snprintf(buf, sizeof(buf), "%d-%d\n", first, last);
+				ret |= write_file(buf, "%s/cpu%d/cache/index%d/shared_cpu_list",
+						  prefix, cpu, idx);
+				cpu_map(buf, nodes * cpus, first, last);
+				ret |= write_file(buf, "%s/cpu%d/cache/index%d/shared_cpu_map",
+						  prefix, cpu, idx);
+			}
+		}
+	}
+	if (ret)
+		return ret;
+
+	snprintf(buf, sizeof(buf), "%s/proc/cpuinfo", bench_dir);
+	fd = fopen(buf, "w");
+	if (!fd) {
+		perror(buf);
+		return -1;
+	}
+	for (cpu = 0; cpu < nodes * cpus; cpu++) {
+		len = fprintf(fd, "processor\t: %d\nvendor_id\t: AuthenticAMD\n"
+			      "model name\t: Synthetic %d-node CPU\napicid\t\t: %d\n\n",
+			      cpu, nodes, cpu);
+		if (len < 0)
+			ret = -1;
+	}
+	fclose(fd);
+
+	snprintf(buf, sizeof(buf), "%s/sys", bench_dir);
+	setenv("HSA_SYSFS_ROOT", buf, 1);
+	snprintf(buf, sizeof(buf), "%s/proc", bench_dir);
+	setenv("HSA_PROCFS_ROOT", buf, 1);
+
+	return ret;
+}
+
+static void remove_tree(void)
+{
+	char cmd[128];
+
+	snprintf(cmd, sizeof(cmd), "rm -rf %s", bench_dir);
+	if (system(cmd))
+		fprintf(stderr, "Failed to remove %s\n", bench_dir);
+}
+
+/* Serializes everything the snapshot reports about all nodes */
+static void *dump_topology(const HsaSystemProperties *sys, size_t *size)
+{
+	HsaNodeProperties node;
+	size_t cap = 1 << 20, len = 0, need;
+	char *buf = malloc(cap);
+	HSAuint32 i;
+
+	for (i = 0; buf && i < sys->NumNodes; i++) {
+		if (hsaKmtGetNodeProperties(i, &node) != HSAKMT_STATUS_SUCCESS)
+			goto err;
+
+		need = sizeof(node) +
+			node.NumMemoryBanks * sizeof(HsaMemoryProperties) +
+			node.NumCaches * sizeof(HsaCacheProperties) +
+			node.NumIOLinks * sizeof(HsaIoLinkProperties);
+		while (len + need > cap) {
+			char *p = realloc(buf, cap *= 2);
+
+			if (!p)
+				goto err;
+			buf = p;
+		}
+
+		memcpy(buf + len, &node, sizeof(node));
+		len += sizeof(node);
+		if (hsaKmtGetNodeMemoryProperties(i, node.NumMemoryBanks,
+				(HsaMemoryProperties *)(buf + len)) != HSAKMT_STATUS_SUCCESS)
+			goto err;
+		len += node.NumMemoryBanks * sizeof(HsaMemoryProperties);
+		if (hsaKmtGetNodeCacheProperties(i, node.CComputeIdLo, node.NumCaches,
+				(HsaCacheProperties *)(buf + len)) != HSAKMT_STATUS_SUCCESS)
+			goto err;
+		len += node.NumCaches * sizeof(HsaCacheProperties);
+		if (hsaKmtGetNodeIoLinkProperties(i, node.NumIOLinks,
+				(HsaIoLinkProperties *)(buf + len)) != HSAKMT_STATUS_SUCCESS)
+			goto err;
+		len += node.NumIOLinks * sizeof(HsaIoLinkProperties);
+	}
+
+	*size = len;
+	return buf;
+
+err:
+	free(buf);
+	return NULL;
+}
+
+/* Takes @iterations snapshots and checks the last one against @ref */
+static int run_mode(const char *name, int iterations, const void *ref,
+		    size_t ref_size, void **dump, size_t *dump_size)
+{
+	HsaSystemProperties sys;
+	double start, total = 0, first = 0;
+	void *buf;
+	size_t size;
+	int i, ret = 0;
+
+	for (i = 0; i < iterations; i++) {
+		if (acquired)
+			hsaKmtReleaseSystemProperties();
+		start = now_us();
+		acquired = hsaKmtAcquireSystemProperties(&sys) == HSAKMT_STATUS_SUCCESS;
+		if (!acquired) {
+			fprintf(stderr, "%s: snapshot failed\n", name);
+			return -1;
+		}
+		if (!i)
+			first = now_us() - start;
+		total += now_us() - start;
+	}
+
+	buf = dump_topology(&sys, &size);
+	if (!buf) {
+		fprintf(stderr, "%s: failed to read the topology\n", name);
+		return -1;
+	}
+	if (ref && (size != ref_size || memcmp(buf, ref, size))) {
+		fprintf(stderr, "%s: topology differs from the serial walk\n", name);
+		ret = -1;
+	}
+
+	printf("%-16s %4u nodes  first %10.1f us  avg %10.1f us\n", name,
+	       sys.NumNodes, first, total / iterations);
+
+	if (dump) {
+		*dump = buf;
+		*dump_size = size;
+	} else {
+		free(buf);
+	}
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	int nodes = 0, cpus = 16, iterations = 20, opt, errors = 0;
+	char cache_path[64];
+	void *ref = NULL;
+	size_t ref_size = 0;
+
+	while ((opt = getopt(argc, argv, "s:c:n:")) != -1) {
+		switch (opt) {
+		case 's':
+			nodes = atoi(optarg);
+			break;
+		case 'c':
+			cpus = atoi(optarg);
+			break;
+		case 'n':
+			iterations = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-s nodes] [-c cpus per node] [-n iterations]\n",
+				argv[0]);
+			return 1;
+		}
+	}
+	if (iterations < 1 || cpus < 1 || nodes < 0)
+		return 1;
+
+	if (!mkdtemp(bench_dir)) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	if (nodes) {
+		if (nodes * cpus > get_nprocs())
+			cpus = get_nprocs() / nodes;
+		if (!cpus) {
+			fprintf(stderr, "At most %d synthetic nodes\n", get_nprocs());
+			remove_tree();
+			return 1;
+		}
+		if (create_synthetic_tree(nodes, cpus)) {
+			remove_tree();
+			return 1;
+		}
+		printf("Synthetic tree: %d nodes, %d CPUs and %d caches per node\n",
+		       nodes, cpus, cpus * BENCH_CACHE_LEVELS);
+	}
+
+	if (hsaKmtOpenKFD() != HSAKMT_STATUS_SUCCESS) {
+		fprintf(stderr, "Failed to open KFD\n");
+		remove_tree();
+		return 1;
+	}
+
+	unsetenv("HSA_TOPOLOGY_CACHE");
+	setenv("HSA_TOPOLOGY_THREADS", "1", 1);
+	errors += !!run_mode("serial walk", iterations, NULL, 0, &ref, &ref_size);
+
+	unsetenv("HSA_TOPOLOGY_THREADS");
+	errors += !!run_mode("parallel walk", iterations, ref, ref_size, NULL, NULL);
+
+	/* Only the first snapshot writes the cache, the others read it */
+	snprintf(cache_path, sizeof(cache_path), "%s/topology.cache", bench_dir);
+	setenv("HSA_TOPOLOGY_CACHE", cache_path, 1);
+	errors += !!run_mode("cold+warm cache", iterations, ref, ref_size, NULL, NULL);
+	errors += !!run_mode("warm cache", iterations, ref, ref_size, NULL, NULL);
+
+	if (acquired)
+		hsaKmtReleaseSystemProperties();
+	hsaKmtCloseKFD();
+	free(ref);
+	remove_tree();
+
+	printf("%d errors\n", errors);
+	return !!errors;
+}
@@ -0,0 +1,386 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Drives the reserved aperture VA allocator without a KFD. It is timed
+ * against the linear list walk it replaced with the same sequence of mixed
+ * size, mixed alignment reservations and releases. Every reservation is
+ * checked for alignment, fixed address reservations must match the list
+ * walk exactly and a nearly full aperture must only fail reservations
+ * that do not fit any hole.
+ *
+ * Usage: vm_area_bench [live areas] [operations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "libhsakmt.h"
+#include "vm_area.h"
+
+#define BENCH_PAGE_SIZE		4096ULL
+#define BENCH_HUGE_PAGE_SIZE	(2ULL << 20)
+#define BENCH_BASE		((void *)(1ULL << 32))
+#define BENCH_LIMIT		((void *)((1ULL << 47) - 1))
+
+/* Reference implementation: the original list walk */
+struct ref_area {
+	void *start;
+	void *end;
+	struct ref_area *next;
+	struct ref_area *prev;
+};
+
+static struct ref_area *ref_head;
+
+static void *ref_reserve(void *base, void *limit, void *address,
+			 uint64_t size, uint64_t align, uint64_t offset)
+{
+	struct ref_area *cur = NULL, *next = ref_head, *area;
+	void *start = address ? address :
+		(void *)(ALIGN_UP((uint64_t)base, align) + offset);
+
+	while (next) {
+		if (next->start > start &&
+		    VOID_PTRS_SUB(next->start, start) >= size)
+			break;
+
+		cur = next;
+		next = next->next;
+		if (!address)
+			start = (void *)(ALIGN_UP((uint64_t)cur->end + 1, align) + offset);
+	}
+	if (!next && VOID_PTRS_SUB(limit, start) + 1 < size)
+		return NULL;
+
+	if (cur && address && address < (void *)ALIGN_UP((uint64_t)cur->end + 1, align))
+		return NULL;
+
+	if (cur && VOID_PTR_ADD(cur->end, 1) == start) {
+		cur->end = VOID_PTR_ADD(start, size - 1);
+		return start;
+	}
+
+	area = malloc(sizeof(*area));
+	if (!area)
+		return NULL;
+	area->start = start;
+	area->end = VOID_PTR_ADD(start, size - 1);
+	area->next = next;
+	area->prev = cur;
+	if (cur)
+		cur->next = area;
+	else
+		ref_head = area;
+	if (next)
+		next->prev = area;
+
+	return start;
+}
+
+static void ref_release(void *address, uint64_t size)
+{
+	struct ref_area *area = ref_head;
+	uint64_t region;
+
+	while (area && !(address >= area->start && address <= area->end))
+		area = area->next;
+	if (!area)
+		return;
+
+	region = VOID_PTRS_SUB(area->end, area->start) + 1;
+	if (region == size) {
+		if (area->prev)
+			area->prev->next = area->next;
+		else
+			ref_head = area->next;
+		if (area->next)
+			area->next->prev = area->prev;
+		free(area);
+	} else if (area->start == address) {
+		area->start = VOID_PTR_ADD(area->start, size);
+	} else if (VOID_PTRS_SUB(area->end, address) + 1 == size) {
+		area->end = VOID_PTR_SUB(area->end, size);
+	} else {
+		struct ref_area *split = malloc(sizeof(*split));
+
+		if (!split)
+			return;
+		split->start = VOID_PTR_ADD(address, size);
+		split->end = area->end;
+		split->prev = area;
+		split->next = area->next;
+		if (area->next)
+			area->next->prev = split;
+		area->next = split;
+		area->end = VOID_PTR_SUB(address, 1);
+	}
+}
+
+static void ref_clear(void)
+{
+	while (ref_head) {
+		struct ref_area *next = ref_head->next;
+
+		free(ref_head);
+		ref_head = next;
+	}
+}
+
+/* A recorded reservation request, replayed against both allocators */
+struct op {
+	uint64_t size;
+	uint64_t align;
+	uint64_t offset;
+	uint32_t release;	/* index into the live set to release first */
+};
+
+/* Same size and alignment policy as reserved_aperture_allocate_aligned */
+static void make_op(struct op *op, unsigned int *seed)
+{
+	uint64_t size, align = BENCH_PAGE_SIZE, orig_align;
+	unsigned int r = rand_r(seed);
+
+	switch (r % 8) {
+	case 0:
+		size = (1 + rand_r(seed) % 512) * BENCH_HUGE_PAGE_SIZE / 8;
+		break;
+	case 1:
+	case 2:
+		size = (1 + rand_r(seed) % 64) * 64 * 1024;
+		break;
+	default:
+		size = (1 + rand_r(seed) % 16) * BENCH_PAGE_SIZE;
+		break;
+	}
+	orig_align = (r & 0x100) ? BENCH_HUGE_PAGE_SIZE : 0;
+	if (orig_align > align)
+		align = orig_align;
+	while (align < BENCH_HUGE_PAGE_SIZE && size >= (align << 1))
+		align <<= 1;
+
+	op->offset = orig_align <= BENCH_PAGE_SIZE ?
+		align - (size & (align - 1)) : 0;
+	op->size = size;
+	op->align = align;
+	op->release = rand_r(seed);
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+struct live {
+	void *addr;
+	uint64_t size;
+};
+
+/* Returns the number of holes of list in [base, limit] the reservation
+ * fits in once aligned.
+ */
+static int count_holes(vm_area_list_t *list, void *base, void *limit,
+		       const struct op *op)
+{
+	void *start = (void *)(ALIGN_UP((uint64_t)base, op->align) + op->offset);
+	vm_area_t *area;
+	int holes = 0;
+
+	for (area = list->head; area; area = area->next) {
+		if (area->start > start &&
+		    VOID_PTRS_SUB(area->start, start) >= op->size)
+			holes++;
+		start = (void *)(ALIGN_UP((uint64_t)area->end + 1, op->align) +
+				 op->offset);
+	}
+	if (start <= limit && VOID_PTRS_SUB(limit, start) + 1 >= op->size)
+		holes++;
+
+	return holes;
+}
+
+/* Returns the number of areas out of order or overlapping */
+static int check_list(vm_area_list_t *list, void *base, void *limit)
+{
+	vm_area_t *area;
+	int errors = 0;
+
+	for (area = list->head; area; area = area->next)
+		if (area->start < base || area->end > limit ||
+		    area->end < area->start ||
+		    (area->next && area->next->start <= area->end) ||
+		    hsakmt_vm_area_find(list, area->end) != area)
+			errors++;
+
+	return errors;
+}
+
+/* Fills the allocator with nr_live areas, then replays ops, each
+ * releasing a random live area and reserving a new one. Returns the
+ * average time per reservation in microseconds and adds the number of
+ * misplaced or needlessly failed reservations to errors.
+ */
+static double run(bool reference, const struct op *ops, uint32_t nr_live,
+		  uint32_t nr_ops, void *limit, uint32_t *errors)
+{
+	vm_area_list_t list;
+	struct live *live = calloc(nr_live, sizeof(*live));
+	double t, total = 0;
+	uint32_t i;
+
+	if (!live)
+		return -1;
+
+	hsakmt_vm_area_list_init(&list);
+
+	for (i = 0; i < nr_live + nr_ops; i++) {
+		const struct op *op = &ops[i];
+		uint32_t slot = i;
+		void *addr;
+
+		if (i >= nr_live) {
+			slot = op->release % nr_live;
+			if (live[slot].addr && reference)
+				ref_release(live[slot].addr, live[slot].size);
+			else if (live[slot].addr)
+				hsakmt_vm_area_release(&list, live[slot].addr,
+						       live[slot].size);
+		}
+
+		t = now_us();
+		if (reference)
+			addr = ref_reserve(BENCH_BASE, limit, NULL,
+					   op->size, op->align, op->offset);
+		else
+			addr = hsakmt_vm_area_reserve(&list, BENCH_BASE,
+						      limit, NULL,
+						      op->size, op->align,
+						      op->offset);
+		if (i >= nr_live)
+			total += now_us() - t;
+
+		if (!reference && addr &&
+		    (((uint64_t)addr - op->offset) & (op->align - 1)))
+			(*errors)++;
+		else if (!reference && !addr &&
+			 count_holes(&list, BENCH_BASE, limit, op))
+			(*errors)++;
+
+		live[slot].addr = addr;
+		live[slot].size = op->size;
+	}
+
+	if (reference) {
+		ref_clear();
+	} else {
+		*errors += check_list(&list, BENCH_BASE, limit);
+		hsakmt_vm_area_list_clear(&list);
+	}
+	free(live);
+
+	return nr_ops ? total / nr_ops : 0;
+}
+
+/* Fixed address reservations must succeed and fail exactly as before */
+static int check_fixed(unsigned int seed)
+{
+	vm_area_list_t list;
+	struct live live[256] = { { NULL, 0 } };
+	int i, mismatches = 0;
+
+	hsakmt_vm_area_list_init(&list);
+	for (i = 0; i < 20000; i++) {
+		struct live *slot = &live[rand_r(&seed) % 256];
+		uint64_t size = (1 + rand_r(&seed) % 8) * BENCH_PAGE_SIZE;
+		void *address = VOID_PTR_ADD(BENCH_BASE,
+			(rand_r(&seed) % 4096) * BENCH_PAGE_SIZE);
+		void *a, *b;
+
+		if (slot->addr) {
+			ref_release(slot->addr, slot->size);
+			hsakmt_vm_area_release(&list, slot->addr, slot->size);
+			slot->addr = NULL;
+		}
+
+		a = ref_reserve(BENCH_BASE, BENCH_LIMIT, address, size,
+				BENCH_PAGE_SIZE, 0);
+		b = hsakmt_vm_area_reserve(&list, BENCH_BASE, BENCH_LIMIT,
+					   address, size, BENCH_PAGE_SIZE, 0);
+		if (a != b)
+			mismatches++;
+		slot->addr = a;
+		slot->size = size;
+	}
+	ref_clear();
+	hsakmt_vm_area_list_clear(&list);
+
+	return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t nr_live = argc > 1 ? strtoul(argv[1], NULL, 0) : 100000;
+	uint32_t nr_ops = argc > 2 ? strtoul(argv[2], NULL, 0) : 2000;
+	unsigned int seed = 1;
+	struct op *ops;
+	double ref_us, tree_us;
+	uint32_t i, errors = 0, fixed_errors;
+
+	if (!nr_live) {
+		fprintf(stderr, "Number of live areas must not be 0\n");
+		return 1;
+	}
+
+	ops = calloc(nr_live + nr_ops, sizeof(*ops));
+	if (!ops) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	for (i = 0; i < nr_live + nr_ops; i++)
+		make_op(&ops[i], &seed);
+
+	ref_us = run(true, ops, nr_live, nr_ops, BENCH_LIMIT, &errors);
+	tree_us = run(false, ops, nr_live, nr_ops, BENCH_LIMIT, &errors);
+
+	/* Small aperture, most reservations fall back to the exact search */
+	run(false, ops, 2048, nr_ops,
+	    VOID_PTR_ADD(BENCH_BASE, (4ULL << 30)), &errors);
+
+	fixed_errors = check_fixed(seed);
+
+	printf("live areas %u, reservations %u\n", nr_live, nr_ops);
+	printf("  list walk: %10.3f us/reservation\n", ref_us);
+	printf("  gap tree:  %10.3f us/reservation\n", tree_us);
+	printf("  errors: %u, fixed address mismatches: %u\n", errors,
+	       fixed_errors);
+
+	free(ops);
+
+	return errors || fixed_errors ? 1 : 0;
+}
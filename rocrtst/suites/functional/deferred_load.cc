@@ -0,0 +1,260 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+/* Test Name: deferred_load
+ *
+ * Purpose: Verifies that the "-lazy-load" loader option defers loading agent
+ * code objects until they are needed.
+ *
+ * Test Description:
+ * The same code object is loaded lazily for every GPU agent into one
+ * executable.  Loaded segments are counted with
+ * hsa_ven_amd_loader_query_segment_descriptors after load, freeze, a kernel
+ * object query for the first agent and
+ * hsa_ven_amd_loader_executable_load_deferred_code_objects.  A second
+ * executable checks that querying the load size of a deferred loaded code
+ * object loads it.
+ *
+ * Expected Results: Every load returns a valid loaded code object handle.
+ * No segment exists until a symbol address is queried, and only the queried
+ * agent's code object is loaded.  The explicit load call loads the remaining
+ * agents.
+ *
+ */
+
+#include "suites/functional/deferred_load.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+static const char kLazyLoad[] = "-lazy-load";
+static const char kKernelName[] = "empty_kernel.kd";
+
+DeferredLoadTest::DeferredLoadTest() : TestBase() {
+  set_num_iteration(1);
+  set_title("RocR Deferred Code Object Load Test");
+  set_description("Checks that lazily loaded code objects get segments only when needed");
+  set_kernel_file_name("dispatch_time_kernels.hsaco");
+}
+
+DeferredLoadTest::~DeferredLoadTest(void) {}
+
+void DeferredLoadTest::SetUp(void) {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = hsa_system_get_major_extension_table(HSA_EXTENSION_AMD_LOADER, 1, sizeof(loader_),
+                                             &loader_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_iterate_agents(rocrtst::IterateGPUAgents, &gpus_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_FALSE(gpus_.empty());
+}
+
+void DeferredLoadTest::Run(void) {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+  TestSymbolAndPrefetch();
+  TestLoadedCodeObjectQuery();
+}
+
+void DeferredLoadTest::DisplayTestInfo(void) { TestBase::DisplayTestInfo(); }
+
+void DeferredLoadTest::DisplayResults(void) const {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  return;
+}
+
+void DeferredLoadTest::Close() {
+  for (hsa_code_object_reader_t reader : readers_) {
+    hsa_code_object_reader_destroy(reader);
+  }
+  readers_.clear();
+  for (int file : files_) {
+    close(file);
+  }
+  files_.clear();
+
+  // This will close handles opened within rocrtst utility calls and call
+  // hsa_shut_down(), so it should be done after other hsa cleanup
+  TestBase::Close();
+}
+
+size_t DeferredLoadTest::CountSegments(hsa_executable_t executable, hsa_agent_t agent) {
+  size_t num = 0;
+  hsa_status_t err = loader_.hsa_ven_amd_loader_query_segment_descriptors(nullptr, &num);
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+  if (num == 0) return 0;
+
+  std::vector<hsa_ven_amd_loader_segment_descriptor_t> segments(num);
+  err = loader_.hsa_ven_amd_loader_query_segment_descriptors(&segments[0], &num);
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+
+  size_t count = 0;
+  for (size_t i = 0; i < num; i++) {
+    if (segments[i].executable.handle == executable.handle &&
+        segments[i].agent.handle == agent.handle) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void DeferredLoadTest::LoadLazily(hsa_executable_t executable, hsa_agent_t agent,
+                                  hsa_loaded_code_object_t* loaded_code_object) {
+  std::string file_name = rocrtst::LocateKernelFile(kernel_file_name(), agent);
+  int file = open(file_name.c_str(), O_RDONLY);
+  ASSERT_NE(-1, file) << "Could not open " << file_name;
+  files_.push_back(file);
+
+  hsa_code_object_reader_t reader;
+  hsa_status_t err = hsa_code_object_reader_create_from_file(file, &reader);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  readers_.push_back(reader);
+
+  loaded_code_object->handle = 0;
+  err = hsa_executable_load_agent_code_object(executable, agent, reader, kLazyLoad,
+                                              loaded_code_object);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_NE(0u, loaded_code_object->handle) << "Deferred load returned a null handle.";
+}
+
+void DeferredLoadTest::TestSymbolAndPrefetch(void) {
+  hsa_status_t err;
+
+  hsa_executable_t executable;
+  err = hsa_executable_create_alt(HSA_PROFILE_FULL, HSA_DEFAULT_FLOAT_ROUNDING_MODE_DEFAULT,
+                                  nullptr, &executable);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  std::vector<hsa_loaded_code_object_t> loaded(gpus_.size());
+  for (size_t i = 0; i < gpus_.size(); i++) {
+    LoadLazily(executable, gpus_[i], &loaded[i]);
+
+    // The handle can be queried before the code object is loaded.
+    hsa_agent_t agent;
+    err = loader_.hsa_ven_amd_loader_loaded_code_object_get_info(
+        loaded[i], HSA_VEN_AMD_LOADER_LOADED_CODE_OBJECT_INFO_AGENT, &agent);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    ASSERT_EQ(gpus_[i].handle, agent.handle);
+    ASSERT_EQ(0u, CountSegments(executable, gpus_[i])) << "Segments loaded eagerly.";
+  }
+
+  err = hsa_executable_freeze(executable, nullptr);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_executable_symbol_t symbol;
+  err = hsa_executable_get_symbol_by_name(executable, kKernelName, &gpus_[0], &symbol);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  for (size_t i = 0; i < gpus_.size(); i++) {
+    ASSERT_EQ(0u, CountSegments(executable, gpus_[i])) << "Symbol lookup loaded segments.";
+  }
+
+  // The first address query loads the code object of that agent only.
+  uint64_t kernel_object = 0;
+  err = hsa_executable_symbol_get_info(symbol, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT,
+                                       &kernel_object);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_NE(0u, kernel_object);
+  ASSERT_EQ(1u, CountSegments(executable, gpus_[0]));
+  for (size_t i = 1; i < gpus_.size(); i++) {
+    ASSERT_EQ(0u, CountSegments(executable, gpus_[i])) << "Other agents loaded.";
+  }
+
+  err = loader_.hsa_ven_amd_loader_executable_load_deferred_code_objects(executable, nullptr);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  for (size_t i = 0; i < gpus_.size(); i++) {
+    ASSERT_EQ(1u, CountSegments(executable, gpus_[i])) << "Agent " << i << " not loaded.";
+  }
+
+  err = hsa_executable_destroy(executable);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void DeferredLoadTest::TestLoadedCodeObjectQuery(void) {
+  hsa_status_t err;
+
+  hsa_executable_t executable;
+  err = hsa_executable_create_alt(HSA_PROFILE_FULL, HSA_DEFAULT_FLOAT_ROUNDING_MODE_DEFAULT,
+                                  nullptr, &executable);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_loaded_code_object_t loaded;
+  LoadLazily(executable, gpus_[0], &loaded);
+  err = hsa_executable_freeze(executable, nullptr);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_EQ(0u, CountSegments(executable, gpus_[0]));
+
+  uint64_t load_size = 0;
+  err = loader_.hsa_ven_amd_loader_loaded_code_object_get_info(
+      loaded, HSA_VEN_AMD_LOADER_LOADED_CODE_OBJECT_INFO_LOAD_SIZE, &load_size);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_NE(0u, load_size);
+  ASSERT_EQ(1u, CountSegments(executable, gpus_[0])) << "Placement query did not load.";
+
+  err = hsa_executable_destroy(executable);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
@@ -0,0 +1,99 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_FUNCTIONAL_DEFERRED_LOAD_H_
+#define ROCRTST_SUITES_FUNCTIONAL_DEFERRED_LOAD_H_
+
+#include <vector>
+
+#include "common/base_rocr.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ven_amd_loader.h"
+#include "suites/test_common/test_base.h"
+
+class DeferredLoadTest : public TestBase {
+ public:
+  DeferredLoadTest();
+
+  // @Brief: Destructor for the DeferredLoadTest class
+  virtual ~DeferredLoadTest();
+
+  // @Brief: Setup the environment for measurement
+  virtual void SetUp();
+
+  // @Brief: Core measurement execution
+  virtual void Run();
+
+  // @Brief: Clean up and retrive the resource
+  virtual void Close();
+
+  // @Brief: Display  results
+  virtual void DisplayResults() const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Loads one code object per GPU lazily and checks that segments
+  // appear on symbol queries and on the explicit load call.
+  void TestSymbolAndPrefetch(void);
+
+  // @Brief: Checks that querying the loaded code object placement loads it.
+  void TestLoadedCodeObjectQuery(void);
+
+ private:
+  // Number of loaded segments of @p executable for @p agent.
+  size_t CountSegments(hsa_executable_t executable, hsa_agent_t agent);
+
+  // Lazily loads the test code object of @p agent into @p executable.
+  void LoadLazily(hsa_executable_t executable, hsa_agent_t agent,
+                  hsa_loaded_code_object_t* loaded_code_object);
+
+  hsa_ven_amd_loader_1_04_pfn_t loader_;
+  std::vector<hsa_agent_t> gpus_;
+  std::vector<hsa_code_object_reader_t> readers_;
+  std::vector<int> files_;
+};
+
+#endif  // ROCRTST_SUITES_FUNCTIONAL_DEFERRED_LOAD_H_
@@ -0,0 +1,259 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+/* Test Name: dispatch_time_slots
+ *
+ * Purpose: Verifies dispatch time profiling through the dispatch time slots
+ * of a queue.
+ *
+ * Test Description:
+ * A batch of empty kernel dispatches is submitted with the slots of their
+ * packet IDs as completion signals, followed by a barrier packet with an
+ * ordinary signal.  Once the barrier completes, the time stamps of the whole
+ * batch are read with one call to hsa_amd_profiling_get_dispatch_times.
+ *
+ * Expected Results: Every dispatch of the batch reports ordered time stamps,
+ * and reading the batch again reports no completed packets.
+ *
+ */
+
+#include "suites/functional/dispatch_time_slots.h"
+
+#include <vector>
+
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+static const uint32_t kQueueSize = 1024;
+static const uint32_t kDispatches = 256;
+
+DispatchTimeSlotsTest::DispatchTimeSlotsTest() : TestBase() {
+  set_num_iteration(1);
+  set_title("RocR Dispatch Time Slots Test");
+  set_description("Profiles dispatches through per-queue time stamp slots instead of signals");
+
+  memset(&aql(), 0, sizeof(hsa_kernel_dispatch_packet_t));
+  set_kernel_file_name("dispatch_time_kernels.hsaco");
+  set_kernel_name("empty_kernel");
+}
+
+DispatchTimeSlotsTest::~DispatchTimeSlotsTest(void) {}
+
+void DispatchTimeSlotsTest::SetUp(void) {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::LoadKernelFromObjFile(this, gpu_device1());
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  // Fill up the kernel packet except header
+  err = rocrtst::InitializeAQLPacket(this, &aql());
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void DispatchTimeSlotsTest::Run(void) {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+  TestInvalidArgs();
+  TestDispatchTimes();
+}
+
+void DispatchTimeSlotsTest::DisplayTestInfo(void) { TestBase::DisplayTestInfo(); }
+
+void DispatchTimeSlotsTest::DisplayResults(void) const {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  return;
+}
+
+void DispatchTimeSlotsTest::Close() {
+  // This will close handles opened within rocrtst utility calls and call
+  // hsa_shut_down(), so it should be done after other hsa cleanup
+  TestBase::Close();
+}
+
+void DispatchTimeSlotsTest::TestInvalidArgs(void) {
+  hsa_status_t err;
+  hsa_signal_t slot_base;
+  hsa_amd_profiling_dispatch_time_t time;
+
+  err = hsa_amd_profiling_dispatch_slots_enable(NULL, &slot_base);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ARGUMENT, err) << "NULL queue accepted.";
+
+  hsa_queue_t* queue;
+  err = hsa_queue_create(*gpu_device1(), 64, HSA_QUEUE_TYPE_SINGLE, NULL, NULL, UINT32_MAX,
+                         UINT32_MAX, &queue);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_amd_profiling_dispatch_slots_enable(queue, NULL);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ARGUMENT, err) << "NULL slot base accepted.";
+
+  err = hsa_amd_profiling_get_dispatch_times(queue, 0, 1, &time, NULL);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_QUEUE, err) << "Read from a queue without slots.";
+
+  err = hsa_amd_profiling_dispatch_slots_enable(queue, &slot_base);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_amd_profiling_get_dispatch_times(queue, 0, 1, NULL, NULL);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ARGUMENT, err) << "NULL times accepted.";
+
+  std::vector<hsa_amd_profiling_dispatch_time_t> times(queue->size + 1);
+  err = hsa_amd_profiling_get_dispatch_times(queue, 0, queue->size + 1, &times[0], NULL);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ARGUMENT, err) << "Read larger than the queue accepted.";
+
+  uint32_t completed = 1;
+  err = hsa_amd_profiling_get_dispatch_times(queue, 0, 0, NULL, &completed);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_EQ(0u, completed);
+
+  err = hsa_queue_destroy(queue);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void DispatchTimeSlotsTest::TestDispatchTimes(void) {
+  hsa_status_t err;
+
+  hsa_queue_t* queue;
+  err = hsa_queue_create(*gpu_device1(), kQueueSize, HSA_QUEUE_TYPE_SINGLE, NULL, NULL,
+                         UINT32_MAX, UINT32_MAX, &queue);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_GT(queue->size, kDispatches);
+
+  hsa_signal_t slot_base;
+  err = hsa_amd_profiling_dispatch_slots_enable(queue, &slot_base);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_NE(0u, slot_base.handle);
+
+  // Enabling again keeps the same slots.
+  hsa_signal_t again;
+  err = hsa_amd_profiling_dispatch_slots_enable(queue, &again);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_EQ(slot_base.handle, again.handle);
+
+  const uint32_t queue_mask = queue->size - 1;
+  hsa_kernel_dispatch_packet_t* q_base =
+      reinterpret_cast<hsa_kernel_dispatch_packet_t*>(queue->base_address);
+  uint16_t header = (HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_ACQUIRE_FENCE_SCOPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_RELEASE_FENCE_SCOPE);
+
+  // Profile the whole batch with no signal other than the barrier's.
+  const uint64_t first = hsa_queue_add_write_index_relaxed(queue, kDispatches + 1);
+  for (uint32_t i = 0; i < kDispatches; i++) {
+    const uint64_t index = first + i;
+    hsa_kernel_dispatch_packet_t packet = aql();
+    packet.completion_signal.handle =
+        slot_base.handle + (index & queue_mask) * HSA_AMD_PROFILING_DISPATCH_SLOT_SIZE;
+    rocrtst::WriteAQLToQueueLoc(queue, index, &packet);
+    rocrtst::AtomicSetPacketHeader(header, packet.setup, &q_base[index & queue_mask]);
+  }
+
+  const uint64_t barrier_index = first + kDispatches;
+  hsa_barrier_and_packet_t* barrier =
+      reinterpret_cast<hsa_barrier_and_packet_t*>(&q_base[barrier_index & queue_mask]);
+  memset(reinterpret_cast<uint8_t*>(barrier) + 4, 0, sizeof(*barrier) - 4);
+  barrier->completion_signal = aql().completion_signal;
+  uint16_t barrier_header = (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
+      (1 << HSA_PACKET_HEADER_BARRIER) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+  __atomic_store_n(&barrier->header, barrier_header, __ATOMIC_RELEASE);
+
+  hsa_signal_store_screlease(queue->doorbell_signal, barrier_index);
+  hsa_signal_wait_scacquire(aql().completion_signal, HSA_SIGNAL_CONDITION_LT, 1, UINT64_MAX,
+                            HSA_WAIT_STATE_BLOCKED);
+
+  std::vector<hsa_amd_profiling_dispatch_time_t> times(kDispatches);
+  uint32_t completed = 0;
+  err = hsa_amd_profiling_get_dispatch_times(queue, first, kDispatches, &times[0], &completed);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_EQ(kDispatches, completed) << "Not every dispatch reported its time stamps.";
+
+  for (uint32_t i = 0; i < kDispatches; i++) {
+    ASSERT_NE(0u, times[i].start);
+    ASSERT_LE(times[i].start, times[i].end) << "Dispatch " << i << " ends before it starts.";
+    // The packet processor starts packets in order.
+    if (i != 0) {
+      ASSERT_LE(times[i - 1].start, times[i].start);
+    }
+  }
+
+  if (verbosity() >= VERBOSE_STANDARD) {
+    fprintf(stdout, "%u dispatches profiled over %lu ticks\n", completed,
+            times[kDispatches - 1].end - times[0].start);
+  }
+
+  // Slots are cleared once read.
+  err = hsa_amd_profiling_get_dispatch_times(queue, first, kDispatches, &times[0], &completed);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_EQ(0u, completed);
+  for (uint32_t i = 0; i < kDispatches; i++) {
+    ASSERT_EQ(0u, times[i].start);
+    ASSERT_EQ(0u, times[i].end);
+  }
+
+  err = hsa_queue_destroy(queue);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
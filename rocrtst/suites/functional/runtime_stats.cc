@@ -0,0 +1,282 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+/* Test Name: runtime_stats
+ *
+ * Purpose: Verifies the counters reported by hsa_amd_runtime_stats_get.
+ *
+ * Test Description:
+ * Host to device copies are submitted and the blit engine and agent counters
+ * are compared before and after.  A barrier packet is then submitted to a new
+ * queue and the queue counters are checked, before and after destroying the
+ * queue.
+ *
+ * Expected Results: Blit engines account for the copied bytes, the agent
+ * totals match the sum of its blit engines, the queue reports one packet and
+ * one doorbell, and the agent keeps the counters of destroyed queues.
+ *
+ */
+
+#include "suites/functional/runtime_stats.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+static const size_t kCopySize = 1024 * 1024;
+static const int kCopies = 8;
+
+static hsa_status_t CollectEntry(const hsa_amd_runtime_stats_entry_t* entry, void* data) {
+  reinterpret_cast<std::vector<hsa_amd_runtime_stats_entry_t>*>(data)->push_back(*entry);
+  return HSA_STATUS_SUCCESS;
+}
+
+static hsa_status_t StopAtFirst(const hsa_amd_runtime_stats_entry_t* entry, void* data) {
+  (*reinterpret_cast<int*>(data))++;
+  return HSA_STATUS_INFO_BREAK;
+}
+
+static std::vector<hsa_amd_runtime_stats_entry_t> GetStats(hsa_agent_t agent) {
+  std::vector<hsa_amd_runtime_stats_entry_t> entries;
+  hsa_status_t err = hsa_amd_runtime_stats_get(agent, CollectEntry, &entries);
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+  return entries;
+}
+
+RuntimeStatsTest::RuntimeStatsTest() : TestBase() {
+  set_num_iteration(1);
+  set_title("RocR Runtime Stats Test");
+  set_description("Checks agent, queue and blit engine submission counters");
+}
+
+RuntimeStatsTest::~RuntimeStatsTest(void) {}
+
+void RuntimeStatsTest::SetUp(void) {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void RuntimeStatsTest::Run(void) {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+  TestBlitCounters();
+  TestQueueCounters();
+}
+
+void RuntimeStatsTest::DisplayTestInfo(void) { TestBase::DisplayTestInfo(); }
+
+void RuntimeStatsTest::DisplayResults(void) const {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  return;
+}
+
+void RuntimeStatsTest::Close() {
+  // This will close handles opened within rocrtst utility calls and call
+  // hsa_shut_down(), so it should be done after other hsa cleanup
+  TestBase::Close();
+}
+
+void RuntimeStatsTest::TestBlitCounters(void) {
+  hsa_status_t err;
+
+  err = hsa_amd_runtime_stats_get(*gpu_device1(), nullptr, nullptr);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ARGUMENT, err) << "NULL callback accepted.";
+  std::vector<hsa_amd_runtime_stats_entry_t> entries;
+  err = hsa_amd_runtime_stats_get(*cpu_device(), CollectEntry, &entries);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_AGENT, err) << "CPU agent accepted.";
+
+  void* src;
+  void* dst;
+  err = hsa_amd_memory_pool_allocate(cpu_pool(), kCopySize, 0, &src);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_amd_memory_pool_allocate(device_pool(), kCopySize, 0, &dst);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  hsa_agent_t agents[2] = {*gpu_device1(), *cpu_device()};
+  err = hsa_amd_agents_allow_access(2, agents, NULL, src);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  memset(src, 0x5a, kCopySize);
+
+  hsa_signal_t signal;
+  err = hsa_signal_create(1, 0, NULL, &signal);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  std::vector<hsa_amd_runtime_stats_entry_t> before = GetStats(*gpu_device1());
+  ASSERT_FALSE(before.empty());
+  ASSERT_EQ(HSA_AMD_RUNTIME_STATS_SOURCE_AGENT, before[0].source) << "Agent totals not first.";
+  ASSERT_EQ(gpu_device1()->handle, before[0].agent.handle);
+
+  for (int i = 0; i < kCopies; i++) {
+    hsa_signal_store_relaxed(signal, 1);
+    err = hsa_amd_memory_async_copy(dst, *gpu_device1(), src, *cpu_device(), kCopySize, 0, NULL,
+                                    signal);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, 1, UINT64_MAX,
+                              HSA_WAIT_STATE_BLOCKED);
+  }
+
+  std::vector<hsa_amd_runtime_stats_entry_t> after = GetStats(*gpu_device1());
+  ASSERT_FALSE(after.empty());
+  const hsa_amd_runtime_stats_entry_t& agent = after[0];
+  ASSERT_GE(agent.bytes - before[0].bytes, kCopies * kCopySize) << "Copied bytes not counted.";
+  ASSERT_GE(agent.submissions - before[0].submissions, uint64_t(kCopies));
+  ASSERT_GE(agent.doorbells - before[0].doorbells, uint64_t(kCopies));
+  ASSERT_NE(0u, agent.average_submit_latency_ns);
+
+  // Agent bytes are the sum of its blit engines.
+  uint64_t blit_bytes = 0;
+  uint64_t blit_submissions = 0;
+  for (const auto& entry : after) {
+    ASSERT_EQ(gpu_device1()->handle, entry.agent.handle);
+    if (entry.source == HSA_AMD_RUNTIME_STATS_SOURCE_BLIT_KERNEL ||
+        entry.source == HSA_AMD_RUNTIME_STATS_SOURCE_BLIT_SDMA) {
+      blit_bytes += entry.bytes;
+      blit_submissions += entry.submissions;
+    } else if (entry.source == HSA_AMD_RUNTIME_STATS_SOURCE_QUEUE) {
+      ASSERT_EQ(0u, entry.bytes) << "Queue reports blit bytes.";
+    }
+  }
+  ASSERT_EQ(agent.bytes, blit_bytes);
+  ASSERT_GE(blit_submissions, uint64_t(kCopies));
+
+  if (verbosity() >= VERBOSE_STANDARD) {
+    for (const auto& entry : after) {
+      fprintf(stdout, "source %d id %lu: %lu submissions, %lu bytes, %lu doorbells, %lu ring full"
+              " waits, %lu barriers, %lu ns average submit\n", entry.source, entry.id,
+              entry.submissions, entry.bytes, entry.doorbells, entry.ring_full_waits,
+              entry.dependency_barriers, entry.average_submit_latency_ns);
+    }
+  }
+
+  // Iteration stops at the first status other than success.
+  int calls = 0;
+  err = hsa_amd_runtime_stats_get(*gpu_device1(), StopAtFirst, &calls);
+  ASSERT_EQ(HSA_STATUS_INFO_BREAK, err);
+  ASSERT_EQ(1, calls);
+
+  hsa_signal_destroy(signal);
+  hsa_amd_memory_pool_free(src);
+  hsa_amd_memory_pool_free(dst);
+}
+
+void RuntimeStatsTest::TestQueueCounters(void) {
+  hsa_status_t err;
+
+  hsa_queue_t* queue;
+  err = hsa_queue_create(*gpu_device1(), 64, HSA_QUEUE_TYPE_SINGLE, NULL, NULL, UINT32_MAX,
+                         UINT32_MAX, &queue);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_signal_t signal;
+  err = hsa_signal_create(1, 0, NULL, &signal);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  uint64_t index = hsa_queue_add_write_index_relaxed(queue, 1);
+  hsa_barrier_and_packet_t* packet = reinterpret_cast<hsa_barrier_and_packet_t*>(
+      queue->base_address) + (index & (queue->size - 1));
+  memset(reinterpret_cast<uint8_t*>(packet) + 4, 0, sizeof(*packet) - 4);
+  packet->completion_signal = signal;
+  uint16_t header = (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+  __atomic_store_n(&packet->header, header, __ATOMIC_RELEASE);
+  hsa_signal_store_screlease(queue->doorbell_signal, index);
+  hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, 1, UINT64_MAX,
+                            HSA_WAIT_STATE_BLOCKED);
+
+  std::vector<hsa_amd_runtime_stats_entry_t> entries = GetStats(*gpu_device1());
+  ASSERT_FALSE(entries.empty());
+  const hsa_amd_runtime_stats_entry_t* found = nullptr;
+  for (const auto& entry : entries) {
+    if (entry.source == HSA_AMD_RUNTIME_STATS_SOURCE_QUEUE && entry.id == queue->id) {
+      found = &entry;
+    }
+  }
+  ASSERT_NE(nullptr, found) << "Queue not reported.";
+  ASSERT_EQ(1u, found->submissions);
+  ASSERT_EQ(1u, found->doorbells);
+  uint64_t agent_submissions = entries[0].submissions;
+  uint64_t agent_doorbells = entries[0].doorbells;
+
+  uint64_t queue_id = queue->id;
+  err = hsa_queue_destroy(queue);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  // The destroyed queue is no longer reported but stays in the agent totals.
+  entries = GetStats(*gpu_device1());
+  ASSERT_FALSE(entries.empty());
+  for (const auto& entry : entries) {
+    if (entry.source == HSA_AMD_RUNTIME_STATS_SOURCE_QUEUE) {
+      ASSERT_NE(queue_id, entry.id) << "Destroyed queue reported.";
+    }
+  }
+  ASSERT_GE(entries[0].submissions, agent_submissions);
+  ASSERT_GE(entries[0].doorbells, agent_doorbells);
+
+  hsa_signal_destroy(signal);
+}
@@ -0,0 +1,204 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+/* Test Name: shared_code_segment
+ *
+ * Purpose: Verifies that identical code object loads share their code segment
+ * only when HSA_LOADER_SHARE_CODE_SEGMENTS enables it.
+ *
+ * Test Description:
+ * The runtime is initialized with HSA_LOADER_SHARE_CODE_SEGMENTS set to "1"
+ * or "0".  For every GPU agent the same code object is loaded into two
+ * executables, each frozen before the next load, and the kernel object
+ * addresses of the two executables are compared.  The first executable is
+ * then destroyed and the kernel object of the second queried again.
+ *
+ * Expected Results: With sharing on both executables return the same kernel
+ * object, which stays valid after the first executable is destroyed.  With
+ * sharing off the kernel objects differ.
+ *
+ */
+
+#include "suites/functional/shared_code_segment.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+static const char kKernelName[] = "empty_kernel.kd";
+
+SharedCodeSegmentTest::SharedCodeSegmentTest(bool share) : TestBase(), share_(share) {
+  set_num_iteration(1);
+  set_title(share ? "RocR Shared Code Segment Test" : "RocR Private Code Segment Test");
+  set_description("Loads one code object twice and checks whether the code segment is shared");
+  set_kernel_file_name("dispatch_time_kernels.hsaco");
+}
+
+SharedCodeSegmentTest::~SharedCodeSegmentTest(void) {}
+
+void SharedCodeSegmentTest::SetUp(void) {
+  hsa_status_t err;
+
+  // The setting is read by hsa_init.  Later tests must not see it.
+  setenv("HSA_LOADER_SHARE_CODE_SEGMENTS", share_ ? "1" : "0", 1);
+  TestBase::SetUp();
+  unsetenv("HSA_LOADER_SHARE_CODE_SEGMENTS");
+
+  err = hsa_iterate_agents(rocrtst::IterateGPUAgents, &gpus_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_FALSE(gpus_.empty());
+}
+
+void SharedCodeSegmentTest::Run(void) {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+  TestLoadTwice();
+}
+
+void SharedCodeSegmentTest::DisplayTestInfo(void) { TestBase::DisplayTestInfo(); }
+
+void SharedCodeSegmentTest::DisplayResults(void) const {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  return;
+}
+
+void SharedCodeSegmentTest::Close() {
+  for (hsa_code_object_reader_t reader : readers_) {
+    hsa_code_object_reader_destroy(reader);
+  }
+  readers_.clear();
+  for (int file : files_) {
+    close(file);
+  }
+  files_.clear();
+
+  // This will close handles opened within rocrtst utility calls and call
+  // hsa_shut_down(), so it should be done after other hsa cleanup
+  TestBase::Close();
+}
+
+void SharedCodeSegmentTest::LoadAndFreeze(hsa_agent_t agent, hsa_executable_t* executable,
+                                          uint64_t* kernel_object) {
+  hsa_status_t err;
+
+  std::string file_name = rocrtst::LocateKernelFile(kernel_file_name(), agent);
+  int file = open(file_name.c_str(), O_RDONLY);
+  ASSERT_NE(-1, file) << "Could not open " << file_name;
+  files_.push_back(file);
+
+  hsa_code_object_reader_t reader;
+  err = hsa_code_object_reader_create_from_file(file, &reader);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  readers_.push_back(reader);
+
+  err = hsa_executable_create_alt(HSA_PROFILE_FULL, HSA_DEFAULT_FLOAT_ROUNDING_MODE_DEFAULT,
+                                  nullptr, executable);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_executable_load_agent_code_object(*executable, agent, reader, nullptr, nullptr);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_executable_freeze(*executable, nullptr);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_executable_symbol_t symbol;
+  err = hsa_executable_get_symbol_by_name(*executable, kKernelName, &agent, &symbol);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  *kernel_object = 0;
+  err = hsa_executable_symbol_get_info(symbol, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT,
+                                       kernel_object);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_NE(0u, *kernel_object);
+}
+
+void SharedCodeSegmentTest::TestLoadTwice(void) {
+  hsa_status_t err;
+
+  for (hsa_agent_t gpu : gpus_) {
+    hsa_executable_t first, second;
+    uint64_t first_object, second_object;
+    ASSERT_NO_FATAL_FAILURE(LoadAndFreeze(gpu, &first, &first_object));
+    ASSERT_NO_FATAL_FAILURE(LoadAndFreeze(gpu, &second, &second_object));
+
+    if (share_) {
+      ASSERT_EQ(first_object, second_object) << "Identical loads did not share code.";
+    } else {
+      ASSERT_NE(first_object, second_object) << "Code shared with sharing disabled.";
+    }
+
+    // The shared segment outlives the executable that created it.
+    err = hsa_executable_destroy(first);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    hsa_executable_symbol_t symbol;
+    err = hsa_executable_get_symbol_by_name(second, kKernelName, &gpu, &symbol);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    uint64_t kernel_object = 0;
+    err = hsa_executable_symbol_get_info(symbol, HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT,
+                                         &kernel_object);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    ASSERT_EQ(second_object, kernel_object);
+
+    err = hsa_executable_destroy(second);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+}
@@ -0,0 +1,224 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+/* Test Name: svm_profile_replay
+ *
+ * Purpose: Verifies the SVM access profiler analysis by replaying a recorded
+ * SMI event log through HSA_SVM_PROFILE_REPLAY.
+ *
+ * Test Description:
+ * A log is written with a range faulted on by one GPU in three consecutive
+ * epochs, a range migrating back and forth between the CPU and that GPU, and
+ * a range faulted on once.  Raw KFD records, profiler log lines and
+ * unrelated lines are mixed.  The ranges are then read back with
+ * hsa_amd_svm_profile_iterate_ranges.
+ *
+ * Expected Results: The recurring faults suggest the faulting agent, the
+ * ping-pong suggests system memory and the single fault gives no hint.
+ * Replayed hints are never applied.
+ *
+ */
+
+#include "suites/functional/svm_profile_replay.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <map>
+
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// gpuid of no agent of this process.
+#define REPLAY_GPUID "dead"
+
+static const uint64_t kRecurringBase = 0x10000000;
+static const uint64_t kThrashBase = 0x20000000;
+static const uint64_t kSingleBase = 0x30000000;
+static const uint64_t kThrashSize = 16 * 4096;
+
+static const char* kReplayLog[] = {
+    // Two faults in epoch 0 then one in each of epochs 1 and 2.
+    "7 5 -1 @10000(" REPLAY_GPUID ") W",
+    "8 9 -1 @10000(" REPLAY_GPUID ") M",
+    "7 10 -1 @10000(" REPLAY_GPUID ") R",
+    "7 100000005 -1 @10000(" REPLAY_GPUID ") R",
+    "10 100000100 -1 " REPLAY_GPUID " 0",
+    "7 200000005 -1 @10000(" REPLAY_GPUID ") W",
+    // Five migrations of the same pages, each reversing the previous one.
+    "ROCr HMM event: 1000 MIGRATE_START PAGEFAULT_GPU CPU->GPU [..] | "
+    "5 1000 -1 @20000(10) 0->" REPLAY_GPUID " 0:0 1",
+    "5 1001 -1 @20000(10) " REPLAY_GPUID "->0 0:0 1",
+    "6 1001 -1 @20000(10) " REPLAY_GPUID "->0 1",
+    "5 1002 -1 @20000(10) 0->" REPLAY_GPUID " 0:0 1",
+    "5 1003 -1 @20000(10) " REPLAY_GPUID "->0 0:0 1",
+    "ROCr HMM event error: Read returned -1, Interrupted system call (4)",
+    "5 1004 -1 @20000(10) 0->" REPLAY_GPUID " 0:0 1",
+    "7 300 -1 @30000(" REPLAY_GPUID ") R",
+};
+
+static hsa_status_t CollectRange(const hsa_amd_svm_profile_range_t* range, void* data) {
+  auto* ranges = reinterpret_cast<std::map<uint64_t, hsa_amd_svm_profile_range_t>*>(data);
+  (*ranges)[reinterpret_cast<uint64_t>(range->base)] = *range;
+  return HSA_STATUS_SUCCESS;
+}
+
+static hsa_status_t StopAtFirst(const hsa_amd_svm_profile_range_t* range, void* data) {
+  (*reinterpret_cast<int*>(data))++;
+  return HSA_STATUS_INFO_BREAK;
+}
+
+SvmProfileReplayTest::SvmProfileReplayTest() : TestBase() {
+  set_num_iteration(1);
+  set_title("RocR SVM Profile Replay Test");
+  set_description("Replays an SMI event log through the SVM access profiler and checks its hints");
+}
+
+SvmProfileReplayTest::~SvmProfileReplayTest(void) {}
+
+void SvmProfileReplayTest::SetUp(void) {
+  hsa_status_t err;
+
+  char path[] = "/tmp/rocrtst_svm_profile_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(-1, fd) << "Failed to create the replay log.";
+  log_path_ = path;
+  FILE* log = fdopen(fd, "w");
+  ASSERT_NE(nullptr, log);
+  for (const char* line : kReplayLog) fprintf(log, "%s\n", line);
+  fclose(log);
+
+  // The log is replayed by hsa_init.  Later tests must not see it.
+  setenv("HSA_SVM_PROFILE_REPLAY", log_path_.c_str(), 1);
+  TestBase::SetUp();
+  unsetenv("HSA_SVM_PROFILE_REPLAY");
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void SvmProfileReplayTest::Run(void) {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+  TestReplayedRanges();
+}
+
+void SvmProfileReplayTest::DisplayTestInfo(void) { TestBase::DisplayTestInfo(); }
+
+void SvmProfileReplayTest::DisplayResults(void) const {
+  // Compare required profile for this test case with what we're actually
+  // running on
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  return;
+}
+
+void SvmProfileReplayTest::Close() {
+  if (!log_path_.empty()) unlink(log_path_.c_str());
+
+  // This will close handles opened within rocrtst utility calls and call
+  // hsa_shut_down(), so it should be done after other hsa cleanup
+  TestBase::Close();
+}
+
+void SvmProfileReplayTest::TestReplayedRanges(void) {
+  hsa_status_t status;
+
+  status = hsa_amd_svm_profile_iterate_ranges(nullptr, nullptr);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ARGUMENT, status) << "NULL callback accepted.";
+
+  // Ranges of a live run of this process may be reported too, use the replayed ones only.
+  std::map<uint64_t, hsa_amd_svm_profile_range_t> ranges;
+  status = hsa_amd_svm_profile_iterate_ranges(CollectRange, &ranges);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, status) << "Failed to iterate profiled ranges.";
+
+  ASSERT_EQ(1u, ranges.count(kRecurringBase)) << "Recurring fault range missing.";
+  const hsa_amd_svm_profile_range_t& recurring = ranges[kRecurringBase];
+  ASSERT_EQ(4096u, recurring.size);
+  ASSERT_EQ(4u, recurring.page_faults);
+  ASSERT_EQ(0u, recurring.migrations);
+  ASSERT_EQ(3u, recurring.fault_epochs);
+  ASSERT_EQ(HSA_AMD_SVM_PROFILE_HINT_PREFER_AGENT, recurring.hint);
+  ASSERT_EQ(0u, recurring.hint_agent.handle) << "Replayed gpuid resolved to an agent.";
+  ASSERT_FALSE(recurring.applied) << "Replayed hint applied.";
+
+  ASSERT_EQ(1u, ranges.count(kThrashBase)) << "Migrating range missing.";
+  const hsa_amd_svm_profile_range_t& thrash = ranges[kThrashBase];
+  ASSERT_EQ(kThrashSize, thrash.size);
+  ASSERT_EQ(0u, thrash.page_faults);
+  ASSERT_EQ(5u, thrash.migrations);
+  ASSERT_EQ(5 * kThrashSize, thrash.migrated_bytes);
+  ASSERT_EQ(4u, thrash.thrash_migrations);
+  ASSERT_EQ(HSA_AMD_SVM_PROFILE_HINT_PREFER_SYSTEM, thrash.hint);
+  ASSERT_NE(0u, thrash.hint_agent.handle) << "System memory hint without a CPU agent.";
+  hsa_device_type_t type;
+  status = hsa_agent_get_info(thrash.hint_agent, HSA_AGENT_INFO_DEVICE, &type);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, status);
+  ASSERT_EQ(HSA_DEVICE_TYPE_CPU, type) << "System memory hint is not a CPU agent.";
+  ASSERT_FALSE(thrash.applied) << "Replayed hint applied.";
+
+  ASSERT_EQ(1u, ranges.count(kSingleBase)) << "Single fault range missing.";
+  const hsa_amd_svm_profile_range_t& single = ranges[kSingleBase];
+  ASSERT_EQ(1u, single.page_faults);
+  ASSERT_EQ(1u, single.fault_epochs);
+  ASSERT_EQ(HSA_AMD_SVM_PROFILE_HINT_NONE, single.hint);
+
+  // Iteration stops at the first status other than success.
+  int calls = 0;
+  status = hsa_amd_svm_profile_iterate_ranges(StopAtFirst, &calls);
+  ASSERT_EQ(HSA_STATUS_INFO_BREAK, status);
+  ASSERT_EQ(1, calls);
+}
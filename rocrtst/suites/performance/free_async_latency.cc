@@ -0,0 +1,220 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <sched.h>
+
+#include <vector>
+
+#include "suites/performance/free_async_latency.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+FreeAsyncLatency::FreeAsyncLatency(void) : TestBase(), released_(0) {
+  sizes_ = {64 * 1024, 2 * 1024 * 1024, 16 * 1024 * 1024};
+  num_buffers_ = 32;
+
+#if ROCRTST_EMULATOR_BUILD
+  set_num_iteration(1);
+#else
+  set_num_iteration(10);
+#endif
+
+  set_title("Asynchronous Free Latency");
+  set_description("This test measures the host time to release a batch of "
+      "device buffers whose last use completes on a signal, by waiting on "
+      "the signal and calling hsa_amd_memory_pool_free, and by calling "
+      "hsa_amd_memory_pool_free_async with the signal as dependency.  It "
+      "also reports how long the runtime takes to reclaim the batch once "
+      "the signal completes.");
+}
+
+FreeAsyncLatency::~FreeAsyncLatency(void) {
+}
+
+void FreeAsyncLatency::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void FreeAsyncLatency::OnRelease(void* ptr, void* user_data) {
+  FreeAsyncLatency* test = reinterpret_cast<FreeAsyncLatency*>(user_data);
+  test->released_++;
+}
+
+void FreeAsyncLatency::AllocateBuffers(size_t size, std::vector<void*>* buffers) {
+  hsa_status_t err;
+
+  buffers->resize(num_buffers_);
+  for (uint32_t i = 0; i < num_buffers_; ++i) {
+    err = hsa_amd_memory_pool_allocate(device_pool(), size, 0, &(*buffers)[i]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+}
+
+void FreeAsyncLatency::Run(void) {
+  hsa_status_t err;
+
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  hsa_signal_t s;
+  err = hsa_signal_create(1, 0, nullptr, &s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  for (size_t size : sizes_) {
+    std::vector<double> sync_time;
+    std::vector<double> async_time;
+    std::vector<double> reclaim_time;
+    std::vector<void*> buffers;
+    rocrtst::PerfTimer p_timer;
+
+    for (uint32_t i = 0; i < num_iteration(); ++i) {
+      // The signal stands in for the completion of the last kernel using
+      // the buffers.
+      AllocateBuffers(size, &buffers);
+      hsa_signal_store_screlease(s, 0);
+
+      int id = p_timer.CreateTimer();
+      p_timer.StartTimer(id);
+      while (hsa_signal_wait_scacquire(s, HSA_SIGNAL_CONDITION_LT, 1,
+                                       UINT64_MAX, HSA_WAIT_STATE_ACTIVE)) {
+      }
+      for (void* ptr : buffers) {
+        err = hsa_amd_memory_pool_free(ptr);
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      }
+      p_timer.StopTimer(id);
+      sync_time.push_back(p_timer.ReadTimer(id));
+
+      AllocateBuffers(size, &buffers);
+      released_ = 0;
+      for (void* ptr : buffers) {
+        err = hsa_amd_register_deallocation_callback(ptr, OnRelease, this);
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      }
+      hsa_signal_store_screlease(s, 1);
+
+      id = p_timer.CreateTimer();
+      p_timer.StartTimer(id);
+      for (void* ptr : buffers) {
+        err = hsa_amd_memory_pool_free_async(ptr, s);
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      }
+      p_timer.StopTimer(id);
+      async_time.push_back(p_timer.ReadTimer(id));
+
+      // Nothing may be reclaimed before the dependency completes.
+      ASSERT_EQ(0u, released_.load());
+
+      // A queued free is no longer a valid allocation.
+      err = hsa_amd_memory_pool_free(buffers[0]);
+      ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ALLOCATION, err);
+
+      id = p_timer.CreateTimer();
+      p_timer.StartTimer(id);
+      hsa_signal_store_screlease(s, 0);
+      while (released_.load() != num_buffers_) {
+        sched_yield();
+      }
+      p_timer.StopTimer(id);
+      reclaim_time.push_back(p_timer.ReadTimer(id));
+    }
+
+    // A null dependency releases without waiting on anything.
+    AllocateBuffers(size, &buffers);
+    released_ = 0;
+    for (void* ptr : buffers) {
+      err = hsa_amd_register_deallocation_callback(ptr, OnRelease, this);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      err = hsa_amd_memory_pool_free_async(ptr, {0});
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    while (released_.load() != num_buffers_) {
+      sched_yield();
+    }
+
+    sync_time_mean_.push_back(rocrtst::CalcMean(sync_time));
+    async_time_mean_.push_back(rocrtst::CalcMean(async_time));
+    reclaim_time_mean_.push_back(rocrtst::CalcMean(reclaim_time));
+  }
+
+  err = hsa_signal_destroy(s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void FreeAsyncLatency::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void FreeAsyncLatency::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  for (size_t i = 0; i < sync_time_mean_.size(); ++i) {
+    std::cout << "Size " << (sizes_[i] >> 10) << " KB x " << num_buffers_ <<
+        ": wait and free " << sync_time_mean_[i] * 1e6 <<
+        " uS, free async " << async_time_mean_[i] * 1e6 <<
+        " uS, reclaim after signal " << reclaim_time_mean_[i] * 1e6 <<
+        " uS" << std::endl;
+  }
+}
+
+void FreeAsyncLatency::Close(void) {
+  TestBase::Close();
+}
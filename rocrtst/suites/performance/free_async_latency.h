@@ -0,0 +1,109 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_FREE_ASYNC_LATENCY_H_
+#define ROCRTST_SUITES_PERFORMANCE_FREE_ASYNC_LATENCY_H_
+#include <atomic>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// @Brief: This class measures the time a host thread spends releasing a
+//  batch of device buffers that are still in use, by waiting for the work
+//  and calling hsa_amd_memory_pool_free and by calling
+//  hsa_amd_memory_pool_free_async on the completion signal.
+
+class FreeAsyncLatency : public TestBase {
+ public:
+  // @Brief: Constructor
+  FreeAsyncLatency(void);
+
+  // @Brief: Destructor
+  virtual ~FreeAsyncLatency(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: Allocate num_buffers_ device buffers of size bytes
+  void AllocateBuffers(size_t size, std::vector<void*>* buffers);
+
+  // @Brief: Deallocation notifier counting reclaimed buffers
+  static void OnRelease(void* ptr, void* user_data);
+
+  // @Brief: Number of buffers released per batch
+  uint32_t num_buffers_;
+
+  // @Brief: Buffer sizes
+  std::vector<size_t> sizes_;
+
+  // @Brief: Buffers reclaimed by the runtime so far
+  std::atomic<uint32_t> released_;
+
+  // @Brief: Mean wait and free time per size, in seconds
+  std::vector<double> sync_time_mean_;
+
+  // @Brief: Mean time to queue the async frees per size, in seconds
+  std::vector<double> async_time_mean_;
+
+  // @Brief: Mean time from signal completion to full reclaim, in seconds
+  std::vector<double> reclaim_time_mean_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_FREE_ASYNC_LATENCY_H_
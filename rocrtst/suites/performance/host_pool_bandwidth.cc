@@ -0,0 +1,226 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "suites/performance/host_pool_bandwidth.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+static const size_t kBufferSize = 256 * 1024 * 1024;
+
+HostPoolBandwidth::HostPoolBandwidth(void) : TestBase() {
+  modes_ = {
+    {"Standard", 0, 0, 0, 0, 0},
+    {"2MB pages", HSA_AMD_MEMORY_POOL_HUGE_PAGE_2MB_FLAG, 0, 0, 0, 0},
+    {"1GB pages", HSA_AMD_MEMORY_POOL_HUGE_PAGE_1GB_FLAG, 0, 0, 0, 0},
+    {"NUMA interleave", HSA_AMD_MEMORY_POOL_NUMA_INTERLEAVE_FLAG, 0, 0, 0, 0},
+    {"2MB pages, NUMA interleave", HSA_AMD_MEMORY_POOL_HUGE_PAGE_2MB_FLAG |
+        HSA_AMD_MEMORY_POOL_NUMA_INTERLEAVE_FLAG, 0, 0, 0, 0},
+  };
+  device_buf_ = nullptr;
+
+#if ROCRTST_EMULATOR_BUILD
+  set_num_iteration(1);
+#else
+  set_num_iteration(10);
+#endif
+
+  set_title("Host Memory Pool Bandwidth");
+  set_description("This test measures CPU read and write bandwidth and "
+      "host/device DMA bandwidth of system memory pool buffers allocated "
+      "with each huge page and NUMA interleave allocation flag.");
+}
+
+HostPoolBandwidth::~HostPoolBandwidth(void) {
+}
+
+void HostPoolBandwidth::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_amd_memory_pool_allocate(device_pool(), kBufferSize, 0,
+                                     &device_buf_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+static double GBPerSec(size_t size, double seconds) {
+  return static_cast<double>(size) / seconds / 1e9;
+}
+
+void HostPoolBandwidth::RunMode(Mode* mode) {
+  hsa_status_t err;
+  void* host_buf = nullptr;
+
+  err = hsa_amd_memory_pool_allocate(cpu_pool(), kBufferSize, mode->flags,
+                                     &host_buf);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_amd_agents_allow_access(1, gpu_device1(), nullptr, host_buf);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_signal_t s;
+  err = hsa_signal_create(1, 0, nullptr, &s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  // Fault in the pages before measuring.
+  memset(host_buf, 0, kBufferSize);
+
+  std::vector<double> write_time;
+  std::vector<double> read_time;
+  std::vector<double> h2d_time;
+  std::vector<double> d2h_time;
+  rocrtst::PerfTimer p_timer;
+  volatile uint64_t sink = 0;
+
+  for (uint32_t i = 0; i < num_iteration(); ++i) {
+    int id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    memset(host_buf, i, kBufferSize);
+    p_timer.StopTimer(id);
+    write_time.push_back(p_timer.ReadTimer(id));
+
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(host_buf);
+    uint64_t sum = 0;
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (size_t w = 0; w < kBufferSize / sizeof(uint64_t); ++w) {
+      sum += words[w];
+    }
+    p_timer.StopTimer(id);
+    read_time.push_back(p_timer.ReadTimer(id));
+    sink = sum;
+
+    hsa_signal_store_relaxed(s, 1);
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    err = hsa_amd_memory_async_copy(device_buf_, *gpu_device1(), host_buf,
+                                    *cpu_device(), kBufferSize, 0, nullptr, s);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    while (hsa_signal_wait_scacquire(s, HSA_SIGNAL_CONDITION_LT, 1,
+                                     UINT64_MAX, HSA_WAIT_STATE_ACTIVE)) {
+    }
+    p_timer.StopTimer(id);
+    h2d_time.push_back(p_timer.ReadTimer(id));
+
+    hsa_signal_store_relaxed(s, 1);
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    err = hsa_amd_memory_async_copy(host_buf, *cpu_device(), device_buf_,
+                                    *gpu_device1(), kBufferSize, 0, nullptr, s);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    while (hsa_signal_wait_scacquire(s, HSA_SIGNAL_CONDITION_LT, 1,
+                                     UINT64_MAX, HSA_WAIT_STATE_ACTIVE)) {
+    }
+    p_timer.StopTimer(id);
+    d2h_time.push_back(p_timer.ReadTimer(id));
+  }
+  (void)sink;
+
+  mode->cpu_write = GBPerSec(kBufferSize, rocrtst::CalcMean(write_time));
+  mode->cpu_read = GBPerSec(kBufferSize, rocrtst::CalcMean(read_time));
+  mode->dma_h2d = GBPerSec(kBufferSize, rocrtst::CalcMean(h2d_time));
+  mode->dma_d2h = GBPerSec(kBufferSize, rocrtst::CalcMean(d2h_time));
+
+  err = hsa_signal_destroy(s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_amd_memory_pool_free(host_buf);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void HostPoolBandwidth::Run(void) {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  for (Mode& mode : modes_) {
+    RunMode(&mode);
+  }
+}
+
+void HostPoolBandwidth::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void HostPoolBandwidth::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "Buffer size: " << (kBufferSize >> 20) << " MB, bandwidth in GB/s"
+      << std::endl;
+  std::cout << "Mode                         CPU write  CPU read  H2D DMA  "
+      "D2H DMA" << std::endl;
+  for (const Mode& mode : modes_) {
+    std::cout << std::left << std::setw(29) << mode.name << std::right <<
+        std::fixed << std::setprecision(2) << std::setw(9) <<
+        mode.cpu_write << std::setw(10) << mode.cpu_read << std::setw(9) <<
+        mode.dma_h2d << std::setw(9) << mode.dma_d2h << std::endl;
+  }
+}
+
+void HostPoolBandwidth::Close(void) {
+  if (device_buf_ != nullptr) {
+    hsa_amd_memory_pool_free(device_buf_);
+    device_buf_ = nullptr;
+  }
+  TestBase::Close();
+}
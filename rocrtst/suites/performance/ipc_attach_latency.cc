@@ -0,0 +1,275 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "suites/performance/ipc_attach_latency.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+IPCAttachLatency::IPCAttachLatency(void) : TestBase(),
+    skipped_(false), single_time_mean_(0), batch_time_mean_(0), cached_time_mean_(0),
+    shared_(nullptr),
+    parent_process_(true), child_index_(0) {
+  buffer_size_ = 1024 * 1024;
+#if ROCRTST_EMULATOR_BUILD
+  set_num_iteration(2);
+#else
+  set_num_iteration(10);
+#endif
+
+  set_title("IPC Attach Latency");
+  set_description("This test exports host allocations from one process and "
+      "measures the time for several processes to attach them concurrently, "
+      "one handle per call, all handles in one batched call, and again "
+      "after detaching when the mappings are reused from the attach cache, "
+      "and checks that detaching a mapping twice fails.");
+}
+
+IPCAttachLatency::~IPCAttachLatency(void) {
+}
+
+void IPCAttachLatency::SetUp(void) {
+  hsa_status_t err;
+
+  // Each process must fork before hsa_init.
+  shared_ = reinterpret_cast<Shared*>(mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(shared_, MAP_FAILED) << "mmap failed to allocate shared memory";
+  memset(reinterpret_cast<void*>(shared_), 0, sizeof(Shared));
+
+  for (uint32_t i = 0; i < kNumChildren; ++i) {
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid) << "fork failed";
+    if (pid == 0) {
+      parent_process_ = false;
+      child_index_ = i;
+      set_verbosity(0);
+      break;
+    }
+    children_[i] = pid;
+  }
+
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+bool IPCAttachLatency::ChildProcessImpl(void) {
+  while (shared_->ready == 0) sched_yield();
+  if (shared_->ready != 1) return true;
+
+  std::vector<size_t> lens(kNumBuffers, shared_->size);
+  std::vector<void*> ptrs(kNumBuffers);
+  std::vector<double> single_time;
+  std::vector<double> batch_time;
+  std::vector<double> cached_time;
+  rocrtst::PerfTimer p_timer;
+  hsa_status_t err;
+
+  for (uint32_t it = 0; it < num_iteration(); ++it) {
+    int id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (uint32_t i = 0; i < kNumBuffers; ++i) {
+      err = hsa_amd_ipc_memory_attach(&shared_->handles[i], lens[i], 0, nullptr, &ptrs[i]);
+      if (err != HSA_STATUS_SUCCESS) return false;
+    }
+    p_timer.StopTimer(id);
+    single_time.push_back(p_timer.ReadTimer(id) / kNumBuffers);
+
+    for (uint32_t i = 0; i < kNumBuffers; ++i) {
+      if (hsa_amd_ipc_memory_detach(ptrs[i]) != HSA_STATUS_SUCCESS) return false;
+    }
+    if (hsa_amd_ipc_memory_cache_purge() != HSA_STATUS_SUCCESS) return false;
+
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    err = hsa_amd_ipc_memory_attach_batch(kNumBuffers, shared_->handles, &lens[0], 0, nullptr,
+                                          &ptrs[0]);
+    if (err != HSA_STATUS_SUCCESS) return false;
+    p_timer.StopTimer(id);
+    batch_time.push_back(p_timer.ReadTimer(id) / kNumBuffers);
+
+    // Attached memory holds the exported data.
+    if (*reinterpret_cast<uint32_t*>(ptrs[kNumBuffers - 1]) != kNumBuffers - 1) return false;
+
+    for (uint32_t i = 0; i < kNumBuffers; ++i) {
+      if (hsa_amd_ipc_memory_detach(ptrs[i]) != HSA_STATUS_SUCCESS) return false;
+    }
+
+    // Detached mappings stay cached, so attaching again reuses them.
+    hsa_amd_ipc_memory_cache_stats_t before, after;
+    if (hsa_amd_ipc_memory_cache_stats(&before) != HSA_STATUS_SUCCESS) return false;
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (uint32_t i = 0; i < kNumBuffers; ++i) {
+      err = hsa_amd_ipc_memory_attach(&shared_->handles[i], lens[i], 0, nullptr, &ptrs[i]);
+      if (err != HSA_STATUS_SUCCESS) return false;
+    }
+    p_timer.StopTimer(id);
+    cached_time.push_back(p_timer.ReadTimer(id) / kNumBuffers);
+    if (hsa_amd_ipc_memory_cache_stats(&after) != HSA_STATUS_SUCCESS) return false;
+    if (after.hits - before.hits != before.idle) return false;
+
+    for (uint32_t i = 0; i < kNumBuffers; ++i) {
+      if (hsa_amd_ipc_memory_detach(ptrs[i]) != HSA_STATUS_SUCCESS) return false;
+    }
+
+    // Detaching an idle cached mapping again fails and leaves it idle.
+    if (hsa_amd_ipc_memory_cache_stats(&before) != HSA_STATUS_SUCCESS) return false;
+    err = hsa_amd_ipc_memory_detach(ptrs[0]);
+    if (err != HSA_STATUS_ERROR_INVALID_ARGUMENT) return false;
+    if (hsa_amd_ipc_memory_cache_stats(&after) != HSA_STATUS_SUCCESS) return false;
+    if (after.idle != before.idle || after.active != before.active) return false;
+
+    if (hsa_amd_ipc_memory_cache_purge() != HSA_STATUS_SUCCESS) return false;
+  }
+
+  shared_->single_time[child_index_] = rocrtst::CalcMean(single_time);
+  shared_->batch_time[child_index_] = rocrtst::CalcMean(batch_time);
+  shared_->cached_time[child_index_] = rocrtst::CalcMean(cached_time);
+  return true;
+}
+
+void IPCAttachLatency::ParentProcessImpl(void) {
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  std::vector<void*> buffers;
+
+  for (uint32_t i = 0; i < kNumBuffers && err == HSA_STATUS_SUCCESS; ++i) {
+    void* ptr;
+    err = hsa_amd_memory_pool_allocate(cpu_pool(), buffer_size_, 0, &ptr);
+    if (err != HSA_STATUS_SUCCESS) break;
+    buffers.push_back(ptr);
+    *reinterpret_cast<uint32_t*>(ptr) = i;
+    err = hsa_amd_ipc_memory_create(ptr, buffer_size_, &shared_->handles[i]);
+  }
+
+  // Host memory can only be exported with dmabuf IPC.
+  shared_->size = buffer_size_;
+  skipped_ = (err != HSA_STATUS_SUCCESS);
+  shared_->ready = skipped_ ? -1 : 1;
+
+  bool children_ok = true;
+  for (uint32_t i = 0; i < kNumChildren; ++i) {
+    int status = 0;
+    waitpid(children_[i], &status, 0);
+    children_ok &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+
+  for (void* ptr : buffers) {
+    err = hsa_amd_memory_pool_free(ptr);
+    EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+
+  ASSERT_TRUE(children_ok) << "Importing process failed";
+  if (skipped_) {
+    std::cout << "Host memory IPC export not supported, set "
+        "HSA_ENABLE_IPC_MODE_LEGACY=0. Test skipped." << std::endl;
+    return;
+  }
+
+  std::vector<double> single_time(shared_->single_time, shared_->single_time + kNumChildren);
+  std::vector<double> batch_time(shared_->batch_time, shared_->batch_time + kNumChildren);
+  single_time_mean_ = rocrtst::CalcMean(single_time);
+  batch_time_mean_ = rocrtst::CalcMean(batch_time);
+  std::vector<double> cached_time(shared_->cached_time, shared_->cached_time + kNumChildren);
+  cached_time_mean_ = rocrtst::CalcMean(cached_time);
+}
+
+void IPCAttachLatency::Run(void) {
+  if (!rocrtst::CheckProfile(this)) {
+    if (!parent_process_) exit(0);
+    return;
+  }
+  TestBase::Run();
+
+  // Note: Close() (and hsa_shut_down()) will be called from main()
+  if (parent_process_) {
+    ParentProcessImpl();
+  } else {
+    exit(ChildProcessImpl() ? 0 : 1);
+  }
+}
+
+void IPCAttachLatency::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void IPCAttachLatency::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this) || skipped_) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "Importing processes: " << kNumChildren << ", handles per process: " <<
+      kNumBuffers << ", buffer size: " << buffer_size_ << " bytes" << std::endl;
+  std::cout << "Attach one handle per call: " << single_time_mean_ * 1e6 <<
+      " uS/handle" << std::endl;
+  std::cout << "Attach all handles in one call: " << batch_time_mean_ * 1e6 <<
+      " uS/handle" << std::endl;
+  std::cout << "Attach cached mappings: " << cached_time_mean_ * 1e6 <<
+      " uS/handle" << std::endl;
+}
+
+void IPCAttachLatency::Close(void) {
+  if (shared_ != nullptr && parent_process_) {
+    munmap(shared_, sizeof(Shared));
+    shared_ = nullptr;
+  }
+  TestBase::Close();
+}
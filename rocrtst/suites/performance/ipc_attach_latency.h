@@ -0,0 +1,126 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_IPC_ATTACH_LATENCY_H_
+#define ROCRTST_SUITES_PERFORMANCE_IPC_ATTACH_LATENCY_H_
+#include <sys/types.h>
+#include <atomic>
+
+#include "suites/test_common/test_base.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// @Brief: This class measures the time for several processes to attach host
+//  allocations exported by one process, attaching one handle per call with
+//  hsa_amd_ipc_memory_attach and all handles in one call with
+//  hsa_amd_ipc_memory_attach_batch, and reattaching mappings kept by the
+//  attach cache.  The dmabuf IPC path is used when
+//  HSA_ENABLE_IPC_MODE_LEGACY=0.
+
+class IPCAttachLatency : public TestBase {
+ public:
+  // @Brief: Constructor
+  IPCAttachLatency(void);
+
+  // @Brief: Destructor
+  virtual ~IPCAttachLatency(void);
+
+  // @Brief: Fork the importing processes and set up the environment
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+  static const uint32_t kNumBuffers = 64;
+  static const uint32_t kNumChildren = 4;
+
+  // @Brief: Data shared between the exporting and importing processes
+  struct Shared {
+    std::atomic<int> ready;  // 1 when handles are published, -1 on failure
+    size_t size;
+    hsa_amd_ipc_memory_t handles[kNumBuffers];
+    double single_time[kNumChildren];
+    double batch_time[kNumChildren];
+    double cached_time[kNumChildren];
+  };
+
+ private:
+  // @Brief: Exports the buffers and waits for the importers
+  void ParentProcessImpl(void);
+
+  // @Brief: Times attaching the exported buffers, returns false on failure
+  bool ChildProcessImpl(void);
+
+  // @Brief: Size of each exported buffer
+  size_t buffer_size_;
+
+  // @Brief: True if exporting on this system failed and the test was skipped
+  bool skipped_;
+
+  // @Brief: Mean time per handle attaching one handle per call, in seconds
+  double single_time_mean_;
+
+  // @Brief: Mean time per handle attaching all handles in one call, in seconds
+  double batch_time_mean_;
+
+  // @Brief: Mean time per handle reattaching cached mappings, in seconds
+  double cached_time_mean_;
+
+  Shared* shared_;
+  bool parent_process_;
+  uint32_t child_index_;
+  pid_t children_[kNumChildren];
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_IPC_ATTACH_LATENCY_H_
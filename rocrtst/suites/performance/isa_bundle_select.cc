@@ -0,0 +1,217 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "suites/performance/isa_bundle_select.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+static const char* kProcessors[] = {
+  "gfx700", "gfx701", "gfx702", "gfx801", "gfx802", "gfx803", "gfx805",
+  "gfx810", "gfx900", "gfx902", "gfx904", "gfx906", "gfx908", "gfx909",
+  "gfx90a", "gfx90c", "gfx940", "gfx941", "gfx942", "gfx1010", "gfx1011",
+  "gfx1012", "gfx1013", "gfx1030", "gfx1031", "gfx1032", "gfx1033",
+  "gfx1034", "gfx1035", "gfx1036", "gfx1100", "gfx1101", "gfx1102",
+  "gfx1103", "gfx1150", "gfx1151", "gfx1152", "gfx1200", "gfx1201"};
+
+static const char* kFeatures[] = {
+  "", ":xnack-", ":xnack+", ":sramecc-", ":sramecc+", ":sramecc-:xnack-",
+  ":sramecc-:xnack+", ":sramecc+:xnack-", ":sramecc+:xnack+"};
+
+IsaBundleSelect::IsaBundleSelect(void) : TestBase() {
+  // Every target/feature combination, most of them unsupported by the
+  // processor, as found in bundles built for many targets.
+  for (const char* processor : kProcessors) {
+    for (const char* features : kFeatures) {
+      entry_names_.push_back(std::string("hipv4-amdgcn-amd-amdhsa--") +
+                             processor + features);
+    }
+  }
+  for (const std::string& name : entry_names_) {
+    entries_.push_back(name.c_str());
+  }
+  memset(&loader_, 0, sizeof(loader_));
+  name_time_mean_ = 0.0;
+  index_time_mean_ = 0.0;
+
+#if ROCRTST_EMULATOR_BUILD
+  set_num_iteration(1);
+#else
+  set_num_iteration(100);
+#endif
+
+  set_title("ISA Bundle Entry Selection");
+  set_description("This test measures the time to select the code object of "
+      "each GPU agent from a bundle with one entry per target ID, by querying "
+      "each entry name and by hsa_ven_amd_loader_select_bundle_entries.");
+}
+
+IsaBundleSelect::~IsaBundleSelect(void) {
+}
+
+void IsaBundleSelect::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = hsa_system_get_major_extension_table(HSA_EXTENSION_AMD_LOADER, 1,
+                                             sizeof(loader_), &loader_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_iterate_agents(rocrtst::IterateGPUAgents, &gpus_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+namespace {
+struct CompatibleData {
+  hsa_isa_t code_object_isa;
+  bool compatible;
+};
+
+uint32_t EntrySpecificity(const std::string& name) {
+  uint32_t specificity = 0;
+  for (const char* feature : {":sramecc+", ":sramecc-", ":xnack+", ":xnack-"}) {
+    if (name.find(feature) != std::string::npos) {
+      specificity++;
+    }
+  }
+  return specificity;
+}
+}  // namespace
+
+void IsaBundleSelect::SelectByName(std::vector<int32_t>* selected) {
+  selected->assign(gpus_.size(), -1);
+  for (size_t a = 0; a < gpus_.size(); ++a) {
+    uint32_t best = 0;
+    for (size_t e = 0; e < entry_names_.size(); ++e) {
+      const std::string& entry = entry_names_[e];
+      std::string name = entry.substr(entry.find("amdgcn-amd-amdhsa--"));
+      CompatibleData data = {{0}, false};
+      if (hsa_isa_from_name(name.c_str(), &data.code_object_isa) !=
+          HSA_STATUS_SUCCESS) {
+        continue;
+      }
+      hsa_agent_iterate_isas(gpus_[a], [](hsa_isa_t isa, void* d) {
+        CompatibleData* cd = reinterpret_cast<CompatibleData*>(d);
+        hsa_isa_compatible(cd->code_object_isa, isa, &cd->compatible);
+        return cd->compatible ? HSA_STATUS_INFO_BREAK : HSA_STATUS_SUCCESS;
+      }, &data);
+      uint32_t specificity = EntrySpecificity(name);
+      if (data.compatible && ((*selected)[a] == -1 || specificity > best)) {
+        (*selected)[a] = static_cast<int32_t>(e);
+        best = specificity;
+      }
+    }
+  }
+}
+
+void IsaBundleSelect::SelectByIndex(std::vector<int32_t>* selected) {
+  selected->assign(gpus_.size(), -1);
+  hsa_status_t err = loader_.hsa_ven_amd_loader_select_bundle_entries(
+      entries_.data(), static_cast<uint32_t>(entries_.size()), gpus_.data(),
+      static_cast<uint32_t>(gpus_.size()), selected->data());
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void IsaBundleSelect::Run(void) {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  std::vector<int32_t> by_name;
+  std::vector<int32_t> by_index;
+  SelectByName(&by_name);
+  SelectByIndex(&by_index);
+  ASSERT_EQ(by_name, by_index);
+
+  std::vector<double> name_time;
+  std::vector<double> index_time;
+  rocrtst::PerfTimer p_timer;
+  for (uint32_t i = 0; i < num_iteration(); ++i) {
+    int id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    SelectByName(&by_name);
+    p_timer.StopTimer(id);
+    name_time.push_back(p_timer.ReadTimer(id));
+
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    SelectByIndex(&by_index);
+    p_timer.StopTimer(id);
+    index_time.push_back(p_timer.ReadTimer(id));
+  }
+
+  name_time_mean_ = rocrtst::CalcMean(name_time);
+  index_time_mean_ = rocrtst::CalcMean(index_time);
+}
+
+void IsaBundleSelect::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void IsaBundleSelect::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "Bundle entries: " << entries_.size() << ", GPU agents: " <<
+      gpus_.size() << std::endl;
+  std::cout << "Average selection time by name: " << name_time_mean_ * 1e6 <<
+      " uS" << std::endl;
+  std::cout << "Average selection time by index: " << index_time_mean_ * 1e6 <<
+      " uS" << std::endl;
+}
+
+void IsaBundleSelect::Close(void) {
+  TestBase::Close();
+}
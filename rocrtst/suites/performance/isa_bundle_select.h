@@ -0,0 +1,108 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_ISA_BUNDLE_SELECT_H_
+#define ROCRTST_SUITES_PERFORMANCE_ISA_BUNDLE_SELECT_H_
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ven_amd_loader.h"
+
+// @Brief: This class measures the time to pick the code object of a large
+//  multi-target bundle for every GPU agent, by name based ISA queries and
+//  by hsa_ven_amd_loader_select_bundle_entries.
+
+class IsaBundleSelect : public TestBase {
+ public:
+  // @Brief: Constructor
+  IsaBundleSelect(void);
+
+  // @Brief: Destructor
+  virtual ~IsaBundleSelect(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: Select entries through hsa_isa_from_name and hsa_isa_compatible
+  void SelectByName(std::vector<int32_t>* selected);
+
+  // @Brief: Select entries through the loader extension
+  void SelectByIndex(std::vector<int32_t>* selected);
+
+  // @Brief: Bundle entry IDs
+  std::vector<std::string> entry_names_;
+
+  // @Brief: Pointers to the bundle entry IDs
+  std::vector<const char*> entries_;
+
+  // @Brief: GPU agents
+  std::vector<hsa_agent_t> gpus_;
+
+  // @Brief: Loader extension table
+  hsa_ven_amd_loader_1_06_pfn_t loader_;
+
+  // @Brief: Mean selection time by name, in seconds
+  double name_time_mean_;
+
+  // @Brief: Mean selection time by index, in seconds
+  double index_time_mean_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_ISA_BUNDLE_SELECT_H_
@@ -0,0 +1,183 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <vector>
+
+#include "suites/performance/ordered_pool_latency.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+OrderedPoolLatency::OrderedPoolLatency(void) : TestBase() {
+  sizes_ = {64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 64 * 1024 * 1024};
+
+#if ROCRTST_EMULATOR_BUILD
+  set_num_iteration(2);
+#else
+  set_num_iteration(100);
+#endif
+
+  set_title("Ordered Pool Allocation Latency");
+  set_description("This test measures the time to allocate and free device "
+      "memory with hsa_amd_memory_pool_allocate and with an ordered pool, "
+      "whose frees carry a release signal and are handed out again to "
+      "allocations that order after it.");
+}
+
+OrderedPoolLatency::~OrderedPoolLatency(void) {
+}
+
+void OrderedPoolLatency::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void OrderedPoolLatency::Run(void) {
+  hsa_status_t err;
+
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  hsa_amd_ordered_pool_t pool;
+  err = hsa_amd_ordered_pool_create(device_pool(), 0, nullptr, &pool);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  // Stands in for the completion signal of the last kernel using a buffer.
+  hsa_signal_t s;
+  err = hsa_signal_create(1, 0, nullptr, &s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  for (size_t size : sizes_) {
+    std::vector<double> pool_time;
+    std::vector<double> ordered_time;
+    rocrtst::PerfTimer p_timer;
+    void* ptr = nullptr;
+
+    for (uint32_t i = 0; i < num_iteration(); ++i) {
+      int id = p_timer.CreateTimer();
+      p_timer.StartTimer(id);
+      err = hsa_amd_memory_pool_allocate(device_pool(), size, 0, &ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      err = hsa_amd_memory_pool_free(ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      p_timer.StopTimer(id);
+      pool_time.push_back(p_timer.ReadTimer(id));
+
+      hsa_signal_t dep;
+      id = p_timer.CreateTimer();
+      p_timer.StartTimer(id);
+      err = hsa_amd_ordered_pool_allocate(pool, size, &ptr, &dep);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      hsa_signal_store_screlease(s, 1);
+      err = hsa_amd_ordered_pool_free(pool, ptr, s);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      p_timer.StopTimer(id);
+      ordered_time.push_back(p_timer.ReadTimer(id));
+
+      // Reuse of the pending free is only offered with a dependency.
+      void* ready = nullptr;
+      err = hsa_amd_ordered_pool_allocate(pool, size, &ready, nullptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      ASSERT_NE(ptr, ready);
+
+      void* reused = nullptr;
+      err = hsa_amd_ordered_pool_allocate(pool, size, &reused, &dep);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      ASSERT_EQ(ptr, reused);
+      ASSERT_EQ(s.handle, dep.handle);
+
+      hsa_signal_store_screlease(s, 0);
+      err = hsa_amd_ordered_pool_free(pool, ready, {0});
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      err = hsa_amd_ordered_pool_free(pool, reused, s);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+
+    // The first ordered allocation of each size reserves a block.
+    pool_time.erase(pool_time.begin());
+    ordered_time.erase(ordered_time.begin());
+    pool_time_mean_.push_back(rocrtst::CalcMean(pool_time));
+    ordered_time_mean_.push_back(rocrtst::CalcMean(ordered_time));
+  }
+
+  err = hsa_amd_ordered_pool_trim(pool, 0);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_amd_ordered_pool_destroy(pool);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_signal_destroy(s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void OrderedPoolLatency::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void OrderedPoolLatency::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  for (size_t i = 0; i < pool_time_mean_.size(); ++i) {
+    std::cout << "Size " << (sizes_[i] >> 10) << " KB: memory pool " <<
+        pool_time_mean_[i] * 1e6 << " uS, ordered pool " <<
+        ordered_time_mean_[i] * 1e6 << " uS" << std::endl;
+  }
+}
+
+void OrderedPoolLatency::Close(void) {
+  TestBase::Close();
+}
@@ -0,0 +1,226 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "suites/performance/svm_attrib_async.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+static const size_t kRangeSize = 64 * 1024;
+
+SvmAttribAsync::SvmAttribAsync(void) : TestBase(),
+    skipped_(false), sync_time_mean_(0), submit_time_mean_(0), drain_time_mean_(0) {
+#if ROCRTST_EMULATOR_BUILD
+  num_ranges_ = 16;
+  set_num_iteration(2);
+#else
+  num_ranges_ = 256;
+  set_num_iteration(10);
+#endif
+
+  set_title("SVM Asynchronous Attributes");
+  set_description("This test sets the preferred location and read mostly "
+      "attributes of each range of a buffer, first with "
+      "hsa_amd_svm_attributes_set and then with "
+      "hsa_amd_svm_attributes_set_async behind one dependency signal.  It "
+      "measures the host time per change of both, and the time for the queued "
+      "changes to complete, then checks the result with "
+      "hsa_amd_svm_attributes_get_async.  The preferred location alternates "
+      "between the GPU and the CPU.");
+}
+
+SvmAttribAsync::~SvmAttribAsync(void) {
+}
+
+void SvmAttribAsync::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void SvmAttribAsync::Run(void) {
+  hsa_status_t err;
+
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  bool svm = false;
+  err = hsa_system_get_info(static_cast<hsa_system_info_t>(HSA_AMD_SYSTEM_INFO_SVM_SUPPORTED),
+                            &svm);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  if (!svm) {
+    skipped_ = true;
+    std::cout << "SVM not supported. Test skipped." << std::endl;
+    return;
+  }
+
+  const size_t size = num_ranges_ * kRangeSize;
+  void* buffer = nullptr;
+  ASSERT_EQ(0, posix_memalign(&buffer, kRangeSize, size));
+  memset(buffer, 0, size);
+
+  hsa_amd_svm_attribute_pair_t access = {HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE,
+                                         gpu_device1()->handle};
+  err = hsa_amd_svm_attributes_set(buffer, size, &access, 1);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_signal_t dep, done;
+  err = hsa_signal_create(1, 0, nullptr, &dep);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_signal_create(0, 0, nullptr, &done);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  std::vector<double> sync_time;
+  std::vector<double> submit_time;
+  std::vector<double> drain_time;
+  rocrtst::PerfTimer p_timer;
+
+  auto wait_done = [&]() {
+    hsa_signal_value_t value;
+    while ((value = hsa_signal_wait_scacquire(done, HSA_SIGNAL_CONDITION_LT, 1, UINT64_MAX,
+                                              HSA_WAIT_STATE_BLOCKED)) > 0) {
+    }
+    return value;
+  };
+
+  for (uint32_t it = 0; it < num_iteration(); ++it) {
+    hsa_agent_t sync_dest = (it % 2 == 0) ? *cpu_device() : *gpu_device1();
+    hsa_agent_t dest = (it % 2 == 0) ? *gpu_device1() : *cpu_device();
+    uint64_t read_mostly = it % 2;
+
+    int id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (uint32_t i = 0; i < num_ranges_; ++i) {
+      uint8_t* range = reinterpret_cast<uint8_t*>(buffer) + i * kRangeSize;
+      hsa_amd_svm_attribute_pair_t pref = {HSA_AMD_SVM_ATTRIB_PREFERRED_LOCATION,
+                                           sync_dest.handle};
+      err = hsa_amd_svm_attributes_set(range, kRangeSize, &pref, 1);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      hsa_amd_svm_attribute_pair_t mostly = {HSA_AMD_SVM_ATTRIB_READ_MOSTLY, !read_mostly};
+      err = hsa_amd_svm_attributes_set(range, kRangeSize, &mostly, 1);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    p_timer.StopTimer(id);
+    sync_time.push_back(p_timer.ReadTimer(id) / (2 * num_ranges_));
+
+    hsa_signal_store_relaxed(dep, 1);
+    hsa_signal_store_relaxed(done, 2 * num_ranges_);
+
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (uint32_t i = 0; i < num_ranges_; ++i) {
+      uint8_t* range = reinterpret_cast<uint8_t*>(buffer) + i * kRangeSize;
+      hsa_amd_svm_attribute_pair_t pref = {HSA_AMD_SVM_ATTRIB_PREFERRED_LOCATION, dest.handle};
+      err = hsa_amd_svm_attributes_set_async(range, kRangeSize, &pref, 1, 1, &dep, done);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      hsa_amd_svm_attribute_pair_t mostly = {HSA_AMD_SVM_ATTRIB_READ_MOSTLY, read_mostly};
+      err = hsa_amd_svm_attributes_set_async(range, kRangeSize, &mostly, 1, 1, &dep, done);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    p_timer.StopTimer(id);
+    submit_time.push_back(p_timer.ReadTimer(id) / (2 * num_ranges_));
+
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    hsa_signal_store_screlease(dep, 0);
+    ASSERT_EQ(0, wait_done()) << "Asynchronous attribute change failed.";
+    p_timer.StopTimer(id);
+    drain_time.push_back(p_timer.ReadTimer(id));
+
+    hsa_amd_svm_attribute_pair_t query[2] = {{HSA_AMD_SVM_ATTRIB_PREFERRED_LOCATION, 0},
+                                             {HSA_AMD_SVM_ATTRIB_READ_MOSTLY, 0}};
+    hsa_signal_store_relaxed(done, 1);
+    err = hsa_amd_svm_attributes_get_async(buffer, size, query, 2, 0, nullptr, done);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    ASSERT_EQ(0, wait_done()) << "Asynchronous attribute query failed.";
+    ASSERT_EQ(dest.handle, query[0].value);
+    ASSERT_EQ(read_mostly, query[1].value);
+  }
+
+  err = hsa_signal_destroy(dep);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_signal_destroy(done);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  free(buffer);
+
+  sync_time_mean_ = rocrtst::CalcMean(sync_time);
+  submit_time_mean_ = rocrtst::CalcMean(submit_time);
+  drain_time_mean_ = rocrtst::CalcMean(drain_time);
+}
+
+void SvmAttribAsync::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void SvmAttribAsync::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this) || skipped_) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "Attribute changes per iteration: 2 x " << num_ranges_ << " x " << kRangeSize <<
+      " bytes" << std::endl;
+  std::cout << "Synchronous: " << sync_time_mean_ * 1e6 << " uS/change" << std::endl;
+  std::cout << "Asynchronous submission: " << submit_time_mean_ * 1e6 << " uS/change" <<
+      std::endl;
+  std::cout << "Completion after dependency: " << drain_time_mean_ * 1e3 << " mS" << std::endl;
+}
+
+void SvmAttribAsync::Close(void) {
+  TestBase::Close();
+}
@@ -0,0 +1,187 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "suites/performance/svm_prefetch_batch.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+static const size_t kPageSize = 4096;
+
+SvmPrefetchBatch::SvmPrefetchBatch(void) : TestBase(),
+    skipped_(false), submit_time_mean_(0), drain_time_mean_(0) {
+#if ROCRTST_EMULATOR_BUILD
+  num_pages_ = 64;
+  set_num_iteration(2);
+#else
+  num_pages_ = 4096;
+  set_num_iteration(10);
+#endif
+
+  set_title("SVM Prefetch Batching");
+  set_description("This test submits one page sized hsa_amd_svm_prefetch_async "
+      "per page of a buffer, all depending on one signal, then releases the "
+      "signal.  It measures the submission time per prefetch and the time "
+      "for all prefetches to complete, and checks the buffer ends up at the "
+      "prefetch destination.  Destinations alternate between the GPU and "
+      "the CPU so every iteration migrates the buffer.");
+}
+
+SvmPrefetchBatch::~SvmPrefetchBatch(void) {
+}
+
+void SvmPrefetchBatch::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void SvmPrefetchBatch::Run(void) {
+  hsa_status_t err;
+
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  bool svm = false;
+  err = hsa_system_get_info(static_cast<hsa_system_info_t>(HSA_AMD_SYSTEM_INFO_SVM_SUPPORTED),
+                            &svm);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  if (!svm) {
+    skipped_ = true;
+    std::cout << "SVM not supported. Test skipped." << std::endl;
+    return;
+  }
+
+  const size_t size = num_pages_ * kPageSize;
+  void* buffer = nullptr;
+  ASSERT_EQ(0, posix_memalign(&buffer, kPageSize, size));
+  memset(buffer, 0, size);
+
+  hsa_amd_svm_attribute_pair_t access = {HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE,
+                                         gpu_device1()->handle};
+  err = hsa_amd_svm_attributes_set(buffer, size, &access, 1);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_signal_t dep, done;
+  err = hsa_signal_create(1, 0, nullptr, &dep);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_signal_create(0, 0, nullptr, &done);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  std::vector<double> submit_time;
+  std::vector<double> drain_time;
+  rocrtst::PerfTimer p_timer;
+
+  for (uint32_t it = 0; it < num_iteration(); ++it) {
+    hsa_agent_t dest = (it % 2 == 0) ? *gpu_device1() : *cpu_device();
+    hsa_signal_store_relaxed(dep, 1);
+    hsa_signal_store_relaxed(done, num_pages_);
+
+    int id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (uint32_t i = 0; i < num_pages_; ++i) {
+      err = hsa_amd_svm_prefetch_async(reinterpret_cast<uint8_t*>(buffer) + i * kPageSize,
+                                       kPageSize, dest, 1, &dep, done);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    p_timer.StopTimer(id);
+    submit_time.push_back(p_timer.ReadTimer(id) / num_pages_);
+
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    hsa_signal_store_screlease(dep, 0);
+    while (hsa_signal_wait_scacquire(done, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                                     HSA_WAIT_STATE_BLOCKED) != 0) {
+    }
+    p_timer.StopTimer(id);
+    drain_time.push_back(p_timer.ReadTimer(id));
+
+    hsa_amd_svm_attribute_pair_t location = {HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION, 0};
+    err = hsa_amd_svm_attributes_get(buffer, size, &location, 1);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    ASSERT_EQ(dest.handle, location.value);
+  }
+
+  err = hsa_signal_destroy(dep);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_signal_destroy(done);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  free(buffer);
+
+  submit_time_mean_ = rocrtst::CalcMean(submit_time);
+  drain_time_mean_ = rocrtst::CalcMean(drain_time);
+}
+
+void SvmPrefetchBatch::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void SvmPrefetchBatch::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this) || skipped_) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "Prefetches per iteration: " << num_pages_ << " x " << kPageSize <<
+      " bytes" << std::endl;
+  std::cout << "Submission: " << submit_time_mean_ * 1e6 << " uS/prefetch" << std::endl;
+  std::cout << "Completion after dependency: " << drain_time_mean_ * 1e3 << " mS" << std::endl;
+}
+
+void SvmPrefetchBatch::Close(void) {
+  TestBase::Close();
+}
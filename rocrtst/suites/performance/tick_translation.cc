@@ -0,0 +1,189 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <algorithm>
+#include <vector>
+
+#include "suites/performance/tick_translation.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+// Largest difference allowed between the runtime's fixed point conversion and
+// the double precision reference, in system ticks.  Each endpoint of the
+// reference is rounded once and the fixed point ratio once more.
+static const uint64_t kMaxTickError = 4;
+
+// Conversion of @p tick with the clock correlation points (t0_gpu, t0_sys) and
+// (t1_gpu, t1_sys), as the runtime computed it with a double precision ratio.
+static uint64_t ReferenceTranslate(uint64_t t0_gpu, uint64_t t0_sys, uint64_t t1_gpu,
+                                   uint64_t t1_sys, uint64_t tick) {
+  double ratio = double(t1_sys - t0_sys) / double(t1_gpu - t0_gpu);
+  int64_t elapsed = int64_t(ratio * double(int64_t(tick - t1_gpu)));
+  return uint64_t(elapsed) + t1_sys;
+}
+
+TickTranslation::TickTranslation(void) : TestBase(),
+    single_time_mean_(0), batch_time_mean_(0), max_error_(0) {
+#if ROCRTST_EMULATOR_BUILD
+  num_ticks_ = 1024;
+  set_num_iteration(2);
+#else
+  num_ticks_ = 1024 * 1024;
+  set_num_iteration(10);
+#endif
+
+  set_title("Agent Tick Translation Throughput");
+  set_description("This test measures the time to convert agent ticks to the "
+      "system domain one tick per call and in bulk, and verifies both "
+      "against a double precision reference conversion.");
+}
+
+TickTranslation::~TickTranslation(void) {
+}
+
+void TickTranslation::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void TickTranslation::Run(void) {
+  hsa_status_t err;
+
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  // Consecutive ticks from agent clock reset.  They predate runtime
+  // initialization, so all of them are converted with the one clock ratio the
+  // runtime fixes for early ticks and the conversion never resyncs clocks.
+  std::vector<uint64_t> ticks(num_ticks_);
+  for (size_t i = 0; i < num_ticks_; ++i) ticks[i] = 1 + i;
+
+  std::vector<uint64_t> single(num_ticks_);
+  std::vector<uint64_t> batch(num_ticks_);
+  std::vector<double> single_time;
+  std::vector<double> batch_time;
+  rocrtst::PerfTimer p_timer;
+
+  for (uint32_t it = 0; it < num_iteration(); ++it) {
+    int id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (size_t i = 0; i < num_ticks_; ++i) {
+      err = hsa_amd_profiling_convert_tick_to_system_domain(*gpu_device1(), ticks[i],
+                                                            &single[i]);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    p_timer.StopTimer(id);
+    single_time.push_back(p_timer.ReadTimer(id) / num_ticks_);
+
+    id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    err = hsa_amd_profiling_convert_ticks_to_system_domain(*gpu_device1(), num_ticks_,
+                                                           &ticks[0], &batch[0]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    p_timer.StopTimer(id);
+    batch_time.push_back(p_timer.ReadTimer(id) / num_ticks_);
+
+    // The conversion is affine, so the converted endpoints define the clock
+    // correlation the reference converts with.
+    const uint64_t t0_gpu = ticks[0], t0_sys = batch[0];
+    const uint64_t t1_gpu = ticks[num_ticks_ - 1], t1_sys = batch[num_ticks_ - 1];
+    ASSERT_LT(t0_sys, t1_sys);
+    for (size_t i = 0; i < num_ticks_; ++i) {
+      ASSERT_EQ(single[i], batch[i]) << "Tick " << ticks[i];
+      if (i != 0) {
+        ASSERT_LE(batch[i - 1], batch[i]);
+      }
+      uint64_t ref = ReferenceTranslate(t0_gpu, t0_sys, t1_gpu, t1_sys, ticks[i]);
+      uint64_t diff = (ref > batch[i]) ? ref - batch[i] : batch[i] - ref;
+      max_error_ = std::max(max_error_, diff);
+    }
+  }
+  ASSERT_LE(max_error_, kMaxTickError);
+
+  // In place conversion gives the same result.
+  std::vector<uint64_t> in_place(ticks);
+  err = hsa_amd_profiling_convert_ticks_to_system_domain(*gpu_device1(), num_ticks_,
+                                                         &in_place[0], &in_place[0]);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  for (size_t i = 0; i < num_ticks_; ++i) {
+    ASSERT_EQ(batch[i], in_place[i]);
+  }
+
+  err = hsa_amd_profiling_convert_ticks_to_system_domain(*gpu_device1(), 1, nullptr, &batch[0]);
+  ASSERT_EQ(HSA_STATUS_ERROR_INVALID_ARGUMENT, err);
+
+  single_time_mean_ = rocrtst::CalcMean(single_time);
+  batch_time_mean_ = rocrtst::CalcMean(batch_time);
+}
+
+void TickTranslation::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void TickTranslation::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "Ticks per iteration: " << num_ticks_ << std::endl;
+  std::cout << "Single tick conversion: " << single_time_mean_ * 1e9 <<
+      " nS/tick" << std::endl;
+  std::cout << "Bulk conversion: " << batch_time_mean_ * 1e9 << " nS/tick" << std::endl;
+  std::cout << "Max difference from reference: " << max_error_ << " ticks" << std::endl;
+}
+
+void TickTranslation::Close(void) {
+  TestBase::Close();
+}
@@ -0,0 +1,226 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "suites/performance/trace_overhead.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+#ifndef ROCRTST_TRACE_DECODER
+#define ROCRTST_TRACE_DECODER ""
+#endif
+
+// Target cost of one enabled trace event, in seconds.
+static const double kEventTarget = 50e-9;
+
+// Events buffered per thread, enough for one iteration of calls so none are
+// dropped while timing.
+static const char kTraceBufferSize[] = "262144";
+
+// Time for the trace flusher to drain the ring between iterations.
+static const useconds_t kDrainIntervalUs = 30000;
+
+// Each traced API call records a begin and an end event.
+static const size_t kEventsPerCall = 2;
+
+TraceOverhead::TraceOverhead(void) : TestBase(),
+    traced_calls_(0), off_time_mean_(0), on_time_mean_(0) {
+#if ROCRTST_EMULATOR_BUILD
+  num_calls_ = 1024;
+  set_num_iteration(2);
+#else
+  num_calls_ = 64 * 1024;
+  set_num_iteration(10);
+#endif
+
+  set_title("Runtime Trace Overhead");
+  set_description("This test measures the time of hsa_signal_load_relaxed "
+      "with runtime tracing off and on, and decodes the trace file the runtime "
+      "wrote with rocr_trace_decode.py.");
+}
+
+TraceOverhead::~TraceOverhead(void) {
+}
+
+void TraceOverhead::SetUp(void) {
+  trace_file_ = "/tmp/rocrtst_trace_" + std::to_string(getpid()) + ".bin";
+  if (access(ROCRTST_TRACE_DECODER, R_OK) == 0) decoder_ = ROCRTST_TRACE_DECODER;
+
+  // The untraced baseline runs first.
+  unsetenv("HSA_TRACE_FILE");
+  TestBase::SetUp();
+}
+
+void TraceOverhead::Restart(bool traced) {
+  hsa_status_t err;
+
+  err = hsa_shut_down();
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  if (traced) {
+    setenv("HSA_TRACE_FILE", trace_file_.c_str(), 1);
+    setenv("HSA_TRACE_BUFFER_SIZE", kTraceBufferSize, 1);
+  }
+  err = hsa_init();
+  unsetenv("HSA_TRACE_FILE");
+  unsetenv("HSA_TRACE_BUFFER_SIZE");
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+double TraceOverhead::TimeSignalLoad(void) {
+  hsa_status_t err;
+  hsa_signal_t signal;
+  std::vector<double> time;
+  rocrtst::PerfTimer p_timer;
+
+  err = hsa_signal_create(1, 0, NULL, &signal);
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+  if (err != HSA_STATUS_SUCCESS) return 0;
+
+  for (uint32_t it = 0; it < num_iteration(); ++it) {
+    hsa_signal_value_t sum = 0;
+    int id = p_timer.CreateTimer();
+    p_timer.StartTimer(id);
+    for (size_t i = 0; i < num_calls_; ++i) {
+      sum += hsa_signal_load_relaxed(signal);
+    }
+    p_timer.StopTimer(id);
+    EXPECT_EQ(hsa_signal_value_t(num_calls_), sum);
+    time.push_back(p_timer.ReadTimer(id) / num_calls_);
+
+    usleep(kDrainIntervalUs);
+  }
+
+  err = hsa_signal_destroy(signal);
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+
+  return rocrtst::CalcMean(time);
+}
+
+void TraceOverhead::CheckDecodedTrace(void) {
+  if (decoder_.empty()) {
+    std::cout << "Trace decoder not found, skipping the decode check." << std::endl;
+    return;
+  }
+
+  std::string cmd = "python3 \"" + decoder_ + "\" \"" + trace_file_ + "\" 2>&1";
+  FILE* out = popen(cmd.c_str(), "r");
+  ASSERT_NE(nullptr, out) << cmd;
+
+  size_t begins = 0, ends = 0, dropped = 0;
+  char line[512];
+  while (fgets(line, sizeof(line), out) != nullptr) {
+    unsigned long count;  // NOLINT(runtime/int)
+    if (strstr(line, " B hsa_signal_load_relaxed") != nullptr) {
+      ++begins;
+    } else if (strstr(line, " E hsa_signal_load_relaxed") != nullptr) {
+      ++ends;
+    } else if (sscanf(line, "thread %*u dropped %lu events", &count) == 1) {
+      dropped += count;
+    }
+  }
+  int status = pclose(out);
+  ASSERT_EQ(0, status) << cmd;
+
+  // Both traced sessions are in the file, the second appended to the first.
+  EXPECT_EQ(begins, ends);
+  EXPECT_LE(begins, traced_calls_);
+  EXPECT_GE(begins * kEventsPerCall + dropped, traced_calls_ * kEventsPerCall);
+}
+
+void TraceOverhead::Run(void) {
+  TestBase::Run();
+
+  off_time_mean_ = TimeSignalLoad();
+
+  // Two traced sessions to the same file.
+  ASSERT_NO_FATAL_FAILURE(Restart(true));
+  on_time_mean_ = TimeSignalLoad();
+  traced_calls_ += num_calls_ * num_iteration();
+
+  ASSERT_NO_FATAL_FAILURE(Restart(true));
+  TimeSignalLoad();
+  traced_calls_ += num_calls_ * num_iteration();
+
+  // Shutting down flushes the trace, the runtime stays up for Close.
+  ASSERT_NO_FATAL_FAILURE(Restart(false));
+
+  CheckDecodedTrace();
+  unlink(trace_file_.c_str());
+
+#if !ROCRTST_EMULATOR_BUILD
+  EXPECT_LT((on_time_mean_ - off_time_mean_) / kEventsPerCall, kEventTarget);
+#endif
+}
+
+void TraceOverhead::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void TraceOverhead::DisplayResults(void) const {
+  TestBase::DisplayResults();
+
+  std::cout << "Calls per iteration: " << num_calls_ << std::endl;
+  std::cout << "Tracing off: " << off_time_mean_ * 1e9 << " nS/call" << std::endl;
+  std::cout << "Tracing on: " << on_time_mean_ * 1e9 << " nS/call" << std::endl;
+  std::cout << "Cost per event: " <<
+      (on_time_mean_ - off_time_mean_) / kEventsPerCall * 1e9 << " nS (target " <<
+      kEventTarget * 1e9 << " nS)" << std::endl;
+}
+
+void TraceOverhead::Close(void) {
+  TestBase::Close();
+}
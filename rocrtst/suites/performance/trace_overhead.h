@@ -0,0 +1,109 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_TRACE_OVERHEAD_H_
+#define ROCRTST_SUITES_PERFORMANCE_TRACE_OVERHEAD_H_
+#include <string>
+
+#include "suites/test_common/test_base.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class measures the cost of runtime event tracing by timing
+//  hsa_signal_load_relaxed with HSA_TRACE_FILE unset and set, and checks that
+//  tools/rocr_trace_decode.py decodes the trace the runtime wrote.
+
+class TraceOverhead : public TestBase {
+ public:
+  // @Brief: Constructor
+  TraceOverhead(void);
+
+  // @Brief: Destructor
+  virtual ~TraceOverhead(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: Restarts the runtime, tracing to trace_file_ if @p traced
+  void Restart(bool traced);
+
+  // @Brief: Returns the mean time of one hsa_signal_load_relaxed, in seconds
+  double TimeSignalLoad(void);
+
+  // @Brief: Decodes trace_file_ and checks it holds the traced calls
+  void CheckDecodedTrace(void);
+
+  // @Brief: Number of API calls per iteration
+  size_t num_calls_;
+
+  // @Brief: API calls made with tracing on
+  size_t traced_calls_;
+
+  // @Brief: Mean time per call with tracing off, in seconds
+  double off_time_mean_;
+
+  // @Brief: Mean time per call with tracing on, in seconds
+  double on_time_mean_;
+
+  // @Brief: Trace file written by the runtime
+  std::string trace_file_;
+
+  // @Brief: Trace decoder, empty if not found
+  std::string decoder_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_TRACE_OVERHEAD_H_
@@ -0,0 +1,209 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2026, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "suites/performance/zeroed_alloc_latency.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/hsatimer.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+
+// Time between allocations, standing in for the work of a training step.
+static const useconds_t kStepIntervalUs = 20000;
+
+ZeroedAllocLatency::ZeroedAllocLatency(void) : TestBase() {
+  sizes_ = {64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 64 * 1024 * 1024};
+
+#if ROCRTST_EMULATOR_BUILD
+  set_num_iteration(1);
+#else
+  set_num_iteration(20);
+#endif
+
+  set_title("Zeroed Device Allocation Latency");
+  set_description("This test measures the time to get zero-filled device "
+      "memory by allocating and calling hsa_amd_memory_fill, and by "
+      "allocating with HSA_AMD_MEMORY_POOL_ZEROED_FLAG, which is served from "
+      "blocks zeroed in the background.");
+}
+
+ZeroedAllocLatency::~ZeroedAllocLatency(void) {
+}
+
+void ZeroedAllocLatency::SetUp(void) {
+  hsa_status_t err;
+  TestBase::SetUp();
+
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void ZeroedAllocLatency::VerifyZeroed(void* ptr, size_t size) {
+  hsa_status_t err;
+  void* host_buf = nullptr;
+
+  err = hsa_amd_memory_pool_allocate(cpu_pool(), size, 0, &host_buf);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_amd_agents_allow_access(1, gpu_device1(), nullptr, host_buf);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  memset(host_buf, 0xa5, size);
+
+  hsa_signal_t s;
+  err = hsa_signal_create(1, 0, nullptr, &s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_amd_memory_async_copy(host_buf, *cpu_device(), ptr, *gpu_device1(),
+                                  size, 0, nullptr, s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  while (hsa_signal_wait_scacquire(s, HSA_SIGNAL_CONDITION_LT, 1, UINT64_MAX,
+                                   HSA_WAIT_STATE_ACTIVE)) {
+  }
+
+  const uint32_t* words = reinterpret_cast<const uint32_t*>(host_buf);
+  for (size_t i = 0; i < size / sizeof(uint32_t); ++i) {
+    ASSERT_EQ(0u, words[i]) << "Non-zero word at offset " << i * 4;
+  }
+
+  err = hsa_signal_destroy(s);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_amd_memory_pool_free(host_buf);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void ZeroedAllocLatency::Run(void) {
+  hsa_status_t err;
+
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+  TestBase::Run();
+
+  for (size_t size : sizes_) {
+    void* ptr = nullptr;
+
+    // Leave a dirty block behind for the allocators to recycle.
+    err = hsa_amd_memory_pool_allocate(device_pool(), size, 0, &ptr);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    err = hsa_amd_memory_fill(ptr, 0xdeadbeef, size / sizeof(uint32_t));
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    err = hsa_amd_memory_pool_free(ptr);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    std::vector<double> fill_time;
+    std::vector<double> zeroed_time;
+    rocrtst::PerfTimer p_timer;
+
+    for (uint32_t i = 0; i < num_iteration(); ++i) {
+      int id = p_timer.CreateTimer();
+      p_timer.StartTimer(id);
+      err = hsa_amd_memory_pool_allocate(device_pool(), size, 0, &ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      err = hsa_amd_memory_fill(ptr, 0, size / sizeof(uint32_t));
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      p_timer.StopTimer(id);
+      fill_time.push_back(p_timer.ReadTimer(id));
+      err = hsa_amd_memory_pool_free(ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+      id = p_timer.CreateTimer();
+      p_timer.StartTimer(id);
+      err = hsa_amd_memory_pool_allocate(device_pool(), size,
+                                         HSA_AMD_MEMORY_POOL_ZEROED_FLAG, &ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      p_timer.StopTimer(id);
+      zeroed_time.push_back(p_timer.ReadTimer(id));
+
+      if (i == 0 || i == num_iteration() - 1) {
+        VerifyZeroed(ptr, size);
+      }
+
+      // Dirty the block so a recycled one would be caught.
+      err = hsa_amd_memory_fill(ptr, 0xdeadbeef, size / sizeof(uint32_t));
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      err = hsa_amd_memory_pool_free(ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+      usleep(kStepIntervalUs);
+    }
+
+    // The first two zeroed allocations of each size miss the pool, the
+    // second one schedules a block for the recurring size.
+    size_t warmup = std::min<size_t>(2, fill_time.size() - 1);
+    fill_time.erase(fill_time.begin(), fill_time.begin() + warmup);
+    zeroed_time.erase(zeroed_time.begin(), zeroed_time.begin() + warmup);
+    fill_time_mean_.push_back(rocrtst::CalcMean(fill_time));
+    zeroed_time_mean_.push_back(rocrtst::CalcMean(zeroed_time));
+  }
+}
+
+void ZeroedAllocLatency::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void ZeroedAllocLatency::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  for (size_t i = 0; i < fill_time_mean_.size(); ++i) {
+    std::cout << "Size " << (sizes_[i] >> 10) << " KB: allocate and fill " <<
+        fill_time_mean_[i] * 1e6 << " uS, zeroed allocate " <<
+        zeroed_time_mean_[i] * 1e6 << " uS" << std::endl;
+  }
+}
+
+void ZeroedAllocLatency::Close(void) {
+  TestBase::Close();
+}
@@ -57,10 +57,25 @@
 #include "suites/functional/memory_atomics.h"
 #include "suites/functional/memory_allocation.h"
 #include "suites/functional/deallocation_notifier.h"
+#include "suites/functional/deferred_load.h"
+#include "suites/functional/shared_code_segment.h"
+#include "suites/functional/svm_profile_replay.h"
+#include "suites/functional/runtime_stats.h"
+#include "suites/functional/dispatch_time_slots.h"
 #include "suites/functional/virtual_memory.h"
 #include "suites/performance/dispatch_time.h"
+#include "suites/performance/host_pool_bandwidth.h"
+#include "suites/performance/isa_bundle_select.h"
 #include "suites/performance/memory_async_copy.h"
 #include "suites/performance/memory_async_copy_numa.h"
+#include "suites/performance/zeroed_alloc_latency.h"
+#include "suites/performance/free_async_latency.h"
+#include "suites/performance/ordered_pool_latency.h"
+#include "suites/performance/tick_translation.h"
+#include "suites/performance/ipc_attach_latency.h"
+#include "suites/performance/svm_prefetch_batch.h"
+#include "suites/performance/svm_attrib_async.h"
+#include "suites/performance/trace_overhead.h"
 #include "suites/performance/enqueueLatency.h"
 #include "suites/negative/memory_allocate_negative_tests.h"
 #include "suites/negative/queue_validation.h"
@@ -374,6 +389,36 @@ TEST(rocrtstFunc, Deallocation_Notifier_Test) {
   RunGenericTest(&notifier);
 }
 
+TEST(rocrtstFunc, Svm_Profile_Replay_Test) {
+  SvmProfileReplayTest replay;
+  RunGenericTest(&replay);
+}
+
+TEST(rocrtstFunc, Runtime_Stats_Test) {
+  RuntimeStatsTest stats;
+  RunGenericTest(&stats);
+}
+
+TEST(rocrtstFunc, Dispatch_Time_Slots_Test) {
+  DispatchTimeSlotsTest slots;
+  RunGenericTest(&slots);
+}
+
+TEST(rocrtstFunc, Deferred_Load_Test) {
+  DeferredLoadTest deferred;
+  RunGenericTest(&deferred);
+}
+
+TEST(rocrtstFunc, Shared_Code_Segment_Test) {
+  SharedCodeSegmentTest shared(true);
+  RunGenericTest(&shared);
+}
+
+TEST(rocrtstFunc, Private_Code_Segment_Test) {
+  SharedCodeSegmentTest unshared(false);
+  RunGenericTest(&unshared);
+}
+
 TEST(rocrtstFunc, AgentProp_UUID) {
   AgentPropTest propTest;
   RunCustomTestProlog(&propTest);
@@ -538,6 +583,56 @@ TEST(rocrtstPerf, AQL_Dispatch_Time_Multi_Interrupt) {
   RunGenericTest(&dt);
 }
 
+TEST(rocrtstPerf, ISA_Bundle_Select) {
+  IsaBundleSelect ibs;
+  RunGenericTest(&ibs);
+}
+
+TEST(rocrtstPerf, Host_Pool_Bandwidth) {
+  HostPoolBandwidth hpb;
+  RunGenericTest(&hpb);
+}
+
+TEST(rocrtstPerf, Zeroed_Alloc_Latency) {
+  ZeroedAllocLatency zal;
+  RunGenericTest(&zal);
+}
+
+TEST(rocrtstPerf, Free_Async_Latency) {
+  FreeAsyncLatency fal;
+  RunGenericTest(&fal);
+}
+
+TEST(rocrtstPerf, Ordered_Pool_Latency) {
+  OrderedPoolLatency opl;
+  RunGenericTest(&opl);
+}
+
+TEST(rocrtstPerf, Tick_Translation) {
+  TickTranslation tt;
+  RunGenericTest(&tt);
+}
+
+TEST(rocrtstPerf, IPC_Attach_Latency) {
+  IPCAttachLatency ial;
+  RunGenericTest(&ial);
+}
+
+TEST(rocrtstPerf, SVM_Prefetch_Batch) {
+  SvmPrefetchBatch spb;
+  RunGenericTest(&spb);
+}
+
+TEST(rocrtstPerf, SVM_Attrib_Async) {
+  SvmAttribAsync saa;
+  RunGenericTest(&saa);
+}
+
+TEST(rocrtstPerf, Trace_Overhead) {
+  TraceOverhead to;
+  RunGenericTest(&to);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
 
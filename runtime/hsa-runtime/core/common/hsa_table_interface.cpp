@@ -1312,6 +1312,107 @@ hsa_status_t HSA_API hsa_amd_enable_logging(uint8_t* flags, void* file) {
   return amdExtTable->hsa_amd_enable_logging_fn(flags, file);
 }
 
+hsa_status_t HSA_API hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dependency_signal) {
+  return amdExtTable->hsa_amd_memory_pool_free_async_fn(ptr, dependency_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_ordered_pool_create(hsa_amd_memory_pool_t memory_pool,
+                                                 uint32_t num_agents, const hsa_agent_t* agents,
+                                                 hsa_amd_ordered_pool_t* pool) {
+  return amdExtTable->hsa_amd_ordered_pool_create_fn(memory_pool, num_agents, agents, pool);
+}
+
+hsa_status_t HSA_API hsa_amd_ordered_pool_destroy(hsa_amd_ordered_pool_t pool) {
+  return amdExtTable->hsa_amd_ordered_pool_destroy_fn(pool);
+}
+
+hsa_status_t HSA_API hsa_amd_ordered_pool_allocate(hsa_amd_ordered_pool_t pool, size_t size,
+                                                   void** ptr, hsa_signal_t* dependency) {
+  return amdExtTable->hsa_amd_ordered_pool_allocate_fn(pool, size, ptr, dependency);
+}
+
+hsa_status_t HSA_API hsa_amd_ordered_pool_free(hsa_amd_ordered_pool_t pool, void* ptr,
+                                               hsa_signal_t release_signal) {
+  return amdExtTable->hsa_amd_ordered_pool_free_fn(pool, ptr, release_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_ordered_pool_trim(hsa_amd_ordered_pool_t pool,
+                                               size_t min_bytes_to_keep) {
+  return amdExtTable->hsa_amd_ordered_pool_trim_fn(pool, min_bytes_to_keep);
+}
+
+hsa_status_t HSA_API hsa_amd_ordered_pool_set_release_threshold(hsa_amd_ordered_pool_t pool,
+                                                                size_t threshold) {
+  return amdExtTable->hsa_amd_ordered_pool_set_release_threshold_fn(pool, threshold);
+}
+
+hsa_status_t HSA_API hsa_amd_profiling_convert_ticks_to_system_domain(hsa_agent_t agent,
+                                                                      size_t num_ticks,
+                                                                      const uint64_t* agent_ticks,
+                                                                      uint64_t* system_ticks) {
+  return amdExtTable->hsa_amd_profiling_convert_ticks_to_system_domain_fn(agent, num_ticks,
+                                                                          agent_ticks,
+                                                                          system_ticks);
+}
+
+hsa_status_t HSA_API hsa_amd_ipc_memory_attach_batch(uint32_t num_handles,
+                                                     const hsa_amd_ipc_memory_t* handles,
+                                                     const size_t* lens, uint32_t num_agents,
+                                                     const hsa_agent_t* mapping_agents,
+                                                     void** mapped_ptrs) {
+  return amdExtTable->hsa_amd_ipc_memory_attach_batch_fn(num_handles, handles, lens, num_agents,
+                                                         mapping_agents, mapped_ptrs);
+}
+
+hsa_status_t HSA_API hsa_amd_ipc_memory_cache_purge() {
+  return amdExtTable->hsa_amd_ipc_memory_cache_purge_fn();
+}
+
+hsa_status_t HSA_API hsa_amd_ipc_memory_cache_stats(hsa_amd_ipc_memory_cache_stats_t* stats) {
+  return amdExtTable->hsa_amd_ipc_memory_cache_stats_fn(stats);
+}
+
+hsa_status_t HSA_API hsa_amd_svm_profile_iterate_ranges(
+    hsa_status_t (*callback)(const hsa_amd_svm_profile_range_t* range, void* data), void* data) {
+  return amdExtTable->hsa_amd_svm_profile_iterate_ranges_fn(callback, data);
+}
+
+hsa_status_t HSA_API hsa_amd_svm_attributes_set_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_svm_attributes_set_async_fn(ptr, size, attribute_list,
+                                                          attribute_count, num_dep_signals,
+                                                          dep_signals, completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_svm_attributes_get_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_svm_attributes_get_async_fn(ptr, size, attribute_list,
+                                                          attribute_count, num_dep_signals,
+                                                          dep_signals, completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_runtime_stats_get(
+    hsa_agent_t agent,
+    hsa_status_t (*callback)(const hsa_amd_runtime_stats_entry_t* entry, void* data), void* data) {
+  return amdExtTable->hsa_amd_runtime_stats_get_fn(agent, callback, data);
+}
+
+hsa_status_t HSA_API hsa_amd_profiling_dispatch_slots_enable(hsa_queue_t* queue,
+                                                             hsa_signal_t* slot_base) {
+  return amdExtTable->hsa_amd_profiling_dispatch_slots_enable_fn(queue, slot_base);
+}
+
+hsa_status_t HSA_API hsa_amd_profiling_get_dispatch_times(hsa_queue_t* queue,
+                                                          uint64_t first_packet_id,
+                                                          uint32_t count,
+                                                          hsa_amd_profiling_dispatch_time_t* times,
+                                                          uint32_t* completed) {
+  return amdExtTable->hsa_amd_profiling_get_dispatch_times_fn(queue, first_packet_id, count, times,
+                                                               completed);
+}
+
 // Tools only table interfaces.
 namespace rocr {
 
@@ -108,6 +108,22 @@ KfdDriver::AllocateMemory(const core::MemoryRegion &mem_region,
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  const core::MemoryRegion::AllocateFlags system_only_flags =
+      core::MemoryRegion::AllocateHugePage2MB | core::MemoryRegion::AllocateHugePage1GB |
+      core::MemoryRegion::AllocateNUMAInterleave;
+  if (!m_region.IsSystem() && (alloc_flags & system_only_flags)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  // The thunk falls back to smaller pages if huge pages are not available.
+  if (alloc_flags & core::MemoryRegion::AllocateHugePage1GB)
+    kmt_alloc_flags.ui32.PageSize = HSA_PAGE_SIZE_1GB;
+  else if (alloc_flags & core::MemoryRegion::AllocateHugePage2MB)
+    kmt_alloc_flags.ui32.PageSize = HSA_PAGE_SIZE_2MB;
+
+  kmt_alloc_flags.ui32.NUMAInterleave =
+      !!(alloc_flags & core::MemoryRegion::AllocateNUMAInterleave);
+
   // Allocating a memory handle for virtual memory
   kmt_alloc_flags.ui32.NoAddress =
       !!(alloc_flags & core::MemoryRegion::AllocateMemoryOnly);
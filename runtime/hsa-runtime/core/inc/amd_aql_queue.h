@@ -47,6 +47,7 @@
 #include "core/inc/signal.h"
 #include "core/inc/queue.h"
 #include "core/inc/amd_gpu_agent.h"
+#include "core/inc/submit_stats.h"
 #include "core/util/locks.h"
 
 namespace rocr {
@@ -227,6 +228,23 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   /// @brief Async reclaim alternate scratch memory
   void AsyncReclaimAltScratch();
 
+  /// @brief Doorbell counters of this queue.  Submissions are given by the
+  /// write index instead.
+  const core::SubmitStats& stats() const { return stats_; }
+
+  /// @brief Allocates the dispatch time slots on first use and enables
+  /// profiling.
+  ///
+  /// @return Completion signal handle of the slot of packet 0.
+  hsa_signal_t EnableDispatchTimeSlots();
+
+  /// @brief Reads, translates and clears the dispatch time slots of @p count
+  /// packets starting at @p first_packet_id.  Incomplete packets report 0.
+  ///
+  /// @param completed Number of completed packets read.
+  hsa_status_t ReadDispatchTimes(uint64_t first_packet_id, uint32_t count,
+                                 hsa_amd_profiling_dispatch_time_t* times, uint32_t* completed);
+
  protected:
   bool _IsA(Queue::rtti_t id) const override { return id == &rtti_id(); }
 
@@ -291,6 +309,8 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   // Cached value of HsaNodeProperties.HSA_CAPABILITY.DoorbellType
   int doorbell_type_;
 
+  core::SubmitStats stats_;
+
   // Handle of agent, which queue is attached to
   GpuAgent* agent_;
 
@@ -311,6 +331,11 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   uint32_t pm4_ib_size_b_;
   KernelMutex pm4_ib_mutex_;
 
+  // Signal ABI blocks indexed by packet ID.  The CP writes the time stamps of
+  // packets completing on them.  Allocated on first use.
+  amd_signal_t* dispatch_time_slots_;
+  KernelMutex dispatch_time_slots_lock_;
+
   // Error handler control variable.
   std::atomic<uint32_t> dynamicScratchState, exceptionState;
   enum { ERROR_HANDLER_DONE = 1, ERROR_HANDLER_TERMINATE = 2, ERROR_HANDLER_SCRATCH_RETRY = 4 };
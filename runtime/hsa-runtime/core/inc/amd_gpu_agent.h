@@ -48,6 +48,7 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <tuple>
 
 #include "hsakmt/hsakmt.h"
 
@@ -147,6 +148,15 @@ class GpuAgentInt : public core::Agent {
    // @param [out] time Timestamp in agent domain.
    virtual uint64_t TranslateTime(uint64_t tick) = 0;
 
+   // @brief Translate timestamps from agent domain to host domain in place.
+   //
+   // @param [in/out] ticks First timestamp in agent domain, replaced with its
+   // host domain value along with the following count - 1 timestamps.
+   // @param [in] count Number of timestamps.
+   // @param [in] stride Distance in bytes between consecutive timestamps.
+   virtual void TranslateTimes(uint64_t* ticks, size_t count,
+                               size_t stride = sizeof(uint64_t)) = 0;
+
    // @brief Invalidate caches on the agent which may hold code object data.
    virtual void InvalidateCodeCaches() = 0;
 
@@ -221,6 +231,18 @@ class GpuAgentInt : public core::Agent {
 
    virtual hsa_status_t
    PcSamplingFlush(pcs::PcsRuntime::PcSamplingSession &session) = 0;
+
+   // @brief Return the samples of a zero-copy session that are in the host
+   // buffer, without copying them.
+   virtual hsa_status_t
+   PcSamplingDataAcquire(pcs::PcsRuntime::PcSamplingSession &session,
+                         hsa_ven_amd_pcs_data_view_t *view) = 0;
+
+   // @brief Return the oldest @p size bytes of samples of a zero-copy session
+   // to the host buffer.
+   virtual hsa_status_t
+   PcSamplingDataRelease(pcs::PcsRuntime::PcSamplingSession &session,
+                         size_t size) = 0;
 };
 
 class GpuAgent : public GpuAgentInt {
@@ -282,6 +304,14 @@ class GpuAgent : public GpuAgentInt {
   // @brief Override from core::Agent.
   hsa_status_t DmaCopy(void* dst, const void* src, size_t size) override;
 
+  // @brief Submit a set of linear copies back to back on the device to device
+  // blit and wait once for all of them to finish.
+  //
+  // @param [in] copies (dst, src, size) of each copy.
+  //
+  // @retval HSA_STATUS_SUCCESS All copies are finished and successful.
+  hsa_status_t DmaCopyBatch(const std::vector<std::tuple<void*, const void*, size_t>>& copies);
+
   // @brief Override from core::Agent.
   hsa_status_t DmaCopy(void* dst, core::Agent& dst_agent, const void* src,
                        core::Agent& src_agent, size_t size,
@@ -337,6 +367,9 @@ class GpuAgent : public GpuAgentInt {
   // @brief Override from AMD::GpuAgentInt.
   uint64_t TranslateTime(uint64_t tick) override;
 
+  // @brief Override from AMD::GpuAgentInt.
+  void TranslateTimes(uint64_t* ticks, size_t count, size_t stride = sizeof(uint64_t)) override;
+
   // @brief Override from AMD::GpuAgentInt.
   void InvalidateCodeCaches() override;
 
@@ -414,6 +447,7 @@ class GpuAgent : public GpuAgentInt {
     // If we did not update t1 since agent initialization, force a SyncClock. Otherwise computing
     // the SystemClockCounter to GPUClockCounter ratio in TranslateTime(tick) results to a division
     // by 0.
+    ScopedAcquire<KernelMutex> lock(&t1_lock_);
     if (t0_.GPUClockCounter == t1_.GPUClockCounter) SyncClocks();
   }
 
@@ -428,6 +462,14 @@ class GpuAgent : public GpuAgentInt {
   // @brief If agent supports it, release scratch memory for all AQL queues on this agent.
   void AsyncReclaimScratchQueues();
 
+  // @brief Forgets a destroyed AQL queue, keeping its counters in the agent totals.
+  void RemoveAqlQueue(core::Queue* queue);
+
+  // @brief Reports the counters of the agent, then of each of its AQL queues and blit engines.
+  hsa_status_t IterateRuntimeStats(
+      hsa_status_t (*callback)(const hsa_amd_runtime_stats_entry_t* entry, void* data),
+      void* data);
+
   // @brief Returns true if scratch reclaim is enabled
   __forceinline bool AsyncScratchReclaimEnabled() const override {
     // TODO: Need to update min CP FW ucode version once it is released
@@ -496,9 +538,27 @@ class GpuAgent : public GpuAgentInt {
       hsa_status_t (*callback)(hsa_region_t region, void* data),
       void* data) const;
 
-  // @brief Update ::t1_ tick count.
+  // @brief Update ::t1_ tick count and publish a new clock snapshot.
   void SyncClocks();
 
+  // @brief Clock correlation used to translate ticks without locking.
+  struct ClockSnapshot {
+    uint64_t t0_gpu;
+    uint64_t t0_sys;
+    uint64_t t1_gpu;
+    uint64_t t1_sys;
+    // System ticks per GPU tick, fixed point.
+    int64_t ratio;
+    // Ratio for ticks predating t0_, 0 until such a tick is seen.
+    int64_t historical_ratio;
+  };
+
+  // @brief Publish ::t0_, ::t1_ and the clock ratios.  Requires ::t1_lock_.
+  void PublishClockSnapshot();
+
+  // @brief True if ticks up to max_tick can't be translated with snapshot.
+  bool ClockSyncNeeded(const ClockSnapshot& snapshot, uint64_t max_tick) const;
+
   // @brief Binds the second-level trap handler to this node.
   void BindTrapHandler();
   hsa_status_t UpdateTrapHandlerWithPCS(void* pcs_hosttrap_buffers, void* stochastic_hosttrap_buffers);
@@ -515,8 +575,22 @@ class GpuAgent : public GpuAgentInt {
   hsa_status_t PcSamplingStart(pcs::PcsRuntime::PcSamplingSession& session);
   hsa_status_t PcSamplingStop(pcs::PcsRuntime::PcSamplingSession& session);
   hsa_status_t PcSamplingFlush(pcs::PcsRuntime::PcSamplingSession& session);
+  hsa_status_t PcSamplingDataAcquire(pcs::PcsRuntime::PcSamplingSession& session,
+                                     hsa_ven_amd_pcs_data_view_t* view);
+  hsa_status_t PcSamplingDataRelease(pcs::PcsRuntime::PcSamplingSession& session, size_t size);
   hsa_status_t PcSamplingFlushHostTrapDeviceBuffers(pcs::PcsRuntime::PcSamplingSession& session);
 
+  // @brief Host buffer consumer side. Returns the published samples as up to
+  // two ranges, oldest first.
+  void PcSamplingPeekHostBuffer(uint8_t** buf1, size_t* buf1_sz, uint8_t** buf2,
+                                size_t* buf2_sz);
+  // @brief Host buffer consumer side. Hands the oldest @p size bytes back to
+  // the producer.
+  void PcSamplingConsumeHostBuffer(size_t size);
+  // @brief Passes host buffer samples to the session's data ready callback.
+  // Unless @p flush is set, only delivers once enough samples are buffered.
+  void PcSamplingDeliver(pcs::PcsRuntime::PcSamplingSession& session, bool flush);
+
   static void PcSamplingThreadRun(void* agent);
   void PcSamplingThread();
 
@@ -556,6 +630,16 @@ class GpuAgent : public GpuAgentInt {
   // Protects xgmi_peer_list_
   KernelMutex xgmi_peer_list_lock_;
 
+  // @brief list of AQL queues owned by this agent. Indexed by queue pointer
+  // Declared ahead of the queues below since destroying a queue removes it.
+  std::vector<core::Queue*> aql_queues_;
+
+  // @brief Counters of destroyed AQL queues, indexed by core::SubmitStat.
+  uint64_t retired_queue_stats_[core::kStatCount];
+
+  // @brief Protects aql_queues_ and retired_queue_stats_.
+  KernelMutex aql_queues_lock_;
+
   // @brief AQL queues for cache management and blit compute usage.
   enum QueueEnum {
     QueueUtility,     // Cache management and device to {host,device} blit compute
@@ -572,7 +656,7 @@ class GpuAgent : public GpuAgentInt {
   // @brief Mutex to protect access to scratch pool.
   KernelMutex scratch_lock_;
 
-  // @brief Mutex to protect access to ::t1_.
+  // @brief Mutex to protect access to ::t1_ and updates of ::clock_snapshot_.
   KernelMutex t1_lock_;
 
   // @brief Mutex to protect access to blit objects.
@@ -586,7 +670,10 @@ class GpuAgent : public GpuAgentInt {
 
   HsaClockCounters t1_;
 
-  double historical_clock_ratio_;
+  int64_t historical_clock_ratio_;
+
+  // @brief Clock correlation for lock free readers.
+  SeqLock<ClockSnapshot> clock_snapshot_;
 
   // @brief s_memrealtime nominal clock frequency
   uint64_t wallclock_frequency_;
@@ -697,8 +784,6 @@ class GpuAgent : public GpuAgentInt {
     KernelMutex lock_;
   } gws_queue_;
 
-  // @brief list of AQL queues owned by this agent. Indexed by queue pointer
-  std::vector<core::Queue*> aql_queues_;
 
   // Sets and Tracks pending SDMA status check or request counts
   void SetCopyRequestRefCount(bool set);
@@ -748,14 +833,24 @@ class GpuAgent : public GpuAgentInt {
     /* Hosttrap data - stored on device so that trap_handler code can access efficiently */
     pcs_hosttrap_sampling_data_t* device_data;
 
-    /* Hosttrap host buffer - stored on host */
+    /* Hosttrap host buffer - stored on host.
+     * Single producer/single consumer ring: the producer (device buffer flush) only moves
+     * host_write_ptr and host_buffer_wrap_pos, the consumer (the client for zero-copy sessions,
+     * otherwise the data ready callback delivery) only moves host_read_ptr. */
     uint8_t* host_buffer;
     size_t host_buffer_size;
-    uint8_t* host_buffer_wrap_pos;
-    uint8_t* host_write_ptr;
-    uint8_t* host_read_ptr;
-    size_t lost_sample_count;
-    std::mutex host_buffer_mutex;
+    std::atomic<uint8_t*> host_buffer_wrap_pos;
+    std::atomic<uint8_t*> host_write_ptr;
+    std::atomic<uint8_t*> host_read_ptr;
+    std::atomic<size_t> lost_sample_count;
+    // Serializes producers: the sampling thread and PcSamplingFlush
+    std::mutex flush_mutex;
+    // Serializes data ready callback delivery
+    std::mutex deliver_mutex;
+
+    // Sample arrival rate estimate, used to deliver ahead of the client's latency
+    uint64_t bytes_received;
+    double bytes_per_second;
 
     uint32_t which_buffer;
     uint64_t* old_val;
@@ -343,8 +343,8 @@ namespace code {
                                 uint64_t size);
       void AddSectionSymbols();
 
-      size_t RelocationSectionCount() { return relocationSections.size(); }
-      RelocationSection* GetRelocationSection(size_t i) { return relocationSections[i]; }
+      size_t RelocationSectionCount() const { return relocationSections.size(); }
+      RelocationSection* GetRelocationSection(size_t i) const { return relocationSections[i]; }
 
       size_t SymbolCount() { return symbols.size(); }
       Symbol* GetSymbol(size_t i) { return symbols[i]; }
@@ -157,6 +157,25 @@ struct CodeObjectReaderImpl final {
 // Context.                                                                   //
 //===----------------------------------------------------------------------===//
 
+/// @brief Segment handed to Context::SegmentsFreeze.
+struct SegmentFreezeInfo {
+  amdgpu_hsa_elf_segment_t segment;
+  hsa_agent_t agent;
+  void* seg;
+  size_t size;
+};
+
+/// @brief Identifies the content of a read-only agent code segment, see
+/// Context::SegmentAcquireShared.
+struct SegmentContentKey {
+  /// Hash of the code object the segment is loaded from.
+  uint64_t hash[2];
+  uint64_t image_size;
+  /// The segment contains no relocated values, so its content is the same at
+  /// any load address and it can be shared with other processes.
+  bool position_independent;
+};
+
 class Context {
 public:
   virtual ~Context() {}
@@ -181,6 +200,29 @@ public:
 
   virtual bool SegmentFreeze(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) = 0;
 
+  /// @brief Freezes all of @p segs. Contexts which upload segments to device
+  /// memory may override this to batch the uploads of an executable; by
+  /// default each segment is frozen on its own.
+  virtual bool SegmentsFreeze(const std::vector<SegmentFreezeInfo>& segs) {
+    for (const SegmentFreezeInfo& info : segs) {
+      if (!SegmentFreeze(info.segment, info.agent, info.seg, info.size)) return false;
+    }
+    return true;
+  }
+
+  /// @brief Returns true if read-only code segments loaded for @p agent may be
+  /// shared, see SegmentAcquireShared and SegmentShare.
+  virtual bool SegmentSharingSupported(hsa_agent_t agent) { return false; }
+
+  /// @brief Returns a frozen segment previously offered with SegmentShare for
+  /// the same @p key and @p agent, taking a reference which is dropped by
+  /// SegmentFree. Returns nullptr if there is none.
+  virtual void* SegmentAcquireShared(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, size_t size, const SegmentContentKey& key) { return nullptr; }
+
+  /// @brief Offers frozen segment @p seg, whose content is identified by
+  /// @p key, to later loads of the same code object.
+  virtual void SegmentShare(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size, const SegmentContentKey& key) {}
+
   virtual bool ImageExtensionSupported() = 0;
 
   virtual hsa_status_t ImageCreate(
@@ -233,6 +275,14 @@ public:
 
   virtual hsa_agent_t GetAgent() = 0;
 
+  /// @brief Stores the dispatch properties of a kernel symbol in
+  /// @p dispatch_info. Fails for other kinds and before the executable is
+  /// frozen.
+  virtual hsa_status_t GetDispatchInfo(
+      const hsa_ven_amd_loader_kernel_dispatch_info_t **dispatch_info) {
+    return HSA_STATUS_ERROR_INVALID_EXECUTABLE_SYMBOL;
+  }
+
 protected:
   Symbol() {}
 
@@ -269,6 +319,10 @@ public:
       void *data),
     void *data) = 0;
 
+  /// @brief Loads the segments of a code object whose load was deferred.
+  /// @returns true if the code object has its segments.
+  virtual bool EnsureLoaded() = 0;
+
   virtual hsa_agent_t getAgent() const = 0;
   virtual hsa_executable_t getExecutable() const = 0;
   virtual uint64_t getElfData() const = 0;
@@ -366,6 +420,10 @@ public:
 
   virtual hsa_status_t Freeze(const char *options) = 0;
 
+  /// @brief Loads code objects whose load was deferred by the lazy-load
+  /// option, for @p agent only or for all agents if @p agent is nullptr.
+  virtual hsa_status_t LoadDeferredCodeObjects(const hsa_agent_t *agent) = 0;
+
   virtual hsa_status_t Validate(uint32_t *result) = 0;
 
   /// @note needed for hsa v1.0.
@@ -43,14 +43,20 @@
 #ifndef HSA_RUNTIME_CORE_INC_AMD_LOADER_CONTEXT_HPP
 #define HSA_RUNTIME_CORE_INC_AMD_LOADER_CONTEXT_HPP
 
+#include <map>
+#include <string>
+#include <tuple>
+
 #include "core/inc/amd_hsa_loader.hpp"
+#include "core/util/locks.h"
 
 namespace rocr {
 namespace amd {
 
 class LoaderContext final : public rocr::amd::hsa::loader::Context {
  public:
-  LoaderContext() : rocr::amd::hsa::loader::Context() {}
+  LoaderContext()
+      : rocr::amd::hsa::loader::Context(), staging_arena_(nullptr), staging_arena_size_(0) {}
 
   ~LoaderContext() {}
 
@@ -70,6 +76,27 @@ class LoaderContext final : public rocr::amd::hsa::loader::Context {
 
   bool SegmentFreeze(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) override;
 
+  /// @brief Uploads all device resident segments of @p segs through one
+  /// staging buffer, with one batched copy and cache invalidate per agent.
+  bool SegmentsFreeze(const std::vector<rocr::amd::hsa::loader::SegmentFreezeInfo>& segs) override;
+
+  /// @brief Frees the pooled staging buffer. Must be called before the
+  /// system memory regions are destroyed.
+  void ReleaseStagingArena();
+
+  bool SegmentSharingSupported(hsa_agent_t agent) override;
+
+  /// @brief Looks up @p key among the segments shared in this process, then,
+  /// if enabled, among those published by other processes on the node.
+  void* SegmentAcquireShared(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, size_t size,
+                             const rocr::amd::hsa::loader::SegmentContentKey& key) override;
+
+  void SegmentShare(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size,
+                    const rocr::amd::hsa::loader::SegmentContentKey& key) override;
+
+  /// @brief Withdraws the segments this process published to other processes.
+  void ReleaseSharedSegments();
+
   bool ImageExtensionSupported() override;
 
   hsa_status_t ImageCreate(hsa_agent_t agent, hsa_access_permission_t image_permission,
@@ -87,6 +114,35 @@ class LoaderContext final : public rocr::amd::hsa::loader::Context {
 private:
   LoaderContext(const LoaderContext&);
   LoaderContext& operator=(const LoaderContext&);
+
+  // Returns a staging buffer of at least @p size bytes, the pooled arena when
+  // it is large enough to be retained. Requires staging_lock_.
+  void* AcquireStaging(size_t size);
+  void ReleaseStaging(void* staging);
+
+  KernelMutex staging_lock_;
+  void* staging_arena_;
+  size_t staging_arena_size_;
+
+  // Agent, content hashes, code object size and segment size.
+  typedef std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, size_t> SharedSegmentId;
+  struct SharedSegment {
+    SharedSegmentId id;
+    uint32_t refcount;
+    // Node wide registry entry published by this process, empty if none.
+    std::string registry;
+  };
+
+  static SharedSegmentId MakeSharedSegmentId(hsa_agent_t agent, size_t size,
+                                             const rocr::amd::hsa::loader::SegmentContentKey& key);
+  void* ImportSharedSegment(hsa_agent_t agent, size_t size,
+                            const rocr::amd::hsa::loader::SegmentContentKey& key);
+  std::string PublishSharedSegment(hsa_agent_t agent, void* seg, size_t size,
+                                   const rocr::amd::hsa::loader::SegmentContentKey& key);
+
+  KernelMutex shared_segments_lock_;
+  std::map<void*, SharedSegment> shared_segments_;
+  std::map<SharedSegmentId, void*> shared_segment_ids_;
 };
 
 } // namespace amd
@@ -50,6 +50,7 @@
 #include "core/inc/agent.h"
 #include "core/inc/runtime.h"
 #include "core/inc/memory_region.h"
+#include "core/inc/amd_zeroed_block_pool.h"
 #include "core/util/simple_heap.h"
 #include "core/util/locks.h"
 
@@ -57,6 +58,8 @@
 
 namespace rocr {
 namespace AMD {
+class OrderedPool;
+
 class MemoryRegion : public core::MemoryRegion {
  public:
   /// @brief Convert this object into hsa_region_t.
@@ -97,6 +100,9 @@ class MemoryRegion : public core::MemoryRegion {
 
   hsa_status_t Free(void* address, size_t size) const;
 
+  void FreeBatch(const std::vector<std::pair<void*, size_t>>& blocks,
+                 std::vector<hsa_status_t>& status) const;
+
   hsa_status_t IPCFragmentExport(void* address) const;
 
   hsa_status_t GetInfo(hsa_region_info_t attribute, void* value) const;
@@ -131,6 +137,15 @@ class MemoryRegion : public core::MemoryRegion {
 
   void Trim() const;
 
+  // Ordered pools sub-allocating from this region.  Their unused blocks are
+  // released by Trim.
+  void AddOrderedPool(OrderedPool* pool) const;
+  void RemoveOrderedPool(OrderedPool* pool) const;
+
+  // Stops refilling pre-zeroed blocks and frees the cached ones. Must run
+  // before the owner's blits are destroyed.
+  void ReleaseZeroedPool() const;
+
   HSAuint64 GetCacheSize() const { return fragment_allocator_.cache_size(); }
 
   __forceinline bool IsLocalMemory() const {
@@ -210,6 +225,9 @@ private:
   // Operational body for Free.  Recursive.
   hsa_status_t FreeImpl(void* address, size_t size) const;
 
+  hsa_status_t AllocateZeroFilled(size_t& size, AllocateFlags alloc_flags, void** address,
+                                  int agent_node_id) const;
+
   class BlockAllocator {
    private:
     MemoryRegion& region_;
@@ -222,6 +240,13 @@ private:
   };
 
   mutable SimpleHeap<BlockAllocator> fragment_allocator_;
+
+  // Pre-zeroed blocks for AllocateZeroed, local memory only.
+  mutable std::unique_ptr<ZeroedBlockPool> zeroed_pool_;
+
+  // Protects ordered_pools_.  Taken inside the agent's allocation lock.
+  mutable KernelMutex ordered_pools_lock_;
+  mutable std::vector<OrderedPool*> ordered_pools_;
 };
 
 }  // namespace amd
@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_ORDERED_POOL_H_
+#define HSA_RUNTIME_CORE_INC_AMD_ORDERED_POOL_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "core/inc/checked.h"
+#include "core/inc/hsa_internal.h"
+#include "inc/hsa_ext_amd.h"
+#include "core/util/locks.h"
+#include "core/util/simple_heap.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace core {
+class Signal;
+}
+
+namespace AMD {
+class MemoryRegion;
+
+/// @brief Sub-allocating memory pool with signal ordered reuse.
+///
+/// Allocations are carved out of large blocks of the backing region by a
+/// SimpleHeap, so allocations of any size recycle memory instead of going to
+/// KFD. Frees are tagged with a release signal. Freed memory returns to the
+/// heap once its signal reaches 0, but an allocation that accepts a
+/// dependency may take it before then and order its first use after the
+/// signal instead.
+///
+/// Blocks are not entered in the runtime's allocation map, so pointer info
+/// and allow access queries don't know pool memory; agents get access when
+/// the pool is created.  The region releases idle blocks of its pools when
+/// an allocation runs out of memory.
+class OrderedPool : public core::Checked<0x3E6A4B9D1C07F582> {
+ public:
+  /// @brief Smallest block requested from the region.
+  static const size_t kMinBlockSize = 16 * 1024 * 1024;
+
+  /// @brief Alignment of every allocation.
+  static const size_t kAlignment = 256;
+
+  /// @param access Agents given access to every block of the pool.
+  OrderedPool(const MemoryRegion& region, const std::vector<hsa_agent_t>& access);
+
+  ~OrderedPool();
+
+  static __forceinline hsa_amd_ordered_pool_t Convert(OrderedPool* pool) {
+    const hsa_amd_ordered_pool_t handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pool))};
+    return handle;
+  }
+
+  static __forceinline OrderedPool* Convert(hsa_amd_ordered_pool_t pool) {
+    return reinterpret_cast<OrderedPool*>(pool.handle);
+  }
+
+  /// @brief Allocate size bytes.  If dependency is not null the memory may
+  /// still be pending release, in which case *dependency receives the signal
+  /// its first use must be ordered after, otherwise a null handle.
+  hsa_status_t Allocate(size_t size, void** ptr, hsa_signal_t* dependency);
+
+  /// @brief Free ptr once release reaches 0.  A null release frees now.
+  hsa_status_t Free(void* ptr, hsa_signal_t release);
+
+  /// @brief Release unused blocks until at most keep bytes stay cached.
+  void Trim(size_t keep);
+
+  /// @brief Unused memory the pool keeps cached regardless of usage.
+  void SetReleaseThreshold(size_t bytes);
+
+  /// @brief Wait for all pending frees.  Fails if allocations are live.
+  hsa_status_t Drain();
+
+  /// @brief Move all unused blocks to blocks for the caller to free,
+  /// regardless of the release threshold.  Runs under the region's
+  /// allocation lock, which Allocate may be waiting for, so a busy pool is
+  /// skipped.
+  void TakeIdleBlocks(std::vector<std::pair<void*, size_t>>* blocks);
+
+ private:
+  class BlockAllocator {
+   public:
+    explicit BlockAllocator(OrderedPool& pool) : pool_(pool) {}
+    void* alloc(size_t request_size, size_t& allocated_size) const;
+    void free(void* ptr, size_t length) const;
+    // Every block is recycled, so no request counts as oversized.
+    size_t block_size() const { return SIZE_MAX; }
+
+   private:
+    OrderedPool& pool_;
+  };
+
+  struct PendingFree {
+    void* ptr;
+    core::Signal* release;
+  };
+
+  /// @brief Return frees whose release signal completed to the heap.
+  void Retire();
+
+  const MemoryRegion& region_;
+
+  const std::vector<hsa_agent_t> access_;
+
+  KernelMutex lock_;
+
+  SimpleHeap<BlockAllocator> heap_;
+
+  /// @brief Live allocations and their sizes.
+  std::map<void*, size_t> live_;
+
+  /// @brief Frees waiting on their release signal, by size.
+  std::multimap<size_t, PendingFree> pending_;
+
+  /// @brief If set, blocks released by heap_ are moved here instead of freed.
+  std::vector<std::pair<void*, size_t>>* taken_;
+
+  DISALLOW_COPY_AND_ASSIGN(OrderedPool);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_AMD_ORDERED_POOL_H_
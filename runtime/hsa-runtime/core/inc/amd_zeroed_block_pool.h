@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_ZEROED_BLOCK_POOL_H_
+#define HSA_RUNTIME_CORE_INC_AMD_ZEROED_BLOCK_POOL_H_
+
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "core/util/locks.h"
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace AMD {
+class MemoryRegion;
+
+/// @brief Cache of pre-zeroed device memory blocks for one memory region.
+///
+/// Zeroed allocations take a cached block of the requested size if one is
+/// ready, and a worker thread allocates and SDMA fills a replacement. A miss
+/// only schedules a block if the size missed recently too, so repeated
+/// allocate-then-zero patterns are served without zeroing on the allocation
+/// path while one-off sizes do not take up the budget.
+class ZeroedBlockPool {
+ public:
+  /// @brief Blocks kept ready per allocation size.
+  static const uint32_t kMaxBlocksPerSize = 4;
+
+  /// @brief Missed sizes remembered to detect recurring sizes.
+  static const size_t kMissHistory = 16;
+
+  /// @param max_bytes Budget for cached blocks. Requests larger than a
+  /// quarter of it are never cached.
+  ZeroedBlockPool(const MemoryRegion& region, size_t max_bytes);
+
+  ~ZeroedBlockPool();
+
+  /// @brief Take a zeroed block of exactly size bytes, nullptr if none is
+  /// ready. Schedules a refill for size on a hit or a repeated miss.
+  void* Acquire(size_t size);
+
+  /// @brief Remove all cached blocks, returning them to the caller to free.
+  void TakeAll(std::vector<std::pair<void*, size_t>>* blocks);
+
+  /// @brief Stop the worker thread. Blocks are no longer refilled.
+  void Stop();
+
+  size_t cached_bytes() const;
+
+ private:
+  static void WorkerRun(void* pool);
+
+  /// @brief Allocate and zero blocks until demand or the budget is met.
+  void Refill();
+
+  const MemoryRegion& region_;
+
+  const size_t max_bytes_;
+
+  mutable KernelMutex lock_;
+
+  /// @brief Zeroed blocks by size.
+  std::multimap<size_t, void*> blocks_;
+
+  /// @brief Blocks still to be zeroed, by size.
+  std::map<size_t, uint32_t> wanted_;
+
+  /// @brief Sizes of the latest misses which were not refilled, oldest first.
+  std::deque<size_t> recent_misses_;
+
+  /// @brief Bytes of blocks in blocks_ and being zeroed.
+  size_t cached_bytes_;
+
+  KernelEvent wake_;
+
+  os::Thread worker_;
+
+  bool exit_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZeroedBlockPool);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_AMD_ZEROED_BLOCK_POOL_H_
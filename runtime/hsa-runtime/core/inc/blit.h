@@ -46,6 +46,8 @@
 #include <stdint.h>
 
 #include "core/inc/agent.h"
+#include "core/inc/submit_stats.h"
+#include "core/util/timer.h"
 
 namespace rocr {
 namespace core {
@@ -119,6 +121,22 @@ class Blit {
 
   virtual void GangLeader(bool gang_leader) = 0;
   virtual bool GangLeader() const { return false; };
+
+  /// @brief Submission counters of this engine.
+  const SubmitStats& stats() const { return stats_; }
+
+ protected:
+  /// @brief Accounts a submission of @p bytes with @p barriers dependency
+  /// barriers, entered at fast_clock tick @p start and now submitted.
+  void RecordSubmit(uint64_t bytes, uint64_t barriers, uint64_t start) {
+    const size_t stripe = SubmitStats::CurrentStripe();
+    stats_.Add(stripe, kStatSubmissions, 1);
+    stats_.Add(stripe, kStatBytes, bytes);
+    if (barriers != 0) stats_.Add(stripe, kStatDependencyBarriers, barriers);
+    stats_.Add(stripe, kStatSubmitTicks, timer::fast_clock::raw_now() - start);
+  }
+
+  SubmitStats stats_;
 };
 }  // namespace core
 }  // namespace rocr
@@ -137,6 +137,77 @@ hsa_status_t
 // Mirrors Amd Extension Apis
 hsa_status_t hsa_amd_memory_pool_free(void* ptr);
 
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dependency_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ordered_pool_create(hsa_amd_memory_pool_t memory_pool, uint32_t num_agents,
+                                         const hsa_agent_t* agents, hsa_amd_ordered_pool_t* pool);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ordered_pool_destroy(hsa_amd_ordered_pool_t pool);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ordered_pool_allocate(hsa_amd_ordered_pool_t pool, size_t size, void** ptr,
+                                           hsa_signal_t* dependency);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ordered_pool_free(hsa_amd_ordered_pool_t pool, void* ptr,
+                                       hsa_signal_t release_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ordered_pool_trim(hsa_amd_ordered_pool_t pool, size_t min_bytes_to_keep);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ordered_pool_set_release_threshold(hsa_amd_ordered_pool_t pool,
+                                                        size_t threshold);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_profiling_convert_ticks_to_system_domain(hsa_agent_t agent, size_t num_ticks,
+                                                              const uint64_t* agent_ticks,
+                                                              uint64_t* system_ticks);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ipc_memory_attach_batch(uint32_t num_handles,
+                                             const hsa_amd_ipc_memory_t* handles,
+                                             const size_t* lens, uint32_t num_agents,
+                                             const hsa_agent_t* mapping_agents,
+                                             void** mapped_ptrs);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ipc_memory_cache_purge();
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_ipc_memory_cache_stats(hsa_amd_ipc_memory_cache_stats_t* stats);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_svm_profile_iterate_ranges(
+    hsa_status_t (*callback)(const hsa_amd_svm_profile_range_t* range, void* data), void* data);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_svm_attributes_set_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_svm_attributes_get_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_runtime_stats_get(
+    hsa_agent_t agent,
+    hsa_status_t (*callback)(const hsa_amd_runtime_stats_entry_t* entry, void* data), void* data);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_profiling_dispatch_slots_enable(hsa_queue_t* queue, hsa_signal_t* slot_base);
+
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_profiling_get_dispatch_times(hsa_queue_t* queue, uint64_t first_packet_id,
+                                                  uint32_t count,
+                                                  hsa_amd_profiling_dispatch_time_t* times,
+                                                  uint32_t* completed);
+
 // Mirrors Amd Extension Apis
 hsa_status_t
     hsa_amd_memory_async_copy(void* dst, hsa_agent_t dst_agent, const void* src,
@@ -84,6 +84,24 @@ namespace rocr {
       hsa_executable_t executable,
       void *data),
     void *data);
+
+  hsa_status_t
+    hsa_ven_amd_loader_executable_load_deferred_code_objects(
+    hsa_executable_t executable,
+    const hsa_agent_t *agent);
+
+  hsa_status_t
+    hsa_ven_amd_loader_executable_symbol_get_dispatch_info(
+    hsa_executable_symbol_t executable_symbol,
+    const hsa_ven_amd_loader_kernel_dispatch_info_t **dispatch_info);
+
+  hsa_status_t
+    hsa_ven_amd_loader_select_bundle_entries(
+    const char *const *isa_names,
+    uint32_t num_isa_names,
+    const hsa_agent_t *agents,
+    uint32_t num_agents,
+    int32_t *selected_entries);
 }  // namespace rocr
 
 #endif
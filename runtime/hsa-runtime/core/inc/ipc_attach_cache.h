@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HSA_RUNTIME_CORE_INC_IPC_ATTACH_CACHE_H_
+#define HSA_RUNTIME_CORE_INC_IPC_ATTACH_CACHE_H_
+
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "inc/hsa_ext_amd.h"
+#include "core/util/locks.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace core {
+
+/// @brief Shares IPC mappings between attaches of the same handle.
+///
+/// Mappings are refcounted per attach.  A mapping whose last reference is
+/// released stays mapped on an LRU idle list so a later attach of the same
+/// handle skips the import; the oldest idle mappings are unmapped past the
+/// idle limit or on Purge.  The cache only does the bookkeeping, mappings
+/// returned for unmapping are unmapped by the caller.
+class IPCAttachCache {
+ public:
+  struct Key {
+    hsa_amd_ipc_memory_t handle;
+    size_t len;
+    // Sorted driver node IDs of the mapping agents, empty for all agents.
+    std::vector<uint32_t> nodes;
+
+    bool operator<(const Key& rhs) const;
+  };
+
+  explicit IPCAttachCache(size_t max_idle)
+      : max_idle_(max_idle), hits_(0), misses_(0), evictions_(0) {}
+
+  /// @brief Returns the mapping of @p key with a new reference, or nullptr
+  /// if it is not cached.
+  void* Acquire(const Key& key);
+
+  /// @brief Caches a new mapping of @p key with one reference.  Returns false
+  /// if another thread cached @p key first, @p ptr is then not shared.
+  bool Insert(const Key& key, void* ptr);
+
+  enum ReleaseResult {
+    kReleased,
+    // @p ptr is not a cached mapping.
+    kNotCached,
+    // @p ptr is cached but has no references, e.g. it was detached twice.
+    kNotReferenced,
+  };
+
+  /// @brief Drops a reference to @p ptr.  Mappings to unmap now are appended
+  /// to @p unmap.
+  ReleaseResult Release(void* ptr, std::vector<void*>& unmap);
+
+  /// @brief Appends all idle mappings to @p unmap and forgets them.
+  void Purge(std::vector<void*>& unmap);
+
+  void GetStats(hsa_amd_ipc_memory_cache_stats_t* stats);
+
+ private:
+  struct Entry;
+  typedef std::map<Key, Entry> EntryMap;
+
+  struct Entry {
+    void* ptr;
+    uint32_t refcount;
+    std::list<EntryMap::iterator>::iterator idle;
+  };
+
+  // Removes the least recently used idle mapping.  Requires lock_.
+  void Evict(std::vector<void*>& unmap);
+
+  EntryMap entries_;
+  std::unordered_map<void*, EntryMap::iterator> by_ptr_;
+
+  // Idle mappings, least recently used first.
+  std::list<EntryMap::iterator> idle_;
+  size_t max_idle_;
+
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t evictions_;
+
+  KernelMutex lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(IPCAttachCache);
+};
+
+}  // namespace core
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_IPC_ATTACH_CACHE_H_
@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HSA_RUNTIME_CORE_INC_IPC_DMABUF_H_
+#define HSA_RUNTIME_CORE_INC_IPC_DMABUF_H_
+
+#include <stdint.h>
+#include <sys/un.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "core/util/locks.h"
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace core {
+
+/// @brief Wire format of the IPC dmabuf socket protocol.
+///
+/// A client sends a request header followed by @p count handles and gets a
+/// reply header followed by @p count status words.  The reply carries one FD
+/// per successful handle, in handle order, as SCM_RIGHTS ancillary data.
+/// Connections stay open for further requests until the client closes them.
+namespace ipc_dmabuf {
+static const uint32_t kRequestMagic = 0x51524849;  // "IHRQ"
+static const uint32_t kReplyMagic = 0x50524849;    // "IHRP"
+
+// Handles per request.  The kernel limits SCM_RIGHTS to 253 FDs per message.
+static const uint32_t kMaxBatch = 64;
+
+struct Header {
+  uint32_t magic;
+  uint32_t count;
+};
+
+struct Request {
+  Header header;
+  uint64_t handles[kMaxBatch];
+};
+
+struct Reply {
+  Header header;
+  int32_t status[kMaxBatch];
+};
+
+// Fills @p address with the abstract socket name of process @p pid's server.
+void SocketAddress(uint32_t pid, struct sockaddr_un* address);
+}  // namespace ipc_dmabuf
+
+/// @brief Serves dmabuf FDs of exported allocations to importing processes.
+///
+/// Worker threads share one epoll instance so requests from many importers
+/// are served concurrently.  Connections are non-blocking and armed one-shot,
+/// so a connection is only served by one worker at a time and a slow client
+/// never holds a worker while its data is in flight.  Exported FDs are kept
+/// open in an LRU cache so repeated attaches skip the driver export; an FD
+/// evicted or unregistered while a reply is using it is closed after the
+/// reply is sent.
+class IPCDmaBufServer {
+ public:
+  /// @param fd_cache_limit Max exported FDs kept open between requests.
+  explicit IPCDmaBufServer(size_t fd_cache_limit);
+  ~IPCDmaBufServer();
+
+  /// @brief Binds the socket of process @p pid and starts the workers.  Does
+  /// nothing if already started.
+  bool Start(uint32_t pid);
+
+  /// @brief Makes [ptr, ptr+len) importable.  Takes ownership of @p dmabuf_fd
+  /// if it is not -1.
+  void Register(void* ptr, size_t len, int dmabuf_fd);
+
+  /// @brief Stops serving @p ptr.  Called when the allocation is freed.
+  void Unregister(void* ptr);
+
+ private:
+  // Closes the FD once the last reference goes away.
+  struct DmaBufFd {
+    explicit DmaBufFd(int fd) : fd(fd) {}
+    ~DmaBufFd();
+    int fd;
+  };
+
+  struct Export {
+    size_t len;
+    std::shared_ptr<DmaBufFd> fd;
+    std::list<uint64_t>::iterator lru;
+  };
+
+  // Progress of one client connection.  Only touched by the worker holding
+  // the connection's one-shot event, so it needs no lock.
+  struct Connection {
+    Connection() : received(0), reply_size(0), sent(0), num_fds(0) {}
+
+    ipc_dmabuf::Request request;
+    size_t received;  // Request bytes read so far.
+
+    ipc_dmabuf::Reply reply;
+    size_t reply_size;  // Zero while no reply is pending.
+    size_t sent;
+    // References keep the FDs open until sent even if they are evicted meanwhile.
+    std::shared_ptr<DmaBufFd> refs[ipc_dmabuf::kMaxBatch];
+    int fds[ipc_dmabuf::kMaxBatch];
+    uint32_t num_fds;
+  };
+
+  static void WorkerLoop(void* server);
+  void Worker();
+
+  // Accepts all pending connections.
+  void Accept();
+
+  // Reads requests from and sends replies to @p fd until it would block.
+  // Sets @p events to the epoll events to wait for next.  Returns false if
+  // the connection must be closed.
+  bool Serve(int fd, Connection* conn, uint32_t* events);
+
+  // Returns the cached FD of @p handle, exporting it if needed.
+  std::shared_ptr<DmaBufFd> GetFd(uint64_t handle);
+
+  // Adds @p handle to the FD cache and evicts the least recently used FDs
+  // over the limit.  Requires lock_.
+  void CacheFd(uint64_t handle, Export& entry);
+
+  // Stops the workers and closes all sockets.  Requires start_lock_.
+  void Stop();
+
+  int listen_fd_;
+  int epoll_fd_;
+  int stop_fd_;
+  std::vector<os::Thread> workers_;
+
+  std::unordered_map<uint64_t, Export> exports_;
+  std::list<uint64_t> fd_lru_;
+  size_t fd_cache_limit_;
+  std::unordered_map<int, std::unique_ptr<Connection>> conns_;
+
+  // Protects the export table, FD cache and connection set.
+  KernelMutex lock_;
+
+  // Serializes Start.  Never taken by workers so Start may join them.
+  KernelMutex start_lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(IPCDmaBufServer);
+};
+
+/// @brief Fetches dmabuf FDs from other processes' IPCDmaBufServer.
+///
+/// Connections are pooled per exporting process and reused across attaches.
+class IPCDmaBufClient {
+ public:
+  IPCDmaBufClient() {}
+  ~IPCDmaBufClient();
+
+  /// @brief Fetches the FDs of @p count handles exported by process @p pid.
+  /// On success @p fds[i] is the FD of @p handles[i], or -1 if that handle is
+  /// not exported.  The caller owns the returned FDs.
+  bool FetchFds(uint32_t pid, uint32_t count, const uint64_t* handles, int* fds);
+
+ private:
+  int Connect(uint32_t pid);
+  bool Request(int conn, uint32_t count, const uint64_t* handles, int* fds);
+
+  // Idle connections by exporter pid.
+  std::map<uint32_t, std::vector<int>> idle_;
+  KernelMutex lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(IPCDmaBufClient);
+};
+
+}  // namespace core
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_IPC_DMABUF_H_
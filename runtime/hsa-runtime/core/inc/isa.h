@@ -48,6 +48,7 @@
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 #include "core/inc/amd_hsa_code.hpp"
 
 namespace rocr {
@@ -100,6 +101,14 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
   /// @brief Isa's version type.
   typedef std::tuple<int32_t, int32_t, int32_t> Version;
 
+  /// @brief Compact Isa identifier: stepping, minor and major version in bits
+  /// 0-23, SRAMECC and XNACK IsaFeature in bits 24-25 and 26-27, and bit 28
+  /// set for wave32 Isas. 0 never identifies a registered Isa.
+  typedef uint32_t Id;
+
+  /// @brief Mask of the version bits of an Id.
+  static constexpr Id kIdVersionMask = 0xFFFFFF;
+
   /// @brief Default destructor.
   ~Isa() = default;
 
@@ -119,6 +128,30 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
   /// false otherwise.
   static bool IsCompatible(const Isa &code_object_isa, const Isa &agent_isa);
 
+  /// @returns True if the Isas identified by @p code_object_isa and
+  /// @p agent_isa are compatible, false otherwise.
+  static bool IsCompatible(Id code_object_isa, Id agent_isa) {
+    if ((code_object_isa & kIdVersionMask) != (agent_isa & kIdVersionMask)) return false;
+    // Only explicitly enabled or disabled features, the values with bit 1 set,
+    // constrain the agent.
+    Id sramecc = IdFeature(code_object_isa, kIdSrameccShift);
+    if ((sramecc & 2) && sramecc != IdFeature(agent_isa, kIdSrameccShift)) return false;
+    Id xnack = IdFeature(code_object_isa, kIdXnackShift);
+    if ((xnack & 2) && xnack != IdFeature(agent_isa, kIdXnackShift)) return false;
+    return true;
+  }
+
+  /// @returns Number of features explicitly enabled or disabled by the Isa
+  /// identified by @p isa. More specific code objects are preferred.
+  static uint32_t Specificity(Id isa) {
+    return ((IdFeature(isa, kIdSrameccShift) >> 1) & 1) + ((IdFeature(isa, kIdXnackShift) >> 1) & 1);
+  }
+
+  /// @returns This Isa's compact identifier.
+  Id GetId() const {
+    return id_;
+  }
+
   /// @returns This Isa's version.
   const Version &GetVersion() const {
     return version_;
@@ -191,7 +224,20 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
       : targetid_(nullptr),
         version_(Version(-1, -1, -1)),
         sramecc_(IsaFeature::Unsupported),
-        xnack_(IsaFeature::Unsupported) {}
+        xnack_(IsaFeature::Unsupported),
+        id_(0) {}
+
+  static constexpr uint32_t kIdSrameccShift = 24;
+  static constexpr uint32_t kIdXnackShift = 26;
+  static constexpr uint32_t kIdWave32Shift = 28;
+
+  /// @returns IsaFeature value stored at @p shift in @p isa.
+  static Id IdFeature(Id isa, uint32_t shift) {
+    return (isa >> shift) & 3;
+  }
+
+  /// @returns Compact identifier of this Isa's properties.
+  Id MakeId() const;
 
   // @brief Isa's target ID name.
   const char* targetid_;
@@ -208,6 +254,9 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
   /// @brief Isa's supported wavefront.
   Wavefront wavefront_;
 
+  /// @brief Isa's compact identifier.
+  Id id_;
+
   /// @brief Isa's friends.
   friend class IsaRegistry;
 }; // class Isa
@@ -238,6 +287,30 @@ class IsaRegistry final {
   static const IsaMap& GetSupportedIsas();
 }; // class IsaRegistry
 
+/// @class IsaBundleIndex.
+/// @brief Compatibility index over the code object Isas of a multi-target
+/// bundle, resolving each entry name once.
+class IsaBundleIndex final {
+ public:
+  /// @brief Indexes @p count Isa names, optionally prefixed by an offload
+  /// kind as in bundle entry IDs. Entries whose name is not a supported Isa
+  /// never match.
+  IsaBundleIndex(const char *const *isa_names, size_t count);
+
+  /// @returns Index of the most specific entry compatible with @p agent_isa,
+  /// lowest index first among equals, or -1 if there is none.
+  int32_t Select(const Isa &agent_isa) const;
+
+ private:
+  struct Entry {
+    Isa::Id id;
+    int32_t index;
+  };
+
+  /// @brief Entries keyed by version, sorted by decreasing specificity.
+  std::unordered_map<Isa::Id, std::vector<Entry>> entries_;
+}; // class IsaBundleIndex
+
 } // namespace core
 } // namespace rocr
 
@@ -106,6 +106,10 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
     AllocateGTTAccess = (1 << 9),
     AllocateContiguous = (1 << 10), // Physically contiguous memory
     AllocateUncached = (1 << 11),   // Uncached memory
+    AllocateHugePage2MB = (1 << 12),     // System memory on 2MB pages if available
+    AllocateHugePage1GB = (1 << 13),     // System memory on 1GB pages if available
+    AllocateNUMAInterleave = (1 << 14),  // System memory interleaved across NUMA nodes
+    AllocateZeroed = (1 << 15),          // Zero-filled memory
   };
 
   typedef uint32_t AllocateFlags;
@@ -114,6 +118,14 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
 
   virtual hsa_status_t Free(void* address, size_t size) const = 0;
 
+  // Releases several allocations at once.  status receives one result per
+  // (address, size) entry of blocks.
+  virtual void FreeBatch(const std::vector<std::pair<void*, size_t>>& blocks,
+                         std::vector<hsa_status_t>& status) const {
+    status.resize(blocks.size());
+    for (size_t i = 0; i < blocks.size(); i++) status[i] = Free(blocks[i].first, blocks[i].second);
+  }
+
   // Prepares suballocated memory for IPC export.
   virtual hsa_status_t IPCFragmentExport(void* address) const = 0;
 
@@ -45,6 +45,7 @@
 #ifndef HSA_RUNTME_CORE_INC_RUNTIME_H_
 #define HSA_RUNTME_CORE_INC_RUNTIME_H_
 
+#include <atomic>
 #include <vector>
 #include <map>
 #include <memory>
@@ -67,6 +68,8 @@
 #include "core/inc/amd_xdna_driver.h"
 #include "core/inc/exceptions.h"
 #include "core/inc/interrupt_signal.h"
+#include "core/inc/ipc_attach_cache.h"
+#include "core/inc/ipc_dmabuf.h"
 #include "core/inc/memory_region.h"
 #include "core/inc/signal.h"
 #include "core/inc/svm_profiler.h"
@@ -219,6 +222,18 @@ class Runtime {
   /// @retval ::HSA_STATUS_SUCCESS if @p ptr is successfully released.
   hsa_status_t FreeMemory(void* ptr);
 
+  /// @brief Free memory previously allocated with AllocateMemory once
+  /// @p dependency completes.
+  ///
+  /// @param [in] ptr Address of the memory to be freed.
+  /// @param [in] dependency Signal which must reach 0 before the memory is
+  /// released, or a null handle to release without waiting.
+  ///
+  /// @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION If @p ptr is not the
+  /// address of a live allocation via ::core::Runtime::AllocateMemory
+  /// @retval ::HSA_STATUS_SUCCESS if the release of @p ptr has been queued.
+  hsa_status_t FreeMemoryAsync(void* ptr, hsa_signal_t dependency);
+
   hsa_status_t RegisterReleaseNotifier(void* ptr, hsa_amd_deallocation_callback_t callback,
                                        void* user_data);
 
@@ -354,8 +369,22 @@ class Runtime {
   hsa_status_t IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len, uint32_t num_agents,
                          Agent** mapping_agents, void** mapped_ptr);
 
+  /// @brief Attaches @p num_handles IPC handles.  With dmabuf IPC the FDs of
+  /// handles from the same exporter are fetched in one request.  Either all
+  /// handles are attached or none.
+  hsa_status_t IPCAttachBatch(uint32_t num_handles, const hsa_amd_ipc_memory_t* handles,
+                              const size_t* lens, uint32_t num_agents, Agent** mapping_agents,
+                              void** mapped_ptrs);
+
   hsa_status_t IPCDetach(void* ptr);
 
+  /// @brief Unmaps the idle mappings of the IPC attach cache.
+  void IPCCachePurge();
+
+  void IPCCacheStats(hsa_amd_ipc_memory_cache_stats_t* stats) {
+    ipc_attach_cache_->GetStats(stats);
+  }
+
   hsa_status_t SetSvmAttrib(void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list,
                             size_t attribute_count);
 
@@ -365,6 +394,25 @@ class Runtime {
   hsa_status_t SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent, uint32_t num_dep_signals,
                            const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
 
+  /// @brief Sets SVM attributes on the prefetch worker once @p dep_signals are
+  /// satisfied.  Attributes are validated and copied before returning.
+  hsa_status_t SetSvmAttribAsync(void* ptr, size_t size,
+                                 hsa_amd_svm_attribute_pair_t* attribute_list,
+                                 size_t attribute_count, uint32_t num_dep_signals,
+                                 const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
+
+  /// @brief Queries SVM attributes on the prefetch worker once @p dep_signals
+  /// are satisfied.  @p attribute_list is written before completion.
+  hsa_status_t GetSvmAttribAsync(void* ptr, size_t size,
+                                 hsa_amd_svm_attribute_pair_t* attribute_list,
+                                 size_t attribute_count, uint32_t num_dep_signals,
+                                 const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
+
+  hsa_status_t SvmProfileIterateRanges(
+      hsa_status_t (*callback)(const hsa_amd_svm_profile_range_t* range, void* data), void* data) {
+    return svm_profile_->IterateRanges(callback, data);
+  }
+
   hsa_status_t DmaBufExport(const void* ptr, size_t size, int* dmabuf, uint64_t* offset);
 
   hsa_status_t DmaBufClose(int dmabuf);
@@ -415,7 +463,10 @@ class Runtime {
 
   const std::vector<uint32_t>& gpu_ids() { return gpu_ids_; }
 
-  Agent* agent_by_gpuid(uint32_t gpuid) { return agents_by_gpuid_[gpuid]; }
+  Agent* agent_by_gpuid(uint32_t gpuid) {
+    auto it = agents_by_gpuid_.find(gpuid);
+    return (it == agents_by_gpuid_.end()) ? nullptr : it->second;
+  }
 
   Agent* region_gpu() { return region_gpu_; }
 
@@ -496,7 +547,14 @@ class Runtime {
 
  protected:
   static void AsyncEventsLoop(void*);
-  static void AsyncIPCSockServerConnLoop(void*);
+  static bool PendingFreeHandler(hsa_signal_value_t value, void* arg);
+
+  // Runs notifiers for and releases all frees queued on signal_handle.
+  void ReclaimPendingFrees(uint64_t signal_handle);
+
+  // Reports a block the driver failed to release.  Does not return unless a
+  // system event handler accepts the error.
+  void ReportFreeFailure(const MemoryRegion* region, void* ptr);
 
   struct AllocationRegion {
     AllocationRegion()
@@ -529,6 +587,13 @@ class Runtime {
     amdgpu_bo_handle ldrm_bo;
   };
 
+  struct PendingFree {
+    PendingFree(void* ptr_arg, AllocationRegion&& allocation_arg)
+        : ptr(ptr_arg), allocation(std::move(allocation_arg)) {}
+    void* ptr;
+    AllocationRegion allocation;
+  };
+
   struct AsyncEventsControl {
     AsyncEventsControl() : async_events_thread_(NULL) {}
     void Shutdown();
@@ -562,14 +627,24 @@ class Runtime {
   struct PrefetchRange;
   typedef std::map<uintptr_t, PrefetchRange> prefetch_map_t;
 
+  // SVM operation queued to the prefetch worker.
   struct PrefetchOp {
+    enum Type { kPrefetch, kSetAttrib, kGetAttrib };
+
+    Type type;
     void* base;
     size_t size;
     uint32_t node_id;
-    int remaining_deps;
     hsa_signal_t completion;
+    // Dependencies not yet seen satisfied.
     std::vector<hsa_signal_t> dep_signals;
+    // prefetch_map_.end() unless type is kPrefetch.
     prefetch_map_t::iterator prefetch_map_entry;
+    // KFD attributes of kSetAttrib.
+    std::vector<HSA_SVM_ATTRIBUTE> attribs;
+    // Caller's list of kGetAttrib.
+    hsa_amd_svm_attribute_pair_t* attribute_list;
+    size_t attribute_count;
   };
 
   struct PrefetchRange {
@@ -581,6 +656,45 @@ class Runtime {
     prefetch_map_t::iterator next;
   };
 
+  // Prefetches are issued in batches by one worker thread which waits on the
+  // dependencies of all queued prefetches at once.
+  struct PrefetchQueue {
+    PrefetchQueue() : thread(NULL), exit(false) {}
+
+    hsa_signal_t wake;
+    os::Thread thread;
+    KernelMutex lock;
+    // Prefetches not yet taken by the worker, in submission order.
+    std::vector<PrefetchOp*> submitted;
+    bool exit;
+  };
+
+  static void SvmPrefetchLoop(void*);
+
+  // Queues @p op to the prefetch worker, starting the worker if needed.
+  void QueuePrefetchOp(PrefetchOp* op);
+
+  // Issues the ops of a batch in order, merging runs of consecutive ops of
+  // one type, and signals their completions.
+  void IssuePrefetchBatch(const std::vector<PrefetchOp*>& batch);
+
+  // Issues prefetches with one KFD call per coalesced range.
+  void IssuePrefetches(const std::vector<PrefetchOp*>& ops);
+
+  // Issues attribute changes with one KFD call per run of changes to the same
+  // range.
+  void IssueSetAttribs(const std::vector<PrefetchOp*>& ops);
+
+  // Converts attributes of SetSvmAttrib to KFD attributes.
+  void ConvertSvmAttribs(hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+                         std::vector<HSA_SVM_ATTRIBUTE>& attribs);
+
+  // Stops the prefetch worker, dropping prefetches still waiting on dependencies.
+  void ShutdownPrefetchQueue();
+
+  // Removes the ranges of ops from prefetch_map_.
+  void RemovePrefetchRanges(const std::vector<PrefetchOp*>& ops);
+
   // Will be created before any user could call hsa_init but also could be
   // destroyed before incorrectly written programs call hsa_shutdown.
   static __forceinline KernelMutex& bootstrap_lock() {
@@ -693,9 +807,14 @@ class Runtime {
   // Contains the region, address, and size of previously allocated memory.
   std::map<const void*, AllocationRegion> allocation_map_;
 
+  // Frees queued by FreeMemoryAsync, keyed by dependency signal handle.
+  KernelMutex pending_free_lock_;
+  std::map<uint64_t, std::vector<PendingFree>> pending_frees_;
+
   // Pending prefetch containers.
   KernelMutex prefetch_lock_;
   prefetch_map_t prefetch_map_;
+  PrefetchQueue prefetch_queue_;
 
   // Allocator using ::system_region_
   std::function<void*(size_t size, size_t align, MemoryRegion::AllocateFlags flags, int agent_node_id)> system_allocator_;
@@ -763,10 +882,15 @@ class Runtime {
 
   std::unique_ptr<AMD::SvmProfileControl> svm_profile_;
 
-  // IPC DMA buf unix domain socket server dmabuf FD passing
-  int ipc_sock_server_fd_;
-  std::map<uint64_t, int> ipc_sock_server_conns_;
-  KernelMutex ipc_sock_server_lock_;
+  // IPC DMA buf unix domain socket server and client for dmabuf FD passing
+  std::unique_ptr<IPCDmaBufServer> ipc_dmabuf_server_;
+  std::unique_ptr<IPCDmaBufClient> ipc_dmabuf_client_;
+
+  // Shares mappings between attaches of the same IPC handle.
+  std::unique_ptr<IPCAttachCache> ipc_attach_cache_;
+
+  // Distinguishes dmabuf exports of an address reused after a free.
+  std::atomic<uint32_t> ipc_export_generation_;
 
  private:
   void CheckVirtualMemApiSupport();
@@ -886,8 +1010,14 @@ class Runtime {
 
   void InitIPCDmaBufSupport();
   bool ipc_dmabuf_supported_;
-  int  IPCClientImport(uint32_t conn_handle, uint64_t dmabuf_fd_handle,
-                       amdgpu_bo_import_result *res,
+  // Attaches one handle.  Takes ownership of @p dmabuf_fd, which must be the
+  // handle's fetched FD with dmabuf IPC and -1 otherwise.
+  hsa_status_t IPCImport(const hsa_amd_ipc_memory_t* handle, size_t len, uint32_t num_agents,
+                         Agent** agents, int dmabuf_fd, void** mapped_ptr);
+  // Unmaps an imported allocation.
+  hsa_status_t IPCUnmap(void* ptr);
+  // Registers and closes @p dmabuf_fd.
+  int  IPCClientImport(int dmabuf_fd, amdgpu_bo_import_result *res,
                        unsigned int numNodes, HSAuint32 *nodes,
                        void **importAddress, HSAuint64 *importSize);
 };
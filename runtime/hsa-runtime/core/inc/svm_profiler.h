@@ -43,27 +43,138 @@
 #ifndef HSA_RUNTME_CORE_INC_SVM_PROFILER_H_
 #define HSA_RUNTME_CORE_INC_SVM_PROFILER_H_
 
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
 #include <vector>
 #include <string>
 #include <thread>
+#include "core/util/locks.h"
 #include "core/util/os.h"
+#include "inc/hsa_ext_amd.h"
 
 namespace rocr {
 namespace AMD {
 
+    /// @brief KFD SMI event record.  Addresses and sizes are in bytes.
+    struct SvmEvent {
+      uint32_t event_id;
+      uint64_t time;
+      uint32_t pid;
+      uint64_t addr;
+      uint64_t size;
+      // Source and destination of migrations.  Other events store their gpuid in from.
+      uint32_t from;
+      uint32_t to;
+      uint32_t trigger;
+      // W/R for page fault start, M/U for page fault end.
+      char mode;
+    };
+
+    /// @brief Parses one KFD SMI event record.  Returns false if @p line is
+    /// malformed.
+    bool ParseSmiEvent(const char* line, SvmEvent* event);
+
+    /// @brief Aggregates SVM page faults and migrations per address granule
+    /// and derives placement hints from recurring patterns.
+    ///
+    /// Event time is split into fixed length epochs.  A granule faulted on by
+    /// one agent in kRecurringEpochs consecutive epochs should prefer, and be
+    /// prefetched to, that agent.  A granule whose migrations reverse the
+    /// previous one kThrashMigrations times in an epoch should prefer system
+    /// memory.  Has no runtime dependencies so recorded logs can be replayed.
+    class SvmAccessAnalyzer {
+    public:
+      static const uint64_t kGranuleSize = 2 * 1024 * 1024;
+      static const uint64_t kEpochNs = 100 * 1000 * 1000;
+      static const uint32_t kRecurringEpochs = 3;
+      static const uint32_t kThrashMigrations = 4;
+      // Events on new granules are dropped past this many.
+      static const size_t kMaxRanges = 64 * 1024;
+
+      struct Range {
+        // Extent of the pages with events in the granule.
+        uint64_t base;
+        uint64_t end;
+        uint64_t page_faults;
+        uint64_t migrations;
+        uint64_t migrated_bytes;
+        uint64_t thrash_migrations;
+        uint32_t fault_epochs;
+        hsa_amd_svm_profile_hint_t hint;
+        uint32_t hint_gpuid;
+        bool applied;
+      };
+
+      SvmAccessAnalyzer() {}
+
+      void Record(const SvmEvent& event);
+
+      /// @brief Records each event of a log written by SvmProfileControl or
+      /// read from a KFD SMI file.  Returns the number of events recorded.
+      size_t Replay(FILE* log);
+
+      /// @brief Appends the ranges whose hint changed since the last call.
+      void TakeHints(std::vector<Range>* ranges);
+
+      /// @brief Marks the hint of @p range applied unless it changed since.
+      void MarkApplied(const Range& range);
+
+      template <typename F> void ForEachRange(F f) const {
+        for (auto& it : granules_) f(it.second.range);
+      }
+
+    private:
+      struct Granule {
+        Range range;
+        // Last epoch with faults and its faulting gpuid, kMixedGpuid if several.
+        uint64_t fault_epoch;
+        uint32_t fault_gpuid;
+        uint64_t thrash_epoch;
+        uint32_t epoch_thrash;
+        uint32_t last_from;
+        uint32_t last_to;
+        bool pending;
+      };
+
+      static const uint32_t kMixedGpuid = UINT32_MAX;
+
+      // Returns the granule containing @p addr, or nullptr if over kMaxRanges.
+      Granule* Lookup(uint64_t addr);
+
+      void Fault(Granule* granule, uint64_t epoch, uint32_t gpuid);
+      void Migrate(Granule* granule, uint64_t epoch, const SvmEvent& event);
+      void SetHint(Granule* granule, hsa_amd_svm_profile_hint_t hint, uint32_t gpuid);
+
+      std::map<uint64_t, Granule> granules_;
+      std::vector<uint64_t> pending_;
+    };
+
     class SvmProfileControl {
     public:
       SvmProfileControl();
       ~SvmProfileControl();
 
+      /// @brief Calls @p callback with each profiled range until it returns
+      /// other than HSA_STATUS_SUCCESS.
+      hsa_status_t IterateRanges(hsa_status_t (*callback)(const hsa_amd_svm_profile_range_t* range,
+                                                          void* data),
+                                 void* data);
+
     private:
       template <typename... Args> std::string format(const char* format, Args... arg);
       void PollSmi();
       static void PollSmiRun(void* profileControl);
+      std::string Describe(const SvmEvent& event);
+      // Applies new hints of the analyzer when HSA_SVM_PROFILE_HINTS is set.
+      void ApplyHints();
+      hsa_agent_t HintAgent(const SvmAccessAnalyzer::Range& range);
       int event;
       bool exit;
       os::Thread poll_smi_thread_;
       std::vector<char> format_buffer;
+      SvmAccessAnalyzer analyzer_;
+      KernelMutex analyzer_lock_;
     };
 
 } // namespace AMD
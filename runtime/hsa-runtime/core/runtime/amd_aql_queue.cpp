@@ -69,6 +69,7 @@
 #include "core/inc/amd_gpu_pm4.h"
 #include "core/inc/hsa_amd_tool_int.hpp"
 #include "core/inc/amd_core_dump.hpp"
+#include "core/util/trace.h"
 
 namespace rocr {
 namespace AMD {
@@ -89,6 +90,7 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
       is_kv_queue_(is_kv),
       pm4_ib_buf_(nullptr),
       pm4_ib_size_b_(0x1000),
+      dispatch_time_slots_(nullptr),
       dynamicScratchState(0),
       exceptionState(0),
       suspended_(false),
@@ -349,6 +351,9 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
 }
 
 AqlQueue::~AqlQueue() {
+  // Keep the agent from reaching the queue through its queue list once teardown starts.
+  agent_->RemoveAqlQueue(this);
+
   // Remove error handler synchronously.
   // Sequences error handler callbacks with queue destroy.
   dynamicScratchState |= ERROR_HANDLER_TERMINATE;
@@ -385,6 +390,7 @@ AqlQueue::~AqlQueue() {
     }
   }
   agent_->system_deallocator()(pm4_ib_buf_);
+  if (dispatch_time_slots_ != nullptr) agent_->system_deallocator()(dispatch_time_slots_);
 }
 
 void AqlQueue::Destroy() {
@@ -459,6 +465,9 @@ uint64_t AqlQueue::AddWriteIndexRelease(uint64_t value) {
 }
 
 void AqlQueue::StoreRelaxed(hsa_signal_value_t value) {
+  trace::Record(trace::kDoorbell, trace::kInstant, amd_queue_.hsa_queue.id, value);
+  stats_.Add(core::kStatDoorbells, 1);
+
   if (doorbell_type_ == 2) {
     // Hardware doorbell supports AQL semantics.
     atomic::Store(signal_.hardware_doorbell_ptr, uint64_t(value), std::memory_order_release);
@@ -1427,6 +1436,89 @@ void AqlQueue::SetProfiling(bool enabled) {
   return;
 }
 
+static_assert(sizeof(amd_signal_t) == HSA_AMD_PROFILING_DISPATCH_SLOT_SIZE,
+              "Dispatch time slot size does not match the signal ABI.");
+
+hsa_signal_t AqlQueue::EnableDispatchTimeSlots() {
+  ScopedAcquire<KernelMutex> lock(&dispatch_time_slots_lock_);
+
+  if (dispatch_time_slots_ == nullptr) {
+    const size_t size = amd_queue_.hsa_queue.size * sizeof(amd_signal_t);
+    dispatch_time_slots_ = reinterpret_cast<amd_signal_t*>(
+        agent_->system_allocator()(size, __alignof(amd_signal_t), 0));
+    if (dispatch_time_slots_ == nullptr)
+      throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES,
+                               "Dispatch time slot allocation failed.\n");
+
+    // Slots have no event mailbox, so completing on them never interrupts the host.
+    memset(dispatch_time_slots_, 0, size);
+    for (uint32_t i = 0; i < amd_queue_.hsa_queue.size; i++)
+      dispatch_time_slots_[i].kind = AMD_SIGNAL_KIND_USER;
+  }
+
+  SetProfiling(true);
+
+  const hsa_signal_t slot_base = {reinterpret_cast<uint64_t>(dispatch_time_slots_)};
+  return slot_base;
+}
+
+hsa_status_t AqlQueue::ReadDispatchTimes(uint64_t first_packet_id, uint32_t count,
+                                         hsa_amd_profiling_dispatch_time_t* times,
+                                         uint32_t* completed) {
+  ScopedAcquire<KernelMutex> lock(&dispatch_time_slots_lock_);
+
+  if (dispatch_time_slots_ == nullptr) return HSA_STATUS_ERROR_INVALID_QUEUE;
+  if (count > amd_queue_.hsa_queue.size) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  // times may be null when count is zero.
+  if (count == 0) {
+    if (completed != nullptr) *completed = 0;
+    return HSA_STATUS_SUCCESS;
+  }
+
+  const uint64_t mask = amd_queue_.hsa_queue.size - 1;
+  uint32_t done = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    amd_signal_t& slot = dispatch_time_slots_[(first_packet_id + i) & mask];
+    // The CP writes end_ts last.
+    const uint64_t end = atomic::Load(&slot.end_ts, std::memory_order_acquire);
+    if (end == 0) {
+      times[i].start = 0;
+      times[i].end = 0;
+      continue;
+    }
+    times[i].start = slot.start_ts;
+    times[i].end = end;
+    // Clear the slot so the packet that next owns it is not reported with these times.
+    atomic::Store(&slot.start_ts, uint64_t(0), std::memory_order_relaxed);
+    atomic::Store(&slot.end_ts, uint64_t(0), std::memory_order_relaxed);
+    done++;
+  }
+
+  // Translate the whole batch with one clock correlation, skipping incomplete packets.
+  if (done == count) {
+    agent_->TranslateTimes(&times[0].start, size_t(count) * 2);
+  } else if (done != 0) {
+    std::vector<uint64_t> ticks;
+    ticks.reserve(size_t(done) * 2);
+    for (uint32_t i = 0; i < count; i++) {
+      if (times[i].end == 0) continue;
+      ticks.push_back(times[i].start);
+      ticks.push_back(times[i].end);
+    }
+    agent_->TranslateTimes(&ticks[0], ticks.size());
+    size_t tick = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      if (times[i].end == 0) continue;
+      times[i].start = ticks[tick++];
+      times[i].end = ticks[tick++];
+    }
+  }
+
+  if (completed != nullptr) *completed = done;
+  return HSA_STATUS_SUCCESS;
+}
+
 // If in_signal is NULL then this ExecutePM4 will block and wait for PM4 commands to complete
 // If in_signal is provided, then ExecutePM4 will return and caller may wait for in_signal
 // Note: On gfx8, there is no completion signal support, so ExecutePM4 will block even if
@@ -48,6 +48,7 @@
 
 #include "core/inc/amd_gpu_agent.h"
 #include "core/inc/hsa_internal.h"
+#include "core/util/trace.h"
 #include "core/util/utils.h"
 
 namespace rocr {
@@ -1025,6 +1026,9 @@ hsa_status_t BlitKernel::SubmitLinearCopyCommand(
     void* dst, const void* src, size_t size,
     std::vector<core::Signal*>& dep_signals, core::Signal& out_signal,
     std::vector<core::Signal*>& gang_signals) {
+  trace::Record(trace::kBlitCopy, trace::kInstant, uintptr_t(this), size);
+  const uint64_t submit_start = timer::fast_clock::raw_now();
+
   // Reserve write index for barrier(s) + dispatch packet.
   const uint32_t num_barrier_packet = uint32_t((dep_signals.size() + 4) / 5);
   const uint32_t total_num_packet = num_barrier_packet + 1;
@@ -1159,12 +1163,16 @@ hsa_status_t BlitKernel::SubmitLinearCopyCommand(
 
   // Submit barrier(s) and dispatch packets.
   ReleaseWriteIndex(write_index_temp, total_num_packet);
+  RecordSubmit(size, num_barrier_packet, submit_start);
 
   return HSA_STATUS_SUCCESS;
 }
 
 hsa_status_t BlitKernel::SubmitLinearFillCommand(void* ptr, uint32_t value,
                                                  size_t count) {
+  trace::Record(trace::kBlitFill, trace::kInstant, uintptr_t(this), count * sizeof(uint32_t));
+  const uint64_t submit_start = timer::fast_clock::raw_now();
+
   std::lock_guard<std::mutex> guard(lock_);
 
   // Reject misaligned base address.
@@ -1204,6 +1212,7 @@ hsa_status_t BlitKernel::SubmitLinearFillCommand(void* ptr, uint32_t value,
                 args, num_workitems, completion_signal_);
 
   ReleaseWriteIndex(write_index, 1);
+  RecordSubmit(fill_size, 0, submit_start);
 
   // Wait for the packet to finish.
   if (HSA::hsa_signal_wait_scacquire(completion_signal_, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
@@ -1225,8 +1234,12 @@ uint64_t BlitKernel::AcquireWriteIndex(uint32_t num_packet) {
 
   uint64_t write_index = queue_->AddWriteIndexAcqRel(num_packet);
 
-  while (write_index + num_packet - queue_->LoadReadIndexRelaxed() > queue_->public_handle()->size) {
-    os::YieldThread();
+  if (write_index + num_packet - queue_->LoadReadIndexRelaxed() > queue_->public_handle()->size) {
+    stats_.Add(core::kStatRingFullWaits, 1);
+    do {
+      os::YieldThread();
+    } while (write_index + num_packet - queue_->LoadReadIndexRelaxed() >
+             queue_->public_handle()->size);
   }
 
   return write_index;
@@ -1237,6 +1250,7 @@ void BlitKernel::ReleaseWriteIndex(uint64_t write_index, uint32_t num_packet) {
   core::Signal* doorbell =
       core::Signal::Convert(queue_->public_handle()->doorbell_signal);
   doorbell->StoreRelease(write_index + num_packet - 1);
+  stats_.Add(core::kStatDoorbells, 1);
 }
 
 void BlitKernel::PopulateQueue(uint64_t index, uint64_t code_handle, void* args,
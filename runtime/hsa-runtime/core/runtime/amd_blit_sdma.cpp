@@ -54,6 +54,7 @@
 #include "core/inc/sdma_registers.h"
 #include "core/inc/signal.h"
 #include "core/inc/interrupt_signal.h"
+#include "core/util/trace.h"
 
 namespace rocr {
 namespace AMD {
@@ -276,6 +277,7 @@ template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bo
 hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::SubmitCommand(
     const void* cmd, size_t cmd_size, uint64_t size, const std::vector<core::Signal*>& dep_signals,
     core::Signal& out_signal, std::vector<core::Signal*>& gang_signals) {
+  const uint64_t submit_start = timer::fast_clock::raw_now();
 
   // The signal is 64 bit value, and poll checks for 32 bit value. So we
   // need to use two poll operations per dependent signal.
@@ -491,6 +493,7 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
   }
 
   ReleaseWriteAddress(curr_index, total_command_size + pad_size);
+  RecordSubmit(size, dep_signals.size(), submit_start);
 
   return HSA_STATUS_SUCCESS;
 }
@@ -498,6 +501,8 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
                       useGCR>::SubmitLinearCopyCommand(void* dst, const void* src, size_t size) {
+  trace::Record(trace::kBlitCopy, trace::kInstant, uintptr_t(this), size);
+
   // Break the copy into multiple copy operation incase the copy size exceeds
   // the SDMA linear copy limit.
   const size_t max_copy_size = max_single_linear_copy_size_ ? max_single_linear_copy_size_ :
@@ -516,6 +521,8 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
                                                        std::vector<core::Signal*>& dep_signals,
                                                        core::Signal& out_signal,
                                                        std::vector<core::Signal*>& gang_signals) {
+  trace::Record(trace::kBlitCopy, trace::kInstant, uintptr_t(this), size);
+
   // Break the copy into multiple copy operations when the copy size exceeds
   // the SDMA linear copy limit.
   const size_t max_copy_size = max_single_linear_copy_size_ ? max_single_linear_copy_size_ :
@@ -609,6 +616,7 @@ template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bo
 hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
                       useGCR>::SubmitLinearFillCommand(void* ptr, uint32_t value, size_t count) {
   const size_t size = count * sizeof(uint32_t);
+  trace::Record(trace::kBlitFill, trace::kInstant, uintptr_t(this), size);
 
   const uint32_t num_fill_command = (size + kMaxSingleFillSize - 1) / kMaxSingleFillSize;
 
@@ -632,6 +640,7 @@ char* BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::Acquir
     return nullptr;
   }
 
+  bool waited = false;
   while (true) {
     curr_index = atomic::Load(&cached_reserve_index_, std::memory_order_acquire);
 
@@ -647,6 +656,10 @@ char* BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::Acquir
     const RingIndexTy new_index = curr_index + cmd_size;
 
     if (CanWriteUpto(new_index) == false) {
+      if (!waited) {
+        stats_.Add(core::kStatRingFullWaits, 1);
+        waited = true;
+      }
       // Wait for read index to move and try again.
       os::YieldThread();
       continue;
@@ -692,6 +705,7 @@ void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
 
       *reinterpret_cast<RingIndexTy*>(queue_resource_.Queue_DoorBell) =
           (HwIndexMonotonic ? new_index : WrapIntoRing(new_index));
+      stats_.Add(core::kStatDoorbells, 1);
 
       atomic::Store(&cached_commit_index_, new_index, std::memory_order_release);
       break;
@@ -64,6 +64,7 @@
 #include "core/inc/isa.h"
 #include "core/inc/runtime.h"
 #include "core/util/os.h"
+#include "core/util/trace.h"
 #include "inc/hsa_ext_image.h"
 #include "inc/hsa_ven_amd_aqlprofile.h"
 #include "inc/hsa_ven_amd_pc_sampling.h"
@@ -99,6 +100,7 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
       properties_(node_props),
       current_coherency_type_(HSA_AMD_COHERENCY_TYPE_COHERENT),
       scratch_used_large_(0),
+      retired_queue_stats_(),
       queues_(),
       is_kv_device_(false),
       trap_code_buf_(NULL),
@@ -123,8 +125,9 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
 
   HSAKMT_STATUS err = hsaKmtGetClockCounters(node_id(), &t0_);
   t1_ = t0_;
-  historical_clock_ratio_ = 0.0;
+  historical_clock_ratio_ = 0;
   assert(err == HSAKMT_STATUS_SUCCESS && "hsaGetClockCounters error");
+  PublishClockSnapshot();
 
   const core::Isa *isa_base;
 
@@ -234,6 +237,10 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
 }
 
 GpuAgent::~GpuAgent() {
+  // Pre-zeroed block refills use the blits.
+  for (const core::MemoryRegion* region : regions_)
+    static_cast<const MemoryRegion*>(region)->ReleaseZeroedPool();
+
   if (this->Enabled()) {
     for (auto& blit : blits_) {
       if (!blit.empty()) {
@@ -942,6 +949,39 @@ hsa_status_t GpuAgent::DmaCopy(void* dst, const void* src, size_t size) {
   return blits_[BlitDevToDev]->SubmitLinearCopyCommand(dst, src, size);
 }
 
+hsa_status_t GpuAgent::DmaCopyBatch(
+    const std::vector<std::tuple<void*, const void*, size_t>>& copies) {
+  if (copies.empty()) return HSA_STATUS_SUCCESS;
+
+  // Each copy packet decrements the completion signal once.
+  core::unique_signal_ptr done(new core::DefaultSignal(copies.size()));
+  if (!done->IsValid()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  std::vector<core::Signal*> dep_signals(0);
+  std::vector<core::Signal*> gang_signals(0);
+
+  hsa_status_t stat = HSA_STATUS_SUCCESS;
+  size_t submitted = 0;
+  for (const auto& copy : copies) {
+    stat = blits_[BlitDevToDev]->SubmitLinearCopyCommand(std::get<0>(copy), std::get<1>(copy),
+                                                         std::get<2>(copy), dep_signals, *done,
+                                                         gang_signals);
+    if (stat != HSA_STATUS_SUCCESS) break;
+    submitted++;
+  }
+
+  // Account for copies which were never submitted so the wait below only
+  // covers packets in flight.
+  if (submitted != copies.size()) done->SubRelaxed(copies.size() - submitted);
+
+  // Callers may hold a lock over the source buffers for the whole batch, so
+  // sleep rather than spin while the copies run.
+  if (done->WaitAcquire(HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_BLOCKED) != 0)
+    return HSA_STATUS_ERROR;
+
+  return stat;
+}
+
 void GpuAgent::SetCopyRequestRefCount(bool set) {
   ScopedAcquire<KernelMutex> lock(&blit_lock_);
   while (pending_copy_stat_check_ref_) {
@@ -1700,7 +1740,10 @@ hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
   auto aql_queue =
       new AqlQueue(this, size, node_id(), scratch, event_callback, data, is_kv_device_);
   *queue = aql_queue;
-  aql_queues_.push_back(aql_queue);
+  {
+    ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
+    aql_queues_.push_back(aql_queue);
+  }
 
   if (doorbell_queue_map_) {
     // Calculate index of the queue doorbell within the doorbell aperture.
@@ -1714,6 +1757,7 @@ hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
 }
 
 void GpuAgent::AcquireQueueMainScratch(ScratchInfo& scratch) {
+  trace::Scope trace_acquire(trace::kScratchAcquire, uintptr_t(&scratch), 0);
   assert(scratch.main_queue_base == nullptr &&
          "AcquireQueueMainScratch called while holding scratch.");
   bool need_queue_scratch_base = (isa_->GetMajorVersion() > 8);
@@ -1899,11 +1943,13 @@ void GpuAgent::ReleaseQueueMainScratch(ScratchInfo& scratch) {
   ScopedAcquire<KernelMutex> lock(&scratch_lock_);
   if (scratch.main_queue_base == nullptr) return;
 
+  trace::Record(trace::kScratchRelease, trace::kInstant, uintptr_t(&scratch), scratch.main_size);
   scratch_cache_.freeMain(scratch);
   scratch.main_queue_base = nullptr;
 }
 
 void GpuAgent::AcquireQueueAltScratch(ScratchInfo& scratch) {
+  trace::Scope trace_acquire(trace::kScratchAcquire, uintptr_t(&scratch), 1);
   assert(scratch.async_reclaim && "Acquire Alt Scratch when FW does not support it");
   assert(scratch.alt_queue_base == nullptr &&
          "AcquireQueueAltScratch called while holding alt scratch.");
@@ -1974,6 +2020,7 @@ void GpuAgent::ReleaseQueueAltScratch(ScratchInfo& scratch) {
   ScopedAcquire<KernelMutex> lock(&scratch_lock_);
   if (scratch.alt_queue_base == nullptr) return;
 
+  trace::Record(trace::kScratchRelease, trace::kInstant, uintptr_t(&scratch), scratch.alt_size);
   scratch_cache_.freeAlt(scratch);
   scratch.alt_queue_base = nullptr;
 }
@@ -1997,6 +2044,7 @@ void GpuAgent::ReleaseScratch(void* base, size_t size, bool large) {
 
 // Go through all the AQL queues and try to release scratch memory
 void GpuAgent::AsyncReclaimScratchQueues() {
+  ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
   for (auto iter : aql_queues_) {
     auto aqlQueue = static_cast<AqlQueue*>(iter);
     aqlQueue->AsyncReclaimMainScratch();
@@ -2009,6 +2057,7 @@ hsa_status_t GpuAgent::SetAsyncScratchThresholds(size_t use_once_limit) {
 
   scratch_limit_async_threshold_ = use_once_limit;
 
+  ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
   for (auto iter : aql_queues_) {
     auto aqlQueue = static_cast<AqlQueue*>(iter);
     aqlQueue->CheckScratchLimits();
@@ -2017,30 +2066,175 @@ hsa_status_t GpuAgent::SetAsyncScratchThresholds(size_t use_once_limit) {
   return HSA_STATUS_SUCCESS;
 }
 
+// Reads the counters of an AQL queue.  Packets are counted by the write index.
+static void ReadQueueStats(AqlQueue* queue, uint64_t* stats) {
+  for (int i = 0; i < core::kStatCount; i++) stats[i] = queue->stats().Read(i);
+  stats[core::kStatSubmissions] = queue->LoadWriteIndexRelaxed();
+}
+
+static uint64_t SubmitTicksToNs(uint64_t ticks) {
+#if defined(__x86_64__) || defined(_M_X64)
+  return uint64_t(double(ticks) * 1e9 / timer::fast_clock::raw_freq());
+#else
+  return ticks;
+#endif
+}
+
+void GpuAgent::RemoveAqlQueue(core::Queue* queue) {
+  ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
+  auto it = std::find(aql_queues_.begin(), aql_queues_.end(), queue);
+  if (it == aql_queues_.end()) return;
+  aql_queues_.erase(it);
+
+  uint64_t stats[core::kStatCount];
+  ReadQueueStats(static_cast<AqlQueue*>(queue), stats);
+  for (int i = 0; i < core::kStatCount; i++) retired_queue_stats_[i] += stats[i];
+}
+
+hsa_status_t GpuAgent::IterateRuntimeStats(
+    hsa_status_t (*callback)(const hsa_amd_runtime_stats_entry_t* entry, void* data),
+    void* data) {
+  // Latency is averaged over latency_submissions, the submissions which recorded it.
+  auto make_entry = [&](hsa_amd_runtime_stats_source_t source, uint64_t id, const uint64_t* stats,
+                        uint64_t latency_submissions) {
+    hsa_amd_runtime_stats_entry_t entry = {};
+    entry.source = source;
+    entry.agent = public_handle();
+    entry.id = id;
+    entry.submissions = stats[core::kStatSubmissions];
+    entry.bytes = stats[core::kStatBytes];
+    entry.doorbells = stats[core::kStatDoorbells];
+    entry.ring_full_waits = stats[core::kStatRingFullWaits];
+    entry.dependency_barriers = stats[core::kStatDependencyBarriers];
+    if (latency_submissions != 0)
+      entry.average_submit_latency_ns =
+          SubmitTicksToNs(stats[core::kStatSubmitTicks]) / latency_submissions;
+    return entry;
+  };
+
+  std::vector<hsa_amd_runtime_stats_entry_t> entries;
+  uint64_t totals[core::kStatCount];
+  {
+    ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
+    std::copy(retired_queue_stats_, retired_queue_stats_ + core::kStatCount, totals);
+    for (auto iter : aql_queues_) {
+      uint64_t stats[core::kStatCount];
+      ReadQueueStats(static_cast<AqlQueue*>(iter), stats);
+      for (int i = 0; i < core::kStatCount; i++) totals[i] += stats[i];
+      entries.push_back(
+          make_entry(HSA_AMD_RUNTIME_STATS_SOURCE_QUEUE, iter->public_handle()->id, stats, 0));
+    }
+  }
+
+  uint64_t blit_submissions = 0;
+  for (size_t i = 0; i < blits_.size(); i++) {
+    if (blits_[i].empty()) continue;
+    const core::Blit* blit = (*blits_[i]).get();
+    uint64_t stats[core::kStatCount];
+    for (int j = 0; j < core::kStatCount; j++) stats[j] = blit->stats().Read(j);
+    entries.push_back(make_entry(blit->isSDMA() ? HSA_AMD_RUNTIME_STATS_SOURCE_BLIT_SDMA
+                                                : HSA_AMD_RUNTIME_STATS_SOURCE_BLIT_KERNEL,
+                                 i, stats, stats[core::kStatSubmissions]));
+
+    blit_submissions += stats[core::kStatSubmissions];
+    // Kernel blit packets and doorbells are already counted by their queue.
+    if (!blit->isSDMA()) stats[core::kStatSubmissions] = stats[core::kStatDoorbells] = 0;
+    for (int j = 0; j < core::kStatCount; j++) totals[j] += stats[j];
+  }
+  entries.insert(entries.begin(),
+                 make_entry(HSA_AMD_RUNTIME_STATS_SOURCE_AGENT, 0, totals, blit_submissions));
+
+  // Callbacks run unlocked so they may create or destroy queues.
+  for (const auto& entry : entries) {
+    hsa_status_t status = callback(&entry, data);
+    if (status != HSA_STATUS_SUCCESS) return status;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
 void GpuAgent::TranslateTime(core::Signal* signal, hsa_amd_profiling_dispatch_time_t& time) {
-  uint64_t start, end;
-  signal->GetRawTs(false, start, end);
-  // Order is important, we want to translate the end time first to ensure that packet duration is
-  // not impacted by clock measurement latency jitter.
-  time.end = TranslateTime(end);
-  time.start = TranslateTime(start);
+  uint64_t ticks[2];
+  signal->GetRawTs(false, ticks[0], ticks[1]);
+  const uint64_t start = ticks[0];
+  const uint64_t end = ticks[1];
+  // Both ticks are translated with the same clock snapshot so that the packet duration is not
+  // impacted by clock measurement latency jitter.
+  TranslateTimes(ticks, 2);
+  time.start = ticks[0];
+  time.end = ticks[1];
 
   if ((start == 0) || (end == 0) || (start < t0_.GPUClockCounter) || (end < t0_.GPUClockCounter))
     debug_print("Signal %p time stamps may be invalid.\n", &signal->signal_);
 }
 
 void GpuAgent::TranslateTime(core::Signal* signal, hsa_amd_profiling_async_copy_time_t& time) {
-  uint64_t start, end;
-  signal->GetRawTs(true, start, end);
-  // Order is important, we want to translate the end time first to ensure that packet duration is
-  // not impacted by clock measurement latency jitter.
-  time.end = TranslateTime(end);
-  time.start = TranslateTime(start);
+  uint64_t ticks[2];
+  signal->GetRawTs(true, ticks[0], ticks[1]);
+  const uint64_t start = ticks[0];
+  const uint64_t end = ticks[1];
+  // Both ticks are translated with the same clock snapshot so that the copy duration is not
+  // impacted by clock measurement latency jitter.
+  TranslateTimes(ticks, 2);
+  time.start = ticks[0];
+  time.end = ticks[1];
 
   if ((start == 0) || (end == 0) || (start < t0_.GPUClockCounter) || (end < t0_.GPUClockCounter))
     debug_print("Signal %p time stamps may be invalid.\n", &signal->signal_);
 }
 
+uint64_t GpuAgent::TranslateTime(uint64_t tick) {
+  TranslateTimes(&tick, 1);
+  return tick;
+}
+
+// Fraction bits of the fixed point clock ratios.  Ratios up to 2^15 system ticks per GPU tick are
+// representable, with an error below 10^-14.
+static const uint32_t kClockRatioShift = 48;
+
+// Scale a tick delta by a fixed point clock ratio.  Truncates toward zero like the integer
+// conversion of a floating point product.  Good for deltas up to 2^63 ticks.
+static __forceinline int64_t ScaleTicks(int64_t delta, int64_t ratio) {
+  __int128 product = __int128(delta) * ratio;
+  product += (product >> 127) & ((__int128(1) << kClockRatioShift) - 1);
+  return int64_t(product >> kClockRatioShift);
+}
+
+void GpuAgent::PublishClockSnapshot() {
+  ClockSnapshot snapshot;
+  snapshot.t0_gpu = t0_.GPUClockCounter;
+  snapshot.t0_sys = t0_.SystemClockCounter;
+  snapshot.t1_gpu = t1_.GPUClockCounter;
+  snapshot.t1_sys = t1_.SystemClockCounter;
+
+  const uint64_t gpu_delta = t1_.GPUClockCounter - t0_.GPUClockCounter;
+  const uint64_t sys_delta = t1_.SystemClockCounter - t0_.SystemClockCounter;
+  snapshot.ratio = 0;
+  if (gpu_delta != 0) {
+    const unsigned __int128 ratio = (static_cast<unsigned __int128>(sys_delta) << kClockRatioShift) /
+        gpu_delta;
+    assert(ratio <= INT64_MAX && "Clock ratio out of range.");
+    snapshot.ratio = int64_t(ratio);
+  }
+  snapshot.historical_ratio = historical_clock_ratio_;
+
+  clock_snapshot_.Store(snapshot);
+}
+
+bool GpuAgent::ClockSyncNeeded(const ClockSnapshot& snapshot, uint64_t max_tick) const {
+  // No correlation since agent initialization.
+  if (snapshot.t1_gpu == snapshot.t0_gpu) return true;
+
+  // Limit errors due to correlated pair certainty to ~0.5us.
+  // extrapolated time < (0.5us / half clock read certainty) * delay between clock measures
+  // clock read certainty is <4us.
+  if (((snapshot.t1_gpu - snapshot.t0_gpu) >> 2) + snapshot.t1_gpu < max_tick) return true;
+
+  // Only allow short (error bounded) extrapolation for times during program execution.
+  // Limit errors due to relative frequency drift to ~0.5us.  Sync clocks at 16Hz.
+  const int64_t max_extrapolation = core::Runtime::runtime_singleton_->sys_clock_freq() >> 4;
+  return ScaleTicks(int64_t(max_tick - snapshot.t1_gpu), snapshot.ratio) >= max_extrapolation;
+}
+
 /*
 Times during program execution are interpolated to adjust for relative clock drift.
 Interval timing may appear as ticks well before process start, leading to large errors due to
@@ -2048,53 +2242,53 @@ frequency adjustment (ie the profiling with NTP problem).  This is fixed by usin
 for early times.
 Intervals larger than t0_ will be frequency adjusted.  This admits a numerical error of not more
 than twice the frequency stability (~10^-5).
+
+The clock correlation is read from a seqlock published snapshot, so translation only takes
+::t1_lock_ when the clocks must be synced.  The whole batch is translated with one snapshot using
+fixed point arithmetic.
 */
-uint64_t GpuAgent::TranslateTime(uint64_t tick) {
-  // Only allow short (error bounded) extrapolation for times during program execution.
-  // Limit errors due to relative frequency drift to ~0.5us.  Sync clocks at 16Hz.
-  const int64_t max_extrapolation = core::Runtime::runtime_singleton_->sys_clock_freq() >> 4;
+void GpuAgent::TranslateTimes(uint64_t* ticks, size_t count, size_t stride) {
+  if (count == 0) return;
 
-  ScopedAcquire<KernelMutex> lock(&t1_lock_);
-  // Limit errors due to correlated pair certainty to ~0.5us.
-  // extrapolated time < (0.5us / half clock read certainty) * delay between clock measures
-  // clock read certainty is <4us.
-  if (((t1_.GPUClockCounter - t0_.GPUClockCounter) >> 2) + t1_.GPUClockCounter < tick) SyncClocks();
+  auto tick_at = [ticks, stride](size_t i) {
+    return reinterpret_cast<uint64_t*>(reinterpret_cast<uint8_t*>(ticks) + i * stride);
+  };
 
-  // Good for ~300 yrs
-  // uint64_t sysdelta = t1_.SystemClockCounter - t0_.SystemClockCounter;
-  // uint64_t gpudelta = t1_.GPUClockCounter - t0_.GPUClockCounter;
-  // int64_t offtick = int64_t(tick - t1_.GPUClockCounter);
-  //__int128 num = __int128(sysdelta)*__int128(offtick) +
-  //__int128(gpudelta)*__int128(t1_.SystemClockCounter);
-  //__int128 sysLarge = num / __int128(gpudelta);
-  // return sysLarge;
+  uint64_t min_tick = UINT64_MAX;
+  uint64_t max_tick = 0;
+  for (size_t i = 0; i < count; i++) {
+    const uint64_t tick = *tick_at(i);
+    min_tick = Min(min_tick, tick);
+    max_tick = Max(max_tick, tick);
+  }
 
-  // Good for ~3.5 months.
-  uint64_t system_tick = 0;
-  int64_t elapsed = 0;
-  double ratio;
+  ClockSnapshot snapshot = clock_snapshot_.Load();
+  const bool historical = min_tick < snapshot.t0_gpu;
 
-  // Valid ticks only need at most one SyncClocks.
-  for (int i = 0; i < 2; i++) {
-    ratio = double(t1_.SystemClockCounter - t0_.SystemClockCounter) /
-        double(t1_.GPUClockCounter - t0_.GPUClockCounter);
-    elapsed = int64_t(ratio * double(int64_t(tick - t1_.GPUClockCounter)));
+  if (ClockSyncNeeded(snapshot, max_tick) || (historical && snapshot.historical_ratio == 0)) {
+    ScopedAcquire<KernelMutex> lock(&t1_lock_);
 
-    // Skip clock sync if under the extrapolation limit.
-    if (elapsed < max_extrapolation) break;
-    SyncClocks();
-  }
+    // Valid ticks only need at most one SyncClocks.
+    for (int i = 0; i < 2 && ClockSyncNeeded(clock_snapshot_.Load(), max_tick); i++) SyncClocks();
 
-  system_tick = uint64_t(elapsed) + t1_.SystemClockCounter;
+    // The ratio in use when the first early tick is seen is kept for all early ticks.
+    if (historical && historical_clock_ratio_ == 0) {
+      historical_clock_ratio_ = clock_snapshot_.Load().ratio;
+      PublishClockSnapshot();
+    }
 
-  // tick predates HSA startup - extrapolate with fixed clock ratio
-  if (tick < t0_.GPUClockCounter) {
-    if (historical_clock_ratio_ == 0.0) historical_clock_ratio_ = ratio;
-    system_tick = uint64_t(historical_clock_ratio_ * double(int64_t(tick - t0_.GPUClockCounter))) +
-        t0_.SystemClockCounter;
+    snapshot = clock_snapshot_.Load();
   }
 
-  return system_tick;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t* tick = tick_at(i);
+    // tick predates HSA startup - extrapolate with fixed clock ratio
+    if (*tick < snapshot.t0_gpu)
+      *tick = snapshot.t0_sys +
+          ScaleTicks(int64_t(*tick - snapshot.t0_gpu), snapshot.historical_ratio);
+    else
+      *tick = snapshot.t1_sys + ScaleTicks(int64_t(*tick - snapshot.t1_gpu), snapshot.ratio);
+  }
 }
 
 bool GpuAgent::current_coherency_type(hsa_amd_coherency_type_t type) {
@@ -2144,6 +2338,7 @@ uint16_t GpuAgent::GetSdmaMicrocodeVersion() const {
 void GpuAgent::SyncClocks() {
   HSAKMT_STATUS err = hsaKmtGetClockCounters(node_id(), &t1_);
   assert(err == HSAKMT_STATUS_SUCCESS && "hsaGetClockCounters error");
+  PublishClockSnapshot();
 }
 
 hsa_status_t GpuAgent::UpdateTrapHandlerWithPCS(void* pcs_hosttrap_buffers, void* pcs_stochastic_buffers) {
@@ -2625,10 +2820,8 @@ hsa_status_t GpuAgent::PcSamplingCreateFromId(HsaPcSamplingTraceId ioctlId,
      *    trap-buffer = half of user-buffer
      *    host-buffer = 2*user-buffer
      *
-     * TODO: We are currently using a temporary host-buffer so that we can increase host-buffer to
-     * factor in client latency. Using a direct-copy to the client buffer would be more efficient.
-     * Revisit this once we have empirical data of latency vs how long it takes to fill 1
-     * trap-buffer.
+     * Sessions without a data ready callback read samples directly from host-buffer, which avoids
+     * the copy to the client buffer.
      */
 
     size_t trap_buffer_size = 0;
@@ -2685,9 +2878,11 @@ hsa_status_t GpuAgent::PcSamplingCreateFromId(HsaPcSamplingTraceId ioctlId,
     }
 
     ht_data.lost_sample_count = 0;
-    ht_data.host_buffer_wrap_pos = 0;
+    ht_data.host_buffer_wrap_pos = nullptr;
     ht_data.host_write_ptr = ht_data.host_buffer;
-    ht_data.host_read_ptr = ht_data.host_write_ptr;
+    ht_data.host_read_ptr = ht_data.host_buffer;
+    ht_data.bytes_received = 0;
+    ht_data.bytes_per_second = 0;
 
     ht_data.session = &session;
     freeHostTrapResources.Dismiss();
@@ -2998,32 +3193,53 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
   } while (true);
 
   *old_val &= (ULLONG_MAX >> 1);
+  ht_data.bytes_received += *old_val * session.sample_size();
+
   /* If the number of entries in old_val is larger than buf_size, then there was a buffer overflow
    * and the 2nd level trap handler code will skip recording samples, causing lost samples
    */
   if (*old_val > (uint64_t)ht_data.device_data->buf_size) {
-    ht_data.lost_sample_count = *old_val - (uint64_t)ht_data.device_data->buf_size;
+    ht_data.lost_sample_count += *old_val - (uint64_t)ht_data.device_data->buf_size;
     *old_val = (uint64_t)ht_data.device_data->buf_size;
   }
 
   to_copy = *old_val * session.sample_size();
 
-  /* Make sure there is enough space after host_write_ptr */
-  if (ht_data.host_write_ptr + to_copy >= host_buffer_end) {
-    // Need to wrap around
-    ht_data.host_buffer_wrap_pos = ht_data.host_write_ptr;
-    ht_data.host_write_ptr = host_buffer_begin;
+  /*
+   * Make sure there is enough space after host_write_ptr. The copy must be contiguous, so wrap
+   * around when it does not fit before the end of the host buffer. The write pointer never
+   * catches up with the read pointer, equal pointers mean the host buffer is empty. When the
+   * consumer has not released enough space, the samples are dropped and counted as lost.
+   */
+  uint8_t* host_write_ptr = ht_data.host_write_ptr.load(std::memory_order_relaxed);
+  uint8_t* host_read_ptr = ht_data.host_read_ptr.load(std::memory_order_acquire);
+  uint8_t* wrap_pos = nullptr;
+  if (host_read_ptr > host_write_ptr) {
+    if (host_write_ptr + to_copy >= host_read_ptr) to_copy = 0;
+  } else if (host_write_ptr + to_copy >= host_buffer_end) {
+    if (host_buffer_begin + to_copy >= host_read_ptr) {
+      to_copy = 0;
+    } else {
+      // Need to wrap around
+      wrap_pos = host_write_ptr;
+      host_write_ptr = host_buffer_begin;
+    }
   }
+  if (to_copy == 0) ht_data.lost_sample_count += *old_val;
+
+  uint8_t* const copy_dst = host_write_ptr;
+  const uint32_t copied = to_copy;
 
   i = 0;
   memset(cmd_data, 0, cmd_data_sz);
 
   if (properties_.NumXcc > 1) {
-    const uint32_t n = ceil(to_copy / (32 * 1024 * 1024));
+    const uint32_t n = (to_copy + CP_DMA_DATA_TRANSFER_CNT_MAX - 1) / CP_DMA_DATA_TRANSFER_CNT_MAX;
     pred_exec_cmd_sz = 2;
     cmd_data[i++] = PM4_HDR(PM4_HDR_IT_OPCODE_PRED_EXEC, pred_exec_cmd_sz, isa_->GetMajorVersion());
-    cmd_data[i++] =
-        PM4_PRED_EXEC_DW2_EXEC_COUNT(0x13 + 7 * n) | PM4_PRED_EXEC_DW2_VIRTUALXCCID_SELECT(0x1);
+    cmd_data[i++] = PM4_PRED_EXEC_DW2_EXEC_COUNT(wait_reg_mem_cmd_sz + n * dma_data_cmd_sz +
+                                                 write_data_cmd_sz) |
+        PM4_PRED_EXEC_DW2_VIRTUALXCCID_SELECT(0x1);
   }
 
   /*
@@ -3061,8 +3277,8 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
                                      PM4_DMA_DATA_SRC_SEL_SRC_ADDR_USING_L2);
     cmd_data[i++] = PM4_DMA_DATA_DW2_SRC_ADDR_LO((uint64_t)buffer_temp);
     cmd_data[i++] = PM4_DMA_DATA_DW3_SRC_ADDR_HI(((uint64_t)buffer_temp) >> 32);
-    cmd_data[i++] = PM4_DMA_DATA_DW4_DST_ADDR_LO((uint64_t)ht_data.host_write_ptr);
-    cmd_data[i++] = PM4_DMA_DATA_DW5_DST_ADDR_HI(((uint64_t)ht_data.host_write_ptr) >> 32);
+    cmd_data[i++] = PM4_DMA_DATA_DW4_DST_ADDR_LO((uint64_t)host_write_ptr);
+    cmd_data[i++] = PM4_DMA_DATA_DW5_DST_ADDR_HI(((uint64_t)host_write_ptr) >> 32);
 
     if (copy_bytes >= to_copy) {
       copy_bytes = to_copy;
@@ -3072,7 +3288,7 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
       cmd_data[i++] = PM4_DMA_DATA_DW6(PM4_DMA_DATA_BYTE_COUNT(copy_bytes) | PM4_DMA_DATA_DIS_WC);
     }
     buffer_temp += copy_bytes;
-    ht_data.host_write_ptr += copy_bytes;
+    host_write_ptr += copy_bytes;
   }
 
   /* WRITE_DATA, Reset buf_written_val */
@@ -3098,22 +3314,41 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
 
   which_buffer = next_buffer;
 
+  // Translate timestamps before publishing so that consumers only see system domain ticks.
+  switch (session.method()) {
+    case HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1: {
+      perf_sample_hosttrap_v1_t* samples = reinterpret_cast<perf_sample_hosttrap_v1_t*>(copy_dst);
+      TranslateTimes(&samples->timestamp, copied / sizeof(*samples), sizeof(*samples));
+    } break;
+    case HSA_VEN_AMD_PCS_METHOD_STOCHASTIC_V1: {
+      perf_sample_snapshot_v1_t* samples = reinterpret_cast<perf_sample_snapshot_v1_t*>(copy_dst);
+      TranslateTimes(&samples->timestamp, copied / sizeof(*samples), sizeof(*samples));
+    } break;
+  }
+
+  // Publish the samples. wrap_pos is stored first, so a consumer that sees the wrapped write
+  // pointer also sees where the data before the wrap ends.
+  if (wrap_pos) ht_data.host_buffer_wrap_pos.store(wrap_pos, std::memory_order_release);
+  ht_data.host_write_ptr.store(host_write_ptr, std::memory_order_release);
+
   return HSA_STATUS_SUCCESS;
 }
 
 void GpuAgent::PcSamplingThread() {
-  // TODO: Implement lost sample count
-  // TODO: Implement latency
-
   pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
   pcs::PcsRuntime::PcSamplingSession& session = *ht_data.session;
   uint32_t& which_buffer = ht_data.which_buffer;
 
-  uint8_t* host_buffer_begin = ht_data.host_buffer;
-  uint8_t* host_buffer_end = ht_data.host_buffer + ht_data.host_buffer_size;
-
   hsa_signal_t done_sig[] = {ht_data.device_data->done_sig0, ht_data.device_data->done_sig1};
 
+  const double clock_freq = double(os::AccurateClockFrequency());
+  uint64_t last_time = os::ReadAccurateClock();
+  uint64_t last_bytes;
+  {
+    std::lock_guard<std::mutex> lock(ht_data.flush_mutex);
+    last_bytes = ht_data.bytes_received;
+  }
+
   while (ht_data.session->isActive()) {
     do {
       hsa_signal_value_t val = HSA::hsa_signal_wait_scacquire(
@@ -3123,142 +3358,154 @@ void GpuAgent::PcSamplingThread() {
     } while (true);
     HSA::hsa_signal_store_screlease(done_sig[which_buffer], 1);
 
-    std::lock_guard<std::mutex> lock(ht_data.host_buffer_mutex);
-    if (PcSamplingFlushHostTrapDeviceBuffers(session) != HSA_STATUS_SUCCESS)
-      goto thread_exit;
-
-    size_t bytes_before_wrap;
-    size_t bytes_after_wrap;
-
-    assert(ht_data.host_read_ptr >= host_buffer_begin && ht_data.host_read_ptr < host_buffer_end);
-    assert(ht_data.host_write_ptr >= host_buffer_begin && ht_data.host_write_ptr < host_buffer_end);
-    assert(ht_data.host_buffer_wrap_pos ? (ht_data.host_read_ptr > ht_data.host_write_ptr)
-                                        : (ht_data.host_read_ptr <= ht_data.host_write_ptr));
-
-    if (ht_data.host_buffer_wrap_pos) {
-      assert(ht_data.host_buffer_wrap_pos <= host_buffer_end &&
-             ht_data.host_buffer_wrap_pos > host_buffer_begin);
-      assert(ht_data.host_read_ptr <= ht_data.host_buffer_wrap_pos);
-
-      // Wrapped around
-      bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-      bytes_after_wrap = ht_data.host_write_ptr - host_buffer_begin;
-
-      while (bytes_before_wrap >= session.buffer_size()) {
-        session.HandleSampleData(ht_data.host_read_ptr, session.buffer_size(), NULL, 0,
-                                 ht_data.lost_sample_count);
-        ht_data.host_read_ptr += session.buffer_size();
-        bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
-      }
-
-      if (bytes_before_wrap + bytes_after_wrap >= session.buffer_size()) {
-        session.HandleSampleData(ht_data.host_read_ptr, bytes_before_wrap, host_buffer_begin,
-                                 (session.buffer_size() - bytes_before_wrap), 0);
-        ht_data.host_read_ptr = host_buffer_begin + (session.buffer_size() - bytes_before_wrap);
-        bytes_before_wrap = 0;
-        ht_data.host_buffer_wrap_pos = 0;
-        bytes_after_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
-      }
-
-      while (bytes_after_wrap >= session.buffer_size()) {
-        session.HandleSampleData(ht_data.host_read_ptr, session.buffer_size(), NULL, 0,
-                                 ht_data.lost_sample_count);
-        ht_data.host_read_ptr += session.buffer_size();
-        bytes_before_wrap = 0;
-        bytes_after_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
-      }
-    } else {
-      bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-
-      while (bytes_before_wrap >= session.buffer_size()) {
-        assert(ht_data.host_read_ptr >= host_buffer_begin &&
-               ht_data.host_read_ptr + session.buffer_size() < host_buffer_end);
-        session.HandleSampleData(ht_data.host_read_ptr, session.buffer_size(), NULL, 0,
-                                 ht_data.lost_sample_count);
-        ht_data.host_read_ptr += session.buffer_size();
-        bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
+    {
+      std::lock_guard<std::mutex> lock(ht_data.flush_mutex);
+      if (PcSamplingFlushHostTrapDeviceBuffers(session) != HSA_STATUS_SUCCESS) goto thread_exit;
+
+      // Track how fast samples arrive, including those moved by PcSamplingFlush.
+      uint64_t now = os::ReadAccurateClock();
+      if (now > last_time) {
+        double rate = double(ht_data.bytes_received - last_bytes) * clock_freq /
+            double(now - last_time);
+        ht_data.bytes_per_second = (ht_data.bytes_per_second == 0)
+            ? rate
+            : 0.75 * ht_data.bytes_per_second + 0.25 * rate;
       }
+      last_time = now;
+      last_bytes = ht_data.bytes_received;
     }
+
+    // Zero-copy clients read the host buffer themselves.
+    if (!session.zero_copy()) PcSamplingDeliver(session, false);
   }
 thread_exit:
   debug_print("PcSamplingThread::Exiting\n");
 }
 
-void GpuAgent::PcSamplingThreadRun(void* _agent) {
-  GpuAgent* agent = (GpuAgent*)_agent;
-  agent->PcSamplingThread();
-  debug_print("PcSamplingThread exiting...");
+void GpuAgent::PcSamplingPeekHostBuffer(uint8_t** buf1, size_t* buf1_sz, uint8_t** buf2,
+                                        size_t* buf2_sz) {
+  pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
+
+  // Only the consumer moves host_read_ptr.
+  uint8_t* read_ptr = ht_data.host_read_ptr.load(std::memory_order_relaxed);
+  uint8_t* write_ptr = ht_data.host_write_ptr.load(std::memory_order_acquire);
+
+  *buf1 = read_ptr;
+  if (read_ptr <= write_ptr) {
+    *buf1_sz = write_ptr - read_ptr;
+    *buf2 = NULL;
+    *buf2_sz = 0;
+  } else {
+    // Wrapped around, the producer does not move host_buffer_wrap_pos until we catch up.
+    uint8_t* wrap_pos = ht_data.host_buffer_wrap_pos.load(std::memory_order_acquire);
+    assert(read_ptr <= wrap_pos && wrap_pos <= ht_data.host_buffer + ht_data.host_buffer_size);
+    *buf1_sz = wrap_pos - read_ptr;
+    *buf2 = ht_data.host_buffer;
+    *buf2_sz = write_ptr - ht_data.host_buffer;
+  }
 }
 
-hsa_status_t GpuAgent::PcSamplingFlush(pcs::PcsRuntime::PcSamplingSession& session) {
+void GpuAgent::PcSamplingConsumeHostBuffer(size_t size) {
   pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
 
-  uint8_t* host_buffer_begin = ht_data.host_buffer;
-  uint8_t* host_buffer_end = ht_data.host_buffer + ht_data.host_buffer_size;
+  uint8_t* read_ptr = ht_data.host_read_ptr.load(std::memory_order_relaxed);
+  uint8_t* write_ptr = ht_data.host_write_ptr.load(std::memory_order_acquire);
 
-  size_t bytes_before_wrap;
-  size_t bytes_after_wrap;
+  if (read_ptr > write_ptr) {
+    uint8_t* wrap_pos = ht_data.host_buffer_wrap_pos.load(std::memory_order_acquire);
+    size_t bytes_before_wrap = wrap_pos - read_ptr;
+    if (size >= bytes_before_wrap)
+      read_ptr = ht_data.host_buffer + (size - bytes_before_wrap);
+    else
+      read_ptr += size;
+  } else {
+    read_ptr += size;
+  }
 
-  std::lock_guard<std::mutex> lock(ht_data.host_buffer_mutex);
-  if (PcSamplingFlushHostTrapDeviceBuffers(session) != HSA_STATUS_SUCCESS)
-    return HSA_STATUS_ERROR;
+  // Release so the producer does not overwrite samples still being read.
+  ht_data.host_read_ptr.store(read_ptr, std::memory_order_release);
+}
 
-  assert(ht_data.host_read_ptr >= host_buffer_begin && ht_data.host_read_ptr < host_buffer_end);
-  assert(ht_data.host_write_ptr >= host_buffer_begin && ht_data.host_write_ptr < host_buffer_end);
-  assert(ht_data.host_buffer_wrap_pos ? (ht_data.host_read_ptr > ht_data.host_write_ptr)
-                                      : (ht_data.host_read_ptr <= ht_data.host_write_ptr));
+void GpuAgent::PcSamplingDeliver(pcs::PcsRuntime::PcSamplingSession& session, bool flush) {
+  pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
+  const size_t buffer_size = session.buffer_size();
+  const size_t sample_size = session.sample_size();
 
-  if (ht_data.host_buffer_wrap_pos) {
-    assert(ht_data.host_buffer_wrap_pos <= host_buffer_end &&
-           ht_data.host_buffer_wrap_pos > host_buffer_begin);
-    assert(ht_data.host_read_ptr <= ht_data.host_buffer_wrap_pos);
+  /*
+   * Call the client back early enough that it has latency microseconds to provide a buffer
+   * before buffer_size bytes are available, based on the sample rate seen so far.
+   */
+  size_t threshold = sample_size;
+  if (!flush) {
+    size_t ahead = Min(size_t(ht_data.bytes_per_second * session.latency() / 1e6),
+                       buffer_size - sample_size);
+    threshold = buffer_size - (ahead - ahead % sample_size);
+  }
 
-    // Wrapped around
-    bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-    bytes_after_wrap = ht_data.host_write_ptr - host_buffer_begin;
+  std::lock_guard<std::mutex> lock(ht_data.deliver_mutex);
+  while (true) {
+    uint8_t* buf1;
+    uint8_t* buf2;
+    size_t buf1_sz, buf2_sz;
+    PcSamplingPeekHostBuffer(&buf1, &buf1_sz, &buf2, &buf2_sz);
 
-    while (bytes_before_wrap > 0) {
-      size_t bytes_to_copy = std::min(bytes_before_wrap, session.buffer_size());
+    size_t available = buf1_sz + buf2_sz;
+    if (available == 0 || available < threshold) break;
 
-      session.HandleSampleData(ht_data.host_read_ptr, bytes_to_copy, NULL, 0,
-                               ht_data.lost_sample_count);
-      ht_data.host_read_ptr += bytes_to_copy;
-      bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-      ht_data.lost_sample_count = 0;
-    }
+    size_t bytes_to_copy = Min(available, buffer_size);
+    buf1_sz = Min(buf1_sz, bytes_to_copy);
+    buf2_sz = bytes_to_copy - buf1_sz;
+    session.HandleSampleData(buf1, buf1_sz, buf2_sz ? buf2 : NULL, buf2_sz,
+                             ht_data.lost_sample_count.exchange(0, std::memory_order_relaxed));
+    PcSamplingConsumeHostBuffer(bytes_to_copy);
+  }
+}
 
-    assert(ht_data.host_read_ptr == ht_data.host_buffer_wrap_pos);
-    ht_data.host_buffer_wrap_pos = 0;
-    ht_data.host_read_ptr = host_buffer_begin;
+void GpuAgent::PcSamplingThreadRun(void* _agent) {
+  GpuAgent* agent = (GpuAgent*)_agent;
+  agent->PcSamplingThread();
+  debug_print("PcSamplingThread exiting...");
+}
 
-    while (bytes_after_wrap > 0) {
-      size_t bytes_to_copy = std::min(bytes_after_wrap, session.buffer_size());
+hsa_status_t GpuAgent::PcSamplingFlush(pcs::PcsRuntime::PcSamplingSession& session) {
+  pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
 
-      session.HandleSampleData(ht_data.host_read_ptr, bytes_to_copy, NULL, 0,
-                               ht_data.lost_sample_count);
-      ht_data.host_read_ptr += bytes_to_copy;
-      bytes_after_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-      ht_data.lost_sample_count = 0;
-    }
-  } else {
-    bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-
-    while (bytes_before_wrap) {
-      size_t bytes_to_copy = std::min(bytes_before_wrap, session.buffer_size());
-      assert(ht_data.host_read_ptr >= host_buffer_begin &&
-             ht_data.host_read_ptr + bytes_to_copy <= host_buffer_end);
-
-      session.HandleSampleData(ht_data.host_read_ptr, bytes_to_copy, NULL, 0,
-                               ht_data.lost_sample_count);
-      ht_data.host_read_ptr += bytes_to_copy;
-      bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-      ht_data.lost_sample_count = 0;
-    }
+  {
+    std::lock_guard<std::mutex> lock(ht_data.flush_mutex);
+    if (PcSamplingFlushHostTrapDeviceBuffers(session) != HSA_STATUS_SUCCESS)
+      return HSA_STATUS_ERROR;
   }
+
+  if (!session.zero_copy()) PcSamplingDeliver(session, true);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t GpuAgent::PcSamplingDataAcquire(pcs::PcsRuntime::PcSamplingSession& session,
+                                             hsa_ven_amd_pcs_data_view_t* view) {
+  pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
+  if (ht_data.session != &session) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  uint8_t* buf1;
+  uint8_t* buf2;
+  PcSamplingPeekHostBuffer(&buf1, &view->buf1_size, &buf2, &view->buf2_size);
+  view->buf1 = buf1;
+  view->buf2 = buf2;
+  view->lost_sample_count = ht_data.lost_sample_count.exchange(0, std::memory_order_relaxed);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t GpuAgent::PcSamplingDataRelease(pcs::PcsRuntime::PcSamplingSession& session,
+                                             size_t size) {
+  pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
+  if (ht_data.session != &session) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  uint8_t* buf1;
+  uint8_t* buf2;
+  size_t buf1_sz, buf2_sz;
+  PcSamplingPeekHostBuffer(&buf1, &buf1_sz, &buf2, &buf2_sz);
+  if (size > buf1_sz + buf2_sz) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  PcSamplingConsumeHostBuffer(size);
   return HSA_STATUS_SUCCESS;
 }
 
@@ -45,9 +45,12 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <map>
+#include <tuple>
 
 #include "core/inc/amd_gpu_agent.h"
 #include "core/inc/amd_memory_region.h"
+#include "core/inc/runtime.h"
 #include "core/util/os.h"
 
 #include <cstdlib>
@@ -59,12 +62,25 @@
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
 #else
+#include <fcntl.h>
+#include <signal.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
 #endif
 
 namespace rocr {
 namespace {
 
+// Segment uploads are packed into a staging buffer at this alignment.
+const size_t kStagingAlign = 256;
+// The pooled staging arena grows on demand between these bounds; larger
+// uploads use a one-off buffer.
+const size_t kStagingArenaMinSize = 256 * 1024;
+const size_t kStagingArenaMaxRetained = 16 * 1024 * 1024;
+
 class SegmentMemory {
 public:
   virtual ~SegmentMemory() {}
@@ -76,6 +92,13 @@ public:
   virtual void Free() = 0;
   virtual bool Freeze() = 0;
 
+  // Device resident segments are written through a host shadow and uploaded
+  // by LoaderContext::SegmentsFreeze. Returns the agent owning the segment's
+  // memory or nullptr if the segment is frozen in place.
+  virtual AMD::GpuAgent* UploadAgent() const { return nullptr; }
+  virtual size_t Size() const = 0;
+  virtual bool IsCode() const { return false; }
+
 protected:
   SegmentMemory() {}
 
@@ -95,6 +118,8 @@ public:
     { return this->Address(offset); }
   bool Allocated() const override
     { return nullptr != ptr_; }
+  size_t Size() const override
+    { return size_; }
 
   bool Allocate(size_t size, size_t align, bool zero) override;
   bool Copy(size_t offset, const void *src, size_t size) override;
@@ -165,6 +190,8 @@ public:
     { return this->Address(offset); }
   bool Allocated() const override
     { return nullptr != ptr_; }
+  size_t Size() const override
+    { return size_; }
 
   bool Allocate(size_t size, size_t align, bool zero) override;
   bool Copy(size_t offset, const void *src, size_t size) override;
@@ -263,6 +290,11 @@ public:
     { assert(this->Allocated()); return (char*)host_ptr_ + offset; }
   bool Allocated() const override
     { return nullptr != ptr_; }
+  size_t Size() const override
+    { return size_; }
+  bool IsCode() const override
+    { return is_code_; }
+  AMD::GpuAgent* UploadAgent() const override;
 
   bool Allocate(size_t size, size_t align, bool zero) override;
   bool Copy(size_t offset, const void *src, size_t size) override;
@@ -299,6 +331,13 @@ const core::MemoryRegion* RegionMemory::System(bool is_code) {
     return core::Runtime::runtime_singleton_->system_regions_fine()[0];
 }
 
+AMD::GpuAgent* RegionMemory::UploadAgent() const {
+  core::Agent* agent = region_->owner();
+  if (agent != nullptr && agent->device_type() == core::Agent::kAmdGpuDevice)
+    return static_cast<AMD::GpuAgent*>(agent);
+  return nullptr;
+}
+
 bool RegionMemory::Allocate(size_t size, size_t align, bool zero) {
   assert(!this->Allocated());
   assert(0 < size);
@@ -311,13 +350,17 @@ bool RegionMemory::Allocate(size_t size, size_t align, bool zero) {
     return false;
   }
   assert(0 == ((uintptr_t)ptr_) % align);
-  if (HSA_STATUS_SUCCESS !=
-      core::Runtime::runtime_singleton_->AllocateMemory(
-          RegionMemory::System(false), size, core::MemoryRegion::AllocateNoFlags, &host_ptr_)) {
-    HSA::hsa_memory_free(ptr_);
-    ptr_ = nullptr;
-    host_ptr_ = nullptr;
-    return false;
+  // Host visible segments are written in place. Device segments keep a plain
+  // host shadow which is staged and uploaded when the executable is frozen.
+  if (UploadAgent() == nullptr) {
+    host_ptr_ = ptr_;
+  } else {
+    host_ptr_ = _aligned_malloc(size, align);
+    if (nullptr == host_ptr_) {
+      HSA::hsa_memory_free(ptr_);
+      ptr_ = nullptr;
+      return false;
+    }
   }
   if (zero) {
     memset(host_ptr_, 0x0, size);
@@ -337,34 +380,122 @@ bool RegionMemory::Copy(size_t offset, const void* src, size_t size) {
 void RegionMemory::Free()
 {
   assert(this->Allocated());
-  HSA::hsa_memory_free(ptr_);
-  if (nullptr != host_ptr_) {
-    HSA::hsa_memory_free(host_ptr_);
+  if (nullptr != host_ptr_ && host_ptr_ != ptr_) {
+    _aligned_free(host_ptr_);
   }
+  HSA::hsa_memory_free(ptr_);
   ptr_ = nullptr;
   host_ptr_ = nullptr;
   size_ = 0;
 }
 
 bool RegionMemory::Freeze() {
-  assert(this->Allocated() && nullptr != host_ptr_);
+  // Device resident segments are uploaded by LoaderContext::SegmentsFreeze.
+  assert(this->Allocated() && UploadAgent() == nullptr);
+  return true;
+}
 
-  core::Agent* agent = region_->owner();
-  if (agent != NULL && agent->device_type() == core::Agent::kAmdGpuDevice) {
-    if (HSA_STATUS_SUCCESS != agent->DmaCopy(ptr_, host_ptr_, size_)) {
-      return false;
-    }
-  } else {
-    memcpy(ptr_, host_ptr_, size_);
-  }
+// Frozen code segment attached from another process, with a host copy of its
+// content for host address queries.
+class ImportedMemory final: public SegmentMemory {
+public:
+  ImportedMemory(): SegmentMemory(), ptr_(nullptr), host_ptr_(nullptr), size_(0) {}
+  ~ImportedMemory() {}
 
-  // Invalidate agent caches which may hold lines of the new allocation.
-  if (is_code_ && (region_->owner()->device_type() == core::Agent::kAmdGpuDevice))
-    ((AMD::GpuAgent*)region_->owner())->InvalidateCodeCaches();
+  void* Address(size_t offset = 0) const override
+    { assert(this->Allocated()); return (char*)ptr_ + offset; }
+  void* HostAddress(size_t offset = 0) const override
+    { assert(this->Allocated()); return (char*)host_ptr_ + offset; }
+  bool Allocated() const override
+    { return nullptr != ptr_; }
+  size_t Size() const override
+    { return size_; }
+  bool IsCode() const override
+    { return true; }
+
+  bool Allocate(size_t size, size_t align, bool zero) override
+    { assert(false && "Imported segments are not allocated."); return false; }
+  bool Copy(size_t offset, const void *src, size_t size) override
+    { assert(false && "Imported segments are read-only."); return false; }
+  bool Freeze() override
+    { return true; }
+
+  bool Attach(const hsa_amd_ipc_memory_t& handle, core::Agent* agent, size_t size);
+  void Free() override;
 
+private:
+  ImportedMemory(const ImportedMemory&);
+  ImportedMemory& operator=(const ImportedMemory&);
+
+  void *ptr_;
+  void *host_ptr_;
+  size_t size_;
+};
+
+bool ImportedMemory::Attach(const hsa_amd_ipc_memory_t& handle, core::Agent* agent, size_t size) {
+  assert(!this->Allocated());
+  if (HSA_STATUS_SUCCESS !=
+      core::Runtime::runtime_singleton_->IPCAttach(&handle, size, 1, &agent, &ptr_)) {
+    ptr_ = nullptr;
+    return false;
+  }
+  host_ptr_ = malloc(size);
+  if (nullptr == host_ptr_ || HSA_STATUS_SUCCESS != HSA::hsa_memory_copy(host_ptr_, ptr_, size)) {
+    free(host_ptr_);
+    host_ptr_ = nullptr;
+    core::Runtime::runtime_singleton_->IPCDetach(ptr_);
+    ptr_ = nullptr;
+    return false;
+  }
+  size_ = size;
   return true;
 }
 
+void ImportedMemory::Free() {
+  assert(this->Allocated());
+  free(host_ptr_);
+  core::Runtime::runtime_singleton_->IPCDetach(ptr_);
+  ptr_ = nullptr;
+  host_ptr_ = nullptr;
+  size_ = 0;
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// Node wide registry entry of a published code segment, stored in a file
+// named after the device and the content key.
+const uint32_t kSharedSegmentMagic = 0x53534348;  // "HCSS"
+const uint32_t kSharedSegmentVersion = 1;
+
+struct SharedSegmentRecord {
+  uint32_t magic;
+  uint32_t version;
+  int32_t pid;
+  uint32_t reserved;
+  uint64_t size;
+  uint64_t hash[2];
+  uint64_t image_size;
+  hsa_amd_ipc_memory_t handle;
+};
+
+std::string SharedSegmentRegistryPath(hsa_agent_t agent,
+                                      const amd::hsa::loader::SegmentContentKey& key) {
+  // Node ids depend on ROCR_VISIBLE_DEVICES, identify the device by its PCI
+  // location and render node instead.
+  const HsaNodeProperties& props =
+      static_cast<AMD::GpuAgent*>(core::Agent::Convert(agent))->properties();
+  char name[160];
+  snprintf(name, sizeof(name), "/dev/shm/hsa_code_%u_%x_%x_%x_%016lx%016lx",
+           static_cast<unsigned>(geteuid()), props.Domain, props.LocationId,
+           props.DrmRenderMinor, static_cast<unsigned long>(key.hash[0]),
+           static_cast<unsigned long>(key.hash[1]));
+  return name;
+}
+
+bool ProcessAlive(int32_t pid) {
+  return kill(pid, 0) == 0 || errno != ESRCH;
+}
+#endif
+
 }  // namespace anonymous
 namespace amd {
 
@@ -386,29 +517,16 @@ hsa_isa_t LoaderContext::IsaFromName(const char *name) {
 
 bool LoaderContext::IsaSupportedByAgent(hsa_agent_t agent,
                                         hsa_isa_t code_object_isa) {
-  std::pair<hsa_isa_t, bool> comparison_data(code_object_isa, false);
-  auto IsIsaEquivalent = [](hsa_isa_t agent_isa_h, void *data) {
-    assert(data);
-
-    std::pair<hsa_isa_t, bool> *data_pair =
-        reinterpret_cast<decltype(&comparison_data)>(data);
-    assert(data_pair);
-    assert(data_pair->second != true);
-
-    const core::Isa *agent_isa = core::Isa::Object(agent_isa_h);
-    assert(agent_isa);
-    const core::Isa *code_object_isa = core::Isa::Object(data_pair->first);
-    assert(code_object_isa);
-
-    data_pair->second = core::Isa::IsCompatible(*code_object_isa, *agent_isa);
-    return data_pair->second ? HSA_STATUS_INFO_BREAK : HSA_STATUS_SUCCESS;
-  };
-
-  hsa_status_t status = HSA::hsa_agent_iterate_isas(agent, IsIsaEquivalent, &comparison_data);
-  if (status != HSA_STATUS_SUCCESS && status != HSA_STATUS_INFO_BREAK) {
+  const core::Agent *agent_object = core::Agent::Convert(agent);
+  if (agent_object == nullptr || !agent_object->IsValid()) {
     return false;
   }
-  return comparison_data.second;
+  const core::Isa *agent_isa = agent_object->isa();
+  const core::Isa *code_object_isa_object = core::Isa::Object(code_object_isa);
+  if (agent_isa == nullptr || code_object_isa_object == nullptr) {
+    return false;
+  }
+  return core::Isa::IsCompatible(*code_object_isa_object, *agent_isa);
 }
 
 void* LoaderContext::SegmentAlloc(amdgpu_hsa_elf_segment_t segment,
@@ -492,6 +610,18 @@ void LoaderContext::SegmentFree(amdgpu_hsa_elf_segment_t segment, // not used.
                                 size_t size)                      // not used.
 {
   assert(nullptr != seg);
+  {
+    ScopedAcquire<KernelMutex> lock(&shared_segments_lock_);
+    auto shared = shared_segments_.find(seg);
+    if (shared != shared_segments_.end()) {
+      if (--shared->second.refcount != 0) return;
+#if !defined(_WIN32) && !defined(_WIN64)
+      if (!shared->second.registry.empty()) unlink(shared->second.registry.c_str());
+#endif
+      shared_segment_ids_.erase(shared->second.id);
+      shared_segments_.erase(shared);
+    }
+  }
   SegmentMemory *mem = (SegmentMemory*)seg;
   mem->Free();
   delete mem;
@@ -516,13 +646,250 @@ void* LoaderContext::SegmentHostAddress(amdgpu_hsa_elf_segment_t segment, // not
   return ((SegmentMemory*)seg)->HostAddress(offset);
 }
 
-bool LoaderContext::SegmentFreeze(amdgpu_hsa_elf_segment_t segment, // not used.
-                                  hsa_agent_t agent,                // not used.
+bool LoaderContext::SegmentFreeze(amdgpu_hsa_elf_segment_t segment,
+                                  hsa_agent_t agent,
                                   void* seg,
-                                  size_t size)                      // not used.
+                                  size_t size)
 {
   assert(nullptr != seg);
-  return ((SegmentMemory*)seg)->Freeze();
+  return SegmentsFreeze({{segment, agent, seg, size}});
+}
+
+bool LoaderContext::SegmentsFreeze(const std::vector<hsa::loader::SegmentFreezeInfo>& segs) {
+  // Gather device resident segments per agent, freeze the rest in place.
+  std::map<AMD::GpuAgent*, std::vector<SegmentMemory*>> uploads;
+  size_t staging_size = 0;
+  for (const auto& info : segs) {
+    assert(nullptr != info.seg);
+    SegmentMemory* mem = (SegmentMemory*)info.seg;
+    AMD::GpuAgent* agent = mem->UploadAgent();
+    if (agent == nullptr) {
+      if (!mem->Freeze()) return false;
+      continue;
+    }
+    uploads[agent].push_back(mem);
+    staging_size += AlignUp(mem->Size(), kStagingAlign);
+  }
+  if (uploads.empty()) return true;
+
+  ScopedAcquire<KernelMutex> lock(&staging_lock_);
+  void* staging = AcquireStaging(staging_size);
+  if (staging == nullptr) return false;
+  MAKE_SCOPE_GUARD([&]() { ReleaseStaging(staging); });
+
+  size_t offset = 0;
+  for (auto& agent_uploads : uploads) {
+    AMD::GpuAgent* agent = agent_uploads.first;
+    std::vector<std::tuple<void*, const void*, size_t>> copies;
+    bool has_code = false;
+    for (SegmentMemory* mem : agent_uploads.second) {
+      void* staged = (char*)staging + offset;
+      memcpy(staged, mem->HostAddress(), mem->Size());
+      copies.emplace_back(mem->Address(), staged, mem->Size());
+      has_code |= mem->IsCode();
+      offset += AlignUp(mem->Size(), kStagingAlign);
+    }
+
+    if (HSA_STATUS_SUCCESS != agent->DmaCopyBatch(copies)) return false;
+
+    // Invalidate agent caches which may hold lines of the new allocations.
+    if (has_code) agent->InvalidateCodeCaches();
+  }
+
+  return true;
+}
+
+void* LoaderContext::AcquireStaging(size_t size) {
+  const core::MemoryRegion* system = RegionMemory::System(false);
+
+  // Requests beyond the retained arena size get a one-off buffer.
+  if (size > kStagingArenaMaxRetained) {
+    void* buffer = nullptr;
+    if (HSA_STATUS_SUCCESS !=
+        core::Runtime::runtime_singleton_->AllocateMemory(
+            system, size, core::MemoryRegion::AllocateNoFlags, &buffer))
+      return nullptr;
+    return buffer;
+  }
+
+  if (staging_arena_size_ < size) {
+    if (staging_arena_ != nullptr) HSA::hsa_memory_free(staging_arena_);
+    staging_arena_ = nullptr;
+    staging_arena_size_ = 0;
+    size_t arena_size = std::min(std::max(size, kStagingArenaMinSize), kStagingArenaMaxRetained);
+    if (HSA_STATUS_SUCCESS !=
+        core::Runtime::runtime_singleton_->AllocateMemory(
+            system, arena_size, core::MemoryRegion::AllocateNoFlags, &staging_arena_)) {
+      staging_arena_ = nullptr;
+      return nullptr;
+    }
+    staging_arena_size_ = arena_size;
+  }
+  return staging_arena_;
+}
+
+void LoaderContext::ReleaseStaging(void* staging) {
+  if (staging != staging_arena_) HSA::hsa_memory_free(staging);
+}
+
+void LoaderContext::ReleaseStagingArena() {
+  ScopedAcquire<KernelMutex> lock(&staging_lock_);
+  if (staging_arena_ != nullptr) HSA::hsa_memory_free(staging_arena_);
+  staging_arena_ = nullptr;
+  staging_arena_size_ = 0;
+}
+
+bool LoaderContext::SegmentSharingSupported(hsa_agent_t agent) {
+  const Flag& flag = core::Runtime::runtime_singleton_->flag();
+  // Breakpoints set in shared code would trap in every executable using it.
+  if (flag.share_code_segments() == Flag::SHARE_CODE_NONE || flag.debug()) return false;
+  core::Agent* core_agent = core::Agent::Convert(agent);
+  return core_agent != nullptr && core_agent->device_type() == core::Agent::kAmdGpuDevice;
+}
+
+LoaderContext::SharedSegmentId LoaderContext::MakeSharedSegmentId(
+    hsa_agent_t agent, size_t size, const hsa::loader::SegmentContentKey& key) {
+  return std::make_tuple(agent.handle, key.hash[0], key.hash[1], key.image_size, size);
+}
+
+void* LoaderContext::SegmentAcquireShared(amdgpu_hsa_elf_segment_t segment,
+                                          hsa_agent_t agent, size_t size,
+                                          const hsa::loader::SegmentContentKey& key) {
+  if (segment != AMDGPU_HSA_SEGMENT_CODE_AGENT) return nullptr;
+
+  ScopedAcquire<KernelMutex> lock(&shared_segments_lock_);
+  SharedSegmentId id = MakeSharedSegmentId(agent, size, key);
+  auto existing = shared_segment_ids_.find(id);
+  if (existing != shared_segment_ids_.end()) {
+    shared_segments_[existing->second].refcount++;
+    return existing->second;
+  }
+
+  if (!key.position_independent ||
+      core::Runtime::runtime_singleton_->flag().share_code_segments() != Flag::SHARE_CODE_NODE) {
+    return nullptr;
+  }
+  void* seg = ImportSharedSegment(agent, size, key);
+  if (seg == nullptr) return nullptr;
+  shared_segment_ids_[id] = seg;
+  SharedSegment& shared = shared_segments_[seg];
+  shared.id = id;
+  shared.refcount = 1;
+  return seg;
+}
+
+void LoaderContext::SegmentShare(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent,
+                                 void* seg, size_t size,
+                                 const hsa::loader::SegmentContentKey& key) {
+  assert(nullptr != seg);
+  if (segment != AMDGPU_HSA_SEGMENT_CODE_AGENT) return;
+
+  ScopedAcquire<KernelMutex> lock(&shared_segments_lock_);
+  SharedSegmentId id = MakeSharedSegmentId(agent, size, key);
+  // Loads racing to share the same content keep their private copies.
+  if (shared_segment_ids_.find(id) != shared_segment_ids_.end()) return;
+  assert(shared_segments_.find(seg) == shared_segments_.end());
+
+  shared_segment_ids_[id] = seg;
+  SharedSegment& shared = shared_segments_[seg];
+  shared.id = id;
+  shared.refcount = 1;
+  if (key.position_independent &&
+      core::Runtime::runtime_singleton_->flag().share_code_segments() == Flag::SHARE_CODE_NODE) {
+    shared.registry = PublishSharedSegment(agent, seg, size, key);
+  }
+}
+
+void* LoaderContext::ImportSharedSegment(hsa_agent_t agent, size_t size,
+                                         const hsa::loader::SegmentContentKey& key) {
+#if defined(_WIN32) || defined(_WIN64)
+  return nullptr;
+#else
+  std::string path = SharedSegmentRegistryPath(agent, key);
+  int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+
+  // Only trust entries private to this user.
+  struct stat st;
+  SharedSegmentRecord record;
+  bool valid = fstat(fd, &st) == 0 && st.st_uid == geteuid() && (st.st_mode & 077) == 0 &&
+      read(fd, &record, sizeof(record)) == sizeof(record);
+  close(fd);
+  valid = valid && record.magic == kSharedSegmentMagic &&
+      record.version == kSharedSegmentVersion && record.size == size &&
+      record.hash[0] == key.hash[0] && record.hash[1] == key.hash[1] &&
+      record.image_size == key.image_size;
+  if (!valid) return nullptr;
+
+  ImportedMemory* mem = new (std::nothrow) ImportedMemory();
+  if (mem == nullptr) return nullptr;
+  if (!mem->Attach(record.handle, core::Agent::Convert(agent), size)) {
+    delete mem;
+    // The publisher exited without withdrawing the entry.
+    if (!ProcessAlive(record.pid)) unlink(path.c_str());
+    return nullptr;
+  }
+  return mem;
+#endif
+}
+
+std::string LoaderContext::PublishSharedSegment(hsa_agent_t agent, void* seg, size_t size,
+                                                const hsa::loader::SegmentContentKey& key) {
+#if defined(_WIN32) || defined(_WIN64)
+  return std::string();
+#else
+  // Only device allocations made by this process can be exported.
+  SegmentMemory* mem = (SegmentMemory*)seg;
+  if (mem->UploadAgent() == nullptr) return std::string();
+
+  SharedSegmentRecord record;
+  memset(&record, 0, sizeof(record));
+  record.magic = kSharedSegmentMagic;
+  record.version = kSharedSegmentVersion;
+  record.pid = getpid();
+  record.size = size;
+  record.hash[0] = key.hash[0];
+  record.hash[1] = key.hash[1];
+  record.image_size = key.image_size;
+  if (HSA_STATUS_SUCCESS !=
+      core::Runtime::runtime_singleton_->IPCCreate(mem->Address(), mem->Size(), &record.handle))
+    return std::string();
+
+  // Write a private file and link it into place so that readers never see a
+  // partial record and concurrent publishers do not overwrite each other.
+  std::string path = SharedSegmentRegistryPath(agent, key);
+  std::string tmp = path + "." + std::to_string(getpid());
+  int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) return std::string();
+  bool written = write(fd, &record, sizeof(record)) == sizeof(record);
+  close(fd);
+
+  bool linked = written && link(tmp.c_str(), path.c_str()) == 0;
+  if (written && !linked && errno == EEXIST) {
+    // Replace the entry of a publisher which exited without withdrawing it.
+    SharedSegmentRecord stale;
+    fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd >= 0) {
+      if (read(fd, &stale, sizeof(stale)) == sizeof(stale) && !ProcessAlive(stale.pid)) {
+        unlink(path.c_str());
+        linked = link(tmp.c_str(), path.c_str()) == 0;
+      }
+      close(fd);
+    }
+  }
+  unlink(tmp.c_str());
+  return linked ? path : std::string();
+#endif
+}
+
+void LoaderContext::ReleaseSharedSegments() {
+  ScopedAcquire<KernelMutex> lock(&shared_segments_lock_);
+  for (auto& shared : shared_segments_) {
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (!shared.second.registry.empty()) unlink(shared.second.registry.c_str());
+#endif
+    shared.second.registry.clear();
+  }
 }
 
 bool LoaderContext::ImageExtensionSupported() {
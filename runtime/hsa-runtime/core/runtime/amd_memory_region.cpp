@@ -47,6 +47,7 @@
 #include "core/inc/runtime.h"
 #include "core/inc/amd_cpu_agent.h"
 #include "core/inc/amd_gpu_agent.h"
+#include "core/inc/amd_ordered_pool.h"
 #include "core/util/utils.h"
 #include "core/inc/exceptions.h"
 #include <unistd.h>
@@ -149,15 +150,58 @@ MemoryRegion::MemoryRegion(bool fine_grain, bool kernarg, bool full_profile,
 
   assert(GetVirtualSize() != 0);
   assert(IsMultipleOf(max_single_alloc_size_, kPageSize()));
+
+  const size_t zeroed_pool_size = core::Runtime::runtime_singleton_->flag().zeroed_pool_size();
+  if (IsLocalMemory() && zeroed_pool_size != 0) {
+    zeroed_pool_.reset(new ZeroedBlockPool(*this, zeroed_pool_size));
+  }
 }
 
-MemoryRegion::~MemoryRegion() {}
+MemoryRegion::~MemoryRegion() { ReleaseZeroedPool(); }
 
 hsa_status_t MemoryRegion::Allocate(size_t& size, AllocateFlags alloc_flags, void** address, int agent_node_id) const {
+  if (alloc_flags & AllocateZeroed)
+    return AllocateZeroFilled(size, alloc_flags & ~AllocateZeroed, address, agent_node_id);
+
   ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
   return AllocateImpl(size, alloc_flags, address, agent_node_id);
 }
 
+hsa_status_t MemoryRegion::AllocateZeroFilled(size_t& size, AllocateFlags alloc_flags,
+                                              void** address, int agent_node_id) const {
+  if (address == NULL) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  {
+    ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+
+    // New system memory pages are zeroed by the kernel.
+    if (!IsLocalMemory()) return AllocateImpl(size, alloc_flags, address, agent_node_id);
+
+    // Only plain allocations are interchangeable with pool blocks.
+    if (zeroed_pool_ != nullptr && alloc_flags == AllocateRestrict &&
+        size <= max_single_alloc_size_) {
+      *address = zeroed_pool_->Acquire(AlignUp(size, kPageSize()));
+      if (*address != nullptr) {
+        size = AlignUp(size, kPageSize());
+        return HSA_STATUS_SUCCESS;
+      }
+    }
+
+    hsa_status_t err = AllocateImpl(size, alloc_flags, address, agent_node_id);
+    if (err != HSA_STATUS_SUCCESS) return err;
+  }
+
+  // Pool miss, zero outside the allocation lock.
+  hsa_status_t err = owner()->DmaFill(*address, 0, size / sizeof(uint32_t));
+  if (err != HSA_STATUS_SUCCESS) {
+    Free(*address, size);
+    *address = nullptr;
+  }
+  return err;
+}
+
 hsa_status_t MemoryRegion::AllocateImpl(size_t& size, AllocateFlags alloc_flags,
                                         void** address, int agent_node_id) const {
   if (address == NULL) {
@@ -177,6 +221,14 @@ hsa_status_t MemoryRegion::AllocateImpl(size_t& size, AllocateFlags alloc_flags,
 
   size = AlignUp(size, kPageSize());
 
+  // Huge page backed system memory must be a whole number of huge pages.
+  if (IsSystem()) {
+    if (alloc_flags & AllocateHugePage1GB)
+      size = AlignUp(size, 1UL << 30);
+    else if (alloc_flags & AllocateHugePage2MB)
+      size = AlignUp(size, 2UL << 20);
+  }
+
   return core::Runtime::runtime_singleton_->AgentDriver(owner()->driver_type)
       .AllocateMemory(*this, alloc_flags, address, size, agent_node_id);
 }
@@ -186,6 +238,35 @@ hsa_status_t MemoryRegion::Free(void* address, size_t size) const {
   return FreeImpl(address, size);
 }
 
+void MemoryRegion::FreeBatch(const std::vector<std::pair<void*, size_t>>& blocks,
+                             std::vector<hsa_status_t>& status) const {
+  status.assign(blocks.size(), HSA_STATUS_SUCCESS);
+
+  ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+
+  // Fragments go back to their heap block, which stays mapped.  Everything
+  // else is a whole KFD allocation.
+  std::vector<HsaMemMapRange> ranges;
+  std::vector<size_t> index;
+  for (size_t i = 0; i < blocks.size(); i++) {
+    if (fragment_allocator_.free(blocks[i].first)) continue;
+    HsaMemMapRange range = {};
+    range.MemoryAddress = blocks[i].first;
+    range.MemorySizeInBytes = blocks[i].second;
+    ranges.push_back(range);
+    index.push_back(i);
+  }
+
+  // Unmap all blocks in one thunk call.  Failures are left for FreeMemory,
+  // whose own unmap is a no-op for blocks that are already unmapped.
+  if (owner()->driver_type == core::DriverType::KFD && ranges.size() > 1)
+    hsaKmtUnmapMemoryToGPUBatch(&ranges[0], ranges.size());
+
+  auto& driver = core::Runtime::runtime_singleton_->AgentDriver(owner()->driver_type);
+  for (size_t i = 0; i < ranges.size(); i++)
+    status[index[i]] = driver.FreeMemory(ranges[i].MemoryAddress, ranges[i].MemorySizeInBytes);
+}
+
 hsa_status_t MemoryRegion::FreeImpl(void* address, size_t size) const {
   if (fragment_allocator_.free(address)) return HSA_STATUS_SUCCESS;
 
@@ -658,7 +739,42 @@ hsa_status_t MemoryRegion::AssignAgent(void* ptr, size_t size,
   return HSA_STATUS_SUCCESS;
 }
 
-void MemoryRegion::Trim() const { fragment_allocator_.trim(); }
+void MemoryRegion::Trim() const {
+  if (zeroed_pool_ != nullptr) {
+    std::vector<std::pair<void*, size_t>> blocks;
+    zeroed_pool_->TakeAll(&blocks);
+    for (auto& block : blocks) FreeImpl(block.first, block.second);
+  }
+
+  {
+    ScopedAcquire<KernelMutex> lock(&ordered_pools_lock_);
+    std::vector<std::pair<void*, size_t>> blocks;
+    for (OrderedPool* pool : ordered_pools_) pool->TakeIdleBlocks(&blocks);
+    for (auto& block : blocks) FreeImpl(block.first, block.second);
+  }
+  fragment_allocator_.trim();
+}
+
+void MemoryRegion::AddOrderedPool(OrderedPool* pool) const {
+  ScopedAcquire<KernelMutex> lock(&ordered_pools_lock_);
+  ordered_pools_.push_back(pool);
+}
+
+void MemoryRegion::RemoveOrderedPool(OrderedPool* pool) const {
+  ScopedAcquire<KernelMutex> lock(&ordered_pools_lock_);
+  ordered_pools_.erase(std::remove(ordered_pools_.begin(), ordered_pools_.end(), pool),
+                       ordered_pools_.end());
+}
+
+void MemoryRegion::ReleaseZeroedPool() const {
+  if (zeroed_pool_ == nullptr) return;
+
+  zeroed_pool_->Stop();
+  ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+  std::vector<std::pair<void*, size_t>> blocks;
+  zeroed_pool_->TakeAll(&blocks);
+  for (auto& block : blocks) FreeImpl(block.first, block.second);
+}
 
 void* MemoryRegion::BlockAllocator::alloc(size_t request_size, size_t& allocated_size) const {
   void* ret;
@@ -0,0 +1,207 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/inc/amd_ordered_pool.h"
+
+#include <algorithm>
+
+#include "core/inc/amd_memory_region.h"
+#include "core/inc/exceptions.h"
+#include "core/inc/signal.h"
+
+namespace rocr {
+namespace AMD {
+
+static const size_t kBlockAlignment = 2 * 1024 * 1024;
+
+void* OrderedPool::BlockAllocator::alloc(size_t request_size, size_t& allocated_size) const {
+  const MemoryRegion& region = pool_.region_;
+  size_t size = std::max(AlignUp(request_size, kBlockAlignment), kMinBlockSize);
+  void* block = nullptr;
+
+  hsa_status_t err = region.Allocate(size, core::MemoryRegion::AllocateRestrict, &block, 0);
+  if (err != HSA_STATUS_SUCCESS && size > request_size) {
+    // The minimum block may not fit, try the request alone.
+    size = request_size;
+    err = region.Allocate(size, core::MemoryRegion::AllocateRestrict, &block, 0);
+  }
+  if (err != HSA_STATUS_SUCCESS) throw hsa_exception(err, "Ordered pool block allocation failed.");
+
+  if (!pool_.access_.empty()) {
+    err = region.AllowAccess(pool_.access_.size(), &pool_.access_[0], block, size);
+    if (err != HSA_STATUS_SUCCESS) {
+      region.Free(block, size);
+      throw hsa_exception(err, "Ordered pool block access failed.");
+    }
+  }
+
+  allocated_size = size;
+  return block;
+}
+
+void OrderedPool::BlockAllocator::free(void* ptr, size_t length) const {
+  if (pool_.taken_ != nullptr) {
+    pool_.taken_->emplace_back(ptr, length);
+    return;
+  }
+  pool_.region_.Free(ptr, length);
+}
+
+OrderedPool::OrderedPool(const MemoryRegion& region, const std::vector<hsa_agent_t>& access)
+    : region_(region), access_(access), heap_(BlockAllocator(*this)), taken_(nullptr) {
+  region_.AddOrderedPool(this);
+}
+
+OrderedPool::~OrderedPool() {
+  region_.RemoveOrderedPool(this);
+  for (auto& pending : pending_) pending.second.release->Release();
+  pending_.clear();
+  heap_.trim();
+}
+
+void OrderedPool::Retire() {
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    core::Signal* release = it->second.release;
+    // A destroyed signal can't be waited on anymore, treat it as complete.
+    if (release->IsValid() && release->LoadRelaxed() != 0) {
+      it++;
+      continue;
+    }
+    heap_.free(it->second.ptr);
+    release->Release();
+    it = pending_.erase(it);
+  }
+}
+
+hsa_status_t OrderedPool::Allocate(size_t size, void** ptr, hsa_signal_t* dependency) {
+  size = AlignUp(size, kAlignment);
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  Retire();
+
+  if (dependency != nullptr) {
+    dependency->handle = 0;
+
+    // Reuse a pending free if the caller can order after its release.  Don't hand out frees
+    // much larger than needed, they are better returned to the heap for splitting.
+    auto it = pending_.lower_bound(size);
+    if (it != pending_.end() && it->first <= size * 2) {
+      *ptr = it->second.ptr;
+      live_[*ptr] = it->first;
+      *dependency = core::Signal::Convert(it->second.release);
+      it->second.release->Release();
+      pending_.erase(it);
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
+  // On failure release cached blocks and retry once.
+  for (bool retry = true;; retry = false) {
+    try {
+      *ptr = heap_.alloc(size);
+      break;
+    } catch (const hsa_exception& e) {
+      if (!retry || heap_.cache_size() == 0) return e.error_code();
+      heap_.trim();
+    }
+  }
+
+  live_[*ptr] = size;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t OrderedPool::Free(void* ptr, hsa_signal_t release) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+
+  auto it = live_.find(ptr);
+  if (it == live_.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+  const size_t size = it->second;
+  live_.erase(it);
+
+  if (release.handle == 0) {
+    heap_.free(ptr);
+  } else {
+    core::Signal* signal = core::Signal::Convert(release);
+    signal->Retain();
+    pending_.insert(std::make_pair(size, PendingFree{ptr, signal}));
+  }
+
+  Retire();
+  return HSA_STATUS_SUCCESS;
+}
+
+void OrderedPool::Trim(size_t keep) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  Retire();
+  heap_.trim(keep);
+}
+
+void OrderedPool::SetReleaseThreshold(size_t bytes) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  heap_.set_cache_floor(bytes);
+}
+
+void OrderedPool::TakeIdleBlocks(std::vector<std::pair<void*, size_t>>* blocks) {
+  if (!lock_.Try()) return;
+  MAKE_SCOPE_GUARD([&]() { lock_.Release(); });
+
+  taken_ = blocks;
+  Retire();
+  heap_.trim();
+  taken_ = nullptr;
+}
+
+hsa_status_t OrderedPool::Drain() {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  if (!live_.empty()) return HSA_STATUS_ERROR_RESOURCE_FREE;
+
+  for (auto& pending : pending_) {
+    core::Signal* release = pending.second.release;
+    if (release->IsValid())
+      release->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, uint64_t(-1), HSA_WAIT_STATE_BLOCKED);
+  }
+  Retire();
+  return HSA_STATUS_SUCCESS;
+}
+
+}  // namespace AMD
+}  // namespace rocr
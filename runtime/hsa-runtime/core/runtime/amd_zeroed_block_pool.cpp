@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/inc/amd_zeroed_block_pool.h"
+
+#include <algorithm>
+
+#include "core/inc/agent.h"
+#include "core/inc/amd_memory_region.h"
+#include "core/inc/exceptions.h"
+
+namespace rocr {
+namespace AMD {
+
+ZeroedBlockPool::ZeroedBlockPool(const MemoryRegion& region, size_t max_bytes)
+    : region_(region), max_bytes_(max_bytes), cached_bytes_(0), worker_(nullptr), exit_(false) {}
+
+ZeroedBlockPool::~ZeroedBlockPool() {
+  Stop();
+  assert(blocks_.empty() && "Zeroed blocks leaked.");
+}
+
+void* ZeroedBlockPool::Acquire(size_t size) {
+  if (size > max_bytes_ / 4) return nullptr;
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  if (exit_) return nullptr;
+
+  void* block = nullptr;
+  auto it = blocks_.find(size);
+  if (it != blocks_.end()) {
+    block = it->second;
+    blocks_.erase(it);
+    cached_bytes_ -= size;
+  } else if (wanted_.find(size) == wanted_.end()) {
+    // Only cache sizes which recur, a size missing for the first time is
+    // remembered instead.
+    auto miss = std::find(recent_misses_.begin(), recent_misses_.end(), size);
+    if (miss == recent_misses_.end()) {
+      if (recent_misses_.size() == kMissHistory) recent_misses_.pop_front();
+      recent_misses_.push_back(size);
+      return nullptr;
+    }
+    recent_misses_.erase(miss);
+  }
+
+  // Replace the block just handed out, keeping at most kMaxBlocksPerSize.
+  auto want = wanted_.find(size);
+  uint32_t pending = (want == wanted_.end()) ? 0 : want->second;
+  if (blocks_.count(size) + pending < kMaxBlocksPerSize) wanted_[size] = pending + 1;
+
+  if (worker_ == nullptr) {
+    worker_ = os::CreateThread(WorkerRun, this);
+    if (worker_ == nullptr) {
+      // Still serve the blocks we have, but never refill.
+      wanted_.clear();
+      return block;
+    }
+  }
+  wake_.Set();
+
+  return block;
+}
+
+size_t ZeroedBlockPool::cached_bytes() const {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  return cached_bytes_;
+}
+
+void ZeroedBlockPool::TakeAll(std::vector<std::pair<void*, size_t>>* blocks) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  for (auto& block : blocks_) {
+    blocks->emplace_back(block.second, block.first);
+    cached_bytes_ -= block.first;
+  }
+  blocks_.clear();
+}
+
+void ZeroedBlockPool::Stop() {
+  {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    exit_ = true;
+    wanted_.clear();
+  }
+
+  if (worker_ != nullptr) {
+    wake_.Set();
+    os::WaitForThread(worker_);
+    os::CloseThread(worker_);
+    worker_ = nullptr;
+  }
+}
+
+void ZeroedBlockPool::WorkerRun(void* arg) {
+  ZeroedBlockPool* pool = reinterpret_cast<ZeroedBlockPool*>(arg);
+
+  while (true) {
+    pool->wake_.WaitForSet();
+    {
+      ScopedAcquire<KernelMutex> lock(&pool->lock_);
+      if (pool->exit_) return;
+    }
+    pool->Refill();
+  }
+}
+
+void ZeroedBlockPool::Refill() {
+  while (true) {
+    size_t size;
+    {
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      if (exit_ || wanted_.empty()) return;
+
+      auto it = wanted_.begin();
+      size = it->first;
+      if (--it->second == 0) wanted_.erase(it);
+
+      if (cached_bytes_ + size > max_bytes_) continue;
+      cached_bytes_ += size;
+    }
+
+    // Allocate as an ordinary allocation would, so the block is freed the
+    // same way once handed out.
+    void* block = nullptr;
+    size_t alloc_size = size;
+    hsa_status_t err;
+    try {
+      err = region_.Allocate(alloc_size, core::MemoryRegion::AllocateRestrict, &block);
+    } catch (const hsa_exception& e) {
+      err = e.error_code();
+    }
+    if (err == HSA_STATUS_SUCCESS) {
+      err = region_.owner()->DmaFill(block, 0, size / sizeof(uint32_t));
+      if (err != HSA_STATUS_SUCCESS) region_.Free(block, size);
+    }
+
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    if (err != HSA_STATUS_SUCCESS) {
+      // Out of memory or SDMA unavailable, stop refilling this size.
+      cached_bytes_ -= size;
+      wanted_.erase(size);
+      continue;
+    }
+    blocks_.emplace(size, block);
+  }
+}
+
+}  // namespace AMD
+}  // namespace rocr
@@ -42,6 +42,7 @@
 
 #include "core/inc/default_signal.h"
 #include "core/util/timer.h"
+#include "core/util/trace.h"
 
 #if defined(__i386__) || defined(__x86_64__)
 #include <mwaitxintrin.h>
@@ -80,6 +81,7 @@ hsa_signal_value_t BusyWaitSignal::WaitRelaxed(hsa_signal_condition_t condition,
                                                hsa_wait_state_t wait_hint) {
   Retain();
   MAKE_SCOPE_GUARD([&]() { Release(); });
+  trace::Scope trace_wait(trace::kSignalWait, Convert(this).handle, compare_value);
 
   waiting_++;
   MAKE_SCOPE_GUARD([&]() { waiting_--; });
@@ -61,6 +61,7 @@
 #include "core/inc/hsa_ven_amd_loader_impl.h"
 #include "inc/hsa_ven_amd_aqlprofile.h"
 #include "core/inc/hsa_ext_amd_impl.h"
+#include "core/util/trace.h"
 
 namespace rocr {
 
@@ -168,7 +169,7 @@ template <class T> static __forceinline T handleExceptionT() {
 }
 }   // namespace amd
 
-#define TRY try {
+#define TRY try { TRACE_API();
 #define CATCH } catch(...) { return AMD::handleException(); }
 #define CATCHRET(RETURN_TYPE) } catch(...) { return AMD::handleExceptionT<RETURN_TYPE>(); }
 
@@ -343,8 +344,12 @@ static size_t get_extension_table_length(uint16_t extension, uint16_t major, uin
       {"hsa_ven_amd_loader_1_01_pfn_t", sizeof(hsa_ven_amd_loader_1_01_pfn_t)},
       {"hsa_ven_amd_loader_1_02_pfn_t", sizeof(hsa_ven_amd_loader_1_02_pfn_t)},
       {"hsa_ven_amd_loader_1_03_pfn_t", sizeof(hsa_ven_amd_loader_1_03_pfn_t)},
+      {"hsa_ven_amd_loader_1_04_pfn_t", sizeof(hsa_ven_amd_loader_1_04_pfn_t)},
+      {"hsa_ven_amd_loader_1_05_pfn_t", sizeof(hsa_ven_amd_loader_1_05_pfn_t)},
+      {"hsa_ven_amd_loader_1_06_pfn_t", sizeof(hsa_ven_amd_loader_1_06_pfn_t)},
       {"hsa_ven_amd_aqlprofile_1_00_pfn_t", sizeof(hsa_ven_amd_aqlprofile_1_00_pfn_t)},
-      {"hsa_ven_amd_pc_sampling_1_00_pfn_t", sizeof(hsa_ven_amd_pc_sampling_1_00_pfn_t)}};
+      {"hsa_ven_amd_pc_sampling_1_00_pfn_t", sizeof(hsa_ven_amd_pc_sampling_1_00_pfn_t)},
+      {"hsa_ven_amd_pc_sampling_1_01_pfn_t", sizeof(hsa_ven_amd_pc_sampling_1_01_pfn_t)}};
   static const size_t num_tables = sizeof(sizes) / sizeof(sizes_t);
 
   if (minor > 99) return 0;
@@ -437,13 +442,16 @@ hsa_status_t hsa_system_get_major_extension_table(uint16_t extension, uint16_t v
     if (version_major != core::Runtime::runtime_singleton_->extensions_.pcs_api.version.major_id) {
       return HSA_STATUS_ERROR;
     }
-    hsa_ven_amd_pc_sampling_1_00_pfn_t ext_table;
+    hsa_ven_amd_pc_sampling_1_01_pfn_t ext_table;
+    ext_table.hsa_ven_amd_pcs_iterate_configuration = hsa_ven_amd_pcs_iterate_configuration;
     ext_table.hsa_ven_amd_pcs_create = hsa_ven_amd_pcs_create;
     ext_table.hsa_ven_amd_pcs_create_from_id = hsa_ven_amd_pcs_create_from_id;
     ext_table.hsa_ven_amd_pcs_destroy = hsa_ven_amd_pcs_destroy;
     ext_table.hsa_ven_amd_pcs_start = hsa_ven_amd_pcs_start;
     ext_table.hsa_ven_amd_pcs_stop = hsa_ven_amd_pcs_stop;
     ext_table.hsa_ven_amd_pcs_flush = hsa_ven_amd_pcs_flush;
+    ext_table.hsa_ven_amd_pcs_data_acquire = hsa_ven_amd_pcs_data_acquire;
+    ext_table.hsa_ven_amd_pcs_data_release = hsa_ven_amd_pcs_data_release;
 
     memcpy(table, &ext_table, Min(sizeof(ext_table), table_length));
   }
@@ -469,7 +477,7 @@ hsa_status_t hsa_system_get_major_extension_table(uint16_t extension, uint16_t v
 
   if (extension == HSA_EXTENSION_AMD_LOADER) {
     if (version_major != 1) return HSA_STATUS_ERROR;
-    hsa_ven_amd_loader_1_03_pfn_t ext_table;
+    hsa_ven_amd_loader_1_06_pfn_t ext_table;
     ext_table.hsa_ven_amd_loader_query_host_address =
         hsa_ven_amd_loader_query_host_address;
     ext_table.hsa_ven_amd_loader_query_segment_descriptors =
@@ -484,6 +492,12 @@ hsa_status_t hsa_system_get_major_extension_table(uint16_t extension, uint16_t v
         hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size;
     ext_table.hsa_ven_amd_loader_iterate_executables =
         hsa_ven_amd_loader_iterate_executables;
+    ext_table.hsa_ven_amd_loader_executable_load_deferred_code_objects =
+        hsa_ven_amd_loader_executable_load_deferred_code_objects;
+    ext_table.hsa_ven_amd_loader_executable_symbol_get_dispatch_info =
+        hsa_ven_amd_loader_executable_symbol_get_dispatch_info;
+    ext_table.hsa_ven_amd_loader_select_bundle_entries =
+        hsa_ven_amd_loader_select_bundle_entries;
 
     memcpy(table, &ext_table, Min(sizeof(ext_table), table_length));
 
@@ -87,11 +87,11 @@ void HsaApiTable::Init() {
   // they can add preprocessor macros on the new functions
 
   constexpr size_t expected_core_api_table_size = 1016;
-  constexpr size_t expected_amd_ext_table_size = 584;
+  constexpr size_t expected_amd_ext_table_size = 720;
   constexpr size_t expected_image_ext_table_size = 120;
   constexpr size_t expected_finalizer_ext_table_size = 64;
   constexpr size_t expected_tools_table_size = 64;
-  constexpr size_t expected_pc_sampling_ext_table_size = 72;
+  constexpr size_t expected_pc_sampling_ext_table_size = 88;
 
   static_assert(sizeof(CoreApiTable) == expected_core_api_table_size,
                 "HSA core API table size changed, bump HSA_CORE_API_TABLE_STEP_VERSION and set "
@@ -474,6 +474,24 @@ void HsaApiTable::UpdateAmdExts() {
   amd_ext_api.hsa_amd_agent_set_async_scratch_limit_fn = AMD::hsa_amd_agent_set_async_scratch_limit;
   amd_ext_api.hsa_amd_queue_get_info_fn = AMD::hsa_amd_queue_get_info;
   amd_ext_api.hsa_amd_enable_logging_fn = AMD::hsa_amd_enable_logging;
+  amd_ext_api.hsa_amd_memory_pool_free_async_fn = AMD::hsa_amd_memory_pool_free_async;
+  amd_ext_api.hsa_amd_ordered_pool_create_fn = AMD::hsa_amd_ordered_pool_create;
+  amd_ext_api.hsa_amd_ordered_pool_destroy_fn = AMD::hsa_amd_ordered_pool_destroy;
+  amd_ext_api.hsa_amd_ordered_pool_allocate_fn = AMD::hsa_amd_ordered_pool_allocate;
+  amd_ext_api.hsa_amd_ordered_pool_free_fn = AMD::hsa_amd_ordered_pool_free;
+  amd_ext_api.hsa_amd_ordered_pool_trim_fn = AMD::hsa_amd_ordered_pool_trim;
+  amd_ext_api.hsa_amd_ordered_pool_set_release_threshold_fn = AMD::hsa_amd_ordered_pool_set_release_threshold;
+  amd_ext_api.hsa_amd_profiling_convert_ticks_to_system_domain_fn =
+      AMD::hsa_amd_profiling_convert_ticks_to_system_domain;
+  amd_ext_api.hsa_amd_ipc_memory_attach_batch_fn = AMD::hsa_amd_ipc_memory_attach_batch;
+  amd_ext_api.hsa_amd_ipc_memory_cache_purge_fn = AMD::hsa_amd_ipc_memory_cache_purge;
+  amd_ext_api.hsa_amd_ipc_memory_cache_stats_fn = AMD::hsa_amd_ipc_memory_cache_stats;
+  amd_ext_api.hsa_amd_svm_profile_iterate_ranges_fn = AMD::hsa_amd_svm_profile_iterate_ranges;
+  amd_ext_api.hsa_amd_svm_attributes_set_async_fn = AMD::hsa_amd_svm_attributes_set_async;
+  amd_ext_api.hsa_amd_svm_attributes_get_async_fn = AMD::hsa_amd_svm_attributes_get_async;
+  amd_ext_api.hsa_amd_runtime_stats_get_fn = AMD::hsa_amd_runtime_stats_get;
+  amd_ext_api.hsa_amd_profiling_dispatch_slots_enable_fn = AMD::hsa_amd_profiling_dispatch_slots_enable;
+  amd_ext_api.hsa_amd_profiling_get_dispatch_times_fn = AMD::hsa_amd_profiling_get_dispatch_times;
 }
 
 void HsaApiTable::UpdateTools() {
@@ -51,9 +51,11 @@
 
 #include "core/inc/agent.h"
 #include "core/inc/amd_aie_agent.h"
+#include "core/inc/amd_aql_queue.h"
 #include "core/inc/amd_cpu_agent.h"
 #include "core/inc/amd_gpu_agent.h"
 #include "core/inc/amd_memory_region.h"
+#include "core/inc/amd_ordered_pool.h"
 #include "core/inc/default_signal.h"
 #include "core/inc/exceptions.h"
 #include "core/inc/intercept_queue.h"
@@ -61,6 +63,7 @@
 #include "core/inc/ipc_signal.h"
 #include "core/inc/runtime.h"
 #include "core/inc/signal.h"
+#include "core/util/trace.h"
 
 namespace rocr {
 
@@ -91,6 +94,11 @@ struct ValidityError<core::Queue*> {
   enum { value = HSA_STATUS_ERROR_INVALID_QUEUE };
 };
 
+template <>
+struct ValidityError<AMD::OrderedPool*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_MEMORY_POOL };
+};
+
 template <class T>
 struct ValidityError<const T*> {
   enum { value = ValidityError<T*>::value };
@@ -144,7 +152,7 @@ static __forceinline bool IsValid(T* ptr) {
   return (ptr == NULL) ? NULL : ptr->IsValid();
 }
 
-#define TRY try {
+#define TRY try { TRACE_API();
 #define CATCH } catch(...) { return AMD::handleException(); }
 #define CATCHRET(RETURN_TYPE) } catch(...) { return AMD::handleExceptionT<RETURN_TYPE>(); }
 
@@ -508,6 +516,33 @@ hsa_status_t hsa_amd_profiling_convert_tick_to_system_domain(hsa_agent_t agent_h
   CATCH;
 }
 
+hsa_status_t hsa_amd_profiling_convert_ticks_to_system_domain(hsa_agent_t agent_handle,
+                                                              size_t num_ticks,
+                                                              const uint64_t* agent_ticks,
+                                                              uint64_t* system_ticks) {
+  TRY;
+  IS_OPEN();
+
+  if (num_ticks != 0 && (agent_ticks == NULL || system_ticks == NULL))
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+
+  IS_VALID(agent);
+
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  AMD::GpuAgentInt* gpu_agent = static_cast<AMD::GpuAgentInt*>(agent);
+
+  if (system_ticks != agent_ticks) memcpy(system_ticks, agent_ticks, num_ticks * sizeof(uint64_t));
+  gpu_agent->TranslateTimes(system_ticks, num_ticks);
+
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
 hsa_status_t hsa_amd_signal_create(hsa_signal_value_t initial_value, uint32_t num_consumers,
                                    const hsa_agent_t* consumers, uint64_t attributes,
                                    hsa_signal_t* hsa_signal) {
@@ -795,6 +830,18 @@ hsa_status_t hsa_amd_memory_pool_allocate(hsa_amd_memory_pool_t memory_pool, siz
   if (flags & HSA_AMD_MEMORY_POOL_EXECUTABLE_FLAG)
     alloc_flag |= core::MemoryRegion::AllocateExecutable;
 
+  if (flags & HSA_AMD_MEMORY_POOL_HUGE_PAGE_2MB_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateHugePage2MB;
+
+  if (flags & HSA_AMD_MEMORY_POOL_HUGE_PAGE_1GB_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateHugePage1GB;
+
+  if (flags & HSA_AMD_MEMORY_POOL_NUMA_INTERLEAVE_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateNUMAInterleave;
+
+  if (flags & HSA_AMD_MEMORY_POOL_ZEROED_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateZeroed;
+
 #ifdef SANITIZER_AMDGPU
   alloc_flag |= core::MemoryRegion::AllocateAsan;
 #endif
@@ -807,6 +854,121 @@ hsa_status_t hsa_amd_memory_pool_free(void* ptr) {
   return HSA::hsa_memory_free(ptr);
 }
 
+hsa_status_t hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dependency_signal) {
+  TRY;
+  IS_OPEN();
+
+  if (ptr == nullptr) return HSA_STATUS_SUCCESS;
+
+  if (dependency_signal.handle != 0) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dependency_signal);
+    IS_VALID(dep_signal_obj);
+  }
+
+  return core::Runtime::runtime_singleton_->FreeMemoryAsync(ptr, dependency_signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_ordered_pool_create(hsa_amd_memory_pool_t memory_pool, uint32_t num_agents,
+                                         const hsa_agent_t* agents, hsa_amd_ordered_pool_t* pool) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(pool);
+
+  if (num_agents != 0 && agents == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  hsa_region_t region = {memory_pool.handle};
+  const AMD::MemoryRegion* mem_region =
+      static_cast<const AMD::MemoryRegion*>(core::MemoryRegion::Convert(region));
+
+  if (mem_region == NULL || !mem_region->IsValid() ||
+      !(mem_region->IsSystem() || mem_region->IsLocalMemory())) {
+    return (hsa_status_t)HSA_STATUS_ERROR_INVALID_MEMORY_POOL;
+  }
+
+  for (uint32_t i = 0; i < num_agents; i++) {
+    const core::Agent* agent = core::Agent::Convert(agents[i]);
+    IS_VALID(agent);
+  }
+
+  AMD::OrderedPool* ordered_pool =
+      new AMD::OrderedPool(*mem_region, std::vector<hsa_agent_t>(agents, agents + num_agents));
+  *pool = AMD::OrderedPool::Convert(ordered_pool);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_ordered_pool_destroy(hsa_amd_ordered_pool_t pool) {
+  TRY;
+  IS_OPEN();
+
+  AMD::OrderedPool* ordered_pool = AMD::OrderedPool::Convert(pool);
+  IS_VALID(ordered_pool);
+
+  hsa_status_t err = ordered_pool->Drain();
+  if (err != HSA_STATUS_SUCCESS) return err;
+
+  delete ordered_pool;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_ordered_pool_allocate(hsa_amd_ordered_pool_t pool, size_t size, void** ptr,
+                                           hsa_signal_t* dependency) {
+  TRY;
+  IS_OPEN();
+
+  if (size == 0 || ptr == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  AMD::OrderedPool* ordered_pool = AMD::OrderedPool::Convert(pool);
+  IS_VALID(ordered_pool);
+
+  return ordered_pool->Allocate(size, ptr, dependency);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_ordered_pool_free(hsa_amd_ordered_pool_t pool, void* ptr,
+                                       hsa_signal_t release_signal) {
+  TRY;
+  IS_OPEN();
+
+  AMD::OrderedPool* ordered_pool = AMD::OrderedPool::Convert(pool);
+  IS_VALID(ordered_pool);
+
+  if (release_signal.handle != 0) {
+    core::Signal* release_signal_obj = core::Signal::Convert(release_signal);
+    IS_VALID(release_signal_obj);
+  }
+
+  return ordered_pool->Free(ptr, release_signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_ordered_pool_trim(hsa_amd_ordered_pool_t pool, size_t min_bytes_to_keep) {
+  TRY;
+  IS_OPEN();
+
+  AMD::OrderedPool* ordered_pool = AMD::OrderedPool::Convert(pool);
+  IS_VALID(ordered_pool);
+
+  ordered_pool->Trim(min_bytes_to_keep);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_ordered_pool_set_release_threshold(hsa_amd_ordered_pool_t pool,
+                                                        size_t threshold) {
+  TRY;
+  IS_OPEN();
+
+  AMD::OrderedPool* ordered_pool = AMD::OrderedPool::Convert(pool);
+  IS_VALID(ordered_pool);
+
+  ordered_pool->SetReleaseThreshold(threshold);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
 hsa_status_t hsa_amd_agents_allow_access(uint32_t num_agents, const hsa_agent_t* agents,
                                          const uint32_t* flags, const void* ptr) {
   TRY;
@@ -1001,6 +1163,41 @@ hsa_status_t hsa_amd_ipc_memory_attach(const hsa_amd_ipc_memory_t* ipc, size_t l
   CATCH;
 }
 
+hsa_status_t hsa_amd_ipc_memory_attach_batch(uint32_t num_handles,
+                                             const hsa_amd_ipc_memory_t* handles,
+                                             const size_t* lens, uint32_t num_agents,
+                                             const hsa_agent_t* mapping_agents,
+                                             void** mapped_ptrs) {
+  static const int tinyArraySize = 8;
+  TRY;
+  IS_OPEN();
+  if (num_handles == 0) return HSA_STATUS_SUCCESS;
+  IS_BAD_PTR(handles);
+  IS_BAD_PTR(lens);
+  IS_BAD_PTR(mapped_ptrs);
+  if (num_agents != 0) IS_BAD_PTR(mapping_agents);
+
+  core::Agent** core_agents = nullptr;
+  if (num_agents > tinyArraySize)
+    core_agents = new core::Agent*[num_agents];
+  else
+    core_agents = (core::Agent**)alloca(sizeof(core::Agent*) * num_agents);
+  if (core_agents == NULL) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  MAKE_SCOPE_GUARD([&]() {
+    if (num_agents > tinyArraySize) delete[] core_agents;
+  });
+
+  for (uint32_t i = 0; i < num_agents; i++) {
+    core::Agent* device = core::Agent::Convert(mapping_agents[i]);
+    IS_VALID(device);
+    core_agents[i] = device;
+  }
+
+  return core::Runtime::runtime_singleton_->IPCAttachBatch(num_handles, handles, lens, num_agents,
+                                                           core_agents, mapped_ptrs);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_ipc_memory_detach(void* mapped_ptr) {
   TRY;
   IS_OPEN();
@@ -1009,6 +1206,23 @@ hsa_status_t hsa_amd_ipc_memory_detach(void* mapped_ptr) {
   CATCH;
 }
 
+hsa_status_t hsa_amd_ipc_memory_cache_purge() {
+  TRY;
+  IS_OPEN();
+  core::Runtime::runtime_singleton_->IPCCachePurge();
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_ipc_memory_cache_stats(hsa_amd_ipc_memory_cache_stats_t* stats) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(stats);
+  core::Runtime::runtime_singleton_->IPCCacheStats(stats);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
 hsa_status_t hsa_amd_ipc_signal_create(hsa_signal_t hsa_signal, hsa_amd_ipc_signal_t* handle) {
   TRY;
   IS_OPEN();
@@ -1176,6 +1390,98 @@ hsa_status_t hsa_amd_svm_prefetch_async(void* ptr, size_t size, hsa_agent_t agen
   CATCH;
 }
 
+hsa_status_t hsa_amd_svm_profile_iterate_ranges(
+    hsa_status_t (*callback)(const hsa_amd_svm_profile_range_t* range, void* data), void* data) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(callback);
+  return core::Runtime::runtime_singleton_->SvmProfileIterateRanges(callback, data);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_svm_attributes_set_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  if (attribute_count != 0) IS_BAD_PTR(attribute_list);
+  if (num_dep_signals != 0) IS_BAD_PTR(dep_signals);
+  return core::Runtime::runtime_singleton_->SetSvmAttribAsync(
+      ptr, size, attribute_list, attribute_count, num_dep_signals, dep_signals, completion_signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_svm_attributes_get_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(attribute_list);
+  if (num_dep_signals != 0) IS_BAD_PTR(dep_signals);
+  return core::Runtime::runtime_singleton_->GetSvmAttribAsync(
+      ptr, size, attribute_list, attribute_count, num_dep_signals, dep_signals, completion_signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_runtime_stats_get(
+    hsa_agent_t agent_handle,
+    hsa_status_t (*callback)(const hsa_amd_runtime_stats_entry_t* entry, void* data), void* data) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(callback);
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  if (agent == NULL || !agent->IsValid() || agent->device_type() != core::Agent::kAmdGpuDevice)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  return static_cast<AMD::GpuAgent*>(agent)->IterateRuntimeStats(callback, data);
+  CATCH;
+}
+
+// Dispatch time slots belong to the hardware queue, also when packets are intercepted.  Intercept
+// queues have the same size as the queue they wrap, so user packet IDs map to the same slots.
+static AqlQueue* DispatchTimeQueue(core::Queue* queue) {
+  if (core::InterceptQueue::IsType(queue))
+    queue = static_cast<core::InterceptQueue*>(queue)->wrapped.get();
+  return AqlQueue::IsType(queue) ? static_cast<AqlQueue*>(queue) : nullptr;
+}
+
+hsa_status_t hsa_amd_profiling_dispatch_slots_enable(hsa_queue_t* queue, hsa_signal_t* slot_base) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(queue);
+  IS_BAD_PTR(slot_base);
+
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+
+  AqlQueue* aql_queue = DispatchTimeQueue(cmd_queue);
+  if (aql_queue == nullptr) return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  *slot_base = aql_queue->EnableDispatchTimeSlots();
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_profiling_get_dispatch_times(hsa_queue_t* queue, uint64_t first_packet_id,
+                                                  uint32_t count,
+                                                  hsa_amd_profiling_dispatch_time_t* times,
+                                                  uint32_t* completed) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(queue);
+  if (count != 0) IS_BAD_PTR(times);
+
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+
+  AqlQueue* aql_queue = DispatchTimeQueue(cmd_queue);
+  if (aql_queue == nullptr) return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  return aql_queue->ReadDispatchTimes(first_packet_id, count, times, completed);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_spm_acquire(hsa_agent_t preferred_agent) {
   TRY;
   IS_OPEN();
@@ -115,6 +115,8 @@ void ExtensionEntryPoints::InitPcSamplingExtTable() {
   pcs_api.hsa_ven_amd_pcs_start_fn = hsa_ext_null;
   pcs_api.hsa_ven_amd_pcs_stop_fn = hsa_ext_null;
   pcs_api.hsa_ven_amd_pcs_flush_fn = hsa_ext_null;
+  pcs_api.hsa_ven_amd_pcs_data_acquire_fn = hsa_ext_null;
+  pcs_api.hsa_ven_amd_pcs_data_release_fn = hsa_ext_null;
 }
 
 // Initialize Amd Ext table for Api related to Images
@@ -517,6 +519,18 @@ hsa_status_t HSA_API hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t pc_sampling) {
       pc_sampling);
 }
 
+hsa_status_t HSA_API hsa_ven_amd_pcs_data_acquire(hsa_ven_amd_pcs_t pc_sampling,
+                                                  hsa_ven_amd_pcs_data_view_t* view) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.pcs_api
+      .hsa_ven_amd_pcs_data_acquire_fn(pc_sampling, view);
+}
+
+hsa_status_t HSA_API hsa_ven_amd_pcs_data_release(hsa_ven_amd_pcs_t pc_sampling,
+                                                  size_t data_size) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.pcs_api
+      .hsa_ven_amd_pcs_data_release_fn(pc_sampling, data_size);
+}
+
 //---------------------------------------------------------------------------//
 //  Stubs for internal extension functions
 //---------------------------------------------------------------------------//
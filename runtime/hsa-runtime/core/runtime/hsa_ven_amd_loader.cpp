@@ -43,8 +43,11 @@
 #include "core/inc/hsa_ven_amd_loader_impl.h"
 
 #include "core/inc/amd_hsa_loader.hpp"
+#include "core/inc/isa.h"
 #include "core/inc/runtime.h"
 
+#include <vector>
+
 namespace rocr {
 
 using namespace amd::hsa;
@@ -157,11 +160,25 @@ hsa_status_t hsa_ven_amd_loader_loaded_code_object_get_info(
       return HSA_STATUS_ERROR_INVALID_ARGUMENT;
     }
 
-    const LoadedCodeObject *lcobj = LoadedCodeObject::Object(loaded_code_object);
+    LoadedCodeObject *lcobj = LoadedCodeObject::Object(loaded_code_object);
     if (!lcobj) {
       return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
     }
 
+    // Load placement is only known once a deferred code object is loaded.
+    switch (attribute) {
+      case HSA_VEN_AMD_LOADER_LOADED_CODE_OBJECT_INFO_LOAD_DELTA:
+      case HSA_VEN_AMD_LOADER_LOADED_CODE_OBJECT_INFO_LOAD_BASE:
+      case HSA_VEN_AMD_LOADER_LOADED_CODE_OBJECT_INFO_LOAD_SIZE: {
+        if (!lcobj->EnsureLoaded()) {
+          return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+
     switch (attribute) {
       case HSA_VEN_AMD_LOADER_LOADED_CODE_OBJECT_INFO_EXECUTABLE: {
         *((hsa_executable_t*)value) = lcobj->getExecutable();
@@ -300,4 +317,76 @@ hsa_ven_amd_loader_iterate_executables(
   } catch(...) { return AMD::handleException(); }
 }
 
+hsa_status_t
+hsa_ven_amd_loader_executable_load_deferred_code_objects(
+    hsa_executable_t executable,
+    const hsa_agent_t *agent) {
+  try {
+    if (!Runtime::runtime_singleton_->IsOpen()) {
+      return HSA_STATUS_ERROR_NOT_INITIALIZED;
+    }
+
+    Executable *exec = Executable::Object(executable);
+    if (!exec) {
+      return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+    }
+
+    return exec->LoadDeferredCodeObjects(agent);
+  } catch(...) { return AMD::handleException(); }
+}
+
+hsa_status_t
+hsa_ven_amd_loader_executable_symbol_get_dispatch_info(
+    hsa_executable_symbol_t executable_symbol,
+    const hsa_ven_amd_loader_kernel_dispatch_info_t **dispatch_info) {
+  try {
+    if (!Runtime::runtime_singleton_->IsOpen()) {
+      return HSA_STATUS_ERROR_NOT_INITIALIZED;
+    }
+    if (nullptr == dispatch_info) {
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+
+    loader::Symbol *sym = loader::Symbol::Object(executable_symbol);
+    if (!sym) {
+      return HSA_STATUS_ERROR_INVALID_EXECUTABLE_SYMBOL;
+    }
+
+    return sym->GetDispatchInfo(dispatch_info);
+  } catch(...) { return AMD::handleException(); }
+}
+
+hsa_status_t
+hsa_ven_amd_loader_select_bundle_entries(
+    const char *const *isa_names,
+    uint32_t num_isa_names,
+    const hsa_agent_t *agents,
+    uint32_t num_agents,
+    int32_t *selected_entries) {
+  try {
+    if (!Runtime::runtime_singleton_->IsOpen()) {
+      return HSA_STATUS_ERROR_NOT_INITIALIZED;
+    }
+    if ((nullptr == isa_names && 0 != num_isa_names) ||
+        ((nullptr == agents || nullptr == selected_entries) && 0 != num_agents)) {
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+
+    std::vector<const Isa*> agent_isas(num_agents);
+    for (uint32_t i = 0; i < num_agents; ++i) {
+      const Agent *agent = Agent::Convert(agents[i]);
+      if (nullptr == agent || !agent->IsValid()) {
+        return HSA_STATUS_ERROR_INVALID_AGENT;
+      }
+      agent_isas[i] = agent->isa();
+    }
+
+    IsaBundleIndex index(isa_names, num_isa_names);
+    for (uint32_t i = 0; i < num_agents; ++i) {
+      selected_entries[i] = nullptr == agent_isas[i] ? -1 : index.Select(*agent_isas[i]);
+    }
+    return HSA_STATUS_SUCCESS;
+  } catch(...) { return AMD::handleException(); }
+}
+
 } // namespace rocr
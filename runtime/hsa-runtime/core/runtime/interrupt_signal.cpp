@@ -44,6 +44,7 @@
 #include "core/inc/runtime.h"
 #include "core/util/timer.h"
 #include "core/util/locks.h"
+#include "core/util/trace.h"
 
 #if defined(__i386__) || defined(__x86_64__)
 #include <mwaitxintrin.h>
@@ -146,6 +147,7 @@ hsa_signal_value_t InterruptSignal::WaitRelaxed(
     uint64_t timeout, hsa_wait_state_t wait_hint) {
   Retain();
   MAKE_SCOPE_GUARD([&]() { Release(); });
+  trace::Scope trace_wait(trace::kSignalWait, Convert(this).handle, compare_value);
 
   uint32_t prior = waiting_++;
   MAKE_SCOPE_GUARD([&]() { waiting_--; });
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/inc/ipc_attach_cache.h"
+
+#include <string.h>
+
+namespace rocr {
+namespace core {
+
+bool IPCAttachCache::Key::operator<(const Key& rhs) const {
+  int cmp = memcmp(handle.handle, rhs.handle.handle, sizeof(handle.handle));
+  if (cmp != 0) return cmp < 0;
+  if (len != rhs.len) return len < rhs.len;
+  return nodes < rhs.nodes;
+}
+
+void* IPCAttachCache::Acquire(const Key& key) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+
+  hits_++;
+  Entry& entry = it->second;
+  if (entry.refcount++ == 0) idle_.erase(entry.idle);
+  return entry.ptr;
+}
+
+bool IPCAttachCache::Insert(const Key& key, void* ptr) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  auto ret = entries_.insert(std::make_pair(key, Entry()));
+  if (!ret.second) return false;
+
+  Entry& entry = ret.first->second;
+  entry.ptr = ptr;
+  entry.refcount = 1;
+  by_ptr_[ptr] = ret.first;
+  return true;
+}
+
+IPCAttachCache::ReleaseResult IPCAttachCache::Release(void* ptr, std::vector<void*>& unmap) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  auto it = by_ptr_.find(ptr);
+  if (it == by_ptr_.end()) return kNotCached;
+
+  Entry& entry = it->second->second;
+  // Idle mappings may be evicted at any time, so an extra detach must not
+  // revive one.
+  debug_warning(entry.refcount != 0 && "IPC mapping released while idle.");
+  if (entry.refcount == 0) return kNotReferenced;
+  if (--entry.refcount != 0) return kReleased;
+
+  entry.idle = idle_.insert(idle_.end(), it->second);
+  while (idle_.size() > max_idle_) Evict(unmap);
+  return kReleased;
+}
+
+void IPCAttachCache::Purge(std::vector<void*>& unmap) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  while (!idle_.empty()) Evict(unmap);
+}
+
+void IPCAttachCache::Evict(std::vector<void*>& unmap) {
+  EntryMap::iterator it = idle_.front();
+  idle_.pop_front();
+  unmap.push_back(it->second.ptr);
+  by_ptr_.erase(it->second.ptr);
+  entries_.erase(it);
+  evictions_++;
+}
+
+void IPCAttachCache::GetStats(hsa_amd_ipc_memory_cache_stats_t* stats) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  stats->hits = hits_;
+  stats->misses = misses_;
+  stats->evictions = evictions_;
+  stats->idle = idle_.size();
+  stats->active = entries_.size() - idle_.size();
+}
+
+}  // namespace core
+}  // namespace rocr
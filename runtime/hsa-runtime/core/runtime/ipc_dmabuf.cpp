@@ -0,0 +1,542 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/inc/ipc_dmabuf.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+#include "hsakmt/hsakmt.h"
+
+namespace rocr {
+namespace core {
+
+namespace ipc_dmabuf {
+void SocketAddress(uint32_t pid, struct sockaddr_un* address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  snprintf(address->sun_path, 32, "xhsa%u", pid);
+  address->sun_path[0] = 0;  // first NULL char creates unlisted abstract socket
+}
+
+// Client sockets time out after 10 seconds so a stalled server can't hang
+// the importer.  Server sockets are non-blocking instead.
+static void SetTimeouts(int fd) {
+  struct timeval tv;
+  tv.tv_sec = 10;
+  tv.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static bool RecvAll(int fd, void* buf, size_t size) {
+  uint8_t* data = reinterpret_cast<uint8_t*>(buf);
+  while (size != 0) {
+    ssize_t ret = recv(fd, data, size, MSG_WAITALL);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) return false;
+    data += ret;
+    size -= ret;
+  }
+  return true;
+}
+
+static bool SendAll(int fd, const void* buf, size_t size) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(buf);
+  while (size != 0) {
+    ssize_t ret = send(fd, data, size, MSG_NOSIGNAL);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) return false;
+    data += ret;
+    size -= ret;
+  }
+  return true;
+}
+
+// Sends as much of @p buf as fits without blocking, with @p num_fds FDs
+// attached to its first byte.  Returns the bytes sent or -1 with errno set.
+static ssize_t SendSome(int fd, const void* buf, size_t size, const int* fds, uint32_t num_fds) {
+  char control[CMSG_SPACE(sizeof(int) * kMaxBatch)];
+  struct iovec io;
+  io.iov_base = const_cast<void*>(buf);
+  io.iov_len = size;
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &io;
+  msg.msg_iovlen = 1;
+
+  if (num_fds != 0) {
+    memset(control, 0, sizeof(control));
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * num_fds);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * num_fds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * num_fds);
+  }
+
+  ssize_t sent;
+  do {
+    sent = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+  } while (sent < 0 && errno == EINTR);
+  return sent;
+}
+
+// Receives @p size bytes and up to kMaxBatch attached FDs.  On failure any
+// received FDs are closed.
+static bool RecvWithFds(int fd, void* buf, size_t size, int* fds, uint32_t* num_fds) {
+  char control[CMSG_SPACE(sizeof(int) * kMaxBatch)];
+  struct iovec io;
+  io.iov_base = buf;
+  io.iov_len = size;
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &io;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t ret;
+  do {
+    ret = recvmsg(fd, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+  } while (ret < 0 && errno == EINTR);
+  if (ret <= 0) return false;
+
+  *num_fds = 0;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+    uint32_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    count = Min(count, kMaxBatch - *num_fds);
+    memcpy(&fds[*num_fds], CMSG_DATA(cmsg), sizeof(int) * count);
+    *num_fds += count;
+  }
+
+  if ((msg.msg_flags & MSG_CTRUNC) ||
+      !RecvAll(fd, reinterpret_cast<uint8_t*>(buf) + ret, size - ret)) {
+    for (uint32_t i = 0; i < *num_fds; i++) close(fds[i]);
+    *num_fds = 0;
+    return false;
+  }
+  return true;
+}
+
+static bool Arm(int epoll_fd, int fd, int op, uint32_t events) {
+  struct epoll_event event;
+  event.events = events | EPOLLONESHOT;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, op, fd, &event) == 0;
+}
+}  // namespace ipc_dmabuf
+
+IPCDmaBufServer::DmaBufFd::~DmaBufFd() { close(fd); }
+
+IPCDmaBufServer::IPCDmaBufServer(size_t fd_cache_limit)
+    : listen_fd_(-1), epoll_fd_(-1), stop_fd_(-1), fd_cache_limit_(fd_cache_limit) {}
+
+IPCDmaBufServer::~IPCDmaBufServer() {
+  ScopedAcquire<KernelMutex> lock(&start_lock_);
+  Stop();
+}
+
+bool IPCDmaBufServer::Start(uint32_t pid) {
+  ScopedAcquire<KernelMutex> lock(&start_lock_);
+  if (!workers_.empty()) return true;
+
+  MAKE_NAMED_SCOPE_GUARD(stopGuard, [&]() { Stop(); });
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (listen_fd_ == -1 || epoll_fd_ == -1 || stop_fd_ == -1) return false;
+
+  // Use the PID as unique socket server name.  The listen backlog only
+  // bounds connections not yet accepted; the workers accept eagerly.
+  struct sockaddr_un address;
+  ipc_dmabuf::SocketAddress(pid, &address);
+  if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) ||
+      listen(listen_fd_, SOMAXCONN)) {
+    debug_print("IPC dmabuf socket server for pid %u not started: %s\n", pid, strerror(errno));
+    return false;
+  }
+
+  // The stop event is level triggered so it wakes every worker.
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.fd = stop_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &event) ||
+      !ipc_dmabuf::Arm(epoll_fd_, listen_fd_, EPOLL_CTL_ADD, EPOLLIN))
+    return false;
+
+  // The server needs to last for the lifetime of the runtime instance as the
+  // attach life cycle is unknown.
+  uint32_t num_workers = Max(1u, Min(4u, std::thread::hardware_concurrency()));
+  for (uint32_t i = 0; i < num_workers; i++) {
+    os::Thread worker = os::CreateThread(WorkerLoop, this);
+    if (worker == nullptr) return false;
+    workers_.push_back(worker);
+  }
+
+  stopGuard.Dismiss();
+  return true;
+}
+
+void IPCDmaBufServer::Stop() {
+  if (!workers_.empty()) {
+    uint64_t one = 1;
+    ssize_t ret = write(stop_fd_, &one, sizeof(one));
+    assert(ret == sizeof(one) && "IPC dmabuf server stop event failed.");
+    (void)ret;
+    for (auto worker : workers_) {
+      os::WaitForThread(worker);
+      os::CloseThread(worker);
+    }
+    workers_.clear();
+  }
+
+  // Workers are gone, so the sockets can be closed without the lock.
+  for (auto& conn : conns_) close(conn.first);
+  conns_.clear();
+  for (int* fd : {&listen_fd_, &epoll_fd_, &stop_fd_}) {
+    if (*fd != -1) close(*fd);
+    *fd = -1;
+  }
+}
+
+void IPCDmaBufServer::Register(void* ptr, size_t len, int dmabuf_fd) {
+  const uint64_t handle = reinterpret_cast<uint64_t>(ptr);
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  Export& entry = exports_[handle];
+  if (entry.fd) fd_lru_.erase(entry.lru);
+  entry.len = len;
+  entry.fd.reset();
+  if (dmabuf_fd != -1) {
+    entry.fd = std::make_shared<DmaBufFd>(dmabuf_fd);
+    CacheFd(handle, entry);
+  }
+}
+
+void IPCDmaBufServer::Unregister(void* ptr) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  auto it = exports_.find(reinterpret_cast<uint64_t>(ptr));
+  if (it == exports_.end()) return;
+  if (it->second.fd) fd_lru_.erase(it->second.lru);
+  exports_.erase(it);
+}
+
+void IPCDmaBufServer::WorkerLoop(void* server) {
+  reinterpret_cast<IPCDmaBufServer*>(server)->Worker();
+}
+
+void IPCDmaBufServer::Worker() {
+  while (true) {
+    struct epoll_event event;
+    int ret = epoll_wait(epoll_fd_, &event, 1, -1);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) return;
+
+    const int fd = event.data.fd;
+    if (fd == stop_fd_) return;
+
+    if (fd == listen_fd_) {
+      Accept();
+      ipc_dmabuf::Arm(epoll_fd_, listen_fd_, EPOLL_CTL_MOD, EPOLLIN);
+      continue;
+    }
+
+    Connection* conn;
+    {
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      auto it = conns_.find(fd);
+      conn = (it == conns_.end()) ? nullptr : it->second.get();
+    }
+
+    uint32_t events;
+    if (conn != nullptr && Serve(fd, conn, &events) &&
+        ipc_dmabuf::Arm(epoll_fd_, fd, EPOLL_CTL_MOD, events))
+      continue;
+
+    // Client hung up or sent a bad request.
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    {
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      conns_.erase(fd);
+    }
+    close(fd);
+  }
+}
+
+void IPCDmaBufServer::Accept() {
+  while (true) {
+    int conn = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (conn == -1) {
+      if (errno == EINTR) continue;
+      return;  // EAGAIN: nothing left to accept.
+    }
+
+    // Register before arming so the worker woken by the first request finds
+    // the connection.
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    conns_[conn].reset(new Connection());
+    if (!ipc_dmabuf::Arm(epoll_fd_, conn, EPOLL_CTL_ADD, EPOLLIN)) {
+      conns_.erase(conn);
+      close(conn);
+    }
+  }
+}
+
+bool IPCDmaBufServer::Serve(int fd, Connection* conn, uint32_t* events) {
+  // Read the header, then the handles it announces.
+  while (conn->reply_size == 0) {
+    size_t size = sizeof(conn->request.header);
+    if (conn->received >= size) {
+      const uint32_t count = conn->request.header.count;
+      if (conn->request.header.magic != ipc_dmabuf::kRequestMagic || count == 0 ||
+          count > ipc_dmabuf::kMaxBatch)
+        return false;
+      size += sizeof(uint64_t) * count;
+      if (conn->received == size) break;
+    }
+
+    ssize_t ret = recv(fd, reinterpret_cast<uint8_t*>(&conn->request) + conn->received,
+                       size - conn->received, 0);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      *events = EPOLLIN;
+      return true;
+    }
+    if (ret <= 0) return false;
+    conn->received += ret;
+  }
+
+  if (conn->reply_size == 0) {
+    const uint32_t count = conn->request.header.count;
+    conn->reply.header.magic = ipc_dmabuf::kReplyMagic;
+    conn->reply.header.count = count;
+    for (uint32_t i = 0; i < count; i++) {
+      conn->refs[i] = GetFd(conn->request.handles[i]);
+      conn->reply.status[i] = conn->refs[i] ? 0 : -1;
+      if (conn->refs[i]) conn->fds[conn->num_fds++] = conn->refs[i]->fd;
+    }
+    conn->reply_size = sizeof(conn->reply.header) + sizeof(int32_t) * count;
+  }
+
+  // The FDs go with the first chunk, the remainder is sent plainly.
+  while (conn->sent < conn->reply_size) {
+    ssize_t ret = ipc_dmabuf::SendSome(
+        fd, reinterpret_cast<uint8_t*>(&conn->reply) + conn->sent, conn->reply_size - conn->sent,
+        conn->fds, conn->sent == 0 ? conn->num_fds : 0);
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      *events = EPOLLOUT;
+      return true;
+    }
+    if (ret <= 0) return false;
+    conn->sent += ret;
+  }
+
+  // Reply done, wait for the next request.
+  for (uint32_t i = 0; i < conn->request.header.count; i++) conn->refs[i].reset();
+  conn->received = 0;
+  conn->reply_size = 0;
+  conn->sent = 0;
+  conn->num_fds = 0;
+  *events = EPOLLIN;
+  return true;
+}
+
+std::shared_ptr<IPCDmaBufServer::DmaBufFd> IPCDmaBufServer::GetFd(uint64_t handle) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  auto it = exports_.find(handle);
+  if (it == exports_.end()) return nullptr;
+
+  Export& entry = it->second;
+  if (entry.fd) {
+    fd_lru_.splice(fd_lru_.end(), fd_lru_, entry.lru);
+    return entry.fd;
+  }
+
+  int fd;
+  uint64_t offset;
+  if (hsaKmtExportDMABufHandle(reinterpret_cast<void*>(handle), entry.len, &fd, &offset) !=
+      HSAKMT_STATUS_SUCCESS)
+    return nullptr;
+
+  std::shared_ptr<DmaBufFd> ret = std::make_shared<DmaBufFd>(fd);
+  entry.fd = ret;
+  CacheFd(handle, entry);
+  return ret;
+}
+
+void IPCDmaBufServer::CacheFd(uint64_t handle, Export& entry) {
+  entry.lru = fd_lru_.insert(fd_lru_.end(), handle);
+  while (fd_lru_.size() > fd_cache_limit_) {
+    auto victim = exports_.find(fd_lru_.front());
+    assert(victim != exports_.end() && "IPC dmabuf FD cache inconsistent.");
+    victim->second.fd.reset();
+    fd_lru_.pop_front();
+  }
+}
+
+IPCDmaBufClient::~IPCDmaBufClient() {
+  for (auto& exporter : idle_)
+    for (int conn : exporter.second) close(conn);
+}
+
+int IPCDmaBufClient::Connect(uint32_t pid) {
+  int conn = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (conn == -1) return -1;
+  ipc_dmabuf::SetTimeouts(conn);
+
+  struct sockaddr_un address;
+  ipc_dmabuf::SocketAddress(pid, &address);
+
+  // The exporter may not be listening yet, retry for up to 10 seconds.
+  int timeoutLimitMs = 10000, timeoutMs = 0, timeoutIntervalMs = 1;
+  while (connect(conn, reinterpret_cast<struct sockaddr*>(&address), sizeof(address))) {
+    if (timeoutMs >= timeoutLimitMs) {
+      close(conn);
+      return -1;
+    }
+    timeoutMs += timeoutIntervalMs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutIntervalMs));
+  }
+  return conn;
+}
+
+bool IPCDmaBufClient::Request(int conn, uint32_t count, const uint64_t* handles, int* fds) {
+  ipc_dmabuf::Request request;
+  request.header.magic = ipc_dmabuf::kRequestMagic;
+  request.header.count = count;
+  memcpy(request.handles, handles, sizeof(uint64_t) * count);
+  if (!ipc_dmabuf::SendAll(conn, &request, sizeof(request.header) + sizeof(uint64_t) * count))
+    return false;
+
+  ipc_dmabuf::Reply reply;
+  int received[ipc_dmabuf::kMaxBatch];
+  uint32_t num_received;
+  if (!ipc_dmabuf::RecvWithFds(conn, &reply, sizeof(reply.header) + sizeof(int32_t) * count,
+                               received, &num_received))
+    return false;
+
+  // FDs arrive in handle order, one per successful handle.
+  bool ok = reply.header.magic == ipc_dmabuf::kReplyMagic && reply.header.count == count;
+  uint32_t next = 0;
+  for (uint32_t i = 0; ok && i < count; i++) {
+    if (reply.status[i] != 0)
+      fds[i] = -1;
+    else if (next < num_received)
+      fds[i] = received[next++];
+    else
+      ok = false;
+  }
+  if (!ok || next != num_received) {
+    for (uint32_t i = 0; i < num_received; i++) close(received[i]);
+    return false;
+  }
+  return true;
+}
+
+bool IPCDmaBufClient::FetchFds(uint32_t pid, uint32_t count, const uint64_t* handles, int* fds) {
+  for (uint32_t i = 0; i < count; i++) fds[i] = -1;
+
+  for (uint32_t first = 0; first < count; first += ipc_dmabuf::kMaxBatch) {
+    const uint32_t batch = Min(count - first, ipc_dmabuf::kMaxBatch);
+    bool done = false;
+
+    // A pooled connection may have been dropped by the server, so a failed
+    // request on one is retried once on a new connection.
+    while (!done) {
+      int conn = -1;
+      {
+        ScopedAcquire<KernelMutex> lock(&lock_);
+        auto it = idle_.find(pid);
+        if (it != idle_.end() && !it->second.empty()) {
+          conn = it->second.back();
+          it->second.pop_back();
+        }
+      }
+      const bool pooled = (conn != -1);
+      if (!pooled) conn = Connect(pid);
+      if (conn == -1) break;
+
+      done = Request(conn, batch, &handles[first], &fds[first]);
+      if (done) {
+        ScopedAcquire<KernelMutex> lock(&lock_);
+        idle_[pid].push_back(conn);
+      } else {
+        close(conn);
+        if (!pooled) break;
+        // Other pooled connections to this exporter are likely stale too.
+        ScopedAcquire<KernelMutex> lock(&lock_);
+        auto it = idle_.find(pid);
+        if (it != idle_.end()) {
+          for (int stale : it->second) close(stale);
+          idle_.erase(it);
+        }
+      }
+    }
+
+    if (!done) {
+      for (uint32_t i = 0; i < first; i++) {
+        if (fds[i] != -1) close(fds[i]);
+        fds[i] = -1;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace core
+}  // namespace rocr
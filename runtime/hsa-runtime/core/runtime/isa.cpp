@@ -69,25 +69,36 @@ bool Wavefront::GetInfo(
   }
 }
 
+static_assert(static_cast<uint32_t>(IsaFeature::Unsupported) == 0 &&
+                  static_cast<uint32_t>(IsaFeature::Any) == 1 &&
+                  static_cast<uint32_t>(IsaFeature::Disabled) == 2 &&
+                  static_cast<uint32_t>(IsaFeature::Enabled) == 3,
+              "Isa::Id feature encoding relies on IsaFeature values");
+
+constexpr Isa::Id Isa::kIdVersionMask;
+constexpr uint32_t Isa::kIdSrameccShift;
+constexpr uint32_t Isa::kIdXnackShift;
+constexpr uint32_t Isa::kIdWave32Shift;
+
 /* static */
 bool Isa::IsCompatible(const Isa &code_object_isa,
                        const Isa &agent_isa) {
-  if (code_object_isa.GetVersion() != agent_isa.GetVersion())
-    return false;
-
-  assert(code_object_isa.IsSrameccSupported() == agent_isa.IsSrameccSupported()  && agent_isa.GetSramecc() != IsaFeature::Any);
-  if ((code_object_isa.GetSramecc() == IsaFeature::Enabled ||
-        code_object_isa.GetSramecc() == IsaFeature::Disabled) &&
-      code_object_isa.GetSramecc() != agent_isa.GetSramecc())
-    return false;
-
-  assert(code_object_isa.IsXnackSupported() == agent_isa.IsXnackSupported() && agent_isa.GetXnack() != IsaFeature::Any);
-  if ((code_object_isa.GetXnack() == IsaFeature::Enabled ||
-        code_object_isa.GetXnack() == IsaFeature::Disabled) &&
-      code_object_isa.GetXnack() != agent_isa.GetXnack())
-    return false;
+  assert(code_object_isa.GetVersion() != agent_isa.GetVersion() ||
+         (code_object_isa.IsSrameccSupported() == agent_isa.IsSrameccSupported() &&
+          agent_isa.GetSramecc() != IsaFeature::Any));
+  assert(code_object_isa.GetVersion() != agent_isa.GetVersion() ||
+         (code_object_isa.IsXnackSupported() == agent_isa.IsXnackSupported() &&
+          agent_isa.GetXnack() != IsaFeature::Any));
+  return IsCompatible(code_object_isa.GetId(), agent_isa.GetId());
+}
 
-  return true;
+Isa::Id Isa::MakeId() const {
+  assert(GetMajorVersion() >= 0 && GetMajorVersion() < 256);
+  assert(GetMinorVersion() >= 0 && GetMinorVersion() < 256);
+  assert(GetStepping() >= 0 && GetStepping() < 256);
+  return (Id(GetMajorVersion()) << 16) | (Id(GetMinorVersion()) << 8) | Id(GetStepping()) |
+      (Id(sramecc_) << kIdSrameccShift) | (Id(xnack_) << kIdXnackShift) |
+      (Id(wavefront_.num_threads_ == 32) << kIdWave32Shift);
 }
 
 std::string Isa::GetProcessorName() const {
@@ -233,6 +244,8 @@ constexpr size_t hsa_name_size = 63;
   amd_amdgpu_##maj##min##stp##_SRAMECC_##sramecc##_XNACK_##xnack##_WAVEFRONTSIZE_##wavefrontsize.sramecc_ = sramecc;                      \
   amd_amdgpu_##maj##min##stp##_SRAMECC_##sramecc##_XNACK_##xnack##_WAVEFRONTSIZE_##wavefrontsize.xnack_ = xnack;                          \
   amd_amdgpu_##maj##min##stp##_SRAMECC_##sramecc##_XNACK_##xnack##_WAVEFRONTSIZE_##wavefrontsize.wavefront_.num_threads_ = wavefrontsize; \
+  amd_amdgpu_##maj##min##stp##_SRAMECC_##sramecc##_XNACK_##xnack##_WAVEFRONTSIZE_##wavefrontsize.id_ =                                   \
+      amd_amdgpu_##maj##min##stp##_SRAMECC_##sramecc##_XNACK_##xnack##_WAVEFRONTSIZE_##wavefrontsize.MakeId();                             \
   supported_isas.insert(std::make_pair(                                                                                                   \
       amd_amdgpu_##maj##min##stp##_SRAMECC_##sramecc##_XNACK_##xnack##_WAVEFRONTSIZE_##wavefrontsize.GetIsaName(),                        \
       std::ref(amd_amdgpu_##maj##min##stp##_SRAMECC_##sramecc##_XNACK_##xnack##_WAVEFRONTSIZE_##wavefrontsize)));                           \
@@ -362,5 +375,33 @@ constexpr size_t hsa_name_size = 63;
   return supported_isas;
 }
 
+IsaBundleIndex::IsaBundleIndex(const char *const *isa_names, size_t count) {
+  constexpr char hsa_isa_name_prefix[] = "amdgcn-amd-amdhsa--";
+  for (size_t i = 0; i < count; ++i) {
+    if (isa_names[i] == nullptr) continue;
+    // Skip the offload kind of bundle entry IDs such as "hipv4-".
+    const char *name = strstr(isa_names[i], hsa_isa_name_prefix);
+    if (name == nullptr) continue;
+    const Isa *isa = IsaRegistry::GetIsa(std::string(name));
+    if (isa == nullptr) continue;
+    entries_[isa->GetId() & Isa::kIdVersionMask].push_back({isa->GetId(), int32_t(i)});
+  }
+  for (auto &version : entries_) {
+    std::stable_sort(version.second.begin(), version.second.end(),
+                     [](const Entry &lhs, const Entry &rhs) {
+                       return Isa::Specificity(lhs.id) > Isa::Specificity(rhs.id);
+                     });
+  }
+}
+
+int32_t IsaBundleIndex::Select(const Isa &agent_isa) const {
+  auto version = entries_.find(agent_isa.GetId() & Isa::kIdVersionMask);
+  if (version == entries_.end()) return -1;
+  for (const Entry &entry : version->second) {
+    if (Isa::IsCompatible(entry.id, agent_isa.GetId())) return entry.index;
+  }
+  return -1;
+}
+
 } // namespace core
 } // namespace rocr
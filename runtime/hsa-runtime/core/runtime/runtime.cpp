@@ -45,6 +45,7 @@
 #include <climits>
 #include <cstring>
 #include <regex>
+#include <set>
 #include <string>
 #include <vector>
 #include <list>
@@ -76,6 +77,7 @@
 #include "core/inc/hsa_ext_amd_impl.h"
 #include "core/inc/hsa_api_trace_int.h"
 #include "core/util/os.h"
+#include "core/util/trace.h"
 #include "core/inc/exceptions.h"
 #include "inc/hsa_ven_amd_aqlprofile.h"
 #include "core/inc/amd_core_dump.hpp"
@@ -349,6 +351,7 @@ hsa_status_t Runtime::AllocateMemory(const MemoryRegion* region, size_t size,
   if (status == HSA_STATUS_SUCCESS) {
     ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
     allocation_map_[*address] = AllocationRegion(region, size, size_requested, alloc_flags);
+    trace::Record(trace::kAllocate, trace::kInstant, uintptr_t(*address), size);
   }
 
   return status;
@@ -359,6 +362,8 @@ hsa_status_t Runtime::FreeMemory(void* ptr) {
     return HSA_STATUS_SUCCESS;
   }
 
+  trace::Record(trace::kFree, trace::kInstant, uintptr_t(ptr));
+
   const MemoryRegion* region = nullptr;
   size_t size = 0;
   std::unique_ptr<std::vector<AllocationRegion::notifier_t>> notifiers;
@@ -400,6 +405,9 @@ hsa_status_t Runtime::FreeMemory(void* ptr) {
   if (alloc_flags & core::MemoryRegion::AllocateAsan)
     assert(hsaKmtReturnAsanHeaderPage(ptr) == HSAKMT_STATUS_SUCCESS);
 
+  // Drop any IPC export so its cached dmabuf FD doesn't pin the memory.
+  if (ipc_dmabuf_server_) ipc_dmabuf_server_->Unregister(ptr);
+
   const hsa_status_t err = region->Free(ptr, size);
   if (err != HSA_STATUS_SUCCESS) {
     // hsaKmtFreeMemory failed to free this pointer. Throw a memory error event
@@ -413,40 +421,133 @@ hsa_status_t Runtime::FreeMemory(void* ptr) {
     // But this is a very unlikely use case and calling region->Free(..) before updating
     // allocation_map_ would require us to hold the memory_lock_ for much longer and we would not be
     // able to call hsaKmtReturnAsanHeaderPage after calling region->Free(..)
+    ReportFreeFailure(region, ptr);
+    return HSA_STATUS_ERROR;
+  }
 
-    const core::Agent* agentOwner = region->owner();
-    hsa_status_t custom_handler_status = HSA_STATUS_ERROR;
-    auto system_event_handlers = runtime_singleton_->GetSystemEventHandlers();
+  return HSA_STATUS_SUCCESS;
+}
 
-    if (!system_event_handlers.empty()) {
-      hsa_amd_event_t memory_error_event;
-      memory_error_event.event_type = HSA_AMD_GPU_MEMORY_ERROR_EVENT;
-      hsa_amd_gpu_memory_error_info_t& error_info = memory_error_event.memory_error;
+void Runtime::ReportFreeFailure(const MemoryRegion* region, void* ptr) {
+  const core::Agent* agentOwner = region->owner();
+  hsa_status_t custom_handler_status = HSA_STATUS_ERROR;
+  auto system_event_handlers = runtime_singleton_->GetSystemEventHandlers();
 
-      error_info.virtual_address = reinterpret_cast<const uint64_t>(ptr);
-      error_info.error_reason_mask = HSA_AMD_MEMORY_ERROR_MEMORY_IN_USE;
-      error_info.agent = Agent::Convert(agentOwner);
+  if (!system_event_handlers.empty()) {
+    hsa_amd_event_t memory_error_event;
+    memory_error_event.event_type = HSA_AMD_GPU_MEMORY_ERROR_EVENT;
+    hsa_amd_gpu_memory_error_info_t& error_info = memory_error_event.memory_error;
 
-      for (auto& callback : system_event_handlers) {
-        hsa_status_t err = callback.first(&memory_error_event, callback.second);
-        if (err == HSA_STATUS_SUCCESS) custom_handler_status = HSA_STATUS_SUCCESS;
-      }
+    error_info.virtual_address = reinterpret_cast<const uint64_t>(ptr);
+    error_info.error_reason_mask = HSA_AMD_MEMORY_ERROR_MEMORY_IN_USE;
+    error_info.agent = Agent::Convert(agentOwner);
+
+    for (auto& callback : system_event_handlers) {
+      hsa_status_t err = callback.first(&memory_error_event, callback.second);
+      if (err == HSA_STATUS_SUCCESS) custom_handler_status = HSA_STATUS_SUCCESS;
+    }
+  }
+  // No custom VM fault handler registered or it failed.
+  if (custom_handler_status != HSA_STATUS_SUCCESS) {
+    fprintf(stderr,
+            "Memory critical error by agent node-%u (Agent handle: %p) on address %p. Reason: "
+            "Memory in use. \n",
+            agentOwner->node_id(), reinterpret_cast<void*>(agentOwner->public_handle().handle),
+            ptr);
+
+    assert(false && "GPU memory error.");
+    std::abort();
+  }
+}
+
+hsa_status_t Runtime::FreeMemoryAsync(void* ptr, hsa_signal_t dependency) {
+  if (ptr == nullptr) {
+    return HSA_STATUS_SUCCESS;
+  }
+
+  // Remove the allocation from the map right away so that the address can't be freed twice or
+  // resolved by pointer queries while the release is pending.  The VA stays reserved until the
+  // reclaim so it can't be handed out again in the meantime.
+  std::unique_ptr<PendingFree> entry;
+  {
+    ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+
+    std::map<const void*, AllocationRegion>::iterator it = allocation_map_.find(ptr);
+    if (it == allocation_map_.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+
+    // Imported fragments can't be released with FreeMemory.
+    if (it->second.region == nullptr) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+    entry.reset(new PendingFree(ptr, std::move(it->second)));
+    allocation_map_.erase(it);
+  }
+
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  {
+    ScopedAcquire<KernelMutex> lock(&pending_free_lock_);
+
+    // Frees sharing a dependency are reclaimed by a single handler.  A null dependency runs the
+    // handler as an async function.
+    auto& pending = pending_frees_[dependency.handle];
+    if (pending.empty())
+      err = SetAsyncSignalHandler(dependency, HSA_SIGNAL_CONDITION_EQ, 0, PendingFreeHandler,
+                                  reinterpret_cast<void*>(dependency.handle));
+
+    if (err == HSA_STATUS_SUCCESS) {
+      pending.push_back(std::move(*entry));
+      return HSA_STATUS_SUCCESS;
     }
-    // No custom VM fault handler registered or it failed.
-    if (custom_handler_status != HSA_STATUS_SUCCESS) {
-      fprintf(stderr,
-              "Memory critical error by agent node-%u (Agent handle: %p) on address %p. Reason: "
-              "Memory in use. \n",
-              agentOwner->node_id(), reinterpret_cast<void*>(agentOwner->public_handle().handle),
-              ptr);
+    pending_frees_.erase(dependency.handle);
+  }
+
+  // Handler registration failed, the allocation is still live.
+  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+  allocation_map_[ptr] = std::move(entry->allocation);
+  return err;
+}
 
-      assert(false && "GPU memory error.");
-      std::abort();
+bool Runtime::PendingFreeHandler(hsa_signal_value_t value, void* arg) {
+  runtime_singleton_->ReclaimPendingFrees(reinterpret_cast<uint64_t>(arg));
+  return false;
+}
+
+void Runtime::ReclaimPendingFrees(uint64_t signal_handle) {
+  std::vector<PendingFree> frees;
+  {
+    ScopedAcquire<KernelMutex> lock(&pending_free_lock_);
+    auto it = pending_frees_.find(signal_handle);
+    if (it == pending_frees_.end()) return;
+    frees = std::move(it->second);
+    pending_frees_.erase(it);
+  }
+
+  // Notifiers run without locks held, as in FreeMemory.  Blocks are grouped by region so each
+  // region can unmap its blocks with one batched call.
+  std::map<const MemoryRegion*, std::vector<std::pair<void*, size_t>>> blocks;
+  for (auto& entry : frees) {
+    AllocationRegion& allocation = entry.allocation;
+    if (allocation.notifiers) {
+      for (auto& notifier : *allocation.notifiers) {
+        notifier.callback(notifier.ptr, notifier.user_data);
+      }
     }
-    return HSA_STATUS_ERROR;
+
+    if (allocation.alloc_flags & core::MemoryRegion::AllocateAsan)
+      assert(hsaKmtReturnAsanHeaderPage(entry.ptr) == HSAKMT_STATUS_SUCCESS);
+
+    if (ipc_dmabuf_server_) ipc_dmabuf_server_->Unregister(entry.ptr);
+
+    blocks[allocation.region].push_back(std::make_pair(entry.ptr, allocation.size));
   }
 
-  return HSA_STATUS_SUCCESS;
+  std::vector<hsa_status_t> status;
+  for (auto& region_blocks : blocks) {
+    region_blocks.first->FreeBatch(region_blocks.second, status);
+    for (size_t i = 0; i < status.size(); i++) {
+      if (status[i] != HSA_STATUS_SUCCESS)
+        ReportFreeFailure(region_blocks.first, region_blocks.second[i].first);
+    }
+  }
 }
 
 hsa_status_t Runtime::RegisterReleaseNotifier(void* ptr, hsa_amd_deallocation_callback_t callback,
@@ -1096,119 +1197,6 @@ hsa_status_t Runtime::SetPtrInfoData(const void* ptr, void* userptr) {
   return HSA_STATUS_ERROR_INVALID_ARGUMENT;
 }
 
-// Send the dmabuf_fd to from process via Unix socket
-static int SendDmaBufFd(int socket, int dmabuf_fd) {
-  char iov_buf[1];
-  struct msghdr msg = {0};
-  char buf[CMSG_SPACE(sizeof(dmabuf_fd))];
-
-  memset(buf, 0, sizeof(buf));
-  memset(iov_buf, 0, sizeof(iov_buf));
-  iov_buf[0] = 'y';
-
-  struct iovec io = {.iov_base = iov_buf, .iov_len = 1};
-
-  msg.msg_iov = &io;
-  msg.msg_iovlen = 1;
-  msg.msg_control = buf;
-  msg.msg_controllen = sizeof(buf);
-
-  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
-  cmsg->cmsg_level = SOL_SOCKET;
-  cmsg->cmsg_type = SCM_RIGHTS;
-  cmsg->cmsg_len = CMSG_LEN(sizeof(dmabuf_fd));
-
-  memcpy(CMSG_DATA(cmsg), &dmabuf_fd, sizeof(dmabuf_fd));
-
-  msg.msg_controllen = CMSG_SPACE(sizeof(dmabuf_fd));
-
-  size_t sent = sendmsg(socket, &msg, 0);
-
-  return (sent < 0) ? -1 : 0;
-}
-
-// Receive the dmabuf_fd to from process via Unix socket
-static int ReceiveDmaBufFd(int socket) {
-  struct msghdr msg = {0};
-
-  // The struct iovec is needed, even if it points to minimal data
-  char m_buffer[1];
-  struct iovec io = {.iov_base = m_buffer, .iov_len = sizeof(m_buffer)};
-  msg.msg_iov = &io;
-  msg.msg_iovlen = 1;
-
-  char c_buffer[256];
-  msg.msg_control = c_buffer;
-  msg.msg_controllen = sizeof(c_buffer);
-
-  size_t rcv = recvmsg(socket, &msg, MSG_WAITALL);
-  if (rcv < 0) return -1;
-
-  while (!rcv)
-    rcv = recvmsg(socket, &msg, MSG_WAITALL);
-
-  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
-
-  int fd;
-  memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
-
-  return fd;
-}
-
-#define IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH 64
-#define IPC_SOCK_SERVER_NAME_LENGTH 32
-#define IPC_SOCK_SERVER_CONN_CLOSE_HANDLE UINT64_MAX
-void Runtime::AsyncIPCSockServerConnLoop(void*) {
-   auto& ipc_sock_server_fd_ = runtime_singleton_->ipc_sock_server_fd_;
-   auto& ipc_sock_server_conns_ = runtime_singleton_->ipc_sock_server_conns_;
-   auto& ipc_sock_server_lock_ = runtime_singleton_->ipc_sock_server_lock_;
-
-   int connection_fd;
-   char buf[IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH];
-   // Wait until the client has connected
-   while (1) {
-     connection_fd = accept(ipc_sock_server_fd_, NULL, NULL);
-     if (connection_fd == -1) continue;
-     MAKE_SCOPE_GUARD([&]() { close(connection_fd); });
-     if (read(connection_fd, buf, sizeof(buf)) == -1)
-       continue;
-
-     // Request to kill the server.
-     uint64_t conn_handle = strtoull(buf, NULL, 10);
-     if (conn_handle == IPC_SOCK_SERVER_CONN_CLOSE_HANDLE)
-       break;
-
-     int dmabuf_fd = -1;
-     uint64_t fragOffset;
-     void *ptr = NULL;
-     size_t len = 0;
-
-     // Search for registered export pointer
-     ScopedAcquire<KernelMutex> lock(&ipc_sock_server_lock_);
-     for (auto& conns : ipc_sock_server_conns_) {
-       if (conn_handle == conns.first) {
-         ptr = reinterpret_cast<void *>(conn_handle);
-         len = conns.second;
-         break;
-       }
-     }
-
-     if (!ptr) continue;
-
-     // Export DMA Buf FD and wait for client import
-     int err = hsaKmtExportDMABufHandle(ptr, len, &dmabuf_fd, &fragOffset);
-     if (err != HSAKMT_STATUS_SUCCESS) continue;
-     SendDmaBufFd(connection_fd, dmabuf_fd);
-     err = read(connection_fd, buf, sizeof(buf));
-     close(dmabuf_fd);
-     if (err == -1) break; // Client failed to confirm import so end server
-   }
-
-   // Clean up
-   ipc_sock_server_conns_.clear();
-   close(ipc_sock_server_fd_);
-}
-
 hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* handle) {
   static_assert(sizeof(hsa_amd_ipc_memory_t) == sizeof(HsaSharedMemoryHandle),
                 "Thunk IPC mismatch.");
@@ -1267,6 +1255,8 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
   handle->handle[0] = dmaBufFdHandleLo;
   handle->handle[1] = dmaBufFdHandleHi;
   handle->handle[2] = getpid(); // socket server name handle
+  // Attach caches key on the handle, so a re-export of a reused address must differ.
+  handle->handle[7] = ++ipc_export_generation_;
 
   Agent *agent = Agent::Convert(info.agentOwner);
   handle->handle[3] = agent->device_type() == Agent::kAmdCpuDevice;
@@ -1275,51 +1265,22 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
   handle->handle[4] = agent->node_id();
   if (useFrag) handle->handle[6] |= 0x80000000 | fragOffset;
 
-  // Work around to defer export on import call to minimize FD creation.
-  // Without this, a deferred export may fail due to the kernel mode driver not
-  // holding the GEM object reference.
-  // Export the dmabuf then close the file to get the reference to ensure the
-  // deferred export will not run into this problem.
+  // Export now so the kernel mode driver holds the GEM object reference that
+  // later exports from the socket server depend on.  The server keeps the FD
+  // in its cache, or re-exports on demand once evicted.
   int dmabuf_fd;
   uint64_t dmabufOffset;
   HSAKMT_STATUS err = hsaKmtExportDMABufHandle(ptr, len, &dmabuf_fd, &dmabufOffset);
   assert(dmabufOffset/pageSize == fragOffset && "DMA Buf inconsistent with pointer offset.");
   if (err != HSAKMT_STATUS_SUCCESS) return HSA_STATUS_ERROR;
-  close(dmabuf_fd);
 
-  ScopedAcquire<KernelMutex> lock(&ipc_sock_server_lock_);
-  if (!ipc_sock_server_conns_.size()) { // create new runtime socket server
-    struct sockaddr_un address;
-    ipc_sock_server_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
-    assert(ipc_sock_server_fd_ > -1 && "DMA buffer could not be exported for IPC!");
-    if (ipc_sock_server_fd_ == -1) return HSA_STATUS_ERROR;
-
-    // Use the PID as unique socket server name.
-    char socketName[IPC_SOCK_SERVER_NAME_LENGTH];
-    snprintf(socketName, IPC_SOCK_SERVER_NAME_LENGTH, "xhsa%i", handle->handle[2]);
-
-    // Initialize os socket server with client acceptance limit.
-    // Socket servers sill serialize connections and drop connections over the listen limit.
-    // The client can try and reconnect and it's unlikely that INT_MAX concurrent
-    // connections will occur.
-    memset(&address, 0, sizeof(struct sockaddr_un));
-    address.sun_family = AF_UNIX;
-    strncpy(address.sun_path, socketName, IPC_SOCK_SERVER_NAME_LENGTH);
-    address.sun_path[0] = 0; // first NULL char creates unlisted abstract socket
-    int err = bind(ipc_sock_server_fd_, (struct sockaddr *)&address, sizeof(struct sockaddr_un));
-    assert(!err && "Connection to export DMA buffer not made!");
-    if (err) return HSA_STATUS_ERROR;
-    err = listen(ipc_sock_server_fd_, 1);
-    assert(!err && "Connection to export DMA buffer not made!");
-    if (err) return HSA_STATUS_ERROR;
-
-    // Spin server client acceptance into a socket server thread.
-    // Socket server needs to last for the lifetime of the runtime instance
-    // as the attach life cycle is unknown.
-    os::CreateThread(AsyncIPCSockServerConnLoop, NULL);
-  }
-
-  ipc_sock_server_conns_[reinterpret_cast<uint64_t>(ptr)] = len;
+  // Socket server needs to last for the lifetime of the runtime instance
+  // as the attach life cycle is unknown.
+  if (!ipc_dmabuf_server_->Start(handle->handle[2])) {
+    close(dmabuf_fd);
+    return HSA_STATUS_ERROR;
+  }
+  ipc_dmabuf_server_->Register(ptr, len, dmabuf_fd);
 
   // TODO: fragment block discard for better memory performance causes memory violations
   // with DMABuf export even when synchronously called. Bypass for now.
@@ -1327,50 +1288,11 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
   return HSA_STATUS_SUCCESS;
 }
 
-int Runtime::IPCClientImport(uint32_t conn_handle, uint64_t dmabuf_fd_handle,
-                             amdgpu_bo_import_result *res,
+int Runtime::IPCClientImport(int dmabuf_fd, amdgpu_bo_import_result *res,
                              unsigned int numNodes, HSAuint32 *nodes,
                              void **importAddress, HSAuint64 *importSize) {
-    struct sockaddr_un address;
-    int dmabuf_fd = -1, socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    assert(socket_fd > -1 && "DMA buffer could not be imported for IPC!");
-    if (socket_fd == -1) return -1;
-
-    // Set 10 second timeout for ReceiveDmaBufFd
-    struct timeval tv;
-    tv.tv_sec = 10;
-    tv.tv_usec = 0;
-    setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
-
-    char buf[IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH];
-    memset(&address, 0, sizeof(struct sockaddr_un));
-    memset(buf, 0, sizeof(buf));
-    address.sun_family = AF_UNIX;
-    snprintf(address.sun_path, IPC_SOCK_SERVER_NAME_LENGTH, "xhsa%i", conn_handle);
-    address.sun_path[0] = 0; // first NULL char creates unlisted abstract socket
-
-    int timeoutLimitMs = 10000, timeoutMs = 0, timeoutIntervalMs = 1;
-    while (timeoutMs < timeoutLimitMs) {
-      if (connect(socket_fd, (struct sockaddr *) &address, sizeof(struct sockaddr_un))) {
-        timeoutMs  += timeoutIntervalMs;
-        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutIntervalMs));
-      } else {
-        break;
-      }
-    }
-
-    MAKE_SCOPE_GUARD([&]() { close(socket_fd); });
-
-    if (timeoutMs >= timeoutLimitMs) return -1;
-
-    // Ping server to export and send DMABUF FD on handle
-    snprintf(buf, sizeof(buf), "%li", dmabuf_fd_handle);
-    if (write(socket_fd, buf, sizeof(buf)) == -1) return -1;
-
-    if (dmabuf_fd_handle == IPC_SOCK_SERVER_CONN_CLOSE_HANDLE) return 0;
-
-    dmabuf_fd = ReceiveDmaBufFd(socket_fd);
     if (dmabuf_fd == -1) return -1;
+    MAKE_SCOPE_GUARD([&]() { close(dmabuf_fd); });
 
     HsaGraphicsResourceInfo info;
     HSA_REGISTER_MEM_FLAGS regFlags;
@@ -1387,22 +1309,93 @@ int Runtime::IPCClientImport(uint32_t conn_handle, uint64_t dmabuf_fd_handle,
         err = amdgpu_bo_import(agent->libDrmDev(), amdgpu_bo_handle_type_dma_buf_fd,
                                dmabuf_fd, res);
       }
-      close(dmabuf_fd);
     }
-
-    // Ping socket server to close exporter
-    if (write(socket_fd, buf, sizeof(buf)) == -1) return -1;
     return err;
 }
 
 hsa_status_t Runtime::IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len, uint32_t num_agents,
                                 Agent** agents, void** mapped_ptr) {
+  return IPCAttachBatch(1, handle, &len, num_agents, agents, mapped_ptr);
+}
+
+hsa_status_t Runtime::IPCAttachBatch(uint32_t num_handles, const hsa_amd_ipc_memory_t* handles,
+                                     const size_t* lens, uint32_t num_agents, Agent** agents,
+                                     void** mapped_ptrs) {
+  // Mappings are shared by attaches of the same handle, length and agents.
+  std::vector<IPCAttachCache::Key> keys(num_handles);
+  std::vector<uint32_t> nodes(num_agents);
+  for (uint32_t i = 0; i < num_agents; i++)
+    agents[i]->GetInfo((hsa_agent_info_t)HSA_AMD_AGENT_INFO_DRIVER_NODE_ID, &nodes[i]);
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+  std::vector<void*> attached(num_handles, nullptr);
+  MAKE_NAMED_SCOPE_GUARD(detachGuard, [&]() {
+    for (void* ptr : attached)
+      if (ptr != nullptr) IPCDetach(ptr);
+  });
+
+  std::vector<uint32_t> misses;
+  for (uint32_t i = 0; i < num_handles; i++) {
+    keys[i].handle = handles[i];
+    keys[i].len = lens[i];
+    keys[i].nodes = nodes;
+    attached[i] = ipc_attach_cache_->Acquire(keys[i]);
+    if (attached[i] == nullptr) misses.push_back(i);
+  }
+
+  std::vector<int> fds(num_handles, -1);
+  MAKE_SCOPE_GUARD([&]() {
+    for (int fd : fds)
+      if (fd != -1) close(fd);
+  });
+
+  if (ipc_dmabuf_supported_) {
+    // Group handles by exporting process, handle[2] names its socket server.
+    std::map<uint32_t, std::vector<uint32_t>> exporters;
+    for (uint32_t i : misses) exporters[handles[i].handle[2]].push_back(i);
+
+    for (auto& exporter : exporters) {
+      const std::vector<uint32_t>& index = exporter.second;
+      std::vector<uint64_t> ids(index.size());
+      std::vector<int> exporter_fds(index.size());
+      for (size_t i = 0; i < index.size(); i++) {
+        const hsa_amd_ipc_memory_t& handle = handles[index[i]];
+        ids[i] = (uint64_t(handle.handle[1]) << 32) | handle.handle[0];
+      }
+      if (!ipc_dmabuf_client_->FetchFds(exporter.first, ids.size(), &ids[0], &exporter_fds[0]))
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+      for (size_t i = 0; i < index.size(); i++) fds[index[i]] = exporter_fds[i];
+    }
+  }
+
+  for (uint32_t i : misses) {
+    int fd = fds[i];
+    fds[i] = -1;
+    hsa_status_t err = IPCImport(&handles[i], lens[i], num_agents, agents, fd, &attached[i]);
+    if (err != HSA_STATUS_SUCCESS) return err;
+    // If another thread cached the handle meanwhile this mapping stays private.
+    ipc_attach_cache_->Insert(keys[i], attached[i]);
+  }
+
+  detachGuard.Dismiss();
+  std::copy(attached.begin(), attached.end(), mapped_ptrs);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t Runtime::IPCImport(const hsa_amd_ipc_memory_t* handle, size_t len,
+                                uint32_t num_agents, Agent** agents, int dmabuf_fd,
+                                void** mapped_ptr) {
   static const int tinyArraySize = 8;
   void* importAddress;
   HSAuint64 importSize;
-  uint64_t dmaBufFDHandle = 0;
   hsa_amd_ipc_memory_t importHandle = *handle;
 
+  // Early returns must not leak the FD.
+  MAKE_SCOPE_GUARD([&]() {
+    if (dmabuf_fd != -1) close(dmabuf_fd);
+  });
+
   // Extract fragment info
   bool isFragment = false;
   uint32_t fragOffset = 0;
@@ -1420,9 +1413,10 @@ hsa_status_t Runtime::IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len,
 
   auto importMemory = [&](unsigned int numNodes, HSAuint32 *nodes,
                           amdgpu_bo_import_result *res) {
+    int fd = dmabuf_fd;
+    dmabuf_fd = -1;
     int ret = ipc_dmabuf_supported_ ?
-          IPCClientImport(importHandle.handle[2], dmaBufFDHandle, res,
-                          numNodes, nodes, &importAddress, &importSize) :
+          IPCClientImport(fd, res, numNodes, nodes, &importAddress, &importSize) :
           hsaKmtRegisterSharedHandle(reinterpret_cast<const HsaSharedMemoryHandle*>(&importHandle),
                                      &importAddress, &importSize);
     if (ret != HSAKMT_STATUS_SUCCESS) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
@@ -1462,12 +1456,6 @@ hsa_status_t Runtime::IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len,
     importHandle.handle[6] &= ~(0x80000000 | 0x1FF);
   }
 
-  if (ipc_dmabuf_supported_) {
-    uint64_t dmaBufFDHandleLo = importHandle.handle[0];
-    uint64_t dmaBufFDHandleHi = importHandle.handle[1];
-    dmaBufFDHandle = (dmaBufFDHandleHi << 32) | dmaBufFDHandleLo;
-  }
-
   if (num_agents == 0) {
     amdgpu_bo_import_result res;
     bool isDmabufSysMem = ipc_dmabuf_supported_ && importHandle.handle[3];
@@ -1519,6 +1507,34 @@ hsa_status_t Runtime::IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len,
 }
 
 hsa_status_t Runtime::IPCDetach(void* ptr) {
+  std::vector<void*> unmap;
+  switch (ipc_attach_cache_->Release(ptr, unmap)) {
+    case IPCAttachCache::kReleased:
+      break;
+    case IPCAttachCache::kNotCached:
+      return IPCUnmap(ptr);
+    case IPCAttachCache::kNotReferenced:
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  // Mappings evicted from the cache are no longer known to the application.
+  for (void* evicted : unmap) {
+    hsa_status_t err = IPCUnmap(evicted);
+    debug_warning(err == HSA_STATUS_SUCCESS && "Failed to unmap cached IPC mapping.");
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+void Runtime::IPCCachePurge() {
+  std::vector<void*> unmap;
+  ipc_attach_cache_->Purge(unmap);
+  for (void* evicted : unmap) {
+    hsa_status_t err = IPCUnmap(evicted);
+    debug_warning(err == HSA_STATUS_SUCCESS && "Failed to unmap cached IPC mapping.");
+  }
+}
+
+hsa_status_t Runtime::IPCUnmap(void* ptr) {
   bool ldrmImportCleaned = false;
   {  // Handle imported fragments.
     ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
@@ -1947,7 +1963,8 @@ Runtime::Runtime()
       hw_exception_event_(nullptr),
       hw_exception_signal_(nullptr),
       ref_count_(0),
-      kfd_version{} {
+      kfd_version{},
+      ipc_export_generation_(0) {
 
   asyncSignals_.monitor_exceptions = false;
   asyncExceptions_.monitor_exceptions = true;
@@ -1979,7 +1996,10 @@ hsa_status_t Runtime::Load() {
   g_use_interrupt_wait = flag_.enable_interrupt();
   g_use_mwaitx = flag_.check_mwaitx(cpuinfo.mwaitx);
 
+  trace::Start(flag_.trace_file(), flag_.trace_buffer_size());
+
   if (!AMD::Load()) {
+    trace::Stop();
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
 
@@ -2014,6 +2034,11 @@ hsa_status_t Runtime::Load() {
 
   // Initialize IPC support mode
   InitIPCDmaBufSupport();
+  ipc_attach_cache_.reset(new IPCAttachCache(flag().ipc_attach_cache_size()));
+  if (ipc_dmabuf_supported_) {
+    ipc_dmabuf_server_.reset(new IPCDmaBufServer(flag().ipc_dmabuf_fd_cache_size()));
+    ipc_dmabuf_client_.reset(new IPCDmaBufClient());
+  }
 
   // Load svm profiler
   svm_profile_.reset(new AMD::SvmProfileControl);
@@ -2022,18 +2047,34 @@ hsa_status_t Runtime::Load() {
 }
 
 void Runtime::Unload() {
-  // Close IPC socket server
-  if (ipc_sock_server_conns_.size())
-    IPCClientImport(getpid(), IPC_SOCK_SERVER_CONN_CLOSE_HANDLE,
-                    NULL, 0, NULL, NULL, NULL);
+  // Unmap cached IPC mappings no longer attached.
+  if (ipc_attach_cache_) {
+    IPCCachePurge();
+    ipc_attach_cache_.reset();
+  }
 
+  // Close IPC socket server and pooled client connections
+  ipc_dmabuf_server_.reset();
+  ipc_dmabuf_client_.reset();
+
+  // The profiler may issue prefetches when applying hints.
   svm_profile_.reset(nullptr);
 
+  ShutdownPrefetchQueue();
+
+  // Frees still waiting on their dependency are released with the rest of the process' memory.
+  {
+    ScopedAcquire<KernelMutex> lock(&pending_free_lock_);
+    pending_frees_.clear();
+  }
+
   UnloadTools();
   UnloadExtensions();
 
   amd::hsa::loader::Loader::Destroy(loader_);
   loader_ = nullptr;
+  loader_context_.ReleaseStagingArena();
+  loader_context_.ReleaseSharedSegments();
 
   std::for_each(gpu_agents_.begin(), gpu_agents_.end(), DeleteObject());
   gpu_agents_.clear();
@@ -2069,6 +2110,8 @@ void Runtime::Unload() {
   DestroyDrivers();
 
   AMD::Unload();
+
+  trace::Stop();
 }
 
 void Runtime::LoadExtensions() {
@@ -2485,10 +2528,24 @@ void Runtime::InternalQueueCreateNotify(const hsa_queue_t* queue, hsa_agent_t ag
 hsa_status_t Runtime::SetSvmAttrib(void* ptr, size_t size,
                                    hsa_amd_svm_attribute_pair_t* attribute_list,
                                    size_t attribute_count) {
+  std::vector<HSA_SVM_ATTRIBUTE> attribs;
+  ConvertSvmAttribs(attribute_list, attribute_count, attribs);
+
+  uint8_t* base = AlignDown((uint8_t*)ptr, 4096);
+  uint8_t* end = AlignUp((uint8_t*)ptr + size, 4096);
+  size_t len = end - base;
+  HSAKMT_STATUS error = hsaKmtSVMSetAttr(base, len, attribs.size(), &attribs[0]);
+  if (error != HSAKMT_STATUS_SUCCESS)
+    throw AMD::hsa_exception(HSA_STATUS_ERROR, "hsaKmtSVMSetAttr failed.");
+
+  return HSA_STATUS_SUCCESS;
+}
+
+void Runtime::ConvertSvmAttribs(hsa_amd_svm_attribute_pair_t* attribute_list,
+                                size_t attribute_count, std::vector<HSA_SVM_ATTRIBUTE>& attribs) {
   uint32_t set_attribs = 0;
   std::vector<bool> agent_seen(max_node_id() + 1, false);
 
-  std::vector<HSA_SVM_ATTRIBUTE> attribs;
   attribs.reserve(attribute_count);
   uint32_t set_flags = 0;
   uint32_t clear_flags = 0;
@@ -2642,20 +2699,35 @@ hsa_status_t Runtime::SetSvmAttrib(void* ptr, size_t size,
   // Add flag updates
   if (clear_flags) attribs.push_back(kmtPair(HSA_SVM_ATTR_CLR_FLAGS, clear_flags));
   if (set_flags) attribs.push_back(kmtPair(HSA_SVM_ATTR_SET_FLAGS, set_flags));
+}
 
-  uint8_t* base = AlignDown((uint8_t*)ptr, 4096);
-  uint8_t* end = AlignUp((uint8_t*)ptr + size, 4096);
-  size_t len = end - base;
-  HSAKMT_STATUS error = hsaKmtSVMSetAttr(base, len, attribs.size(), &attribs[0]);
-  if (error != HSAKMT_STATUS_SUCCESS)
-    throw AMD::hsa_exception(HSA_STATUS_ERROR, "hsaKmtSVMSetAttr failed.");
-
-  return HSA_STATUS_SUCCESS;
+// Throws for attributes which can't be queried, shared by the synchronous and
+// asynchronous queries so they accept the same attributes.
+static void ValidateSvmGetAttribs(const hsa_amd_svm_attribute_pair_t* attribute_list,
+                                  size_t attribute_count) {
+  for (size_t i = 0; i < attribute_count; i++) {
+    switch (attribute_list[i].attribute) {
+      case HSA_AMD_SVM_ATTRIB_GLOBAL_FLAG:
+      case HSA_AMD_SVM_ATTRIB_READ_ONLY:
+      case HSA_AMD_SVM_ATTRIB_HIVE_LOCAL:
+      case HSA_AMD_SVM_ATTRIB_MIGRATION_GRANULARITY:
+      case HSA_AMD_SVM_ATTRIB_PREFERRED_LOCATION:
+      case HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION:
+      case HSA_AMD_SVM_ATTRIB_READ_MOSTLY:
+      case HSA_AMD_SVM_ATTRIB_ACCESS_QUERY:
+        break;
+      default:
+        throw AMD::hsa_exception(HSA_STATUS_ERROR_INVALID_ARGUMENT,
+                                 "Illegal or invalid attribute in Runtime::GetSvmAttrib");
+    }
+  }
 }
 
 hsa_status_t Runtime::GetSvmAttrib(void* ptr, size_t size,
                                    hsa_amd_svm_attribute_pair_t* attribute_list,
                                    size_t attribute_count) {
+  ValidateSvmGetAttribs(attribute_list, attribute_count);
+
   std::vector<HSA_SVM_ATTRIBUTE> attribs;
   attribs.reserve(attribute_count);
 
@@ -2717,8 +2789,8 @@ hsa_status_t Runtime::GetSvmAttrib(void* ptr, size_t size,
         break;
       }
       default:
-        throw AMD::hsa_exception(HSA_STATUS_ERROR_INVALID_ARGUMENT,
-                                 "Illegal or invalid attribute in Runtime::SetSvmAttrib");
+        assert(false && "SVM attribute accepted by ValidateSvmGetAttribs is not handled.");
+        throw AMD::hsa_exception(HSA_STATUS_ERROR, "Unhandled attribute in Runtime::GetSvmAttrib");
     }
   }
 
@@ -2825,15 +2897,12 @@ hsa_status_t Runtime::SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent,
   else
     op->node_id = dest->node_id();
 
+  op->type = PrefetchOp::kPrefetch;
   op->base = reinterpret_cast<void*>(base);
   op->size = len;
   op->completion = completion_signal;
-  if (num_dep_signals > 1) {
-    op->remaining_deps = num_dep_signals - 1;
-    for (int i = 0; i < num_dep_signals - 1; i++) op->dep_signals.push_back(dep_signals[i]);
-  } else {
-    op->remaining_deps = 0;
-  }
+  op->dep_signals.assign(dep_signals, dep_signals + num_dep_signals);
+  for (hsa_signal_t dep : op->dep_signals) Signal::Convert(dep);
 
   {
     ScopedAcquire<KernelMutex> lock(&prefetch_lock_);
@@ -2897,57 +2966,372 @@ hsa_status_t Runtime::SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent,
     it->second.next = it->second.prev = prefetch_map_.end();
   }
 
-  // Remove the prefetch's ranges from the map.
-  static auto removePrefetchRanges = [](PrefetchOp* op) {
-    ScopedAcquire<KernelMutex> lock(&Runtime::runtime_singleton_->prefetch_lock_);
-    auto it = op->prefetch_map_entry;
-    while (it != Runtime::runtime_singleton_->prefetch_map_.end()) {
-      auto next = it->second.next;
-      Runtime::runtime_singleton_->prefetch_map_.erase(it);
-      it = next;
+  MAKE_NAMED_SCOPE_GUARD(RangeGuard, [&]() { RemovePrefetchRanges({op}); });
+
+  QueuePrefetchOp(op);
+
+  RangeGuard.Dismiss();
+  OpGuard.Dismiss();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t Runtime::SetSvmAttribAsync(void* ptr, size_t size,
+                                        hsa_amd_svm_attribute_pair_t* attribute_list,
+                                        size_t attribute_count, uint32_t num_dep_signals,
+                                        const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal) {
+  uintptr_t base = reinterpret_cast<uintptr_t>(AlignDown(ptr, 4096));
+  uintptr_t end = AlignUp(reinterpret_cast<uintptr_t>(ptr) + size, 4096);
+
+  PrefetchOp* op = new PrefetchOp();
+  MAKE_NAMED_SCOPE_GUARD(OpGuard, [&]() { delete op; });
+  ConvertSvmAttribs(attribute_list, attribute_count, op->attribs);
+
+  op->type = PrefetchOp::kSetAttrib;
+  op->base = reinterpret_cast<void*>(base);
+  op->size = end - base;
+  op->completion = completion_signal;
+  op->dep_signals.assign(dep_signals, dep_signals + num_dep_signals);
+  for (hsa_signal_t dep : op->dep_signals) Signal::Convert(dep);
+  op->prefetch_map_entry = prefetch_map_.end();
+
+  QueuePrefetchOp(op);
+
+  OpGuard.Dismiss();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t Runtime::GetSvmAttribAsync(void* ptr, size_t size,
+                                        hsa_amd_svm_attribute_pair_t* attribute_list,
+                                        size_t attribute_count, uint32_t num_dep_signals,
+                                        const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal) {
+  // Other errors are only known once the query runs and are reported through
+  // the completion signal.
+  ValidateSvmGetAttribs(attribute_list, attribute_count);
+
+  PrefetchOp* op = new PrefetchOp();
+  MAKE_NAMED_SCOPE_GUARD(OpGuard, [&]() { delete op; });
+  op->type = PrefetchOp::kGetAttrib;
+  op->base = ptr;
+  op->size = size;
+  op->completion = completion_signal;
+  op->dep_signals.assign(dep_signals, dep_signals + num_dep_signals);
+  for (hsa_signal_t dep : op->dep_signals) Signal::Convert(dep);
+  op->prefetch_map_entry = prefetch_map_.end();
+  op->attribute_list = attribute_list;
+  op->attribute_count = attribute_count;
+
+  QueuePrefetchOp(op);
+
+  OpGuard.Dismiss();
+  return HSA_STATUS_SUCCESS;
+}
+
+void Runtime::QueuePrefetchOp(PrefetchOp* op) {
+  {
+    ScopedAcquire<KernelMutex> lock(&prefetch_queue_.lock);
+    // Lazy initializer
+    if (prefetch_queue_.thread == NULL) {
+      hsa_status_t err = HSA::hsa_signal_create(0, 0, NULL, &prefetch_queue_.wake);
+      if (err != HSA_STATUS_SUCCESS)
+        throw AMD::hsa_exception(err, "Prefetch control signal creation error.");
+      prefetch_queue_.exit = false;
+      prefetch_queue_.thread = os::CreateThread(SvmPrefetchLoop, this);
+      if (prefetch_queue_.thread == NULL) {
+        HSA::hsa_signal_destroy(prefetch_queue_.wake);
+        throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES,
+                                 "Prefetch thread creation error.");
+      }
     }
-  };
+    // Dependencies are in use until seen satisfied.
+    for (hsa_signal_t dep : op->dep_signals) hsa_signal_handle(dep)->Retain();
+    prefetch_queue_.submitted.push_back(op);
+  }
+  hsa_signal_handle(prefetch_queue_.wake)->StoreRelease(1);
+}
+
+void Runtime::SvmPrefetchLoop(void* runtime) {
+  Runtime* self = reinterpret_cast<Runtime*>(runtime);
+  PrefetchQueue& queue = self->prefetch_queue_;
 
-  // Prefetch Signal handler for synchronization.
-  static hsa_amd_signal_handler signal_handler = [](hsa_signal_value_t value, void* arg) {
-    PrefetchOp* op = reinterpret_cast<PrefetchOp*>(arg);
+  // Prefetches waiting on dependencies, in submission order.
+  std::vector<PrefetchOp*> waiting;
+  std::vector<PrefetchOp*> batch;
+  std::vector<hsa_signal_t> signals;
+  std::vector<hsa_signal_condition_t> conds;
+  std::vector<hsa_signal_value_t> values;
 
-    if (op->remaining_deps > 0) {
-      op->remaining_deps--;
-      Runtime::runtime_singleton_->SetAsyncSignalHandler(
-          op->dep_signals[op->remaining_deps], HSA_SIGNAL_CONDITION_EQ, 0, signal_handler, arg);
-      return false;
+  while (true) {
+    {
+      ScopedAcquire<KernelMutex> lock(&queue.lock);
+      if (queue.exit) break;
+      waiting.insert(waiting.end(), queue.submitted.begin(), queue.submitted.end());
+      queue.submitted.clear();
+    }
+
+    // Prefetches whose dependencies are all satisfied form the next batch.
+    batch.clear();
+    size_t kept = 0;
+    for (PrefetchOp* op : waiting) {
+      auto& deps = op->dep_signals;
+      while (!deps.empty() && hsa_signal_handle(deps.back())->LoadAcquire() == 0) {
+        hsa_signal_handle(deps.back())->Release();
+        deps.pop_back();
+      }
+      if (deps.empty())
+        batch.push_back(op);
+      else
+        waiting[kept++] = op;
     }
+    waiting.resize(kept);
 
-    HSA_SVM_ATTRIBUTE attrib;
-    attrib.type = HSA_SVM_ATTR_PREFETCH_LOC;
-    attrib.value = op->node_id;
-    HSAKMT_STATUS error = hsaKmtSVMSetAttr(op->base, op->size, 1, &attrib);
-    assert(error == HSAKMT_STATUS_SUCCESS && "KFD Prefetch failed.");
+    if (!batch.empty()) {
+      self->IssuePrefetchBatch(batch);
+      continue;
+    }
 
-    removePrefetchRanges(op);
+    // Wait for new prefetches or any outstanding dependency.  Each waiting
+    // prefetch contributes the dependency it is blocked on.
+    signals.assign(1, queue.wake);
+    conds.assign(1, HSA_SIGNAL_CONDITION_NE);
+    values.assign(1, 0);
+    std::set<uint64_t> blocking;
+    for (PrefetchOp* op : waiting) {
+      hsa_signal_t dep = op->dep_signals.back();
+      if (!blocking.insert(dep.handle).second) continue;
+      signals.push_back(dep);
+      conds.push_back(HSA_SIGNAL_CONDITION_EQ);
+      values.push_back(0);
+    }
 
-    if (op->completion.handle != 0) Signal::Convert(op->completion)->SubRelaxed(1);
+    hsa_signal_value_t value;
+    uint32_t index = AMD::hsa_amd_signal_wait_any(uint32_t(signals.size()), &signals[0],
+                                                  &conds[0], &values[0], uint64_t(-1),
+                                                  HSA_WAIT_STATE_BLOCKED, &value);
+    if (index == 0) hsa_signal_handle(queue.wake)->StoreRelaxed(0);
+  }
+
+  waiting.insert(waiting.end(), queue.submitted.begin(), queue.submitted.end());
+  queue.submitted.clear();
+  self->RemovePrefetchRanges(waiting);
+  for (PrefetchOp* op : waiting) {
+    for (hsa_signal_t dep : op->dep_signals) hsa_signal_handle(dep)->Release();
     delete op;
+  }
+}
 
-    return false;
+// Sets [base, end) to node in a map of ranges keyed by base, trimming the
+// ranges it overlaps.
+static void AssignPrefetchRange(std::map<uintptr_t, std::pair<uintptr_t, uint32_t>>& ranges,
+                                uintptr_t base, uintptr_t end, uint32_t node) {
+  auto it = ranges.upper_bound(base);
+  if (it != ranges.begin()) {
+    auto prev = std::prev(it);
+    if (prev->second.first > base) {
+      auto old = prev->second;
+      if (old.first > end) ranges[end] = old;
+      if (prev->first < base)
+        prev->second.first = base;
+      else
+        ranges.erase(prev);
+    }
+  }
+  while (it != ranges.end() && it->first < end) {
+    if (it->second.first > end) ranges[end] = it->second;
+    it = ranges.erase(it);
+  }
+  ranges[base] = std::make_pair(end, node);
+}
+
+void Runtime::IssuePrefetchBatch(const std::vector<PrefetchOp*>& batch) {
+  // Ops of different types may depend on each other's effects so only runs of
+  // one type are reordered or merged.
+  std::vector<PrefetchOp*> run;
+  size_t first = 0;
+  while (first < batch.size()) {
+    PrefetchOp::Type type = batch[first]->type;
+    size_t last = first + 1;
+    while (last < batch.size() && batch[last]->type == type) last++;
+    run.assign(batch.begin() + first, batch.begin() + last);
+    first = last;
+
+    switch (type) {
+      case PrefetchOp::kPrefetch:
+        IssuePrefetches(run);
+        break;
+      case PrefetchOp::kSetAttrib:
+        IssueSetAttribs(run);
+        break;
+      case PrefetchOp::kGetAttrib:
+        for (PrefetchOp* op : run) {
+          bool ok = true;
+          try {
+            GetSvmAttrib(op->base, op->size, op->attribute_list, op->attribute_count);
+          } catch (const AMD::hsa_exception&) {
+            ok = false;
+          }
+          if (op->completion.handle == 0) continue;
+          if (ok)
+            Signal::Convert(op->completion)->SubRelaxed(1);
+          else
+            Signal::Convert(op->completion)->StoreRelease(-1);
+        }
+        break;
+    }
+  }
+
+  for (PrefetchOp* op : batch) delete op;
+}
+
+// Applies the KFD attributes of a later change to the same range on top of
+// those of an earlier one.
+static void MergeSvmAttribs(std::vector<HSA_SVM_ATTRIBUTE>& attribs,
+                            const std::vector<HSA_SVM_ATTRIBUTE>& later) {
+  auto find = [&](uint32_t type) {
+    return std::find_if(attribs.begin(), attribs.end(),
+                        [&](const HSA_SVM_ATTRIBUTE& attrib) { return attrib.type == type; });
+  };
+  auto isAccess = [](uint32_t type) {
+    return (type == HSA_SVM_ATTR_ACCESS) || (type == HSA_SVM_ATTR_ACCESS_IN_PLACE) ||
+        (type == HSA_SVM_ATTR_NO_ACCESS);
   };
 
-  auto no_dependencies = [](void* arg) { signal_handler(0, arg); };
+  for (const HSA_SVM_ATTRIBUTE& attrib : later) {
+    switch (attrib.type) {
+      case HSA_SVM_ATTR_SET_FLAGS:
+      case HSA_SVM_ATTR_CLR_FLAGS: {
+        uint32_t opposite = (attrib.type == HSA_SVM_ATTR_SET_FLAGS) ? HSA_SVM_ATTR_CLR_FLAGS
+                                                                     : HSA_SVM_ATTR_SET_FLAGS;
+        auto it = find(opposite);
+        if (it != attribs.end()) it->value &= ~attrib.value;
+        it = find(attrib.type);
+        if (it != attribs.end())
+          it->value |= attrib.value;
+        else
+          attribs.push_back(attrib);
+        break;
+      }
+      case HSA_SVM_ATTR_ACCESS:
+      case HSA_SVM_ATTR_ACCESS_IN_PLACE:
+      case HSA_SVM_ATTR_NO_ACCESS: {
+        // Access attributes are per node, given by value.
+        attribs.erase(std::remove_if(attribs.begin(), attribs.end(),
+                                     [&](const HSA_SVM_ATTRIBUTE& old) {
+                                       return isAccess(old.type) && (old.value == attrib.value);
+                                     }),
+                      attribs.end());
+        attribs.push_back(attrib);
+        break;
+      }
+      default: {
+        auto it = find(attrib.type);
+        if (it != attribs.end())
+          it->value = attrib.value;
+        else
+          attribs.push_back(attrib);
+      }
+    }
+  }
+}
 
-  MAKE_NAMED_SCOPE_GUARD(RangeGuard, [&]() { removePrefetchRanges(op); });
+void Runtime::IssueSetAttribs(const std::vector<PrefetchOp*>& ops) {
+  std::vector<HSA_SVM_ATTRIBUTE> attribs;
+  size_t first = 0;
+  while (first < ops.size()) {
+    void* base = ops[first]->base;
+    size_t size = ops[first]->size;
+    attribs = ops[first]->attribs;
+    size_t last = first + 1;
+    for (; last < ops.size() && ops[last]->base == base && ops[last]->size == size; last++)
+      MergeSvmAttribs(attribs, ops[last]->attribs);
+
+    bool ok = true;
+    if (!attribs.empty())
+      ok = (hsaKmtSVMSetAttr(base, size, attribs.size(), &attribs[0]) == HSAKMT_STATUS_SUCCESS);
+
+    for (; first < last; first++) {
+      hsa_signal_t completion = ops[first]->completion;
+      if (completion.handle == 0) continue;
+      if (ok)
+        Signal::Convert(completion)->SubRelaxed(1);
+      else
+        Signal::Convert(completion)->StoreRelease(-1);
+    }
+  }
+}
 
-  hsa_status_t err;
-  if (num_dep_signals == 0)
-    err = AMD::hsa_amd_async_function(no_dependencies, op);
-  else
-    err = SetAsyncSignalHandler(dep_signals[num_dep_signals - 1], HSA_SIGNAL_CONDITION_EQ, 0,
-                                signal_handler, op);
-  if (err != HSA_STATUS_SUCCESS) throw AMD::hsa_exception(err, "Signal handler unable to be set.");
+void Runtime::IssuePrefetches(const std::vector<PrefetchOp*>& batch) {
+  // Later prefetches of a range replace earlier ones, then adjacent ranges
+  // to the same node are merged so each run costs one KFD call.
+  std::map<uintptr_t, std::pair<uintptr_t, uint32_t>> ranges;
+  for (PrefetchOp* op : batch) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(op->base);
+    AssignPrefetchRange(ranges, base, base + op->size, op->node_id);
+  }
 
-  RangeGuard.Dismiss();
-  OpGuard.Dismiss();
-  return HSA_STATUS_SUCCESS;
+  // The range may have been freed since the prefetch was queued, which is
+  // reported through the completion signals of the ops overlapping it.
+  std::vector<std::pair<uintptr_t, uintptr_t>> failed;
+  HSA_SVM_ATTRIBUTE attrib;
+  attrib.type = HSA_SVM_ATTR_PREFETCH_LOC;
+  auto it = ranges.begin();
+  while (it != ranges.end()) {
+    uintptr_t base = it->first;
+    uintptr_t end = it->second.first;
+    uint32_t node = it->second.second;
+    for (++it; it != ranges.end() && it->first == end && it->second.second == node; ++it)
+      end = it->second.first;
+
+    attrib.value = node;
+    HSAKMT_STATUS error =
+        hsaKmtSVMSetAttr(reinterpret_cast<void*>(base), end - base, 1, &attrib);
+    if (error != HSAKMT_STATUS_SUCCESS) {
+      debug_print("KFD prefetch of [%p, %p) failed: %d\n", reinterpret_cast<void*>(base),
+                  reinterpret_cast<void*>(end), error);
+      failed.push_back(std::make_pair(base, end));
+    }
+  }
+
+  RemovePrefetchRanges(batch);
+
+  for (PrefetchOp* op : batch) {
+    if (op->completion.handle == 0) continue;
+    uintptr_t base = reinterpret_cast<uintptr_t>(op->base);
+    bool ok = std::none_of(failed.begin(), failed.end(),
+                           [&](const std::pair<uintptr_t, uintptr_t>& range) {
+                             return (range.first < base + op->size) && (base < range.second);
+                           });
+    if (ok)
+      Signal::Convert(op->completion)->SubRelaxed(1);
+    else
+      Signal::Convert(op->completion)->StoreRelease(-1);
+  }
+}
+
+void Runtime::RemovePrefetchRanges(const std::vector<PrefetchOp*>& ops) {
+  ScopedAcquire<KernelMutex> lock(&prefetch_lock_);
+  for (PrefetchOp* op : ops) {
+    auto it = op->prefetch_map_entry;
+    while (it != prefetch_map_.end()) {
+      auto next = it->second.next;
+      prefetch_map_.erase(it);
+      it = next;
+    }
+  }
+}
+
+void Runtime::ShutdownPrefetchQueue() {
+  if (prefetch_queue_.thread == NULL) return;
+  {
+    ScopedAcquire<KernelMutex> lock(&prefetch_queue_.lock);
+    prefetch_queue_.exit = true;
+  }
+  hsa_signal_handle(prefetch_queue_.wake)->StoreRelease(1);
+  os::WaitForThread(prefetch_queue_.thread);
+  os::CloseThread(prefetch_queue_.thread);
+  prefetch_queue_.thread = NULL;
+  HSA::hsa_signal_destroy(prefetch_queue_.wake);
 }
 
 Agent* Runtime::GetSVMPrefetchAgent(void* ptr, size_t size) {
@@ -47,6 +47,7 @@
 
 #include <algorithm>
 #include "core/util/timer.h"
+#include "core/util/trace.h"
 #include "core/inc/runtime.h"
 
 namespace rocr {
@@ -55,6 +56,37 @@ namespace core {
 KernelMutex Signal::ipcLock_;
 std::map<decltype(hsa_signal_t::handle), Signal*> Signal::ipcMap_;
 
+namespace {
+// Per thread KFD wait set, reused across WaitAny calls so that sleeping on a
+// signal list does not rebuild the event arguments on every wakeup.
+class ThreadWaitSet {
+ public:
+  ThreadWaitSet() : set_(nullptr) {}
+  ~ThreadWaitSet() {
+    if (set_ != nullptr) hsaKmtDestroyEventWaitSet(set_);
+  }
+
+  // Loads the set with the unique events evts. Returns nullptr if the set is
+  // unavailable, callers then fall back to hsaKmtWaitOnMultipleEvents_Ext.
+  HsaEventWaitSet* Load(HsaEvent** evts, uint32_t count, uint64_t age) {
+    if (set_ == nullptr && hsaKmtCreateEventWaitSet(count, &set_) != HSAKMT_STATUS_SUCCESS) {
+      set_ = nullptr;
+      return nullptr;
+    }
+    hsaKmtEventWaitSetClear(set_);
+    for (uint32_t i = 0; i < count; i++) {
+      if (hsaKmtEventWaitSetAdd(set_, evts[i], age) != HSAKMT_STATUS_SUCCESS) return nullptr;
+    }
+    return set_;
+  }
+
+ private:
+  HsaEventWaitSet* set_;
+};
+
+thread_local ThreadWaitSet thread_wait_set;
+}  // namespace
+
 void SharedSignalPool_t::clear() {
   ifdebug {
     size_t capacity = 0;
@@ -181,6 +213,8 @@ uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
                          const hsa_signal_condition_t* conds, const hsa_signal_value_t* values,
                          uint64_t timeout, hsa_wait_state_t wait_hint,
                          hsa_signal_value_t* satisfying_value) {
+  trace::Scope trace_wait(trace::kSignalWaitAny, signal_count);
+
   hsa_signal_handle* signals =
       reinterpret_cast<hsa_signal_handle*>(const_cast<hsa_signal_t*>(hsa_signals));
 
@@ -237,6 +271,10 @@ uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
     for (uint32_t i = 0; i < unique_evts; i++)
       event_age[i] = 1;
 
+  HsaEventWaitSet* wait_set = nullptr;
+  if (unique_evts != 0)
+    wait_set = thread_wait_set.Load(evts, unique_evts, event_age[0]);
+
   int64_t value;
 
   timer::fast_clock::time_point start_time = timer::fast_clock::now();
@@ -306,7 +344,10 @@ uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
     uint64_t ct=timer::duration_cast<std::chrono::milliseconds>(
       time_remaining).count();
     wait_ms = (ct>0xFFFFFFFEu) ? 0xFFFFFFFEu : ct;
-    hsaKmtWaitOnMultipleEvents_Ext(evts, unique_evts, false, wait_ms, event_age);
+    if (wait_set != nullptr)
+      hsaKmtWaitOnEventWaitSet(wait_set, false, wait_ms);
+    else
+      hsaKmtWaitOnMultipleEvents_Ext(evts, unique_evts, false, wait_ms, event_age);
   }
 }
 
@@ -360,6 +401,10 @@ uint32_t Signal::WaitAnyExceptions(uint32_t signal_count, const hsa_signal_t* hs
     for (uint32_t i = 0; i < unique_evts; i++)
       event_age[i] = 1;
 
+  HsaEventWaitSet* wait_set = nullptr;
+  if (unique_evts != 0)
+    wait_set = thread_wait_set.Load(evts, unique_evts, event_age[0]);
+
   int64_t value;
 
   bool condition_met = false;
@@ -411,7 +456,10 @@ uint32_t Signal::WaitAnyExceptions(uint32_t signal_count, const hsa_signal_t* hs
       }
     }
 
-    hsaKmtWaitOnMultipleEvents_Ext(evts, unique_evts, false, wait_ms, event_age);
+    if (wait_set != nullptr)
+      hsaKmtWaitOnEventWaitSet(wait_set, false, wait_ms);
+    else
+      hsaKmtWaitOnMultipleEvents_Ext(evts, unique_evts, false, wait_ms, event_age);
   } //while
 }
 
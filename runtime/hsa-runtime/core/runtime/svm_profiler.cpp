@@ -43,6 +43,8 @@
 #include "core/inc/svm_profiler.h"
 
 #include <stdint.h>
+#include <string.h>
+#include <unistd.h>
 #include <algorithm>
 #include <sys/eventfd.h>
 #include <poll.h>
@@ -53,6 +55,7 @@
 #include "core/inc/runtime.h"
 #include "core/inc/agent.h"
 #include "core/inc/amd_gpu_agent.h"
+#include "core/inc/exceptions.h"
 #include "core/util/os.h"
 
 namespace rocr {
@@ -111,21 +114,340 @@ static const char* smi_unmap_string(uint32_t trigger) {
   return strings[trigger];
 }
 
+bool ParseSmiEvent(const char* line, SvmEvent* event) {
+  memset(event, 0, sizeof(*event));
+
+  // Event records follow the format:
+  // event_id timestamp -pid event_specific_info trigger
+  // timestamp, pid, and trigger are in dec.  All other are hex.
+  // event_specific substring is listed for each event type.
+  // See kfd_ioctl.h for more info.
+  int offset = 0;
+  int args = sscanf(line, "%x %lu -%u%n", &event->event_id, &event->time, &event->pid, &offset);
+  if (args != 3) return false;
+
+  const char* cursor = line + offset;
+  if (*cursor != '\0') cursor++;
+
+  uint32_t size = 0;
+  switch (event->event_id) {
+    //@addr(size) from->to prefetch_location:preferred_location
+    case HSA_SMI_EVENT_MIGRATE_START: {
+      uint32_t fetch, pref;
+      args = sscanf(cursor, "@%lx(%x) %x->%x %x:%x %u", &event->addr, &size, &event->from,
+                    &event->to, &fetch, &pref, &event->trigger);
+      if (args != 7) return false;
+      break;
+    }
+    //@addr(size) from->to
+    case HSA_SMI_EVENT_MIGRATE_END: {
+      args = sscanf(cursor, "@%lx(%x) %x->%x %u", &event->addr, &size, &event->from, &event->to,
+                    &event->trigger);
+      if (args != 5) return false;
+      break;
+    }
+    //@addr(gpu_id) W/R
+    case HSA_SMI_EVENT_PAGE_FAULT_START:
+    //@addr(gpu_id) M/U  (migration / page table update)
+    case HSA_SMI_EVENT_PAGE_FAULT_END: {
+      args = sscanf(cursor, "@%lx(%x) %c", &event->addr, &event->from, &event->mode);
+      if (args != 3) return false;
+      size = 1;
+      break;
+    }
+    // gpu_id
+    case HSA_SMI_EVENT_QUEUE_EVICTION:
+    case HSA_SMI_EVENT_QUEUE_RESTORE: {
+      args = sscanf(cursor, "%x %u", &event->from, &event->trigger);
+      if (args != 2) return false;
+      break;
+    }
+    //@addr(size) gpu_id
+    case HSA_SMI_EVENT_UNMAP_FROM_GPU: {
+      args = sscanf(cursor, "@%lx(%x) %x %u", &event->addr, &size, &event->from, &event->trigger);
+      if (args != 4) return false;
+      break;
+    }
+    default:;
+  }
+
+  event->addr *= 4096;
+  event->size = uint64_t(size) * 4096;
+  return true;
+}
+
+SvmAccessAnalyzer::Granule* SvmAccessAnalyzer::Lookup(uint64_t addr) {
+  uint64_t index = addr / kGranuleSize;
+  auto it = granules_.find(index);
+  if (it != granules_.end()) return &it->second;
+  if (granules_.size() >= kMaxRanges) return nullptr;
+
+  Granule& granule = granules_[index];
+  memset(&granule, 0, sizeof(granule));
+  granule.range.base = addr;
+  granule.range.end = addr;
+  granule.range.hint = HSA_AMD_SVM_PROFILE_HINT_NONE;
+  granule.fault_gpuid = kMixedGpuid;
+  granule.last_from = kMixedGpuid;
+  granule.last_to = kMixedGpuid;
+  return &granule;
+}
+
+void SvmAccessAnalyzer::SetHint(Granule* granule, hsa_amd_svm_profile_hint_t hint,
+                                uint32_t gpuid) {
+  if ((granule->range.hint == hint) && (granule->range.hint_gpuid == gpuid)) return;
+  granule->range.hint = hint;
+  granule->range.hint_gpuid = gpuid;
+  granule->range.applied = false;
+  if (!granule->pending) {
+    granule->pending = true;
+    pending_.push_back(granule->range.base / kGranuleSize);
+  }
+}
+
+void SvmAccessAnalyzer::Fault(Granule* granule, uint64_t epoch, uint32_t gpuid) {
+  granule->range.page_faults++;
+
+  if (granule->range.fault_epochs != 0 && granule->fault_epoch == epoch) {
+    if (granule->fault_gpuid != gpuid) granule->fault_gpuid = kMixedGpuid;
+    return;
+  }
+
+  // First fault of this epoch.  The streak continues if the previous epoch was
+  // faulted on by this agent alone.
+  if ((granule->range.fault_epochs != 0) && (granule->fault_epoch + 1 == epoch) &&
+      (granule->fault_gpuid == gpuid))
+    granule->range.fault_epochs++;
+  else
+    granule->range.fault_epochs = 1;
+  granule->fault_epoch = epoch;
+  granule->fault_gpuid = gpuid;
+
+  // Thrashing ranges stay in system memory.
+  if ((granule->range.fault_epochs >= kRecurringEpochs) &&
+      (granule->range.hint != HSA_AMD_SVM_PROFILE_HINT_PREFER_SYSTEM))
+    SetHint(granule, HSA_AMD_SVM_PROFILE_HINT_PREFER_AGENT, gpuid);
+}
+
+void SvmAccessAnalyzer::Migrate(Granule* granule, uint64_t epoch, const SvmEvent& event) {
+  granule->range.migrations++;
+
+  if ((event.from == granule->last_to) && (event.to == granule->last_from)) {
+    granule->range.thrash_migrations++;
+    if (granule->thrash_epoch != epoch) {
+      granule->thrash_epoch = epoch;
+      granule->epoch_thrash = 0;
+    }
+    if (++granule->epoch_thrash >= kThrashMigrations)
+      SetHint(granule, HSA_AMD_SVM_PROFILE_HINT_PREFER_SYSTEM, 0);
+  }
+  granule->last_from = event.from;
+  granule->last_to = event.to;
+
+  // CPU page faults only show up as the migrations they trigger.
+  if (event.trigger == HSA_MIGRATE_TRIGGER_PAGEFAULT_CPU) Fault(granule, epoch, event.to);
+}
+
+void SvmAccessAnalyzer::Record(const SvmEvent& event) {
+  bool fault = (event.event_id == HSA_SMI_EVENT_PAGE_FAULT_START);
+  bool migrate = (event.event_id == HSA_SMI_EVENT_MIGRATE_START);
+  if ((!fault && !migrate) || (event.size == 0)) return;
+
+  uint64_t epoch = event.time / kEpochNs;
+  uint64_t addr = event.addr;
+  uint64_t end = event.addr + event.size;
+  while (addr < end) {
+    uint64_t next = std::min(AlignDown(addr, kGranuleSize) + kGranuleSize, end);
+    Granule* granule = Lookup(addr);
+    if (granule != nullptr) {
+      granule->range.base = std::min(granule->range.base, addr);
+      granule->range.end = std::max(granule->range.end, next);
+      if (fault) {
+        Fault(granule, epoch, event.from);
+      } else {
+        granule->range.migrated_bytes += next - addr;
+        Migrate(granule, epoch, event);
+      }
+    }
+    addr = next;
+  }
+}
+
+size_t SvmAccessAnalyzer::Replay(FILE* log) {
+  size_t count = 0;
+  char line[HSA_SMI_EVENT_MSG_SIZE + 512];
+  while (fgets(line, sizeof(line), log) != nullptr) {
+    // Profiler log lines end with the KFD record they were decoded from.
+    const char* record = strstr(line, " | ");
+    record = (record == nullptr) ? line : record + 3;
+
+    SvmEvent event;
+    if (!ParseSmiEvent(record, &event)) continue;
+    Record(event);
+    count++;
+  }
+  return count;
+}
+
+void SvmAccessAnalyzer::TakeHints(std::vector<Range>* ranges) {
+  for (uint64_t index : pending_) {
+    Granule& granule = granules_[index];
+    granule.pending = false;
+    if (granule.range.hint != HSA_AMD_SVM_PROFILE_HINT_NONE) ranges->push_back(granule.range);
+  }
+  pending_.clear();
+}
+
+void SvmAccessAnalyzer::MarkApplied(const Range& range) {
+  auto it = granules_.find(range.base / kGranuleSize);
+  if (it == granules_.end()) return;
+  // Skip if the hint changed while it was applied.
+  if ((it->second.range.hint == range.hint) && (it->second.range.hint_gpuid == range.hint_gpuid))
+    it->second.range.applied = true;
+}
+
 void SvmProfileControl::PollSmiRun(void* _profileControl) {
   SvmProfileControl* profileControl = (SvmProfileControl*)_profileControl;
 
   profileControl->PollSmi();
 }
 
+hsa_agent_t SvmProfileControl::HintAgent(const SvmAccessAnalyzer::Range& range) {
+  hsa_agent_t handle = {0};
+  core::Agent* agent = nullptr;
+  if (range.hint == HSA_AMD_SVM_PROFILE_HINT_PREFER_SYSTEM) {
+    if (!core::Runtime::runtime_singleton_->cpu_agents().empty())
+      agent = core::Runtime::runtime_singleton_->cpu_agents()[0];
+  } else if (range.hint == HSA_AMD_SVM_PROFILE_HINT_PREFER_AGENT) {
+    agent = core::Runtime::runtime_singleton_->agent_by_gpuid(range.hint_gpuid);
+  }
+  if (agent != nullptr) handle = agent->public_handle();
+  return handle;
+}
+
+void SvmProfileControl::ApplyHints() {
+  std::vector<SvmAccessAnalyzer::Range> hints;
+  {
+    ScopedAcquire<KernelMutex> lock(&analyzer_lock_);
+    analyzer_.TakeHints(&hints);
+  }
+
+  for (auto& range : hints) {
+    hsa_agent_t agent = HintAgent(range);
+    if (agent.handle == 0) continue;
+
+    void* ptr = reinterpret_cast<void*>(range.base);
+    size_t size = range.end - range.base;
+    hsa_amd_svm_attribute_pair_t attrib = {HSA_AMD_SVM_ATTRIB_PREFERRED_LOCATION, agent.handle};
+    try {
+      if (core::Runtime::runtime_singleton_->SetSvmAttrib(ptr, size, &attrib, 1) !=
+          HSA_STATUS_SUCCESS)
+        continue;
+      if (range.hint == HSA_AMD_SVM_PROFILE_HINT_PREFER_AGENT)
+        core::Runtime::runtime_singleton_->SvmPrefetch(ptr, size, agent, 0, nullptr,
+                                                       hsa_signal_t{0});
+    } catch (const hsa_exception&) {
+      // The range may have been freed since it was profiled.
+      continue;
+    }
+
+    ScopedAcquire<KernelMutex> lock(&analyzer_lock_);
+    analyzer_.MarkApplied(range);
+  }
+}
+
+hsa_status_t SvmProfileControl::IterateRanges(
+    hsa_status_t (*callback)(const hsa_amd_svm_profile_range_t* range, void* data), void* data) {
+  std::vector<SvmAccessAnalyzer::Range> ranges;
+  {
+    ScopedAcquire<KernelMutex> lock(&analyzer_lock_);
+    analyzer_.ForEachRange([&](const SvmAccessAnalyzer::Range& range) { ranges.push_back(range); });
+  }
+
+  // Callbacks may call into the runtime so they run unlocked.
+  for (auto& range : ranges) {
+    hsa_amd_svm_profile_range_t out;
+    out.base = reinterpret_cast<void*>(range.base);
+    out.size = range.end - range.base;
+    out.page_faults = range.page_faults;
+    out.migrations = range.migrations;
+    out.migrated_bytes = range.migrated_bytes;
+    out.thrash_migrations = range.thrash_migrations;
+    out.fault_epochs = range.fault_epochs;
+    out.hint = range.hint;
+    out.hint_agent = HintAgent(range);
+    out.applied = range.applied;
+    hsa_status_t err = callback(&out, data);
+    if (err != HSA_STATUS_SUCCESS) return err;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+std::string SvmProfileControl::Describe(const SvmEvent& event) {
+  auto format_agent = [this](uint32_t gpuid) {
+    core::Agent* agent = core::Runtime::runtime_singleton_->agent_by_gpuid(gpuid);
+    if (agent == nullptr)
+      return format("gpuid %x", gpuid);
+    else if (agent->device_type() == core::Agent::kAmdCpuDevice)
+      return std::string("CPU");
+    else
+      return format("GPU%u(%p)", ((AMD::GpuAgent*)agent)->enumeration_index(),
+                    agent->public_handle());
+  };
+
+  switch (event.event_id) {
+    case HSA_SMI_EVENT_MIGRATE_START:
+    case HSA_SMI_EVENT_MIGRATE_END: {
+      std::string from_agent = format_agent(event.from);
+      std::string to_agent = format_agent(event.to);
+      std::string range = format("[%p, %p]", event.addr, event.addr + event.size - 1);
+      std::string cause = smi_migrate_string(event.trigger);
+      return cause + " " + from_agent + "->" + to_agent + " " + range;
+    }
+    case HSA_SMI_EVENT_PAGE_FAULT_START: {
+      std::string agent = format_agent(event.from);
+      std::string range = std::to_string(event.addr);
+      std::string cause = (event.mode == 'W') ? "Write" : "Read";
+      return cause + " " + agent + " " + range;
+    }
+    case HSA_SMI_EVENT_PAGE_FAULT_END: {
+      std::string agent = format_agent(event.from);
+      std::string range = std::to_string(event.addr);
+      std::string cause = (event.mode == 'M') ? "Migration" : "Map";
+      return cause + " " + agent + " " + range;
+    }
+    case HSA_SMI_EVENT_QUEUE_EVICTION:
+    case HSA_SMI_EVENT_QUEUE_RESTORE: {
+      std::string agent = format_agent(event.from);
+      std::string cause = smi_eviction_string(event.trigger);
+      return cause + " " + agent;
+    }
+    case HSA_SMI_EVENT_UNMAP_FROM_GPU: {
+      std::string gpu = format_agent(event.from);
+      std::string range = format("[%p, %p]", event.addr, event.addr + event.size - 1);
+      std::string cause = smi_unmap_string(event.trigger);
+      return cause + " " + gpu + " " + range;
+    }
+    default:
+      return std::string();
+  }
+}
+
 void SvmProfileControl::PollSmi() {
-  if (core::Runtime::runtime_singleton_->flag().svm_profile().empty()) {
+  const auto& flag = core::Runtime::runtime_singleton_->flag();
+  if (flag.svm_profile().empty() && !flag.svm_profile_hints()) {
     return;
   }
-  FILE* logFile = fopen(core::Runtime::runtime_singleton_->flag().svm_profile().c_str(), "a");
-  if (logFile == NULL) {
-    return;
+  FILE* logFile = NULL;
+  if (!flag.svm_profile().empty()) {
+    logFile = fopen(flag.svm_profile().c_str(), "a");
+    if (logFile == NULL) {
+      return;
+    }
   }
-  MAKE_NAMED_SCOPE_GUARD(logGuard, [&]() { fclose(logFile); });
+  MAKE_NAMED_SCOPE_GUARD(logGuard, [&]() {
+    if (logFile != NULL) fclose(logFile);
+  });
 
   std::vector<pollfd> files;
   files.resize(core::Runtime::runtime_singleton_->gpu_agents().size() + 1);
@@ -162,15 +484,8 @@ void SvmProfileControl::PollSmi() {
   smi_records.resize(core::Runtime::runtime_singleton_->gpu_agents().size() + 1);
   char buffer[HSA_SMI_EVENT_MSG_SIZE + 1];
 
-  auto format_agent = [this](uint32_t gpuid) {
-    std::string ret;
-    core::Agent* agent = core::Runtime::runtime_singleton_->agent_by_gpuid(gpuid);
-    if (agent->device_type() == core::Agent::kAmdCpuDevice)
-      return std::string("CPU");
-    else
-      return format("GPU%u(%p)", ((AMD::GpuAgent*)agent)->enumeration_index(),
-                    agent->public_handle());
-  };
+  // Privileged processes receive the events of all processes.
+  uint32_t pid = getpid();
 
   while (!exit) {
     int ready = poll(&files[0], files.size(), -1);
@@ -185,8 +500,6 @@ void SvmProfileControl::PollSmi() {
         auto len = read(files[i].fd, buffer, sizeof(buffer) - 1);
         if (len > 0) {
           buffer[len] = '\0';
-          // printf("%s\n", buffer);
-          // fprintf(logFile, "%s\n", buffer);
 
           smi_records[i] += buffer;
 
@@ -197,158 +510,51 @@ void SvmProfileControl::PollSmi() {
             std::string line = smi_records[i].substr(0, pos);
             smi_records[i].erase(0, pos + 1);
 
-            const char* cursor;
-            cursor = line.c_str();
-
-            // Event records follow the format:
-            // event_id timestamp -pid event_specific_info trigger
-            // timestamp, pid, and trigger are in dec.  All other are hex.
-            // event_specific substring is listed for each event type.
-            // See kfd_ioctl.h for more info.
-            int event_id;
-            uint64_t time;
-            int pid;
-            int offset = 0;
-            int args = sscanf(cursor, "%x %lu -%u%n", &event_id, &time, &pid, &offset);
-            assert(args == 3 && "Parsing error!");
-
-            std::string detail;
-            cursor += offset + 1;
-            switch (event_id) {
-              //@addr(size) from->to prefetch_location:preferred_location
-              case HSA_SMI_EVENT_MIGRATE_START: {
-                uint64_t addr;
-                uint32_t size;
-                uint32_t from, to;
-                uint32_t trigger = 0;
-                uint32_t fetch, pref;
-                args = sscanf(cursor, "@%lx(%x) %x->%x %x:%x %u", &addr, &size, &from, &to, &fetch,
-                              &pref, &trigger);
-                assert(args == 7 && "Parsing error!");
-
-                addr *= 4096;
-                size *= 4096;
-
-                std::string from_agent = format_agent(from);
-                std::string to_agent = format_agent(to);
-                std::string range = format("[%p, %p]", addr, addr + size - 1);
-                std::string cause = smi_migrate_string(trigger);
-                detail = cause + " " + from_agent + "->" + to_agent + " " + range;
-                break;
-              }
-              //@addr(size) from->to
-              case HSA_SMI_EVENT_MIGRATE_END: {
-                uint64_t addr;
-                uint32_t size;
-                uint32_t from, to;
-                uint32_t trigger;
-                args = sscanf(cursor, "@%lx(%x) %x->%x %u", &addr, &size, &from, &to, &trigger);
-                assert(args == 5 && "Parsing error!");
-
-                addr *= 4096;
-                size *= 4096;
-
-                std::string from_agent = format_agent(from);
-                std::string to_agent = format_agent(to);
-                std::string range = format("[%p, %p]", addr, addr + size - 1);
-                std::string cause = smi_migrate_string(trigger);
-                detail = cause + " " + from_agent + "->" + to_agent + " " + range;
-                break;
-              }
-              //@addr(gpu_id) W/R
-              case HSA_SMI_EVENT_PAGE_FAULT_START: {
-                uint64_t addr;
-                uint32_t gpuid;
-                char mode;
-                args = sscanf(cursor, "@%lx(%x) %c", &addr, &gpuid, &mode);
-
-                addr *= 4096;
-
-                assert(args == 3 && "Parsing error!");
-                std::string agent = format_agent(gpuid);
-                std::string range = std::to_string(addr);
-                std::string cause = (mode == 'W') ? "Write" : "Read";
-                detail = cause + " " + agent + " " + range;
-                break;
-              }
-              //@addr(gpu_id) M/U  (migration / page table update)
-              case HSA_SMI_EVENT_PAGE_FAULT_END: {
-                uint64_t addr;
-                uint32_t gpuid;
-                char mode;
-                args = sscanf(cursor, "@%lx(%x) %c", &addr, &gpuid, &mode);
-                assert(args == 3 && "Parsing error!");
-
-                addr *= 4096;
-
-                std::string agent = format_agent(gpuid);
-                std::string range = std::to_string(addr);
-                std::string cause = (mode == 'M') ? "Migration" : "Map";
-                detail = cause + " " + agent + " " + range;
-                break;
-              }
-              // gpu_id
-              case HSA_SMI_EVENT_QUEUE_EVICTION: {
-                uint32_t gpuid;
-                uint32_t trigger;
-                args = sscanf(cursor, "%x %u", &gpuid, &trigger);
-                assert(args == 2 && "Parsing error!");
-                std::string agent = format_agent(gpuid);
-                std::string cause = smi_eviction_string(trigger);
-                detail = cause + " " + agent;
-                break;
-              }
-              // gpu_id
-              case HSA_SMI_EVENT_QUEUE_RESTORE: {
-                uint32_t gpuid;
-                uint32_t trigger;
-                args = sscanf(cursor, "%x %u", &gpuid, &trigger);
-                assert(args == 2 && "Parsing error!");
-                std::string agent = format_agent(gpuid);
-                std::string cause = smi_eviction_string(trigger);
-                detail = cause + " " + agent;
-                break;
-              }
-              //@addr(size) gpu_id
-              case HSA_SMI_EVENT_UNMAP_FROM_GPU: {
-                uint64_t addr;
-                uint32_t size;
-                uint32_t gpuid;
-                uint32_t trigger;
-                args = sscanf(cursor, "@%lx(%x) %x %u", &addr, &size, &gpuid, &trigger);
-                assert(args == 4 && "Parsing error!");
-
-                addr *= 4096;
-                size *= 4096;
-
-                std::string gpu = format_agent(gpuid);
-                std::string range = format("[%p, %p]", addr, addr + size - 1);
-                std::string cause = smi_unmap_string(trigger);
-                detail = cause + " " + gpu + " " + range;
-                break;
-              }
-              default:;
+            SvmEvent smi_event;
+            bool parsed = ParseSmiEvent(line.c_str(), &smi_event);
+            assert(parsed && "Parsing error!");
+            if (!parsed) continue;
+
+            if (smi_event.pid == pid) {
+              ScopedAcquire<KernelMutex> lock(&analyzer_lock_);
+              analyzer_.Record(smi_event);
             }
 
-            std::string record = std::string("ROCr HMM event: ") + std::to_string(time) + " " +
-                smi_event_string(event_id) + " " + detail;
-            // printf("%s\n", record.c_str());
+            if (logFile == NULL) continue;
+            // The raw record is kept so logs can be replayed through HSA_SVM_PROFILE_REPLAY.
+            std::string record = std::string("ROCr HMM event: ") +
+                std::to_string(smi_event.time) + " " + smi_event_string(smi_event.event_id) +
+                " " + Describe(smi_event) + " | " + line;
             fprintf(logFile, "%s\n", record.c_str());
           }
-        } else {
+        } else if (logFile != NULL) {
           auto err = errno;
           const char* msg = strerror(err);
-          // printf("ROCr HMM event error: Read returned %ld, %s (%d)\n", len, msg, err);
           fprintf(logFile, "ROCr HMM event error: Read returned %ld, %s (%d)\n", len, msg, err);
         }
         files[i].revents = 0;
       }
     }
     if (files[0].revents & POLLIN) return;
+
+    if (flag.svm_profile_hints()) ApplyHints();
   }
 }
 
 SvmProfileControl::SvmProfileControl() : event(-1), exit(false) {
+  // Replay before returning so the results are visible once HSA is initialized.
+  const std::string& replay_log = core::Runtime::runtime_singleton_->flag().svm_profile_replay();
+  if (!replay_log.empty()) {
+    FILE* replay = fopen(replay_log.c_str(), "r");
+    if (replay != NULL) {
+      analyzer_.Replay(replay);
+      fclose(replay);
+      // Replayed addresses belong to another run, never apply their hints.
+      std::vector<SvmAccessAnalyzer::Range> discard;
+      analyzer_.TakeHints(&discard);
+    }
+  }
+
   event = eventfd(0, EFD_CLOEXEC);
   if (event == -1) return;
 
@@ -59,6 +59,9 @@ class Flag {
   enum SDMA_OVERRIDE { SDMA_DISABLE, SDMA_ENABLE, SDMA_DEFAULT };
   enum SRAMECC_ENABLE { SRAMECC_DISABLED, SRAMECC_ENABLED, SRAMECC_DEFAULT };
 
+  // Scope in which identical read-only code segments are shared.
+  enum SHARE_CODE_SEGMENTS { SHARE_CODE_NONE, SHARE_CODE_PROCESS, SHARE_CODE_NODE };
+
   // The values are meaningful and chosen to satisfy the thunk API.
   enum XNACK_REQUEST { XNACK_DISABLE = 0, XNACK_ENABLE = 1, XNACK_UNCHANGED = 2 };
   static_assert(XNACK_DISABLE == 0, "XNACK_REQUEST enum values improperly changed.");
@@ -68,6 +71,10 @@ class Flag {
   // reclaim is supported
   const size_t DEFAULT_SCRATCH_SINGLE_LIMIT = 146800640;  // small_limit >> 2;
   const size_t DEFAULT_PCS_MAX_DEVICE_BUFFER_SIZE = 256 * 1024 * 1024;
+  const size_t DEFAULT_ZEROED_POOL_SIZE = 256 * 1024 * 1024;
+  const size_t DEFAULT_IPC_DMABUF_FD_CACHE_SIZE = 256;
+  const size_t DEFAULT_IPC_ATTACH_CACHE_SIZE = 64;
+  const size_t DEFAULT_TRACE_BUFFER_SIZE = 16384;
 
   explicit Flag() { Refresh(); }
 
@@ -195,6 +202,11 @@ class Flag {
     var = os::GetEnvVar("HSA_LOADER_ENABLE_MMAP_URI");
     loader_enable_mmap_uri_ = (var == "1") ? true : false;
 
+    // "1" shares within the process, "2" extends it to other processes on the node.
+    var = os::GetEnvVar("HSA_LOADER_SHARE_CODE_SEGMENTS");
+    share_code_segments_ = (var == "1") ? SHARE_CODE_PROCESS :
+                           ((var == "2") ? SHARE_CODE_NODE : SHARE_CODE_NONE);
+
     var = os::GetEnvVar("HSA_FORCE_SDMA_SIZE");
     force_sdma_size_ = var.empty() ? 1024 * 1024 : atoi(var.c_str());
 
@@ -223,6 +235,14 @@ class Flag {
     var = os::GetEnvVar("HSA_SVM_PROFILE");
     svm_profile_ = var;
 
+    // Applies the placement hints of the SVM profiler to the profiled ranges.
+    var = os::GetEnvVar("HSA_SVM_PROFILE_HINTS");
+    svm_profile_hints_ = (var == "1") ? true : false;
+
+    // SVM profiler log or KFD SMI event records to analyze at startup.
+    var = os::GetEnvVar("HSA_SVM_PROFILE_REPLAY");
+    svm_profile_replay_ = var;
+
     var = os::GetEnvVar("HSA_ENABLE_SRAMECC");
     sramecc_enable_ =
         (var == "0") ? SRAMECC_DISABLED : ((var == "1") ? SRAMECC_ENABLED : SRAMECC_DEFAULT);
@@ -250,6 +270,46 @@ class Flag {
 
     var = os::GetEnvVar("HSA_ALLOCATE_QUEUE_DEV_MEM");
     dev_mem_queue_ = (var == "1") ? true : false;
+
+    // Budget in bytes for pre-zeroed device blocks per memory pool, 0 disables the pool.
+    if (os::IsEnvVarSet("HSA_ZEROED_POOL_SIZE")) {
+      var = os::GetEnvVar("HSA_ZEROED_POOL_SIZE");
+      char* end;
+      zeroed_pool_size_ = strtoul(var.c_str(), &end, 10);
+    } else {
+      zeroed_pool_size_ = DEFAULT_ZEROED_POOL_SIZE;
+    }
+
+    // Number of exported dmabuf FDs the IPC server keeps open for reuse.
+    if (os::IsEnvVarSet("HSA_IPC_DMABUF_FD_CACHE_SIZE")) {
+      var = os::GetEnvVar("HSA_IPC_DMABUF_FD_CACHE_SIZE");
+      char* end;
+      ipc_dmabuf_fd_cache_size_ = strtoul(var.c_str(), &end, 10);
+    } else {
+      ipc_dmabuf_fd_cache_size_ = DEFAULT_IPC_DMABUF_FD_CACHE_SIZE;
+    }
+
+    // Number of detached IPC mappings kept for reuse by later attaches.
+    if (os::IsEnvVarSet("HSA_IPC_ATTACH_CACHE_SIZE")) {
+      var = os::GetEnvVar("HSA_IPC_ATTACH_CACHE_SIZE");
+      char* end;
+      ipc_attach_cache_size_ = strtoul(var.c_str(), &end, 10);
+    } else {
+      ipc_attach_cache_size_ = DEFAULT_IPC_ATTACH_CACHE_SIZE;
+    }
+
+    // Binary trace of runtime events, see core/util/trace.h.
+    var = os::GetEnvVar("HSA_TRACE_FILE");
+    trace_file_ = var;
+
+    // Events buffered per thread between trace flushes.
+    if (os::IsEnvVarSet("HSA_TRACE_BUFFER_SIZE")) {
+      var = os::GetEnvVar("HSA_TRACE_BUFFER_SIZE");
+      char* end;
+      trace_buffer_size_ = strtoul(var.c_str(), &end, 10);
+    } else {
+      trace_buffer_size_ = DEFAULT_TRACE_BUFFER_SIZE;
+    }
   }
 
   void parse_masks(uint32_t maxGpu, uint32_t maxCU) {
@@ -321,6 +381,8 @@ class Flag {
 
   bool loader_enable_mmap_uri() const { return loader_enable_mmap_uri_; }
 
+  SHARE_CODE_SEGMENTS share_code_segments() const { return share_code_segments_; }
+
   size_t force_sdma_size() const { return force_sdma_size_; }
 
   bool check_sramecc_validity() const { return check_sramecc_validity_; }
@@ -354,6 +416,10 @@ class Flag {
 
   const std::string& svm_profile() const { return svm_profile_; }
 
+  bool svm_profile_hints() const { return svm_profile_hints_; }
+
+  const std::string& svm_profile_replay() const { return svm_profile_replay_; }
+
   SRAMECC_ENABLE sramecc_enable() const { return sramecc_enable_; }
 
   bool enable_ipc_mode_legacy() const { return enable_ipc_mode_legacy_; }
@@ -361,6 +427,16 @@ class Flag {
   size_t pc_sampling_max_device_buffer_size() const { return pc_sampling_max_device_buffer_size_; }
 
   bool dev_mem_queue() const { return dev_mem_queue_; }
+
+  size_t zeroed_pool_size() const { return zeroed_pool_size_; }
+
+  size_t ipc_dmabuf_fd_cache_size() const { return ipc_dmabuf_fd_cache_size_; }
+
+  size_t ipc_attach_cache_size() const { return ipc_attach_cache_size_; }
+
+  const std::string& trace_file() const { return trace_file_; }
+
+  size_t trace_buffer_size() const { return trace_buffer_size_; }
  private:
   bool check_flat_scratch_;
   bool enable_vm_fault_message_;
@@ -390,6 +466,7 @@ class Flag {
   bool enable_mwaitx_;
   bool enable_ipc_mode_legacy_;
   bool dev_mem_queue_;
+  bool svm_profile_hints_;
 
   SDMA_OVERRIDE enable_sdma_;
   SDMA_OVERRIDE enable_peer_sdma_;
@@ -410,6 +487,7 @@ class Flag {
 
   std::string tools_lib_names_;
   std::string svm_profile_;
+  std::string svm_profile_replay_;
 
   size_t force_sdma_size_;
 
@@ -418,8 +496,19 @@ class Flag {
 
   SRAMECC_ENABLE sramecc_enable_;
 
+  SHARE_CODE_SEGMENTS share_code_segments_;
+
   size_t pc_sampling_max_device_buffer_size_;
 
+  size_t zeroed_pool_size_;
+
+  size_t ipc_dmabuf_fd_cache_size_;
+
+  size_t ipc_attach_cache_size_;
+
+  std::string trace_file_;
+  size_t trace_buffer_size_;
+
   // Map GPU index post RVD to its default cu mask.
   std::map<uint32_t, std::vector<uint32_t>> cu_mask_;
 
@@ -407,6 +407,11 @@ void uSleep(int delayInUs) { usleep(delayInUs); }
 
 void YieldThread() { sched_yield(); }
 
+uint32_t GetCurrentCpu() {
+  int cpu = sched_getcpu();
+  return cpu < 0 ? 0 : cpu;
+}
+
 Thread CreateThread(ThreadEntry function, void* threadArgument, uint stackSize) {
   os_thread* result = new os_thread(function, threadArgument, stackSize);
   if (!result->Valid()) {
@@ -45,6 +45,10 @@
 #ifndef HSA_RUNTIME_CORE_UTIL_LOCKS_H_
 #define HSA_RUNTIME_CORE_UTIL_LOCKS_H_
 
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
 #include "utils.h"
 #include "os.h"
 
@@ -167,6 +171,52 @@ class KernelEvent {
   DISALLOW_COPY_AND_ASSIGN(KernelEvent);
 };
 
+/// @brief: publishes a small trivially copyable value to lock free readers.
+/// Writers must be serialized externally.  Readers never block writers, they
+/// retry if a write happened while they were copying the value.
+template <class T> class SeqLock {
+ public:
+  SeqLock() : seq_(0) {
+    for (auto& word : data_) word.store(0, std::memory_order_relaxed);
+  }
+
+  void Store(const T& value) {
+    uint64_t words[kWords] = {};
+    memcpy(words, &value, sizeof(T));
+
+    const uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) data_[i].store(words[i], std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  T Load() const {
+    uint64_t words[kWords];
+    uint32_t seq;
+    do {
+      // Odd sequence numbers mark a write in progress.
+      while ((seq = seq_.load(std::memory_order_acquire)) & 1) os::YieldThread();
+      for (size_t i = 0; i < kWords; i++) words[i] = data_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (seq_.load(std::memory_order_relaxed) != seq);
+
+    T value;
+    memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+ private:
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type.");
+  static const size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  std::atomic<uint32_t> seq_;
+  std::atomic<uint64_t> data_[kWords];
+
+  /// @brief: Disable copiable and assignable ability.
+  DISALLOW_COPY_AND_ASSIGN(SeqLock);
+};
+
 /// @brief: represents a yielding shared mutex.
 /// aka read/write mutex
 class KernelSharedMutex {
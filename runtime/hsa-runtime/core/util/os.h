@@ -201,6 +201,11 @@ void uSleep(int delayInUs);
 /// @return: void.
 void YieldThread();
 
+/// @brief: Gets the CPU the calling thread is running on.
+/// @param: void.
+/// @return: uint32_t, CPU index, 0 if unknown.
+uint32_t GetCurrentCpu();
+
 typedef void (*ThreadEntry)(void*);
 
 /// @brief: Creates a thread will return NULL if failed.
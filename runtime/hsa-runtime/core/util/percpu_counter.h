@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef HSA_RUNTIME_CORE_UTIL_PERCPU_COUNTER_H_
+#define HSA_RUNTIME_CORE_UTIL_PERCPU_COUNTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <new>
+
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+
+/// @brief A group of @p N statistics counters striped by CPU.
+///
+/// Add updates the stripe of the calling thread's current CPU with a relaxed
+/// add, so threads on different CPUs never write the same cache line.  Read
+/// sums all stripes and is not a snapshot across counters.  Callers updating
+/// several counters at once look up the stripe once with CurrentStripe.
+template <size_t N> class PerCpuCounters {
+ public:
+  PerCpuCounters() {
+    base_ = AlignUp(storage_, kCacheLineSize);
+    for (size_t i = 0; i < kStripes; i++) new (stripe(i)) Stripe();
+  }
+
+  /// @brief Returns the stripe index of the calling thread's current CPU.
+  static size_t CurrentStripe() { return os::GetCurrentCpu() & (kStripes - 1); }
+
+  void Add(size_t counter, uint64_t value) { Add(CurrentStripe(), counter, value); }
+
+  /// @brief Adds to @p counter in the stripe at @p index, from CurrentStripe.
+  void Add(size_t index, size_t counter, uint64_t value) {
+    stripe(index)->values[counter].fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t Read(size_t counter) const {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kStripes; i++)
+      sum += stripe(i)->values[counter].load(std::memory_order_relaxed);
+    return sum;
+  }
+
+ private:
+  // Stripes are shared by CPUs with equal index modulo kStripes.
+  static const size_t kStripes = 16;
+  static const size_t kCacheLineSize = 64;
+
+  struct Stripe {
+    std::atomic<uint64_t> values[N];
+  };
+  static const size_t kStripeSize =
+      (sizeof(Stripe) + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+
+  Stripe* stripe(size_t index) const {
+    return reinterpret_cast<Stripe*>(base_ + index * kStripeSize);
+  }
+
+  // Stripes are aligned by hand since heap allocations are not cache line
+  // aligned before C++17.
+  char storage_[kStripes * kStripeSize + kCacheLineSize];
+  char* base_;
+
+  DISALLOW_COPY_AND_ASSIGN(PerCpuCounters);
+};
+
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_UTIL_PERCPU_COUNTER_H_
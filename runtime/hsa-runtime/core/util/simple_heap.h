@@ -47,6 +47,7 @@
 #ifndef HSA_RUNTME_CORE_UTIL_SIMPLE_HEAP_H_
 #define HSA_RUNTME_CORE_UTIL_SIMPLE_HEAP_H_
 
+#include <algorithm>
 #include <map>
 #include <deque>
 #include <utility>
@@ -89,6 +90,8 @@ template <typename Allocator> class SimpleHeap {
   size_t in_use_size_;
   // Total size of block cache
   size_t cache_size_;
+  // Cache size retained regardless of usage.
+  size_t cache_floor_;
 
   __forceinline bool isFree(const Fragment_T& node) { return node.free; }
   __forceinline void setUsed(Fragment_T& node) {
@@ -118,7 +121,7 @@ template <typename Allocator> class SimpleHeap {
 
  public:
   explicit SimpleHeap(const Allocator& BlockAllocator = Allocator())
-      : block_allocator_(BlockAllocator), in_use_size_(0), cache_size_(0) {}
+      : block_allocator_(BlockAllocator), in_use_size_(0), cache_size_(0), cache_floor_(0) {}
   ~SimpleHeap() {
     trim();
     // Leak here may be due to the user.  Check is for debugging only.
@@ -163,12 +166,21 @@ template <typename Allocator> class SimpleHeap {
       return reinterpret_cast<void*>(base);
     }
 
-    // No usable fragment, check block cache
-    if (bytes < default_block_size() && !block_cache_.empty()) {
-      const auto& block = block_cache_.back();
-      base = block.base_ptr_;
-      size = block.length_;
-      block_cache_.pop_back();
+    // No usable fragment, check block cache for the smallest block that fits.  Blocks are
+    // normally all the default size, prefer the most recently cached one.
+    auto cached = block_cache_.end();
+    if (bytes < default_block_size()) {
+      for (auto it = block_cache_.begin(); it != block_cache_.end(); it++) {
+        if ((it->length_ >= bytes) &&
+            ((cached == block_cache_.end()) || (it->length_ <= cached->length_)))
+          cached = it;
+      }
+    }
+
+    if (cached != block_cache_.end()) {
+      base = cached->base_ptr_;
+      size = cached->length_;
+      block_cache_.erase(cached);
       cache_size_ -= size;
     } else {  // Alloc new block - new block may be larger than default.
       void* ptr = block_allocator_.alloc(bytes, size);
@@ -267,7 +279,7 @@ template <typename Allocator> class SimpleHeap {
 
   void balance() {
     // Release old blocks when over cache limit.
-    while ((block_cache_.size() > 1) && (cache_size_ > in_use_size_ * 2)) {
+    while ((block_cache_.size() > 1) && (cache_size_ > std::max(in_use_size_ * 2, cache_floor_))) {
       const auto& block = block_cache_.front();
       block_allocator_.free(reinterpret_cast<void*>(block.base_ptr_), block.length_);
       cache_size_ -= block.length_;
@@ -275,15 +287,26 @@ template <typename Allocator> class SimpleHeap {
     }
   }
 
-  void trim() {
-    for (const auto& block : block_cache_)
+  // Release cached blocks, oldest first, until at most keep bytes remain cached.
+  void trim(size_t keep = 0) {
+    while (!block_cache_.empty() && (cache_size_ > keep)) {
+      const auto& block = block_cache_.front();
       block_allocator_.free(reinterpret_cast<void*>(block.base_ptr_), block.length_);
-    block_cache_.clear();
-    cache_size_ = 0;
+      cache_size_ -= block.length_;
+      block_cache_.pop_front();
+    }
+  }
+
+  // Keep up to bytes of free blocks cached even when usage is low.
+  void set_cache_floor(size_t bytes) {
+    cache_floor_ = bytes;
+    balance();
   }
 
   size_t cache_size() const { return cache_size_; }
 
+  size_t in_use_size() const { return in_use_size_; }
+
   size_t default_block_size() const { return block_allocator_.block_size(); }
 
   // Prevent reuse of the block containing ptr.  No further fragments will be allocated from the
@@ -0,0 +1,366 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "core/util/trace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <unordered_set>
+#include <vector>
+
+#include "core/util/locks.h"
+#include "core/util/os.h"
+#include "core/util/timer.h"
+
+namespace rocr {
+namespace trace {
+
+std::atomic<bool> enabled(false);
+
+namespace {
+
+// Period of the flusher.  A ring of N events absorbs bursts of N events per
+// period per thread without drops.
+const unsigned int kFlushIntervalMs = 10;
+
+const size_t kMinRingEvents = 64;
+// Keeps one ring's events block below the 4GB block size limit.
+const size_t kMaxRingEvents = size_t(1) << 24;
+
+// Single producer, single consumer ring of one thread's events.  Rings are
+// never freed: a ring whose thread exited is reused by a later thread.
+struct Ring {
+  explicit Ring(size_t size)
+      : events(new Event[size]()),
+        mask(size - 1),
+        head(0),
+        dropped(0),
+        cached_tail(0),
+        tail(0),
+        reported(0),
+        tid(0),
+        in_use(true) {}
+
+  std::unique_ptr<Event[]> events;
+  const uint64_t mask;
+
+  // Written by the owning thread.
+  std::atomic<uint64_t> head;
+  std::atomic<uint64_t> dropped;
+  // Owner's last read of tail, so the flusher's line is only read when the
+  // ring looks full.
+  uint64_t cached_tail;
+
+  // Written by the flusher, kept off the producer's cache line.
+  alignas(64) std::atomic<uint64_t> tail;
+  // Dropped count already written to the file.
+  uint64_t reported;
+
+  std::atomic<uint32_t> tid;
+  // Cleared when the owning thread exits.
+  std::atomic<bool> in_use;
+};
+
+class Tracer {
+ public:
+  Tracer() : ring_events_(0), file_(nullptr), flusher_(nullptr), wake_(nullptr), exit_(false) {}
+
+  void Start(const std::string& path, size_t ring_events);
+  void Stop();
+
+  // Returns a ring for the calling thread or nullptr if out of memory.
+  Ring* AcquireRing(uint32_t tid);
+
+ private:
+  static void FlushLoop(void* tracer);
+
+  // Moves all recorded events to the file.  Only called by the flusher or
+  // after it stopped.
+  void Flush();
+
+  void WriteBlock(BlockType type, const void* data, uint32_t size);
+  void WriteName(uint64_t key);
+
+  // Protects rings_, ring_events_ and file_.
+  KernelMutex lock_;
+  std::vector<Ring*> rings_;
+  size_t ring_events_;
+
+  FILE* file_;
+  os::Thread flusher_;
+  os::EventHandle wake_;
+  std::atomic<bool> exit_;
+
+  // Paths written by this process.
+  std::unordered_set<std::string> opened_;
+
+  // kApi names already written.
+  std::unordered_set<uint64_t> names_;
+  std::vector<Event> buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(Tracer);
+};
+
+// Leaked so threads exiting after static destruction may still use it.
+Tracer& tracer() {
+  static Tracer* tracer = new Tracer();
+  return *tracer;
+}
+
+struct RingHolder {
+  RingHolder() : ring(nullptr), tid(0) {}
+  ~RingHolder() {
+    if (ring != nullptr) ring->in_use.store(false, std::memory_order_release);
+  }
+  Ring* ring;
+  uint32_t tid;
+};
+
+thread_local RingHolder holder;
+
+void Tracer::Start(const std::string& path, size_t ring_events) {
+  if (path.empty()) return;
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  if (file_ != nullptr) return;
+
+  // Truncate on the first session of the process, later sessions (after
+  // hsa_shut_down and hsa_init) append a new header and their blocks.
+  bool first = opened_.insert(path).second;
+  file_ = fopen(path.c_str(), first ? "wb" : "ab");
+  if (file_ == nullptr) {
+    debug_print("Could not open trace file %s.\n", path.c_str());
+    return;
+  }
+  MAKE_NAMED_SCOPE_GUARD(fileGuard, [&]() {
+    fclose(file_);
+    file_ = nullptr;
+  });
+
+  ring_events = std::min(std::max(ring_events, kMinRingEvents), kMaxRingEvents);
+  ring_events_ = size_t(1) << (64 - __builtin_clzll(ring_events - 1));
+
+  // Discard events left over from a previous session.
+  for (Ring* ring : rings_) {
+    ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+    ring->reported = ring->dropped.load(std::memory_order_relaxed);
+  }
+  names_.clear();
+
+  FileHeader header;
+  memcpy(header.magic, kFileMagic, sizeof(header.magic));
+  header.version = kFileVersion;
+  header.event_size = sizeof(Event);
+#if defined(__x86_64__) || defined(_M_X64)
+  header.frequency = timer::fast_clock::raw_freq();
+#else
+  header.frequency = 1e9;
+#endif
+  header.start_timestamp = timer::fast_clock::raw_now();
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  header.start_realtime_ns = uint64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+  if (fwrite(&header, sizeof(header), 1, file_) != 1) return;
+
+  wake_ = os::CreateOsEvent(true, false);
+  if (wake_ == nullptr) return;
+  exit_ = false;
+  flusher_ = os::CreateThread(FlushLoop, this);
+  if (flusher_ == nullptr) {
+    os::DestroyOsEvent(wake_);
+    wake_ = nullptr;
+    return;
+  }
+
+  fileGuard.Dismiss();
+  enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::Stop() {
+  {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    if (file_ == nullptr) return;
+    enabled.store(false, std::memory_order_relaxed);
+  }
+
+  exit_ = true;
+  os::SetOsEvent(wake_);
+  os::WaitForThread(flusher_);
+  os::CloseThread(flusher_);
+  flusher_ = nullptr;
+  os::DestroyOsEvent(wake_);
+  wake_ = nullptr;
+
+  // Events of threads still inside a traced scope are written now, later ones
+  // are discarded by the next Start.
+  Flush();
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  fclose(file_);
+  file_ = nullptr;
+}
+
+Ring* Tracer::AcquireRing(uint32_t tid) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  for (Ring* ring : rings_) {
+    if (ring->in_use.load(std::memory_order_acquire)) continue;
+    // Keep the previous thread's events until they are flushed.
+    if (ring->head.load(std::memory_order_relaxed) != ring->tail.load(std::memory_order_acquire))
+      continue;
+    ring->tid.store(tid, std::memory_order_relaxed);
+    ring->in_use.store(true, std::memory_order_relaxed);
+    return ring;
+  }
+
+  if (ring_events_ == 0) return nullptr;
+  Ring* ring = new (std::nothrow) Ring(ring_events_);
+  if (ring == nullptr) return nullptr;
+  ring->tid.store(tid, std::memory_order_relaxed);
+  rings_.push_back(ring);
+  return ring;
+}
+
+void Tracer::FlushLoop(void* tracer) {
+  Tracer* self = reinterpret_cast<Tracer*>(tracer);
+  while (!self->exit_) {
+    os::WaitForOsEvent(self->wake_, kFlushIntervalMs);
+    if (self->exit_) break;
+    self->Flush();
+  }
+}
+
+void Tracer::Flush() {
+  std::vector<Ring*> rings;
+  {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    rings = rings_;
+  }
+
+  for (Ring* ring : rings) {
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    if (head != tail) {
+      buffer_.clear();
+      for (uint64_t i = tail; i != head; i++) buffer_.push_back(ring->events[i & ring->mask]);
+      ring->tail.store(head, std::memory_order_release);
+
+      for (const Event& event : buffer_) {
+        if (event.id == kApi && names_.insert(event.arg0).second) WriteName(event.arg0);
+      }
+      WriteBlock(kBlockEvents, buffer_.data(), buffer_.size() * sizeof(Event));
+    }
+
+    uint64_t dropped = ring->dropped.load(std::memory_order_relaxed);
+    if (dropped != ring->reported) {
+      struct {
+        uint32_t tid;
+        uint32_t reserved;
+        uint64_t count;
+      } block = {ring->tid.load(std::memory_order_relaxed), 0, dropped - ring->reported};
+      WriteBlock(kBlockDropped, &block, sizeof(block));
+      ring->reported = dropped;
+    }
+  }
+
+  fflush(file_);
+}
+
+void Tracer::WriteBlock(BlockType type, const void* data, uint32_t size) {
+  BlockHeader header = {type, size};
+  fwrite(&header, sizeof(header), 1, file_);
+  fwrite(data, size, 1, file_);
+}
+
+void Tracer::WriteName(uint64_t key) {
+  const char* name = reinterpret_cast<const char*>(key);
+  size_t len = strlen(name);
+  BlockHeader header = {kBlockString, uint32_t(sizeof(key) + len)};
+  fwrite(&header, sizeof(header), 1, file_);
+  fwrite(&key, sizeof(key), 1, file_);
+  fwrite(name, len, 1, file_);
+}
+
+}  // namespace
+
+void RecordEvent(EventId id, Phase phase, uint64_t arg0, uint64_t arg1) {
+  Ring* ring = holder.ring;
+  if (__builtin_expect(ring == nullptr, false)) {
+    holder.tid = uint32_t(syscall(SYS_gettid));
+    ring = holder.ring = tracer().AcquireRing(holder.tid);
+    if (ring == nullptr) return;
+  }
+
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  if (head - ring->cached_tail > ring->mask) {
+    ring->cached_tail = ring->tail.load(std::memory_order_acquire);
+    if (head - ring->cached_tail > ring->mask) {
+      ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  Event& event = ring->events[head & ring->mask];
+  event.timestamp = timer::fast_clock::raw_now();
+  event.tid = holder.tid;
+  event.id = id;
+  event.phase = phase;
+  event.reserved = 0;
+  event.arg0 = arg0;
+  event.arg1 = arg1;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+void Start(const std::string& path, size_t ring_events) { tracer().Start(path, ring_events); }
+
+void Stop() { tracer().Stop(); }
+
+}  // namespace trace
+}  // namespace rocr
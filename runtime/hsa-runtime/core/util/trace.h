@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Low overhead binary tracing of runtime events.
+//
+// Enabled by HSA_TRACE_FILE=<path>.  Each thread records fixed size events
+// into its own single producer ring, without locks or formatting.  A flusher
+// thread drains the rings to the trace file every few milliseconds.  Events
+// which find their ring full are dropped and counted.  When tracing is off
+// recording costs one relaxed load and a predicted branch.
+//
+// File layout: FileHeader followed by blocks, each a BlockHeader and its
+// payload.  A process truncates the file when it first starts tracing, later
+// sessions in the same process append another FileHeader and their blocks.
+// Events of one thread are in order, events of different threads must be
+// sorted by timestamp.  Timestamps are fast_clock ticks, TSC on x86.
+// runtime/hsa-runtime/tools/rocr_trace_decode.py decodes a trace file.
+
+#ifndef HSA_RUNTIME_CORE_UTIL_TRACE_H_
+#define HSA_RUNTIME_CORE_UTIL_TRACE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace trace {
+
+enum EventId : uint16_t {
+  // arg0: API function name.
+  kApi = 1,
+  // arg0: queue id, arg1: doorbell value.
+  kDoorbell = 2,
+  // arg0: blit engine, arg1: bytes.
+  kBlitCopy = 3,
+  kBlitFill = 4,
+  // arg0: signal handle, arg1: compare value.
+  kSignalWait = 5,
+  // arg0: number of signals.
+  kSignalWaitAny = 6,
+  // arg0: queue scratch info, arg1: 0 for main and 1 for alt scratch.
+  kScratchAcquire = 7,
+  // arg0: queue scratch info, arg1: bytes released.
+  kScratchRelease = 8,
+  // arg0: address, arg1: bytes.
+  kAllocate = 9,
+  // arg0: address.
+  kFree = 10,
+};
+
+enum Phase : uint8_t { kInstant = 0, kBegin = 1, kEnd = 2 };
+
+struct Event {
+  uint64_t timestamp;
+  uint32_t tid;
+  uint16_t id;
+  uint8_t phase;
+  uint8_t reserved;
+  uint64_t arg0;
+  uint64_t arg1;
+};
+static_assert(sizeof(Event) == 32, "Trace event size changed.");
+
+static const char kFileMagic[8] = {'R', 'O', 'C', 'R', 'T', 'R', 'C', '\0'};
+static const uint32_t kFileVersion = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t event_size;
+  // Timestamp ticks per second.
+  double frequency;
+  // Timestamp and CLOCK_REALTIME in ns when tracing started.
+  uint64_t start_timestamp;
+  uint64_t start_realtime_ns;
+};
+
+enum BlockType : uint32_t {
+  // Array of Event.
+  kBlockEvents = 1,
+  // uint64_t key followed by the name, not terminated.  Names kApi arg0 keys.
+  kBlockString = 2,
+  // uint32_t tid, uint32_t reserved, uint64_t events dropped since the last
+  // block for tid.
+  kBlockDropped = 3,
+};
+
+struct BlockHeader {
+  uint32_t type;
+  // Payload bytes.
+  uint32_t size;
+};
+
+extern std::atomic<bool> enabled;
+
+// Out of line part of Record.
+void RecordEvent(EventId id, Phase phase, uint64_t arg0, uint64_t arg1);
+
+static __forceinline void Record(EventId id, Phase phase, uint64_t arg0 = 0, uint64_t arg1 = 0) {
+  if (__builtin_expect(enabled.load(std::memory_order_relaxed), false))
+    RecordEvent(id, phase, arg0, arg1);
+}
+
+// Records begin and end events around a scope.
+class Scope {
+ public:
+  Scope(EventId id, uint64_t arg0, uint64_t arg1 = 0) : id_(id), arg0_(arg0), arg1_(arg1) {
+    Record(id_, kBegin, arg0_, arg1_);
+  }
+  ~Scope() { Record(id_, kEnd, arg0_, arg1_); }
+
+ private:
+  EventId id_;
+  uint64_t arg0_;
+  uint64_t arg1_;
+  DISALLOW_COPY_AND_ASSIGN(Scope);
+};
+
+/// @brief Starts tracing to @p path with rings of @p ring_events events.
+/// Does nothing if @p path is empty or tracing is already started.  Truncates
+/// @p path the first time it is used by the process, appends afterwards.
+void Start(const std::string& path, size_t ring_events);
+
+/// @brief Stops tracing and writes out the remaining events.
+void Stop();
+
+}  // namespace trace
+}  // namespace rocr
+
+// Traces entry and exit of the enclosing API function.
+#define TRACE_API() rocr::trace::Scope trace_api_scope_(rocr::trace::kApi, uintptr_t(__func__))
+
+#endif  // HSA_RUNTIME_CORE_UTIL_TRACE_H_
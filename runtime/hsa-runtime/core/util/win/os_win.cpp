@@ -135,6 +135,8 @@ void uSleep(int delayInUs) { ::Sleep(delayInUs / 1000); }
 
 void YieldThread() { ::Sleep(0); }
 
+uint32_t GetCurrentCpu() { return GetCurrentProcessorNumber(); }
+
 struct ThreadArgs {
   void* entry_args;
   ThreadEntry entry_function;
@@ -188,6 +188,8 @@ struct PcSamplingExtTable {
   decltype(hsa_ven_amd_pcs_start)* hsa_ven_amd_pcs_start_fn;
   decltype(hsa_ven_amd_pcs_stop)* hsa_ven_amd_pcs_stop_fn;
   decltype(hsa_ven_amd_pcs_flush)* hsa_ven_amd_pcs_flush_fn;
+  decltype(hsa_ven_amd_pcs_data_acquire)* hsa_ven_amd_pcs_data_acquire_fn;
+  decltype(hsa_ven_amd_pcs_data_release)* hsa_ven_amd_pcs_data_release_fn;
 };
 
 
@@ -266,6 +268,24 @@ struct AmdExtTable {
   decltype(hsa_amd_queue_get_info)* hsa_amd_queue_get_info_fn;
   decltype(hsa_amd_vmem_address_reserve_align)* hsa_amd_vmem_address_reserve_align_fn;
   decltype(hsa_amd_enable_logging)* hsa_amd_enable_logging_fn;
+  decltype(hsa_amd_memory_pool_free_async)* hsa_amd_memory_pool_free_async_fn;
+  decltype(hsa_amd_ordered_pool_create)* hsa_amd_ordered_pool_create_fn;
+  decltype(hsa_amd_ordered_pool_destroy)* hsa_amd_ordered_pool_destroy_fn;
+  decltype(hsa_amd_ordered_pool_allocate)* hsa_amd_ordered_pool_allocate_fn;
+  decltype(hsa_amd_ordered_pool_free)* hsa_amd_ordered_pool_free_fn;
+  decltype(hsa_amd_ordered_pool_trim)* hsa_amd_ordered_pool_trim_fn;
+  decltype(hsa_amd_ordered_pool_set_release_threshold)* hsa_amd_ordered_pool_set_release_threshold_fn;
+  decltype(hsa_amd_profiling_convert_ticks_to_system_domain)*
+      hsa_amd_profiling_convert_ticks_to_system_domain_fn;
+  decltype(hsa_amd_ipc_memory_attach_batch)* hsa_amd_ipc_memory_attach_batch_fn;
+  decltype(hsa_amd_ipc_memory_cache_purge)* hsa_amd_ipc_memory_cache_purge_fn;
+  decltype(hsa_amd_ipc_memory_cache_stats)* hsa_amd_ipc_memory_cache_stats_fn;
+  decltype(hsa_amd_svm_profile_iterate_ranges)* hsa_amd_svm_profile_iterate_ranges_fn;
+  decltype(hsa_amd_svm_attributes_set_async)* hsa_amd_svm_attributes_set_async_fn;
+  decltype(hsa_amd_svm_attributes_get_async)* hsa_amd_svm_attributes_get_async_fn;
+  decltype(hsa_amd_runtime_stats_get)* hsa_amd_runtime_stats_get_fn;
+  decltype(hsa_amd_profiling_dispatch_slots_enable)* hsa_amd_profiling_dispatch_slots_enable_fn;
+  decltype(hsa_amd_profiling_get_dispatch_times)* hsa_amd_profiling_get_dispatch_times_fn;
 };
 
 // Table to export HSA Core Runtime Apis
@@ -58,11 +58,11 @@
 // Step Ids of the Api tables exported by Hsa Core Runtime
 #define HSA_API_TABLE_STEP_VERSION                  0x01
 #define HSA_CORE_API_TABLE_STEP_VERSION             0x00
-#define HSA_AMD_EXT_API_TABLE_STEP_VERSION          0x04
+#define HSA_AMD_EXT_API_TABLE_STEP_VERSION          0x0D
 #define HSA_FINALIZER_API_TABLE_STEP_VERSION        0x00
 #define HSA_IMAGE_API_TABLE_STEP_VERSION            0x00
 #define HSA_AQLPROFILE_API_TABLE_STEP_VERSION       0x00
 #define HSA_TOOLS_API_TABLE_STEP_VERSION            0x00
-#define HSA_PC_SAMPLING_API_TABLE_STEP_VERSION      0x00
+#define HSA_PC_SAMPLING_API_TABLE_STEP_VERSION      0x01
 
 #endif  // HSA_RUNTIME_INC_HSA_API_TRACE_VERSION_H
@@ -57,9 +57,21 @@
  * - 1.4 - Virtual Memory API
  * - 1.5 - hsa_amd_agent_info: HSA_AMD_AGENT_INFO_MEMORY_PROPERTIES
  * - 1.6 - Virtual Memory API: hsa_amd_vmem_address_reserve_align
+ * - 1.7 - hsa_amd_memory_pool_free_async
+ * - 1.8 - Ordered memory pools: hsa_amd_ordered_pool_create and related calls
+ * - 1.9 - hsa_amd_profiling_convert_ticks_to_system_domain
+ * - 1.10 - hsa_amd_ipc_memory_attach_batch
+ * - 1.11 - IPC attach cache: hsa_amd_ipc_memory_cache_purge, hsa_amd_ipc_memory_cache_stats
+ * - 1.12 - SVM profiler: hsa_amd_svm_profile_iterate_ranges
+ * - 1.13 - hsa_amd_svm_attributes_set_async, hsa_amd_svm_attributes_get_async
+ * - 1.14 - hsa_amd_runtime_stats_get
+ * - 1.15 - hsa_amd_profiling_dispatch_slots_enable, hsa_amd_profiling_get_dispatch_times
+ * - 1.16 - Memory pool flags: HSA_AMD_MEMORY_POOL_HUGE_PAGE_2MB_FLAG,
+ *          HSA_AMD_MEMORY_POOL_HUGE_PAGE_1GB_FLAG, HSA_AMD_MEMORY_POOL_NUMA_INTERLEAVE_FLAG
+ * - 1.17 - Memory pool flag: HSA_AMD_MEMORY_POOL_ZEROED_FLAG
  */
 #define HSA_AMD_INTERFACE_VERSION_MAJOR 1
-#define HSA_AMD_INTERFACE_VERSION_MINOR 6
+#define HSA_AMD_INTERFACE_VERSION_MINOR 17
 
 #ifdef __cplusplus
 extern "C" {
@@ -965,6 +977,101 @@ hsa_status_t HSA_API hsa_amd_profiling_get_dispatch_time(
     hsa_agent_t agent, hsa_signal_t signal,
     hsa_amd_profiling_dispatch_time_t* time);
 
+/**
+ * @brief Distance in bytes between the completion signal handles of
+ * consecutive dispatch time slots.
+ */
+#define HSA_AMD_PROFILING_DISPATCH_SLOT_SIZE 64
+
+/**
+ * @brief Enable dispatch time slots on a queue.
+ *
+ * @details Dispatch time slots collect packet processing time stamps without
+ * a signal per profiled packet.  The queue owns one slot per packet in its
+ * ring, and packet ID P owns slot (P % queue->size).  The slot handle of
+ * packet P is:
+ *
+ *   slot_base.handle + (P % queue->size) * HSA_AMD_PROFILING_DISPATCH_SLOT_SIZE
+ *
+ * A packet is profiled when its slot handle is used as its completion
+ * signal.  The packet processor then writes the packet's start and end
+ * time stamps into the slot.  Slots do not raise completion interrupts.
+ * Retrieve the time stamps in batches with
+ * ::hsa_amd_profiling_get_dispatch_times.  Packets that need to notify the
+ * host, such as a barrier closing a batch, still use ordinary signals.
+ *
+ * Slot handles are only valid as completion signals of packets on @p queue.
+ * They must not be passed to other signal functions.
+ *
+ * Profiling is enabled on @p queue as if by
+ * ::hsa_amd_profiling_set_profiler_enabled.  The slots are freed when the
+ * queue is destroyed.  Calling this function again returns the same
+ * @p slot_base.
+ *
+ * @param[in] queue A valid queue.
+ *
+ * @param[out] slot_base Completion signal handle of the slot of packet 0.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE The queue is invalid or is not a
+ * hardware queue of a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The slots could not be
+ * allocated.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p queue or @p slot_base is
+ * NULL.
+ */
+hsa_status_t HSA_API hsa_amd_profiling_dispatch_slots_enable(hsa_queue_t* queue,
+                                                             hsa_signal_t* slot_base);
+
+/**
+ * @brief Retrieve the time stamps of consecutive packets from the dispatch
+ * time slots of a queue.
+ *
+ * @details Reads the slots of packet IDs @p first_packet_id through
+ * @p first_packet_id + @p count - 1.  The time stamps of all packets in the
+ * batch are translated to the HSA system clock domain with the same clock
+ * correlation.
+ *
+ * A packet that has not completed, or did not use its slot, reports a start
+ * and end of 0.  The slot of a completed packet is cleared once read.  Read a
+ * packet's slot before the queue wraps around to it, which happens when
+ * packet ID (P + queue->size) is submitted.
+ *
+ * @param[in] queue A queue with dispatch time slots enabled.
+ *
+ * @param[in] first_packet_id Packet ID of the first packet to read.
+ *
+ * @param[in] count Number of packets to read.  Must not exceed queue->size.
+ *
+ * @param[out] times Array of @p count entries receiving the time stamps of
+ * each packet.
+ *
+ * @param[out] completed Number of entries in @p times holding the time stamps
+ * of completed packets.  May be NULL.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE The queue is invalid or does not
+ * have dispatch time slots enabled.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p queue is NULL, @p times is
+ * NULL while @p count is not 0, or @p count exceeds the queue size.
+ */
+hsa_status_t HSA_API hsa_amd_profiling_get_dispatch_times(hsa_queue_t* queue,
+                                                          uint64_t first_packet_id,
+                                                          uint32_t count,
+                                                          hsa_amd_profiling_dispatch_time_t* times,
+                                                          uint32_t* completed);
+
 /**
  * @brief Retrieve asynchronous copy timestamps.
  *
@@ -1015,6 +1122,40 @@ hsa_status_t HSA_API
                                                     uint64_t agent_tick,
                                                     uint64_t* system_tick);
 
+/**
+ * @brief Converts an array of the agent's ticks to HSA system domain ticks.
+ *
+ * @details Equivalent to calling
+ * ::hsa_amd_profiling_convert_tick_to_system_domain for each tick, except that
+ * all ticks are converted with the same clock correlation. Prefer this
+ * function when converting many ticks.
+ *
+ * @param[in] agent The agent used to retrieve the ticks. It is user's
+ * responsibility to make sure the ticks are from this agent, otherwise, the
+ * behavior is undefined.
+ *
+ * @param[in] num_ticks Number of ticks to convert.
+ *
+ * @param[in] agent_ticks Tick counts retrieved from the specified @p agent.
+ *
+ * @param[out] system_ticks Translated HSA system domain clock counter ticks.
+ * May be equal to @p agent_ticks to convert in place.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p agent_ticks or
+ * @p system_ticks is NULL and @p num_ticks is not 0.
+ */
+hsa_status_t HSA_API
+    hsa_amd_profiling_convert_ticks_to_system_domain(hsa_agent_t agent, size_t num_ticks,
+                                                     const uint64_t* agent_ticks,
+                                                     uint64_t* system_ticks);
+
 /** @} */
 
 /** \defgroup status Runtime notifications
@@ -1578,6 +1719,36 @@ typedef enum hsa_amd_memory_pool_flag_s {
    *  Allocates executable memory
    */
   HSA_AMD_MEMORY_POOL_EXECUTABLE_FLAG = (1 << 2),
+  /**
+   * Backs system memory with 2MB huge pages. The allocation size is rounded up
+   * to a multiple of 2MB. If no explicit huge pages are available, the
+   * allocation falls back to transparent huge pages and then to base pages.
+   * Only valid for system memory pools.
+   */
+  HSA_AMD_MEMORY_POOL_HUGE_PAGE_2MB_FLAG = (1 << 3),
+  /**
+   * Backs system memory with 1GB huge pages. The allocation size is rounded up
+   * to a multiple of 1GB. Falls back to 2MB huge pages, then as
+   * ::HSA_AMD_MEMORY_POOL_HUGE_PAGE_2MB_FLAG. Only valid for system memory
+   * pools.
+   */
+  HSA_AMD_MEMORY_POOL_HUGE_PAGE_1GB_FLAG = (1 << 4),
+  /**
+   * Interleaves system memory pages across NUMA nodes instead of placing
+   * them on the node of the pool. The node set defaults to all nodes the
+   * process may allocate from and can be restricted with the
+   * HSA_NUMA_INTERLEAVE_NODES environment variable (numactl node list
+   * syntax). Only valid for system memory pools.
+   */
+  HSA_AMD_MEMORY_POOL_NUMA_INTERLEAVE_FLAG = (1 << 5),
+  /**
+   * Returns zero-filled memory. Device memory is served from a per-pool cache
+   * of blocks zeroed ahead of time by SDMA, which is refilled in the
+   * background for sizes requested repeatedly. If no block is ready the
+   * memory is zeroed before returning. The cache size is set with the
+   * HSA_ZEROED_POOL_SIZE environment variable, 0 disables it.
+   */
+  HSA_AMD_MEMORY_POOL_ZEROED_FLAG = (1 << 6),
 
 } hsa_amd_memory_pool_flag_t;
 
@@ -1693,6 +1864,214 @@ hsa_status_t HSA_API
  */
 hsa_status_t HSA_API hsa_amd_memory_pool_free(void* ptr);
 
+/**
+ * @brief Deallocate a block of memory previously allocated using
+ * ::hsa_amd_memory_pool_allocate once a dependency signal completes.
+ *
+ * @details The allocation is released from the runtime's view immediately, so
+ * @p ptr must not be passed to any other API after this call returns.  The
+ * backing memory is unmapped and returned to the system by the runtime's
+ * asynchronous event thread once the value of @p dependency_signal becomes 0.
+ * Frees waiting on the same signal are reclaimed together so that GPU unmaps
+ * can be batched.  Deallocation notifiers registered on @p ptr run at reclaim
+ * time.
+ *
+ * @param[in] ptr Pointer to a memory block previously returned by
+ * ::hsa_amd_memory_pool_allocate.  A NULL pointer is ignored.
+ *
+ * @param[in] dependency_signal Signal to wait on before the memory is
+ * released.  If the handle is 0 the memory is released as soon as possible
+ * without blocking the caller.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The free has been queued.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr does not match a
+ * value previously returned by ::hsa_amd_memory_pool_allocate or is already
+ * pending release.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p dependency_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to queue the
+ * release.
+ */
+hsa_status_t HSA_API hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dependency_signal);
+
+/**
+ * @brief Ordered memory pool, a sub-allocating pool on top of a memory pool
+ * whose frees are ordered by signals.
+ */
+typedef struct hsa_amd_ordered_pool_s {
+  /**
+   * Opaque handle. Two handles reference the same object of the enclosing type
+   * if and only if they are equal.
+   */
+  uint64_t handle;
+} hsa_amd_ordered_pool_t;
+
+/**
+ * @brief Create an ordered pool allocating from @p memory_pool.
+ *
+ * @details The ordered pool reserves large blocks from @p memory_pool and
+ * sub-allocates them, so allocations of any size are recycled without kernel
+ * driver calls. Memory freed with ::hsa_amd_ordered_pool_free becomes
+ * reusable once its release signal completes. Allocations that accept a
+ * dependency may receive memory whose release is still pending, together
+ * with the signal their first use must be ordered after, in the way stream
+ * ordered allocators recycle memory within a stream.
+ *
+ * Unused memory beyond the release threshold, initially 0, is returned to
+ * @p memory_pool when it exceeds twice the memory in use, or on
+ * ::hsa_amd_ordered_pool_trim. All unused memory is returned when an
+ * allocation from @p memory_pool runs out of memory.
+ *
+ * Memory of an ordered pool is not an allocation of @p memory_pool:
+ * ::hsa_amd_pointer_info and ::hsa_amd_agents_allow_access do not accept it.
+ * Agents needing access must be given in @p agents.
+ *
+ * @param[in] memory_pool Memory pool to allocate blocks from. Must be a
+ * global segment pool that allows runtime allocation.
+ *
+ * @param[in] num_agents Size of @p agents.
+ *
+ * @param[in] agents Agents given access to all memory of the ordered pool, in
+ * addition to the default access of @p memory_pool. May be NULL if
+ * @p num_agents is 0.
+ *
+ * @param[out] pool Created ordered pool.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p memory_pool is invalid or
+ * does not allow allocation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent in @p agents is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p pool is NULL, or @p agents is
+ * NULL and @p num_agents is not 0.
+ */
+hsa_status_t HSA_API hsa_amd_ordered_pool_create(hsa_amd_memory_pool_t memory_pool,
+                                                 uint32_t num_agents, const hsa_agent_t* agents,
+                                                 hsa_amd_ordered_pool_t* pool);
+
+/**
+ * @brief Destroy an ordered pool, returning its memory to the memory pool.
+ *
+ * @details Waits for the release signals of all pending frees.
+ *
+ * @param[in] pool Ordered pool.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p pool is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_RESOURCE_FREE Allocations of @p pool have not
+ * been freed. The pool is not destroyed.
+ */
+hsa_status_t HSA_API hsa_amd_ordered_pool_destroy(hsa_amd_ordered_pool_t pool);
+
+/**
+ * @brief Allocate memory from an ordered pool.
+ *
+ * @param[in] pool Ordered pool.
+ *
+ * @param[in] size Allocation size in bytes. Allocations are 256 byte aligned.
+ *
+ * @param[out] ptr Allocated memory.
+ *
+ * @param[out] dependency If not NULL, the pool may return memory whose
+ * release is still pending. The release signal is then stored here and all
+ * use of @p ptr must be ordered after it reaches 0, for instance by passing
+ * it as a dependency of the first packet or copy touching the memory. A
+ * null handle is stored if the memory is ready. If NULL, only memory that is
+ * ready is returned.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p pool is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p size is 0 or @p ptr is NULL.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES No memory is available.
+ */
+hsa_status_t HSA_API hsa_amd_ordered_pool_allocate(hsa_amd_ordered_pool_t pool, size_t size,
+                                                   void** ptr, hsa_signal_t* dependency);
+
+/**
+ * @brief Free memory allocated from an ordered pool.
+ *
+ * @param[in] pool Ordered pool @p ptr was allocated from.
+ *
+ * @param[in] ptr Memory to free.
+ *
+ * @param[in] release_signal Signal completing (reaching 0) when the last use
+ * of @p ptr has finished. The memory is only handed out again to allocations
+ * that order after it until then. The signal must not be destroyed before it
+ * completes. If the handle is 0 the memory is reusable immediately.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p pool is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p release_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr is not a live
+ * allocation of @p pool.
+ */
+hsa_status_t HSA_API hsa_amd_ordered_pool_free(hsa_amd_ordered_pool_t pool, void* ptr,
+                                               hsa_signal_t release_signal);
+
+/**
+ * @brief Return unused memory of an ordered pool to its memory pool.
+ *
+ * @details Only blocks with no live or pending allocations are released.
+ *
+ * @param[in] pool Ordered pool.
+ *
+ * @param[in] min_bytes_to_keep Unused memory to keep cached, in bytes.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p pool is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_ordered_pool_trim(hsa_amd_ordered_pool_t pool,
+                                               size_t min_bytes_to_keep);
+
+/**
+ * @brief Set the amount of unused memory an ordered pool keeps cached
+ * regardless of how much memory is in use.
+ *
+ * @param[in] pool Ordered pool.
+ *
+ * @param[in] threshold Release threshold in bytes.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p pool is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_ordered_pool_set_release_threshold(hsa_amd_ordered_pool_t pool,
+                                                                size_t threshold);
+
 /**
  * @brief Asynchronously copy a block of memory from the location pointed to by
  * @p src on the @p src_agent to the memory block pointed to by @p dst on the @p
@@ -2537,6 +2916,46 @@ hsa_status_t HSA_API hsa_amd_ipc_memory_attach(
     const hsa_agent_t* mapping_agents,
     void** mapped_ptr);
 
+/**
+ * @brief Imports several shared memory handles into the local process, as
+ * if by calling hsa_amd_ipc_memory_attach on each handle.  Handles exported
+ * by the same process are imported with a single request to that process,
+ * which is faster than attaching them one at a time.
+ *
+ * Either all handles are attached or, on failure, none are.
+ *
+ * @param[in] num_handles Count of handles in @p handles.
+ *
+ * @param[in] handles Array of identifiers for the shared memory.
+ *
+ * @param[in] lens Array of @p num_handles lengths, as @p len of
+ * hsa_amd_ipc_memory_attach.
+ *
+ * @param[in] num_agents Count of agents in @p mapping_agents.
+ * May be zero if all agents are to be allowed access.
+ *
+ * @param[in] mapping_agents List of agents to access the shared memory.
+ * Ignored if @p num_agents is zero.
+ *
+ * @param[out] mapped_ptrs Array of @p num_handles entries receiving the process
+ * local pointers to the shared memory.  Each must be released with
+ * hsa_amd_ipc_memory_detach.
+ *
+ * @retval HSA_STATUS_SUCCESS if all memory is successfully imported.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT some handle is not valid, some
+ * length is incorrect, @p handles, @p lens or @p mapped_ptrs is NULL, or some
+ * agent for which access was requested can not access the shared memory.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_memory_attach_batch(
+    uint32_t num_handles, const hsa_amd_ipc_memory_t* handles, const size_t* lens,
+    uint32_t num_agents, const hsa_agent_t* mapping_agents, void** mapped_ptrs);
+
 /**
  * @brief Decrements the reference count for the shared memory mapping and
  * releases access to shared memory imported with hsa_amd_ipc_memory_attach.
@@ -2550,10 +2969,68 @@ hsa_status_t HSA_API hsa_amd_ipc_memory_attach(
  * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
  *
  * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p mapped_ptr was not imported
- * with hsa_amd_ipc_memory_attach.
+ * with hsa_amd_ipc_memory_attach, or all its attaches were already detached.
  */
 hsa_status_t HSA_API hsa_amd_ipc_memory_detach(void* mapped_ptr);
 
+/**
+ * @brief Statistics of the IPC attach cache.
+ *
+ * Attaching a handle already attached with the same length and agents returns
+ * the existing mapping and increments its reference count.  When the last
+ * reference is detached the mapping is kept for reuse, up to
+ * HSA_IPC_ATTACH_CACHE_SIZE mappings, instead of being unmapped.
+ */
+typedef struct hsa_amd_ipc_memory_cache_stats_s {
+  /**
+   * Attaches that reused a cached mapping.
+   */
+  uint64_t hits;
+  /**
+   * Attaches that imported and mapped the memory.
+   */
+  uint64_t misses;
+  /**
+   * Detached mappings unmapped to stay within the cache limit or by
+   * hsa_amd_ipc_memory_cache_purge.
+   */
+  uint64_t evictions;
+  /**
+   * Cached mappings with at least one outstanding attach.
+   */
+  uint64_t active;
+  /**
+   * Cached mappings with no outstanding attach.
+   */
+  uint64_t idle;
+} hsa_amd_ipc_memory_cache_stats_t;
+
+/**
+ * @brief Unmaps all detached mappings kept by the IPC attach cache.
+ *
+ * Memory of another process stays allocated while a process keeps a mapping
+ * of it.  Call this to release such memory, for example after the exporting
+ * process is done with it.  Attached mappings are not affected.
+ *
+ * @retval HSA_STATUS_SUCCESS if the cache is purged.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ */
+hsa_status_t HSA_API hsa_amd_ipc_memory_cache_purge(void);
+
+/**
+ * @brief Retrieves statistics of the IPC attach cache.
+ *
+ * @param[out] stats Receives the statistics.
+ *
+ * @retval HSA_STATUS_SUCCESS if @p stats is filled.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p stats is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_memory_cache_stats(hsa_amd_ipc_memory_cache_stats_t* stats);
+
 /** @} */
 
 /** \addtogroup status Runtime notifications
@@ -3058,6 +3535,180 @@ hsa_status_t hsa_amd_svm_prefetch_async(void* ptr, size_t size, hsa_agent_t agen
                                         uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
                                         hsa_signal_t completion_signal);
 
+/**
+ * @brief Asynchronously sets SVM memory attributes.
+ *
+ * Same as ::hsa_amd_svm_attributes_set, but the attributes are applied by a
+ * runtime worker thread when @p dep_signals have been observed equal to zero.
+ * Attribute changes and prefetches whose dependencies are satisfied are
+ * issued in submission order.  Consecutive attribute changes to the same
+ * range are merged into one driver call.
+ *
+ * @param[in] ptr Will be aligned down to nearest page boundary.
+ *
+ * @param[in] size Will be aligned up to nearest page boundary.
+ *
+ * @param[in] attribute_list List of attributes to set for the address range.
+ * The list is copied before this function returns.
+ *
+ * @param[in] attribute_count Length of @p attribute_list.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * attributes are set. If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal decremented once the attributes are set.
+ * The runtime indicates that an error has occurred by setting the value of the
+ * completion signal to a negative number. If no completion signal is required
+ * this handle may be null.
+ *
+ * @retval HSA_STATUS_SUCCESS The attribute change is queued.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p attribute_list is invalid.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_AGENT An attribute names an invalid agent.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_SIGNAL A dependent signal is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_svm_attributes_set_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
+
+/**
+ * @brief Asynchronously gets SVM memory attributes.
+ *
+ * Same as ::hsa_amd_svm_attributes_get, but the query is run by a runtime
+ * worker thread when @p dep_signals have been observed equal to zero, after
+ * the attribute changes and prefetches submitted before it.
+ *
+ * @param[in] ptr Will be aligned down to nearest page boundary.
+ *
+ * @param[in] size Will be aligned up to nearest page boundary.
+ *
+ * @param[in,out] attribute_list List of attributes to query.  Must remain
+ * valid until @p completion_signal is decremented, at which point it holds the
+ * results.
+ *
+ * @param[in] attribute_count Length of @p attribute_list.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * query. If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal decremented once @p attribute_list is
+ * written. The runtime indicates that an error has occurred by setting the
+ * value of the completion signal to a negative number.
+ *
+ * @retval HSA_STATUS_SUCCESS The query is queued.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p attribute_list is NULL or
+ * contains an attribute which cannot be queried.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_SIGNAL A dependent signal is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_svm_attributes_get_async(
+    void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list, size_t attribute_count,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
+
+/**
+ * @brief Placement hint derived by the SVM access profiler.
+ */
+typedef enum hsa_amd_svm_profile_hint_s {
+  /**
+   * No recurring access pattern was detected.
+   */
+  HSA_AMD_SVM_PROFILE_HINT_NONE = 0,
+  /**
+   * One agent page faulted on the range in several consecutive epochs.  The
+   * range should prefer and be prefetched to that agent.
+   */
+  HSA_AMD_SVM_PROFILE_HINT_PREFER_AGENT = 1,
+  /**
+   * The range repeatedly migrated back and forth between agents.  The range
+   * should prefer system memory.
+   */
+  HSA_AMD_SVM_PROFILE_HINT_PREFER_SYSTEM = 2
+} hsa_amd_svm_profile_hint_t;
+
+/**
+ * @brief SVM access statistics of a profiled range.
+ *
+ * Events are aggregated per 2MB aligned granule of the address space.
+ */
+typedef struct hsa_amd_svm_profile_range_s {
+  /**
+   * Start of the pages of the granule with recorded events.
+   */
+  void* base;
+  /**
+   * Size in bytes of the pages of the granule with recorded events.
+   */
+  size_t size;
+  /**
+   * GPU page faults and CPU page faults which caused a migration.
+   */
+  uint64_t page_faults;
+  /**
+   * Migrations touching the range.
+   */
+  uint64_t migrations;
+  /**
+   * Bytes of the range migrated.
+   */
+  uint64_t migrated_bytes;
+  /**
+   * Migrations which reversed the previous migration of the range.
+   */
+  uint64_t thrash_migrations;
+  /**
+   * Consecutive epochs, up to the last one faulted on, in which a single
+   * agent faulted on the range.
+   */
+  uint32_t fault_epochs;
+  /**
+   * Placement hint for the range.
+   */
+  hsa_amd_svm_profile_hint_t hint;
+  /**
+   * Agent whose memory the range should prefer.  Handle is 0 if there is no
+   * hint or the agent is not part of this process, e.g. for replayed logs.
+   */
+  hsa_agent_t hint_agent;
+  /**
+   * The hint was applied to the range because HSA_SVM_PROFILE_HINTS=1.
+   */
+  bool applied;
+} hsa_amd_svm_profile_range_t;
+
+/**
+ * @brief Iterates the ranges recorded by the SVM access profiler.
+ *
+ * The profiler aggregates the SVM page faults and migrations of this process
+ * when HSA_SVM_PROFILE names a log file or HSA_SVM_PROFILE_HINTS=1, and
+ * analyzes the log named by HSA_SVM_PROFILE_REPLAY at startup.  Otherwise no
+ * ranges are reported.
+ *
+ * @param[in] callback Callback invoked once per range.  If the callback
+ * returns a status other than ::HSA_STATUS_SUCCESS, the traversal stops and
+ * that status is returned.
+ *
+ * @param[in] data Application data passed to @p callback.
+ *
+ * @retval HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p callback is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_svm_profile_iterate_ranges(
+    hsa_status_t (*callback)(const hsa_amd_svm_profile_range_t* range, void* data), void* data);
+
 /** @} */
 
 /** \addtogroup profile Profiling
@@ -3117,6 +3768,106 @@ hsa_status_t hsa_amd_spm_set_dest_buffer(hsa_agent_t preferred_agent, size_t siz
                                          uint32_t* timeout, uint32_t* size_copied, void* dest,
                                          bool* is_data_loss);
 
+/**
+ * @brief Source of an ::hsa_amd_runtime_stats_entry_t.
+ */
+typedef enum hsa_amd_runtime_stats_source_s {
+  /**
+   * Totals of an agent: its queues, including destroyed ones, and its blit
+   * engines.  Submissions and doorbells of kernel blit engines are counted
+   * once, by the queue the engine uses.
+   */
+  HSA_AMD_RUNTIME_STATS_SOURCE_AGENT = 0,
+  /**
+   * An AQL queue of the agent, including queues used internally by the
+   * runtime.
+   */
+  HSA_AMD_RUNTIME_STATS_SOURCE_QUEUE = 1,
+  /**
+   * A blit engine copying with kernels on an internal queue.
+   */
+  HSA_AMD_RUNTIME_STATS_SOURCE_BLIT_KERNEL = 2,
+  /**
+   * A blit engine copying with an SDMA engine.
+   */
+  HSA_AMD_RUNTIME_STATS_SOURCE_BLIT_SDMA = 3
+} hsa_amd_runtime_stats_source_t;
+
+/**
+ * @brief Submission counters of an agent, queue or blit engine.
+ *
+ * Counters are cumulative since the source was created.
+ */
+typedef struct hsa_amd_runtime_stats_entry_s {
+  /**
+   * Source of the counters.
+   */
+  hsa_amd_runtime_stats_source_t source;
+  /**
+   * Agent owning the source.
+   */
+  hsa_agent_t agent;
+  /**
+   * Queue id for queues, blit engine index for blit engines, 0 for agents.
+   */
+  uint64_t id;
+  /**
+   * Packets written to a queue, or copies and fills submitted to a blit
+   * engine.
+   */
+  uint64_t submissions;
+  /**
+   * Bytes copied or filled by blit engines.  0 for queues.
+   */
+  uint64_t bytes;
+  /**
+   * Doorbell writes.
+   */
+  uint64_t doorbells;
+  /**
+   * Blit submissions which waited for space in a full ring.  0 for queues.
+   */
+  uint64_t ring_full_waits;
+  /**
+   * Barrier packets, or SDMA poll command pairs, inserted by blit engines to
+   * wait on dependent signals.  0 for queues.
+   */
+  uint64_t dependency_barriers;
+  /**
+   * Average time in nanoseconds from the start of a blit submission until its
+   * doorbell was written.  0 for queues.
+   */
+  uint64_t average_submit_latency_ns;
+} hsa_amd_runtime_stats_entry_t;
+
+/**
+ * @brief Reports the submission counters of a GPU agent, its queues and its
+ * blit engines.
+ *
+ * Counters are kept with relaxed per-CPU counters and are not a consistent
+ * snapshot while submissions are in flight.  Blit engines are only reported
+ * once the runtime created them.
+ *
+ * @param[in] agent GPU agent.
+ *
+ * @param[in] callback Callback invoked with the agent totals first, then
+ * once per queue and per blit engine.  If the callback returns a status other
+ * than ::HSA_STATUS_SUCCESS, the traversal stops and that status is returned.
+ *
+ * @param[in] data Application data passed to @p callback.
+ *
+ * @retval HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid or not a GPU.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p callback is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_runtime_stats_get(
+    hsa_agent_t agent,
+    hsa_status_t (*callback)(const hsa_amd_runtime_stats_entry_t* entry, void* data), void* data);
+
 /** @} */
 
 /** \addtogroup memory Memory
@@ -527,10 +527,187 @@ hsa_ven_amd_loader_iterate_executables(
 
 //===----------------------------------------------------------------------===//
 
+/**
+ * @brief Load the code objects of @p executable whose load was deferred by the
+ * "-lazy-load" loader option.
+ *
+ * @details With "-lazy-load", agent code objects (version 3 and above) only
+ * publish their symbols when loaded; their segments are allocated, relocated
+ * and, if the executable is frozen, uploaded the first time the address of one
+ * of their symbols is queried. This function performs that work up front, for
+ * example to move it off a latency sensitive path. Code objects that are
+ * already loaded are skipped.
+ *
+ * Deferred code objects still return a loaded code object handle. Querying
+ * its load base, size or delta, or iterating its segments, also loads it. A
+ * failed load is undone and not retried.
+ *
+ * @param[in] executable Executable.
+ *
+ * @param[in] agent Agent whose deferred code objects are loaded. May be NULL,
+ * in which case the deferred code objects of all agents are loaded.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_EXECUTABLE @p executable is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The HSA runtime failed to
+ * allocate the required resources.
+ */
+hsa_status_t
+hsa_ven_amd_loader_executable_load_deferred_code_objects(
+    hsa_executable_t executable,
+    const hsa_agent_t *agent);
+
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Dispatch relevant properties of a kernel symbol, gathered in one
+ * 64 byte structure so that a dispatch can be set up without querying each
+ * attribute through ::hsa_executable_symbol_get_info.
+ */
+typedef struct hsa_ven_amd_loader_kernel_dispatch_info_s {
+  /**
+   * Kernel object handle, same as ::HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT.
+   * Valid once the executable is frozen.
+   */
+  uint64_t kernel_object;
+  /**
+   * Size of the kernarg segment, in bytes.
+   */
+  uint32_t kernarg_segment_size;
+  /**
+   * Alignment of the kernarg segment, in bytes.
+   */
+  uint32_t kernarg_segment_alignment;
+  /**
+   * Statically allocated group segment size, in bytes.
+   */
+  uint32_t group_segment_size;
+  /**
+   * Statically allocated private segment size per work-item, in bytes.
+   */
+  uint32_t private_segment_size;
+  /**
+   * Wavefront size the kernel was compiled for.
+   */
+  uint32_t wavefront_size;
+  /**
+   * COMPUTE_PGM_RSRC1 value of the kernel descriptor.
+   */
+  uint32_t compute_pgm_rsrc1;
+  /**
+   * COMPUTE_PGM_RSRC2 value of the kernel descriptor.
+   */
+  uint32_t compute_pgm_rsrc2;
+  /**
+   * COMPUTE_PGM_RSRC3 value of the kernel descriptor. 0 for code object V2.
+   */
+  uint32_t compute_pgm_rsrc3;
+  /**
+   * Kernel code properties of the kernel descriptor. 0 for code object V2.
+   */
+  uint16_t kernel_code_properties;
+  /**
+   * Non-zero if the kernel uses a dynamically sized call stack.
+   */
+  uint8_t is_dynamic_callstack;
+  /**
+   * Reserved, must be 0.
+   */
+  uint8_t reserved0;
+  /**
+   * Reserved, must be 0.
+   */
+  uint32_t reserved1[5];
+} hsa_ven_amd_loader_kernel_dispatch_info_t;
+
+/**
+ * @brief Retrieve the dispatch properties of a kernel symbol.
+ *
+ * @details The returned structure is owned by the executable and remains valid
+ * and unchanged until the executable is destroyed, so callers may cache the
+ * pointer instead of querying it for every dispatch.
+ *
+ * @param[in] executable_symbol Executable symbol of kind
+ * ::HSA_SYMBOL_KIND_KERNEL.
+ *
+ * @param[out] dispatch_info Memory location where the HSA runtime stores a
+ * pointer to the dispatch properties of @p executable_symbol.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_EXECUTABLE_SYMBOL @p executable_symbol is
+ * invalid or is not a kernel.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_EXECUTABLE The executable of
+ * @p executable_symbol is not frozen, or its code object failed to load.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p dispatch_info is NULL.
+ */
+hsa_status_t
+hsa_ven_amd_loader_executable_symbol_get_dispatch_info(
+    hsa_executable_symbol_t executable_symbol,
+    const hsa_ven_amd_loader_kernel_dispatch_info_t **dispatch_info);
+
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Select the code object of a multi-target bundle to load on each of
+ * a set of agents.
+ *
+ * @details Each entry name is resolved once. An entry is eligible for an agent
+ * if its ISA is compatible with the agent's ISA, as reported by
+ * ::hsa_isa_compatible. Among eligible entries, the one explicitly enabling or
+ * disabling the most target features is selected, and the first one in
+ * @p isa_names among equally specific entries.
+ *
+ * @param[in] isa_names Array of @p num_isa_names ISA names, such as
+ * "amdgcn-amd-amdhsa--gfx90a:xnack+". Offload bundle entry IDs, such as
+ * "hipv4-amdgcn-amd-amdhsa--gfx90a:xnack+", are accepted as well. Entries that
+ * are NULL or do not name a supported ISA are never selected.
+ *
+ * @param[in] num_isa_names Number of entries in @p isa_names.
+ *
+ * @param[in] agents Array of @p num_agents agents.
+ *
+ * @param[in] num_agents Number of entries in @p agents.
+ *
+ * @param[out] selected_entries Array of @p num_agents elements where the HSA
+ * runtime stores, for each agent, the index of the selected entry of
+ * @p isa_names, or -1 if no entry is compatible with the agent.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent in @p agents is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p isa_names is NULL while
+ * @p num_isa_names is not 0, or @p agents or @p selected_entries is NULL while
+ * @p num_agents is not 0.
+ */
+hsa_status_t
+hsa_ven_amd_loader_select_bundle_entries(
+    const char *const *isa_names,
+    uint32_t num_isa_names,
+    const hsa_agent_t *agents,
+    uint32_t num_agents,
+    int32_t *selected_entries);
+
+//===----------------------------------------------------------------------===//
+
 /**
  * @brief Extension version.
  */
-#define hsa_ven_amd_loader 001003
+#define hsa_ven_amd_loader 001006
 
 /**
  * @brief Extension function table version 1.00.
@@ -660,6 +837,171 @@ typedef struct hsa_ven_amd_loader_1_03_pfn_s {
       void *data);
 } hsa_ven_amd_loader_1_03_pfn_t;
 
+/**
+ * @brief Extension function table version 1.04.
+ */
+typedef struct hsa_ven_amd_loader_1_04_pfn_s {
+  hsa_status_t (*hsa_ven_amd_loader_query_host_address)(
+    const void *device_address,
+    const void **host_address);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_segment_descriptors)(
+    hsa_ven_amd_loader_segment_descriptor_t *segment_descriptors,
+    size_t *num_segment_descriptors);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_executable)(
+    const void *device_address,
+    hsa_executable_t *executable);
+
+  hsa_status_t (*hsa_ven_amd_loader_executable_iterate_loaded_code_objects)(
+    hsa_executable_t executable,
+    hsa_status_t (*callback)(
+      hsa_executable_t executable,
+      hsa_loaded_code_object_t loaded_code_object,
+      void *data),
+    void *data);
+
+  hsa_status_t (*hsa_ven_amd_loader_loaded_code_object_get_info)(
+    hsa_loaded_code_object_t loaded_code_object,
+    hsa_ven_amd_loader_loaded_code_object_info_t attribute,
+    void *value);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size)(
+      hsa_file_t file,
+      size_t offset,
+      size_t size,
+      hsa_code_object_reader_t *code_object_reader);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_iterate_executables)(
+      hsa_status_t (*callback)(
+        hsa_executable_t executable,
+        void *data),
+      void *data);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_load_deferred_code_objects)(
+      hsa_executable_t executable,
+      const hsa_agent_t *agent);
+} hsa_ven_amd_loader_1_04_pfn_t;
+
+/**
+ * @brief Extension function table version 1.05.
+ */
+typedef struct hsa_ven_amd_loader_1_05_pfn_s {
+  hsa_status_t (*hsa_ven_amd_loader_query_host_address)(
+    const void *device_address,
+    const void **host_address);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_segment_descriptors)(
+    hsa_ven_amd_loader_segment_descriptor_t *segment_descriptors,
+    size_t *num_segment_descriptors);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_executable)(
+    const void *device_address,
+    hsa_executable_t *executable);
+
+  hsa_status_t (*hsa_ven_amd_loader_executable_iterate_loaded_code_objects)(
+    hsa_executable_t executable,
+    hsa_status_t (*callback)(
+      hsa_executable_t executable,
+      hsa_loaded_code_object_t loaded_code_object,
+      void *data),
+    void *data);
+
+  hsa_status_t (*hsa_ven_amd_loader_loaded_code_object_get_info)(
+    hsa_loaded_code_object_t loaded_code_object,
+    hsa_ven_amd_loader_loaded_code_object_info_t attribute,
+    void *value);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size)(
+      hsa_file_t file,
+      size_t offset,
+      size_t size,
+      hsa_code_object_reader_t *code_object_reader);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_iterate_executables)(
+      hsa_status_t (*callback)(
+        hsa_executable_t executable,
+        void *data),
+      void *data);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_load_deferred_code_objects)(
+      hsa_executable_t executable,
+      const hsa_agent_t *agent);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_symbol_get_dispatch_info)(
+      hsa_executable_symbol_t executable_symbol,
+      const hsa_ven_amd_loader_kernel_dispatch_info_t **dispatch_info);
+} hsa_ven_amd_loader_1_05_pfn_t;
+
+/**
+ * @brief Extension function table version 1.06.
+ */
+typedef struct hsa_ven_amd_loader_1_06_pfn_s {
+  hsa_status_t (*hsa_ven_amd_loader_query_host_address)(
+    const void *device_address,
+    const void **host_address);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_segment_descriptors)(
+    hsa_ven_amd_loader_segment_descriptor_t *segment_descriptors,
+    size_t *num_segment_descriptors);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_executable)(
+    const void *device_address,
+    hsa_executable_t *executable);
+
+  hsa_status_t (*hsa_ven_amd_loader_executable_iterate_loaded_code_objects)(
+    hsa_executable_t executable,
+    hsa_status_t (*callback)(
+      hsa_executable_t executable,
+      hsa_loaded_code_object_t loaded_code_object,
+      void *data),
+    void *data);
+
+  hsa_status_t (*hsa_ven_amd_loader_loaded_code_object_get_info)(
+    hsa_loaded_code_object_t loaded_code_object,
+    hsa_ven_amd_loader_loaded_code_object_info_t attribute,
+    void *value);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size)(
+      hsa_file_t file,
+      size_t offset,
+      size_t size,
+      hsa_code_object_reader_t *code_object_reader);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_iterate_executables)(
+      hsa_status_t (*callback)(
+        hsa_executable_t executable,
+        void *data),
+      void *data);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_load_deferred_code_objects)(
+      hsa_executable_t executable,
+      const hsa_agent_t *agent);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_symbol_get_dispatch_info)(
+      hsa_executable_symbol_t executable_symbol,
+      const hsa_ven_amd_loader_kernel_dispatch_info_t **dispatch_info);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_select_bundle_entries)(
+      const char *const *isa_names,
+      uint32_t num_isa_names,
+      const hsa_agent_t *agents,
+      uint32_t num_agents,
+      int32_t *selected_entries);
+} hsa_ven_amd_loader_1_06_pfn_t;
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
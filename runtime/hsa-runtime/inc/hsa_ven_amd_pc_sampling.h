@@ -237,6 +237,8 @@ hsa_status_t hsa_ven_amd_pcs_iterate_configuration(
  *      within @p latency period.
  * OR
  *   2. When hsa_ven_amd_pcs_flush is called.
+ * If NULL, the session delivers samples without copying: the client reads them in place with
+ * hsa_ven_amd_pcs_data_acquire and hands them back with hsa_ven_amd_pcs_data_release.
  * @param[in] client_callback_data client private data to be provided back when data_ready_callback
  * is called.
  * @param[out] pc_sampling PC sampling session handle used to reference this session when calling
@@ -292,6 +294,8 @@ hsa_status_t hsa_ven_amd_pcs_create(hsa_agent_t agent, hsa_ven_amd_pcs_method_ki
  *      within @p latency period.
  * OR
  *   2. When hsa_ven_amd_pcs_flush is called.
+ * If NULL, the session delivers samples without copying: the client reads them in place with
+ * hsa_ven_amd_pcs_data_acquire and hands them back with hsa_ven_amd_pcs_data_release.
  * @param[in] client_callback_data client private data to be provided back when data_ready_callback
  * is called.
  * @param[out] pc_sampling PC sampling session handle used to reference this session when calling
@@ -375,7 +379,63 @@ hsa_status_t hsa_ven_amd_pcs_stop(hsa_ven_amd_pcs_t pc_sampling);
  */
 hsa_status_t hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t pc_sampling);
 
+/**
+ * @brief Read-only view of the samples available in a zero-copy PC Sampling session
+ *
+ * The samples are in HSA internal buffers and may be split in two ranges when the internal buffer
+ * wraps around. Samples in @p buf1 are older than samples in @p buf2.
+ */
+typedef struct {
+  const void* buf1;
+  size_t buf1_size;
+  const void* buf2;
+  size_t buf2_size;
+  size_t lost_sample_count;
+} hsa_ven_amd_pcs_data_view_t;
+
+/**
+ * @brief  Get the samples available in a zero-copy PC Sampling session
+ *
+ * Returns a read-only view of all the samples HSA has received for a session created with a NULL
+ * data_ready_callback, without copying them. The samples remain valid and are not overwritten
+ * until they are returned with hsa_ven_amd_pcs_data_release. While samples are held, new samples
+ * that do not fit in HSA internal buffers are dropped and reported in lost_sample_count.
+ *
+ * The function does not block. Samples still in device buffers are moved to the internal buffers
+ * periodically while the session is active, or by calling hsa_ven_amd_pcs_flush.
+ *
+ * hsa_ven_amd_pcs_data_acquire and hsa_ven_amd_pcs_data_release must not be called concurrently
+ * for the same session.
+ *
+ * @param[in] pc_sampling PC sampling session handle
+ * @param[out] view samples available. Sizes are 0 if no samples are available.
+ * lost_sample_count is the number of samples dropped since the previous call.
+ *
+ * @retval ::HSA_STATUS_SUCCESS view returned successfully
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT Invalid PC sampling handle, @p view is NULL or
+ * the session was created with a data_ready_callback
+ */
+hsa_status_t hsa_ven_amd_pcs_data_acquire(hsa_ven_amd_pcs_t pc_sampling,
+                                          hsa_ven_amd_pcs_data_view_t* view);
+
+/**
+ * @brief  Return consumed samples of a zero-copy PC Sampling session
+ *
+ * Releases the oldest @p data_size bytes of the samples returned by hsa_ven_amd_pcs_data_acquire
+ * so that HSA may reuse the memory. Pointers into released samples must not be used afterwards.
+ *
+ * @param[in] pc_sampling PC sampling session handle
+ * @param[in] data_size number of bytes consumed. Must be a multiple of the sample size and at most
+ * the total size of the last acquired view.
+ *
+ * @retval ::HSA_STATUS_SUCCESS samples released successfully
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT Invalid PC sampling handle, invalid @p data_size
+ * or the session was created with a data_ready_callback
+ */
+hsa_status_t hsa_ven_amd_pcs_data_release(hsa_ven_amd_pcs_t pc_sampling, size_t data_size);
+
 #define hsa_ven_amd_pc_sampling_1_00
+#define hsa_ven_amd_pc_sampling_1_01
 
 /**
  * @brief The function pointer table for the PC Sampling v1.00 extension. Can be returned by
@@ -409,6 +469,43 @@ typedef struct hsa_ven_amd_pc_sampling_1_00_pfn_t {
 
 } hsa_ven_amd_pc_sampling_1_00_pfn_t;
 
+/**
+ * @brief The function pointer table for the PC Sampling v1.01 extension. Can be returned by
+ * ::hsa_system_get_extension_table or ::hsa_system_get_major_extension_table.
+ */
+typedef struct hsa_ven_amd_pc_sampling_1_01_pfn_t {
+  hsa_status_t (*hsa_ven_amd_pcs_iterate_configuration)(
+      hsa_agent_t agent, hsa_ven_amd_pcs_iterate_configuration_callback_t configuration_callback,
+      void* callback_data);
+
+  hsa_status_t (*hsa_ven_amd_pcs_create)(hsa_agent_t agent, hsa_ven_amd_pcs_method_kind_t method,
+                                         hsa_ven_amd_pcs_units_t units, size_t interval,
+                                         size_t latency, size_t buffer_size,
+                                         hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback,
+                                         void* client_callback_data,
+                                         hsa_ven_amd_pcs_t* pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_create_from_id)(
+      uint32_t pcs_id, hsa_agent_t agent, hsa_ven_amd_pcs_method_kind_t method,
+      hsa_ven_amd_pcs_units_t units, size_t interval, size_t latency, size_t buffer_size,
+      hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback, void* client_callback_data,
+      hsa_ven_amd_pcs_t* pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_destroy)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_start)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_stop)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_flush)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_data_acquire)(hsa_ven_amd_pcs_t pc_sampling,
+                                               hsa_ven_amd_pcs_data_view_t* view);
+
+  hsa_status_t (*hsa_ven_amd_pcs_data_release)(hsa_ven_amd_pcs_t pc_sampling, size_t data_size);
+
+} hsa_ven_amd_pc_sampling_1_01_pfn_t;
+
 #ifdef __cplusplus
 }  // end extern "C" block
 #endif /*__cplusplus*/
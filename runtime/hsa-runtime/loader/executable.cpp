@@ -107,6 +107,7 @@ public:
   const amd::options::NoArgOption* DumpAll() const { return &dump_all; }
   const amd::options::ValueOption<std::string>* DumpDir() const { return &dump_dir; }
   const amd::options::PrefixOption* Substitute() const { return &substitute; }
+  const amd::options::NoArgOption* LazyLoad() const { return &lazy_load; }
 
   bool ParseOptions(const std::string& options);
   void Reset();
@@ -126,6 +127,7 @@ private:
   amd::options::NoArgOption dump_all;
   amd::options::ValueOption<std::string> dump_dir;
   amd::options::PrefixOption substitute;
+  amd::options::NoArgOption lazy_load;
   amd::options::OptionParser option_parser;
 };
 
@@ -137,6 +139,7 @@ LoaderOptions::LoaderOptions(std::ostream& error) :
   dump_all("dump-all", "Dump all finalizer input and output (as above)"),
   dump_dir("dump-dir", "Dump directory"),
   substitute("substitute", "Substitute code object with given index or index range on loading from file"),
+  lazy_load("lazy-load", "Defer loading agent code objects until a symbol address is first queried"),
   option_parser(false, error)
 {
   option_parser.AddOption(&help);
@@ -146,6 +149,7 @@ LoaderOptions::LoaderOptions(std::ostream& error) :
   option_parser.AddOption(&dump_all);
   option_parser.AddOption(&dump_dir);
   option_parser.AddOption(&substitute);
+  option_parser.AddOption(&lazy_load);
 }
 
 bool LoaderOptions::ParseOptions(const std::string& options)
@@ -184,7 +188,9 @@ Executable* AmdHsaCodeLoader::CreateExecutable(
 {
   WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
 
-  executables.push_back(new ExecutableImpl(profile, context, executables.size(), default_float_rounding_mode));
+  ExecutableImpl *executable = new ExecutableImpl(profile, context, executables.size(), default_float_rounding_mode);
+  executable->loader_ = this;
+  executables.push_back(executable);
   return executables.back();
 }
 
@@ -196,7 +202,9 @@ Executable* AmdHsaCodeLoader::CreateExecutable(
 {
   WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
 
-  executables.push_back(new ExecutableImpl(profile, std::move(isolated_context), executables.size(), default_float_rounding_mode));
+  ExecutableImpl *executable = new ExecutableImpl(profile, std::move(isolated_context), executables.size(), default_float_rounding_mode);
+  executable->loader_ = this;
+  executables.push_back(executable);
   return executables.back();
 }
 
@@ -238,33 +246,56 @@ hsa_status_t AmdHsaCodeLoader::FreezeExecutable(Executable *executable, const ch
     return status;
   }
 
-  // Assuming runtime atomic implements C++ std::memory_order
   WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
+  AddToDebugMap(reinterpret_cast<ExecutableImpl*>(executable));
+
+  return HSA_STATUS_SUCCESS;
+}
+
+void AmdHsaCodeLoader::AddToDebugMap(ExecutableImpl *executable) {
+  std::lock_guard<std::mutex> debug_map_lock(debug_map_lock_);
+  ReaderLockGuard<ReaderWriterLock> reader_lock(executable->rw_lock_);
+
+  // Code objects loaded lazily after the executable was frozen may already be
+  // in the map.
+  std::vector<LoadedCodeObjectImpl*> pending;
+  for (auto &lco : executable->loaded_code_objects) {
+    if (!lco->in_debug_map) {
+      pending.push_back(lco);
+    }
+  }
+  if (pending.empty()) {
+    return;
+  }
+
+  // Assuming runtime atomic implements C++ std::memory_order
   atomic::Store(&_amdgpu_r_debug.r_state, r_debug::RT_ADD, std::memory_order_relaxed);
   atomic::Fence(std::memory_order_acq_rel);
   _loader_debug_state();
   atomic::Fence(std::memory_order_acq_rel);
-  for (auto &lco : reinterpret_cast<ExecutableImpl*>(executable)->loaded_code_objects) {
+  for (auto &lco : pending) {
     AddCodeObjectInfoIntoDebugMap(&(lco->r_debug_info));
+    lco->in_debug_map = true;
   }
   atomic::Store(&_amdgpu_r_debug.r_state, r_debug::RT_CONSISTENT, std::memory_order_release);
   _loader_debug_state();
-
-  return HSA_STATUS_SUCCESS;
 }
 
 void AmdHsaCodeLoader::DestroyExecutable(Executable *executable) {
   // Assuming runtime atomic implements C++ std::memory_order
   WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
+  std::unique_lock<std::mutex> debug_map_lock(debug_map_lock_);
   atomic::Store(&_amdgpu_r_debug.r_state, r_debug::RT_DELETE, std::memory_order_relaxed);
   atomic::Fence(std::memory_order_acq_rel);
   _loader_debug_state();
   atomic::Fence(std::memory_order_acq_rel);
   for (auto &lco : reinterpret_cast<ExecutableImpl*>(executable)->loaded_code_objects) {
     RemoveCodeObjectInfoFromDebugMap(&(lco->r_debug_info));
+    lco->in_debug_map = false;
   }
   atomic::Store(&_amdgpu_r_debug.r_state, r_debug::RT_CONSISTENT, std::memory_order_release);
   _loader_debug_state();
+  debug_map_lock.unlock();
 
   executables[((ExecutableImpl*)executable)->id()] = nullptr;
   delete executable;
@@ -463,14 +494,14 @@ bool SymbolImpl::GetInfo(hsa_symbol_info32_t symbol_info, void *value) {
     }
     case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT:
     case HSA_EXECUTABLE_SYMBOL_INFO_VARIABLE_ADDRESS: {
-      if (!is_loaded) {
+      if (!EnsureLoaded()) {
         return false;
       }
       *((uint64_t*)value) = address;
       break;
     }
     case HSA_EXECUTABLE_SYMBOL_INFO_AGENT: {
-      if (!is_loaded) {
+      if (!is_loaded && nullptr == deferred) {
         return false;
       }
       *((hsa_agent_t*)value) = agent;
@@ -484,6 +515,13 @@ bool SymbolImpl::GetInfo(hsa_symbol_info32_t symbol_info, void *value) {
   return true;
 }
 
+bool SymbolImpl::EnsureLoaded() {
+  if (nullptr != deferred && !deferred->loaded.load(std::memory_order_acquire)) {
+    deferred->owner->LoadDeferredCodeObject(deferred);
+  }
+  return is_loaded;
+}
+
 //===----------------------------------------------------------------------===//
 // KernelSymbol.                                                              //
 //===----------------------------------------------------------------------===//
@@ -558,6 +596,26 @@ bool KernelSymbol::GetInfo(hsa_symbol_info32_t symbol_info, void *value) {
   return true;
 }
 
+static_assert(sizeof(hsa_ven_amd_loader_kernel_dispatch_info_t) == 64,
+              "dispatch info must fill exactly one cache line");
+static_assert(offsetof(hsa_ven_amd_loader_kernel_dispatch_info_t, kernel_object) == 0,
+              "kernel object must lead the dispatch info");
+static_assert(offsetof(hsa_ven_amd_loader_kernel_dispatch_info_t, reserved1) == 44,
+              "dispatch info layout changed");
+
+hsa_status_t KernelSymbol::GetDispatchInfo(
+    const hsa_ven_amd_loader_kernel_dispatch_info_t **info) {
+  assert((reinterpret_cast<uintptr_t>(&dispatch_info) & 63) == 0);
+  // A deferred load publishes the kernel object itself if already frozen.
+  EnsureLoaded();
+  // The kernel object is only published once the executable is frozen.
+  if (0 == dispatch_info.kernel_object) {
+    return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+  }
+  *info = &dispatch_info;
+  return HSA_STATUS_SUCCESS;
+}
+
 //===----------------------------------------------------------------------===//
 // VariableSymbol.                                                            //
 //===----------------------------------------------------------------------===//
@@ -645,6 +703,10 @@ hsa_status_t LoadedCodeObjectImpl::IterateLoadedSegments(
 {
   assert(callback);
 
+  if (!EnsureLoaded()) {
+    return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
+  }
+
   for (auto &loaded_segment : loaded_segments) {
     hsa_status_t status = callback(LoadedSegment::Handle(loaded_segment), data);
     if (status != HSA_STATUS_SUCCESS) {
@@ -655,6 +717,17 @@ hsa_status_t LoadedCodeObjectImpl::IterateLoadedSegments(
   return HSA_STATUS_SUCCESS;
 }
 
+bool LoadedCodeObjectImpl::EnsureLoaded()
+{
+  if (nullptr == deferred) {
+    return true;
+  }
+  if (!deferred->loaded.load(std::memory_order_acquire)) {
+    owner->LoadDeferredCodeObject(deferred);
+  }
+  return deferred->load_status == HSA_STATUS_SUCCESS;
+}
+
 void LoadedCodeObjectImpl::Print(std::ostream& out)
 {
   out << "Code Object" << std::endl;
@@ -751,6 +824,8 @@ ExecutableImpl::ExecutableImpl(
   , default_float_rounding_mode_(default_float_rounding_mode)
   , state_(HSA_EXECUTABLE_STATE_UNFROZEN)
   , program_allocation_segment(nullptr)
+  , deferring_(nullptr)
+  , loader_(nullptr)
 {
 }
 
@@ -766,6 +841,8 @@ ExecutableImpl::ExecutableImpl(
   , default_float_rounding_mode_(default_float_rounding_mode)
   , state_(HSA_EXECUTABLE_STATE_UNFROZEN)
   , program_allocation_segment(nullptr)
+  , deferring_(nullptr)
+  , loader_(nullptr)
 {
   context_ = unique_context_.get();
 }
@@ -783,6 +860,10 @@ ExecutableImpl::~ExecutableImpl() {
   for (auto &symbol_entry : agent_symbols_) {
     delete symbol_entry.second;
   }
+
+  for (DeferredCodeObject* d : deferred_code_objects_) {
+    delete d;
+  }
 }
 
 hsa_status_t ExecutableImpl::DefineProgramExternalVariable(
@@ -901,6 +982,10 @@ Symbol* ExecutableImpl::GetSymbolInternal(
 hsa_status_t ExecutableImpl::IterateSymbols(
   iterate_symbols_f callback, void *data)
 {
+  // Callbacks commonly query symbol addresses, which cannot load deferred code
+  // objects while the reader lock is held.
+  LoadDeferredCodeObjects(nullptr);
+
   ReaderLockGuard<ReaderWriterLock> reader_lock(rw_lock_);
   assert(callback);
 
@@ -929,6 +1014,8 @@ hsa_status_t ExecutableImpl::IterateAgentSymbols(
                              hsa_executable_symbol_t symbol,
                              void *data),
     void *data) {
+  LoadDeferredCodeObjects(&agent);
+
   ReaderLockGuard<ReaderWriterLock> reader_lock(rw_lock_);
   assert(callback);
 
@@ -974,6 +1061,8 @@ hsa_status_t ExecutableImpl::IterateLoadedCodeObjects(
     void *data),
   void *data)
 {
+  LoadDeferredCodeObjects(nullptr);
+
   ReaderLockGuard<ReaderWriterLock> reader_lock(rw_lock_);
   assert(callback);
 
@@ -1029,10 +1118,17 @@ size_t ExecutableImpl::QuerySegmentDescriptors(
 }
 
 hsa_agent_t LoadedCodeObjectImpl::getAgent() const {
+  // Deferred code objects have no segments until they are loaded.
+  if (nullptr != deferred) {
+    return agent;
+  }
   assert(loaded_segments.size() == 1 && "Only supports code objects v2+");
   return loaded_segments.front()->Agent();
 }
 hsa_executable_t LoadedCodeObjectImpl::getExecutable() const {
+  if (nullptr != deferred) {
+    return Executable::Handle(owner);
+  }
   assert(loaded_segments.size() == 1 && "Only supports code objects v2+");
   return Executable::Handle(loaded_segments.front()->Owner());
 }
@@ -1295,10 +1391,25 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
 
   hsa_status_t status;
 
+  // Only v3+ agent code objects can be deferred: their kernel descriptors are
+  // described by .kd symbols, so symbols can be published without segments.
+  if (loaderOptions.LazyLoad()->is_set() && agent.handle != 0 && majorVersion >= 3) {
+    LoadedCodeObjectImpl *lco = nullptr;
+    status = DeferCodeObject(agent, majorVersion, uri, &lco);
+    code.reset();
+    if (status == HSA_STATUS_SUCCESS && nullptr != loaded_code_object) {
+      *loaded_code_object = LoadedCodeObject::Handle(lco);
+    }
+    return status;
+  }
+
+  SegmentContentKey share_key;
+  bool shareable = ShareableContentKey(agent, code.get(), majorVersion, &share_key);
+
   objects.push_back(new LoadedCodeObjectImpl(this, agent, code->ElfData(), code->ElfSize()));
   loaded_code_objects.push_back((LoadedCodeObjectImpl*)objects.back());
 
-  status = LoadSegments(agent, code.get(), majorVersion);
+  status = LoadSegments(agent, code.get(), majorVersion, shareable ? &share_key : nullptr);
   if (status != HSA_STATUS_SUCCESS) return status;
 
   for (size_t i = 0; i < code->SymbolCount(); ++i) {
@@ -1331,13 +1442,200 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t ExecutableImpl::DeferCodeObject(hsa_agent_t agent,
+                                             uint32_t majorVersion,
+                                             const std::string &uri,
+                                             LoadedCodeObjectImpl **loaded_code_object) {
+  DeferredCodeObject *deferred = new DeferredCodeObject(
+      this, agent, code->ElfData(), code->ElfSize(), majorVersion, uri);
+  deferred_code_objects_.push_back(deferred);
+
+  // The loaded code object exists from the start so the caller gets a handle
+  // it can query, querying its segments loads it.
+  LoadedCodeObjectImpl *lco = new LoadedCodeObjectImpl(
+      this, agent, deferred->elf.data(), deferred->elf.size());
+  lco->deferred = deferred;
+  lco->r_debug_info.l_name = strdup(uri.c_str());
+  objects.push_back(lco);
+  deferred->loaded_code_object = lco;
+  *loaded_code_object = lco;
+
+  // Publish the symbols now so lookups and iteration behave as if the code
+  // object was loaded; addresses are resolved by LoadDeferredCodeObject.
+  deferring_ = deferred;
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  for (size_t i = 0; i < code->SymbolCount(); ++i) {
+    if (code->GetSymbol(i)->elfSym()->type() != STT_AMDGPU_HSA_KERNEL &&
+        code->GetSymbol(i)->elfSym()->binding() == STB_LOCAL)
+      continue;
+
+    status = LoadSymbol(agent, code->GetSymbol(i), majorVersion);
+    if (status != HSA_STATUS_SUCCESS) { break; }
+  }
+  deferring_ = nullptr;
+  return status;
+}
+
+hsa_status_t ExecutableImpl::LoadDeferredCodeObject(DeferredCodeObject *deferred) {
+  std::lock_guard<std::mutex> deferred_lock(deferred->lock);
+  if (deferred->loaded.load(std::memory_order_relaxed)) {
+    return deferred->load_status;
+  }
+
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  bool frozen = false;
+  {
+    WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
+    hsa_agent_t agent = deferred->agent;
+    LoadedCodeObjectImpl *lco = deferred->loaded_code_object;
+    std::vector<SymbolImpl*> resolved;
+
+    std::unique_ptr<code::AmdHsaCode> c(new code::AmdHsaCode());
+    if (!c->InitAsBuffer(deferred->elf.data(), deferred->elf.size())) {
+      status = HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
+    }
+
+    if (status == HSA_STATUS_SUCCESS) {
+      SegmentContentKey share_key;
+      bool shareable = ShareableContentKey(agent, c.get(), deferred->major_version, &share_key);
+
+      // Segment loading and relocation work on the last loaded code object.
+      loaded_code_objects.push_back(lco);
+      status = LoadSegments(agent, c.get(), deferred->major_version,
+                            shareable ? &share_key : nullptr);
+    }
+
+    if (status == HSA_STATUS_SUCCESS) {
+      for (size_t i = 0; i < c->SymbolCount(); ++i) {
+        code::Symbol *sym = c->GetSymbol(i);
+        auto agent_symbol = agent_symbols_.find(std::make_pair(sym->Name(), agent));
+        if (agent_symbol == agent_symbols_.end() || agent_symbol->second->deferred != deferred) {
+          continue;
+        }
+        agent_symbol->second->address = SymbolAddress(agent, sym);
+        agent_symbol->second->is_loaded = true;
+        resolved.push_back(agent_symbol->second);
+      }
+
+      // External symbols must be defined by eagerly loaded code objects or
+      // DefineAgentExternalVariable, deferred definitions resolve to 0.
+      status = ApplyRelocations(agent, c.get());
+    }
+
+    if (status == HSA_STATUS_SUCCESS) {
+      lco->r_debug_info.l_addr = lco->getDelta();
+
+      // Freeze already uploaded the rest of the executable, upload this one now.
+      if (HSA_EXECUTABLE_STATE_FROZEN == state_) {
+        status = FreezeSegments({lco});
+        if (status == HSA_STATUS_SUCCESS) {
+          for (SymbolImpl *symbol : resolved) {
+            PublishDispatchInfo(symbol);
+          }
+          frozen = true;
+        }
+      }
+    }
+
+    if (status != HSA_STATUS_SUCCESS) {
+      // Undo the partial load.  The handle stays valid and reports no segments.
+      for (SymbolImpl *symbol : resolved) {
+        symbol->address = 0;
+        symbol->is_loaded = false;
+      }
+      for (Segment *segment : lco->LoadedSegments()) {
+        objects.erase(std::remove(objects.begin(), objects.end(), segment), objects.end());
+        segment->Destroy();
+        delete segment;
+      }
+      lco->LoadedSegments().clear();
+      loaded_code_objects.erase(
+          std::remove(loaded_code_objects.begin(), loaded_code_objects.end(), lco),
+          loaded_code_objects.end());
+    }
+  }
+
+  // The executable lock must be released first, AddToDebugMap acquires it
+  // after the debug map lock.
+  if (frozen && nullptr != loader_) {
+    loader_->AddToDebugMap(this);
+  }
+
+  // A failed load is not retried, its symbols stay without an address.
+  deferred->load_status = status;
+  deferred->loaded.store(true, std::memory_order_release);
+  return status;
+}
+
+hsa_status_t ExecutableImpl::LoadDeferredCodeObjects(const hsa_agent_t *agent) {
+  std::vector<DeferredCodeObject*> pending;
+  {
+    ReaderLockGuard<ReaderWriterLock> reader_lock(rw_lock_);
+    for (DeferredCodeObject *d : deferred_code_objects_) {
+      if (nullptr != agent && d->agent.handle != agent->handle) {
+        continue;
+      }
+      if (!d->loaded.load(std::memory_order_acquire)) {
+        pending.push_back(d);
+      }
+    }
+  }
+
+  for (DeferredCodeObject *d : pending) {
+    hsa_status_t status = LoadDeferredCodeObject(d);
+    if (status != HSA_STATUS_SUCCESS) { return status; }
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+namespace {
+
+// Two independent 64-bit hashes of @p data, selecting code objects whose
+// segments may be shared.  Candidates are compared byte by byte before reuse.
+void ContentHash(const void *data, size_t size, uint64_t hash[2]) {
+  const uint8_t *bytes = static_cast<const uint8_t*>(data);
+  uint64_t h0 = 0xcbf29ce484222325ULL ^ size;
+  uint64_t h1 = 0x9e3779b97f4a7c15ULL ^ size;
+  auto mix = [&](uint64_t w) {
+    w *= 0x87c37b91114253d5ULL;
+    w = (w << 31) | (w >> 33);
+    h0 = ((h0 ^ w) * 0x4cf5ad432745937fULL) + 0x52dce729;
+    h1 = (h1 ^ w) * 0xff51afd7ed558ccdULL;
+    h1 ^= h1 >> 29;
+  };
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t w;
+    memcpy(&w, bytes + i, sizeof(w));
+    mix(w);
+  }
+  if (i < size) {
+    uint64_t w = 0;
+    memcpy(&w, bytes + i, size - i);
+    mix(w);
+  }
+  auto fmix = [](uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  };
+  hash[0] = fmix(h0);
+  hash[1] = fmix(h1 ^ h0);
+}
+
+}
+
 hsa_status_t ExecutableImpl::LoadSegments(hsa_agent_t agent,
                                           const code::AmdHsaCode *c,
-                                          uint32_t majorVersion) {
+                                          uint32_t majorVersion,
+                                          const SegmentContentKey *share_key) {
   if (majorVersion < 2)
     return LoadSegmentsV1(agent, c);
   else
-    return LoadSegmentsV2(agent, c);
+    return LoadSegmentsV2(agent, c, share_key);
 }
 
 hsa_status_t ExecutableImpl::LoadSegmentsV1(hsa_agent_t agent,
@@ -1352,7 +1650,8 @@ hsa_status_t ExecutableImpl::LoadSegmentsV1(hsa_agent_t agent,
 }
 
 hsa_status_t ExecutableImpl::LoadSegmentsV2(hsa_agent_t agent,
-                                            const code::AmdHsaCode *c) {
+                                            const code::AmdHsaCode *c,
+                                            const SegmentContentKey *share_key) {
   assert(c->Machine() == ELF::EM_AMDGPU && "Program code objects are not supported");
 
   if (!c->DataSegmentCount()) return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
@@ -1361,6 +1660,23 @@ hsa_status_t ExecutableImpl::LoadSegmentsV2(hsa_agent_t agent,
   uint64_t size = c->DataSegment(c->DataSegmentCount() - 1)->vaddr() +
                   c->DataSegment(c->DataSegmentCount() - 1)->memSize();
 
+  if (share_key) {
+    void *ptr = context_->SegmentAcquireShared(AMDGPU_HSA_SEGMENT_CODE_AGENT, agent, size, *share_key);
+    if (ptr) {
+      Segment *load_segment = new Segment(this, agent, AMDGPU_HSA_SEGMENT_CODE_AGENT,
+          ptr, size, vaddr, c->DataSegment(0)->offset());
+      load_segment->MarkShared();
+      if (SharedSegmentMatches(c, load_segment, *share_key)) {
+        objects.push_back(load_segment);
+        loaded_code_objects.back()->LoadedSegments().push_back(load_segment);
+        return HSA_STATUS_SUCCESS;
+      }
+      // Hash collision, fall back to a private copy.
+      load_segment->Destroy();
+      delete load_segment;
+    }
+  }
+
   void *ptr = context_->SegmentAlloc(AMDGPU_HSA_SEGMENT_CODE_AGENT, agent, size,
       AMD_ISA_ALIGN_BYTES, true);
   if (!ptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
@@ -1368,6 +1684,7 @@ hsa_status_t ExecutableImpl::LoadSegmentsV2(hsa_agent_t agent,
   Segment *load_segment = new Segment(this, agent, AMDGPU_HSA_SEGMENT_CODE_AGENT,
       ptr, size, vaddr, c->DataSegment(0)->offset());
   if (!load_segment) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  if (share_key) load_segment->SetShareKey(*share_key);
 
   hsa_status_t status = HSA_STATUS_SUCCESS;
   for (size_t i = 0; i < c->DataSegmentCount(); ++i) {
@@ -1381,6 +1698,93 @@ hsa_status_t ExecutableImpl::LoadSegmentsV2(hsa_agent_t agent,
   return HSA_STATUS_SUCCESS;
 }
 
+bool ExecutableImpl::ShareableContentKey(hsa_agent_t agent,
+                                         code::AmdHsaCode *c,
+                                         uint32_t majorVersion,
+                                         SegmentContentKey *key) {
+  // The segment may only be shared if nothing in it depends on the executable
+  // it is loaded into: v2 kernel code is patched with per executable debug
+  // info, writable data is per executable and external symbols may be defined
+  // differently by each executable.
+  if (agent.handle == 0 || majorVersion < 3 || !context_->SegmentSharingSupported(agent)) {
+    return false;
+  }
+  for (size_t i = 0; i < c->DataSectionCount(); ++i) {
+    code::Section *sec = c->DataSection(i);
+    if (!sec || !(sec->flags() & SHF_WRITE)) continue;
+    // Written by relocations only.
+    if (sec->Name() == ".got" || sec->Name() == ".data.rel.ro") continue;
+    return false;
+  }
+  for (size_t i = 0; i < c->SymbolCount(); ++i) {
+    if (c->GetSymbol(i)->IsDeclaration()) return false;
+  }
+
+  // Relocations applied into a shared segment resolve to the same values as
+  // long as the segment is not moved, which only holds within a process.
+  bool position_independent = true;
+  for (size_t i = 0; i < c->RelocationSectionCount(); ++i) {
+    code::RelocationSection *sec = c->GetRelocationSection(i);
+    // Static relocations are not applied for v2 and up.
+    if (sec->targetSection()) continue;
+    for (size_t j = 0; j < sec->relocationCount(); ++j) {
+      amd::elf::Symbol *sym = sec->relocation(j)->symbol();
+      if (sym->type() == STT_NOTYPE && !sym->name().empty()) return false;
+      position_independent = false;
+    }
+  }
+
+  ContentHash(c->ElfData(), c->ElfSize(), key->hash);
+  key->image_size = c->ElfSize();
+  key->position_independent = position_independent;
+  return true;
+}
+
+bool ExecutableImpl::SharedSegmentMatches(const code::AmdHsaCode *c,
+                                          loader::Segment *load_segment,
+                                          const SegmentContentKey &key) {
+  // Bytes written by dynamic relocations hold load address dependent values,
+  // every other byte of the shared segment must equal the image.
+  std::vector<std::pair<uint64_t, uint64_t>> relocated;
+  if (!key.position_independent) {
+    for (size_t i = 0; i < c->RelocationSectionCount(); ++i) {
+      code::RelocationSection *sec = c->GetRelocationSection(i);
+      if (sec->targetSection()) continue;
+      for (size_t j = 0; j < sec->relocationCount(); ++j) {
+        code::Relocation *rel = sec->relocation(j);
+        uint64_t size = (rel->type() == ELF::R_AMDGPU_ABS64 ||
+                         rel->type() == ELF::R_AMDGPU_RELATIVE64) ? 8 : 4;
+        relocated.push_back(std::make_pair(rel->offset(), rel->offset() + size));
+      }
+    }
+    std::sort(relocated.begin(), relocated.end());
+  }
+
+  for (size_t i = 0; i < c->DataSegmentCount(); ++i) {
+    const code::Segment *s = c->DataSegment(i);
+    if (s->imageSize() == 0) continue;
+    const char *host = static_cast<const char *>(context_->SegmentHostAddress(
+        load_segment->ElfSegment(), load_segment->Agent(), load_segment->Ptr(),
+        load_segment->Offset(s->vaddr())));
+    if (!host) return false;
+    const char *image = reinterpret_cast<const char *>(s->data());
+
+    uint64_t begin = s->vaddr();
+    uint64_t end = begin + s->imageSize();
+    uint64_t cur = begin;
+    for (const auto &r : relocated) {
+      if (r.second <= cur) continue;
+      if (r.first >= end) break;
+      if (r.first > cur && memcmp(host + (cur - begin), image + (cur - begin), r.first - cur) != 0)
+        return false;
+      cur = std::min(r.second, end);
+    }
+    if (cur < end && memcmp(host + (cur - begin), image + (cur - begin), end - cur) != 0)
+      return false;
+  }
+  return true;
+}
+
 hsa_status_t ExecutableImpl::LoadSegmentV1(hsa_agent_t agent,
                                            const code::Segment *s) {
   assert(s->type() < PT_LOOS + AMDGPU_HSA_SEGMENT_LAST);
@@ -1459,7 +1863,7 @@ hsa_status_t ExecutableImpl::LoadDefinitionSymbol(hsa_agent_t agent,
     }
   }
 
-  uint64_t address = SymbolAddress(agent, sym);
+  uint64_t address = deferring_ ? 0 : SymbolAddress(agent, sym);
   SymbolImpl *symbol = nullptr;
   if (string_ends_with(sym->GetSymbolName(), ".kd")) {
     // V3.
@@ -1489,6 +1893,10 @@ hsa_status_t ExecutableImpl::LoadDefinitionSymbol(hsa_agent_t agent,
                                     64,
                                     uses_wave32 ? 32 : 64,
                                     address);
+    kernel_symbol->dispatch_info.compute_pgm_rsrc1 = kd.compute_pgm_rsrc1;
+    kernel_symbol->dispatch_info.compute_pgm_rsrc2 = kd.compute_pgm_rsrc2;
+    kernel_symbol->dispatch_info.compute_pgm_rsrc3 = kd.compute_pgm_rsrc3;
+    kernel_symbol->dispatch_info.kernel_code_properties = kd.kernel_code_properties;
     symbol = kernel_symbol;
   } else if (sym->IsVariableSymbol()) {
     symbol = new VariableSymbol(true,
@@ -1540,6 +1948,8 @@ hsa_status_t ExecutableImpl::LoadDefinitionSymbol(hsa_agent_t agent,
                                       256,
                                       uses_wave32 ? 32 : 64,
                                       address);
+      kernel_symbol->dispatch_info.compute_pgm_rsrc1 = akc.compute_pgm_rsrc1;
+      kernel_symbol->dispatch_info.compute_pgm_rsrc2 = akc.compute_pgm_rsrc2;
       kernel_symbol->debug_info.elf_raw = code->ElfData();
       kernel_symbol->debug_info.elf_size = code->ElfSize();
       kernel_symbol->debug_info.kernel_name = kernel_symbol->full_name.c_str();
@@ -1557,6 +1967,10 @@ hsa_status_t ExecutableImpl::LoadDefinitionSymbol(hsa_agent_t agent,
   }
 
   assert(symbol);
+  if (deferring_) {
+    symbol->is_loaded = false;
+    symbol->deferred = deferring_;
+  }
   if (isAgent) {
     symbol->agent = agent;
     agent_symbols_.insert(std::make_pair(std::make_pair(sym->Name(), agent), symbol));
@@ -1627,6 +2041,11 @@ hsa_status_t ExecutableImpl::ApplyRelocations(hsa_agent_t agent, amd::hsa::code:
 {
   hsa_status_t status = HSA_STATUS_SUCCESS;
 
+  // Shared segments were relocated by the load that first published them.
+  for (auto &seg : loaded_code_objects.back()->LoadedSegments()) {
+    if (seg->IsShared()) { return HSA_STATUS_SUCCESS; }
+  }
+
   uint32_t majorVersion, minorVersion;
   if (!c->GetCodeObjectVersion(&majorVersion, &minorVersion)) {
     return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
@@ -1939,16 +2358,58 @@ hsa_status_t ExecutableImpl::Freeze(const char *options) {
     return HSA_STATUS_ERROR_FROZEN_EXECUTABLE;
   }
 
-  for (auto &lco : loaded_code_objects) {
-    for (auto &ls : lco->LoadedSegments()) {
-      ls->Freeze();
-    }
+  // Nothing is published if the upload fails, a later Freeze retries it.
+  hsa_status_t status = FreezeSegments(loaded_code_objects);
+  if (status != HSA_STATUS_SUCCESS) {
+    return status;
+  }
+
+  for (auto &symbol_entry : program_symbols_) {
+    PublishDispatchInfo(symbol_entry.second);
+  }
+  for (auto &symbol_entry : agent_symbols_) {
+    PublishDispatchInfo(symbol_entry.second);
   }
 
   state_ = HSA_EXECUTABLE_STATE_FROZEN;
   return HSA_STATUS_SUCCESS;
 }
 
+void ExecutableImpl::PublishDispatchInfo(SymbolImpl *symbol) {
+  if (!symbol->IsKernel() || !symbol->is_loaded) {
+    return;
+  }
+  static_cast<KernelSymbol*>(symbol)->dispatch_info.kernel_object = symbol->address;
+}
+
+hsa_status_t ExecutableImpl::FreezeSegments(const std::vector<LoadedCodeObjectImpl*> &lcos) {
+  // Hand every pending segment to the context at once so uploads and cache
+  // invalidations can be batched per agent.
+  std::vector<SegmentFreezeInfo> pending_info;
+  std::vector<Segment*> pending;
+  for (auto &lco : lcos) {
+    for (auto &ls : lco->LoadedSegments()) {
+      if (ls->IsFrozen()) continue;
+      pending_info.push_back({ls->ElfSegment(), ls->Agent(), ls->Ptr(), ls->Size()});
+      pending.push_back(ls);
+    }
+  }
+  if (pending.empty()) {
+    return HSA_STATUS_SUCCESS;
+  }
+  if (!context_->SegmentsFreeze(pending_info)) {
+    logger_ << "LoaderError: failed to upload code object segments\n";
+    return HSA_STATUS_ERROR;
+  }
+  for (auto &ls : pending) {
+    ls->MarkFrozen();
+    if (ls->ShareKey()) {
+      context_->SegmentShare(ls->ElfSegment(), ls->Agent(), ls->Ptr(), ls->Size(), *ls->ShareKey());
+    }
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
 void ExecutableImpl::Print(std::ostream& out)
 {
   out << "AMD Executable" << std::endl;
@@ -44,12 +44,16 @@
 #define HSA_RUNTIME_CORE_LOADER_EXECUTABLE_HPP_
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <libelf.h>
 #include <link.h>
 #include <list>
+#include <mutex>
+#include <new>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -59,6 +63,7 @@
 #include "inc/hsa_ext_image.h"
 #include "core/inc/amd_hsa_loader.hpp"
 #include "core/inc/amd_hsa_code.hpp"
+#include "core/util/utils.h"
 #include "inc/amd_hsa_kernel_code.h"
 #include "amd_hsa_locks.hpp"
 
@@ -72,6 +77,8 @@ class SymbolImpl;
 class KernelSymbol;
 class VariableSymbol;
 class ExecutableImpl;
+class AmdHsaCodeLoader;
+struct DeferredCodeObject;
 
 //===----------------------------------------------------------------------===//
 // SymbolImpl.                                                                //
@@ -98,11 +105,18 @@ public:
   bool is_definition;
   uint64_t address;
   hsa_agent_t agent;
+  /// @brief Code object whose segments back this symbol when its load was
+  /// deferred, nullptr otherwise.
+  DeferredCodeObject *deferred;
 
   hsa_agent_t GetAgent() override {
     return agent;
   }
 
+  /// @brief Loads the deferred code object backing this symbol, if any.
+  /// @returns true if the symbol has a valid address.
+  bool EnsureLoaded();
+
 protected:
   SymbolImpl(const bool &_is_loaded,
              const hsa_symbol_kind_t &_kind,
@@ -117,7 +131,8 @@ protected:
     , symbol_name(_symbol_name)
     , linkage(_linkage)
     , is_definition(_is_definition)
-    , address(_address) {}
+    , address(_address)
+    , deferred(nullptr) {}
 
   virtual bool GetInfo(hsa_symbol_info32_t symbol_info, void* value) override;
 
@@ -161,12 +176,35 @@ public:
     , is_dynamic_callstack(_is_dynamic_callstack)
     , size(_size)
     , alignment(_alignment)
-    , wavefront_size(_wavefront_size) {}
+    , wavefront_size(_wavefront_size) {
+    memset(&dispatch_info, 0, sizeof(dispatch_info));
+    dispatch_info.kernarg_segment_size = _kernarg_segment_size;
+    dispatch_info.kernarg_segment_alignment = _kernarg_segment_alignment;
+    dispatch_info.group_segment_size = _group_segment_size;
+    dispatch_info.private_segment_size = _private_segment_size;
+    dispatch_info.wavefront_size = _wavefront_size;
+    dispatch_info.is_dynamic_callstack = _is_dynamic_callstack ? 1 : 0;
+  }
 
   ~KernelSymbol() {}
 
   bool GetInfo(hsa_symbol_info32_t symbol_info, void *value);
 
+  hsa_status_t GetDispatchInfo(
+      const hsa_ven_amd_loader_kernel_dispatch_info_t **info) override;
+
+  void* operator new(size_t size) {
+    void* ptr = _aligned_malloc(size, alignof(KernelSymbol));
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+  }
+
+  void* operator new(size_t size, void* ptr) { return ptr; }
+
+  void operator delete(void* ptr) { _aligned_free(ptr); }
+
+  void operator delete(void*, void*) {}
+
   std::string full_name;
   uint32_t kernarg_segment_size;
   uint32_t kernarg_segment_alignment;
@@ -177,6 +215,10 @@ public:
   uint32_t alignment;
   uint32_t wavefront_size;
   amd_runtime_loader_debug_info_t debug_info;
+  /// @brief Filled from the kernel descriptor when the symbol is loaded, the
+  /// kernel object is published when the executable is frozen. Kept in its
+  /// own cache line so a dispatch touches a single line.
+  alignas(64) hsa_ven_amd_loader_kernel_dispatch_info_t dispatch_info;
 
 private:
   KernelSymbol(const KernelSymbol &ks);
@@ -300,7 +342,8 @@ private:
 
 public:
   LoadedCodeObjectImpl(ExecutableImpl *owner_, hsa_agent_t agent_, const void *elf_data_, size_t elf_size_)
-    : ExecutableObject(owner_, agent_), elf_data(elf_data_), elf_size(elf_size_) {
+    : ExecutableObject(owner_, agent_), elf_data(elf_data_), elf_size(elf_size_), in_debug_map(false),
+      deferred(nullptr) {
       memset(&r_debug_info, 0, sizeof(r_debug_info));
     }
 
@@ -316,9 +359,16 @@ public:
       void *data),
     void *data) override;
 
+  bool EnsureLoaded() override;
+
   void Print(std::ostream& out) override;
 
-  void Destroy() override {}
+  // Deferred code objects get a name before they are loaded, so it may never
+  // reach the debug map, which otherwise frees it.
+  void Destroy() override {
+    free(r_debug_info.l_name);
+    r_debug_info.l_name = nullptr;
+  }
 
   hsa_agent_t getAgent() const override;
   hsa_executable_t getExecutable() const override;
@@ -331,6 +381,40 @@ public:
   std::string getUri() const override;
 
   link_map r_debug_info;
+  bool in_debug_map;
+  /// @brief Pending load backing this code object, nullptr if it was loaded
+  /// eagerly.  It only joins the executable's loaded code objects once its
+  /// segments are loaded.
+  DeferredCodeObject *deferred;
+};
+
+/// @brief Agent code object whose segments are not allocated until one of its
+/// symbol addresses is first queried (see the lazy-load loader option).
+struct DeferredCodeObject {
+  DeferredCodeObject(ExecutableImpl *owner_, hsa_agent_t agent_,
+                     const void *elf_data, size_t elf_size,
+                     uint32_t major_version_, const std::string &uri_)
+    : owner(owner_), agent(agent_),
+      elf(static_cast<const char*>(elf_data), static_cast<const char*>(elf_data) + elf_size),
+      major_version(major_version_), uri(uri_), loaded_code_object(nullptr),
+      load_status(HSA_STATUS_SUCCESS), loaded(false) { }
+
+  ExecutableImpl *owner;
+  hsa_agent_t agent;
+  /// Private copy, the caller's code object may be released after loading.
+  std::vector<char> elf;
+  uint32_t major_version;
+  std::string uri;
+  /// Handle given out at load time, owned by the executable's objects.
+  LoadedCodeObjectImpl *loaded_code_object;
+
+  std::mutex lock;
+  hsa_status_t load_status;
+  std::atomic<bool> loaded;
+
+private:
+  DeferredCodeObject(const DeferredCodeObject&);
+  DeferredCodeObject& operator=(const DeferredCodeObject&);
 };
 
 class Segment : public LoadedSegment, public ExecutableObject {
@@ -341,11 +425,15 @@ private:
   uint64_t vaddr;
   bool frozen;
   size_t storage_offset;
+  bool shared;
+  bool shareable;
+  SegmentContentKey share_key;
 
 public:
   Segment(ExecutableImpl *owner_, hsa_agent_t agent_, amdgpu_hsa_elf_segment_t segment_, void* ptr_, size_t size_, uint64_t vaddr_, size_t storage_offset_)
     : ExecutableObject(owner_, agent_), segment(segment_),
-      ptr(ptr_), size(size_), vaddr(vaddr_), frozen(false), storage_offset(storage_offset_) { }
+      ptr(ptr_), size(size_), vaddr(vaddr_), frozen(false), storage_offset(storage_offset_),
+      shared(false), shareable(false) { }
 
   amdgpu_hsa_elf_segment_t ElfSegment() const { return segment; }
   void* Ptr() const { return ptr; }
@@ -360,6 +448,18 @@ public:
   void* Address(uint64_t addr); // Address in segment. Used for relocations and valid on agent.
 
   bool Freeze();
+  bool IsFrozen() const { return frozen; }
+  void MarkFrozen() { frozen = true; }
+
+  /// Content is already loaded, relocated and frozen by another load of the
+  /// same code object.
+  bool IsShared() const { return shared; }
+  void MarkShared() { shared = true; frozen = true; }
+
+  /// Key under which the segment is offered for sharing once frozen, nullptr
+  /// if the segment is private.
+  const SegmentContentKey* ShareKey() const { return shareable ? &share_key : nullptr; }
+  void SetShareKey(const SegmentContentKey &key) { share_key = key; shareable = true; }
 
   bool IsAddressInSegment(uint64_t addr);
   void Copy(uint64_t addr, const void* src, size_t size);
@@ -515,6 +615,9 @@ public:
   void Print(std::ostream& out) override;
   bool PrintToFile(const std::string& filename) override;
 
+  hsa_status_t LoadDeferredCodeObjects(const hsa_agent_t *agent) override;
+  hsa_status_t LoadDeferredCodeObject(DeferredCodeObject *deferred);
+
   Context* context() { return context_; }
   size_t id() { return id_; }
 
@@ -528,14 +631,26 @@ private:
     const char *symbol_name,
     const hsa_agent_t *agent);
 
+  bool ShareableContentKey(hsa_agent_t agent, amd::hsa::code::AmdHsaCode *c,
+                           uint32_t majorVersion, SegmentContentKey *key);
+  bool SharedSegmentMatches(const code::AmdHsaCode *c, loader::Segment *load_segment,
+                            const SegmentContentKey &key);
+
   hsa_status_t LoadSegments(hsa_agent_t agent, const code::AmdHsaCode *c,
-                            uint32_t majorVersion);
+                            uint32_t majorVersion,
+                            const SegmentContentKey *share_key = nullptr);
   hsa_status_t LoadSegmentsV1(hsa_agent_t agent, const code::AmdHsaCode *c);
-  hsa_status_t LoadSegmentsV2(hsa_agent_t agent, const code::AmdHsaCode *c);
+  hsa_status_t LoadSegmentsV2(hsa_agent_t agent, const code::AmdHsaCode *c,
+                              const SegmentContentKey *share_key);
   hsa_status_t LoadSegmentV1(hsa_agent_t agent, const code::Segment *s);
   hsa_status_t LoadSegmentV2(const code::Segment *data_segment,
                              loader::Segment *load_segment);
 
+  hsa_status_t DeferCodeObject(hsa_agent_t agent, uint32_t majorVersion, const std::string &uri,
+                               LoadedCodeObjectImpl **loaded_code_object);
+  hsa_status_t FreezeSegments(const std::vector<LoadedCodeObjectImpl*> &lcos);
+  void PublishDispatchInfo(SymbolImpl *symbol);
+
   hsa_status_t LoadSymbol(hsa_agent_t agent, amd::hsa::code::Symbol* sym, uint32_t majorVersion);
   hsa_status_t LoadDefinitionSymbol(hsa_agent_t agent, amd::hsa::code::Symbol* sym, uint32_t majorVersion);
   hsa_status_t LoadDeclarationSymbol(hsa_agent_t agent, amd::hsa::code::Symbol* sym, uint32_t majorVersion);
@@ -566,6 +681,10 @@ private:
   std::vector<ExecutableObject*> objects;
   Segment *program_allocation_segment;
   std::vector<LoadedCodeObjectImpl*> loaded_code_objects;
+  std::vector<DeferredCodeObject*> deferred_code_objects_;
+  /// Set while publishing the symbols of a deferred code object.
+  DeferredCodeObject *deferring_;
+  AmdHsaCodeLoader *loader_;
 };
 
 class AmdHsaCodeLoader : public Loader {
@@ -573,6 +692,11 @@ private:
   Context* context;
   std::vector<Executable*> executables;
   amd::hsa::common::ReaderWriterLock rw_lock_;
+  /// Serializes debug map updates. Unlike rw_lock_ it may be taken from within
+  /// IterateExecutables callbacks, which can trigger deferred code object loads.
+  std::mutex debug_map_lock_;
+
+  void AddToDebugMap(ExecutableImpl *executable);
 
 public:
   AmdHsaCodeLoader(Context* context_)
@@ -612,6 +736,8 @@ public:
 
   void EnableReadOnlyMode();
   void DisableReadOnlyMode();
+
+  friend class ExecutableImpl;
 };
 
 } // namespace loader
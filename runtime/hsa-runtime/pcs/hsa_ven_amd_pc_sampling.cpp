@@ -152,6 +152,19 @@ hsa_status_t hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t handle) {
   CATCH;
 }
 
+hsa_status_t hsa_ven_amd_pcs_data_acquire(hsa_ven_amd_pcs_t handle,
+                                          hsa_ven_amd_pcs_data_view_t* view) {
+  TRY;
+  return PcsRuntime::instance()->PcSamplingDataAcquire(handle, view);
+  CATCH;
+}
+
+hsa_status_t hsa_ven_amd_pcs_data_release(hsa_ven_amd_pcs_t handle, size_t data_size) {
+  TRY;
+  return PcsRuntime::instance()->PcSamplingDataRelease(handle, data_size);
+  CATCH;
+}
+
 void LoadPcSampling(core::PcSamplingExtTableInternal* pcs_api) {
   pcs_api->hsa_ven_amd_pcs_iterate_configuration_fn = hsa_ven_amd_pcs_iterate_configuration;
   pcs_api->hsa_ven_amd_pcs_create_fn = hsa_ven_amd_pcs_create;
@@ -160,6 +173,8 @@ void LoadPcSampling(core::PcSamplingExtTableInternal* pcs_api) {
   pcs_api->hsa_ven_amd_pcs_start_fn = hsa_ven_amd_pcs_start;
   pcs_api->hsa_ven_amd_pcs_stop_fn = hsa_ven_amd_pcs_stop;
   pcs_api->hsa_ven_amd_pcs_flush_fn = hsa_ven_amd_pcs_flush;
+  pcs_api->hsa_ven_amd_pcs_data_acquire_fn = hsa_ven_amd_pcs_data_acquire;
+  pcs_api->hsa_ven_amd_pcs_data_release_fn = hsa_ven_amd_pcs_data_release;
 }
 
 }  //  namespace pcs
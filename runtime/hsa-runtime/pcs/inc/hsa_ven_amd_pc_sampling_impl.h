@@ -79,6 +79,11 @@ hsa_status_t hsa_ven_amd_pcs_stop(hsa_ven_amd_pcs_t pc_sampling);
 
 hsa_status_t hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t pc_sampling);
 
+hsa_status_t hsa_ven_amd_pcs_data_acquire(hsa_ven_amd_pcs_t pc_sampling,
+                                          hsa_ven_amd_pcs_data_view_t* view);
+
+hsa_status_t hsa_ven_amd_pcs_data_release(hsa_ven_amd_pcs_t pc_sampling, size_t data_size);
+
 // Update Api table with func pointers that implement functionality
 void LoadPcSampling(core::PcSamplingExtTableInternal* pcs_api);
 
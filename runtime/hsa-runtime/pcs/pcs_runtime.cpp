@@ -106,7 +106,7 @@ PcsRuntime::PcSamplingSession::PcSamplingSession(
     core::Agent* _agent, hsa_ven_amd_pcs_method_kind_t method, hsa_ven_amd_pcs_units_t units,
     size_t interval, size_t latency, size_t buffer_size,
     hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback, void* client_callback_data)
-    : agent(_agent), thunkId_(0), active_(false), valid_(true), sample_size_(0) {
+    : agent(_agent), thunkId_(0), active_(false), readers_(0), valid_(true), sample_size_(0) {
   switch (method) {
     case HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1:
       sample_size_ = sizeof(perf_sample_hosttrap_v1_t);
@@ -184,48 +184,12 @@ hsa_status_t PcsRuntime::PcSamplingSession::DataCopyCallback(uint8_t* buffer,
 hsa_status_t PcsRuntime::PcSamplingSession::HandleSampleData(uint8_t* buf1, size_t buf1_sz,
                                                              uint8_t* buf2, size_t buf2_sz,
                                                              size_t lost_sample_count) {
+  // Timestamps were translated when the samples were moved to the host buffer.
   data_rdy.buf1 = buf1;
   data_rdy.buf1_sz = buf1_sz;
   data_rdy.buf2 = buf2;
   data_rdy.buf2_sz = buf2_sz;
 
-  AMD::GpuAgent* gpuAgent = static_cast<AMD::GpuAgent*>(agent);
-
-  switch (csd.method) {
-    case HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1: {
-      size_t buf_samples = buf1_sz / sizeof(perf_sample_hosttrap_v1_t);
-      perf_sample_hosttrap_v1_t* samples = reinterpret_cast<perf_sample_hosttrap_v1_t*>(buf1);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
-
-      buf_samples = buf2_sz / sizeof(perf_sample_hosttrap_v1_t);
-      samples = reinterpret_cast<perf_sample_hosttrap_v1_t*>(buf2);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
-    }
-    break;
-    case HSA_VEN_AMD_PCS_METHOD_STOCHASTIC_V1: {
-      size_t buf_samples = buf1_sz / sizeof(perf_sample_snapshot_v1_t);
-      perf_sample_snapshot_v1_t* samples = reinterpret_cast<perf_sample_snapshot_v1_t*>(buf1);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
-
-      buf_samples = buf2_sz / sizeof(perf_sample_snapshot_v1_t);
-      samples = reinterpret_cast<perf_sample_snapshot_v1_t*>(buf2);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
-    }
-    break;
-  }
-
   csd.data_ready_callback(csd.client_callback_data, buf1_sz + buf2_sz, lost_sample_count,
                           &PcSamplingDataCopyCallback,
                           /* hsa_callback_data*/ this);
@@ -246,7 +210,6 @@ hsa_status_t PcsRuntime::PcSamplingCreate(core::Agent* agent, hsa_ven_amd_pcs_me
                                           void* client_cb_data, hsa_ven_amd_pcs_t* handle) {
 
   IS_BAD_PTR(handle);
-  IS_BAD_PTR(data_ready_cb);
 
   return PcSamplingCreateInternal(
       agent, method, units, interval, latency, buffer_size, data_ready_cb, client_cb_data, handle,
@@ -262,7 +225,6 @@ hsa_status_t PcsRuntime::PcSamplingCreateFromId(uint32_t ioctl_pcs_id, core::Age
                                                 hsa_ven_amd_pcs_data_ready_callback_t data_ready_cb,
                                                 void* client_cb_data, hsa_ven_amd_pcs_t* handle) {
   IS_BAD_PTR(handle);
-  IS_BAD_PTR(data_ready_cb);
 
   return PcSamplingCreateInternal(
       agent, method, units, interval, latency, buffer_size, data_ready_cb, client_cb_data, handle,
@@ -308,6 +270,9 @@ hsa_status_t PcsRuntime::PcSamplingDestroy(hsa_ven_amd_pcs_t handle) {
   }
   AMD::GpuAgentInt* gpu_agent = static_cast<AMD::GpuAgentInt*>(pcSamplingSessionIt->second.agent);
 
+  // New readers need pc_sampling_lock_, wait for the ones already reading.
+  while (pcSamplingSessionIt->second.HasReaders()) os::YieldThread();
+
   hsa_status_t ret = gpu_agent->PcSamplingDestroy(pcSamplingSessionIt->second);
   pc_sampling_.erase(pcSamplingSessionIt);
   return ret;
@@ -349,5 +314,49 @@ hsa_status_t PcsRuntime::PcSamplingFlush(hsa_ven_amd_pcs_t handle) {
   return gpu_agent->PcSamplingFlush(pcSamplingSessionIt->second);
 }
 
+hsa_status_t PcsRuntime::PcSamplingDataAcquire(hsa_ven_amd_pcs_t handle,
+                                               hsa_ven_amd_pcs_data_view_t* view) {
+  IS_BAD_PTR(view);
+
+  PcSamplingSession* session;
+  {
+    ScopedAcquire<KernelMutex> lock(&pc_sampling_lock_);
+    auto pcSamplingSessionIt = pc_sampling_.find(reinterpret_cast<uint64_t>(handle.handle));
+    if (pcSamplingSessionIt == pc_sampling_.end()) {
+      debug_warning(false && "Cannot find PcSampling session");
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    session = &pcSamplingSessionIt->second;
+    if (!session->zero_copy()) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    session->AddReader();
+  }
+
+  // Do not hold pc_sampling_lock_ so that reading samples never waits on a flush.  The reader
+  // reference keeps PcSamplingDestroy from freeing the session meanwhile.
+  AMD::GpuAgentInt* gpu_agent = static_cast<AMD::GpuAgentInt*>(session->agent);
+  MAKE_SCOPE_GUARD([&]() { session->RemoveReader(); });
+  return gpu_agent->PcSamplingDataAcquire(*session, view);
+}
+
+hsa_status_t PcsRuntime::PcSamplingDataRelease(hsa_ven_amd_pcs_t handle, size_t data_size) {
+  PcSamplingSession* session;
+  {
+    ScopedAcquire<KernelMutex> lock(&pc_sampling_lock_);
+    auto pcSamplingSessionIt = pc_sampling_.find(reinterpret_cast<uint64_t>(handle.handle));
+    if (pcSamplingSessionIt == pc_sampling_.end()) {
+      debug_warning(false && "Cannot find PcSampling session");
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+    session = &pcSamplingSessionIt->second;
+    if (!session->zero_copy() || (data_size % session->sample_size()))
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    session->AddReader();
+  }
+
+  AMD::GpuAgentInt* gpu_agent = static_cast<AMD::GpuAgentInt*>(session->agent);
+  MAKE_SCOPE_GUARD([&]() { session->RemoveReader(); });
+  return gpu_agent->PcSamplingDataRelease(*session, data_size);
+}
+
 }  // namespace pcs
 }  // namespace rocr
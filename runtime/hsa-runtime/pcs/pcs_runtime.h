@@ -72,7 +72,7 @@ class PcsRuntime {
 
   class PcSamplingSession {
    public:
-    PcSamplingSession() : agent(NULL), thunkId_(0), active_(false){};
+    PcSamplingSession() : agent(NULL), thunkId_(0), active_(false), readers_(0){};
     PcSamplingSession(core::Agent* agent, hsa_ven_amd_pcs_method_kind_t method,
                       hsa_ven_amd_pcs_units_t units, size_t interval, size_t latency,
                       size_t buffer_size, hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback,
@@ -84,6 +84,8 @@ class PcsRuntime {
     const hsa_ven_amd_pcs_method_kind_t method() { return csd.method; }
     const size_t latency() { return csd.latency; }
     const size_t sample_size() { return sample_size_; }
+    // Samples are read in place by the client instead of copied through data_ready_callback
+    const bool zero_copy() { return csd.data_ready_callback == NULL; }
 
     void GetHsaKmtSamplingInfo(HsaPcSamplingInfo* sampleInfo);
     hsa_status_t HandleSampleData(uint8_t* buf1, size_t buf1_sz, uint8_t* buf2, size_t buf2_sz,
@@ -97,10 +99,17 @@ class PcsRuntime {
     void start() { active_ = true; }
     void stop() { active_ = false; }
 
+    // Zero copy reads run without pc_sampling_lock_, they pin the session so that it is not
+    // destroyed under them.  Readers are added under pc_sampling_lock_.
+    void AddReader() { readers_.fetch_add(1, std::memory_order_relaxed); }
+    void RemoveReader() { readers_.fetch_sub(1, std::memory_order_release); }
+    bool HasReaders() const { return readers_.load(std::memory_order_acquire) != 0; }
+
    private:
     HsaPcSamplingTraceId thunkId_;
 
     bool active_;  // Set to true when the session is started
+    std::atomic<uint32_t> readers_;  // Zero copy reads in progress
     bool valid_;   // Whether configuration parameters are valid
     size_t sample_size_;
 
@@ -146,6 +155,8 @@ class PcsRuntime {
   hsa_status_t PcSamplingStart(hsa_ven_amd_pcs_t handle);
   hsa_status_t PcSamplingStop(hsa_ven_amd_pcs_t handle);
   hsa_status_t PcSamplingFlush(hsa_ven_amd_pcs_t handle);
+  hsa_status_t PcSamplingDataAcquire(hsa_ven_amd_pcs_t handle, hsa_ven_amd_pcs_data_view_t* view);
+  hsa_status_t PcSamplingDataRelease(hsa_ven_amd_pcs_t handle, size_t data_size);
 
  private:
   /// @brief Initialize singleton object, must be called once.
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+################################################################################
+#
+# The University of Illinois/NCSA
+# Open Source License (NCSA)
+#
+# Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+#
+# Developed by:
+#
+#                 AMD Research and AMD HSA Software Development
+#
+#                 Advanced Micro Devices, Inc.
+#
+#                 www.amd.com
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal with the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+#  - Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimers.
+#  - Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimers in
+#    the documentation and/or other materials provided with the distribution.
+#  - Neither the names of Advanced Micro Devices, Inc,
+#    nor the names of its contributors may be used to endorse or promote
+#    products derived from this Software without specific prior written
+#    permission.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+# OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+# ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS WITH THE SOFTWARE.
+#
+################################################################################
+
+"""Decodes trace files written by the runtime when HSA_TRACE_FILE is set.
+
+The format is described in core/util/trace.h.  A file holds one session per
+hsa_init of the writing process, they are decoded as one trace.  By default events are printed
+as text, one per line, in timestamp order.  --chrome writes the Chrome trace
+event JSON format instead, viewable in chrome://tracing or Perfetto.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+FILE_MAGIC = b"ROCRTRC\0"
+FILE_VERSION = 1
+
+FILE_HEADER = struct.Struct("<8sIIdQQ")
+BLOCK_HEADER = struct.Struct("<II")
+EVENT = struct.Struct("<QIHBBQQ")
+DROPPED = struct.Struct("<IIQ")
+
+BLOCK_EVENTS = 1
+BLOCK_STRING = 2
+BLOCK_DROPPED = 3
+
+EVENT_NAMES = {
+    1: "api",
+    2: "doorbell",
+    3: "blit_copy",
+    4: "blit_fill",
+    5: "signal_wait",
+    6: "signal_wait_any",
+    7: "scratch_acquire",
+    8: "scratch_release",
+    9: "allocate",
+    10: "free",
+}
+
+PHASE_NAMES = {0: "I", 1: "B", 2: "E"}
+
+
+class Trace(object):
+    def __init__(self):
+        self.frequency = 0.0
+        self.start_timestamp = 0
+        self.start_realtime_ns = 0
+        self.sessions = 1
+        self.events = []
+        self.strings = {}
+        self.dropped = {}
+
+    def time_us(self, timestamp):
+        return (timestamp - self.start_timestamp) * 1e6 / self.frequency
+
+    def event_name(self, event_id, arg0):
+        if event_id == 1:
+            return self.strings.get(arg0, "api@%#x" % arg0)
+        return EVENT_NAMES.get(event_id, "event%d" % event_id)
+
+
+def read_header(path, data, offset):
+    if offset + FILE_HEADER.size > len(data):
+        raise ValueError("%s: truncated header at offset %d" % (path, offset))
+    magic, version, event_size, frequency, start_ts, start_rt = \
+        FILE_HEADER.unpack_from(data, offset)
+    if magic != FILE_MAGIC:
+        raise ValueError("%s: not a runtime trace file" % path)
+    if version != FILE_VERSION or event_size != EVENT.size:
+        raise ValueError("%s: unsupported trace version %d" % (path, version))
+    return frequency, start_ts, start_rt
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    trace = Trace()
+    trace.frequency, trace.start_timestamp, trace.start_realtime_ns = read_header(path, data, 0)
+
+    offset = FILE_HEADER.size
+    while offset + BLOCK_HEADER.size <= len(data):
+        # Later sessions of the same process append their own header.  Event
+        # timestamps share one clock, so times stay relative to the first.
+        if data[offset:offset + len(FILE_MAGIC)] == FILE_MAGIC:
+            read_header(path, data, offset)
+            trace.sessions += 1
+            offset += FILE_HEADER.size
+            continue
+        block_type, size = BLOCK_HEADER.unpack_from(data, offset)
+        offset += BLOCK_HEADER.size
+        if offset + size > len(data):
+            # The process may have died during a flush.
+            sys.stderr.write("warning: truncated block at offset %d\n" % offset)
+            break
+        if block_type == BLOCK_EVENTS:
+            trace.events.extend(EVENT.iter_unpack(data[offset:offset + size]))
+        elif block_type == BLOCK_STRING:
+            key, = struct.unpack_from("<Q", data, offset)
+            trace.strings[key] = data[offset + 8:offset + size].decode("utf-8", "replace")
+        elif block_type == BLOCK_DROPPED:
+            tid, _, count = DROPPED.unpack_from(data, offset)
+            trace.dropped[tid] = trace.dropped.get(tid, 0) + count
+        offset += size
+
+    trace.events.sort(key=lambda event: event[0])
+    return trace
+
+
+def print_text(trace, out):
+    for timestamp, tid, event_id, phase, _, arg0, arg1 in trace.events:
+        name = trace.event_name(event_id, arg0)
+        if event_id == 1:
+            args = ""
+        else:
+            args = " %#x %d" % (arg0, arg1)
+        out.write("%14.3f %7d %s %s%s\n" % (trace.time_us(timestamp), tid,
+                                            PHASE_NAMES.get(phase, "?"), name, args))
+    for tid, count in sorted(trace.dropped.items()):
+        out.write("thread %d dropped %d events\n" % (tid, count))
+
+
+def write_chrome(trace, out):
+    records = []
+    for timestamp, tid, event_id, phase, _, arg0, arg1 in trace.events:
+        record = {
+            "name": trace.event_name(event_id, arg0),
+            "ph": PHASE_NAMES.get(phase, "I"),
+            "ts": trace.time_us(timestamp),
+            "pid": 0,
+            "tid": tid,
+        }
+        if event_id != 1:
+            record["args"] = {"arg0": "%#x" % arg0, "arg1": arg1}
+        if record["ph"] == "I":
+            record["s"] = "t"
+        records.append(record)
+    json.dump({"traceEvents": records,
+               "otherData": {"start_realtime_ns": trace.start_realtime_ns,
+                             "sessions": trace.sessions,
+                             "dropped": trace.dropped}}, out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="trace file written by the runtime")
+    parser.add_argument("--chrome", action="store_true",
+                        help="write Chrome trace event JSON instead of text")
+    parser.add_argument("-o", "--output", help="output file, stdout by default")
+    args = parser.parse_args()
+
+    trace = read_trace(args.trace)
+    out = open(args.output, "w") if args.output else sys.stdout
+    try:
+        if args.chrome:
+            write_chrome(trace, out)
+        else:
+            print_text(trace, out)
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == "__main__":
+    main()